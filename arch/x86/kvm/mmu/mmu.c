@@ -699,6 +699,23 @@ static int mmu_topup_memory_caches(struct kvm_vcpu *vcpu, bool maybe_indirect)
 					  PT64_ROOT_MAX_LEVEL);
 }
 
+/*
+ * Bind shadow-page refills to the node backing the faulting gfn.  The cache
+ * may still hold pages allocated for the previous node; those are consumed
+ * either way, and subsequent refills then follow the fault pattern, which
+ * for NUMA-aligned vCPUs converges on node-local page table metadata.
+ */
+static void mmu_bind_shadow_page_cache_node(struct kvm_vcpu *vcpu,
+					    struct kvm_page_fault *fault)
+{
+	int nid = NUMA_NO_NODE;
+
+	if (fault->slot && pfn_valid(fault->pfn))
+		nid = page_to_nid(pfn_to_page(fault->pfn));
+
+	kvm_mmu_memory_cache_set_node(&vcpu->arch.mmu_shadow_page_cache, nid);
+}
+
 static void mmu_free_memory_caches(struct kvm_vcpu *vcpu)
 {
 	kvm_mmu_free_memory_cache(&vcpu->arch.mmu_pte_list_desc_cache);
@@ -4508,6 +4525,8 @@ static int direct_page_fault(struct kvm_vcpu *vcpu, struct kvm_page_fault *fault
 	if (r != RET_PF_CONTINUE)
 		return r;
 
+	mmu_bind_shadow_page_cache_node(vcpu, fault);
+
 	r = RET_PF_RETRY;
 	write_lock(&vcpu->kvm->mmu_lock);
 
@@ -4598,6 +4617,8 @@ static int kvm_tdp_mmu_page_fault(struct kvm_vcpu *vcpu,
 	if (r != RET_PF_CONTINUE)
 		return r;
 
+	mmu_bind_shadow_page_cache_node(vcpu, fault);
+
 	r = RET_PF_RETRY;
 	read_lock(&vcpu->kvm->mmu_lock);
 
@@ -6854,7 +6875,18 @@ void kvm_arch_flush_shadow_all(struct kvm *kvm)
 void kvm_arch_flush_shadow_memslot(struct kvm *kvm,
 				   struct kvm_memory_slot *slot)
 {
-	kvm_mmu_zap_all_fast(kvm);
+	/*
+	 * Zapping every SPTE on memslot deletion is the historical behavior
+	 * and some guests depend on it (see KVM_X86_QUIRK_SLOT_ZAP_ALL).
+	 * When userspace disables the quirk, zap only the leaf SPTEs that
+	 * cover the deleted slot, so that deleting a slot no longer costs
+	 * time proportional to total guest size.
+	 */
+	if (kvm_check_has_quirk(kvm, KVM_X86_QUIRK_SLOT_ZAP_ALL))
+		kvm_mmu_zap_all_fast(kvm);
+	else
+		kvm_zap_gfn_range(kvm, slot->base_gfn,
+				  slot->base_gfn + slot->npages);
 }
 
 void kvm_mmu_invalidate_mmio_sptes(struct kvm *kvm, u64 gen)
@@ -4190,8 +4190,12 @@ static __no_kcsan fastpath_t svm_vcpu_run(struct kvm_vcpu *vcpu,
 	if (!static_cpu_has(X86_FEATURE_V_SPEC_CTRL))
 		x86_spec_ctrl_set_guest(svm->virt_spec_ctrl);
 
+	kvm_vcpu_stat_guest_entry(vcpu);
+
 	svm_vcpu_enter_exit(vcpu, spec_ctrl_intercepted);
 
+	kvm_vcpu_stat_guest_exit(vcpu);
+
 	if (!static_cpu_has(X86_FEATURE_V_SPEC_CTRL))
 		x86_spec_ctrl_restore_host(svm->virt_spec_ctrl);
 
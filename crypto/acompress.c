@@ -153,6 +153,50 @@ void acomp_request_free(struct acomp_req *req)
 }
 EXPORT_SYMBOL_GPL(acomp_request_free);
 
+static int acomp_batch_submit(struct crypto_batch *batch,
+			      struct acomp_req *reqs[], unsigned int nr,
+			      int (*op)(struct acomp_req *req))
+{
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < nr; i++) {
+		struct acomp_req *req = reqs[i];
+
+		req->base.complete = crypto_batch_done;
+		req->base.data = batch;
+
+		atomic_inc(&batch->pending);
+		err = op(req);
+		if (err == -EINPROGRESS)
+			continue;
+		if (err == -EBUSY &&
+		    req->base.flags & CRYPTO_TFM_REQ_MAY_BACKLOG)
+			continue;
+		/* completed synchronously, or failed to queue */
+		crypto_batch_done(batch, err);
+	}
+
+	/* drop the submission reference taken by crypto_init_batch() */
+	crypto_batch_done(batch, 0);
+
+	return -EINPROGRESS;
+}
+
+int crypto_acomp_batch_compress(struct crypto_batch *batch,
+				struct acomp_req *reqs[], unsigned int nr)
+{
+	return acomp_batch_submit(batch, reqs, nr, crypto_acomp_compress);
+}
+EXPORT_SYMBOL_GPL(crypto_acomp_batch_compress);
+
+int crypto_acomp_batch_decompress(struct crypto_batch *batch,
+				  struct acomp_req *reqs[], unsigned int nr)
+{
+	return acomp_batch_submit(batch, reqs, nr, crypto_acomp_decompress);
+}
+EXPORT_SYMBOL_GPL(crypto_acomp_batch_decompress);
+
 void comp_prepare_alg(struct comp_alg_common *alg)
 {
 	struct crypto_alg *base = &alg->base;
@@ -556,7 +556,14 @@ void af_alg_free_sg(struct af_alg_sgl *sgl)
 }
 EXPORT_SYMBOL_GPL(af_alg_free_sg);
 
-static int af_alg_cmsg_send(struct msghdr *msg, struct af_alg_control *con)
+/**
+ * af_alg_cmsg_send - parse the SOL_ALG control messages of a sendmsg call
+ *
+ * @msg: message to parse
+ * @con: Returns the parsed control information
+ * Return: 0 upon success, < 0 upon error
+ */
+int af_alg_cmsg_send(struct msghdr *msg, struct af_alg_control *con)
 {
 	struct cmsghdr *cmsg;
 
@@ -588,6 +595,12 @@ static int af_alg_cmsg_send(struct msghdr *msg, struct af_alg_control *con)
 			con->aead_assoclen = *(u32 *)CMSG_DATA(cmsg);
 			break;
 
+		case ALG_SET_VECTORED:
+			if (cmsg->cmsg_len < CMSG_LEN(sizeof(u32)))
+				return -EINVAL;
+			con->vectored = *(u32 *)CMSG_DATA(cmsg);
+			break;
+
 		default:
 			return -EINVAL;
 		}
@@ -595,6 +608,7 @@ static int af_alg_cmsg_send(struct msghdr *msg, struct af_alg_control *con)
 
 	return 0;
 }
+EXPORT_SYMBOL_GPL(af_alg_cmsg_send);
 
 /**
  * af_alg_alloc_tsgl - allocate the TX SGL
@@ -372,6 +372,36 @@ int crypto_ahash_digest(struct ahash_request *req)
 }
 EXPORT_SYMBOL_GPL(crypto_ahash_digest);
 
+int crypto_ahash_batch_digest(struct crypto_batch *batch,
+			      struct ahash_request *reqs[], unsigned int nr)
+{
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < nr; i++) {
+		struct ahash_request *req = reqs[i];
+
+		req->base.complete = crypto_batch_done;
+		req->base.data = batch;
+
+		atomic_inc(&batch->pending);
+		err = crypto_ahash_digest(req);
+		if (err == -EINPROGRESS)
+			continue;
+		if (err == -EBUSY &&
+		    req->base.flags & CRYPTO_TFM_REQ_MAY_BACKLOG)
+			continue;
+		/* completed synchronously, or failed to queue */
+		crypto_batch_done(batch, err);
+	}
+
+	/* drop the submission reference taken by crypto_init_batch() */
+	crypto_batch_done(batch, 0);
+
+	return -EINPROGRESS;
+}
+EXPORT_SYMBOL_GPL(crypto_ahash_batch_digest);
+
 static void ahash_def_finup_done2(void *data, int err)
 {
 	struct ahash_request *areq = data;
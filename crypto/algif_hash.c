@@ -21,6 +21,9 @@ struct hash_ctx {
 
 	u8 *result;
 
+	u8 *vec_results;
+	unsigned int vec_size;
+
 	struct crypto_wait wait;
 
 	unsigned int len;
@@ -29,6 +32,9 @@ struct hash_ctx {
 	struct ahash_request req;
 };
 
+/* Number of vectored ops kept in flight per submission round. */
+#define HASH_VEC_BATCH	16
+
 static int hash_alloc_result(struct sock *sk, struct hash_ctx *ctx)
 {
 	unsigned ds;
@@ -60,6 +66,166 @@ static void hash_free_result(struct sock *sk, struct hash_ctx *ctx)
 	ctx->result = NULL;
 }
 
+static void hash_free_vec_results(struct sock *sk, struct hash_ctx *ctx)
+{
+	if (!ctx->vec_results)
+		return;
+
+	sock_kzfree_s(sk, ctx->vec_results, ctx->vec_size);
+	ctx->vec_results = NULL;
+	ctx->vec_size = 0;
+}
+
+static int hash_vec_prep_op(struct crypto_ahash *tfm, struct iov_iter *seg,
+			    struct af_alg_sgl *sgl, struct ahash_request *req,
+			    u8 *result, size_t max_pages)
+{
+	size_t len = iov_iter_count(seg);
+	ssize_t extracted;
+	size_t npages;
+
+	sgl->sgt.sgl = sgl->sgl;
+	sgl->sgt.nents = 0;
+	sgl->sgt.orig_nents = 0;
+	sgl->need_unpin = false;
+
+	if (len) {
+		npages = iov_iter_npages(seg, max_pages + 1);
+		if (npages > max_pages)
+			return -EMSGSIZE;
+		if (npages == 0)
+			return -EIO;
+
+		sg_init_table(sgl->sgl, npages);
+
+		sgl->need_unpin = iov_iter_extract_will_pin(seg);
+
+		extracted = extract_iter_to_sg(seg, len, &sgl->sgt, npages, 0);
+		if (extracted < 0)
+			return extracted;
+		if (extracted != len)
+			return -EIO;
+		sg_mark_end(sgl->sgt.sgl + sgl->sgt.nents - 1);
+	}
+
+	ahash_request_set_tfm(req, tfm);
+	ahash_request_set_callback(req, CRYPTO_TFM_REQ_MAY_BACKLOG, NULL, NULL);
+	ahash_request_set_crypt(req, len ? sgl->sgt.sgl : NULL, result, len);
+
+	return 0;
+}
+
+/*
+ * Vectored submission: each iovec of the sendmsg call is hashed as an
+ * independent message.  The digests are produced in iovec order and read
+ * back as one concatenated blob with recvmsg.  Ops are submitted in
+ * batches of HASH_VEC_BATCH through crypto_ahash_batch_digest() so async
+ * implementations keep several requests in flight, with one completion
+ * wait per batch rather than per op.
+ */
+static int hash_sendmsg_vec(struct sock *sk, struct msghdr *msg)
+{
+	struct alg_sock *ask = alg_sk(sk);
+	struct hash_ctx *ctx = ask->private;
+	struct crypto_ahash *tfm = crypto_ahash_reqtfm(&ctx->req);
+	unsigned int ds = crypto_ahash_digestsize(tfm);
+	unsigned int op_len = sizeof(struct af_alg_sgl) +
+			      sizeof(struct ahash_request) +
+			      crypto_ahash_reqsize(tfm);
+	struct ahash_request *reqs[HASH_VEC_BATCH];
+	DECLARE_CRYPTO_WAIT(wait);
+	struct crypto_batch batch;
+	size_t max_pages, nr_ops, done = 0;
+	ssize_t copied;
+	u8 *results;
+	void *ops;
+	unsigned int i, n;
+	int err;
+
+	if (msg->msg_flags & MSG_MORE)
+		return -EINVAL;
+
+	max_pages = min_t(size_t, ALG_MAX_PAGES,
+			  DIV_ROUND_UP(sk->sk_sndbuf, PAGE_SIZE));
+	copied = iov_iter_count(&msg->msg_iter);
+
+	lock_sock(sk);
+
+	/* Vectored ops don't carry accumulation state across sendmsgs. */
+	hash_free_result(sk, ctx);
+	hash_free_vec_results(sk, ctx);
+	ctx->more = false;
+
+	err = 0;
+	nr_ops = iter_is_iovec(&msg->msg_iter) ? msg->msg_iter.nr_segs : 1;
+	if (!nr_ops || !copied)
+		goto unlock;
+
+	err = -ENOMEM;
+	results = sock_kmalloc(sk, nr_ops * ds, GFP_KERNEL);
+	if (!results)
+		goto unlock;
+	ops = sock_kmalloc(sk, HASH_VEC_BATCH * op_len, GFP_KERNEL);
+	if (!ops)
+		goto free_results;
+
+	while (done < nr_ops) {
+		n = 0;
+		crypto_init_batch(&batch, crypto_req_done, &wait);
+
+		while (done + n < nr_ops && n < HASH_VEC_BATCH) {
+			struct af_alg_sgl *sgl = ops + n * op_len;
+			struct ahash_request *req = (void *)(sgl + 1);
+			struct iov_iter seg;
+
+			if (iter_is_iovec(&msg->msg_iter)) {
+				const struct iovec *iov =
+					iter_iov(&msg->msg_iter) + done + n;
+
+				iov_iter_init(&seg, ITER_SOURCE, iov, 1,
+					      iov->iov_len);
+			} else {
+				/* single buffer, single op */
+				seg = msg->msg_iter;
+			}
+
+			err = hash_vec_prep_op(tfm, &seg, sgl, req,
+					       results + (done + n) * ds,
+					       max_pages);
+			if (err) {
+				for (i = 0; i <= n; i++)
+					af_alg_free_sg(ops + i * op_len);
+				goto free_ops;
+			}
+			reqs[n++] = req;
+		}
+
+		err = crypto_wait_req(crypto_ahash_batch_digest(&batch,
+								reqs, n),
+				      &wait);
+		for (i = 0; i < n; i++)
+			af_alg_free_sg(ops + i * op_len);
+		if (err)
+			goto free_ops;
+
+		done += n;
+	}
+
+	ctx->vec_results = results;
+	ctx->vec_size = nr_ops * ds;
+	sock_kfree_s(sk, ops, HASH_VEC_BATCH * op_len);
+	release_sock(sk);
+	return copied;
+
+free_ops:
+	sock_kfree_s(sk, ops, HASH_VEC_BATCH * op_len);
+free_results:
+	sock_kzfree_s(sk, results, nr_ops * ds);
+unlock:
+	release_sock(sk);
+	return err;
+}
+
 static int hash_sendmsg(struct socket *sock, struct msghdr *msg,
 			size_t ignored)
 {
@@ -71,6 +237,16 @@ static int hash_sendmsg(struct socket *sock, struct msghdr *msg,
 	bool continuing, need_init = false;
 	int err;
 
+	if (msg->msg_controllen) {
+		struct af_alg_control con = {};
+
+		err = af_alg_cmsg_send(msg, &con);
+		if (err)
+			return err;
+		if (con.vectored)
+			return hash_sendmsg_vec(sk, msg);
+	}
+
 	max_pages = min_t(size_t, ALG_MAX_PAGES,
 			  DIV_ROUND_UP(sk->sk_sndbuf, PAGE_SIZE));
 
@@ -80,6 +256,7 @@ static int hash_sendmsg(struct socket *sock, struct msghdr *msg,
 	if (!continuing) {
 		/* Discard a previous request that wasn't marked MSG_MORE. */
 		hash_free_result(sk, ctx);
+		hash_free_vec_results(sk, ctx);
 		if (!msg_data_left(msg))
 			goto done; /* Zero-length; don't start new req */
 		need_init = true;
@@ -186,12 +363,28 @@ static int hash_recvmsg(struct socket *sock, struct msghdr *msg, size_t len,
 	bool result;
 	int err;
 
+	lock_sock(sk);
+
+	if (ctx->vec_results) {
+		size_t total = ctx->vec_size;
+
+		if (len > total)
+			len = total;
+		else if (len < total)
+			msg->msg_flags |= MSG_TRUNC;
+
+		err = memcpy_to_msg(msg, ctx->vec_results, len);
+		hash_free_vec_results(sk, ctx);
+		release_sock(sk);
+
+		return err ?: len;
+	}
+
 	if (len > ds)
 		len = ds;
 	else if (len < ds)
 		msg->msg_flags |= MSG_TRUNC;
 
-	lock_sock(sk);
 	result = ctx->result;
 	err = hash_alloc_result(sk, ctx);
 	if (err)
@@ -405,6 +598,7 @@ static void hash_sock_destruct(struct sock *sk)
 	struct hash_ctx *ctx = ask->private;
 
 	hash_free_result(sk, ctx);
+	hash_free_vec_results(sk, ctx);
 	sock_kfree_s(sk, ctx, ctx->len);
 	af_alg_release_parent(sk);
 }
@@ -421,6 +615,8 @@ static int hash_accept_parent_nokey(void *private, struct sock *sk)
 		return -ENOMEM;
 
 	ctx->result = NULL;
+	ctx->vec_results = NULL;
+	ctx->vec_size = 0;
 	ctx->len = len;
 	ctx->more = false;
 	crypto_init_wait(&ctx->wait);
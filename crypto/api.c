@@ -693,5 +693,20 @@ void crypto_req_done(void *data, int err)
 }
 EXPORT_SYMBOL_GPL(crypto_req_done);
 
+void crypto_batch_done(void *data, int err)
+{
+	struct crypto_batch *batch = data;
+
+	if (err == -EINPROGRESS)
+		return;
+
+	if (err)
+		atomic_cmpxchg(&batch->err, 0, err);
+
+	if (atomic_dec_and_test(&batch->pending))
+		batch->complete(batch->data, atomic_read(&batch->err));
+}
+EXPORT_SYMBOL_GPL(crypto_batch_done);
+
 MODULE_DESCRIPTION("Cryptographic core API");
 MODULE_LICENSE("GPL");
@@ -1107,6 +1107,58 @@ int device_links_check_suppliers(struct device *dev)
 	return ret ? ret : fwnode_ret;
 }
 
+/**
+ * device_links_supplier_ready - Tell whether a probe retry could make progress.
+ * @dev: Consumer device on the deferred probe pending list.
+ *
+ * A side-effect free counterpart of device_links_check_suppliers() used by the
+ * deferred probe machinery to skip retries that are guaranteed to end in
+ * another -EPROBE_DEFER because a managed supplier has still not bound.  When
+ * in doubt (permissive fw_devlink, best-effort probing) it reports ready, so
+ * a filtered retry behaves exactly like an unconditional one.
+ *
+ * Uses only the SRCU read side so it is safe to call with the deferred probe
+ * mutex held: driver_deferred_probe_add() runs under the device links write
+ * lock, so taking it here would invert the lock order.
+ */
+bool device_links_supplier_ready(struct device *dev)
+{
+	struct device_link *link;
+	struct fwnode_handle *sup_fw;
+	bool ready = true;
+	int idx;
+
+	mutex_lock(&fwnode_link_lock);
+	sup_fw = fwnode_links_check_suppliers(dev->fwnode);
+	mutex_unlock(&fwnode_link_lock);
+	if (sup_fw && !dev_is_best_effort(dev))
+		return false;
+
+	idx = device_links_read_lock();
+
+	list_for_each_entry_rcu(link, &dev->links.suppliers, c_node,
+				device_links_read_lock_held()) {
+		if (!(link->flags & DL_FLAG_MANAGED))
+			continue;
+
+		if (READ_ONCE(link->status) == DL_STATE_AVAILABLE ||
+		    link->flags & DL_FLAG_SYNC_STATE_ONLY)
+			continue;
+
+		if (dev_is_best_effort(dev) &&
+		    link->flags & DL_FLAG_INFERRED &&
+		    !link->supplier->can_match)
+			continue;
+
+		ready = false;
+		break;
+	}
+
+	device_links_read_unlock(idx);
+
+	return ready;
+}
+
 /**
  * __device_links_queue_sync_state - Queue a device for sync_state() callback
  * @dev: Device to call sync_state() on
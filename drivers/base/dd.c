@@ -174,18 +174,29 @@ static bool driver_deferred_probe_enable;
  */
 void driver_deferred_probe_trigger(void)
 {
+	struct device_private *p, *tmp;
+
 	if (!driver_deferred_probe_enable)
 		return;
 
 	/*
 	 * A successful probe means that all the devices in the pending list
-	 * should be triggered to be reprobed.  Move all the deferred devices
-	 * into the active list so they can be retried by the workqueue
+	 * should be triggered to be reprobed.  Move the deferred devices into
+	 * the active list so they can be retried by the workqueue, but skip
+	 * the ones whose managed suppliers have still not bound:
+	 * device_links_check_suppliers() would only put them straight back on
+	 * the pending list, and the probe that eventually binds their
+	 * supplier triggers us again.
 	 */
 	mutex_lock(&deferred_probe_mutex);
 	atomic_inc(&deferred_trigger_count);
-	list_splice_tail_init(&deferred_probe_pending_list,
-			      &deferred_probe_active_list);
+	list_for_each_entry_safe(p, tmp, &deferred_probe_pending_list,
+				 deferred_probe) {
+		if (!device_links_supplier_ready(p->device))
+			continue;
+		list_move_tail(&p->deferred_probe,
+			       &deferred_probe_active_list);
+	}
 	mutex_unlock(&deferred_probe_mutex);
 
 	/*
@@ -25,6 +25,7 @@
 #include <linux/shmem_fs.h>
 #include <linux/ramfs.h>
 #include <linux/sched.h>
+#include <linux/sched/task.h>
 #include <linux/slab.h>
 #include <linux/kthread.h>
 #include <linux/init_syscalls.h>
@@ -39,9 +40,17 @@
 
 static struct task_struct *thread;
 
+/*
+ * Additional workers forked off the main thread with CLONE_FS, so they share
+ * its devtmpfs root.  Bounded: beyond a few workers node creation mostly
+ * serializes on the per-directory inode locks anyway.
+ */
+#define DEVTMPFS_MAX_WORKERS	4
+
 static int __initdata mount_dev = IS_ENABLED(CONFIG_DEVTMPFS_MOUNT);
 
 static DEFINE_SPINLOCK(req_lock);
+static DECLARE_WAIT_QUEUE_HEAD(req_waitq);
 
 static struct req {
 	struct req *next;
@@ -103,7 +112,7 @@ static int devtmpfs_submit_req(struct req *req, const char *tmp)
 	requests = req;
 	spin_unlock(&req_lock);
 
-	wake_up_process(thread);
+	wake_up(&req_waitq);
 	wait_for_completion(&req->done);
 
 	kfree(tmp);
@@ -206,10 +215,16 @@ static int handle_create(const char *nodename, umode_t mode, kuid_t uid,
 {
 	struct dentry *dentry;
 	struct path path;
+	int retries;
 	int err;
 
+	/*
+	 * A concurrent handle_remove() of a sibling node can delete the
+	 * parent directories between create_path() and the re-lookup, so
+	 * retry a few times instead of just once.
+	 */
 	dentry = kern_path_create(AT_FDCWD, nodename, &path, 0);
-	if (dentry == ERR_PTR(-ENOENT)) {
+	for (retries = 0; dentry == ERR_PTR(-ENOENT) && retries < 3; retries++) {
 		create_path(nodename);
 		dentry = kern_path_create(AT_FDCWD, nodename, &path, 0);
 	}
@@ -389,23 +404,22 @@ static int handle(const char *name, umode_t mode, kuid_t uid, kgid_t gid,
 static void __noreturn devtmpfs_work_loop(void)
 {
 	while (1) {
+		struct req *req;
+
 		spin_lock(&req_lock);
-		while (requests) {
-			struct req *req = requests;
-			requests = NULL;
-			spin_unlock(&req_lock);
-			while (req) {
-				struct req *next = req->next;
-				req->err = handle(req->name, req->mode,
-						  req->uid, req->gid, req->dev);
-				complete(&req->done);
-				req = next;
-			}
-			spin_lock(&req_lock);
-		}
-		__set_current_state(TASK_INTERRUPTIBLE);
+		req = requests;
+		if (req)
+			requests = req->next;
 		spin_unlock(&req_lock);
-		schedule();
+
+		if (req) {
+			req->err = handle(req->name, req->mode,
+					  req->uid, req->gid, req->dev);
+			complete(&req->done);
+			continue;
+		}
+
+		wait_event_interruptible(req_waitq, READ_ONCE(requests));
 	}
 }
 
@@ -431,13 +445,28 @@ out:
  * calls.  That call is done while devtmpfs_init, which is marked __init,
  * synchronously waits for it to complete.
  */
+static int devtmpfs_worker(void *p)
+{
+	devtmpfs_work_loop();
+	return 0;
+}
+
 static int __ref devtmpfsd(void *p)
 {
 	int err = devtmpfs_setup(p);
+	int nr_workers;
+	int i;
 
 	complete(&setup_done);
 	if (err)
 		return err;
+
+	nr_workers = min_t(int, DEVTMPFS_MAX_WORKERS, num_online_cpus());
+	for (i = 1; i < nr_workers; i++)
+		if (kernel_thread(devtmpfs_worker, NULL, "kdevtmpfs",
+				  CLONE_FS) < 0)
+			break;
+
 	devtmpfs_work_loop();
 	return 0;
 }
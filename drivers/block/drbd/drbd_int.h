@@ -47,6 +47,7 @@ extern int drbd_fault_rate;
 #endif
 
 extern unsigned int drbd_minor_count;
+extern unsigned int drbd_resync_stripes;
 extern char drbd_usermode_helper[];
 extern int drbd_proc_details;
 
@@ -848,6 +849,16 @@ struct drbd_device {
 	struct drbd_bitmap *bitmap;
 	unsigned long bm_resync_fo; /* bit offset for drbd_bm_find_next */
 
+	/* Striped resync: the bitmap is split into disjoint stripes, each
+	 * with its own scan cursor, serviced round-robin so that in-flight
+	 * resync requests spread over the whole device instead of crawling
+	 * it front to back. See make_resync_request(). */
+#define DRBD_RS_STRIPES_MAX 16
+	unsigned long rs_stripe_fo[DRBD_RS_STRIPES_MAX];
+	unsigned long rs_stripe_span; /* bits per stripe */
+	unsigned int rs_stripes;
+	unsigned int rs_stripe_cur; /* next stripe to take a request from */
+
 	/* Used to track operations of resync... */
 	struct lru_cache *resync;
 	/* Number of locked elements in resync LRU */
@@ -92,6 +92,12 @@ module_param_named(disable_sendpage, drbd_disable_sendpage, bool, 0644);
 /* module parameters we share */
 int drbd_proc_details; /* Detail level in proc drbd*/
 module_param_named(proc_details, drbd_proc_details, int, 0644);
+/* Number of disjoint bitmap stripes scanned round-robin during resync,
+ * so that resync reads keep more spindles/flash channels busy. Takes
+ * effect for resyncs started after the change. */
+unsigned int drbd_resync_stripes = 1;
+module_param_named(resync_stripes, drbd_resync_stripes, uint, 0644);
+MODULE_PARM_DESC(resync_stripes, "Number of bitmap stripes resynced in parallel (1..16)");
 /* module parameters shared with defaults */
 unsigned int drbd_minor_count = DRBD_MINOR_COUNT_DEF;
 /* Module parameter for setting the user mode helper program
@@ -582,6 +582,91 @@ static int drbd_rs_number_requests(struct drbd_peer_device *peer_device)
 	return number;
 }
 
+/*
+ * Split the bitmap into drbd_resync_stripes disjoint stripes, one scan
+ * cursor each. The stripe span is rounded up to a multiple of the resync
+ * extent size so that request merging in make_resync_request() can never
+ * cross a stripe boundary.
+ */
+static void drbd_rs_setup_stripes(struct drbd_device *device)
+{
+	unsigned long bits = drbd_bm_bits(device);
+	unsigned long span;
+	unsigned int n, i;
+
+	n = clamp_t(unsigned int, drbd_resync_stripes, 1, DRBD_RS_STRIPES_MAX);
+	/* don't bother striping very small devices */
+	if (bits <= (unsigned long)n * BM_BITS_PER_EXT)
+		n = 1;
+	span = round_up(DIV_ROUND_UP(bits, n), BM_BITS_PER_EXT);
+	if (!span)
+		span = BM_BITS_PER_EXT;
+
+	device->rs_stripes = n;
+	device->rs_stripe_span = span;
+	device->rs_stripe_cur = 0;
+	for (i = 0; i < n; i++)
+		device->rs_stripe_fo[i] = min((unsigned long)i * span, bits);
+}
+
+/*
+ * Pick the next dirty bit to request, round-robin over the resync
+ * stripes. A stripe is finished once no dirty bits are left before its
+ * end; the scan is finished when all stripes are.
+ */
+static unsigned long drbd_rs_find_next(struct drbd_device *device)
+{
+	unsigned long bits = drbd_bm_bits(device);
+	unsigned int n = device->rs_stripes;
+	unsigned int s;
+
+	for (s = 0; s < n; s++) {
+		unsigned int cur = (device->rs_stripe_cur + s) % n;
+		unsigned long end = min((unsigned long)(cur + 1) *
+					device->rs_stripe_span, bits);
+		unsigned long bit;
+
+		if (device->rs_stripe_fo[cur] >= end)
+			continue;
+		bit = drbd_bm_find_next(device, device->rs_stripe_fo[cur]);
+		if (bit == DRBD_END_OF_BITMAP || bit >= end) {
+			device->rs_stripe_fo[cur] = end;
+			continue;
+		}
+		device->rs_stripe_cur = (cur + 1) % n;
+		return bit;
+	}
+	return DRBD_END_OF_BITMAP;
+}
+
+/* Move the cursor of the stripe owning @bit to @next. @next may equal
+ * @bit to rescan it on the next run. bm_resync_fo is kept in sync for
+ * the sector offset progress display. */
+static void drbd_rs_advance_fo(struct drbd_device *device, unsigned long bit,
+			       unsigned long next)
+{
+	unsigned int s = min_t(unsigned int, bit / device->rs_stripe_span,
+			       device->rs_stripes - 1);
+
+	device->rs_stripe_fo[s] = next;
+	device->bm_resync_fo = next;
+}
+
+static bool drbd_rs_scan_done(struct drbd_device *device)
+{
+	unsigned long bits = drbd_bm_bits(device);
+	unsigned int s;
+
+	for (s = 0; s < device->rs_stripes; s++) {
+		unsigned long end = min((unsigned long)(s + 1) *
+					device->rs_stripe_span, bits);
+
+		if (device->rs_stripe_fo[s] < end)
+			return false;
+	}
+	return true;
+}
+
 static int make_resync_request(struct drbd_peer_device *const peer_device, int cancel)
 {
 	struct drbd_device *const device = peer_device->device;
@@ -619,6 +704,10 @@ static int make_resync_request(struct drbd_peer_device *const peer_device, int c
 		rcu_read_unlock();
 	}
 
+	/* a resync may have been running before this module was loaded */
+	if (!device->rs_stripes)
+		drbd_rs_setup_stripes(device);
+
 	max_bio_size = queue_max_hw_sectors(device->rq_queue) << 9;
 	number = drbd_rs_number_requests(peer_device);
 	if (number <= 0)
@@ -645,7 +734,7 @@ static int make_resync_request(struct drbd_peer_device *const peer_device, int c
 
 next_sector:
 		size = BM_BLOCK_SIZE;
-		bit  = drbd_bm_find_next(device, device->bm_resync_fo);
+		bit  = drbd_rs_find_next(device);
 
 		if (bit == DRBD_END_OF_BITMAP) {
 			device->bm_resync_fo = drbd_bm_bits(device);
@@ -656,10 +745,10 @@ next_sector:
 		sector = BM_BIT_TO_SECT(bit);
 
 		if (drbd_try_rs_begin_io(peer_device, sector)) {
-			device->bm_resync_fo = bit;
+			drbd_rs_advance_fo(device, bit, bit);
 			goto requeue;
 		}
-		device->bm_resync_fo = bit + 1;
+		drbd_rs_advance_fo(device, bit, bit + 1);
 
 		if (unlikely(drbd_bm_test_bit(device, bit) == 0)) {
 			drbd_rs_complete_io(device, sector);
@@ -703,9 +792,9 @@ next_sector:
 			i++;
 		}
 		/* if we merged some,
-		 * reset the offset to start the next drbd_bm_find_next from */
+		 * reset the offset to start the next drbd_rs_find_next from */
 		if (size > BM_BLOCK_SIZE)
-			device->bm_resync_fo = bit + 1;
+			drbd_rs_advance_fo(device, bit, bit + 1);
 #endif
 
 		/* adjust very last sectors, in case we are oddly sized */
@@ -719,7 +808,8 @@ next_sector:
 				return -EIO;
 			case -EAGAIN: /* allocation failed, or ldev busy */
 				drbd_rs_complete_io(device, sector);
-				device->bm_resync_fo = BM_SECT_TO_BIT(sector);
+				drbd_rs_advance_fo(device, BM_SECT_TO_BIT(sector),
+						   BM_SECT_TO_BIT(sector));
 				i = rollback_i;
 				goto requeue;
 			case 0:
@@ -744,7 +834,7 @@ next_sector:
 		}
 	}
 
-	if (device->bm_resync_fo >= drbd_bm_bits(device)) {
+	if (drbd_rs_scan_done(device)) {
 		/* last syncer _request_ was sent,
 		 * but the P_RS_DATA_REPLY not yet received.  sync will end (and
 		 * next sync group will resume), as soon as we receive the last
@@ -1861,6 +1951,7 @@ void drbd_start_resync(struct drbd_device *device, enum drbd_conns side)
 		     (unsigned long) device->rs_total);
 		if (side == C_SYNC_TARGET) {
 			device->bm_resync_fo = 0;
+			drbd_rs_setup_stripes(device);
 			device->use_csums = use_checksum_based_resync(connection, device);
 		} else {
 			device->use_csums = false;
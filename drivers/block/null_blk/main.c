@@ -4,6 +4,8 @@
  * Shaohua Li <shli@fb.com>
  */
 #include <linux/module.h>
+#include <linux/ctype.h>
+#include <linux/random.h>
 
 #include <linux/moduleparam.h>
 #include <linux/sched.h>
@@ -463,6 +465,190 @@ NULLB_DEVICE_ATTR(no_sched, bool, NULL);
 NULLB_DEVICE_ATTR(shared_tags, bool, NULL);
 NULLB_DEVICE_ATTR(shared_tag_bitmap, bool, NULL);
 NULLB_DEVICE_ATTR(fua, bool, NULL);
+NULLB_DEVICE_ATTR(lat_stall_nsec, ulong, NULL);
+NULLB_DEVICE_ATTR(lat_stall_period_ms, ulong, NULL);
+NULLB_DEVICE_ATTR(lat_stats, bool, NULL);
+
+/*
+ * Parse one group of a latency model specification, a comma separated
+ * list of percentile=nanoseconds points, e.g. "p50=8000,p99=120000".
+ * Percentiles take an optional single fractional digit ("p99.9") and
+ * must be given in ascending order with non-decreasing latencies.
+ */
+static int null_lat_parse_model(struct null_lat_model *model, char *buf)
+{
+	char *tok;
+
+	while ((tok = strsep(&buf, ",")) != NULL) {
+		unsigned int pct, frac = 0;
+		unsigned long nsec;
+		char *val, *dot;
+
+		if (!*tok)
+			continue;
+		if (model->nr_points >= NULL_LAT_POINTS_MAX)
+			return -E2BIG;
+		if (tok[0] != 'p')
+			return -EINVAL;
+		val = strchr(tok, '=');
+		if (!val)
+			return -EINVAL;
+		*val++ = '\0';
+		dot = strchr(tok + 1, '.');
+		if (dot) {
+			*dot++ = '\0';
+			if (!isdigit(*dot) || dot[1])
+				return -EINVAL;
+			frac = *dot - '0';
+		}
+		if (kstrtouint(tok + 1, 10, &pct))
+			return -EINVAL;
+		if (kstrtoul(val, 10, &nsec))
+			return -EINVAL;
+		pct = pct * 100 + frac * 10;
+		if (!pct || pct > 10000)
+			return -EINVAL;
+		if (model->nr_points &&
+		    (pct <= model->pct[model->nr_points - 1] ||
+		     nsec < model->nsec[model->nr_points - 1]))
+			return -EINVAL;
+		model->pct[model->nr_points] = pct;
+		model->nsec[model->nr_points] = nsec;
+		model->nr_points++;
+	}
+
+	return model->nr_points ? 0 : -EINVAL;
+}
+
+static const char * const null_lat_class_names[NULL_LAT_NR_CLASS] = {
+	[NULL_LAT_READ]		= "read",
+	[NULL_LAT_WRITE]	= "write",
+};
+
+static ssize_t nullb_device_lat_model_show(struct config_item *item,
+					   char *page)
+{
+	struct nullb_device *dev = to_nullb_device(item);
+	ssize_t sz = 0;
+	int cl, i;
+
+	for (cl = 0; cl < NULL_LAT_NR_CLASS; cl++) {
+		struct null_lat_model *model = &dev->lat_model[cl];
+
+		if (!model->nr_points)
+			continue;
+		sz += snprintf(page + sz, PAGE_SIZE - sz, "%s%s:",
+			       sz ? ";" : "", null_lat_class_names[cl]);
+		for (i = 0; i < model->nr_points; i++)
+			sz += snprintf(page + sz, PAGE_SIZE - sz,
+				       "%sp%u.%u=%lu", i ? "," : "",
+				       model->pct[i] / 100,
+				       (model->pct[i] % 100) / 10,
+				       model->nsec[i]);
+	}
+	sz += snprintf(page + sz, PAGE_SIZE - sz, "%s\n", sz ? "" : "none");
+	return sz;
+}
+
+/*
+ * A latency model replaces the fixed completion_nsec with a per-op-class
+ * latency distribution, so that IO stack changes can be validated against
+ * the multi-modal behavior of real devices (fast path, GC stalls, thermal
+ * throttle) instead of a single mode. The specification is one or two
+ * semicolon separated groups with an optional "read:" or "write:" prefix
+ * (an unprefixed group applies to both classes):
+ *
+ *	read:p50=8000,p99=120000,p99.9=2000000;write:p50=25000,p99=800000
+ *
+ * Samples below the first and above the last point clamp to it. Like
+ * completion_nsec, the model only takes effect in timer IRQ mode.
+ * Writing "none" or an empty string removes the model.
+ */
+static ssize_t nullb_device_lat_model_store(struct config_item *item,
+					    const char *page, size_t count)
+{
+	struct nullb_device *dev = to_nullb_device(item);
+	struct null_lat_model model[NULL_LAT_NR_CLASS] = {};
+	char *orig, *buf, *group;
+	int ret = 0;
+
+	if (test_bit(NULLB_DEV_FL_CONFIGURED, &dev->flags))
+		return -EBUSY;
+
+	orig = kstrndup(page, count, GFP_KERNEL);
+	if (!orig)
+		return -ENOMEM;
+
+	buf = strstrip(orig);
+	if (*buf && strcmp(buf, "none")) {
+		while ((group = strsep(&buf, ";")) != NULL) {
+			struct null_lat_model m = {};
+			int cl = -1;
+
+			if (!strncmp(group, "read:", 5)) {
+				cl = NULL_LAT_READ;
+				group += 5;
+			} else if (!strncmp(group, "write:", 6)) {
+				cl = NULL_LAT_WRITE;
+				group += 6;
+			}
+
+			ret = null_lat_parse_model(&m, group);
+			if (ret)
+				break;
+			if (cl < 0) {
+				model[NULL_LAT_READ] = m;
+				model[NULL_LAT_WRITE] = m;
+			} else {
+				model[cl] = m;
+			}
+		}
+	}
+
+	if (!ret)
+		memcpy(dev->lat_model, model, sizeof(model));
+	kfree(orig);
+	return ret ? ret : count;
+}
+CONFIGFS_ATTR(nullb_device_, lat_model);
+
+/*
+ * Achieved submission-to-completion latencies, one power-of-two bucketed
+ * histogram per op class. Each entry is <bucket floor in ns>:<count>.
+ * Writing anything clears the histograms.
+ */
+static ssize_t nullb_device_lat_histogram_show(struct config_item *item,
+					       char *page)
+{
+	struct nullb_device *dev = to_nullb_device(item);
+	ssize_t sz = 0;
+	int cl, i;
+
+	for (cl = 0; cl < NULL_LAT_NR_CLASS; cl++) {
+		sz += snprintf(page + sz, PAGE_SIZE - sz, "%s:",
+			       null_lat_class_names[cl]);
+		for (i = 0; i < NULL_LAT_HIST_BUCKETS; i++) {
+			u64 samples = atomic64_read(&dev->lat_hist[cl][i]);
+
+			if (!samples)
+				continue;
+			sz += snprintf(page + sz, PAGE_SIZE - sz, " %llu:%llu",
+				       1ULL << i, samples);
+		}
+		sz += snprintf(page + sz, PAGE_SIZE - sz, "\n");
+	}
+	return sz;
+}
+
+static ssize_t nullb_device_lat_histogram_store(struct config_item *item,
+						const char *page, size_t count)
+{
+	struct nullb_device *dev = to_nullb_device(item);
+
+	memset(dev->lat_hist, 0, sizeof(dev->lat_hist));
+	return count;
+}
+CONFIGFS_ATTR(nullb_device_, lat_histogram);
 
 static ssize_t nullb_device_power_show(struct config_item *item, char *page)
 {
@@ -614,6 +800,11 @@ static struct configfs_attribute *nullb_device_attrs[] = {
 	&nullb_device_attr_shared_tags,
 	&nullb_device_attr_shared_tag_bitmap,
 	&nullb_device_attr_fua,
+	&nullb_device_attr_lat_model,
+	&nullb_device_attr_lat_stall_nsec,
+	&nullb_device_attr_lat_stall_period_ms,
+	&nullb_device_attr_lat_stats,
+	&nullb_device_attr_lat_histogram,
 	NULL,
 };
 
@@ -694,7 +885,9 @@ static ssize_t memb_group_features_show(struct config_item *item, char *page)
 	return snprintf(page, PAGE_SIZE,
 			"badblocks,blocking,blocksize,cache_size,fua,"
 			"completion_nsec,discard,home_node,hw_queue_depth,"
-			"irqmode,max_sectors,mbps,memory_backed,no_sched,"
+			"irqmode,lat_histogram,lat_model,lat_stall_nsec,"
+			"lat_stall_period_ms,lat_stats,"
+			"max_sectors,mbps,memory_backed,no_sched,"
 			"poll_queues,power,queue_mode,shared_tag_bitmap,"
 			"shared_tags,size,submit_queues,use_per_node_hctx,"
 			"virt_boundary,zoned,zone_capacity,zone_max_active,"
@@ -799,17 +992,86 @@ static void null_free_dev(struct nullb_device *dev)
 	kfree(dev);
 }
 
+static inline enum null_lat_class null_lat_class(enum req_op op)
+{
+	return op == REQ_OP_READ ? NULL_LAT_READ : NULL_LAT_WRITE;
+}
+
+/*
+ * Draw a completion latency from the percentile table configured for the
+ * op class, falling back to the fixed completion_nsec when no model is
+ * loaded. An occasional stall is injected on top to mimic background
+ * device activity such as garbage collection, if configured.
+ */
+static u64 null_lat_sample(struct nullb_device *dev, enum req_op op)
+{
+	struct null_lat_model *model = &dev->lat_model[null_lat_class(op)];
+	u64 nsec;
+	u32 r;
+	int i;
+
+	if (!model->nr_points) {
+		nsec = dev->completion_nsec;
+	} else {
+		r = get_random_u32_below(10000);
+		if (r <= model->pct[0]) {
+			nsec = model->nsec[0];
+		} else if (r >= model->pct[model->nr_points - 1]) {
+			nsec = model->nsec[model->nr_points - 1];
+		} else {
+			for (i = 1; r > model->pct[i]; i++)
+				;
+			/* linear interpolation inside the segment */
+			nsec = model->nsec[i - 1] +
+				div_u64((model->nsec[i] - model->nsec[i - 1]) *
+					(u64)(r - model->pct[i - 1]),
+					model->pct[i] - model->pct[i - 1]);
+		}
+	}
+
+	if (dev->lat_stall_nsec && dev->lat_stall_period_ms) {
+		u64 now = ktime_get_ns();
+		u64 next = atomic64_read(&dev->lat_next_stall);
+
+		if (now >= next &&
+		    atomic64_cmpxchg(&dev->lat_next_stall, next,
+				now + dev->lat_stall_period_ms *
+				      NSEC_PER_MSEC) == next)
+			nsec += dev->lat_stall_nsec;
+	}
+
+	return nsec;
+}
+
+static void null_lat_account(struct nullb_cmd *cmd)
+{
+	struct nullb_device *dev = cmd->nq->dev;
+	struct request *rq = blk_mq_rq_from_pdu(cmd);
+	int bucket;
+	u64 delta;
+
+	if (!cmd->lat_start_ns)
+		return;
+
+	delta = ktime_get_ns() - cmd->lat_start_ns;
+	bucket = max(min_t(int, fls64(delta), NULL_LAT_HIST_BUCKETS) - 1, 0);
+	atomic64_inc(&dev->lat_hist[null_lat_class(req_op(rq))][bucket]);
+	cmd->lat_start_ns = 0;
+}
+
 static enum hrtimer_restart null_cmd_timer_expired(struct hrtimer *timer)
 {
 	struct nullb_cmd *cmd = container_of(timer, struct nullb_cmd, timer);
 
+	null_lat_account(cmd);
 	blk_mq_end_request(blk_mq_rq_from_pdu(cmd), cmd->error);
 	return HRTIMER_NORESTART;
 }
 
 static void null_cmd_end_timer(struct nullb_cmd *cmd)
 {
-	ktime_t kt = cmd->nq->dev->completion_nsec;
+	struct request *rq = blk_mq_rq_from_pdu(cmd);
+	ktime_t kt = null_lat_sample(cmd->nq->dev, req_op(rq));
 
 	hrtimer_start(&cmd->timer, kt, HRTIMER_MODE_REL);
 }
@@ -818,6 +1080,7 @@ static void null_complete_rq(struct request *rq)
 {
 	struct nullb_cmd *cmd = blk_mq_rq_to_pdu(rq);
 
+	null_lat_account(cmd);
 	blk_mq_end_request(rq, cmd->error);
 }
 
@@ -1338,6 +1601,7 @@ static inline void nullb_complete_cmd(struct nullb_cmd *cmd)
 		blk_mq_complete_request(rq);
 		break;
 	case NULL_IRQ_NONE:
+		null_lat_account(cmd);
 		blk_mq_end_request(rq, cmd->error);
 		break;
 	case NULL_IRQ_TIMER:
@@ -1533,6 +1797,7 @@ static int null_poll(struct blk_mq_hw_ctx *hctx, struct io_comp_batch *iob)
 		cmd = blk_mq_rq_to_pdu(req);
 		cmd->error = null_process_cmd(cmd, req_op(req), blk_rq_pos(req),
 						blk_rq_sectors(req));
+		null_lat_account(cmd);
 		if (!blk_mq_add_to_batch(req, iob, (__force int) cmd->error,
 					blk_mq_end_request_batch))
 			blk_mq_end_request(req, cmd->error);
@@ -1595,6 +1860,7 @@ static blk_status_t null_queue_rq(struct blk_mq_hw_ctx *hctx,
 	cmd->nq = nq;
 	cmd->fake_timeout = should_timeout_request(rq) ||
 		blk_should_fake_timeout(rq->q);
+	cmd->lat_start_ns = nq->dev->lat_stats ? ktime_get_ns() : 0;
 
 	if (should_requeue_request(rq)) {
 		/*
@@ -18,6 +18,7 @@
 struct nullb_cmd {
 	blk_status_t error;
 	bool fake_timeout;
+	u64 lat_start_ns; /* submission time, 0 if lat_stats is off */
 	struct nullb_queue *nq;
 	struct hrtimer timer;
 };
@@ -30,6 +31,25 @@ struct nullb_queue {
 	spinlock_t poll_lock;
 };
 
+#define NULL_LAT_POINTS_MAX	8
+#define NULL_LAT_HIST_BUCKETS	32
+
+enum null_lat_class {
+	NULL_LAT_READ = 0,
+	NULL_LAT_WRITE,		/* writes and all other ops */
+	NULL_LAT_NR_CLASS,
+};
+
+/*
+ * Completion latency model: a percentile table sampled with linear
+ * interpolation between points, see null_lat_sample().
+ */
+struct null_lat_model {
+	unsigned int nr_points;
+	unsigned int pct[NULL_LAT_POINTS_MAX]; /* percentile scaled by 100 */
+	unsigned long nsec[NULL_LAT_POINTS_MAX];
+};
+
 struct nullb_zone {
 	/*
 	 * Zone lock to prevent concurrent modification of a zone write
@@ -74,8 +94,14 @@ struct nullb_device {
 	bool need_zone_res_mgmt;
 	spinlock_t zone_res_lock;
 
+	struct null_lat_model lat_model[NULL_LAT_NR_CLASS];
+	atomic64_t lat_hist[NULL_LAT_NR_CLASS][NULL_LAT_HIST_BUCKETS];
+	atomic64_t lat_next_stall; /* time of the next injected stall */
+
 	unsigned long size; /* device size in MB */
 	unsigned long completion_nsec; /* time in ns to complete a request */
+	unsigned long lat_stall_nsec; /* duration of an injected stall */
+	unsigned long lat_stall_period_ms; /* how often to inject a stall */
 	unsigned long cache_size; /* disk cache size in MB */
 	unsigned long zone_size; /* zone size in MB if device is zoned */
 	unsigned long zone_capacity; /* zone capacity in MB if device is zoned */
@@ -106,6 +132,7 @@ struct nullb_device {
 	bool shared_tags; /* share tag set between devices for blk-mq */
 	bool shared_tag_bitmap; /* use hostwide shared tags */
 	bool fua; /* Support FUA */
+	bool lat_stats; /* collect completion latency histograms */
 };
 
 struct nullb {
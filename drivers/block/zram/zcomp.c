@@ -34,10 +34,60 @@ static const char * const backends[] = {
 #endif
 };
 
+#ifdef CONFIG_ZRAM_DICTIONARY
+/* mirrors the level the crypto zstd backend compresses with */
+#define ZCOMP_ZSTD_LEVEL	3
+
+static void zcomp_strm_free_dict(struct zcomp_strm *zstrm)
+{
+	vfree(zstrm->cctx_mem);
+	vfree(zstrm->dctx_mem);
+	zstrm->cctx_mem = NULL;
+	zstrm->dctx_mem = NULL;
+	zstrm->cctx = NULL;
+	zstrm->dctx = NULL;
+}
+
+/*
+ * Set up direct zstd contexts for dictionary compression. The crypto API
+ * cannot pass a dictionary down to its backends, so when a dictionary is
+ * loaded we drive the zstd library directly instead of going through ->tfm.
+ */
+static int zcomp_strm_init_dict(struct zcomp_strm *zstrm, struct zcomp *comp)
+{
+	zstd_parameters params = zstd_get_params(ZCOMP_ZSTD_LEVEL, PAGE_SIZE);
+	size_t sz;
+
+	sz = zstd_cctx_workspace_bound(&params.cParams);
+	zstrm->cctx_mem = vzalloc(sz);
+	zstrm->cctx = zstd_init_cctx(zstrm->cctx_mem, sz);
+
+	sz = zstd_dctx_workspace_bound();
+	zstrm->dctx_mem = vzalloc(sz);
+	zstrm->dctx = zstd_init_dctx(zstrm->dctx_mem, sz);
+
+	if (!zstrm->cctx || !zstrm->dctx) {
+		zcomp_strm_free_dict(zstrm);
+		return -ENOMEM;
+	}
+
+	zstrm->dict = comp->dict;
+	zstrm->dict_sz = comp->dict_sz;
+	return 0;
+}
+#else
+static void zcomp_strm_free_dict(struct zcomp_strm *zstrm) { }
+static int zcomp_strm_init_dict(struct zcomp_strm *zstrm, struct zcomp *comp)
+{
+	return -EINVAL;
+}
+#endif
+
 static void zcomp_strm_free(struct zcomp_strm *zstrm)
 {
 	if (!IS_ERR_OR_NULL(zstrm->tfm))
 		crypto_free_comp(zstrm->tfm);
+	zcomp_strm_free_dict(zstrm);
 	vfree(zstrm->buffer);
 	zstrm->tfm = NULL;
 	zstrm->buffer = NULL;
@@ -59,6 +109,10 @@ static int zcomp_strm_init(struct zcomp_strm *zstrm, struct zcomp *comp)
 		zcomp_strm_free(zstrm);
 		return -ENOMEM;
 	}
+	if (comp->dict_sz && zcomp_strm_init_dict(zstrm, comp)) {
+		zcomp_strm_free(zstrm);
+		return -ENOMEM;
+	}
 	return 0;
 }
 
@@ -134,6 +188,21 @@ int zcomp_compress(struct zcomp_strm *zstrm,
 	 */
 	*dst_len = PAGE_SIZE * 2;
 
+#ifdef CONFIG_ZRAM_DICTIONARY
+	if (zstrm->cctx) {
+		size_t sz;
+
+		sz = zstd_compress_using_dict(zstrm->cctx, zstrm->buffer,
+					      PAGE_SIZE * 2, src, PAGE_SIZE,
+					      zstrm->dict, zstrm->dict_sz,
+					      ZCOMP_ZSTD_LEVEL);
+		if (zstd_is_error(sz))
+			return -EINVAL;
+		*dst_len = sz;
+		return 0;
+	}
+#endif
+
 	return crypto_comp_compress(zstrm->tfm,
 			src, PAGE_SIZE,
 			zstrm->buffer, dst_len);
@@ -144,6 +213,17 @@ int zcomp_decompress(struct zcomp_strm *zstrm,
 {
 	unsigned int dst_len = PAGE_SIZE;
 
+#ifdef CONFIG_ZRAM_DICTIONARY
+	if (zstrm->dctx) {
+		size_t sz;
+
+		sz = zstd_decompress_using_dict(zstrm->dctx, dst, PAGE_SIZE,
+						src, src_len, zstrm->dict,
+						zstrm->dict_sz);
+		return zstd_is_error(sz) ? -EINVAL : 0;
+	}
+#endif
+
 	return crypto_comp_decompress(zstrm->tfm,
 			src, src_len,
 			dst, &dst_len);
@@ -206,8 +286,11 @@ void zcomp_destroy(struct zcomp *comp)
  * if requested algorithm is not supported, ERR_PTR(-ENOMEM) in
  * case of allocation error, or any other error potentially
  * returned by zcomp_init().
+ *
+ * An optional dictionary may be passed; it must stay alive for the
+ * whole lifetime of the zcomp and is only supported for "zstd".
  */
-struct zcomp *zcomp_create(const char *alg)
+struct zcomp *zcomp_create(const char *alg, const void *dict, size_t dict_sz)
 {
 	struct zcomp *comp;
 	int error;
@@ -220,11 +303,17 @@ struct zcomp *zcomp_create(const char *alg)
 	if (!zcomp_available_algorithm(alg))
 		return ERR_PTR(-EINVAL);
 
+	if (dict_sz &&
+	    (!IS_ENABLED(CONFIG_ZRAM_DICTIONARY) || strcmp(alg, "zstd")))
+		return ERR_PTR(-EINVAL);
+
 	comp = kzalloc(sizeof(struct zcomp), GFP_KERNEL);
 	if (!comp)
 		return ERR_PTR(-ENOMEM);
 
 	comp->name = alg;
+	comp->dict = dict;
+	comp->dict_sz = dict_sz;
 	error = zcomp_init(comp);
 	if (error) {
 		kfree(comp);
@@ -6,6 +6,9 @@
 #ifndef _ZCOMP_H_
 #define _ZCOMP_H_
 #include <linux/local_lock.h>
+#ifdef CONFIG_ZRAM_DICTIONARY
+#include <linux/zstd.h>
+#endif
 
 struct zcomp_strm {
 	/* The members ->buffer and ->tfm are protected by ->lock. */
@@ -13,12 +16,27 @@ struct zcomp_strm {
 	/* compression/decompression buffer */
 	void *buffer;
 	struct crypto_comp *tfm;
+#ifdef CONFIG_ZRAM_DICTIONARY
+	/*
+	 * Dictionary zstd contexts, used instead of ->tfm when the owning
+	 * zcomp has a dictionary loaded. The dictionary itself is owned by
+	 * the zram device and outlives the streams.
+	 */
+	zstd_cctx *cctx;
+	zstd_dctx *dctx;
+	void *cctx_mem;
+	void *dctx_mem;
+	const void *dict;
+	size_t dict_sz;
+#endif
 };
 
 /* dynamic per-device compression frontend */
 struct zcomp {
 	struct zcomp_strm __percpu *stream;
 	const char *name;
+	const void *dict;
+	size_t dict_sz;
 	struct hlist_node node;
 };
 
@@ -27,7 +45,7 @@ int zcomp_cpu_dead(unsigned int cpu, struct hlist_node *node);
 ssize_t zcomp_available_show(const char *comp, char *buf);
 bool zcomp_available_algorithm(const char *comp);
 
-struct zcomp *zcomp_create(const char *alg);
+struct zcomp *zcomp_create(const char *alg, const void *dict, size_t dict_sz);
 void zcomp_destroy(struct zcomp *comp);
 
 struct zcomp_strm *zcomp_stream_get(struct zcomp *comp);
@@ -18,6 +18,7 @@
 #include <linux/module.h>
 #include <linux/kernel.h>
 #include <linux/bio.h>
+#include <linux/bitmap.h>
 #include <linux/bitops.h>
 #include <linux/blkdev.h>
 #include <linux/buffer_head.h>
@@ -33,6 +34,7 @@
 #include <linux/debugfs.h>
 #include <linux/cpuhotplug.h>
 #include <linux/part_stat.h>
+#include <linux/kernel_read_file.h>
 
 #include "zram_drv.h"
 
@@ -542,20 +544,45 @@ out:
 	return err;
 }
 
-static unsigned long alloc_block_bdev(struct zram *zram)
+/*
+ * Allocate a run of up to @nr contiguous blocks on the backing device so
+ * that a batch of pages can be written out with a single large bio. If no
+ * run of @nr blocks is free, progressively settle for shorter runs.
+ * Returns the number of blocks allocated, with the first block index
+ * stored in @blk_start, or 0 if the backing device is full.
+ */
+static unsigned int alloc_block_bdev_range(struct zram *zram,
+					   unsigned long *blk_start,
+					   unsigned int nr)
 {
 	unsigned long blk_idx = 1;
+	unsigned int i;
 retry:
 	/* skip 0 bit to confuse zram.handle = 0 */
-	blk_idx = find_next_zero_bit(zram->bitmap, zram->nr_pages, blk_idx);
-	if (blk_idx == zram->nr_pages)
+	blk_idx = bitmap_find_next_zero_area(zram->bitmap, zram->nr_pages,
+					     blk_idx, nr, 0);
+	if (blk_idx + nr > zram->nr_pages) {
+		if (nr > 1) {
+			nr /= 2;
+			blk_idx = 1;
+			goto retry;
+		}
 		return 0;
+	}
 
-	if (test_and_set_bit(blk_idx, zram->bitmap))
-		goto retry;
+	for (i = 0; i < nr; i++) {
+		if (test_and_set_bit(blk_idx + i, zram->bitmap)) {
+			/* lost the race for a block, look further */
+			while (i--)
+				clear_bit(blk_idx + i, zram->bitmap);
+			blk_idx++;
+			goto retry;
+		}
+	}
 
-	atomic64_inc(&zram->stats.bd_count);
-	return blk_idx;
+	atomic64_add(nr, &zram->stats.bd_count);
+	*blk_start = blk_idx;
+	return nr;
 }
 
 static void free_block_bdev(struct zram *zram, unsigned long blk_idx)
@@ -586,18 +613,120 @@ static void read_from_bdev_async(struct zram *zram, struct page *page,
 #define IDLE_WRITEBACK			(1<<1)
 #define INCOMPRESSIBLE_WRITEBACK	(1<<2)
 
+/* number of pages written back with a single bio, at most */
+#define ZRAM_WB_BATCH			32
+
+static void zram_writeback_rollback(struct zram *zram, unsigned long index)
+{
+	zram_slot_lock(zram, index);
+	zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+	zram_clear_flag(zram, index, ZRAM_IDLE);
+	zram_slot_unlock(zram, index);
+}
+
+/*
+ * Write a batch of pages, already read out of their slots and marked
+ * ZRAM_UNDER_WB, to the backing device. Batching the pages lets us submit
+ * large bios over contiguous runs of backing blocks instead of one
+ * synchronous bio per page. Returns 0 on success or the most recent
+ * error, after rolling back the slots that were not written.
+ */
+static int zram_writeback_batch(struct zram *zram, struct page **pages,
+				unsigned long *indexes, unsigned int count)
+{
+	struct bio_vec bio_vecs[ZRAM_WB_BATCH];
+	struct bio bio;
+	unsigned long blk_start;
+	unsigned int done = 0, nr, i;
+	int ret = 0, err;
+
+	while (done < count) {
+		nr = alloc_block_bdev_range(zram, &blk_start, count - done);
+		if (!nr) {
+			for (i = done; i < count; i++)
+				zram_writeback_rollback(zram, indexes[i]);
+			return -ENOSPC;
+		}
+
+		bio_init(&bio, zram->bdev, bio_vecs, nr,
+			 REQ_OP_WRITE | REQ_SYNC);
+		bio.bi_iter.bi_sector = blk_start * (PAGE_SIZE >> 9);
+		for (i = 0; i < nr; i++)
+			__bio_add_page(&bio, pages[done + i], PAGE_SIZE, 0);
+
+		err = submit_bio_wait(&bio);
+		if (err) {
+			for (i = 0; i < nr; i++) {
+				zram_writeback_rollback(zram,
+							indexes[done + i]);
+				free_block_bdev(zram, blk_start + i);
+			}
+			/*
+			 * BIO errors are not fatal, we continue and simply
+			 * attempt to writeback the remaining objects (pages).
+			 * At the same time we need to signal user-space that
+			 * some writes (at least one, but also could be all of
+			 * them) were not successful and we do so by returning
+			 * the most recent BIO error.
+			 */
+			ret = err;
+			done += nr;
+			continue;
+		}
+
+		for (i = 0; i < nr; i++) {
+			unsigned long index = indexes[done + i];
+			unsigned long blk_idx = blk_start + i;
+
+			atomic64_inc(&zram->stats.bd_writes);
+			/*
+			 * We released zram_slot_lock so need to check if the
+			 * slot was changed. If there is freeing for the slot,
+			 * we can catch it easily by zram_allocated.
+			 * A subtle case is the slot is freed/reallocated/marked
+			 * as ZRAM_IDLE again. To close the race, idle_store
+			 * doesn't mark ZRAM_IDLE once it found the slot was
+			 * ZRAM_UNDER_WB. Thus, we could close the race by
+			 * checking ZRAM_IDLE bit.
+			 */
+			zram_slot_lock(zram, index);
+			if (!zram_allocated(zram, index) ||
+			    !zram_test_flag(zram, index, ZRAM_IDLE)) {
+				zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+				zram_clear_flag(zram, index, ZRAM_IDLE);
+				zram_slot_unlock(zram, index);
+				free_block_bdev(zram, blk_idx);
+				continue;
+			}
+
+			zram_free_page(zram, index);
+			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
+			zram_set_flag(zram, index, ZRAM_WB);
+			zram_set_element(zram, index, blk_idx);
+			zram_slot_unlock(zram, index);
+			atomic64_inc(&zram->stats.pages_stored);
+			spin_lock(&zram->wb_limit_lock);
+			if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
+				zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
+			spin_unlock(&zram->wb_limit_lock);
+		}
+		done += nr;
+	}
+
+	return ret;
+}
+
 static ssize_t writeback_store(struct device *dev,
 		struct device_attribute *attr, const char *buf, size_t len)
 {
 	struct zram *zram = dev_to_zram(dev);
 	unsigned long nr_pages = zram->disksize >> PAGE_SHIFT;
 	unsigned long index = 0;
-	struct bio bio;
-	struct bio_vec bio_vec;
-	struct page *page;
+	struct page *pages[ZRAM_WB_BATCH] = { NULL };
+	unsigned long indexes[ZRAM_WB_BATCH];
+	unsigned int nr_batched = 0, batch_max, i;
 	ssize_t ret = len;
 	int mode, err;
-	unsigned long blk_idx = 0;
 
 	if (sysfs_streq(buf, "idle"))
 		mode = IDLE_WRITEBACK;
@@ -630,28 +759,31 @@ static ssize_t writeback_store(struct device *dev,
 		goto release_init_lock;
 	}
 
-	page = alloc_page(GFP_KERNEL);
-	if (!page) {
-		ret = -ENOMEM;
-		goto release_init_lock;
+	for (i = 0; i < ZRAM_WB_BATCH; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i]) {
+			ret = -ENOMEM;
+			goto free_pages;
+		}
 	}
 
 	for (; nr_pages != 0; index++, nr_pages--) {
+		/*
+		 * The writeback limit is only charged once a batch is
+		 * written out, so cap the batch to what the limit still
+		 * allows instead of checking it page by page.
+		 */
 		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && !zram->bd_wb_limit) {
-			spin_unlock(&zram->wb_limit_lock);
+		if (zram->wb_limit_enable)
+			batch_max = min_t(u64, ZRAM_WB_BATCH,
+				zram->bd_wb_limit >> (PAGE_SHIFT - 12));
+		else
+			batch_max = ZRAM_WB_BATCH;
+		spin_unlock(&zram->wb_limit_lock);
+		if (!batch_max) {
 			ret = -EIO;
 			break;
 		}
-		spin_unlock(&zram->wb_limit_lock);
-
-		if (!blk_idx) {
-			blk_idx = alloc_block_bdev(zram);
-			if (!blk_idx) {
-				ret = -ENOSPC;
-				break;
-			}
-		}
 
 		zram_slot_lock(zram, index);
 		if (!zram_allocated(zram, index))
@@ -680,76 +812,36 @@ static ssize_t writeback_store(struct device *dev,
 		/* Need for hugepage writeback racing */
 		zram_set_flag(zram, index, ZRAM_IDLE);
 		zram_slot_unlock(zram, index);
-		if (zram_read_page(zram, page, index, NULL)) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
+		if (zram_read_page(zram, pages[nr_batched], index, NULL)) {
+			zram_writeback_rollback(zram, index);
 			continue;
 		}
 
-		bio_init(&bio, zram->bdev, &bio_vec, 1,
-			 REQ_OP_WRITE | REQ_SYNC);
-		bio.bi_iter.bi_sector = blk_idx * (PAGE_SIZE >> 9);
-		__bio_add_page(&bio, page, PAGE_SIZE, 0);
+		indexes[nr_batched++] = index;
+		if (nr_batched < batch_max)
+			continue;
 
-		/*
-		 * XXX: A single page IO would be inefficient for write
-		 * but it would be not bad as starter.
-		 */
-		err = submit_bio_wait(&bio);
+		err = zram_writeback_batch(zram, pages, indexes, nr_batched);
+		nr_batched = 0;
 		if (err) {
-			zram_slot_lock(zram, index);
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			zram_slot_unlock(zram, index);
-			/*
-			 * BIO errors are not fatal, we continue and simply
-			 * attempt to writeback the remaining objects (pages).
-			 * At the same time we need to signal user-space that
-			 * some writes (at least one, but also could be all of
-			 * them) were not successful and we do so by returning
-			 * the most recent BIO error.
-			 */
 			ret = err;
-			continue;
-		}
-
-		atomic64_inc(&zram->stats.bd_writes);
-		/*
-		 * We released zram_slot_lock so need to check if the slot was
-		 * changed. If there is freeing for the slot, we can catch it
-		 * easily by zram_allocated.
-		 * A subtle case is the slot is freed/reallocated/marked as
-		 * ZRAM_IDLE again. To close the race, idle_store doesn't
-		 * mark ZRAM_IDLE once it found the slot was ZRAM_UNDER_WB.
-		 * Thus, we could close the race by checking ZRAM_IDLE bit.
-		 */
-		zram_slot_lock(zram, index);
-		if (!zram_allocated(zram, index) ||
-			  !zram_test_flag(zram, index, ZRAM_IDLE)) {
-			zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-			zram_clear_flag(zram, index, ZRAM_IDLE);
-			goto next;
+			if (err == -ENOSPC)
+				break;
 		}
-
-		zram_free_page(zram, index);
-		zram_clear_flag(zram, index, ZRAM_UNDER_WB);
-		zram_set_flag(zram, index, ZRAM_WB);
-		zram_set_element(zram, index, blk_idx);
-		blk_idx = 0;
-		atomic64_inc(&zram->stats.pages_stored);
-		spin_lock(&zram->wb_limit_lock);
-		if (zram->wb_limit_enable && zram->bd_wb_limit > 0)
-			zram->bd_wb_limit -=  1UL << (PAGE_SHIFT - 12);
-		spin_unlock(&zram->wb_limit_lock);
+		continue;
 next:
 		zram_slot_unlock(zram, index);
 	}
 
-	if (blk_idx)
-		free_block_bdev(zram, blk_idx);
-	__free_page(page);
+	if (nr_batched) {
+		err = zram_writeback_batch(zram, pages, indexes, nr_batched);
+		if (err)
+			ret = err;
+	}
+free_pages:
+	for (i = 0; i < ZRAM_WB_BATCH; i++)
+		if (pages[i])
+			__free_page(pages[i]);
 release_init_lock:
 	up_read(&zram->init_lock);
 
@@ -1019,6 +1111,95 @@ static ssize_t comp_algorithm_store(struct device *dev,
 	return ret ? ret : len;
 }
 
+#ifdef CONFIG_ZRAM_DICTIONARY
+/* generous limit, trained dictionaries are usually way below 128K */
+#define ZRAM_DICT_MAX_SZ	(1UL << 20)
+
+static void zram_reset_dict(struct zram *zram)
+{
+	vfree(zram->dict);
+	zram->dict = NULL;
+	zram->dict_sz = 0;
+}
+
+static ssize_t dictionary_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct zram *zram = dev_to_zram(dev);
+	ssize_t sz;
+
+	down_read(&zram->init_lock);
+	if (zram->dict_sz)
+		sz = scnprintf(buf, PAGE_SIZE, "%zu\n", zram->dict_sz);
+	else
+		sz = scnprintf(buf, PAGE_SIZE, "none\n");
+	up_read(&zram->init_lock);
+
+	return sz;
+}
+
+/*
+ * Takes a path to a dictionary trained in userspace (e.g. `zstd --train`)
+ * on pages representative of the expected workload, or "none" to drop the
+ * current dictionary. Like the compression algorithm, the dictionary can
+ * only be changed before the device is initialized, so re-training boils
+ * down to reset, write a new dictionary, re-init.
+ */
+static ssize_t dictionary_store(struct device *dev,
+		struct device_attribute *attr, const char *buf, size_t len)
+{
+	struct zram *zram = dev_to_zram(dev);
+	char *file_name;
+	void *dict = NULL;
+	ssize_t dict_sz = 0;
+	size_t sz;
+	int err;
+
+	file_name = kmalloc(PATH_MAX, GFP_KERNEL);
+	if (!file_name)
+		return -ENOMEM;
+
+	strscpy(file_name, buf, PATH_MAX);
+	/* ignore trailing newline */
+	sz = strlen(file_name);
+	if (sz > 0 && file_name[sz - 1] == '\n')
+		file_name[sz - 1] = 0x00;
+
+	if (strcmp(file_name, "none")) {
+		dict_sz = kernel_read_file_from_path(file_name, 0, &dict,
+						     ZRAM_DICT_MAX_SZ, NULL,
+						     READING_UNKNOWN);
+		if (dict_sz <= 0) {
+			err = dict_sz ? dict_sz : -EINVAL;
+			goto out;
+		}
+	}
+
+	down_write(&zram->init_lock);
+	if (init_done(zram)) {
+		up_write(&zram->init_lock);
+		pr_info("Can't change dictionary for initialized device\n");
+		err = -EBUSY;
+		goto out;
+	}
+
+	zram_reset_dict(zram);
+	zram->dict = dict;
+	zram->dict_sz = dict_sz;
+	dict = NULL;
+	up_write(&zram->init_lock);
+	err = 0;
+out:
+	vfree(dict);
+	kfree(file_name);
+	return err ? err : len;
+}
+#else
+static void zram_reset_dict(struct zram *zram)
+{
+}
+#endif
+
 #ifdef CONFIG_ZRAM_MULTI_COMP
 static ssize_t recomp_algorithm_show(struct device *dev,
 				     struct device_attribute *attr,
@@ -2011,6 +2192,7 @@ static void zram_reset_device(struct zram *zram)
 	zram_destroy_comps(zram);
 	memset(&zram->stats, 0, sizeof(zram->stats));
 	reset_bdev(zram);
+	zram_reset_dict(zram);
 
 	comp_algorithm_set(zram, ZRAM_PRIMARY_COMP, default_compressor);
 	up_write(&zram->init_lock);
@@ -2043,10 +2225,20 @@ static ssize_t disksize_store(struct device *dev,
 	}
 
 	for (prio = 0; prio < ZRAM_MAX_COMPS; prio++) {
+		const void *dict = NULL;
+		size_t dict_sz = 0;
+
 		if (!zram->comp_algs[prio])
 			continue;
 
-		comp = zcomp_create(zram->comp_algs[prio]);
+#ifdef CONFIG_ZRAM_DICTIONARY
+		/* only the primary compressor uses the dictionary */
+		if (prio == ZRAM_PRIMARY_COMP) {
+			dict = zram->dict;
+			dict_sz = zram->dict_sz;
+		}
+#endif
+		comp = zcomp_create(zram->comp_algs[prio], dict, dict_sz);
 		if (IS_ERR(comp)) {
 			pr_err("Cannot initialise %s compressing backend\n",
 			       zram->comp_algs[prio]);
@@ -2149,6 +2341,9 @@ static DEVICE_ATTR_RW(writeback_limit_enable);
 static DEVICE_ATTR_RW(recomp_algorithm);
 static DEVICE_ATTR_WO(recompress);
 #endif
+#ifdef CONFIG_ZRAM_DICTIONARY
+static DEVICE_ATTR_RW(dictionary);
+#endif
 
 static struct attribute *zram_disk_attrs[] = {
 	&dev_attr_disksize.attr,
@@ -2175,6 +2370,9 @@ static struct attribute *zram_disk_attrs[] = {
 #ifdef CONFIG_ZRAM_MULTI_COMP
 	&dev_attr_recomp_algorithm.attr,
 	&dev_attr_recompress.attr,
+#endif
+#ifdef CONFIG_ZRAM_DICTIONARY
+	&dev_attr_dictionary.attr,
 #endif
 	NULL,
 };
@@ -2311,6 +2509,8 @@ static int zram_remove(struct zram *zram)
 	 */
 	zram_reset_device(zram);
 
+	/* a dictionary may be loaded even on an uninitialized device */
+	zram_reset_dict(zram);
 	put_disk(zram->disk);
 	kfree(zram);
 	return 0;
@@ -123,6 +123,11 @@ struct zram {
 	u64 disksize;	/* bytes */
 	const char *comp_algs[ZRAM_MAX_COMPS];
 	s8 num_active_comps;
+#ifdef CONFIG_ZRAM_DICTIONARY
+	/* compression dictionary used by the primary compressor */
+	void *dict;
+	size_t dict_sz;
+#endif
 	/*
 	 * zram is claimed so open request will be failed
 	 */
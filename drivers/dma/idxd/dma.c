@@ -132,6 +132,166 @@ idxd_dma_submit_memcpy(struct dma_chan *c, dma_addr_t dma_dest,
 	return &desc->txd;
 }
 
+/* Context for an in-flight batch descriptor, freed on completion. */
+struct idxd_batch {
+	struct dsa_hw_desc *descs;
+	struct dsa_completion_record *comps;
+	dma_addr_t descs_dma;
+	size_t size;
+	unsigned int nr;
+	struct device *dev;
+	dma_async_tx_callback_result cb;
+	void *cb_param;
+};
+
+static void idxd_dma_batch_complete(void *param,
+				    const struct dmaengine_result *res)
+{
+	struct idxd_batch *batch = param;
+
+	if (batch->cb)
+		batch->cb(batch->cb_param, res);
+	dma_free_coherent(batch->dev, batch->size, batch->descs,
+			  batch->descs_dma);
+	kfree(batch);
+}
+
+static char idxd_batch_op_to_opcode(const struct idxd_batch_op *op)
+{
+	return op->type == IDXD_BATCH_OP_MEMFILL ? DSA_OPCODE_MEMFILL :
+						   DSA_OPCODE_MEMMOVE;
+}
+
+/**
+ * idxd_dma_submit_batch - submit a list of memory operations as one batch
+ * @c: dmaengine channel backed by a DSA work queue
+ * @ops: array of memcpy/memfill operations to perform
+ * @nr_ops: number of entries in @ops, at most the device max batch size
+ * @cb: completion callback, invoked once when the whole batch is done
+ * @cb_param: argument passed to @cb
+ *
+ * The operations are submitted as a single DSA batch descriptor, so the
+ * whole list costs one descriptor write and raises one completion
+ * interrupt. A single-entry list is submitted as a plain descriptor since
+ * the hardware requires at least two descriptors per batch. The addresses
+ * in @ops must already be DMA mapped against the channel's device.
+ *
+ * Returns the assigned cookie on success or a negative errno.
+ */
+dma_cookie_t idxd_dma_submit_batch(struct dma_chan *c,
+				   const struct idxd_batch_op *ops,
+				   unsigned int nr_ops,
+				   dma_async_tx_callback_result cb,
+				   void *cb_param)
+{
+	struct idxd_wq *wq = to_idxd_wq(c);
+	struct idxd_device *idxd = wq->idxd;
+	struct idxd_batch *batch = NULL;
+	struct idxd_desc *desc;
+	dma_cookie_t cookie;
+	u32 desc_flags;
+	unsigned int i;
+
+	if (wq->state != IDXD_WQ_ENABLED)
+		return -ENXIO;
+
+	if (!nr_ops || nr_ops > idxd->max_batch_size)
+		return -EINVAL;
+
+	if (nr_ops > 1 && !(idxd->hw.opcap.bits[0] & IDXD_OPCAP_BATCH))
+		return -EOPNOTSUPP;
+
+	for (i = 0; i < nr_ops; i++) {
+		if (!ops[i].len || ops[i].len > idxd->max_xfer_bytes)
+			return -EINVAL;
+		if (ops[i].type == IDXD_BATCH_OP_MEMFILL &&
+		    !(idxd->hw.opcap.bits[0] & IDXD_OPCAP_MEMFILL))
+			return -EOPNOTSUPP;
+	}
+
+	op_flag_setup(DMA_PREP_INTERRUPT, &desc_flags);
+
+	if (nr_ops > 1) {
+		batch = kzalloc(sizeof(*batch), GFP_NOWAIT);
+		if (!batch)
+			return -ENOMEM;
+
+		batch->nr = nr_ops;
+		batch->dev = &idxd->pdev->dev;
+		batch->cb = cb;
+		batch->cb_param = cb_param;
+		batch->size = nr_ops * (sizeof(struct dsa_hw_desc) +
+					sizeof(struct dsa_completion_record));
+		batch->descs = dma_alloc_coherent(batch->dev, batch->size,
+						  &batch->descs_dma,
+						  GFP_NOWAIT);
+		if (!batch->descs) {
+			kfree(batch);
+			return -ENOMEM;
+		}
+		batch->comps = (struct dsa_completion_record *)
+			       &batch->descs[nr_ops];
+
+		for (i = 0; i < nr_ops; i++) {
+			dma_addr_t comp_dma = batch->descs_dma +
+				nr_ops * sizeof(struct dsa_hw_desc) +
+				i * sizeof(struct dsa_completion_record);
+
+			/*
+			 * Sub-descriptors must have a completion record so
+			 * that a partially completed batch can be diagnosed,
+			 * but must not request an interrupt of their own.
+			 */
+			idxd_prep_desc_common(wq, &batch->descs[i],
+					      idxd_batch_op_to_opcode(&ops[i]),
+					      ops[i].type == IDXD_BATCH_OP_MEMFILL ?
+						      ops[i].pattern : ops[i].src,
+					      ops[i].dst, ops[i].len, comp_dma,
+					      IDXD_OP_FLAG_CRAV | IDXD_OP_FLAG_RCR);
+		}
+	}
+
+	desc = idxd_alloc_desc(wq, IDXD_OP_NONBLOCK);
+	if (IS_ERR(desc)) {
+		cookie = PTR_ERR(desc);
+		goto err_free_batch;
+	}
+
+	if (batch) {
+		/* desc_list_addr and desc_count alias src_addr and xfer_size */
+		idxd_prep_desc_common(wq, desc->hw, DSA_OPCODE_BATCH,
+				      batch->descs_dma, 0, nr_ops,
+				      desc->compl_dma, desc_flags);
+		desc->txd.callback_result = idxd_dma_batch_complete;
+		desc->txd.callback_param = batch;
+	} else {
+		idxd_prep_desc_common(wq, desc->hw,
+				      idxd_batch_op_to_opcode(&ops[0]),
+				      ops[0].type == IDXD_BATCH_OP_MEMFILL ?
+					      ops[0].pattern : ops[0].src,
+				      ops[0].dst, ops[0].len, desc->compl_dma,
+				      desc_flags);
+		desc->txd.callback_result = cb;
+		desc->txd.callback_param = cb_param;
+	}
+	desc->txd.flags = DMA_PREP_INTERRUPT;
+
+	cookie = dmaengine_submit(&desc->txd);
+	if (cookie < 0)
+		goto err_free_batch;
+
+	return cookie;
+
+err_free_batch:
+	if (batch) {
+		dma_free_coherent(batch->dev, batch->size, batch->descs,
+				  batch->descs_dma);
+		kfree(batch);
+	}
+	return cookie;
+}
+EXPORT_SYMBOL_NS_GPL(idxd_dma_submit_batch, IDXD);
+
 static int idxd_dma_alloc_chan_resources(struct dma_chan *chan)
 {
 	struct idxd_wq *wq = to_idxd_wq(chan);
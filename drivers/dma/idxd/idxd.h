@@ -788,6 +788,34 @@ int idxd_enqcmds(struct idxd_wq *wq, void __iomem *portal, const void *desc);
 int idxd_register_dma_device(struct idxd_device *idxd);
 void idxd_unregister_dma_device(struct idxd_device *idxd);
 
+/* batched memory operations */
+enum idxd_batch_op_type {
+	IDXD_BATCH_OP_MEMCPY = 0,
+	IDXD_BATCH_OP_MEMFILL,
+};
+
+/*
+ * One element of a batch submitted through idxd_dma_submit_batch(). For
+ * IDXD_BATCH_OP_MEMCPY, @src is the DMA address of the source buffer; for
+ * IDXD_BATCH_OP_MEMFILL, @pattern is the 64-bit fill pattern. @dst and @len
+ * must be valid for either type.
+ */
+struct idxd_batch_op {
+	enum idxd_batch_op_type type;
+	union {
+		dma_addr_t src;
+		u64 pattern;
+	};
+	dma_addr_t dst;
+	size_t len;
+};
+
+dma_cookie_t idxd_dma_submit_batch(struct dma_chan *c,
+				   const struct idxd_batch_op *ops,
+				   unsigned int nr_ops,
+				   dma_async_tx_callback_result cb,
+				   void *cb_param);
+
 /* cdev */
 int idxd_cdev_register(void);
 void idxd_cdev_remove(void);
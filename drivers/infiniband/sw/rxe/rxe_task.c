@@ -4,6 +4,8 @@
  * Copyright (c) 2015 System Fabric Works, Inc. All rights reserved.
  */
 
+#include <linux/hash.h>
+
 #include "rxe.h"
 
 static struct workqueue_struct *rxe_wq;
@@ -195,6 +197,11 @@ int rxe_init_task(struct rxe_task *task, struct rxe_qp *qp,
 	task->qp = qp;
 	task->func = func;
 	task->state = TASK_STATE_IDLE;
+	/* hash the qpn to a cpu so that the load from many QPs spreads
+	 * over the online cpus while all tasks of one QP stay local
+	 */
+	task->cpu = cpumask_nth(hash_32(qp_num(qp), 32) % num_online_cpus(),
+				cpu_online_mask);
 	spin_lock_init(&task->lock);
 	INIT_WORK(&task->work, do_work);
 
@@ -264,7 +271,8 @@ void rxe_sched_task(struct rxe_task *task)
 
 	spin_lock_irqsave(&task->lock, flags);
 	if (__reserve_if_idle(task))
-		queue_work(rxe_wq, &task->work);
+		queue_work_on(cpu_online(task->cpu) ? task->cpu :
+			      WORK_CPU_UNBOUND, rxe_wq, &task->work);
 	spin_unlock_irqrestore(&task->lock, flags);
 }
 
@@ -25,6 +25,11 @@ struct rxe_task {
 	struct work_struct	work;
 	int			state;
 	spinlock_t		lock;
+	/* CPU the task is steered to. All three tasks of a QP share it,
+	 * so processing for one QP stays local to one CPU while
+	 * different QPs spread across the online CPUs.
+	 */
+	int			cpu;
 	struct rxe_qp		*qp;
 	int			(*func)(struct rxe_qp *qp);
 	int			ret;
@@ -11,6 +11,7 @@
 #include <linux/acpi_iort.h>
 #include <linux/atomic.h>
 #include <linux/crash_dump.h>
+#include <linux/debugfs.h>
 #include <linux/device.h>
 #include <linux/dma-direct.h>
 #include <linux/dma-map-ops.h>
@@ -26,6 +27,8 @@
 #include <linux/of_iommu.h>
 #include <linux/pci.h>
 #include <linux/scatterlist.h>
+#include <linux/sched/clock.h>
+#include <linux/seq_file.h>
 #include <linux/spinlock.h>
 #include <linux/swiotlb.h>
 #include <linux/vmalloc.h>
@@ -75,6 +78,17 @@ struct iommu_dma_cookie {
 			struct timer_list	fq_timer;
 			/* 1 when timer is active, 0 when not */
 			atomic_t		fq_timer_on;
+			/* Adaptive flush interval, in jiffies */
+			unsigned long		fq_timeout_jiffies;
+			/* EWMA of flush_iotlb_all() latency, in ns */
+			u64			fq_flush_lat_ns;
+			/* Flushes forced by a full queue */
+			atomic64_t		fq_flush_full_cnt;
+			/* Flushes driven by the timer */
+			atomic64_t		fq_flush_timer_cnt;
+#ifdef CONFIG_IOMMU_DEBUGFS
+			struct dentry		*fq_debugfs;
+#endif
 		};
 		/* Trivial linear page allocator for IOMMU_DMA_MSI_COOKIE */
 		dma_addr_t		msi_iova;
@@ -177,9 +191,29 @@ static void fq_ring_free(struct iommu_dma_cookie *cookie, struct iova_fq *fq)
 
 static void fq_flush_iotlb(struct iommu_dma_cookie *cookie)
 {
+	u64 lat, ewma, start = local_clock();
+	unsigned long interval;
+
 	atomic64_inc(&cookie->fq_flush_start_cnt);
 	cookie->fq_domain->ops->flush_iotlb_all(cookie->fq_domain);
 	atomic64_inc(&cookie->fq_flush_finish_cnt);
+
+	/*
+	 * Track invalidation latency and adapt the flush interval to it:
+	 * flush often enough that the amortized invalidation cost stays
+	 * around 1% of one CPU, clamped to the queue type's static timeout
+	 * as the upper bound.  Cheap invalidation hardware thus gets a
+	 * near-strict window while expensive hardware keeps today's
+	 * batching.  Updates are racy but purely advisory.
+	 */
+	lat = local_clock() - start;
+	ewma = READ_ONCE(cookie->fq_flush_lat_ns);
+	ewma += (s64)(lat - ewma) >> 3;
+	WRITE_ONCE(cookie->fq_flush_lat_ns, ewma);
+
+	interval = clamp(nsecs_to_jiffies(ewma * 100), 1UL,
+			 msecs_to_jiffies(cookie->options.fq_timeout));
+	WRITE_ONCE(cookie->fq_timeout_jiffies, interval);
 }
 
 static void fq_flush_timeout(struct timer_list *t)
@@ -188,6 +222,7 @@ static void fq_flush_timeout(struct timer_list *t)
 	int cpu;
 
 	atomic_set(&cookie->fq_timer_on, 0);
+	atomic64_inc(&cookie->fq_flush_timer_cnt);
 	fq_flush_iotlb(cookie);
 
 	if (cookie->options.qt == IOMMU_DMA_OPTS_SINGLE_QUEUE) {
@@ -230,6 +265,7 @@ static void queue_iova(struct iommu_dma_cookie *cookie,
 	fq_ring_free_locked(cookie, fq);
 
 	if (fq_full(fq)) {
+		atomic64_inc(&cookie->fq_flush_full_cnt);
 		fq_flush_iotlb(cookie);
 		fq_ring_free_locked(cookie, fq);
 	}
@@ -247,7 +283,7 @@ static void queue_iova(struct iommu_dma_cookie *cookie,
 	if (!atomic_read(&cookie->fq_timer_on) &&
 	    !atomic_xchg(&cookie->fq_timer_on, 1))
 		mod_timer(&cookie->fq_timer,
-			  jiffies + msecs_to_jiffies(cookie->options.fq_timeout));
+			  jiffies + READ_ONCE(cookie->fq_timeout_jiffies));
 }
 
 static void iommu_dma_free_fq_single(struct iova_fq *fq)
@@ -274,11 +310,58 @@ static void iommu_dma_free_fq_percpu(struct iova_fq __percpu *percpu_fq)
 	free_percpu(percpu_fq);
 }
 
+#ifdef CONFIG_IOMMU_DEBUGFS
+static int iommu_dma_fq_stats_show(struct seq_file *m, void *unused)
+{
+	struct iommu_dma_cookie *cookie = m->private;
+
+	seq_printf(m, "flushes: %lld\n",
+		   atomic64_read(&cookie->fq_flush_start_cnt));
+	seq_printf(m, "queue_full_flushes: %lld\n",
+		   atomic64_read(&cookie->fq_flush_full_cnt));
+	seq_printf(m, "timer_flushes: %lld\n",
+		   atomic64_read(&cookie->fq_flush_timer_cnt));
+	seq_printf(m, "avg_flush_ns: %llu\n",
+		   READ_ONCE(cookie->fq_flush_lat_ns));
+	seq_printf(m, "flush_interval_ms: %u\n",
+		   jiffies_to_msecs(READ_ONCE(cookie->fq_timeout_jiffies)));
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(iommu_dma_fq_stats);
+
+static void iommu_dma_fq_debugfs_init(struct iommu_dma_cookie *cookie)
+{
+	static atomic_t instance;
+	char name[32];
+
+	if (!iommu_debugfs_dir)
+		return;
+
+	snprintf(name, sizeof(name), "dma-fq-%d", atomic_inc_return(&instance));
+	cookie->fq_debugfs = debugfs_create_file(name, 0400, iommu_debugfs_dir,
+						 cookie, &iommu_dma_fq_stats_fops);
+}
+
+static void iommu_dma_fq_debugfs_exit(struct iommu_dma_cookie *cookie)
+{
+	debugfs_remove(cookie->fq_debugfs);
+}
+#else
+static void iommu_dma_fq_debugfs_init(struct iommu_dma_cookie *cookie)
+{
+}
+
+static void iommu_dma_fq_debugfs_exit(struct iommu_dma_cookie *cookie)
+{
+}
+#endif
+
 static void iommu_dma_free_fq(struct iommu_dma_cookie *cookie)
 {
 	if (!cookie->fq_domain)
 		return;
 
+	iommu_dma_fq_debugfs_exit(cookie);
 	del_timer_sync(&cookie->fq_timer);
 	if (cookie->options.qt == IOMMU_DMA_OPTS_SINGLE_QUEUE)
 		iommu_dma_free_fq_single(cookie->single_fq);
@@ -342,6 +425,10 @@ int iommu_dma_init_fq(struct iommu_domain *domain)
 
 	atomic64_set(&cookie->fq_flush_start_cnt,  0);
 	atomic64_set(&cookie->fq_flush_finish_cnt, 0);
+	atomic64_set(&cookie->fq_flush_full_cnt,   0);
+	atomic64_set(&cookie->fq_flush_timer_cnt,  0);
+	cookie->fq_flush_lat_ns = 0;
+	cookie->fq_timeout_jiffies = msecs_to_jiffies(cookie->options.fq_timeout);
 
 	if (cookie->options.qt == IOMMU_DMA_OPTS_SINGLE_QUEUE)
 		rc = iommu_dma_init_fq_single(cookie);
@@ -355,6 +442,7 @@ int iommu_dma_init_fq(struct iommu_domain *domain)
 
 	timer_setup(&cookie->fq_timer, fq_flush_timeout, 0);
 	atomic_set(&cookie->fq_timer_on, 0);
+	iommu_dma_fq_debugfs_init(cookie);
 	/*
 	 * Prevent incomplete fq state being observable. Pairs with path from
 	 * __iommu_dma_unmap() through iommu_dma_free_iova() to queue_iova()
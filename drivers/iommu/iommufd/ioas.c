@@ -232,6 +232,69 @@ out_put:
 	return rc;
 }
 
+int iommufd_ioas_map_vec(struct iommufd_ucmd *ucmd)
+{
+	struct iommu_ioas_map_vec *cmd = ucmd->cmd;
+	struct iommu_ioas_map_elem __user *uelems =
+		u64_to_user_ptr(cmd->elems_uptr);
+	struct iommufd_ioas *ioas;
+	unsigned int flags = 0;
+	u32 done;
+	int rc = 0;
+
+	if ((cmd->flags &
+	     ~(IOMMU_IOAS_MAP_FIXED_IOVA | IOMMU_IOAS_MAP_WRITEABLE |
+	       IOMMU_IOAS_MAP_READABLE)) ||
+	    cmd->num_mapped || cmd->__reserved)
+		return -EOPNOTSUPP;
+	if (!cmd->num_elems)
+		return -EINVAL;
+
+	ioas = iommufd_get_ioas(ucmd->ictx, cmd->ioas_id);
+	if (IS_ERR(ioas))
+		return PTR_ERR(ioas);
+
+	if (!(cmd->flags & IOMMU_IOAS_MAP_FIXED_IOVA))
+		flags = IOPT_ALLOC_IOVA;
+
+	for (done = 0; done < cmd->num_elems; done++) {
+		struct iommu_ioas_map_elem elem;
+		unsigned long iova;
+
+		if (copy_from_user(&elem, &uelems[done], sizeof(elem))) {
+			rc = -EFAULT;
+			break;
+		}
+		if (elem.iova >= ULONG_MAX || elem.length >= ULONG_MAX) {
+			rc = -EOVERFLOW;
+			break;
+		}
+
+		iova = elem.iova;
+		rc = iopt_map_user_pages(ucmd->ictx, &ioas->iopt, &iova,
+					 u64_to_user_ptr(elem.user_va),
+					 elem.length,
+					 conv_iommu_prot(cmd->flags), flags);
+		if (rc)
+			break;
+
+		elem.iova = iova;
+		if (copy_to_user(&uelems[done], &elem, sizeof(elem))) {
+			/* The range is established regardless */
+			done++;
+			rc = -EFAULT;
+			break;
+		}
+	}
+
+	/* Report partial progress even on failure */
+	cmd->num_mapped = done;
+	if (iommufd_ucmd_respond(ucmd, sizeof(*cmd)) && !rc)
+		rc = -EFAULT;
+	iommufd_put_object(ucmd->ictx, &ioas->obj);
+	return rc;
+}
+
 int iommufd_ioas_copy(struct iommufd_ucmd *ucmd)
 {
 	struct iommu_ioas_copy *cmd = ucmd->cmd;
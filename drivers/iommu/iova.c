@@ -11,6 +11,7 @@
 #include <linux/smp.h>
 #include <linux/bitops.h>
 #include <linux/cpu.h>
+#include <linux/topology.h>
 #include <linux/workqueue.h>
 
 /* The anchor node sits above the top of the usable address space */
@@ -581,10 +582,24 @@ struct iova_cpu_rcache {
 	struct iova_magazine *prev;
 };
 
-struct iova_rcache {
+/*
+ * Intermediate per-node magazine tier between the CPU caches and the
+ * rbtree.  The trim worker adapts how many magazines each node retains
+ * from the misses seen since the last trim, so a depot deepens while a
+ * size class keeps running dry and shrinks back once it goes quiet.
+ */
+struct iova_depot {
 	spinlock_t lock;
-	unsigned int depot_size;
-	struct iova_magazine *depot;
+	struct iova_magazine *head;
+	unsigned int size;
+	/* Empty-depot events since the last trim */
+	unsigned int misses;
+	/* Number of magazines the trim worker leaves behind */
+	unsigned int target;
+};
+
+struct iova_rcache {
+	struct iova_depot *depots;
 	struct iova_cpu_rcache __percpu *cpu_rcaches;
 	struct iova_domain *iovad;
 	struct delayed_work work;
@@ -669,45 +684,64 @@ static void iova_magazine_push(struct iova_magazine *mag, unsigned long pfn)
 	mag->pfns[mag->size++] = pfn;
 }
 
-static struct iova_magazine *iova_depot_pop(struct iova_rcache *rcache)
+static struct iova_magazine *iova_depot_pop(struct iova_depot *depot)
 {
-	struct iova_magazine *mag = rcache->depot;
+	struct iova_magazine *mag = depot->head;
 
-	rcache->depot = mag->next;
+	depot->head = mag->next;
 	mag->size = IOVA_MAG_SIZE;
-	rcache->depot_size--;
+	depot->size--;
 	return mag;
 }
 
-static void iova_depot_push(struct iova_rcache *rcache, struct iova_magazine *mag)
+static void iova_depot_push(struct iova_depot *depot, struct iova_magazine *mag)
 {
-	mag->next = rcache->depot;
-	rcache->depot = mag;
-	rcache->depot_size++;
+	mag->next = depot->head;
+	depot->head = mag;
+	depot->size++;
 }
 
 static void iova_depot_work_func(struct work_struct *work)
 {
 	struct iova_rcache *rcache = container_of(work, typeof(*rcache), work.work);
-	struct iova_magazine *mag = NULL;
+	bool again = false;
 	unsigned long flags;
+	int nid;
+
+	for_each_node(nid) {
+		struct iova_depot *depot = &rcache->depots[nid];
+		unsigned int base = max_t(unsigned int, nr_cpus_node(nid), 1);
+		struct iova_magazine *mag = NULL;
+
+		spin_lock_irqsave(&depot->lock, flags);
+		/* Deepen the reserve while the depot keeps running dry */
+		if (depot->misses)
+			depot->target = min(depot->target * 2, base * 8);
+		else if (depot->target > base)
+			depot->target /= 2;
+		depot->misses = 0;
+
+		if (depot->size > depot->target) {
+			mag = iova_depot_pop(depot);
+			if (depot->size > depot->target)
+				again = true;
+		}
+		spin_unlock_irqrestore(&depot->lock, flags);
 
-	spin_lock_irqsave(&rcache->lock, flags);
-	if (rcache->depot_size > num_online_cpus())
-		mag = iova_depot_pop(rcache);
-	spin_unlock_irqrestore(&rcache->lock, flags);
+		if (mag) {
+			iova_magazine_free_pfns(mag, rcache->iovad);
+			iova_magazine_free(mag);
+		}
+	}
 
-	if (mag) {
-		iova_magazine_free_pfns(mag, rcache->iovad);
-		iova_magazine_free(mag);
+	if (again)
 		schedule_delayed_work(&rcache->work, IOVA_DEPOT_DELAY);
-	}
 }
 
 int iova_domain_init_rcaches(struct iova_domain *iovad)
 {
 	unsigned int cpu;
-	int i, ret;
+	int i, nid, ret;
 
 	iovad->rcaches = kcalloc(IOVA_RANGE_CACHE_MAX_SIZE,
 				 sizeof(struct iova_rcache),
@@ -720,7 +754,6 @@ int iova_domain_init_rcaches(struct iova_domain *iovad)
 		struct iova_rcache *rcache;
 
 		rcache = &iovad->rcaches[i];
-		spin_lock_init(&rcache->lock);
 		rcache->iovad = iovad;
 		INIT_DELAYED_WORK(&rcache->work, iova_depot_work_func);
 		rcache->cpu_rcaches = __alloc_percpu(sizeof(*cpu_rcache),
@@ -740,6 +773,19 @@ int iova_domain_init_rcaches(struct iova_domain *iovad)
 				goto out_err;
 			}
 		}
+		rcache->depots = kcalloc(nr_node_ids, sizeof(*rcache->depots),
+					 GFP_KERNEL);
+		if (!rcache->depots) {
+			ret = -ENOMEM;
+			goto out_err;
+		}
+		for_each_node(nid) {
+			struct iova_depot *depot = &rcache->depots[nid];
+
+			spin_lock_init(&depot->lock);
+			depot->target = max_t(unsigned int,
+					      nr_cpus_node(nid), 1);
+		}
 	}
 
 	ret = cpuhp_state_add_instance_nocalls(CPUHP_IOMMU_IOVA_DEAD,
@@ -780,9 +826,12 @@ static bool __iova_rcache_insert(struct iova_domain *iovad,
 		struct iova_magazine *new_mag = iova_magazine_alloc(GFP_ATOMIC);
 
 		if (new_mag) {
-			spin_lock(&rcache->lock);
-			iova_depot_push(rcache, cpu_rcache->loaded);
-			spin_unlock(&rcache->lock);
+			struct iova_depot *depot =
+				&rcache->depots[numa_node_id()];
+
+			spin_lock(&depot->lock);
+			iova_depot_push(depot, cpu_rcache->loaded);
+			spin_unlock(&depot->lock);
 			schedule_delayed_work(&rcache->work, IOVA_DEPOT_DELAY);
 
 			cpu_rcache->loaded = new_mag;
@@ -831,13 +880,26 @@ static unsigned long __iova_rcache_get(struct iova_rcache *rcache,
 		swap(cpu_rcache->prev, cpu_rcache->loaded);
 		has_pfn = true;
 	} else {
-		spin_lock(&rcache->lock);
-		if (rcache->depot) {
+		struct iova_depot *depot = &rcache->depots[numa_node_id()];
+
+		spin_lock(&depot->lock);
+		if (depot->head) {
 			iova_magazine_free(cpu_rcache->loaded);
-			cpu_rcache->loaded = iova_depot_pop(rcache);
+			cpu_rcache->loaded = iova_depot_pop(depot);
 			has_pfn = true;
+			/*
+			 * Refill in pairs while the depot is deep enough;
+			 * reloading prev as well halves the number of trips
+			 * back here under sustained load.
+			 */
+			if (depot->head) {
+				iova_magazine_free(cpu_rcache->prev);
+				cpu_rcache->prev = iova_depot_pop(depot);
+			}
+		} else {
+			depot->misses++;
 		}
-		spin_unlock(&rcache->lock);
+		spin_unlock(&depot->lock);
 	}
 
 	if (has_pfn)
@@ -873,6 +935,7 @@ static void free_iova_rcaches(struct iova_domain *iovad)
 	struct iova_rcache *rcache;
 	struct iova_cpu_rcache *cpu_rcache;
 	unsigned int cpu;
+	int nid;
 
 	for (int i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
 		rcache = &iovad->rcaches[i];
@@ -885,8 +948,15 @@ static void free_iova_rcaches(struct iova_domain *iovad)
 		}
 		free_percpu(rcache->cpu_rcaches);
 		cancel_delayed_work_sync(&rcache->work);
-		while (rcache->depot)
-			iova_magazine_free(iova_depot_pop(rcache));
+		if (!rcache->depots)
+			continue;
+		for_each_node(nid) {
+			struct iova_depot *depot = &rcache->depots[nid];
+
+			while (depot->head)
+				iova_magazine_free(iova_depot_pop(depot));
+		}
+		kfree(rcache->depots);
 	}
 
 	kfree(iovad->rcaches);
@@ -920,17 +990,22 @@ static void free_global_cached_iovas(struct iova_domain *iovad)
 {
 	struct iova_rcache *rcache;
 	unsigned long flags;
+	int nid;
 
 	for (int i = 0; i < IOVA_RANGE_CACHE_MAX_SIZE; ++i) {
 		rcache = &iovad->rcaches[i];
-		spin_lock_irqsave(&rcache->lock, flags);
-		while (rcache->depot) {
-			struct iova_magazine *mag = iova_depot_pop(rcache);
+		for_each_node(nid) {
+			struct iova_depot *depot = &rcache->depots[nid];
 
-			iova_magazine_free_pfns(mag, iovad);
-			iova_magazine_free(mag);
+			spin_lock_irqsave(&depot->lock, flags);
+			while (depot->head) {
+				struct iova_magazine *mag = iova_depot_pop(depot);
+
+				iova_magazine_free_pfns(mag, iovad);
+				iova_magazine_free(mag);
+			}
+			spin_unlock_irqrestore(&depot->lock, flags);
 		}
-		spin_unlock_irqrestore(&rcache->lock, flags);
 	}
 }
 
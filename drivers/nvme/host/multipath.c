@@ -5,6 +5,7 @@
 
 #include <linux/backing-dev.h>
 #include <linux/moduleparam.h>
+#include <linux/random.h>
 #include <linux/vmalloc.h>
 #include <trace/events/block.h>
 #include "nvme.h"
@@ -17,6 +18,7 @@ MODULE_PARM_DESC(multipath,
 static const char *nvme_iopolicy_names[] = {
 	[NVME_IOPOLICY_NUMA]	= "numa",
 	[NVME_IOPOLICY_RR]	= "round-robin",
+	[NVME_IOPOLICY_EWMA]	= "ewma",
 };
 
 static int iopolicy = NVME_IOPOLICY_NUMA;
@@ -29,6 +31,8 @@ static int nvme_set_iopolicy(const char *val, const struct kernel_param *kp)
 		iopolicy = NVME_IOPOLICY_NUMA;
 	else if (!strncmp(val, "round-robin", 11))
 		iopolicy = NVME_IOPOLICY_RR;
+	else if (!strncmp(val, "ewma", 4))
+		iopolicy = NVME_IOPOLICY_EWMA;
 	else
 		return -EINVAL;
 
@@ -43,7 +47,7 @@ static int nvme_get_iopolicy(char *buf, const struct kernel_param *kp)
 module_param_call(iopolicy, nvme_set_iopolicy, nvme_get_iopolicy,
 	&iopolicy, 0644);
 MODULE_PARM_DESC(iopolicy,
-	"Default multipath I/O policy; 'numa' (default) or 'round-robin'");
+	"Default multipath I/O policy; 'numa' (default), 'round-robin' or 'ewma'");
 
 void nvme_mpath_default_iopolicy(struct nvme_subsystem *subsys)
 {
@@ -127,7 +131,15 @@ void nvme_mpath_start_request(struct request *rq)
 	struct nvme_ns *ns = rq->q->queuedata;
 	struct gendisk *disk = ns->head->disk;
 
-	if (!blk_queue_io_stat(disk->queue) || blk_rq_is_passthrough(rq))
+	if (blk_rq_is_passthrough(rq))
+		return;
+
+	if (READ_ONCE(ns->head->subsys->iopolicy) == NVME_IOPOLICY_EWMA) {
+		nvme_req(rq)->flags |= NVME_MPATH_LAT;
+		nvme_req(rq)->lat_start_ns = ktime_get_ns();
+	}
+
+	if (!blk_queue_io_stat(disk->queue))
 		return;
 
 	nvme_req(rq)->flags |= NVME_MPATH_IO_STATS;
@@ -136,10 +148,29 @@ void nvme_mpath_start_request(struct request *rq)
 }
 EXPORT_SYMBOL_GPL(nvme_mpath_start_request);
 
+/*
+ * Fold a completion time into the path's latency EWMA with 1/8 gain.
+ * Updates are advisory and deliberately tolerate racing completions.
+ */
+static void nvme_mpath_add_latency_sample(struct nvme_ns *ns, u64 lat)
+{
+	u64 ewma = READ_ONCE(ns->lat_ewma_ns);
+
+	if (!ewma)
+		ewma = lat;
+	else
+		ewma += (s64)(lat - ewma) >> 3;
+	WRITE_ONCE(ns->lat_ewma_ns, ewma);
+}
+
 void nvme_mpath_end_request(struct request *rq)
 {
 	struct nvme_ns *ns = rq->q->queuedata;
 
+	if (nvme_req(rq)->flags & NVME_MPATH_LAT)
+		nvme_mpath_add_latency_sample(ns,
+				ktime_get_ns() - nvme_req(rq)->lat_start_ns);
+
 	if (!(nvme_req(rq)->flags & NVME_MPATH_IO_STATS))
 		return;
 	bdev_end_io_acct(ns->head->disk->part0, req_op(rq),
@@ -337,11 +368,91 @@ static inline bool nvme_path_is_optimized(struct nvme_ns *ns)
 		ns->ana_state == NVME_ANA_OPTIMIZED;
 }
 
+/*
+ * Weight of a path relative to the fastest one, on a 0..256 scale of
+ * inverse latency.  Unsampled paths get full weight so new paths are
+ * probed quickly, and anything within ~25% of the fastest also counts
+ * as fastest so jitter between near-equal fabrics does not constantly
+ * shift traffic around.
+ */
+static u32 nvme_ewma_weight(u64 ewma, u64 min_ewma)
+{
+	u32 weight;
+
+	if (!ewma || ewma <= min_ewma)
+		return 256;
+	weight = div64_u64(min_ewma << 8, ewma);
+	if (weight >= 204)
+		return 256;
+	return max(weight, 1U);
+}
+
+static struct nvme_ns *nvme_ewma_path(struct nvme_ns_head *head)
+{
+	struct nvme_ns *ns, *found = NULL, *fallback = NULL;
+	u64 min_ewma = U64_MAX;
+	u32 total = 0, r;
+
+	list_for_each_entry_rcu(ns, &head->list, siblings) {
+		if (nvme_path_is_disabled(ns))
+			continue;
+		if (ns->ana_state == NVME_ANA_OPTIMIZED) {
+			u64 ewma = READ_ONCE(ns->lat_ewma_ns);
+
+			if (ewma && ewma < min_ewma)
+				min_ewma = ewma;
+			found = ns;
+		} else if (ns->ana_state == NVME_ANA_NONOPTIMIZED) {
+			fallback = ns;
+		}
+	}
+	if (!found)
+		return fallback;
+
+	list_for_each_entry_rcu(ns, &head->list, siblings) {
+		if (nvme_path_is_disabled(ns) ||
+		    ns->ana_state != NVME_ANA_OPTIMIZED)
+			continue;
+		total += nvme_ewma_weight(READ_ONCE(ns->lat_ewma_ns),
+					  min_ewma);
+	}
+	if (!total)
+		return found;
+
+	/*
+	 * Route probabilistically, proportional to inverse latency; a
+	 * degraded path keeps receiving a trickle of IO so its recovery
+	 * is noticed without a separate prober.
+	 */
+	r = get_random_u32_below(total);
+	list_for_each_entry_rcu(ns, &head->list, siblings) {
+		u32 weight;
+
+		if (nvme_path_is_disabled(ns) ||
+		    ns->ana_state != NVME_ANA_OPTIMIZED)
+			continue;
+		found = ns;
+		weight = nvme_ewma_weight(READ_ONCE(ns->lat_ewma_ns),
+					  min_ewma);
+		if (r < weight)
+			break;
+		r -= weight;
+	}
+	return found;
+}
+
 inline struct nvme_ns *nvme_find_path(struct nvme_ns_head *head)
 {
 	int node = numa_node_id();
 	struct nvme_ns *ns;
 
+	if (READ_ONCE(head->subsys->iopolicy) == NVME_IOPOLICY_EWMA) {
+		ns = nvme_ewma_path(head);
+		if (ns)
+			return ns;
+		/* no usable path found, fall through to the numa logic */
+	}
+
 	ns = srcu_dereference(head->current_path[node], &head->srcu);
 	if (unlikely(!ns))
 		return __nvme_find_path(head, node);
@@ -834,6 +945,15 @@ static ssize_t ana_state_show(struct device *dev, struct device_attribute *attr,
 }
 DEVICE_ATTR_RO(ana_state);
 
+static ssize_t latency_ns_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct nvme_ns *ns = nvme_get_ns_from_dev(dev);
+
+	return sysfs_emit(buf, "%llu\n", READ_ONCE(ns->lat_ewma_ns));
+}
+DEVICE_ATTR_RO(latency_ns);
+
 static int nvme_lookup_ana_group_desc(struct nvme_ctrl *ctrl,
 		struct nvme_ana_group_desc *desc, void *data)
 {
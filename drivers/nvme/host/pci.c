@@ -105,6 +105,11 @@ static bool noacpi;
 module_param(noacpi, bool, 0444);
 MODULE_PARM_DESC(noacpi, "disable acpi bios quirks");
 
+static bool irq_coalesce;
+module_param(irq_coalesce, bool, 0444);
+MODULE_PARM_DESC(irq_coalesce,
+	"enable closed-loop interrupt coalescing on IRQ driven IO queues");
+
 struct nvme_dev;
 struct nvme_queue;
 
@@ -141,6 +146,8 @@ struct nvme_dev {
 	struct nvme_ctrl ctrl;
 	u32 last_ps;
 	bool hmb;
+	struct delayed_work irq_coal_work;
+	int irq_coal_level;
 
 	mempool_t *iod_mempool;
 
@@ -214,6 +221,12 @@ struct nvme_queue {
 	__le32 *dbbuf_sq_ei;
 	__le32 *dbbuf_cq_ei;
 	struct completion delete_done;
+	/* closed-loop irq coalescing state, see nvme_irq_coal_work(): */
+	u32 irq_count;
+	u32 cqe_count;
+	u32 irq_count_last;
+	u32 cqe_count_last;
+	bool coal_on;
 };
 
 union nvme_descriptor {
@@ -1079,8 +1092,12 @@ static irqreturn_t nvme_irq(int irq, void *data)
 {
 	struct nvme_queue *nvmeq = data;
 	DEFINE_IO_COMP_BATCH(iob);
+	int found;
 
-	if (nvme_poll_cq(nvmeq, &iob)) {
+	found = nvme_poll_cq(nvmeq, &iob);
+	if (found) {
+		nvmeq->irq_count++;
+		nvmeq->cqe_count += found;
 		if (!rq_list_empty(iob.req_list))
 			nvme_pci_complete_batch(&iob);
 		return IRQ_HANDLED;
@@ -1097,6 +1114,125 @@ static irqreturn_t nvme_irq_check(int irq, void *data)
 	return IRQ_NONE;
 }
 
+/*
+ * Aggregation steps programmed through NVME_FEAT_IRQ_COALESCE.  TIME is
+ * in 100us increments, THR is 0's based completion queue entries.
+ */
+static const struct {
+	u8 time;
+	u8 thr;
+} nvme_irq_coal_steps[] = {
+	{ 1, 3 }, { 2, 7 }, { 4, 15 }, { 8, 31 },
+};
+
+/* NVME_FEAT_IRQ_CONFIG: disable coalescing for the addressed vector */
+#define NVME_IRQ_CONFIG_CD	(1 << 16)
+
+/* Per-vector interrupt rates (per second) for entering/leaving coalescing */
+#define NVME_IRQ_COAL_HIGH_THRESH	8000
+#define NVME_IRQ_COAL_LOW_THRESH	1000
+
+static int nvme_set_irq_config(struct nvme_dev *dev, u16 iv, bool coalesce)
+{
+	u32 dword11 = iv;
+
+	if (!coalesce)
+		dword11 |= NVME_IRQ_CONFIG_CD;
+
+	return nvme_set_features(&dev->ctrl, NVME_FEAT_IRQ_CONFIG, dword11,
+				 NULL, 0, NULL);
+}
+
+/*
+ * Feedback controller for interrupt aggregation: vectors are sampled once
+ * a second and coalescing is enabled per vector while its interrupt rate
+ * stays high enough to hurt, so high IOPS queues shed IRQ overhead while
+ * idle and lightly loaded queues keep completing with no added latency.
+ * The aggregation window itself is stepped up while a coalesced vector
+ * keeps storming and stepped back down when the load drops.
+ */
+static void nvme_irq_coal_work(struct work_struct *work)
+{
+	struct nvme_dev *dev = container_of(work, struct nvme_dev,
+					    irq_coal_work.work);
+	int level = dev->irq_coal_level;
+	u32 busiest = 0;
+	unsigned int i;
+
+	if (nvme_ctrl_state(&dev->ctrl) != NVME_CTRL_LIVE)
+		return;
+
+	for (i = 1; i < dev->online_queues; i++) {
+		struct nvme_queue *nvmeq = &dev->queues[i];
+		u32 irqs, cqes;
+		bool want;
+
+		if (test_bit(NVMEQ_POLLED, &nvmeq->flags) ||
+		    !test_bit(NVMEQ_ENABLED, &nvmeq->flags))
+			continue;
+
+		irqs = READ_ONCE(nvmeq->irq_count) - nvmeq->irq_count_last;
+		cqes = READ_ONCE(nvmeq->cqe_count) - nvmeq->cqe_count_last;
+		nvmeq->irq_count_last += irqs;
+		nvmeq->cqe_count_last += cqes;
+
+		/*
+		 * Vectors already amortizing many completions over one
+		 * interrupt gain little from aggregation, so only rate
+		 * qualifies a vector.  The hysteresis band keeps a queue
+		 * hovering around the threshold from reprogramming the
+		 * feature on every sample.
+		 */
+		want = nvmeq->coal_on ? irqs > NVME_IRQ_COAL_LOW_THRESH :
+					irqs > NVME_IRQ_COAL_HIGH_THRESH &&
+					cqes < irqs * 4;
+		if (want != nvmeq->coal_on) {
+			if (nvme_set_irq_config(dev, nvmeq->cq_vector, want))
+				goto stop;
+			nvmeq->coal_on = want;
+		}
+		if (nvmeq->coal_on)
+			busiest = max(busiest, irqs);
+	}
+
+	if (busiest > NVME_IRQ_COAL_HIGH_THRESH)
+		level++;
+	else if (busiest < NVME_IRQ_COAL_LOW_THRESH)
+		level--;
+	level = clamp(level, 0, (int)ARRAY_SIZE(nvme_irq_coal_steps) - 1);
+	if (level != dev->irq_coal_level) {
+		if (nvme_set_features(&dev->ctrl, NVME_FEAT_IRQ_COALESCE,
+				      (nvme_irq_coal_steps[level].time << 8) |
+				      nvme_irq_coal_steps[level].thr,
+				      NULL, 0, NULL))
+			goto stop;
+		dev->irq_coal_level = level;
+	}
+
+	queue_delayed_work(nvme_wq, &dev->irq_coal_work,
+			   round_jiffies_relative(HZ));
+	return;
+stop:
+	dev_warn(dev->ctrl.device,
+		 "irq coalescing features unavailable, stopping controller loop\n");
+}
+
+static void nvme_irq_coal_start(struct nvme_dev *dev)
+{
+	unsigned int i;
+
+	if (!irq_coalesce || dev->online_queues <= 1)
+		return;
+
+	/* a controller reset cleared both features; resync cached state */
+	for (i = 1; i < dev->online_queues; i++)
+		dev->queues[i].coal_on = false;
+	dev->irq_coal_level = 0;
+
+	queue_delayed_work(nvme_wq, &dev->irq_coal_work,
+			   round_jiffies_relative(HZ));
+}
+
 /*
  * Poll for completions for any interrupt driven queue
  * Can be called from any context.
@@ -2592,6 +2728,7 @@ static void nvme_dev_disable(struct nvme_dev *dev, bool shutdown)
 	struct pci_dev *pdev = to_pci_dev(dev->dev);
 	bool dead;
 
+	cancel_delayed_work_sync(&dev->irq_coal_work);
 	mutex_lock(&dev->shutdown_lock);
 	dead = nvme_pci_ctrl_is_dead(dev);
 	if (state == NVME_CTRL_LIVE || state == NVME_CTRL_RESETTING) {
@@ -2783,6 +2920,7 @@ static void nvme_reset_work(struct work_struct *work)
 	}
 
 	nvme_start_ctrl(&dev->ctrl);
+	nvme_irq_coal_start(dev);
 	return;
 
  out_unlock:
@@ -2946,6 +3084,7 @@ static struct nvme_dev *nvme_pci_alloc_dev(struct pci_dev *pdev,
 	if (!dev)
 		return ERR_PTR(-ENOMEM);
 	INIT_WORK(&dev->ctrl.reset_work, nvme_reset_work);
+	INIT_DELAYED_WORK(&dev->irq_coal_work, nvme_irq_coal_work);
 	mutex_init(&dev->shutdown_lock);
 
 	dev->nr_write_queues = write_queues;
@@ -3081,6 +3220,7 @@ static int nvme_probe(struct pci_dev *pdev, const struct pci_device_id *id)
 	pci_set_drvdata(pdev, dev);
 
 	nvme_start_ctrl(&dev->ctrl);
+	nvme_irq_coal_start(dev);
 	nvme_put_ctrl(&dev->ctrl);
 	flush_work(&dev->ctrl.scan_work);
 	return 0;
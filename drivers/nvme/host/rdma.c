@@ -80,6 +80,7 @@ enum nvme_rdma_queue_flags {
 	NVME_RDMA_Q_ALLOCATED		= 0,
 	NVME_RDMA_Q_LIVE		= 1,
 	NVME_RDMA_Q_TR_READY		= 2,
+	NVME_RDMA_Q_SRQ			= 3,
 };
 
 struct nvme_rdma_queue {
@@ -117,6 +118,13 @@ struct nvme_rdma_ctrl {
 	struct blk_mq_tag_set	admin_tag_set;
 	struct nvme_rdma_device	*device;
 
+	/* receive resources shared by the IO queues, if use_srq: */
+	struct ib_srq		*srq;
+	struct nvme_rdma_qe	*srq_ring;
+	u32			srq_size;
+	int			srq_users;
+	struct mutex		srq_mutex;
+
 	u32			max_fr_pages;
 
 	struct sockaddr_storage addr;
@@ -148,9 +156,17 @@ module_param(register_always, bool, 0444);
 MODULE_PARM_DESC(register_always,
 	 "Use memory registration even for contiguous memory regions");
 
+static bool use_srq;
+module_param(use_srq, bool, 0444);
+MODULE_PARM_DESC(use_srq,
+	 "Share one receive queue between all IO queues of a controller when the device supports it");
+
 static int nvme_rdma_cm_handler(struct rdma_cm_id *cm_id,
 		struct rdma_cm_event *event);
 static void nvme_rdma_recv_done(struct ib_cq *cq, struct ib_wc *wc);
+static int nvme_rdma_post_recv(struct nvme_rdma_queue *queue,
+		struct nvme_rdma_qe *qe);
+static void nvme_rdma_put_srq(struct nvme_rdma_queue *queue);
 static void nvme_rdma_complete_rq(struct request *rq);
 
 static const struct blk_mq_ops nvme_rdma_mq_ops;
@@ -264,9 +280,13 @@ static int nvme_rdma_create_qp(struct nvme_rdma_queue *queue, const int factor)
 	init_attr.event_handler = nvme_rdma_qp_event;
 	/* +1 for drain */
 	init_attr.cap.max_send_wr = factor * queue->queue_size + 1;
-	/* +1 for drain */
-	init_attr.cap.max_recv_wr = queue->queue_size + 1;
-	init_attr.cap.max_recv_sge = 1;
+	if (test_bit(NVME_RDMA_Q_SRQ, &queue->flags)) {
+		init_attr.srq = queue->ctrl->srq;
+	} else {
+		/* +1 for drain */
+		init_attr.cap.max_recv_wr = queue->queue_size + 1;
+		init_attr.cap.max_recv_sge = 1;
+	}
 	init_attr.cap.max_send_sge = 1 + dev->num_inline_segments;
 	init_attr.sq_sig_type = IB_SIGNAL_REQ_WR;
 	init_attr.qp_type = IB_QPT_RC;
@@ -441,8 +461,12 @@ static void nvme_rdma_destroy_queue_ib(struct nvme_rdma_queue *queue)
 	ib_destroy_qp(queue->qp);
 	nvme_rdma_free_cq(queue);
 
-	nvme_rdma_free_ring(ibdev, queue->rsp_ring, queue->queue_size,
-			sizeof(struct nvme_completion), DMA_FROM_DEVICE);
+	if (test_bit(NVME_RDMA_Q_SRQ, &queue->flags))
+		nvme_rdma_put_srq(queue);
+	else
+		nvme_rdma_free_ring(ibdev, queue->rsp_ring, queue->queue_size,
+				sizeof(struct nvme_completion),
+				DMA_FROM_DEVICE);
 
 	nvme_rdma_dev_put(dev);
 }
@@ -486,6 +510,98 @@ static int nvme_rdma_create_cq(struct ib_device *ibdev,
 	return 0;
 }
 
+/*
+ * Attach an IO queue to the controller wide shared receive queue,
+ * creating it on first use.  The SRQ is sized for aggregate load rather
+ * than for the worst case sum of all queue depths: responses are tiny
+ * and short-lived, so a quarter of the summed depths bounds what is in
+ * flight in practice while an undersized SRQ only costs RNR retries,
+ * not correctness.
+ */
+static int nvme_rdma_get_srq(struct nvme_rdma_queue *queue)
+{
+	struct nvme_rdma_ctrl *ctrl = queue->ctrl;
+	struct ib_device *ibdev = queue->device->dev;
+	struct ib_srq_init_attr attr = {};
+	struct ib_srq *srq;
+	u32 depth;
+	int i, ret = 0;
+
+	mutex_lock(&ctrl->srq_mutex);
+	if (ctrl->srq) {
+		ctrl->srq_users++;
+		goto out_unlock;
+	}
+
+	depth = (ctrl->ctrl.queue_count - 1) * queue->queue_size / 4;
+	depth = clamp(depth, (u32)queue->queue_size + 1,
+		      (u32)ibdev->attrs.max_srq_wr - 1);
+
+	attr.attr.max_wr = depth;
+	attr.attr.max_sge = 1;
+
+	srq = ib_create_srq(queue->device->pd, &attr);
+	if (IS_ERR(srq)) {
+		ret = PTR_ERR(srq);
+		goto out_unlock;
+	}
+
+	ctrl->srq_ring = nvme_rdma_alloc_ring(ibdev, depth,
+			sizeof(struct nvme_completion), DMA_FROM_DEVICE);
+	if (!ctrl->srq_ring) {
+		ib_destroy_srq(srq);
+		ret = -ENOMEM;
+		goto out_unlock;
+	}
+
+	ctrl->srq = srq;
+	ctrl->srq_size = depth;
+	ctrl->srq_users = 1;
+
+	/*
+	 * Receive buffers can be posted right away, no QP needs to be
+	 * attached yet.
+	 */
+	set_bit(NVME_RDMA_Q_SRQ, &queue->flags);
+	for (i = 0; i < depth; i++) {
+		ret = nvme_rdma_post_recv(queue, &ctrl->srq_ring[i]);
+		if (ret) {
+			clear_bit(NVME_RDMA_Q_SRQ, &queue->flags);
+			ib_destroy_srq(srq);
+			nvme_rdma_free_ring(ibdev, ctrl->srq_ring, depth,
+					sizeof(struct nvme_completion),
+					DMA_FROM_DEVICE);
+			ctrl->srq = NULL;
+			ctrl->srq_ring = NULL;
+			goto out_unlock;
+		}
+	}
+
+out_unlock:
+	if (!ret)
+		set_bit(NVME_RDMA_Q_SRQ, &queue->flags);
+	mutex_unlock(&ctrl->srq_mutex);
+	return ret;
+}
+
+static void nvme_rdma_put_srq(struct nvme_rdma_queue *queue)
+{
+	struct nvme_rdma_ctrl *ctrl = queue->ctrl;
+
+	mutex_lock(&ctrl->srq_mutex);
+	if (--ctrl->srq_users == 0) {
+		/* all attached QPs are gone by now */
+		ib_destroy_srq(ctrl->srq);
+		nvme_rdma_free_ring(queue->device->dev, ctrl->srq_ring,
+				ctrl->srq_size, sizeof(struct nvme_completion),
+				DMA_FROM_DEVICE);
+		ctrl->srq = NULL;
+		ctrl->srq_ring = NULL;
+	}
+	mutex_unlock(&ctrl->srq_mutex);
+	clear_bit(NVME_RDMA_Q_SRQ, &queue->flags);
+}
+
 static int nvme_rdma_create_queue_ib(struct nvme_rdma_queue *queue)
 {
 	struct ib_device *ibdev;
@@ -508,15 +624,28 @@ static int nvme_rdma_create_queue_ib(struct nvme_rdma_queue *queue)
 	if (ret)
 		goto out_put_dev;
 
+	/*
+	 * IO queues share one controller wide receive ring when possible;
+	 * devices without SRQ support keep the per-queue ring.
+	 */
+	if (use_srq && nvme_rdma_queue_idx(queue) &&
+	    ibdev->attrs.max_srq && nvme_rdma_get_srq(queue))
+		dev_info(queue->ctrl->ctrl.device,
+			 "SRQ unavailable, using per-queue receive rings\n");
+
 	ret = nvme_rdma_create_qp(queue, send_wr_factor);
 	if (ret)
-		goto out_destroy_ib_cq;
-
-	queue->rsp_ring = nvme_rdma_alloc_ring(ibdev, queue->queue_size,
-			sizeof(struct nvme_completion), DMA_FROM_DEVICE);
-	if (!queue->rsp_ring) {
-		ret = -ENOMEM;
-		goto out_destroy_qp;
+		goto out_put_srq;
+
+	if (!test_bit(NVME_RDMA_Q_SRQ, &queue->flags)) {
+		queue->rsp_ring = nvme_rdma_alloc_ring(ibdev,
+				queue->queue_size,
+				sizeof(struct nvme_completion),
+				DMA_FROM_DEVICE);
+		if (!queue->rsp_ring) {
+			ret = -ENOMEM;
+			goto out_destroy_qp;
+		}
 	}
 
 	/*
@@ -555,11 +684,15 @@ static int nvme_rdma_create_queue_ib(struct nvme_rdma_queue *queue)
 out_destroy_mr_pool:
 	ib_mr_pool_destroy(queue->qp, &queue->qp->rdma_mrs);
 out_destroy_ring:
-	nvme_rdma_free_ring(ibdev, queue->rsp_ring, queue->queue_size,
-			    sizeof(struct nvme_completion), DMA_FROM_DEVICE);
+	if (!test_bit(NVME_RDMA_Q_SRQ, &queue->flags))
+		nvme_rdma_free_ring(ibdev, queue->rsp_ring, queue->queue_size,
+				    sizeof(struct nvme_completion),
+				    DMA_FROM_DEVICE);
 out_destroy_qp:
 	rdma_destroy_qp(queue->cm_id);
-out_destroy_ib_cq:
+out_put_srq:
+	if (test_bit(NVME_RDMA_Q_SRQ, &queue->flags))
+		nvme_rdma_put_srq(queue);
 	nvme_rdma_free_cq(queue);
 out_put_dev:
 	nvme_rdma_dev_put(queue->device);
@@ -1644,7 +1777,10 @@ static int nvme_rdma_post_recv(struct nvme_rdma_queue *queue,
 	wr.sg_list  = &list;
 	wr.num_sge  = 1;
 
-	ret = ib_post_recv(queue->qp, &wr, NULL);
+	if (test_bit(NVME_RDMA_Q_SRQ, &queue->flags))
+		ret = ib_post_srq_recv(queue->ctrl->srq, &wr, NULL);
+	else
+		ret = ib_post_recv(queue->qp, &wr, NULL);
 	if (unlikely(ret)) {
 		dev_err(queue->ctrl->ctrl.device,
 			"%s failed with error code %d\n", __func__, ret);
@@ -1782,6 +1918,10 @@ static int nvme_rdma_conn_established(struct nvme_rdma_queue *queue)
 {
 	int ret, i;
 
+	/* the shared ring was filled when the SRQ was created */
+	if (test_bit(NVME_RDMA_Q_SRQ, &queue->flags))
+		return 0;
+
 	for (i = 0; i < queue->queue_size; i++) {
 		ret = nvme_rdma_post_recv(queue, &queue->rsp_ring[i]);
 		if (ret)
@@ -2249,6 +2389,7 @@ static struct nvme_ctrl *nvme_rdma_create_ctrl(struct device *dev,
 		return ERR_PTR(-ENOMEM);
 	ctrl->ctrl.opts = opts;
 	INIT_LIST_HEAD(&ctrl->list);
+	mutex_init(&ctrl->srq_mutex);
 
 	if (!(opts->mask & NVMF_OPT_TRSVCID)) {
 		opts->trsvcid =
@@ -1028,6 +1028,47 @@ static void nvme_tcp_fail_request(struct nvme_tcp_request *req)
 	}
 }
 
+/*
+ * Account for @ret payload bytes pushed into the socket from the chunk
+ * described by @page/@offset/@len.  @queue, @req_data_sent, @req_data_len
+ * and @h2cdata_left must be sampled before the send as the RX path may
+ * complete the request and recycle it once the last payload byte is on
+ * the wire.  Returns 1 when this finished the current PDU's payload.
+ */
+static int nvme_tcp_data_sent(struct nvme_tcp_request *req,
+			      struct nvme_tcp_queue *queue, struct page *page,
+			      size_t offset, size_t len, bool last,
+			      int req_data_sent, int req_data_len,
+			      u32 h2cdata_left, int ret)
+{
+	if (queue->data_digest)
+		nvme_tcp_ddgst_update(queue->snd_hash, page, offset, ret);
+
+	/*
+	 * update the request iterator except for the last payload send
+	 * in the request where we don't want to modify it as we may
+	 * compete with the RX path completing the request.
+	 */
+	if (req_data_sent + ret < req_data_len)
+		nvme_tcp_advance_req(req, ret);
+
+	/* fully successful last send in current PDU */
+	if (last && ret == len) {
+		if (queue->data_digest) {
+			nvme_tcp_ddgst_final(queue->snd_hash, &req->ddgst);
+			req->state = NVME_TCP_SEND_DDGST;
+			req->offset = 0;
+		} else {
+			if (h2cdata_left)
+				nvme_tcp_setup_h2c_data_pdu(req);
+			else
+				nvme_tcp_done_send_req(queue);
+		}
+		return 1;
+	}
+	return 0;
+}
+
 static int nvme_tcp_try_send_data(struct nvme_tcp_request *req)
 {
 	struct nvme_tcp_queue *queue = req->queue;
@@ -1060,33 +1101,10 @@ static int nvme_tcp_try_send_data(struct nvme_tcp_request *req)
 		if (ret <= 0)
 			return ret;
 
-		if (queue->data_digest)
-			nvme_tcp_ddgst_update(queue->snd_hash, page,
-					offset, ret);
-
-		/*
-		 * update the request iterator except for the last payload send
-		 * in the request where we don't want to modify it as we may
-		 * compete with the RX path completing the request.
-		 */
-		if (req_data_sent + ret < req_data_len)
-			nvme_tcp_advance_req(req, ret);
-
-		/* fully successful last send in current PDU */
-		if (last && ret == len) {
-			if (queue->data_digest) {
-				nvme_tcp_ddgst_final(queue->snd_hash,
-					&req->ddgst);
-				req->state = NVME_TCP_SEND_DDGST;
-				req->offset = 0;
-			} else {
-				if (h2cdata_left)
-					nvme_tcp_setup_h2c_data_pdu(req);
-				else
-					nvme_tcp_done_send_req(queue);
-			}
+		if (nvme_tcp_data_sent(req, queue, page, offset, len, last,
+				       req_data_sent, req_data_len,
+				       h2cdata_left, ret))
 			return 1;
-		}
 	}
 	return -EAGAIN;
 }
@@ -1095,14 +1113,42 @@ static int nvme_tcp_try_send_cmd_pdu(struct nvme_tcp_request *req)
 {
 	struct nvme_tcp_queue *queue = req->queue;
 	struct nvme_tcp_cmd_pdu *pdu = nvme_tcp_req_cmd_pdu(req);
-	struct bio_vec bvec;
+	struct bio_vec bvec[2];
 	struct msghdr msg = { .msg_flags = MSG_DONTWAIT | MSG_SPLICE_PAGES, };
 	bool inline_data = nvme_tcp_has_inline_data(req);
 	u8 hdgst = nvme_tcp_hdgst_len(queue);
 	int len = sizeof(*pdu) + hdgst - req->offset;
+	int req_data_sent = req->data_sent;
+	int req_data_len = req->data_len;
+	u32 h2cdata_left = req->h2cdata_left;
+	struct page *data_page = NULL;
+	size_t data_off = 0, data_len = 0;
+	bool last = false;
+	int nr_bvec = 0;
 	int ret;
 
-	if (inline_data || nvme_tcp_queue_more(queue))
+	bvec_set_virt(&bvec[nr_bvec++], (void *)pdu + req->offset, len);
+
+	/*
+	 * Fold the first chunk of inline data into the same sendmsg as the
+	 * command PDU, so small writes hit the socket once instead of
+	 * twice.  Data digest needs crypto context set up between header
+	 * and payload, so digest enabled queues keep the split sends.
+	 */
+	if (inline_data && !queue->data_digest) {
+		data_page = nvme_tcp_req_cur_page(req);
+		if (sendpage_ok(data_page)) {
+			data_off = nvme_tcp_req_cur_offset(req);
+			data_len = nvme_tcp_req_cur_length(req);
+			last = nvme_tcp_pdu_last_send(req, data_len);
+			bvec_set_page(&bvec[nr_bvec++], data_page, data_len,
+				      data_off);
+		}
+	}
+
+	if (data_len && last && !nvme_tcp_queue_more(queue))
+		msg.msg_flags |= MSG_EOR;
+	else if (inline_data || nvme_tcp_queue_more(queue))
 		msg.msg_flags |= MSG_MORE;
 	else
 		msg.msg_flags |= MSG_EOR;
@@ -1110,26 +1156,32 @@ static int nvme_tcp_try_send_cmd_pdu(struct nvme_tcp_request *req)
 	if (queue->hdr_digest && !req->offset)
 		nvme_tcp_hdgst(queue->snd_hash, pdu, sizeof(*pdu));
 
-	bvec_set_virt(&bvec, (void *)pdu + req->offset, len);
-	iov_iter_bvec(&msg.msg_iter, ITER_SOURCE, &bvec, 1, len);
+	iov_iter_bvec(&msg.msg_iter, ITER_SOURCE, bvec, nr_bvec,
+		      len + data_len);
 	ret = sock_sendmsg(queue->sock, &msg);
 	if (unlikely(ret <= 0))
 		return ret;
 
-	len -= ret;
-	if (!len) {
-		if (inline_data) {
-			req->state = NVME_TCP_SEND_DATA;
-			if (queue->data_digest)
-				crypto_ahash_init(queue->snd_hash);
-		} else {
-			nvme_tcp_done_send_req(queue);
-		}
-		return 1;
+	if (ret < len) {
+		req->offset += ret;
+		return -EAGAIN;
 	}
-	req->offset += ret;
 
-	return -EAGAIN;
+	if (inline_data) {
+		req->state = NVME_TCP_SEND_DATA;
+		if (queue->data_digest)
+			crypto_ahash_init(queue->snd_hash);
+		if (ret > len &&
+		    nvme_tcp_data_sent(req, queue, data_page, data_off,
+				       data_len, last, req_data_sent,
+				       req_data_len, h2cdata_left,
+				       ret - len))
+			return 1;
+		/* nvme_tcp_try_send_data() pushes the remaining payload */
+	} else {
+		nvme_tcp_done_send_req(queue);
+	}
+	return 1;
 }
 
 static int nvme_tcp_try_send_data_pdu(struct nvme_tcp_request *req)
@@ -1217,7 +1269,11 @@ static int nvme_tcp_try_send(struct nvme_tcp_queue *queue)
 		ret = nvme_tcp_try_send_cmd_pdu(req);
 		if (ret <= 0)
 			goto done;
-		if (!nvme_tcp_has_inline_data(req))
+		/*
+		 * The PDU send may have covered the whole inline payload,
+		 * in which case the request is already done.
+		 */
+		if (!queue->request || !nvme_tcp_has_inline_data(req))
 			goto out;
 	}
 
@@ -32,6 +32,7 @@
 #include <linux/rbtree.h>
 #include <linux/sched/signal.h>
 #include <linux/sched/mm.h>
+#include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/uaccess.h>
 #include <linux/vfio.h>
@@ -60,6 +61,11 @@ module_param_named(dma_entry_limit, dma_entry_limit, uint, 0644);
 MODULE_PARM_DESC(dma_entry_limit,
 		 "Maximum number of user DMA mappings per container (65535).");
 
+static unsigned int map_threads = 1;
+module_param_named(map_threads, map_threads, uint, 0644);
+MODULE_PARM_DESC(map_threads,
+		 "Maximum number of threads used to pin and map a single large DMA mapping (default 1, the calling thread does all the work).");
+
 struct vfio_iommu {
 	struct list_head	domain_list;
 	struct list_head	iova_list;
@@ -434,9 +440,15 @@ static int vfio_lock_acct(struct vfio_dma *dma, long npage, bool async)
 	if (async && !mmget_not_zero(mm))
 		return -ESRCH; /* process exited */
 
-	ret = mm_lock_acct(dma->task, mm, dma->lock_cap, npage);
-	if (!ret)
-		dma->locked_vm += npage;
+	ret = mmap_write_lock_killable(mm);
+	if (!ret) {
+		ret = __account_locked_vm(mm, abs(npage), npage > 0, dma->task,
+					  dma->lock_cap);
+		if (!ret)
+			/* mmap_lock also serializes this when map_threads > 1 */
+			dma->locked_vm += npage;
+		mmap_write_unlock(mm);
+	}
 
 	if (async)
 		mmput(mm);
@@ -1022,22 +1034,17 @@ static size_t unmap_unpin_slow(struct vfio_domain *domain,
 	return unmapped;
 }
 
-static long vfio_unmap_unpin(struct vfio_iommu *iommu, struct vfio_dma *dma,
-			     bool do_accounting)
+static long vfio_unmap_unpin_range(struct vfio_iommu *iommu,
+				   struct vfio_dma *dma, dma_addr_t iova,
+				   size_t size, bool do_accounting)
 {
-	dma_addr_t iova = dma->iova, end = dma->iova + dma->size;
+	dma_addr_t start = iova, end = iova + size;
 	struct vfio_domain *domain, *d;
 	LIST_HEAD(unmapped_region_list);
 	struct iommu_iotlb_gather iotlb_gather;
 	int unmapped_region_cnt = 0;
 	long unlocked = 0;
 
-	if (!dma->size)
-		return 0;
-
-	if (list_empty(&iommu->domain_list))
-		return 0;
-
 	/*
 	 * We use the IOMMU to track the physical addresses, otherwise we'd
 	 * need a much more complicated tracking system.  Unfortunately that
@@ -1049,7 +1056,7 @@ static long vfio_unmap_unpin(struct vfio_iommu *iommu, struct vfio_dma *dma,
 				      struct vfio_domain, next);
 
 	list_for_each_entry_continue(d, &iommu->domain_list, next) {
-		iommu_unmap(d->domain, dma->iova, dma->size);
+		iommu_unmap(d->domain, start, size);
 		cond_resched();
 	}
 
@@ -1092,8 +1099,6 @@ static long vfio_unmap_unpin(struct vfio_iommu *iommu, struct vfio_dma *dma,
 		}
 	}
 
-	dma->iommu_mapped = false;
-
 	if (unmapped_region_cnt) {
 		unlocked += vfio_sync_unpin(dma, domain, &unmapped_region_list,
 					    &iotlb_gather);
@@ -1106,6 +1111,24 @@ static long vfio_unmap_unpin(struct vfio_iommu *iommu, struct vfio_dma *dma,
 	return unlocked;
 }
 
+static long vfio_unmap_unpin(struct vfio_iommu *iommu, struct vfio_dma *dma,
+			     bool do_accounting)
+{
+	long unlocked;
+
+	if (!dma->size)
+		return 0;
+
+	if (list_empty(&iommu->domain_list))
+		return 0;
+
+	unlocked = vfio_unmap_unpin_range(iommu, dma, dma->iova, dma->size,
+					  do_accounting);
+	dma->iommu_mapped = false;
+
+	return unlocked;
+}
+
 static void vfio_remove_dma(struct vfio_iommu *iommu, struct vfio_dma *dma)
 {
 	WARN_ON(!RB_EMPTY_ROOT(&dma->pfn_list));
@@ -1442,24 +1465,32 @@ unwind:
 	return ret;
 }
 
-static int vfio_pin_map_dma(struct vfio_iommu *iommu, struct vfio_dma *dma,
-			    size_t map_size)
+/*
+ * Pin and map a range of the user mapping.  On failure nothing is left
+ * behind; whatever part of the range was already pinned and mapped is
+ * torn down again so that callers can fan ranges out to multiple threads
+ * without creating holes that vfio_unmap_unpin() would trip over.
+ */
+static int vfio_pin_map_dma_range(struct vfio_iommu *iommu,
+				  struct vfio_dma *dma, unsigned long vaddr,
+				  size_t size)
 {
-	dma_addr_t iova = dma->iova;
-	unsigned long vaddr = dma->vaddr;
+	dma_addr_t iova = dma->iova + (vaddr - dma->vaddr);
+	unsigned long limit = task_rlimit(dma->task,
+					  RLIMIT_MEMLOCK) >> PAGE_SHIFT;
 	struct vfio_batch batch;
-	size_t size = map_size;
+	size_t mapped = 0;
+	unsigned long pfn;
 	long npage;
-	unsigned long pfn, limit = rlimit(RLIMIT_MEMLOCK) >> PAGE_SHIFT;
 	int ret = 0;
 
 	vfio_batch_init(&batch);
 
-	while (size) {
+	while (size > mapped) {
 		/* Pin a contiguous chunk of memory */
-		npage = vfio_pin_pages_remote(dma, vaddr + dma->size,
-					      size >> PAGE_SHIFT, &pfn, limit,
-					      &batch);
+		npage = vfio_pin_pages_remote(dma, vaddr + mapped,
+					      (size - mapped) >> PAGE_SHIFT,
+					      &pfn, limit, &batch);
 		if (npage <= 0) {
 			WARN_ON(!npage);
 			ret = (int)npage;
@@ -1467,28 +1498,128 @@ static int vfio_pin_map_dma(struct vfio_iommu *iommu, struct vfio_dma *dma,
 		}
 
 		/* Map it! */
-		ret = vfio_iommu_map(iommu, iova + dma->size, pfn, npage,
+		ret = vfio_iommu_map(iommu, iova + mapped, pfn, npage,
 				     dma->prot);
 		if (ret) {
-			vfio_unpin_pages_remote(dma, iova + dma->size, pfn,
+			vfio_unpin_pages_remote(dma, iova + mapped, pfn,
 						npage, true);
 			vfio_batch_unpin(&batch, dma);
 			break;
 		}
 
-		size -= npage << PAGE_SHIFT;
-		dma->size += npage << PAGE_SHIFT;
+		mapped += npage << PAGE_SHIFT;
 	}
 
 	vfio_batch_fini(&batch);
-	dma->iommu_mapped = true;
 
-	if (ret)
-		vfio_remove_dma(iommu, dma);
+	if (ret && mapped)
+		vfio_unmap_unpin_range(iommu, dma, iova, mapped, true);
 
 	return ret;
 }
 
+struct vfio_pin_mt_work {
+	struct work_struct work;
+	struct vfio_iommu *iommu;
+	struct vfio_dma *dma;
+	unsigned long vaddr;
+	size_t size;
+	int ret;
+};
+
+static void vfio_pin_map_dma_thread(struct work_struct *work)
+{
+	struct vfio_pin_mt_work *w = container_of(work,
+					struct vfio_pin_mt_work, work);
+	struct mm_struct *mm = w->dma->mm;
+
+	if (!mmget_not_zero(mm)) {
+		w->ret = -ENODEV;
+		return;
+	}
+
+	kthread_use_mm(mm);
+	w->ret = vfio_pin_map_dma_range(w->iommu, w->dma, w->vaddr, w->size);
+	kthread_unuse_mm(mm);
+	mmput(mm);
+}
+
+/* Minimum amount of work worth handing to another thread */
+#define VFIO_PIN_MT_MIN_CHUNK	SZ_128M
+
+static int vfio_pin_map_dma(struct vfio_iommu *iommu, struct vfio_dma *dma,
+			    size_t map_size)
+{
+	unsigned int i, nthreads = READ_ONCE(map_threads);
+	struct vfio_pin_mt_work *works = NULL;
+	size_t chunk;
+	int ret;
+
+	nthreads = min3(nthreads, num_online_cpus(),
+			(unsigned int)(map_size / VFIO_PIN_MT_MIN_CHUNK));
+	if (nthreads > 1)
+		works = kcalloc(nthreads, sizeof(*works), GFP_KERNEL);
+
+	if (!works) {
+		ret = vfio_pin_map_dma_range(iommu, dma, dma->vaddr, map_size);
+		goto done;
+	}
+
+	/*
+	 * Shard on PMD boundaries so that at most the first and last pages
+	 * of a chunk can break up an otherwise physically contiguous run
+	 * that the iommu could have mapped with a superpage.
+	 */
+	chunk = ALIGN(DIV_ROUND_UP(map_size, nthreads), PMD_SIZE);
+	nthreads = DIV_ROUND_UP(map_size, chunk);
+
+	for (i = 0; i < nthreads; i++) {
+		struct vfio_pin_mt_work *w = &works[i];
+
+		w->iommu = iommu;
+		w->dma = dma;
+		w->vaddr = dma->vaddr + i * chunk;
+		w->size = min(chunk, map_size - i * chunk);
+		INIT_WORK(&w->work, vfio_pin_map_dma_thread);
+		queue_work(system_unbound_wq, &w->work);
+	}
+
+	ret = 0;
+	for (i = 0; i < nthreads; i++) {
+		flush_work(&works[i].work);
+		if (works[i].ret && !ret)
+			ret = works[i].ret;
+	}
+
+	/*
+	 * Each range unwinds itself on failure, but if any range failed the
+	 * successful ones must go too, leaving dma->size zero so that
+	 * vfio_remove_dma() below has nothing left to tear down.
+	 */
+	if (ret) {
+		for (i = 0; i < nthreads; i++) {
+			if (works[i].ret)
+				continue;
+			vfio_unmap_unpin_range(iommu, dma,
+					       dma->iova + i * chunk,
+					       works[i].size, true);
+		}
+	}
+
+	kfree(works);
+
+done:
+	if (ret) {
+		vfio_remove_dma(iommu, dma);
+		return ret;
+	}
+
+	dma->size = map_size;
+	dma->iommu_mapped = true;
+
+	return 0;
+}
+
 /*
  * Check dma map request is within a valid iova range
  */
@@ -118,6 +118,15 @@ struct vhost_net_virtqueue {
 	int done_idx;
 	/* Number of XDP frames batched */
 	int batched_xdp;
+	/* Adaptive used-ring flush threshold, 1..VHOST_NET_BATCH.
+	 * Grows while a handler run keeps saturating it and shrinks
+	 * while runs come up short, so light load signals the guest
+	 * (almost) per packet and heavy load amortizes the signal. */
+	int batch_depth;
+	/* Adaptive busy-poll budget in busy_clock() units, clamped to
+	 * the configured busyloop_timeout.  Shrinks after idle polls so
+	 * a quiet queue falls back to notification mode. */
+	unsigned long busyloop_budget;
 	/* an array of userspace buffers info */
 	struct ubuf_info_msgzc *ubuf_info;
 	/* Reference counting for outstanding ubufs.
@@ -449,6 +458,19 @@ static int vhost_net_enable_vq(struct vhost_net *n,
 	return vhost_poll_start(poll, sock->file);
 }
 
+/* Retune the used-ring flush threshold from what the last handler run
+ * actually moved: runs that keep the batch full double the depth, short
+ * runs halve it so an idle-ish queue signals with per-packet latency.
+ * Called with the vq mutex held.
+ */
+static void vhost_net_tune_batch(struct vhost_net_virtqueue *nvq, int pkts)
+{
+	if (pkts >= nvq->batch_depth)
+		nvq->batch_depth = min(nvq->batch_depth * 2, VHOST_NET_BATCH);
+	else
+		nvq->batch_depth = max(nvq->batch_depth / 2, 1);
+}
+
 static void vhost_net_signal_used(struct vhost_net_virtqueue *nvq)
 {
 	struct vhost_virtqueue *vq = &nvq->vq;
@@ -526,8 +548,13 @@ static void vhost_net_busy_poll(struct vhost_net *net,
 				bool *busyloop_intr,
 				bool poll_rx)
 {
+	struct vhost_net_virtqueue *nvq = container_of(poll_rx ? rvq : tvq,
+						       struct vhost_net_virtqueue,
+						       vq);
 	unsigned long busyloop_timeout;
+	unsigned long budget;
 	unsigned long endtime;
+	bool found = false;
 	struct socket *sock;
 	struct vhost_virtqueue *vq = poll_rx ? tvq : rvq;
 
@@ -544,8 +571,16 @@ static void vhost_net_busy_poll(struct vhost_net *net,
 	busyloop_timeout = poll_rx ? rvq->busyloop_timeout:
 				     tvq->busyloop_timeout;
 
+	/* The configured timeout only caps the budget; repeated idle
+	 * polls shrink the budget so we stop burning the CPU and rely
+	 * on notification instead, productive polls grow it back.
+	 */
+	budget = nvq->busyloop_budget;
+	if (!budget || budget > busyloop_timeout)
+		budget = busyloop_timeout;
+
 	preempt_disable();
-	endtime = busy_clock() + busyloop_timeout;
+	endtime = busy_clock() + budget;
 
 	while (vhost_can_busy_poll(endtime)) {
 		if (vhost_vq_has_work(vq)) {
@@ -555,14 +590,21 @@ static void vhost_net_busy_poll(struct vhost_net *net,
 
 		if ((sock_has_rx_data(sock) &&
 		     !vhost_vq_avail_empty(&net->dev, rvq)) ||
-		    !vhost_vq_avail_empty(&net->dev, tvq))
+		    !vhost_vq_avail_empty(&net->dev, tvq)) {
+			found = true;
 			break;
+		}
 
 		cpu_relax();
 	}
 
 	preempt_enable();
 
+	if (found)
+		nvq->busyloop_budget = min(budget * 2, busyloop_timeout);
+	else if (!*busyloop_intr)
+		nvq->busyloop_budget = max(budget / 2, 1UL);
+
 	if (poll_rx || sock_has_rx_data(sock))
 		vhost_net_busy_poll_try_queue(net, vq);
 	else if (!poll_rx) /* On tx here, sock has no rx data. */
@@ -759,7 +801,7 @@ static void handle_tx_copy(struct vhost_net *net, struct socket *sock)
 	do {
 		bool busyloop_intr = false;
 
-		if (nvq->done_idx == VHOST_NET_BATCH)
+		if (nvq->done_idx >= nvq->batch_depth)
 			vhost_tx_batch(net, nvq, sock, &msg);
 
 		head = get_tx_bufs(net, nvq, &msg, &out, &in, &len,
@@ -825,6 +867,7 @@ done:
 		++nvq->done_idx;
 	} while (likely(!vhost_exceeds_weight(vq, ++sent_pkts, total_len)));
 
+	vhost_net_tune_batch(nvq, sent_pkts);
 	vhost_tx_batch(net, nvq, sock, &msg);
 }
 
@@ -1213,7 +1256,7 @@ static void handle_rx(struct vhost_net *net)
 			goto out;
 		}
 		nvq->done_idx += headcount;
-		if (nvq->done_idx > VHOST_NET_BATCH)
+		if (nvq->done_idx > nvq->batch_depth)
 			vhost_net_signal_used(nvq);
 		if (unlikely(vq_log))
 			vhost_log_write(vq, vq_log, log, vhost_len,
@@ -1225,6 +1268,7 @@ static void handle_rx(struct vhost_net *net)
 		vhost_poll_queue(&vq->poll);
 	else if (!sock_len)
 		vhost_net_enable_vq(net, vq);
+	vhost_net_tune_batch(nvq, recv_pkts);
 out:
 	vhost_net_signal_used(nvq);
 	mutex_unlock(&vq->mutex);
@@ -1309,6 +1353,8 @@ static int vhost_net_open(struct inode *inode, struct file *f)
 		n->vqs[i].upend_idx = 0;
 		n->vqs[i].done_idx = 0;
 		n->vqs[i].batched_xdp = 0;
+		n->vqs[i].batch_depth = VHOST_NET_BATCH;
+		n->vqs[i].busyloop_budget = 0;
 		n->vqs[i].vhost_hlen = 0;
 		n->vqs[i].sock_hlen = 0;
 		n->vqs[i].rx_ring = NULL;
@@ -16,6 +16,7 @@
 #include <linux/init.h>
 #include <linux/slab.h>
 #include <linux/kthread.h>
+#include <linux/sched/clock.h>
 #include <linux/types.h>
 #include <linux/string.h>
 #include <linux/configfs.h>
@@ -170,6 +171,10 @@ static unsigned vhost_scsi_max_io_vqs = 128;
 module_param_named(max_io_vqs, vhost_scsi_max_io_vqs, uint, 0644);
 MODULE_PARM_DESC(max_io_vqs, "Set the max number of IO virtqueues a vhost scsi device can support. The default is 128. The max is 1024.");
 
+static unsigned int vhost_scsi_poll_us;
+module_param_named(poll_us, vhost_scsi_poll_us, uint, 0644);
+MODULE_PARM_DESC(poll_us, "Busy-poll the completion list for up to this many microseconds before the completion work returns, instead of taking a worker wakeup per completion batch. The default is 0 (disabled).");
+
 struct vhost_scsi_virtqueue {
 	struct vhost_virtqueue vq;
 	struct vhost_scsi *vs;
@@ -190,6 +195,12 @@ struct vhost_scsi_virtqueue {
 
 	struct vhost_work completion_work;
 	struct llist_head completion_list;
+	/*
+	 * Adaptive busy-poll budget in microseconds, clamped to the poll_us
+	 * module parameter.  Grows while polling keeps finding completions
+	 * and shrinks when a poll times out.  0 means use poll_us.
+	 */
+	unsigned int poll_budget_us;
 };
 
 struct vhost_scsi {
@@ -553,6 +564,11 @@ static int vhost_scsi_copy_sgl_to_iov(struct vhost_scsi_cmd *cmd)
 	return 0;
 }
 
+static unsigned long vhost_scsi_busy_clock(void)
+{
+	return local_clock() >> 10;
+}
+
 /* Fill in status and signal that we are done processing this command
  *
  * This is scheduled in the vhost work queue so we are called with the owner
@@ -562,14 +578,18 @@ static void vhost_scsi_complete_cmd_work(struct vhost_work *work)
 {
 	struct vhost_scsi_virtqueue *svq = container_of(work,
 				struct vhost_scsi_virtqueue, completion_work);
+	unsigned int poll_us = READ_ONCE(vhost_scsi_poll_us);
 	struct virtio_scsi_cmd_resp v_rsp;
 	struct vhost_scsi_cmd *cmd, *t;
 	struct llist_node *llnode;
 	struct se_cmd *se_cmd;
 	struct iov_iter iov_iter;
+	unsigned long endtime;
 	bool signal = false;
+	unsigned int budget;
 	int ret;
 
+again:
 	llnode = llist_del_all(&svq->completion_list);
 	llist_for_each_entry_safe(cmd, t, llnode, tvc_completion_list) {
 		se_cmd = &cmd->tvc_se_cmd;
@@ -604,8 +624,35 @@ static void vhost_scsi_complete_cmd_work(struct vhost_work *work)
 		vhost_scsi_release_cmd_res(se_cmd);
 	}
 
-	if (signal)
+	if (signal) {
+		signal = false;
 		vhost_signal(&svq->vs->dev, &svq->vq);
+	}
+
+	if (!poll_us)
+		return;
+
+	/*
+	 * Busy-poll for the next backend completions instead of returning
+	 * to the worker loop and paying a wakeup per completion batch.
+	 * Give up early if other work was queued for this vq's worker.
+	 */
+	budget = svq->poll_budget_us;
+	if (!budget || budget > poll_us)
+		budget = poll_us;
+
+	endtime = vhost_scsi_busy_clock() + budget;
+	while (llist_empty(&svq->completion_list)) {
+		if (need_resched() || vhost_vq_has_work(&svq->vq) ||
+		    time_after(vhost_scsi_busy_clock(), endtime)) {
+			svq->poll_budget_us = max(budget / 2, 1U);
+			return;
+		}
+		cpu_relax();
+	}
+
+	svq->poll_budget_us = min(budget * 2, poll_us);
+	goto again;
 }
 
 static struct vhost_scsi_cmd *
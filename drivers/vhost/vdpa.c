@@ -15,7 +15,9 @@
 #include <linux/module.h>
 #include <linux/cdev.h>
 #include <linux/device.h>
+#include <linux/hrtimer.h>
 #include <linux/mm.h>
+#include <linux/sched/clock.h>
 #include <linux/slab.h>
 #include <linux/iommu.h>
 #include <linux/uuid.h>
@@ -36,16 +38,32 @@ enum {
 
 #define VHOST_VDPA_IOTLB_BUCKETS 16
 
+static unsigned int kick_batch_us;
+module_param(kick_batch_us, uint, 0644);
+MODULE_PARM_DESC(kick_batch_us,
+		 "Window in microseconds over which guest kicks are folded into a single doorbell write. 0 to forward every kick (default)");
+
 struct vhost_vdpa_as {
 	struct hlist_node hash_link;
 	struct vhost_iotlb iotlb;
 	u32 id;
 };
 
+/* Shadow doorbell state, one per virtqueue.  See handle_vq_kick(). */
+struct vhost_vdpa_kick {
+	struct vhost_vdpa *v;
+	u16 qid;
+	spinlock_t lock;
+	bool deferred;
+	u64 last_kick_ns;
+	struct hrtimer timer;
+};
+
 struct vhost_vdpa {
 	struct vhost_dev vdev;
 	struct iommu_domain *domain;
 	struct vhost_virtqueue *vqs;
+	struct vhost_vdpa_kick *kicks;
 	struct completion completion;
 	struct vdpa_device *vdpa;
 	struct hlist_head as[VHOST_VDPA_IOTLB_BUCKETS];
@@ -57,6 +75,7 @@ struct vhost_vdpa {
 	int minor;
 	struct eventfd_ctx *config_ctx;
 	int in_batch;
+	bool batch_dirty;
 	struct vdpa_iova_range range;
 	u32 batch_asid;
 	bool suspended;
@@ -66,9 +85,9 @@ static DEFINE_IDA(vhost_vdpa_ida);
 
 static dev_t vhost_vdpa_major;
 
-static void vhost_vdpa_iotlb_unmap(struct vhost_vdpa *v,
-				   struct vhost_iotlb *iotlb, u64 start,
-				   u64 last, u32 asid);
+static u64 vhost_vdpa_iotlb_unmap(struct vhost_vdpa *v,
+				  struct vhost_iotlb *iotlb, u64 start,
+				  u64 last, u32 asid);
 
 static inline u32 iotlb_to_asid(struct vhost_iotlb *iotlb)
 {
@@ -163,14 +182,64 @@ static int vhost_vdpa_remove_as(struct vhost_vdpa *v, u32 asid)
 	return 0;
 }
 
+static enum hrtimer_restart vhost_vdpa_kick_timer_fn(struct hrtimer *timer)
+{
+	struct vhost_vdpa_kick *kick = container_of(timer,
+						    struct vhost_vdpa_kick,
+						    timer);
+	const struct vdpa_config_ops *ops = kick->v->vdpa->config;
+	unsigned long flags;
+
+	spin_lock_irqsave(&kick->lock, flags);
+	kick->deferred = false;
+	kick->last_kick_ns = local_clock();
+	spin_unlock_irqrestore(&kick->lock, flags);
+
+	ops->kick_vq(kick->v->vdpa, kick->qid);
+
+	return HRTIMER_NORESTART;
+}
+
 static void handle_vq_kick(struct vhost_work *work)
 {
 	struct vhost_virtqueue *vq = container_of(work, struct vhost_virtqueue,
 						  poll.work);
 	struct vhost_vdpa *v = container_of(vq->dev, struct vhost_vdpa, vdev);
 	const struct vdpa_config_ops *ops = v->vdpa->config;
+	u16 qid = vq - v->vqs;
+	struct vhost_vdpa_kick *kick = &v->kicks[qid];
+	u64 window = (u64)READ_ONCE(kick_batch_us) * NSEC_PER_USEC;
+	u64 now, since;
+	unsigned long flags;
+
+	if (!window) {
+		ops->kick_vq(v->vdpa, qid);
+		return;
+	}
+
+	/*
+	 * Shadow the doorbell: the first kick of a burst is forwarded to
+	 * the device right away, the rest are folded into one deferred
+	 * write when the batch window expires.
+	 */
+	spin_lock_irqsave(&kick->lock, flags);
+	if (kick->deferred) {
+		spin_unlock_irqrestore(&kick->lock, flags);
+		return;
+	}
+	now = local_clock();
+	since = now - kick->last_kick_ns;
+	if (since < window) {
+		kick->deferred = true;
+		hrtimer_start(&kick->timer, ns_to_ktime(window - since),
+			      HRTIMER_MODE_REL);
+		spin_unlock_irqrestore(&kick->lock, flags);
+		return;
+	}
+	kick->last_kick_ns = now;
+	spin_unlock_irqrestore(&kick->lock, flags);
 
-	ops->kick_vq(v->vdpa, vq - v->vqs);
+	ops->kick_vq(v->vdpa, qid);
 }
 
 static irqreturn_t vhost_vdpa_virtqueue_cb(void *private)
@@ -908,13 +977,14 @@ static void vhost_vdpa_general_unmap(struct vhost_vdpa *v,
 	}
 }
 
-static void vhost_vdpa_pa_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
-				u64 start, u64 last, u32 asid)
+static u64 vhost_vdpa_pa_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
+			       u64 start, u64 last, u32 asid)
 {
 	struct vhost_dev *dev = &v->vdev;
 	struct vhost_iotlb_map *map;
 	struct page *page;
 	unsigned long pfn, pinned;
+	u64 unmapped = 0;
 
 	while ((map = vhost_iotlb_itree_first(iotlb, start, last)) != NULL) {
 		pinned = PFN_DOWN(map->size);
@@ -928,14 +998,18 @@ static void vhost_vdpa_pa_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
 		atomic64_sub(PFN_DOWN(map->size), &dev->mm->pinned_vm);
 		vhost_vdpa_general_unmap(v, map, asid);
 		vhost_iotlb_map_free(iotlb, map);
+		unmapped++;
 	}
+
+	return unmapped;
 }
 
-static void vhost_vdpa_va_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
-				u64 start, u64 last, u32 asid)
+static u64 vhost_vdpa_va_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
+			       u64 start, u64 last, u32 asid)
 {
 	struct vhost_iotlb_map *map;
 	struct vdpa_map_file *map_file;
+	u64 unmapped = 0;
 
 	while ((map = vhost_iotlb_itree_first(iotlb, start, last)) != NULL) {
 		map_file = (struct vdpa_map_file *)map->opaque;
@@ -943,12 +1017,15 @@ static void vhost_vdpa_va_unmap(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
 		kfree(map_file);
 		vhost_vdpa_general_unmap(v, map, asid);
 		vhost_iotlb_map_free(iotlb, map);
+		unmapped++;
 	}
+
+	return unmapped;
 }
 
-static void vhost_vdpa_iotlb_unmap(struct vhost_vdpa *v,
-				   struct vhost_iotlb *iotlb, u64 start,
-				   u64 last, u32 asid)
+static u64 vhost_vdpa_iotlb_unmap(struct vhost_vdpa *v,
+				  struct vhost_iotlb *iotlb, u64 start,
+				  u64 last, u32 asid)
 {
 	struct vdpa_device *vdpa = v->vdpa;
 
@@ -999,6 +1076,8 @@ static int vhost_vdpa_map(struct vhost_vdpa *v, struct vhost_iotlb *iotlb,
 	} else if (ops->set_map) {
 		if (!v->in_batch)
 			r = ops->set_map(vdpa, asid, iotlb);
+		else
+			v->batch_dirty = true;
 	} else {
 		r = iommu_map(v->domain, iova, pa, size,
 			      perm_to_iommu_flags(perm),
@@ -1022,12 +1101,21 @@ static void vhost_vdpa_unmap(struct vhost_vdpa *v,
 	struct vdpa_device *vdpa = v->vdpa;
 	const struct vdpa_config_ops *ops = vdpa->config;
 	u32 asid = iotlb_to_asid(iotlb);
+	u64 unmapped;
 
-	vhost_vdpa_iotlb_unmap(v, iotlb, iova, iova + size - 1, asid);
+	unmapped = vhost_vdpa_iotlb_unmap(v, iotlb, iova, iova + size - 1,
+					  asid);
 
-	if (ops->set_map) {
+	/*
+	 * The device translation is rebuilt from the whole iotlb on each
+	 * set_map() call, so skip the rebuild when the invalidation hit
+	 * nothing and the cached translation is still valid.
+	 */
+	if (ops->set_map && unmapped) {
 		if (!v->in_batch)
 			ops->set_map(vdpa, asid, iotlb);
+		else
+			v->batch_dirty = true;
 	}
 
 }
@@ -1281,9 +1369,10 @@ static int vhost_vdpa_process_iotlb_msg(struct vhost_dev *dev, u32 asid,
 	case VHOST_IOTLB_BATCH_BEGIN:
 		v->batch_asid = asid;
 		v->in_batch = true;
+		v->batch_dirty = false;
 		break;
 	case VHOST_IOTLB_BATCH_END:
-		if (v->in_batch && ops->set_map)
+		if (v->in_batch && v->batch_dirty && ops->set_map)
 			ops->set_map(vdpa, asid, iotlb);
 		v->in_batch = false;
 		break;
@@ -1454,12 +1543,15 @@ static int vhost_vdpa_release(struct inode *inode, struct file *filep)
 {
 	struct vhost_vdpa *v = filep->private_data;
 	struct vhost_dev *d = &v->vdev;
+	u32 i;
 
 	mutex_lock(&d->mutex);
 	filep->private_data = NULL;
 	vhost_vdpa_clean_irq(v);
 	vhost_vdpa_reset(v);
 	vhost_dev_stop(&v->vdev);
+	for (i = 0; i < v->nvqs; i++)
+		hrtimer_cancel(&v->kicks[i].timer);
 	vhost_vdpa_unbind_mm(v);
 	vhost_vdpa_config_put(v);
 	vhost_vdpa_cleanup(v);
@@ -1549,6 +1641,7 @@ static void vhost_vdpa_release_dev(struct device *device)
 	       container_of(device, struct vhost_vdpa, dev);
 
 	ida_free(&vhost_vdpa_ida, v->minor);
+	kfree(v->kicks);
 	kfree(v->vqs);
 	kfree(v);
 }
@@ -1595,6 +1688,23 @@ static int vhost_vdpa_probe(struct vdpa_device *vdpa)
 		goto err;
 	}
 
+	v->kicks = kcalloc(v->nvqs, sizeof(struct vhost_vdpa_kick),
+			   GFP_KERNEL);
+	if (!v->kicks) {
+		r = -ENOMEM;
+		goto err;
+	}
+
+	for (i = 0; i < v->nvqs; i++) {
+		struct vhost_vdpa_kick *kick = &v->kicks[i];
+
+		kick->v = v;
+		kick->qid = i;
+		spin_lock_init(&kick->lock);
+		hrtimer_init(&kick->timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+		kick->timer.function = vhost_vdpa_kick_timer_fn;
+	}
+
 	r = dev_set_name(&v->dev, "vhost-vdpa-%u", minor);
 	if (r)
 		goto err;
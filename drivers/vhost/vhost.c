@@ -30,6 +30,7 @@
 #include <linux/interval_tree_generic.h>
 #include <linux/nospec.h>
 #include <linux/kcov.h>
+#include <linux/topology.h>
 
 #include "vhost.h"
 
@@ -241,6 +242,7 @@ static void vhost_worker_queue(struct vhost_worker *worker,
 		 * sure it was not in the list.
 		 * test_and_set_bit() implies a memory barrier.
 		 */
+		atomic_inc(&worker->pending);
 		llist_add(&work->node, &worker->work_list);
 		vhost_task_wake(worker->vtsk);
 	}
@@ -334,6 +336,7 @@ static void __vhost_vq_meta_reset(struct vhost_virtqueue *vq)
 
 	for (j = 0; j < VHOST_NUM_ADDRS; j++)
 		vq->meta_iotlb[j] = NULL;
+	vq->cached_map = NULL;
 }
 
 static void vhost_vq_meta_reset(struct vhost_dev *d)
@@ -396,6 +399,8 @@ static bool vhost_run_work_list(void *data)
 
 	node = llist_del_all(&worker->work_list);
 	if (node) {
+		int done = 0;
+
 		__set_current_state(TASK_RUNNING);
 
 		node = llist_reverse_order(node);
@@ -406,8 +411,10 @@ static bool vhost_run_work_list(void *data)
 			kcov_remote_start_common(worker->kcov_handle);
 			work->fn(work);
 			kcov_remote_stop();
+			done++;
 			cond_resched();
 		}
+		atomic_sub(done, &worker->pending);
 	}
 
 	return !!node;
@@ -657,11 +664,17 @@ static struct vhost_worker *vhost_worker_create(struct vhost_dev *dev)
 	int ret;
 	u32 id;
 
-	worker = kzalloc(sizeof(*worker), GFP_KERNEL_ACCOUNT);
+	/*
+	 * Keep the worker local to the node the owner runs on; guest memory
+	 * and the backend device are normally allocated from there too.
+	 */
+	worker = kzalloc_node(sizeof(*worker), GFP_KERNEL_ACCOUNT,
+			      numa_node_id());
 	if (!worker)
 		return NULL;
 
 	worker->dev = dev;
+	worker->node = numa_node_id();
 	snprintf(name, sizeof(name), "vhost-%d", current->pid);
 
 	vtsk = vhost_task_create(vhost_run_work_list, vhost_worker_killed,
@@ -759,6 +772,41 @@ static void __vhost_vq_attach_worker(struct vhost_virtqueue *vq,
 	mutex_unlock(&old_worker->mutex);
 }
 
+/*
+ * Pick the least loaded worker for auto attachment.  attachment_cnt and
+ * pending are read unlocked; both are advisory load signals and a stale
+ * value only leads to a slightly unbalanced pick, never to a dangling
+ * worker since the device mutex is held.
+ *
+ * Caller must have device mutex.
+ */
+static struct vhost_worker *vhost_worker_pick(struct vhost_dev *dev)
+{
+	struct vhost_worker *worker, *best = NULL;
+	int node = numa_node_id();
+	unsigned long i;
+
+	xa_for_each(&dev->worker_xa, i, worker) {
+		if (worker->killed)
+			continue;
+		if (!best) {
+			best = worker;
+		} else if (worker->attachment_cnt != best->attachment_cnt) {
+			if (worker->attachment_cnt < best->attachment_cnt)
+				best = worker;
+		} else if (atomic_read(&worker->pending) !=
+			   atomic_read(&best->pending)) {
+			if (atomic_read(&worker->pending) <
+			    atomic_read(&best->pending))
+				best = worker;
+		} else if (worker->node == node && best->node != node) {
+			best = worker;
+		}
+	}
+
+	return best;
+}
+
  /* Caller must have device mutex */
 static int vhost_vq_attach_worker(struct vhost_virtqueue *vq,
 				  struct vhost_vring_worker *info)
@@ -770,9 +818,20 @@ static int vhost_vq_attach_worker(struct vhost_virtqueue *vq,
 	if (!dev->use_worker)
 		return -EINVAL;
 
-	worker = xa_find(&dev->worker_xa, &index, UINT_MAX, XA_PRESENT);
-	if (!worker || worker->id != info->worker_id)
-		return -ENODEV;
+	if (info->worker_id == VHOST_VRING_WORKER_AUTO) {
+		/*
+		 * The chosen worker can be queried back with
+		 * VHOST_GET_VRING_WORKER.
+		 */
+		worker = vhost_worker_pick(dev);
+		if (!worker)
+			return -ENODEV;
+	} else {
+		worker = xa_find(&dev->worker_xa, &index, UINT_MAX,
+				 XA_PRESENT);
+		if (!worker || worker->id != info->worker_id)
+			return -ENODEV;
+	}
 
 	__vhost_vq_attach_worker(vq, worker);
 	return 0;
@@ -2391,6 +2450,7 @@ static int translate_desc(struct vhost_virtqueue *vq, u64 addr, u32 len,
 	const struct vhost_iotlb_map *map;
 	struct vhost_dev *dev = vq->dev;
 	struct vhost_iotlb *umem = dev->iotlb ? dev->iotlb : dev->umem;
+	bool use_cache = umem == dev->iotlb;
 	struct iovec *_iov;
 	u64 s = 0, last = addr + len - 1;
 	int ret = 0;
@@ -2402,7 +2462,20 @@ static int translate_desc(struct vhost_virtqueue *vq, u64 addr, u32 len,
 			break;
 		}
 
-		map = vhost_iotlb_itree_first(umem, addr, last);
+		/*
+		 * Datapath buffers tend to be translated through the same
+		 * few large mappings, so try the last hit before walking
+		 * the interval tree.  The cached pointer has the same life
+		 * cycle as the meta_iotlb entries: it is only kept for
+		 * dev->iotlb maps and dropped by vhost_vq_meta_reset()
+		 * before any of them is freed.
+		 */
+		map = use_cache ? vq->cached_map : NULL;
+		if (map && (addr < map->start || addr > map->last ||
+			    !(map->perm & access)))
+			map = NULL;
+		if (!map)
+			map = vhost_iotlb_itree_first(umem, addr, last);
 		if (map == NULL || map->start > addr) {
 			if (umem != dev->iotlb) {
 				ret = -EFAULT;
@@ -2415,6 +2488,9 @@ static int translate_desc(struct vhost_virtqueue *vq, u64 addr, u32 len,
 			break;
 		}
 
+		if (use_cache)
+			vq->cached_map = map;
+
 		_iov = iov + ret;
 		size = map->size - addr + map->start;
 		_iov->iov_len = min((u64)len - s, size);
@@ -32,8 +32,12 @@ struct vhost_worker {
 	/* Used to serialize device wide flushing with worker swapping. */
 	struct mutex		mutex;
 	struct llist_head	work_list;
+	/* Works queued but not yet run; load signal for auto attachment */
+	atomic_t		pending;
 	u64			kcov_handle;
 	u32			id;
+	/* NUMA node the worker was allocated on */
+	int			node;
 	int			attachment_cnt;
 	bool			killed;
 };
@@ -89,6 +93,9 @@ struct vhost_virtqueue {
 	vring_avail_t __user *avail;
 	vring_used_t __user *used;
 	const struct vhost_iotlb_map *meta_iotlb[VHOST_NUM_ADDRS];
+	/* Last mapping hit by translate_desc(), only for dev->iotlb.
+	 * Reset together with meta_iotlb on every IOTLB update. */
+	const struct vhost_iotlb_map *cached_map;
 	struct file *kick;
 	struct vhost_vring_call call_ctx;
 	struct eventfd_ctx *error_ctx;
@@ -29,6 +29,9 @@
  */
 #define VHOST_VSOCK_PKT_WEIGHT 256
 
+/* Used-ring entries accumulated before flushing them to the guest */
+#define VHOST_VSOCK_BATCH 16
+
 enum {
 	VHOST_VSOCK_FEATURES = VHOST_FEATURES |
 			       (1ULL << VIRTIO_F_ACCESS_PLATFORM) |
@@ -92,7 +95,7 @@ vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 {
 	struct vhost_virtqueue *tx_vq = &vsock->vqs[VSOCK_VQ_TX];
 	int pkts = 0, total_len = 0;
-	bool added = false;
+	int done_idx = 0;
 	bool restart_tx = false;
 
 	mutex_lock(&vq->mutex);
@@ -213,8 +216,18 @@ vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 		 */
 		virtio_transport_deliver_tap_pkt(skb);
 
-		vhost_add_used(vq, head, sizeof(*hdr) + payload_len);
-		added = true;
+		/* Batch used-ring updates; bulk transfers are split over
+		 * many rx buffers and publishing them one by one makes the
+		 * used-ring cachelines bounce between host and guest.
+		 */
+		vq->heads[done_idx].id = cpu_to_vhost32(vq, head);
+		vq->heads[done_idx].len = cpu_to_vhost32(vq, sizeof(*hdr) +
+							     payload_len);
+		if (++done_idx == VHOST_VSOCK_BATCH) {
+			vhost_add_used_and_signal_n(&vsock->dev, vq, vq->heads,
+						    done_idx);
+			done_idx = 0;
+		}
 
 		VIRTIO_VSOCK_SKB_CB(skb)->offset += payload_len;
 		total_len += payload_len;
@@ -247,8 +260,9 @@ vhost_transport_do_send_pkt(struct vhost_vsock *vsock,
 			consume_skb(skb);
 		}
 	} while(likely(!vhost_exceeds_weight(vq, ++pkts, total_len)));
-	if (added)
-		vhost_signal(&vsock->dev, vq);
+	if (done_idx)
+		vhost_add_used_and_signal_n(&vsock->dev, vq, vq->heads,
+					    done_idx);
 
 out:
 	mutex_unlock(&vq->mutex);
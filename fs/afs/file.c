@@ -299,13 +299,19 @@ int afs_fetch_data(struct afs_vnode *vnode, struct afs_read *req)
 
 	afs_op_set_vnode(op, 0, vnode);
 
+	/* Stripe reads of a replicated volume over the replica set */
+	if (vnode->volume->type == AFSVL_ROVOL)
+		op->flags |= AFS_OPERATION_STRIPE;
+
 	op->fetch.req	= afs_get_read(req);
 	op->ops		= &afs_fetch_data_operation;
 	return afs_do_sync_operation(op);
 }
 
-static void afs_issue_read(struct netfs_io_subrequest *subreq)
+static void afs_read_worker(struct work_struct *work)
 {
+	struct netfs_io_subrequest *subreq =
+		container_of(work, struct netfs_io_subrequest, work);
 	struct afs_vnode *vnode = AFS_FS_I(subreq->rreq->inode);
 	struct afs_read *fsreq;
 
@@ -324,6 +330,18 @@ static void afs_issue_read(struct netfs_io_subrequest *subreq)
 	afs_put_read(fsreq);
 }
 
+/*
+ * Issue a read subrequest.  The fetch is punted to a workqueue so that the
+ * subrequests of a large read run as simultaneous RPCs - possibly to
+ * different fileservers, if the volume is replicated - rather than being
+ * performed synchronously one after another.
+ */
+static void afs_issue_read(struct netfs_io_subrequest *subreq)
+{
+	INIT_WORK(&subreq->work, afs_read_worker);
+	queue_work(afs_wq, &subreq->work);
+}
+
 static int afs_symlink_read_folio(struct file *file, struct folio *folio)
 {
 	struct afs_vnode *vnode = AFS_FS_I(folio->mapping->host);
@@ -654,6 +654,7 @@ struct afs_volume {
 	struct afs_server_list __rcu *servers;	/* List of servers on which volume resides */
 	rwlock_t		servers_lock;	/* Lock for ->servers */
 	unsigned int		servers_seq;	/* Incremented each time ->servers changes */
+	atomic_t		rr_rotor;	/* Replica rotor for striped reads */
 
 	/* RO release tracking */
 	struct mutex		volsync_lock;	/* Time/state evaluation lock */
@@ -958,6 +959,7 @@ struct afs_operation {
 #define AFS_OPERATION_TRIED_ALL		0x0400	/* Set if we've tried all the fileservers */
 #define AFS_OPERATION_RETRY_SERVER	0x0800	/* Set if we should retry the current server */
 #define AFS_OPERATION_DIR_CONFLICT	0x1000	/* Set if we detected a 3rd-party dir change */
+#define AFS_OPERATION_STRIPE		0x2000	/* Set to stripe over a replica set */
 };
 
 /*
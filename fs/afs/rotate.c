@@ -149,6 +149,47 @@ static bool afs_sleep_and_retry(struct afs_operation *op)
  * Select the fileserver to use.  May be called multiple times to rotate
  * through the fileservers.
  */
+/*
+ * Pick the next replica in the ring for a striped read of a replicated
+ * volume.  A per-volume rotor spreads successive fetches over the replica
+ * set so that large reads aggregate the bandwidth of all the servers.
+ * Failover is unchanged: servers that failed have already been removed from
+ * op->untried_servers, and the next candidate is simply the next replica.
+ *
+ * Called with the RCU read lock held.
+ */
+static void afs_pick_striped_server(struct afs_operation *op)
+{
+	unsigned int nr = op->server_list->nr_servers;
+	unsigned int rotor = atomic_inc_return(&op->volume->rr_rotor);
+	int i, j, n;
+
+	for (n = 0; n < nr; n++) {
+		struct afs_endpoint_state *es;
+		struct afs_server_entry *se;
+		struct afs_addr_list *sal;
+
+		i = (rotor + n) % nr;
+		se = &op->server_list->servers[i];
+		if (!test_bit(i, &op->untried_servers) ||
+		    test_bit(AFS_SE_EXCLUDED, &se->flags) ||
+		    !test_bit(AFS_SERVER_FL_RESPONDING, &se->server->flags))
+			continue;
+		es = op->server_states[i].endpoint_state;
+		sal = es->addresses;
+
+		afs_get_address_preferences_rcu(op->net, sal);
+		for (j = 0; j < sal->nr_addrs; j++) {
+			if (es->failed_set & (1 << j))
+				continue;
+			if (!sal->addrs[j].peer)
+				continue;
+			op->server_index = i;
+			return;
+		}
+	}
+}
+
 bool afs_select_fileserver(struct afs_operation *op)
 {
 	struct afs_addr_list *alist;
@@ -531,28 +572,32 @@ pick_server:
 	rcu_read_lock();
 	op->server_index = -1;
 	best_prio = -1;
-	for (i = 0; i < op->server_list->nr_servers; i++) {
-		struct afs_endpoint_state *es;
-		struct afs_server_entry *se = &op->server_list->servers[i];
-		struct afs_addr_list *sal;
-		struct afs_server *s = se->server;
-
-		if (!test_bit(i, &op->untried_servers) ||
-		    test_bit(AFS_SE_EXCLUDED, &se->flags) ||
-		    !test_bit(AFS_SERVER_FL_RESPONDING, &s->flags))
-			continue;
-		es = op->server_states[i].endpoint_state;
-		sal = es->addresses;
-
-		afs_get_address_preferences_rcu(op->net, sal);
-		for (j = 0; j < sal->nr_addrs; j++) {
-			if (es->failed_set & (1 << j))
-				continue;
-			if (!sal->addrs[j].peer)
+	if ((op->flags & AFS_OPERATION_STRIPE) && op->server_list->nr_servers > 1)
+		afs_pick_striped_server(op);
+	if (op->server_index == -1) {
+		for (i = 0; i < op->server_list->nr_servers; i++) {
+			struct afs_endpoint_state *es;
+			struct afs_server_entry *se = &op->server_list->servers[i];
+			struct afs_addr_list *sal;
+			struct afs_server *s = se->server;
+
+			if (!test_bit(i, &op->untried_servers) ||
+			    test_bit(AFS_SE_EXCLUDED, &se->flags) ||
+			    !test_bit(AFS_SERVER_FL_RESPONDING, &s->flags))
 				continue;
-			if (sal->addrs[j].prio > best_prio) {
-				op->server_index = i;
-				best_prio = sal->addrs[j].prio;
+			es = op->server_states[i].endpoint_state;
+			sal = es->addresses;
+
+			afs_get_address_preferences_rcu(op->net, sal);
+			for (j = 0; j < sal->nr_addrs; j++) {
+				if (es->failed_set & (1 << j))
+					continue;
+				if (!sal->addrs[j].peer)
+					continue;
+				if (sal->addrs[j].prio > best_prio) {
+					op->server_index = i;
+					best_prio = sal->addrs[j].prio;
+				}
 			}
 		}
 	}
@@ -40,6 +40,7 @@
 #include <linux/migrate.h>
 #include <linux/ramfs.h>
 #include <linux/percpu-refcount.h>
+#include <linux/llist.h>
 #include <linux/mount.h>
 #include <linux/pseudo_fs.h>
 
@@ -85,6 +86,11 @@ struct kioctx_table {
 
 struct kioctx_cpu {
 	unsigned		reqs_available;
+	/*
+	 * Completed iocbs staged here by aio_complete(), folded into the
+	 * user-visible ring by aio_flush_staged().
+	 */
+	struct llist_head	staged;
 };
 
 struct ctx_rq_wait {
@@ -209,6 +215,7 @@ struct aio_kiocb {
 
 	struct list_head	ki_list;	/* the aio core uses this
 						 * for cancellation */
+	struct llist_node	ki_stage;	/* per-CPU completion staging */
 	refcount_t		ki_refcnt;
 
 	/*
@@ -403,6 +410,8 @@ static const struct file_operations aio_ring_fops = {
 	.mmap = aio_ring_mmap,
 };
 
+static void aio_flush_staged(struct kioctx *ctx, bool try);
+
 #if IS_ENABLED(CONFIG_MIGRATION)
 static int aio_migrate_folio(struct address_space *mapping, struct folio *dst,
 			struct folio *src, enum migrate_mode mode)
@@ -470,6 +479,13 @@ static int aio_migrate_folio(struct address_space *mapping, struct folio *dst,
 	ctx->ring_folios[idx] = dst;
 	spin_unlock_irqrestore(&ctx->completion_lock, flags);
 
+	/*
+	 * Holding completion_lock obliges us to fold in any completions
+	 * whose trylock backed off while we held it, or they would stay
+	 * staged until the next completion on their CPU.
+	 */
+	aio_flush_staged(ctx, true);
+
 	/* The old folio is no longer accessible. */
 	folio_put(src);
 
@@ -1043,6 +1059,12 @@ static void user_refill_reqs_available(struct kioctx *ctx)
 	}
 
 	spin_unlock_irq(&ctx->completion_lock);
+
+	/*
+	 * We may have made a staging flusher back off while we held the
+	 * lock; pick up anything it left behind.
+	 */
+	aio_flush_staged(ctx, true);
 }
 
 static bool get_reqs_available(struct kioctx *ctx)
@@ -1124,100 +1146,162 @@ struct aio_waiter {
 	size_t			min_nr;
 };
 
-/* aio_complete
- *	Called when the io request on the given iocb is complete.
+static bool aio_staged_pending(struct kioctx *ctx)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		if (!llist_empty(&per_cpu_ptr(ctx->cpu, cpu)->staged))
+			return true;
+	return false;
+}
+
+/* aio_flush_staged
+ *	Fold completions staged on the per-CPU lists into the user-visible
+ *	ring.  With @try set the lock is only trylocked: if that fails the
+ *	current holder is obliged to re-check the staging lists after
+ *	unlocking, so staged events never linger behind a contended lock.
  */
-static void aio_complete(struct aio_kiocb *iocb)
+static void aio_flush_staged(struct kioctx *ctx, bool try)
 {
-	struct kioctx	*ctx = iocb->ki_ctx;
 	struct aio_ring	*ring;
 	struct io_event	*ev_page, *event;
-	unsigned tail, pos, head, avail;
+	unsigned tail, pos, head, avail, nr;
 	unsigned long	flags;
+	int cpu;
 
-	/*
-	 * Add a completion event to the ring buffer. Must be done holding
-	 * ctx->completion_lock to prevent other code from messing with the tail
-	 * pointer since we might be called from irq context.
-	 */
-	spin_lock_irqsave(&ctx->completion_lock, flags);
+	while (aio_staged_pending(ctx)) {
+		struct llist_node *batch = NULL;
 
-	tail = ctx->tail;
-	pos = tail + AIO_EVENTS_OFFSET;
+		if (try) {
+			if (!spin_trylock_irqsave(&ctx->completion_lock, flags))
+				return;
+		} else {
+			spin_lock_irqsave(&ctx->completion_lock, flags);
+		}
 
-	if (++tail >= ctx->nr_events)
-		tail = 0;
+		nr = 0;
+		tail = ctx->tail;
+		for_each_possible_cpu(cpu) {
+			struct llist_node *node;
 
-	ev_page = folio_address(ctx->ring_folios[pos / AIO_EVENTS_PER_PAGE]);
-	event = ev_page + pos % AIO_EVENTS_PER_PAGE;
+			node = llist_del_all(&per_cpu_ptr(ctx->cpu, cpu)->staged);
+			node = llist_reverse_order(node);
+			while (node) {
+				struct aio_kiocb *iocb =
+					container_of(node, struct aio_kiocb, ki_stage);
 
-	*event = iocb->ki_res;
+				node = node->next;
 
-	flush_dcache_folio(ctx->ring_folios[pos / AIO_EVENTS_PER_PAGE]);
+				pos = tail + AIO_EVENTS_OFFSET;
+				if (++tail >= ctx->nr_events)
+					tail = 0;
 
-	pr_debug("%p[%u]: %p: %p %Lx %Lx %Lx\n", ctx, tail, iocb,
-		 (void __user *)(unsigned long)iocb->ki_res.obj,
-		 iocb->ki_res.data, iocb->ki_res.res, iocb->ki_res.res2);
+				ev_page = folio_address(ctx->ring_folios[pos / AIO_EVENTS_PER_PAGE]);
+				event = ev_page + pos % AIO_EVENTS_PER_PAGE;
 
-	/* after flagging the request as done, we
-	 * must never even look at it again
-	 */
-	smp_wmb();	/* make event visible before updating tail */
+				*event = iocb->ki_res;
 
-	ctx->tail = tail;
+				flush_dcache_folio(ctx->ring_folios[pos / AIO_EVENTS_PER_PAGE]);
 
-	ring = folio_address(ctx->ring_folios[0]);
-	head = ring->head;
-	ring->tail = tail;
-	flush_dcache_folio(ctx->ring_folios[0]);
+				pr_debug("added to ring %p at [%u]\n", iocb, tail);
 
-	ctx->completed_events++;
-	if (ctx->completed_events > 1)
-		refill_reqs_available(ctx, head, tail);
+				/* keep the batch linked for the post-lock work */
+				iocb->ki_stage.next = batch;
+				batch = &iocb->ki_stage;
+				nr++;
+			}
+		}
 
-	avail = tail > head
-		? tail - head
-		: tail + ctx->nr_events - head;
-	spin_unlock_irqrestore(&ctx->completion_lock, flags);
+		if (!nr) {
+			/* another flusher beat us to the whole batch */
+			spin_unlock_irqrestore(&ctx->completion_lock, flags);
+			continue;
+		}
 
-	pr_debug("added to ring %p at [%u]\n", iocb, tail);
+		smp_wmb();	/* make events visible before updating tail */
 
-	/*
-	 * Check if the user asked us to deliver the result through an
-	 * eventfd. The eventfd_signal() function is safe to be called
-	 * from IRQ context.
-	 */
-	if (iocb->ki_eventfd)
-		eventfd_signal(iocb->ki_eventfd);
+		ctx->tail = tail;
 
-	/*
-	 * We have to order our ring_info tail store above and test
-	 * of the wait list below outside the wait lock.  This is
-	 * like in wake_up_bit() where clearing a bit has to be
-	 * ordered with the unlocked test.
-	 */
-	smp_mb();
+		ring = folio_address(ctx->ring_folios[0]);
+		head = ring->head;
+		ring->tail = tail;
+		flush_dcache_folio(ctx->ring_folios[0]);
 
-	if (waitqueue_active(&ctx->wait)) {
-		struct aio_waiter *curr, *next;
-		unsigned long flags;
+		ctx->completed_events += nr;
+		if (ctx->completed_events > 1)
+			refill_reqs_available(ctx, head, tail);
 
-		spin_lock_irqsave(&ctx->wait.lock, flags);
-		list_for_each_entry_safe(curr, next, &ctx->wait.head, w.entry)
-			if (avail >= curr->min_nr) {
-				wake_up_process(curr->w.private);
-				list_del_init_careful(&curr->w.entry);
-			}
-		spin_unlock_irqrestore(&ctx->wait.lock, flags);
+		avail = tail > head
+			? tail - head
+			: tail + ctx->nr_events - head;
+		spin_unlock_irqrestore(&ctx->completion_lock, flags);
+
+		/*
+		 * Check if the user asked us to deliver the result through an
+		 * eventfd. The eventfd_signal() function is safe to be called
+		 * from IRQ context.
+		 */
+		while (batch) {
+			struct aio_kiocb *iocb =
+				container_of(batch, struct aio_kiocb, ki_stage);
+
+			batch = batch->next;
+			if (iocb->ki_eventfd)
+				eventfd_signal(iocb->ki_eventfd);
+			iocb_destroy(iocb);
+		}
+
+		/*
+		 * We have to order our ring_info tail store above and test
+		 * of the wait list below outside the wait lock.  This is
+		 * like in wake_up_bit() where clearing a bit has to be
+		 * ordered with the unlocked test.
+		 */
+		smp_mb();
+
+		if (waitqueue_active(&ctx->wait)) {
+			struct aio_waiter *curr, *next;
+			unsigned long flags;
+
+			spin_lock_irqsave(&ctx->wait.lock, flags);
+			list_for_each_entry_safe(curr, next, &ctx->wait.head, w.entry)
+				if (avail >= curr->min_nr) {
+					wake_up_process(curr->w.private);
+					list_del_init_careful(&curr->w.entry);
+				}
+			spin_unlock_irqrestore(&ctx->wait.lock, flags);
+		}
 	}
 }
 
+/* aio_complete
+ *	Called when the io request on the given iocb is complete.  Stages
+ *	the completion on this CPU's list and tries to fold the staged
+ *	events into the ring; if the completion lock is busy the holder
+ *	picks them up instead, so we never spin on it.  May be called from
+ *	irq context.
+ */
+static void aio_complete(struct aio_kiocb *iocb)
+{
+	struct kioctx	*ctx = iocb->ki_ctx;
+
+	pr_debug("%p: %p: %p %Lx %Lx %Lx\n", ctx, iocb,
+		 (void __user *)(unsigned long)iocb->ki_res.obj,
+		 iocb->ki_res.data, iocb->ki_res.res, iocb->ki_res.res2);
+
+	/*
+	 * The flusher owns the iocb from here on - it gets destroyed once
+	 * its event has been written to the ring.
+	 */
+	llist_add(&iocb->ki_stage, &raw_cpu_ptr(ctx->cpu)->staged);
+	aio_flush_staged(ctx, true);
+}
+
 static inline void iocb_put(struct aio_kiocb *iocb)
 {
-	if (refcount_dec_and_test(&iocb->ki_refcnt)) {
+	if (refcount_dec_and_test(&iocb->ki_refcnt))
 		aio_complete(iocb);
-		iocb_destroy(iocb);
-	}
 }
 
 /* aio_read_events_ring
@@ -1241,6 +1325,10 @@ static long aio_read_events_ring(struct kioctx *ctx,
 	sched_annotate_sleep();
 	mutex_lock(&ctx->ring_lock);
 
+	/* Fold any staged completions in before looking at the tail. */
+	if (aio_staged_pending(ctx))
+		aio_flush_staged(ctx, false);
+
 	/* Access to ->ring_folios here is protected by ctx->ring_lock. */
 	ring = folio_address(ctx->ring_folios[0]);
 	head = ring->head;
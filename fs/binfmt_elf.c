@@ -40,6 +40,7 @@
 #include <linux/sched.h>
 #include <linux/sched/coredump.h>
 #include <linux/sched/task_stack.h>
+#include <linux/sysctl.h>
 #include <linux/sched/cputime.h>
 #include <linux/sizes.h>
 #include <linux/types.h>
@@ -353,6 +354,13 @@ create_elf_tables(struct linux_binprm *bprm, const struct elfhdr *exec,
  * into memory at "addr". (Note that p_filesz is rounded up to the
  * next page, so any extra bytes from the file must be wiped.)
  */
+/*
+ * Minimum p_filesz, in bytes, for which a read-only PT_LOAD segment is
+ * populated at map time instead of being faulted in 4K at a time after
+ * exec.  0 (the default) leaves everything to demand faulting.
+ */
+static unsigned long sysctl_elf_populate_bytes __read_mostly;
+
 static unsigned long elf_map(struct file *filep, unsigned long addr,
 		const struct elf_phdr *eppnt, int prot, int type,
 		unsigned long total_size)
@@ -378,11 +386,21 @@ static unsigned long elf_map(struct file *filep, unsigned long addr,
 	*/
 	if (total_size) {
 		total_size = ELF_PAGEALIGN(total_size);
-		map_addr = vm_mmap(filep, addr, total_size, prot, type, off);
+		map_addr = vm_mmap(filep, addr, total_size, prot,
+				   type & ~MAP_POPULATE, off);
 		if (!BAD_ADDR(map_addr))
 			vm_munmap(map_addr+size, total_size-size);
 	} else
-		map_addr = vm_mmap(filep, addr, size, prot, type, off);
+		map_addr = vm_mmap(filep, addr, size, prot,
+				   type & ~MAP_POPULATE, off);
+
+	/*
+	 * Populate only the segment itself, never the total_size span
+	 * whose tail is unmapped or overmapped by later segments.
+	 * Best effort: a failed populate just leaves demand faulting.
+	 */
+	if (!BAD_ADDR(map_addr) && (type & MAP_POPULATE))
+		mm_populate(map_addr, size);
 
 	if ((type & MAP_FIXED_NOREPLACE) &&
 	    PTR_ERR((void *)map_addr) == -EEXIST)
@@ -1039,6 +1057,19 @@ out_free_interp:
 
 		elf_flags = MAP_PRIVATE;
 
+		/*
+		 * Eagerly populate large read-only segments (text and
+		 * rodata) when the admin asked for it, so cold starts of
+		 * big binaries are bounded by IO bandwidth rather than by
+		 * hundreds of thousands of 4K demand faults.  Writable
+		 * segments stay demand faulted: populating them charges
+		 * private pages the task may never touch.
+		 */
+		if (sysctl_elf_populate_bytes &&
+		    !(elf_ppnt->p_flags & PF_W) &&
+		    elf_ppnt->p_filesz >= sysctl_elf_populate_bytes)
+			elf_flags |= MAP_POPULATE;
+
 		vaddr = elf_ppnt->p_vaddr;
 		/*
 		 * The first time through the loop, first_pt_load is true:
@@ -2101,9 +2132,20 @@ end_coredump:
 
 #endif		/* CONFIG_ELF_CORE */
 
+static struct ctl_table elf_sysctls[] = {
+	{
+		.procname	= "exec-populate-bytes",
+		.data		= &sysctl_elf_populate_bytes,
+		.maxlen		= sizeof(sysctl_elf_populate_bytes),
+		.mode		= 0644,
+		.proc_handler	= proc_doulongvec_minmax,
+	},
+};
+
 static int __init init_elf_binfmt(void)
 {
 	register_binfmt(&elf_format);
+	register_sysctl_init("fs", elf_sysctls);
 	return 0;
 }
 
@@ -55,6 +55,8 @@ struct cachefiles_ondemand_info {
 	int				ondemand_id;
 	enum cachefiles_object_state	state;
 	struct cachefiles_object	*object;
+	struct list_head		read_reqs;	/* in-flight READ requests */
+	spinlock_t			read_reqs_lock;	/* protects read_reqs */
 };
 
 /*
@@ -138,12 +140,35 @@ static inline bool cachefiles_in_ondemand_mode(struct cachefiles_cache *cache)
 struct cachefiles_req {
 	struct cachefiles_object *object;
 	struct completion done;
+	refcount_t ref;
 	int error;
+	loff_t off;			/* READ: requested range start */
+	size_t len;			/* READ: requested range length */
+	struct list_head dedup_link;	/* READ: link in ondemand->read_reqs */
 	struct cachefiles_msg msg;
 };
 
 #define CACHEFILES_REQ_NEW	XA_MARK_1
 
+/*
+ * Wrapper for a kiocb issued against the backing filesystem.
+ */
+struct cachefiles_kiocb {
+	struct kiocb		iocb;
+	refcount_t		ki_refcnt;
+	loff_t			start;
+	union {
+		size_t		skipped;
+		size_t		len;
+	};
+	struct cachefiles_object *object;
+	netfs_io_terminated_t	term_func;
+	void			*term_func_priv;
+	bool			was_async;
+	unsigned int		inval_counter;	/* Copy of cookie->inval_counter */
+	u64			b_writing;
+};
+
 #include <trace/events/cachefiles.h>
 
 static inline
@@ -264,6 +289,7 @@ extern bool cachefiles_cook_key(struct cachefiles_object *object);
  * main.c
  */
 extern struct kmem_cache *cachefiles_object_jar;
+extern struct kmem_cache *cachefiles_kiocb_cache;
 
 /*
  * namei.c
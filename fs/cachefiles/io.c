@@ -10,33 +10,18 @@
 #include <linux/file.h>
 #include <linux/uio.h>
 #include <linux/bio.h>
+#include <linux/blkdev.h>
 #include <linux/falloc.h>
 #include <linux/sched/mm.h>
 #include <trace/events/fscache.h>
 #include "internal.h"
 
-struct cachefiles_kiocb {
-	struct kiocb		iocb;
-	refcount_t		ki_refcnt;
-	loff_t			start;
-	union {
-		size_t		skipped;
-		size_t		len;
-	};
-	struct cachefiles_object *object;
-	netfs_io_terminated_t	term_func;
-	void			*term_func_priv;
-	bool			was_async;
-	unsigned int		inval_counter;	/* Copy of cookie->inval_counter */
-	u64			b_writing;
-};
-
 static inline void cachefiles_put_kiocb(struct cachefiles_kiocb *ki)
 {
 	if (refcount_dec_and_test(&ki->ki_refcnt)) {
 		cachefiles_put_object(ki->object, cachefiles_obj_put_ioreq);
 		fput(ki->iocb.ki_filp);
-		kfree(ki);
+		kmem_cache_free(cachefiles_kiocb_cache, ki);
 	}
 }
 
@@ -80,6 +65,7 @@ static int cachefiles_read(struct netfs_cache_resources *cres,
 {
 	struct cachefiles_object *object;
 	struct cachefiles_kiocb *ki;
+	struct blk_plug plug;
 	struct file *file;
 	unsigned int old_nofs;
 	ssize_t ret = -ENOBUFS;
@@ -131,7 +117,7 @@ static int cachefiles_read(struct netfs_cache_resources *cres,
 	}
 
 	ret = -ENOMEM;
-	ki = kzalloc(sizeof(struct cachefiles_kiocb), GFP_KERNEL);
+	ki = kmem_cache_zalloc(cachefiles_kiocb_cache, GFP_KERNEL);
 	if (!ki)
 		goto presubmission_error;
 
@@ -155,9 +141,11 @@ static int cachefiles_read(struct netfs_cache_resources *cres,
 
 	trace_cachefiles_read(object, file_inode(file), ki->iocb.ki_pos, len - skipped);
 	old_nofs = memalloc_nofs_save();
+	blk_start_plug(&plug);
 	ret = cachefiles_inject_read_error();
 	if (ret == 0)
 		ret = vfs_iocb_iter_read(file, &ki->iocb, iter);
+	blk_finish_plug(&plug);
 	memalloc_nofs_restore(old_nofs);
 	switch (ret) {
 	case -EIOCBQUEUED:
@@ -286,6 +274,7 @@ int __cachefiles_write(struct cachefiles_object *object,
 {
 	struct cachefiles_cache *cache;
 	struct cachefiles_kiocb *ki;
+	struct blk_plug plug;
 	unsigned int old_nofs;
 	ssize_t ret;
 	size_t len = iov_iter_count(iter);
@@ -297,7 +286,7 @@ int __cachefiles_write(struct cachefiles_object *object,
 	       file, file_inode(file)->i_ino, start_pos, len,
 	       i_size_read(file_inode(file)));
 
-	ki = kzalloc(sizeof(struct cachefiles_kiocb), GFP_KERNEL);
+	ki = kmem_cache_zalloc(cachefiles_kiocb_cache, GFP_KERNEL);
 	if (!ki) {
 		if (term_func)
 			term_func(term_func_priv, -ENOMEM, false);
@@ -326,9 +315,11 @@ int __cachefiles_write(struct cachefiles_object *object,
 
 	trace_cachefiles_write(object, file_inode(file), ki->iocb.ki_pos, len);
 	old_nofs = memalloc_nofs_save();
+	blk_start_plug(&plug);
 	ret = cachefiles_inject_write_error();
 	if (ret == 0)
 		ret = vfs_iocb_iter_write(file, &ki->iocb, iter);
+	blk_finish_plug(&plug);
 	memalloc_nofs_restore(old_nofs);
 	switch (ret) {
 	case -EIOCBQUEUED:
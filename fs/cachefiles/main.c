@@ -32,6 +32,7 @@ MODULE_AUTHOR("Red Hat, Inc.");
 MODULE_LICENSE("GPL");
 
 struct kmem_cache *cachefiles_object_jar;
+struct kmem_cache *cachefiles_kiocb_cache;
 
 static struct miscdevice cachefiles_dev = {
 	.minor	= MISC_DYNAMIC_MINOR,
@@ -64,9 +65,20 @@ static int __init cachefiles_init(void)
 		goto error_object_jar;
 	}
 
+	cachefiles_kiocb_cache =
+		kmem_cache_create("cachefiles_kiocb",
+				  sizeof(struct cachefiles_kiocb),
+				  0, SLAB_HWCACHE_ALIGN, NULL);
+	if (!cachefiles_kiocb_cache) {
+		pr_notice("Failed to allocate a kiocb cache\n");
+		goto error_kiocb_cache;
+	}
+
 	pr_info("Loaded\n");
 	return 0;
 
+error_kiocb_cache:
+	kmem_cache_destroy(cachefiles_object_jar);
 error_object_jar:
 	misc_deregister(&cachefiles_dev);
 error_dev:
@@ -85,6 +97,7 @@ static void __exit cachefiles_exit(void)
 {
 	pr_info("Unloading\n");
 
+	kmem_cache_destroy(cachefiles_kiocb_cache);
 	kmem_cache_destroy(cachefiles_object_jar);
 	misc_deregister(&cachefiles_dev);
 	cachefiles_unregister_error_injection();
@@ -4,6 +4,12 @@
 #include <linux/uio.h>
 #include "internal.h"
 
+static void cachefiles_req_put(struct cachefiles_req *req)
+{
+	if (refcount_dec_and_test(&req->ref))
+		kfree(req);
+}
+
 static int cachefiles_ondemand_fd_release(struct inode *inode,
 					  struct file *file)
 {
@@ -22,7 +28,7 @@ static int cachefiles_ondemand_fd_release(struct inode *inode,
 	xas_for_each_marked(&xas, req, ULONG_MAX, CACHEFILES_REQ_NEW) {
 		if (req->msg.object_id == object_id &&
 		    req->msg.opcode == CACHEFILES_OP_CLOSE) {
-			complete(&req->done);
+			complete_all(&req->done);
 			xas_store(&xas, NULL);
 		}
 	}
@@ -95,7 +101,7 @@ static long cachefiles_ondemand_fd_ioctl(struct file *filp, unsigned int ioctl,
 		return -EINVAL;
 
 	trace_cachefiles_ondemand_cread(object, id);
-	complete(&req->done);
+	complete_all(&req->done);
 	return 0;
 }
 
@@ -178,7 +184,7 @@ int cachefiles_ondemand_copen(struct cachefiles_cache *cache, char *args)
 	wake_up_all(&cache->daemon_pollwq);
 
 out:
-	complete(&req->done);
+	complete_all(&req->done);
 	return ret;
 }
 
@@ -353,7 +359,7 @@ ssize_t cachefiles_ondemand_daemon_read(struct cachefiles_cache *cache,
 	/* CLOSE request has no reply */
 	if (msg->opcode == CACHEFILES_OP_CLOSE) {
 		xa_erase(&cache->reqs, id);
-		complete(&req->done);
+		complete_all(&req->done);
 	}
 
 	return n;
@@ -364,7 +370,7 @@ err_put_fd:
 error:
 	xa_erase(&cache->reqs, id);
 	req->error = ret;
-	complete(&req->done);
+	complete_all(&req->done);
 	return ret;
 }
 
@@ -397,6 +403,7 @@ static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
 
 	req->object = object;
 	init_completion(&req->done);
+	refcount_set(&req->ref, 1);
 	req->msg.opcode = opcode;
 	req->msg.len = sizeof(struct cachefiles_msg) + data_len;
 
@@ -453,10 +460,26 @@ static int cachefiles_ondemand_send_req(struct cachefiles_object *object,
 	if (ret)
 		goto out;
 
+	/*
+	 * Publish READ requests so that later reads of an already
+	 * requested range can park on this one instead of sending the
+	 * daemon a duplicate round trip.
+	 */
+	if (opcode == CACHEFILES_OP_READ) {
+		spin_lock(&object->ondemand->read_reqs_lock);
+		list_add_tail(&req->dedup_link, &object->ondemand->read_reqs);
+		spin_unlock(&object->ondemand->read_reqs_lock);
+	}
+
 	wake_up_all(&cache->daemon_pollwq);
 	wait_for_completion(&req->done);
 	ret = req->error;
-	kfree(req);
+	if (opcode == CACHEFILES_OP_READ) {
+		spin_lock(&object->ondemand->read_reqs_lock);
+		list_del(&req->dedup_link);
+		spin_unlock(&object->ondemand->read_reqs_lock);
+	}
+	cachefiles_req_put(req);
 	return ret;
 out:
 	/* Reset the object to close state in error handling path.
@@ -465,7 +488,8 @@ out:
 	 */
 	if (opcode == CACHEFILES_OP_OPEN)
 		cachefiles_ondemand_set_object_close(object);
-	kfree(req);
+	if (req)
+		cachefiles_req_put(req);
 	return ret;
 }
 
@@ -529,6 +553,8 @@ static int cachefiles_ondemand_init_read_req(struct cachefiles_req *req,
 
 	load->off = read_ctx->off;
 	load->len = read_ctx->len;
+	req->off = read_ctx->off;
+	req->len = read_ctx->len;
 	trace_cachefiles_ondemand_read(object, &req->msg, load);
 	return 0;
 }
@@ -578,6 +604,8 @@ int cachefiles_ondemand_init_obj_info(struct cachefiles_object *object,
 		return -ENOMEM;
 
 	object->ondemand->object = object;
+	INIT_LIST_HEAD(&object->ondemand->read_reqs);
+	spin_lock_init(&object->ondemand->read_reqs_lock);
 	INIT_WORK(&object->ondemand->ondemand_work, ondemand_object_worker);
 	return 0;
 }
@@ -592,6 +620,31 @@ int cachefiles_ondemand_read(struct cachefiles_object *object,
 			     loff_t pos, size_t len)
 {
 	struct cachefiles_read_ctx read_ctx = {pos, len};
+	struct cachefiles_ondemand_info *info = object->ondemand;
+	struct cachefiles_req *req;
+	int ret;
+
+	/*
+	 * If an in-flight request already covers this range, wait for it
+	 * to be filled rather than asking the daemon to fetch the same
+	 * data again.  Many tasks faulting the same missing extent thus
+	 * cost one user-agent round trip instead of one each.
+	 */
+	if (info) {
+		spin_lock(&info->read_reqs_lock);
+		list_for_each_entry(req, &info->read_reqs, dedup_link) {
+			if (req->off <= pos &&
+			    req->off + req->len >= pos + len) {
+				refcount_inc(&req->ref);
+				spin_unlock(&info->read_reqs_lock);
+				wait_for_completion(&req->done);
+				ret = req->error;
+				cachefiles_req_put(req);
+				return ret;
+			}
+		}
+		spin_unlock(&info->read_reqs_lock);
+	}
 
 	return cachefiles_ondemand_send_req(object, CACHEFILES_OP_READ,
 			sizeof(struct cachefiles_read),
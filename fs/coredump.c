@@ -867,35 +867,42 @@ void dump_skip(struct coredump_params *cprm, size_t nr)
 EXPORT_SYMBOL(dump_skip);
 
 #ifdef CONFIG_ELF_CORE
-static int dump_emit_page(struct coredump_params *cprm, struct page *page)
+/*
+ * Memory pages are gathered into batches this large and written with a
+ * single kernel_write, so dumping a big heap issues hundreds of KB per
+ * write instead of one write per 4K page.
+ */
+#define DUMP_PAGE_BATCH	128
+
+static int dump_emit_pages(struct coredump_params *cprm, struct bio_vec *bvecs,
+			   int nr)
 {
-	struct bio_vec bvec;
 	struct iov_iter iter;
 	struct file *file = cprm->file;
+	size_t size = (size_t)nr * PAGE_SIZE;
 	loff_t pos;
 	ssize_t n;
 
-	if (!page)
-		return 0;
+	if (!nr)
+		return 1;
 
 	if (cprm->to_skip) {
 		if (!__dump_skip(cprm, cprm->to_skip))
 			return 0;
 		cprm->to_skip = 0;
 	}
-	if (cprm->written + PAGE_SIZE > cprm->limit)
+	if (cprm->written + size > cprm->limit)
 		return 0;
 	if (dump_interrupted())
 		return 0;
 	pos = file->f_pos;
-	bvec_set_page(&bvec, page, PAGE_SIZE, 0);
-	iov_iter_bvec(&iter, ITER_SOURCE, &bvec, 1, PAGE_SIZE);
+	iov_iter_bvec(&iter, ITER_SOURCE, bvecs, nr, size);
 	n = __kernel_write_iter(cprm->file, &iter, &pos);
-	if (n != PAGE_SIZE)
+	if (n != size)
 		return 0;
 	file->f_pos = pos;
-	cprm->written += PAGE_SIZE;
-	cprm->pos += PAGE_SIZE;
+	cprm->written += size;
+	cprm->pos += size;
 
 	return 1;
 }
@@ -908,8 +915,41 @@ static int dump_emit_page(struct coredump_params *cprm, struct page *page)
  */
 #ifdef copy_mc_to_kernel
 
-#define dump_page_alloc() alloc_page(GFP_KERNEL)
-#define dump_page_free(x) __free_page(x)
+static struct page **dump_bounce_alloc(int *batch)
+{
+	struct page **pages;
+	int i;
+
+	pages = kmalloc_array(*batch, sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return NULL;
+	for (i = 0; i < *batch; i++) {
+		pages[i] = alloc_page(GFP_KERNEL);
+		if (!pages[i])
+			break;
+	}
+	if (!i) {
+		kfree(pages);
+		return NULL;
+	}
+	/* dump with whatever batch size we could get pages for */
+	*batch = i;
+	return pages;
+}
+
+static void dump_bounce_free(struct page **pages, int batch)
+{
+	int i;
+
+	if (IS_ERR_OR_NULL(pages))
+		return;
+	for (i = 0; i < batch; i++)
+		__free_page(pages[i]);
+	kfree(pages);
+}
+
+#define dump_bounce_page(pages, idx) ((pages)[(idx)])
+
 static struct page *dump_page_copy(struct page *src, struct page *dst)
 {
 	void *buf = kmap_local_page(src);
@@ -920,24 +960,55 @@ static struct page *dump_page_copy(struct page *src, struct page *dst)
 
 #else
 
-/* We just want to return non-NULL; it's never used. */
-#define dump_page_alloc() ERR_PTR(-EINVAL)
-#define dump_page_free(x) ((void)(x))
+/*
+ * No bounce pages: the user pages are written directly.  The returned
+ * cookie just needs to be non-NULL and IS_ERR so dump_flush_pages()
+ * knows it holds the page references; it's never dereferenced.
+ */
+static inline struct page **dump_bounce_alloc(int *batch)
+{
+	return ERR_PTR(-EINVAL);
+}
+static inline void dump_bounce_free(struct page **pages, int batch) { }
+#define dump_bounce_page(pages, idx) ((struct page *)NULL)
 static inline struct page *dump_page_copy(struct page *src, struct page *dst)
 {
 	return src;
 }
 #endif
 
+static int dump_flush_pages(struct coredump_params *cprm,
+			    struct bio_vec *bvecs, int nr,
+			    struct page **bounce)
+{
+	int ret, i;
+
+	ret = dump_emit_pages(cprm, bvecs, nr);
+	if (IS_ERR(bounce)) {
+		/* the batch held references on the user pages themselves */
+		for (i = 0; i < nr; i++)
+			put_page(bvecs[i].bv_page);
+	}
+	return ret;
+}
+
 int dump_user_range(struct coredump_params *cprm, unsigned long start,
 		    unsigned long len)
 {
 	unsigned long addr;
-	struct page *dump_page;
+	struct bio_vec *bvecs;
+	struct page **bounce;
+	int batch = DUMP_PAGE_BATCH;
+	int nr = 0, ret = 0;
 
-	dump_page = dump_page_alloc();
-	if (!dump_page)
+	bounce = dump_bounce_alloc(&batch);
+	if (!bounce)
 		return 0;
+	bvecs = kmalloc_array(batch, sizeof(*bvecs), GFP_KERNEL);
+	if (!bvecs) {
+		dump_bounce_free(bounce, batch);
+		return 0;
+	}
 
 	for (addr = start; addr < start + len; addr += PAGE_SIZE) {
 		struct page *page;
@@ -951,18 +1022,50 @@ int dump_user_range(struct coredump_params *cprm, unsigned long start,
 		 */
 		page = get_dump_page(addr);
 		if (page) {
-			int stop = !dump_emit_page(cprm, dump_page_copy(page, dump_page));
-			put_page(page);
-			if (stop) {
-				dump_page_free(dump_page);
-				return 0;
+			struct page *out;
+
+			out = dump_page_copy(page, dump_bounce_page(bounce, nr));
+			if (out != page)
+				put_page(page);
+			if (!out)
+				goto out;
+
+			bvec_set_page(&bvecs[nr], out, PAGE_SIZE, 0);
+			if (++nr == batch) {
+				nr = 0;
+				if (!dump_flush_pages(cprm, bvecs, batch,
+						      bounce))
+					goto out;
 			}
 		} else {
+			/*
+			 * Write out what we have gathered before recording
+			 * the hole, since emitting applies any pending skip
+			 * ahead of the data.
+			 */
+			if (nr) {
+				ret = dump_flush_pages(cprm, bvecs, nr, bounce);
+				nr = 0;
+				if (!ret)
+					goto out;
+				ret = 0;
+			}
 			dump_skip(cprm, PAGE_SIZE);
 		}
 	}
-	dump_page_free(dump_page);
-	return 1;
+	ret = dump_flush_pages(cprm, bvecs, nr, bounce);
+	nr = 0;
+out:
+	/* drop references a failed batch was still holding */
+	if (nr && IS_ERR(bounce)) {
+		int i;
+
+		for (i = 0; i < nr; i++)
+			put_page(bvecs[i].bv_page);
+	}
+	kfree(bvecs);
+	dump_bounce_free(bounce, batch);
+	return ret;
 }
 #endif
 
@@ -152,6 +152,168 @@ int fscrypt_crypt_data_unit(const struct fscrypt_inode_info *ci,
 	return 0;
 }
 
+/*
+ * Number of data unit requests kept in flight at once when crypting a
+ * multi-unit range.  Each data unit takes its own IV, so one request can
+ * never cover more than one unit; the next best thing is to keep a small
+ * pipeline of requests outstanding so that async crypto engines see some
+ * queue depth instead of a strict submit-wait cycle per unit.  Synchronous
+ * tfms complete each request inline and only benefit from the request reuse.
+ */
+#define FSCRYPT_MAX_INFLIGHT_UNITS	8
+
+struct fscrypt_unit_req {
+	struct skcipher_request *req;
+	union fscrypt_iv iv;
+	struct scatterlist src, dst;
+};
+
+struct fscrypt_crypt_batch {
+	atomic_t pending;
+	int err;
+	struct completion done;
+};
+
+static void fscrypt_batch_done(void *data, int err)
+{
+	struct fscrypt_crypt_batch *batch = data;
+
+	if (err == -EINPROGRESS)
+		return;	/* a backlogged request was moved onto the queue */
+	if (err)
+		cmpxchg(&batch->err, 0, err);
+	if (atomic_dec_and_test(&batch->pending))
+		complete(&batch->done);
+}
+
+static void fscrypt_batch_submit(const struct fscrypt_inode_info *ci,
+				 fscrypt_direction_t rw, u64 index,
+				 struct fscrypt_unit_req *ureq,
+				 struct page *src_page, struct page *dest_page,
+				 unsigned int du_size, unsigned int offs,
+				 struct fscrypt_crypt_batch *batch)
+{
+	int res;
+
+	fscrypt_generate_iv(&ureq->iv, index, ci);
+	sg_init_table(&ureq->dst, 1);
+	sg_set_page(&ureq->dst, dest_page, du_size, offs);
+	sg_init_table(&ureq->src, 1);
+	sg_set_page(&ureq->src, src_page, du_size, offs);
+	skcipher_request_set_crypt(ureq->req, &ureq->src, &ureq->dst, du_size,
+				   &ureq->iv);
+	atomic_inc(&batch->pending);
+	if (rw == FS_DECRYPT)
+		res = crypto_skcipher_decrypt(ureq->req);
+	else
+		res = crypto_skcipher_encrypt(ureq->req);
+	if (res == -EINPROGRESS || res == -EBUSY)
+		return;	/* in flight; fscrypt_batch_done() will account it */
+	if (res)
+		cmpxchg(&batch->err, 0, res);
+	atomic_dec(&batch->pending);
+}
+
+/*
+ * Encrypt or decrypt a range of contiguous data units starting at byte offset
+ * @offs into @src_folio.  The ciphertext goes to the same offsets of
+ * @dest_page if it is non-NULL (in which case the range must lie within one
+ * page of @src_folio), or back in place otherwise.
+ *
+ * Unlike a loop over fscrypt_crypt_data_unit(), this reuses a pipeline of
+ * requests across the units instead of reallocating one per unit, and it
+ * waits once per pipeline-ful of units rather than once per unit.
+ */
+static int fscrypt_crypt_data_units(const struct fscrypt_inode_info *ci,
+				    fscrypt_direction_t rw, u64 index,
+				    struct folio *src_folio,
+				    struct page *dest_page,
+				    unsigned int len, unsigned int offs,
+				    gfp_t gfp_flags)
+{
+	const unsigned int du_bits = ci->ci_data_unit_bits;
+	const unsigned int du_size = 1U << du_bits;
+	struct crypto_skcipher *tfm = ci->ci_enc_key.tfm;
+	struct fscrypt_crypt_batch batch;
+	struct fscrypt_unit_req *ureqs;
+	unsigned int nr_reqs, i;
+	unsigned int pos = offs;
+	int res = 0;
+
+	nr_reqs = min_t(unsigned int, len >> du_bits,
+			FSCRYPT_MAX_INFLIGHT_UNITS);
+	if (nr_reqs <= 1)
+		goto fallback;
+	ureqs = kmalloc_array(nr_reqs, sizeof(*ureqs), gfp_flags);
+	if (!ureqs)
+		goto fallback;
+	for (i = 0; i < nr_reqs; i++) {
+		ureqs[i].req = skcipher_request_alloc(tfm, gfp_flags);
+		if (!ureqs[i].req) {
+			while (i--)
+				skcipher_request_free(ureqs[i].req);
+			kfree(ureqs);
+			goto fallback;
+		}
+		skcipher_request_set_callback(ureqs[i].req,
+					      CRYPTO_TFM_REQ_MAY_BACKLOG |
+					      CRYPTO_TFM_REQ_MAY_SLEEP,
+					      fscrypt_batch_done, &batch);
+	}
+
+	init_completion(&batch.done);
+	while (len) {
+		unsigned int n = min_t(unsigned int, len >> du_bits, nr_reqs);
+		u64 wave_index = index;
+
+		atomic_set(&batch.pending, 1);
+		batch.err = 0;
+		reinit_completion(&batch.done);
+		for (i = 0; i < n; i++) {
+			struct page *src_page =
+				folio_page(src_folio, pos >> PAGE_SHIFT);
+			unsigned int poff = pos & ~PAGE_MASK;
+
+			fscrypt_batch_submit(ci, rw, index, &ureqs[i],
+					     src_page, dest_page ?: src_page,
+					     du_size, poff, &batch);
+			index++;
+			pos += du_size;
+			len -= du_size;
+		}
+		if (!atomic_dec_and_test(&batch.pending))
+			wait_for_completion(&batch.done);
+		res = batch.err;
+		if (res) {
+			fscrypt_err(ci->ci_inode,
+				    "%scryption failed for data units at %llu: %d",
+				    (rw == FS_DECRYPT ? "De" : "En"),
+				    wave_index, res);
+			break;
+		}
+	}
+
+	for (i = 0; i < nr_reqs; i++)
+		skcipher_request_free(ureqs[i].req);
+	kfree(ureqs);
+	return res;
+
+fallback:
+	/* A single-unit range, or no memory for the pipeline */
+	for (; len; len -= du_size, pos += du_size, index++) {
+		struct page *src_page =
+			folio_page(src_folio, pos >> PAGE_SHIFT);
+		unsigned int poff = pos & ~PAGE_MASK;
+
+		res = fscrypt_crypt_data_unit(ci, rw, index, src_page,
+					      dest_page ?: src_page,
+					      du_size, poff, gfp_flags);
+		if (res)
+			return res;
+	}
+	return 0;
+}
+
 /**
  * fscrypt_encrypt_pagecache_blocks() - Encrypt data from a pagecache page
  * @page: the locked pagecache page containing the data to encrypt
@@ -187,10 +349,10 @@ struct page *fscrypt_encrypt_pagecache_blocks(struct page *page,
 	const struct fscrypt_inode_info *ci = inode->i_crypt_info;
 	const unsigned int du_bits = ci->ci_data_unit_bits;
 	const unsigned int du_size = 1U << du_bits;
+	struct folio *folio = page_folio(page);
 	struct page *ciphertext_page;
 	u64 index = ((u64)page->index << (PAGE_SHIFT - du_bits)) +
 		    (offs >> du_bits);
-	unsigned int i;
 	int err;
 
 	if (WARN_ON_ONCE(!PageLocked(page)))
@@ -203,14 +365,13 @@ struct page *fscrypt_encrypt_pagecache_blocks(struct page *page,
 	if (!ciphertext_page)
 		return ERR_PTR(-ENOMEM);
 
-	for (i = offs; i < offs + len; i += du_size, index++) {
-		err = fscrypt_crypt_data_unit(ci, FS_ENCRYPT, index,
-					      page, ciphertext_page,
-					      du_size, i, gfp_flags);
-		if (err) {
-			fscrypt_free_bounce_page(ciphertext_page);
-			return ERR_PTR(err);
-		}
+	err = fscrypt_crypt_data_units(ci, FS_ENCRYPT, index, folio,
+				       ciphertext_page, len,
+				       folio_page_idx(folio, page) * PAGE_SIZE +
+				       offs, gfp_flags);
+	if (err) {
+		fscrypt_free_bounce_page(ciphertext_page);
+		return ERR_PTR(err);
 	}
 	SetPagePrivate(ciphertext_page);
 	set_page_private(ciphertext_page, (unsigned long)page);
@@ -272,8 +433,6 @@ int fscrypt_decrypt_pagecache_blocks(struct folio *folio, size_t len,
 	const unsigned int du_size = 1U << du_bits;
 	u64 index = ((u64)folio->index << (PAGE_SHIFT - du_bits)) +
 		    (offs >> du_bits);
-	size_t i;
-	int err;
 
 	if (WARN_ON_ONCE(!folio_test_locked(folio)))
 		return -EINVAL;
@@ -281,16 +440,8 @@ int fscrypt_decrypt_pagecache_blocks(struct folio *folio, size_t len,
 	if (WARN_ON_ONCE(len <= 0 || !IS_ALIGNED(len | offs, du_size)))
 		return -EINVAL;
 
-	for (i = offs; i < offs + len; i += du_size, index++) {
-		struct page *page = folio_page(folio, i >> PAGE_SHIFT);
-
-		err = fscrypt_crypt_data_unit(ci, FS_DECRYPT, index, page,
-					      page, du_size, i & ~PAGE_MASK,
-					      GFP_NOFS);
-		if (err)
-			return err;
-	}
-	return 0;
+	return fscrypt_crypt_data_units(ci, FS_DECRYPT, index, folio, NULL,
+					len, offs, GFP_NOFS);
 }
 EXPORT_SYMBOL(fscrypt_decrypt_pagecache_blocks);
 
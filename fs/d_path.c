@@ -4,6 +4,8 @@
 #include <linux/uaccess.h>
 #include <linux/fs_struct.h>
 #include <linux/fs.h>
+#include <linux/hash.h>
+#include <linux/init.h>
 #include <linux/slab.h>
 #include <linux/prefetch.h>
 #include "mount.h"
@@ -236,6 +238,167 @@ char *d_absolute_path(const struct path *path,
 	return extract_string(&b);
 }
 
+/*
+ * Lookaside cache of rendered pathnames.
+ *
+ * Audit-style workloads call d_path() for the same handful of hot paths
+ * over and over, and each call repeats the full ancestor walk (retrying
+ * under rename_lock if anything in the tree is being renamed).  Cache the
+ * finished string instead, keyed by the (dentry, vfsmount, root) triple,
+ * and validate it purely by the global rename_lock and mount_lock
+ * sequence counts observed when it was rendered: any rename or mount
+ * topology change bumps one of them and silently invalidates every entry.
+ *
+ * The cache is direct-mapped and holds no references.  A slot may only
+ * hit for the dentry the caller passed in, which the caller keeps alive,
+ * so the one remaining reuse hazard - a slot outliving its dentry and
+ * matching an unrelated dentry later allocated at the same address - is
+ * closed by dentry_free() zapping the slot before the memory can be
+ * recycled.  Mounts cannot be reused without a mount_lock bump, which
+ * already invalidates the slot, and only roots that are mount roots are
+ * cached: they are pinned by their mount, so their address likewise
+ * cannot be recycled without a bump.  A chroot root is an ordinary
+ * dentry with no such guarantee, so paths relative to one are not
+ * cached.
+ */
+#define D_PATH_CACHE_SHIFT	8
+#define D_PATH_CACHE_SIZE	(1 << D_PATH_CACHE_SHIFT)
+#define D_PATH_CACHE_NAMELEN	120
+
+struct d_path_cache_slot {
+	spinlock_t lock;
+	const struct dentry *dentry;
+	const struct vfsmount *mnt;
+	const struct dentry *root_dentry;
+	const struct vfsmount *root_mnt;
+	unsigned int rename_seq;
+	unsigned int mount_seq;
+	unsigned int len;
+	char name[D_PATH_CACHE_NAMELEN];
+};
+
+static struct d_path_cache_slot d_path_cache[D_PATH_CACHE_SIZE];
+static bool d_path_cache_ready __read_mostly;
+
+static struct d_path_cache_slot *d_path_cache_slot(const struct dentry *dentry)
+{
+	return &d_path_cache[hash_ptr(dentry, D_PATH_CACHE_SHIFT)];
+}
+
+/*
+ * Called from dentry_free() so that a slot never outlives the dentry it
+ * was keyed by; @dentry is dead, only its address is compared.
+ */
+void d_path_cache_zap(const struct dentry *dentry)
+{
+	struct d_path_cache_slot *slot;
+
+	if (!smp_load_acquire(&d_path_cache_ready))
+		return;
+	slot = d_path_cache_slot(dentry);
+	if (READ_ONCE(slot->dentry) != dentry)
+		return;
+	spin_lock(&slot->lock);
+	if (slot->dentry == dentry)
+		slot->dentry = NULL;
+	spin_unlock(&slot->lock);
+}
+
+static char *d_path_cache_lookup(const struct path *path,
+				 const struct path *root,
+				 char *buf, int buflen)
+{
+	struct d_path_cache_slot *slot;
+	unsigned int rseq, mseq;
+	char *res = NULL;
+
+	if (!smp_load_acquire(&d_path_cache_ready))
+		return NULL;
+	slot = d_path_cache_slot(path->dentry);
+	if (READ_ONCE(slot->dentry) != path->dentry)
+		return NULL;
+
+	/*
+	 * A slot is valid iff neither sequence count has moved since it
+	 * was filled; like the walk itself, the copied name is then known
+	 * to have been correct at the read_seqbegin() point.
+	 */
+	rseq = read_seqbegin(&rename_lock);
+	mseq = read_seqbegin(&mount_lock);
+
+	spin_lock(&slot->lock);
+	if (slot->dentry == path->dentry && slot->mnt == path->mnt &&
+	    slot->root_dentry == root->dentry &&
+	    slot->root_mnt == root->mnt &&
+	    slot->rename_seq == rseq && slot->mount_seq == mseq &&
+	    slot->len < buflen) {
+		res = buf + buflen - slot->len - 1;
+		memcpy(res, slot->name, slot->len);
+		res[slot->len] = '\0';
+	}
+	spin_unlock(&slot->lock);
+	return res;
+}
+
+/*
+ * @root_is_mnt_root is whether root->dentry == root->mnt->mnt_root, sampled
+ * by the caller while it was still under rcu_read_lock(): no reference is
+ * held on @root, so the mount must not be dereferenced here.
+ */
+static void d_path_cache_fill(const struct path *path,
+			      const struct path *root, const char *name,
+			      bool root_is_mnt_root,
+			      unsigned int rseq, unsigned int mseq)
+{
+	struct d_path_cache_slot *slot;
+	size_t len = strlen(name);
+
+	if (!smp_load_acquire(&d_path_cache_ready))
+		return;
+	if (len >= D_PATH_CACHE_NAMELEN)
+		return;
+	/*
+	 * Only mount roots are acceptable keys; see the comment at the top
+	 * of the cache.  A freed chroot root dentry could be reallocated at
+	 * the same address without anything bumping mount_lock.
+	 */
+	if (!root_is_mnt_root)
+		return;
+	/*
+	 * Only publish a name whose walk was consistent: if either count
+	 * moved while we rendered, the string may mix old and new
+	 * topology.  The caller still holds a reference on @path, so
+	 * dentry_free() cannot zap this slot from under the insert.
+	 */
+	if (read_seqretry(&rename_lock, rseq) ||
+	    read_seqretry(&mount_lock, mseq))
+		return;
+
+	slot = d_path_cache_slot(path->dentry);
+	if (!spin_trylock(&slot->lock))
+		return;
+	slot->dentry = path->dentry;
+	slot->mnt = path->mnt;
+	slot->root_dentry = root->dentry;
+	slot->root_mnt = root->mnt;
+	slot->rename_seq = rseq;
+	slot->mount_seq = mseq;
+	slot->len = len;
+	memcpy(slot->name, name, len);
+	spin_unlock(&slot->lock);
+}
+
+static int __init d_path_cache_init(void)
+{
+	int i;
+
+	for (i = 0; i < D_PATH_CACHE_SIZE; i++)
+		spin_lock_init(&d_path_cache[i].lock);
+	smp_store_release(&d_path_cache_ready, true);
+	return 0;
+}
+fs_initcall(d_path_cache_init);
+
 static void get_fs_root_rcu(struct fs_struct *fs, struct path *root)
 {
 	unsigned seq;
@@ -265,7 +428,12 @@ static void get_fs_root_rcu(struct fs_struct *fs, struct path *root)
 char *d_path(const struct path *path, char *buf, int buflen)
 {
 	DECLARE_BUFFER(b, buf, buflen);
+	unsigned int rseq, mseq;
 	struct path root;
+	bool root_is_mnt_root;
+	bool deleted;
+	char *res;
+	int err;
 
 	/*
 	 * We have various synthetic filesystems that never get mounted.  On
@@ -284,14 +452,30 @@ char *d_path(const struct path *path, char *buf, int buflen)
 
 	rcu_read_lock();
 	get_fs_root_rcu(current->fs, &root);
-	if (unlikely(d_unlinked(path->dentry)))
+	if (unlikely(d_unlinked(path->dentry))) {
+		deleted = true;
 		prepend(&b, " (deleted)", 11);
-	else
+	} else {
+		res = d_path_cache_lookup(path, &root, buf, buflen);
+		if (res) {
+			rcu_read_unlock();
+			return res;
+		}
+		deleted = false;
 		prepend_char(&b, 0);
-	prepend_path(path, &root, &b);
+	}
+	rseq = read_seqbegin(&rename_lock);
+	mseq = read_seqbegin(&mount_lock);
+	err = prepend_path(path, &root, &b);
+	/* no reference is held on root, only sample it under RCU */
+	root_is_mnt_root = root.dentry == root.mnt->mnt_root;
 	rcu_read_unlock();
 
-	return extract_string(&b);
+	res = extract_string(&b);
+	if (!IS_ERR(res) && !err && !deleted)
+		d_path_cache_fill(path, &root, res, root_is_mnt_root,
+				  rseq, mseq);
+	return res;
 }
 EXPORT_SYMBOL(d_path);
 
@@ -923,12 +923,22 @@ static void *dax_insert_entry(struct xa_state *xas, struct vm_fault *vmf,
 	return entry;
 }
 
-static int dax_writeback_one(struct xa_state *xas, struct dax_device *dax_dev,
-		struct address_space *mapping, void *entry)
+/*
+ * Prepare one entry for writeback: lock it, clear its TOWRITE tag and
+ * write-protect all mappings of it.  On success the entry is left locked
+ * and *pfnp/*countp/*indexp describe the run of pages to flush; the
+ * caller batches contiguous runs into one cache flush and completes each
+ * entry with dax_writeback_finish().  Returns 0 if the entry needs no
+ * writeback (already done, punched out or reallocated).
+ */
+static int dax_writeback_prep(struct xa_state *xas,
+		struct address_space *mapping, void **entryp,
+		unsigned long *pfnp, unsigned long *countp, pgoff_t *indexp)
 {
 	unsigned long pfn, index, count, end;
 	long ret = 0;
 	struct vm_area_struct *vma;
+	void *entry = *entryp;
 
 	/*
 	 * A page got tagged dirty in DAX mapping? Something is seriously
@@ -996,27 +1006,71 @@ static int dax_writeback_one(struct xa_state *xas, struct dax_device *dax_dev,
 	}
 	i_mmap_unlock_read(mapping);
 
-	dax_flush(dax_dev, page_address(pfn_to_page(pfn)), count * PAGE_SIZE);
-	/*
-	 * After we have flushed the cache, we can clear the dirty tag. There
-	 * cannot be new dirty data in the pfn after the flush has completed as
-	 * the pfn mappings are writeprotected and fault waits for mapping
-	 * entry lock.
-	 */
+	*entryp = entry;
+	*pfnp = pfn;
+	*countp = count;
+	*indexp = xas->xa_index;
+	trace_dax_writeback_one(mapping->host, index, count);
+
 	xas_reset(xas);
 	xas_lock_irq(xas);
-	xas_store(xas, entry);
-	xas_clear_mark(xas, PAGECACHE_TAG_DIRTY);
-	dax_wake_entry(xas, entry, WAKE_NEXT);
-
-	trace_dax_writeback_one(mapping->host, index, count);
-	return ret;
+	return 1;
 
  put_unlocked:
 	put_unlocked_entry(xas, entry, WAKE_NEXT);
 	return ret;
 }
 
+/*
+ * The flush has completed, so clear the dirty tag and unlock the entry.
+ * There cannot be new dirty data in the pfn after the flush as the pfn
+ * mappings are writeprotected and faults wait for the mapping entry lock.
+ */
+static void dax_writeback_finish(struct address_space *mapping, void *entry,
+		pgoff_t index)
+{
+	XA_STATE(xas, &mapping->i_pages, index);
+
+	xas_lock_irq(&xas);
+	xas_store(&xas, entry);
+	xas_clear_mark(&xas, PAGECACHE_TAG_DIRTY);
+	dax_wake_entry(&xas, entry, WAKE_NEXT);
+	xas_unlock_irq(&xas);
+}
+
+/*
+ * Entries whose pfns are contiguous are gathered into one run and the
+ * whole extent is flushed with a single dax_flush() call, so flushing
+ * 4K entries no longer issues cache writebacks one page at a time.
+ */
+#define DAX_WB_BATCH	64
+
+struct dax_wb_batch {
+	void *entries[DAX_WB_BATCH];
+	pgoff_t indices[DAX_WB_BATCH];
+	int nr;
+	unsigned long pfn;	/* first pfn of the run */
+	unsigned long count;	/* pages in the run */
+};
+
+/* Called without the xarray lock held */
+static void dax_wb_batch_flush(struct dax_wb_batch *batch,
+		struct dax_device *dax_dev, struct address_space *mapping)
+{
+	int i;
+
+	if (!batch->nr)
+		return;
+
+	dax_flush(dax_dev, page_address(pfn_to_page(batch->pfn)),
+		  batch->count * PAGE_SIZE);
+	for (i = 0; i < batch->nr; i++)
+		dax_writeback_finish(mapping, batch->entries[i],
+				     batch->indices[i]);
+	batch->nr = 0;
+	batch->count = 0;
+}
+
 /*
  * Flush the mapping to the persistent domain within the byte range of [start,
  * end]. This is required by data integrity operations to ensure file data is
@@ -1028,6 +1082,7 @@ int dax_writeback_mapping_range(struct address_space *mapping,
 	XA_STATE(xas, &mapping->i_pages, wbc->range_start >> PAGE_SHIFT);
 	struct inode *inode = mapping->host;
 	pgoff_t end_index = wbc->range_end >> PAGE_SHIFT;
+	struct dax_wb_batch batch = { .nr = 0 };
 	void *entry;
 	int ret = 0;
 	unsigned int scanned = 0;
@@ -1044,20 +1099,45 @@ int dax_writeback_mapping_range(struct address_space *mapping,
 
 	xas_lock_irq(&xas);
 	xas_for_each_marked(&xas, entry, end_index, PAGECACHE_TAG_TOWRITE) {
-		ret = dax_writeback_one(&xas, dax_dev, mapping, entry);
+		unsigned long pfn, count;
+		pgoff_t index;
+
+		ret = dax_writeback_prep(&xas, mapping, &entry, &pfn, &count,
+					 &index);
 		if (ret < 0) {
 			mapping_set_error(mapping, ret);
 			break;
 		}
+		if (ret > 0) {
+			if (batch.nr == DAX_WB_BATCH ||
+			    (batch.nr && pfn != batch.pfn + batch.count)) {
+				/* run broken, flush what we have gathered */
+				xas_pause(&xas);
+				xas_unlock_irq(&xas);
+				dax_wb_batch_flush(&batch, dax_dev, mapping);
+				xas_lock_irq(&xas);
+			}
+			if (!batch.nr) {
+				batch.pfn = pfn;
+				batch.count = 0;
+			}
+			batch.entries[batch.nr] = entry;
+			batch.indices[batch.nr] = index;
+			batch.nr++;
+			batch.count += count;
+			ret = 0;
+		}
 		if (++scanned % XA_CHECK_SCHED)
 			continue;
 
 		xas_pause(&xas);
 		xas_unlock_irq(&xas);
+		dax_wb_batch_flush(&batch, dax_dev, mapping);
 		cond_resched();
 		xas_lock_irq(&xas);
 	}
 	xas_unlock_irq(&xas);
+	dax_wb_batch_flush(&batch, dax_dev, mapping);
 	trace_dax_writeback_range_done(inode, xas.xa_index, end_index);
 	return ret;
 }
@@ -128,6 +128,9 @@ static DEFINE_PER_CPU(long, nr_dentry);
 static DEFINE_PER_CPU(long, nr_dentry_unused);
 static DEFINE_PER_CPU(long, nr_dentry_negative);
 
+/* Default per-superblock cap on unused negative dentries; 0 disables it */
+static unsigned long sysctl_neg_dentry_limit __read_mostly;
+
 #if defined(CONFIG_SYSCTL) && defined(CONFIG_PROC_FS)
 /* Statistics gathering. */
 static struct dentry_stat_t dentry_stat = {
@@ -191,6 +194,13 @@ static struct ctl_table fs_dcache_sysctls[] = {
 		.mode		= 0444,
 		.proc_handler	= proc_nr_dentry,
 	},
+	{
+		.procname	= "negative-dentry-limit",
+		.data		= &sysctl_neg_dentry_limit,
+		.maxlen		= sizeof(sysctl_neg_dentry_limit),
+		.mode		= 0644,
+		.proc_handler	= proc_doulongvec_minmax,
+	},
 };
 
 static int __init init_fs_dcache_sysctls(void)
@@ -348,6 +358,35 @@ static inline void __d_set_inode_and_type(struct dentry *dentry,
 	smp_store_release(&dentry->d_flags, flags);
 }
 
+static inline long neg_dentry_limit(struct super_block *sb)
+{
+	return sb->s_neg_dentry_max ?: READ_ONCE(sysctl_neg_dentry_limit);
+}
+
+/*
+ * Negative dentries are counted both globally, for dentry-state, and per
+ * superblock, against the (optional) cap. Crossing the cap kicks the sb's
+ * prune work; dropping back below it is the work's job, not ours.
+ */
+static void neg_dentry_inc(struct dentry *dentry)
+{
+	struct super_block *sb = dentry->d_sb;
+	long limit = neg_dentry_limit(sb);
+
+	this_cpu_inc(nr_dentry_negative);
+	percpu_counter_inc(&sb->s_nr_neg_dentry);
+	if (unlikely(limit) &&
+	    percpu_counter_read_positive(&sb->s_nr_neg_dentry) > limit &&
+	    atomic_read(&sb->s_active))
+		schedule_delayed_work(&sb->s_neg_dentry_prune, 0);
+}
+
+static void neg_dentry_dec(struct dentry *dentry)
+{
+	this_cpu_dec(nr_dentry_negative);
+	percpu_counter_dec(&dentry->d_sb->s_nr_neg_dentry);
+}
+
 static inline void __d_clear_type_and_inode(struct dentry *dentry)
 {
 	unsigned flags = READ_ONCE(dentry->d_flags);
@@ -356,12 +395,13 @@ static inline void __d_clear_type_and_inode(struct dentry *dentry)
 	WRITE_ONCE(dentry->d_flags, flags);
 	dentry->d_inode = NULL;
 	if (flags & DCACHE_LRU_LIST)
-		this_cpu_inc(nr_dentry_negative);
+		neg_dentry_inc(dentry);
 }
 
 static void dentry_free(struct dentry *dentry)
 {
 	WARN_ON(!hlist_unhashed(&dentry->d_u.d_alias));
+	d_path_cache_zap(dentry);
 	if (unlikely(dname_external(dentry))) {
 		struct external_name *p = external_name(dentry);
 		if (likely(atomic_dec_and_test(&p->u.count))) {
@@ -426,7 +466,7 @@ static void d_lru_add(struct dentry *dentry)
 	dentry->d_flags |= DCACHE_LRU_LIST;
 	this_cpu_inc(nr_dentry_unused);
 	if (d_is_negative(dentry))
-		this_cpu_inc(nr_dentry_negative);
+		neg_dentry_inc(dentry);
 	WARN_ON_ONCE(!list_lru_add_obj(
 			&dentry->d_sb->s_dentry_lru, &dentry->d_lru));
 }
@@ -437,7 +477,7 @@ static void d_lru_del(struct dentry *dentry)
 	dentry->d_flags &= ~DCACHE_LRU_LIST;
 	this_cpu_dec(nr_dentry_unused);
 	if (d_is_negative(dentry))
-		this_cpu_dec(nr_dentry_negative);
+		neg_dentry_dec(dentry);
 	WARN_ON_ONCE(!list_lru_del_obj(
 			&dentry->d_sb->s_dentry_lru, &dentry->d_lru));
 }
@@ -470,7 +510,7 @@ static void d_lru_isolate(struct list_lru_one *lru, struct dentry *dentry)
 	dentry->d_flags &= ~DCACHE_LRU_LIST;
 	this_cpu_dec(nr_dentry_unused);
 	if (d_is_negative(dentry))
-		this_cpu_dec(nr_dentry_negative);
+		neg_dentry_dec(dentry);
 	list_lru_isolate(lru, &dentry->d_lru);
 }
 
@@ -480,7 +520,7 @@ static void d_lru_shrink_move(struct list_lru_one *lru, struct dentry *dentry,
 	D_FLAG_VERIFY(dentry, DCACHE_LRU_LIST);
 	dentry->d_flags |= DCACHE_SHRINK_LIST;
 	if (d_is_negative(dentry))
-		this_cpu_dec(nr_dentry_negative);
+		neg_dentry_dec(dentry);
 	list_lru_isolate_move(lru, &dentry->d_lru, list);
 }
 
@@ -1157,6 +1197,76 @@ long prune_dcache_sb(struct super_block *sb, struct shrink_control *sc)
 	return freed;
 }
 
+static enum lru_status dentry_lru_isolate_negative(struct list_head *item,
+		struct list_lru_one *lru, spinlock_t *lru_lock, void *arg)
+{
+	struct list_head *freeable = arg;
+	struct dentry	*dentry = container_of(item, struct dentry, d_lru);
+
+	/* inverting the lru lock/d_lock order, same as dentry_lru_isolate() */
+	if (!spin_trylock(&dentry->d_lock))
+		return LRU_SKIP;
+
+	/*
+	 * Only unused negative dentries are fair game here. Rotate positive
+	 * ones so that repeated small walks keep making progress through a
+	 * mixed LRU, and give referenced negatives one more pass, the same
+	 * grace the regular shrinker isolation grants them.
+	 */
+	if (!d_is_negative(dentry) || dentry->d_lockref.count) {
+		spin_unlock(&dentry->d_lock);
+		return LRU_ROTATE;
+	}
+
+	if (dentry->d_flags & DCACHE_REFERENCED) {
+		dentry->d_flags &= ~DCACHE_REFERENCED;
+		spin_unlock(&dentry->d_lock);
+		return LRU_ROTATE;
+	}
+
+	d_lru_shrink_move(lru, dentry, freeable);
+	spin_unlock(&dentry->d_lock);
+
+	return LRU_REMOVED;
+}
+
+/*
+ * Background trim of a superblock's negative dentries, kicked whenever the
+ * count crosses the sb's cap. Nibbles in small batches so a stat() storm on
+ * missing paths is paid back incrementally, not as one giant prune under the
+ * shrinker. Runs under s_umount shared to keep umount away; rearms itself if
+ * the storm is still outrunning it.
+ */
+#define NEG_DENTRY_PRUNE_BATCH	128
+
+void sb_prune_neg_dentry(struct work_struct *work)
+{
+	struct super_block *sb = container_of(work, struct super_block,
+					      s_neg_dentry_prune.work);
+	long limit = neg_dentry_limit(sb);
+	long freed;
+
+	if (!limit || !super_trylock_shared(sb))
+		return;
+
+	do {
+		LIST_HEAD(dispose);
+
+		freed = list_lru_walk(&sb->s_dentry_lru,
+				      dentry_lru_isolate_negative, &dispose,
+				      NEG_DENTRY_PRUNE_BATCH);
+		shrink_dentry_list(&dispose);
+		cond_resched();
+	} while (freed &&
+		 percpu_counter_read_positive(&sb->s_nr_neg_dentry) > limit);
+
+	up_read(&sb->s_umount);
+
+	if (percpu_counter_read_positive(&sb->s_nr_neg_dentry) > limit &&
+	    atomic_read(&sb->s_active))
+		schedule_delayed_work(&sb->s_neg_dentry_prune, HZ / 10);
+}
+
 static enum lru_status dentry_lru_isolate_shrink(struct list_head *item,
 		struct list_lru_one *lru, spinlock_t *lru_lock, void *arg)
 {
@@ -1847,7 +1957,7 @@ static void __d_instantiate(struct dentry *dentry, struct inode *inode)
 	 * Decrement negative dentry count if it was in the LRU list.
 	 */
 	if (dentry->d_flags & DCACHE_LRU_LIST)
-		this_cpu_dec(nr_dentry_negative);
+		neg_dentry_dec(dentry);
 	hlist_add_head(&dentry->d_u.d_alias, &inode->i_dentry);
 	raw_write_seqcount_begin(&dentry->d_seq);
 	__d_set_inode_and_type(dentry, inode, add_flags);
@@ -93,11 +93,13 @@ struct dio_submit {
 					   in dio_blocks units */
 
 	/*
-	 * Deferred addition of a page to the dio.  These variables are
+	 * Deferred addition of a page run to the dio.  These variables are
 	 * private to dio_send_cur_page(), submit_page_section() and
-	 * dio_bio_add_page().
+	 * dio_bio_add_page().  The run starts within cur_page and may extend
+	 * across the following pages of the same folio, so cur_page_offset +
+	 * cur_page_len can exceed PAGE_SIZE.
 	 */
-	struct page *cur_page;		/* The page */
+	struct page *cur_page;		/* First page of the run */
 	unsigned cur_page_offset;	/* Offset into it, in bytes */
 	unsigned cur_page_len;		/* Nr of bytes at cur_page_offset */
 	sector_t cur_page_block;	/* Where it starts */
@@ -680,9 +682,10 @@ out:
 }
 
 /*
- * Attempt to put the current chunk of 'cur_page' into the current BIO.  If
- * that was successful then update final_block_in_bio and take a ref against
- * the just-added page.
+ * Attempt to put the current run of 'cur_page' into the current BIO.  The run
+ * may span several pages of one folio, which stay a single bio_vec.  If that
+ * was successful then update final_block_in_bio and take a ref against each
+ * just-added page.
  *
  * Return zero on success.  Non-zero means the caller needs to start a new BIO.
  */
@@ -693,12 +696,21 @@ static inline int dio_bio_add_page(struct dio *dio, struct dio_submit *sdio)
 	ret = bio_add_page(sdio->bio, sdio->cur_page,
 			sdio->cur_page_len, sdio->cur_page_offset);
 	if (ret == sdio->cur_page_len) {
+		unsigned int run_end = sdio->cur_page_offset +
+				       sdio->cur_page_len;
+		unsigned int npages = DIV_ROUND_UP(run_end, PAGE_SIZE);
+		unsigned int i;
+
+		/*
+		 * Decrement count by the number of pages the run finishes
+		 */
+		sdio->pages_in_io -= run_end >> PAGE_SHIFT;
 		/*
-		 * Decrement count only, if we are done with this page
+		 * The bio needs a pin on every page it covers, as
+		 * bio_release_pages() drops one per page.
 		 */
-		if ((sdio->cur_page_len + sdio->cur_page_offset) == PAGE_SIZE)
-			sdio->pages_in_io--;
-		dio_pin_page(dio, sdio->cur_page);
+		for (i = 0; i < npages; i++)
+			dio_pin_page(dio, sdio->cur_page + i);
 		sdio->final_block_in_bio = sdio->cur_page_block +
 			(sdio->cur_page_len >> sdio->blkbits);
 		ret = 0;
@@ -709,11 +721,12 @@ static inline int dio_bio_add_page(struct dio *dio, struct dio_submit *sdio)
 }
 		
 /*
- * Put cur_page under IO.  The section of cur_page which is described by
- * cur_page_offset,cur_page_len is put into a BIO.  The section of cur_page
- * starts on-disk at cur_page_block.
+ * Put the cur_page run under IO.  The section which is described by
+ * cur_page_offset,cur_page_len is put into a BIO.  The section starts within
+ * cur_page and starts on-disk at cur_page_block.
  *
- * We take a ref against the page here (on behalf of its presence in the bio).
+ * We take refs against the covered pages here (on behalf of their presence in
+ * the bio).
  *
  * The caller of this function is responsible for removing cur_page from the
  * dio, and for dropping the refcount which came from that presence.
@@ -799,14 +812,23 @@ submit_page_section(struct dio *dio, struct dio_submit *sdio, struct page *page,
 	}
 
 	/*
-	 * Can we just grow the current page's presence in the dio?
+	 * Can we just grow the current page run's presence in the dio?  The
+	 * run may extend across the pages of a large folio: those are
+	 * physically contiguous, so the whole run still forms a single
+	 * bio_vec.
 	 */
-	if (sdio->cur_page == page &&
-	    sdio->cur_page_offset + sdio->cur_page_len == offset &&
-	    sdio->cur_page_block +
-	    (sdio->cur_page_len >> sdio->blkbits) == blocknr) {
-		sdio->cur_page_len += len;
-		goto out;
+	if (sdio->cur_page) {
+		unsigned int run_end = sdio->cur_page_offset +
+				       sdio->cur_page_len;
+
+		if (page == sdio->cur_page + (run_end >> PAGE_SHIFT) &&
+		    page_folio(page) == page_folio(sdio->cur_page) &&
+		    offset == (run_end & (PAGE_SIZE - 1)) &&
+		    sdio->cur_page_block +
+		    (sdio->cur_page_len >> sdio->blkbits) == blocknr) {
+			sdio->cur_page_len += len;
+			goto out;
+		}
 	}
 
 	/*
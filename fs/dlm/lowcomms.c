@@ -253,21 +253,6 @@ struct kmem_cache *dlm_lowcomms_msg_cache_create(void)
 }
 
 /* need to held writequeue_lock */
-static struct writequeue_entry *con_next_wq(struct connection *con)
-{
-	struct writequeue_entry *e;
-
-	e = list_first_entry_or_null(&con->writequeue, struct writequeue_entry,
-				     list);
-	/* if len is zero nothing is to send, if there are users filling
-	 * buffers we wait until the users are done so we can send more.
-	 */
-	if (!e || e->users || e->len == 0)
-		return NULL;
-
-	return e;
-}
-
 static struct connection *__find_con(int nodeid, int r)
 {
 	struct connection *con;
@@ -1366,30 +1351,41 @@ int dlm_lowcomms_resend_msg(struct dlm_msg *msg)
 }
 
 /* Send a message */
+/* maximum number of writequeue pages handed to one sendmsg call */
+#define DLM_MAX_SEND_PAGES 8
+
 static int send_to_sock(struct connection *con)
 {
+	struct bio_vec bvecs[DLM_MAX_SEND_PAGES];
 	struct writequeue_entry *e;
-	struct bio_vec bvec;
 	struct msghdr msg = {
 		.msg_flags = MSG_SPLICE_PAGES | MSG_DONTWAIT | MSG_NOSIGNAL,
 	};
-	int len, offset, ret;
+	size_t len = 0;
+	int nvec = 0, ret;
 
 	spin_lock_bh(&con->writequeue_lock);
-	e = con_next_wq(con);
-	if (!e) {
+	/* Batch up every stable entry at the head of the writequeue.
+	 * Only the last entry can have users still filling it, and only
+	 * this work completes entries, so the snapshot taken here stays
+	 * valid after the lock is dropped.
+	 */
+	list_for_each_entry(e, &con->writequeue, list) {
+		if (e->users || e->len == 0)
+			break;
+		bvec_set_page(&bvecs[nvec], e->page, e->len, e->offset);
+		len += e->len;
+		if (++nvec == DLM_MAX_SEND_PAGES)
+			break;
+	}
+	if (!nvec) {
 		clear_bit(CF_SEND_PENDING, &con->flags);
 		spin_unlock_bh(&con->writequeue_lock);
 		return DLM_IO_END;
 	}
-
-	len = e->len;
-	offset = e->offset;
-	WARN_ON_ONCE(len == 0 && e->users == 0);
 	spin_unlock_bh(&con->writequeue_lock);
 
-	bvec_set_page(&bvec, e->page, len, offset);
-	iov_iter_bvec(&msg.msg_iter, ITER_SOURCE, &bvec, 1, len);
+	iov_iter_bvec(&msg.msg_iter, ITER_SOURCE, bvecs, nvec, len);
 	ret = sock_sendmsg(con->sock, &msg);
 	trace_dlm_send(con->nodeid, ret);
 	if (ret == -EAGAIN || ret == 0) {
@@ -1419,7 +1415,13 @@ static int send_to_sock(struct connection *con)
 	}
 
 	spin_lock_bh(&con->writequeue_lock);
-	writequeue_entry_complete(e, ret);
+	while (ret) {
+		e = list_first_entry(&con->writequeue,
+				     struct writequeue_entry, list);
+		len = min_t(size_t, ret, e->len);
+		ret -= len;
+		writequeue_entry_complete(e, len);
+	}
 	spin_unlock_bh(&con->writequeue_lock);
 
 	return DLM_IO_SUCCESS;
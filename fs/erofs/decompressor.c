@@ -204,6 +204,14 @@ int z_erofs_fixup_insize(struct z_erofs_decompress_req *rq, const char *padbuf,
 	return 0;
 }
 
+/*
+ * Decompression sticks with the generic lib/lz4 decoder on every arch.
+ * LZ4 decode is a byte-granular, branch-bound copy loop with no data
+ * parallelism to vectorize, so a SIMD backend would buy little, and
+ * taking kernel_fpu_begin() sections here would pin preemption across
+ * the copy loops on the readahead path.  Parallelism comes from
+ * decompressing pclusters on many CPUs, not from vectorizing one.
+ */
 static int z_erofs_lz4_decompress_mem(struct z_erofs_lz4_decompress_ctx *ctx,
 				      u8 *dst)
 {
@@ -1350,6 +1350,8 @@ static void z_erofs_decompress_queue(const struct z_erofs_decompressqueue *io,
 	}
 }
 
+static void z_erofs_decompress_fanout(struct z_erofs_decompressqueue *bgq);
+
 static void z_erofs_decompressqueue_work(struct work_struct *work)
 {
 	struct z_erofs_decompressqueue *bgq =
@@ -1357,6 +1359,7 @@ static void z_erofs_decompressqueue_work(struct work_struct *work)
 	struct page *pagepool = NULL;
 
 	DBG_BUGON(bgq->head == Z_EROFS_PCLUSTER_TAIL);
+	z_erofs_decompress_fanout(bgq);
 	z_erofs_decompress_queue(bgq, &pagepool);
 	erofs_release_pages(&pagepool);
 	kvfree(bgq);
@@ -1369,6 +1372,71 @@ static void z_erofs_decompressqueue_kthread_work(struct kthread_work *work)
 }
 #endif
 
+/* don't split chains shorter than this; both halves should be worthwhile */
+#define Z_EROFS_FANOUT_MIN	4
+
+/*
+ * Split the latter half of a long pcluster chain off to another CPU so
+ * that a big readahead burst decompresses on several cores instead of
+ * being serialized on the worker that got the final bio completion.
+ * Each new owner splits again on arrival, so the fan-out doubles until
+ * the batches drop below Z_EROFS_FANOUT_MIN pclusters.
+ */
+static void z_erofs_decompress_fanout(struct z_erofs_decompressqueue *bgq)
+{
+	struct z_erofs_decompressqueue *sub;
+	z_erofs_next_pcluster_t pos = bgq->head;
+	struct z_erofs_pcluster *pcl;
+	unsigned int nr = 0, i;
+
+	while (pos != Z_EROFS_PCLUSTER_TAIL) {
+		pcl = container_of(pos, struct z_erofs_pcluster, next);
+		pos = READ_ONCE(pcl->next);
+		++nr;
+	}
+	if (nr < Z_EROFS_FANOUT_MIN)
+		return;
+
+	sub = kvzalloc(sizeof(*sub), GFP_NOFS | __GFP_NOWARN);
+	if (!sub)
+		return;
+
+	pos = bgq->head;
+	for (i = 0; i < nr / 2; ++i) {
+		pcl = container_of(pos, struct z_erofs_pcluster, next);
+		pos = READ_ONCE(pcl->next);
+	}
+	/* this context owns the whole chain, so cutting it is plain stores */
+	sub->sb = bgq->sb;
+	sub->head = pos;
+	sub->eio = bgq->eio;
+	sub->sync = false;
+	pcl->next = Z_EROFS_PCLUSTER_TAIL;
+
+#ifdef CONFIG_EROFS_FS_PCPU_KTHREAD
+	{
+		struct kthread_worker *worker;
+		unsigned int cpu;
+
+		kthread_init_work(&sub->u.kthread_work,
+				  z_erofs_decompressqueue_kthread_work);
+		cpu = cpumask_next(raw_smp_processor_id(), cpu_online_mask);
+		if (cpu >= nr_cpu_ids)
+			cpu = cpumask_first(cpu_online_mask);
+		rcu_read_lock();
+		worker = rcu_dereference(z_erofs_pcpu_workers[cpu]);
+		if (worker) {
+			kthread_queue_work(worker, &sub->u.kthread_work);
+			rcu_read_unlock();
+			return;
+		}
+		rcu_read_unlock();
+	}
+#endif
+	INIT_WORK(&sub->u.work, z_erofs_decompressqueue_work);
+	queue_work(z_erofs_workqueue, &sub->u.work);
+}
+
 static void z_erofs_decompress_kickoff(struct z_erofs_decompressqueue *io,
 				       int bios)
 {
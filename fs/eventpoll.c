@@ -207,6 +207,14 @@ struct eventpoll {
 	 */
 	struct epitem *ovflist;
 
+	/*
+	 * Per-CPU staging lists for ready events, chained through epi->next
+	 * just like ->ovflist, and merged into ->rdllist under the write
+	 * lock once someone actually goes looking for events. Keeps the
+	 * poll callbacks of a shared epoll fd off a single list tail.
+	 */
+	struct epitem * __percpu *rdl_pcpu;
+
 	/* wakeup_source used when ep_send_events or __ep_eventpoll_poll is running */
 	struct wakeup_source *ws;
 
@@ -388,8 +396,16 @@ static inline struct epitem *ep_item_from_wait(wait_queue_entry_t *p)
  */
 static inline int ep_events_available(struct eventpoll *ep)
 {
-	return !list_empty_careful(&ep->rdllist) ||
-		READ_ONCE(ep->ovflist) != EP_UNACTIVE_PTR;
+	int cpu;
+
+	if (!list_empty_careful(&ep->rdllist) ||
+	    READ_ONCE(ep->ovflist) != EP_UNACTIVE_PTR)
+		return 1;
+	for_each_possible_cpu(cpu) {
+		if (READ_ONCE(*per_cpu_ptr(ep->rdl_pcpu, cpu)))
+			return 1;
+	}
+	return 0;
 }
 
 #ifdef CONFIG_NET_RX_BUSY_POLL
@@ -697,6 +713,35 @@ static inline void ep_pm_stay_awake_rcu(struct epitem *epi)
 }
 
 
+/*
+ * Merge the per-CPU staging lists into the main ready list. Must be called
+ * with ep->lock held for writing, which fences out the poll callbacks that
+ * push onto the staging lists under the read lock.
+ */
+static void ep_drain_rdl_pcpu(struct eventpoll *ep)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct epitem *epi, *nepi;
+
+		nepi = xchg(per_cpu_ptr(ep->rdl_pcpu, cpu), NULL);
+		for (epi = nepi; epi; epi = nepi) {
+			nepi = epi->next;
+			epi->next = EP_UNACTIVE_PTR;
+			/*
+			 * ep_insert()/ep_modify() may have linked the item
+			 * directly while it sat on the staging list; don't
+			 * queue it twice.
+			 */
+			if (!ep_is_linked(epi)) {
+				list_add_tail(&epi->rdllink, &ep->rdllist);
+				ep_pm_stay_awake(epi);
+			}
+		}
+	}
+}
+
 /*
  * ep->mutex needs to be held because we could be hit by
  * eventpoll_release_file() and epoll_ctl().
@@ -713,6 +758,7 @@ static void ep_start_scan(struct eventpoll *ep, struct list_head *txlist)
 	 */
 	lockdep_assert_irqs_enabled();
 	write_lock_irq(&ep->lock);
+	ep_drain_rdl_pcpu(ep);
 	list_splice_init(&ep->rdllist, txlist);
 	WRITE_ONCE(ep->ovflist, NULL);
 	write_unlock_irq(&ep->lock);
@@ -789,6 +835,7 @@ static void ep_free(struct eventpoll *ep)
 	mutex_destroy(&ep->mtx);
 	free_uid(ep->user);
 	wakeup_source_unregister(ep->ws);
+	free_percpu(ep->rdl_pcpu);
 	kfree(ep);
 }
 
@@ -838,6 +885,14 @@ static bool __ep_remove(struct eventpoll *ep, struct epitem *epi, bool force)
 	rb_erase_cached(&epi->rbn, &ep->rbr);
 
 	write_lock_irq(&ep->lock);
+	/*
+	 * The item may still sit on a per-CPU staging list. Poll callbacks
+	 * for it are done once ep_unregister_pollwait() has returned, and
+	 * ep->mtx keeps ->ovflist inactive, so a non-default ->next means
+	 * exactly that; one drain moves it onto rdllist for unlinking.
+	 */
+	if (epi->next != EP_UNACTIVE_PTR)
+		ep_drain_rdl_pcpu(ep);
 	if (ep_is_linked(epi))
 		list_del_init(&epi->rdllink);
 	write_unlock_irq(&ep->lock);
@@ -1122,6 +1177,12 @@ static int ep_alloc(struct eventpoll **pep)
 	if (unlikely(!ep))
 		return -ENOMEM;
 
+	ep->rdl_pcpu = alloc_percpu(struct epitem *);
+	if (unlikely(!ep->rdl_pcpu)) {
+		kfree(ep);
+		return -ENOMEM;
+	}
+
 	mutex_init(&ep->mtx);
 	rwlock_init(&ep->lock);
 	init_waitqueue_head(&ep->wq);
@@ -1211,65 +1272,37 @@ struct file *get_epoll_tfile_raw_ptr(struct file *file, int tfd,
 #endif /* CONFIG_KCMP */
 
 /*
- * Adds a new entry to the tail of the list in a lockless way, i.e.
- * multiple CPUs are allowed to call this function concurrently.
- *
- * Beware: it is necessary to prevent any other modifications of the
- *         existing list until all changes are completed, in other words
- *         concurrent list_add_tail_lockless() calls should be protected
- *         with a read lock, where write lock acts as a barrier which
- *         makes sure all list_add_tail_lockless() calls are fully
- *         completed.
- *
- *        Also an element can be locklessly added to the list only in one
- *        direction i.e. either to the tail or to the head, otherwise
- *        concurrent access will corrupt the list.
+ * Chains a new epi entry to the tail of the ep->ovflist in a lockless way,
+ * i.e. multiple CPUs are allowed to call this function concurrently.
  *
- * Return: %false if element has been already added to the list, %true
- * otherwise.
+ * Return: %false if epi element has been already chained, %true otherwise.
  */
-static inline bool list_add_tail_lockless(struct list_head *new,
-					  struct list_head *head)
+static inline bool chain_epi_lockless(struct epitem *epi)
 {
-	struct list_head *prev;
+	struct eventpoll *ep = epi->ep;
 
-	/*
-	 * This is simple 'new->next = head' operation, but cmpxchg()
-	 * is used in order to detect that same element has been just
-	 * added to the list from another CPU: the winner observes
-	 * new->next == new.
-	 */
-	if (!try_cmpxchg(&new->next, &new, head))
+	/* Fast preliminary check */
+	if (epi->next != EP_UNACTIVE_PTR)
 		return false;
 
-	/*
-	 * Initially ->next of a new element must be updated with the head
-	 * (we are inserting to the tail) and only then pointers are atomically
-	 * exchanged.  XCHG guarantees memory ordering, thus ->next should be
-	 * updated before pointers are actually swapped and pointers are
-	 * swapped before prev->next is updated.
-	 */
-
-	prev = xchg(&head->prev, new);
-
-	/*
-	 * It is safe to modify prev->next and new->prev, because a new element
-	 * is added only to the tail and new->next is updated before XCHG.
-	 */
+	/* Check that the same epi has not been just chained from another CPU */
+	if (cmpxchg(&epi->next, EP_UNACTIVE_PTR, NULL) != EP_UNACTIVE_PTR)
+		return false;
 
-	prev->next = new;
-	new->prev = prev;
+	/* Atomically exchange tail */
+	epi->next = xchg(&ep->ovflist, epi);
 
 	return true;
 }
 
 /*
- * Chains a new epi entry to the tail of the ep->ovflist in a lockless way,
- * i.e. multiple CPUs are allowed to call this function concurrently.
+ * Stages an epi entry on the current CPU's ready list. Uses the same
+ * cmpxchg() claim on ->next as chain_epi_lockless() to detect the same epi
+ * arriving concurrently from another CPU's wait queue.
  *
- * Return: %false if epi element has been already chained, %true otherwise.
+ * Return: %false if epi element has been already queued, %true otherwise.
  */
-static inline bool chain_epi_lockless(struct epitem *epi)
+static inline bool stage_epi_lockless(struct epitem *epi)
 {
 	struct eventpoll *ep = epi->ep;
 
@@ -1277,12 +1310,16 @@ static inline bool chain_epi_lockless(struct epitem *epi)
 	if (epi->next != EP_UNACTIVE_PTR)
 		return false;
 
-	/* Check that the same epi has not been just chained from another CPU */
+	/* Check that the same epi has not been just staged from another CPU */
 	if (cmpxchg(&epi->next, EP_UNACTIVE_PTR, NULL) != EP_UNACTIVE_PTR)
 		return false;
 
-	/* Atomically exchange tail */
-	epi->next = xchg(&ep->ovflist, epi);
+	/*
+	 * Only this CPU pushes onto its slot, and the drain side holds the
+	 * write lock against our read lock; the xchg covers the push racing
+	 * with the drain's own xchg of the slot.
+	 */
+	epi->next = xchg(this_cpu_ptr(ep->rdl_pcpu), epi);
 
 	return true;
 }
@@ -1346,8 +1383,12 @@ static int ep_poll_callback(wait_queue_entry_t *wait, unsigned mode, int sync, v
 		if (chain_epi_lockless(epi))
 			ep_pm_stay_awake_rcu(epi);
 	} else if (!ep_is_linked(epi)) {
-		/* In the usual case, add event to ready list. */
-		if (list_add_tail_lockless(&epi->rdllink, &ep->rdllist))
+		/*
+		 * In the usual case, stage the event on this CPU's ready
+		 * list; epoll_wait() merges the staging lists when it goes
+		 * looking for events.
+		 */
+		if (stage_epi_lockless(epi))
 			ep_pm_stay_awake_rcu(epi);
 	}
 
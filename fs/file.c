@@ -26,6 +26,13 @@
 
 unsigned int sysctl_nr_open __read_mostly = 1024*1024;
 unsigned int sysctl_nr_open_min = BITS_PER_LONG;
+/*
+ * Opt-in per-CPU caching of released fd slots, see file_close_fd_cached().
+ * Off by default: a cache hit hands out a slot that need not be the
+ * lowest free fd, which POSIX otherwise guarantees.
+ */
+unsigned int sysctl_fd_cache __read_mostly;
+static void fd_cache_drain(struct files_struct *files);
 /* our min() is unusable in constant expressions ;-/ */
 #define __const_min(x, y) ((x) < (y) ? (x) : (y))
 unsigned int sysctl_nr_open_max =
@@ -324,6 +331,7 @@ struct files_struct *dup_fd(struct files_struct *oldf, unsigned int max_fds, int
 	struct file **old_fds, **new_fds;
 	unsigned int open_files, i;
 	struct fdtable *old_fdt, *new_fdt;
+	bool quiesce = false;
 
 	*errorp = -ENOMEM;
 	newf = kmem_cache_alloc(files_cachep, GFP_KERNEL);
@@ -333,6 +341,7 @@ struct files_struct *dup_fd(struct files_struct *oldf, unsigned int max_fds, int
 	atomic_set(&newf->count, 1);
 
 	spin_lock_init(&newf->file_lock);
+	newf->fd_cache = NULL;
 	newf->resize_in_progress = false;
 	init_waitqueue_head(&newf->resize_wait);
 	newf->next_fd = 0;
@@ -344,6 +353,25 @@ struct files_struct *dup_fd(struct files_struct *oldf, unsigned int max_fds, int
 	new_fdt->fd = &newf->fd_array[0];
 
 	spin_lock(&oldf->file_lock);
+	if (oldf->fd_cache && atomic_read(&oldf->count) > 1) {
+		/*
+		 * Quiesce lockless closers, the same way expand_fdtable()
+		 * quiesces fd_install(): otherwise the copy loop below can
+		 * read a file pointer whose last reference a concurrent
+		 * file_close_fd_cached() is about to drop.
+		 */
+		quiesce = true;
+		oldf->resize_in_progress = true;
+		spin_unlock(&oldf->file_lock);
+		synchronize_rcu();
+		spin_lock(&oldf->file_lock);
+	}
+	/*
+	 * Return parked slots to the bitmaps: their ->open_fds bits would
+	 * otherwise be copied into a child that starts without a cache and
+	 * has nobody to ever hand the slots back.
+	 */
+	fd_cache_drain(oldf);
 	old_fdt = files_fdtable(oldf);
 	open_files = sane_fdtable_size(old_fdt, max_fds);
 
@@ -399,6 +427,10 @@ struct files_struct *dup_fd(struct files_struct *oldf, unsigned int max_fds, int
 		}
 		rcu_assign_pointer(*new_fds++, f);
 	}
+	if (quiesce) {
+		oldf->resize_in_progress = false;
+		wake_up_all(&oldf->resize_wait);
+	}
 	spin_unlock(&oldf->file_lock);
 
 	/* clear the remainder */
@@ -409,6 +441,12 @@ struct files_struct *dup_fd(struct files_struct *oldf, unsigned int max_fds, int
 	return newf;
 
 out_release:
+	if (quiesce) {
+		spin_lock(&oldf->file_lock);
+		oldf->resize_in_progress = false;
+		wake_up_all(&oldf->resize_wait);
+		spin_unlock(&oldf->file_lock);
+	}
 	kmem_cache_free(files_cachep, newf);
 out:
 	return NULL;
@@ -454,6 +492,7 @@ void put_files_struct(struct files_struct *files)
 		/* free the arrays if they are not embedded */
 		if (fdt != &files->fdtab)
 			__free_fdtable(fdt);
+		free_percpu(files->fd_cache);
 		kmem_cache_free(files_cachep, files);
 	}
 }
@@ -561,6 +600,10 @@ out:
 
 int __get_unused_fd_flags(unsigned flags, unsigned long nofile)
 {
+	int fd = alloc_fd_cached(nofile, flags);
+
+	if (fd >= 0)
+		return fd;
 	return alloc_fd(0, nofile, flags);
 }
 
@@ -588,6 +631,206 @@ void put_unused_fd(unsigned int fd)
 
 EXPORT_SYMBOL(put_unused_fd);
 
+/*
+ * Per-CPU fd slot caches.
+ *
+ * With fs.fd-cache enabled, closing an fd can park its slot in a small
+ * per-CPU cache instead of returning it to the bitmaps, and a later
+ * allocation can take the slot back, in both cases without touching
+ * ->file_lock.  A parked slot keeps its bit in ->open_fds set and its
+ * file pointer NULL, which is exactly the state of an open() that has
+ * not reached fd_install() yet, so the rest of the code needs no new
+ * states.  The one exception is dup2() onto a parked slot, which would
+ * see EBUSY forever; see fd_cache_steal().
+ */
+static struct fd_cache __percpu *fd_cache_get(struct files_struct *files)
+{
+	struct fd_cache __percpu *cache = READ_ONCE(files->fd_cache);
+	int cpu;
+
+	if (likely(cache) || !READ_ONCE(sysctl_fd_cache))
+		return cache;
+
+	cache = alloc_percpu(struct fd_cache);
+	if (!cache)
+		return NULL;
+	for_each_possible_cpu(cpu)
+		spin_lock_init(&per_cpu_ptr(cache, cpu)->lock);
+	if (cmpxchg(&files->fd_cache, NULL, cache) != NULL) {
+		free_percpu(cache);
+		cache = files->fd_cache;
+	}
+	return cache;
+}
+
+/*
+ * Take a parked slot, if there is one below @end.  The slot keeps
+ * whatever close-on-exec state its previous user gave it; bitmap writes
+ * stay under ->file_lock, so a mismatch pays for the lock while callers
+ * with consistent O_CLOEXEC usage never do.
+ */
+static int alloc_fd_cached(unsigned long end, unsigned flags)
+{
+	struct files_struct *files = current->files;
+	struct fd_cache __percpu *cache = fd_cache_get(files);
+	struct fdtable *fdt;
+	struct fd_cache *fc;
+	unsigned int fd = UINT_MAX;
+	bool mismatch;
+
+	if (!cache)
+		return -1;
+
+	fc = raw_cpu_ptr(cache);
+	spin_lock(&fc->lock);
+	if (fc->count) {
+		fd = fc->fds[fc->count - 1];
+		if (fd < end)
+			fc->count--;
+		else
+			fd = UINT_MAX;
+	}
+	spin_unlock(&fc->lock);
+	if (fd == UINT_MAX)
+		return -1;
+
+	/*
+	 * Only our own bit is read; it can't change under us since the
+	 * slot is claimed, and the table can only have grown since the
+	 * slot was parked.
+	 */
+	rcu_read_lock_sched();
+	fdt = rcu_dereference_sched(files->fdt);
+	mismatch = test_bit(fd, fdt->close_on_exec) != !!(flags & O_CLOEXEC);
+	rcu_read_unlock_sched();
+
+	if (unlikely(mismatch)) {
+		spin_lock(&files->file_lock);
+		fdt = files_fdtable(files);
+		if (flags & O_CLOEXEC)
+			__set_close_on_exec(fd, fdt);
+		else
+			__clear_close_on_exec(fd, fdt);
+		spin_unlock(&files->file_lock);
+	}
+	return fd;
+}
+
+/*
+ * Try to close @fd and park its slot without taking ->file_lock.  This
+ * follows the same resize protocol as fd_install(): bail out to the
+ * locked path whenever a resize is in flight.  The slot is claimed with
+ * xchg(), pairing with the xchg() the locked closers switch to once a
+ * cache exists, so racing closers agree on a single winner.
+ *
+ * Returns the claimed file, or NULL if the caller should take the
+ * locked path (which also covers a plain bad fd).
+ */
+static struct file *file_close_fd_cached(struct files_struct *files,
+					 unsigned fd)
+{
+	struct fd_cache __percpu *cache = fd_cache_get(files);
+	struct fd_cache *fc;
+	struct fdtable *fdt;
+	struct file *file;
+	bool parked = false;
+
+	if (!cache)
+		return NULL;
+
+	rcu_read_lock_sched();
+	if (unlikely(files->resize_in_progress)) {
+		rcu_read_unlock_sched();
+		return NULL;
+	}
+	/* coupled with smp_wmb() in expand_fdtable() */
+	smp_rmb();
+	fdt = rcu_dereference_sched(files->fdt);
+	if (fd >= fdt->max_fds) {
+		rcu_read_unlock_sched();
+		return NULL;
+	}
+	fd = array_index_nospec(fd, fdt->max_fds);
+	file = xchg(&fdt->fd[fd], NULL);
+	rcu_read_unlock_sched();
+	if (!file)
+		return NULL;
+
+	fc = raw_cpu_ptr(cache);
+	spin_lock(&fc->lock);
+	if (fc->count < FD_CACHE_NR) {
+		fc->fds[fc->count++] = fd;
+		parked = true;
+	}
+	spin_unlock(&fc->lock);
+
+	if (!parked) {
+		spin_lock(&files->file_lock);
+		__put_unused_fd(files, fd);
+		spin_unlock(&files->file_lock);
+	}
+	return file;
+}
+
+/*
+ * dup2() onto a parked slot would otherwise see EBUSY forever: the slot
+ * is claimed in ->open_fds but nobody is going to install a file in it.
+ * Pull it out of whichever per-CPU cache holds it.  Called with
+ * ->file_lock held; each cache lock serializes against the owner
+ * popping the same slot concurrently, so exactly one side gets it.
+ */
+static bool fd_cache_steal(struct files_struct *files, unsigned int fd)
+{
+	struct fd_cache __percpu *cache = READ_ONCE(files->fd_cache);
+	unsigned int i;
+	int cpu;
+
+	if (!cache)
+		return false;
+
+	for_each_possible_cpu(cpu) {
+		struct fd_cache *fc = per_cpu_ptr(cache, cpu);
+		bool found = false;
+
+		spin_lock(&fc->lock);
+		for (i = 0; i < fc->count; i++) {
+			if (fc->fds[i] == fd) {
+				fc->fds[i] = fc->fds[--fc->count];
+				found = true;
+				break;
+			}
+		}
+		spin_unlock(&fc->lock);
+		if (found)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Return every parked slot to the bitmaps.  Called with ->file_lock held
+ * by dup_fd(); concurrent owners popping entries via alloc_fd_cached()
+ * are serialized per cache by fc->lock, so each slot ends up on exactly
+ * one side.
+ */
+static void fd_cache_drain(struct files_struct *files)
+{
+	struct fd_cache __percpu *cache = READ_ONCE(files->fd_cache);
+	int cpu;
+
+	if (!cache)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct fd_cache *fc = per_cpu_ptr(cache, cpu);
+
+		spin_lock(&fc->lock);
+		while (fc->count)
+			__put_unused_fd(files, fc->fds[--fc->count]);
+		spin_unlock(&fc->lock);
+	}
+}
+
 /*
  * Install a file pointer in the fd array.
  *
@@ -655,6 +898,17 @@ struct file *file_close_fd_locked(struct files_struct *files, unsigned fd)
 		return NULL;
 
 	fd = array_index_nospec(fd, fdt->max_fds);
+	/*
+	 * Once a cache exists, file_close_fd_cached() may be claiming the
+	 * same slot without the lock; use the same xchg() so only one
+	 * closer walks away with the file.
+	 */
+	if (unlikely(files->fd_cache)) {
+		file = xchg(&fdt->fd[fd], NULL);
+		if (file)
+			__put_unused_fd(files, fd);
+		return file;
+	}
 	file = fdt->fd[fd];
 	if (file) {
 		rcu_assign_pointer(fdt->fd[fd], NULL);
@@ -668,9 +922,12 @@ int close_fd(unsigned fd)
 	struct files_struct *files = current->files;
 	struct file *file;
 
-	spin_lock(&files->file_lock);
-	file = file_close_fd_locked(files, fd);
-	spin_unlock(&files->file_lock);
+	file = file_close_fd_cached(files, fd);
+	if (!file) {
+		spin_lock(&files->file_lock);
+		file = file_close_fd_locked(files, fd);
+		spin_unlock(&files->file_lock);
+	}
 	if (!file)
 		return -EBADF;
 
@@ -1248,9 +1505,15 @@ __releases(&files->file_lock)
 	 * tables and this condition does not arise without those.
 	 */
 	fdt = files_fdtable(files);
-	tofree = fdt->fd[fd];
-	if (!tofree && fd_is_open(fd, fdt))
-		goto Ebusy;
+	if (unlikely(files->fd_cache))
+		tofree = xchg(&fdt->fd[fd], NULL);
+	else
+		tofree = fdt->fd[fd];
+	if (!tofree && fd_is_open(fd, fdt)) {
+		/* A parked slot is ours for the taking. */
+		if (!fd_cache_steal(files, fd))
+			goto Ebusy;
+	}
 	get_file(file);
 	rcu_assign_pointer(fdt->fd[fd], file);
 	__set_open_fd(fd, fdt);
@@ -129,6 +129,15 @@ static struct ctl_table fs_stat_sysctls[] = {
 		.extra1		= &sysctl_nr_open_min,
 		.extra2		= &sysctl_nr_open_max,
 	},
+	{
+		.procname	= "fd-cache",
+		.data		= &sysctl_fd_cache,
+		.maxlen		= sizeof(unsigned int),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra1		= SYSCTL_ZERO,
+		.extra2		= SYSCTL_ONE,
+	},
 };
 
 static int __init init_fs_stat_sysctls(void)
@@ -435,10 +444,25 @@ out:
 	file_free(file);
 }
 
-static LLIST_HEAD(delayed_fput_list);
-static void delayed_fput(struct work_struct *unused)
+/*
+ * Final fputs from kernel threads and interrupt context are deferred to
+ * workqueue context.  The queues are per-CPU so that teardown storms
+ * releasing millions of files are drained in parallel batches instead
+ * of serializing on one kworker, which used to produce multi-second
+ * spikes on a single CPU.
+ */
+struct delayed_fput_queue {
+	struct llist_head list;
+	struct delayed_work work;
+};
+
+static DEFINE_PER_CPU(struct delayed_fput_queue, delayed_fput_queue);
+
+static void delayed_fput(struct work_struct *work)
 {
-	struct llist_node *node = llist_del_all(&delayed_fput_list);
+	struct delayed_fput_queue *q =
+		container_of(work, struct delayed_fput_queue, work.work);
+	struct llist_node *node = llist_del_all(&q->list);
 	struct file *f, *t;
 
 	llist_for_each_entry_safe(f, t, node, f_llist)
@@ -462,12 +486,20 @@ static void ____fput(struct callback_head *work)
  */
 void flush_delayed_fput(void)
 {
-	delayed_fput(NULL);
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct delayed_fput_queue *q =
+			per_cpu_ptr(&delayed_fput_queue, cpu);
+		struct llist_node *node = llist_del_all(&q->list);
+		struct file *f, *t;
+
+		llist_for_each_entry_safe(f, t, node, f_llist)
+			__fput(f);
+	}
 }
 EXPORT_SYMBOL_GPL(flush_delayed_fput);
 
-static DECLARE_DELAYED_WORK(delayed_fput_work, delayed_fput);
-
 void fput(struct file *file)
 {
 	if (atomic_long_dec_and_test(&file->f_count)) {
@@ -488,8 +520,15 @@ void fput(struct file *file)
 			 */
 		}
 
-		if (llist_add(&file->f_llist, &delayed_fput_list))
-			schedule_delayed_work(&delayed_fput_work, 1);
+		{
+			struct delayed_fput_queue *q;
+
+			q = get_cpu_ptr(&delayed_fput_queue);
+			if (llist_add(&file->f_llist, &q->list))
+				queue_delayed_work_on(smp_processor_id(),
+						      system_wq, &q->work, 1);
+			put_cpu_ptr(&delayed_fput_queue);
+		}
 	}
 }
 
@@ -512,6 +551,16 @@ EXPORT_SYMBOL(__fput_sync);
 
 void __init files_init(void)
 {
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct delayed_fput_queue *q =
+			per_cpu_ptr(&delayed_fput_queue, cpu);
+
+		init_llist_head(&q->list);
+		INIT_DELAYED_WORK(&q->work, delayed_fput);
+	}
+
 	filp_cachep = kmem_cache_create("filp", sizeof(struct file), 0,
 				SLAB_TYPESAFE_BY_RCU | SLAB_HWCACHE_ALIGN |
 				SLAB_PANIC | SLAB_ACCOUNT, NULL);
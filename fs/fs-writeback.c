@@ -29,6 +29,7 @@
 #include <linux/tracepoint.h>
 #include <linux/device.h>
 #include <linux/memcontrol.h>
+#include <linux/sysctl.h>
 #include "internal.h"
 
 /*
@@ -2030,6 +2031,88 @@ static long __writeback_inodes_wb(struct bdi_writeback *wb,
 	return wrote;
 }
 
+/*
+ * Number of concurrent flusher contexts per backing device.  The helpers
+ * only drain what the main flusher has already staged on ->b_io, so this
+ * controls how many threads submit writeback for a single device, not
+ * what gets written or when.
+ */
+static unsigned int wb_nr_flushers __read_mostly = 1;
+
+/*
+ * A helper flusher context.  Writes back whatever the main worker has
+ * staged on ->b_io, racing with it and with the other helpers; exclusion
+ * on individual inodes is provided by I_SYNC, and a contended inode is
+ * simply requeued.
+ */
+static void wb_flush_workfn(struct work_struct *work)
+{
+	struct wb_flush_work *fw = container_of(work, struct wb_flush_work,
+						work);
+	struct bdi_writeback *wb = fw->wb;
+	struct wb_writeback_work fwork = {
+		.nr_pages	= LONG_MAX,
+		.sync_mode	= WB_SYNC_NONE,
+		.range_cyclic	= 1,
+		.reason		= WB_REASON_BACKGROUND,
+	};
+	struct blk_plug plug;
+	long wrote;
+
+	set_worker_desc("flush-%s", bdi_dev_name(wb->bdi));
+
+	/* Leave the rescuer to the main flushers */
+	if (current_is_workqueue_rescuer())
+		return;
+
+	blk_start_plug(&plug);
+	spin_lock(&wb->list_lock);
+	wrote = __writeback_inodes_wb(wb, &fwork);
+	spin_unlock(&wb->list_lock);
+	blk_finish_plug(&plug);
+	trace_writeback_pages_written(wrote);
+}
+
+/*
+ * Kick the helper flusher contexts for @wb after staging a batch on
+ * ->b_io.  Only ever called from @wb's own worker, which also serializes
+ * the one-time setup: there is exactly one main worker per wb.
+ */
+static void wb_kick_flush_helpers(struct bdi_writeback *wb)
+{
+	struct backing_dev_info *bdi = wb->bdi;
+	unsigned int i, nr = READ_ONCE(wb_nr_flushers);
+
+	if (wb != &bdi->wb || nr <= 1)
+		return;
+	if (!bdi->flush_works_init) {
+		for (i = 0; i < WB_MAX_FLUSHERS - 1; i++) {
+			INIT_WORK(&bdi->flush_works[i].work, wb_flush_workfn);
+			bdi->flush_works[i].wb = wb;
+		}
+		bdi->flush_works_init = true;
+	}
+	for (i = 0; i < nr - 1; i++)
+		queue_work(bdi_wq, &bdi->flush_works[i].work);
+}
+
+/*
+ * Wait for the helper contexts to finish.  The main worker does this
+ * before returning so that a helper can never outlive the wb_workfn()
+ * run that kicked it, which keeps wb_shutdown()'s flush of ->dwork
+ * sufficient to quiesce the whole bdi.
+ */
+static void wb_wait_flush_helpers(struct bdi_writeback *wb)
+{
+	struct backing_dev_info *bdi = wb->bdi;
+	unsigned int i;
+
+	if (wb != &bdi->wb || !bdi->flush_works_init)
+		return;
+	for (i = 0; i < WB_MAX_FLUSHERS - 1; i++)
+		flush_work(&bdi->flush_works[i].work);
+}
+
 static long writeback_inodes_wb(struct bdi_writeback *wb, long nr_pages,
 				enum wb_reason reason)
 {
@@ -2122,6 +2205,7 @@ static long wb_writeback(struct bdi_writeback *wb,
 
 			queue_io(wb, work, dirtied_before);
 			queued = true;
+			wb_kick_flush_helpers(wb);
 		}
 		if (work->sb)
 			progress = writeback_sb_inodes(work->sb, wb, work);
@@ -2314,6 +2398,7 @@ void wb_workfn(struct work_struct *work)
 			pages_written = wb_do_writeback(wb);
 			trace_writeback_pages_written(pages_written);
 		} while (!list_empty(&wb->work_list));
+		wb_wait_flush_helpers(wb);
 	} else {
 		/*
 		 * bdi_wq can't get enough workers and we're running off
@@ -2413,6 +2498,27 @@ static int __init start_dirtytime_writeback(void)
 }
 __initcall(start_dirtytime_writeback);
 
+static unsigned int wb_max_flushers = WB_MAX_FLUSHERS;
+
+static struct ctl_table fs_writeback_sysctls[] = {
+	{
+		.procname	= "writeback-flushers",
+		.data		= &wb_nr_flushers,
+		.maxlen		= sizeof(wb_nr_flushers),
+		.mode		= 0644,
+		.proc_handler	= proc_douintvec_minmax,
+		.extra1		= SYSCTL_ONE,
+		.extra2		= &wb_max_flushers,
+	},
+};
+
+static int __init init_fs_writeback_sysctls(void)
+{
+	register_sysctl_init("fs", fs_writeback_sysctls);
+	return 0;
+}
+fs_initcall(init_fs_writeback_sysctls);
+
 int dirtytime_interval_handler(struct ctl_table *table, int write,
 			       void *buffer, size_t *lenp, loff_t *ppos)
 {
@@ -48,6 +48,7 @@ static void fuse_request_init(struct fuse_mount *fm, struct fuse_req *req)
 	refcount_set(&req->count, 1);
 	__set_bit(FR_PENDING, &req->flags);
 	req->fm = fm;
+	req->fiq = &fm->fc->iq;
 }
 
 static struct fuse_req *fuse_request_alloc(struct fuse_mount *fm, gfp_t flags)
@@ -194,8 +195,7 @@ EXPORT_SYMBOL_GPL(fuse_len_args);
 
 u64 fuse_get_unique(struct fuse_iqueue *fiq)
 {
-	fiq->reqctr += FUSE_REQ_ID_STEP;
-	return fiq->reqctr;
+	return atomic64_add_return(FUSE_REQ_ID_STEP, &fiq->reqctr);
 }
 EXPORT_SYMBOL_GPL(fuse_get_unique);
 
@@ -222,6 +222,50 @@ const struct fuse_iqueue_ops fuse_dev_fiq_ops = {
 };
 EXPORT_SYMBOL_GPL(fuse_dev_fiq_ops);
 
+/*
+ * Pick and lock the input queue that the current CPU maps to.  Shards are
+ * installed by FUSE_DEV_IOC_CLONE when the server negotiated
+ * FUSE_CLONE_QUEUES; a shard whose device has been closed is skipped in
+ * favor of the main queue.
+ */
+static struct fuse_iqueue *fuse_lock_iqueue(struct fuse_conn *fc)
+__acquires(fiq->lock)
+{
+	struct fuse_iqueue *fiq = &fc->iq;
+	unsigned int nr = smp_load_acquire(&fc->nr_iqs);
+
+	if (nr) {
+		struct fuse_iqueue *shard;
+
+		shard = fc->iqs[raw_smp_processor_id() % nr];
+		spin_lock(&shard->lock);
+		if (likely(shard->connected))
+			return shard;
+		spin_unlock(&shard->lock);
+	}
+	spin_lock(&fiq->lock);
+	return fiq;
+}
+
+/*
+ * Lock the input queue a request was queued on.  Closing a cloned device
+ * moves its pending requests to the main queue, so req->fiq must be
+ * re-checked once the lock is held.
+ */
+static struct fuse_iqueue *fuse_req_lock_iqueue(struct fuse_req *req)
+__acquires(fiq->lock)
+{
+	struct fuse_iqueue *fiq;
+
+	for (;;) {
+		fiq = READ_ONCE(req->fiq);
+		spin_lock(&fiq->lock);
+		if (likely(fiq == READ_ONCE(req->fiq)))
+			return fiq;
+		spin_unlock(&fiq->lock);
+	}
+}
+
 static void queue_request_and_unlock(struct fuse_iqueue *fiq,
 				     struct fuse_req *req)
 __releases(fiq->lock)
@@ -229,6 +273,7 @@ __releases(fiq->lock)
 	req->in.h.len = sizeof(struct fuse_in_header) +
 		fuse_len_args(req->args->in_numargs,
 			      (struct fuse_arg *) req->args->in_args);
+	WRITE_ONCE(req->fiq, fiq);
 	list_add_tail(&req->list, &fiq->pending);
 	fiq->ops->wake_pending_and_unlock(fiq);
 }
@@ -254,17 +299,16 @@ void fuse_queue_forget(struct fuse_conn *fc, struct fuse_forget_link *forget,
 
 static void flush_bg_queue(struct fuse_conn *fc)
 {
-	struct fuse_iqueue *fiq = &fc->iq;
-
 	while (fc->active_background < fc->max_background &&
 	       !list_empty(&fc->bg_queue)) {
 		struct fuse_req *req;
+		struct fuse_iqueue *fiq;
 
 		req = list_first_entry(&fc->bg_queue, struct fuse_req, list);
 		list_del(&req->list);
 		fc->active_background++;
-		spin_lock(&fiq->lock);
-		req->in.h.unique = fuse_get_unique(fiq);
+		fiq = fuse_lock_iqueue(fc);
+		req->in.h.unique = fuse_get_unique(&fc->iq);
 		queue_request_and_unlock(fiq, req);
 	}
 }
@@ -281,7 +325,6 @@ void fuse_request_end(struct fuse_req *req)
 {
 	struct fuse_mount *fm = req->fm;
 	struct fuse_conn *fc = fm->fc;
-	struct fuse_iqueue *fiq = &fc->iq;
 
 	if (test_and_set_bit(FR_FINISHED, &req->flags))
 		goto put_request;
@@ -292,7 +335,8 @@ void fuse_request_end(struct fuse_req *req)
 	 * smp_mb() from queue_interrupt().
 	 */
 	if (test_bit(FR_INTERRUPTED, &req->flags)) {
-		spin_lock(&fiq->lock);
+		struct fuse_iqueue *fiq = fuse_req_lock_iqueue(req);
+
 		list_del_init(&req->intr_entry);
 		spin_unlock(&fiq->lock);
 	}
@@ -333,9 +377,8 @@ EXPORT_SYMBOL_GPL(fuse_request_end);
 
 static int queue_interrupt(struct fuse_req *req)
 {
-	struct fuse_iqueue *fiq = &req->fm->fc->iq;
+	struct fuse_iqueue *fiq = fuse_req_lock_iqueue(req);
 
-	spin_lock(&fiq->lock);
 	/* Check for we've sent request to interrupt this req */
 	if (unlikely(!test_bit(FR_INTERRUPTED, &req->flags))) {
 		spin_unlock(&fiq->lock);
@@ -364,7 +407,6 @@ static int queue_interrupt(struct fuse_req *req)
 static void request_wait_answer(struct fuse_req *req)
 {
 	struct fuse_conn *fc = req->fm->fc;
-	struct fuse_iqueue *fiq = &fc->iq;
 	int err;
 
 	if (!fc->no_interrupt) {
@@ -382,13 +424,15 @@ static void request_wait_answer(struct fuse_req *req)
 	}
 
 	if (!test_bit(FR_FORCE, &req->flags)) {
+		struct fuse_iqueue *fiq;
+
 		/* Only fatal signals may interrupt this */
 		err = wait_event_killable(req->waitq,
 					test_bit(FR_FINISHED, &req->flags));
 		if (!err)
 			return;
 
-		spin_lock(&fiq->lock);
+		fiq = fuse_req_lock_iqueue(req);
 		/* Request is not yet in userspace, bail out */
 		if (test_bit(FR_PENDING, &req->flags)) {
 			list_del(&req->list);
@@ -409,15 +453,16 @@ static void request_wait_answer(struct fuse_req *req)
 
 static void __fuse_request_send(struct fuse_req *req)
 {
-	struct fuse_iqueue *fiq = &req->fm->fc->iq;
+	struct fuse_conn *fc = req->fm->fc;
+	struct fuse_iqueue *fiq;
 
 	BUG_ON(test_bit(FR_BACKGROUND, &req->flags));
-	spin_lock(&fiq->lock);
+	fiq = fuse_lock_iqueue(fc);
 	if (!fiq->connected) {
 		spin_unlock(&fiq->lock);
 		req->out.h.error = -ENOTCONN;
 	} else {
-		req->in.h.unique = fuse_get_unique(fiq);
+		req->in.h.unique = fuse_get_unique(&fc->iq);
 		/* acquire extra reference, since request is still needed
 		   after fuse_request_end() */
 		__fuse_get_request(req);
@@ -1206,7 +1251,7 @@ static ssize_t fuse_dev_do_read(struct fuse_dev *fud, struct file *file,
 {
 	ssize_t err;
 	struct fuse_conn *fc = fud->fc;
-	struct fuse_iqueue *fiq = &fc->iq;
+	struct fuse_iqueue *fiq = fud->fiq;
 	struct fuse_pqueue *fpq = &fud->pq;
 	struct fuse_req *req;
 	struct fuse_args *args;
@@ -1820,6 +1865,8 @@ static void fuse_resend(struct fuse_conn *fc)
 	}
 
 	spin_lock(&fiq->lock);
+	list_for_each_entry(req, &to_queue, list)
+		WRITE_ONCE(req->fiq, fiq);
 	/* iq and pq requests are both oldest to newest */
 	list_splice(&to_queue, &fiq->pending);
 	fiq->ops->wake_pending_and_unlock(fiq);
@@ -2122,7 +2169,7 @@ static __poll_t fuse_dev_poll(struct file *file, poll_table *wait)
 	if (!fud)
 		return EPOLLERR;
 
-	fiq = &fud->fc->iq;
+	fiq = fud->fiq;
 	poll_wait(file, &fiq->waitq, wait);
 
 	spin_lock(&fiq->lock);
@@ -2235,6 +2282,18 @@ void fuse_abort_conn(struct fuse_conn *fc)
 		wake_up_all(&fiq->waitq);
 		spin_unlock(&fiq->lock);
 		kill_fasync(&fiq->fasync, SIGIO, POLL_IN);
+		for (i = 0; i < fc->nr_iqs; i++) {
+			struct fuse_iqueue *shard = fc->iqs[i];
+
+			spin_lock(&shard->lock);
+			shard->connected = 0;
+			list_for_each_entry(req, &shard->pending, list)
+				clear_bit(FR_PENDING, &req->flags);
+			list_splice_tail_init(&shard->pending, &to_end);
+			wake_up_all(&shard->waitq);
+			spin_unlock(&shard->lock);
+			kill_fasync(&shard->fasync, SIGIO, POLL_IN);
+		}
 		end_polls(fc);
 		wake_up_all(&fc->blocked_waitq);
 		spin_unlock(&fc->lock);
@@ -2271,6 +2330,35 @@ int fuse_dev_release(struct inode *inode, struct file *file)
 
 		end_requests(&to_end);
 
+		if (fud->fiq != &fc->iq) {
+			struct fuse_iqueue *fiq = &fc->iq;
+			struct fuse_iqueue *shard = fud->fiq;
+			struct fuse_req *req;
+			bool pending;
+
+			/*
+			 * No new requests are routed to a disconnected
+			 * shard.  Move what is already queued to the main
+			 * queue; both locks are held so that req->fiq
+			 * cannot change under a waiter that has locked the
+			 * old queue.
+			 */
+			spin_lock(&fiq->lock);
+			spin_lock_nested(&shard->lock, SINGLE_DEPTH_NESTING);
+			shard->connected = 0;
+			list_for_each_entry(req, &shard->pending, list)
+				WRITE_ONCE(req->fiq, fiq);
+			pending = !list_empty(&shard->pending);
+			list_splice_tail_init(&shard->pending, &fiq->pending);
+			WARN_ON(!list_empty(&shard->interrupts));
+			wake_up_all(&shard->waitq);
+			spin_unlock(&shard->lock);
+			if (pending)
+				fiq->ops->wake_pending_and_unlock(fiq);
+			else
+				spin_unlock(&fiq->lock);
+		}
+
 		/* Are we the last open device? */
 		if (atomic_dec_and_test(&fc->dev_count)) {
 			WARN_ON(fc->iq.fasync != NULL);
@@ -2290,7 +2378,37 @@ static int fuse_dev_fasync(int fd, struct file *file, int on)
 		return -EPERM;
 
 	/* No locking - fasync_helper does its own locking */
-	return fasync_helper(fd, file, on, &fud->fc->iq.fasync);
+	return fasync_helper(fd, file, on, &fud->fiq->fasync);
+}
+
+/*
+ * Give a cloned device its own input queue shard.  Requests are routed to
+ * shards by CPU and the server has promised (by negotiating
+ * FUSE_CLONE_QUEUES) to dedicate a reader to each cloned fd.  Falls back
+ * to the main queue if the shard cannot be set up.
+ */
+static void fuse_dev_bind_queue(struct fuse_conn *fc, struct fuse_dev *fud)
+{
+	struct fuse_iqueue *fiq;
+
+	if (!fc->clone_queues)
+		return;
+
+	fiq = kmalloc(sizeof(*fiq), GFP_KERNEL);
+	if (!fiq)
+		return;
+
+	fuse_iqueue_init(fiq, &fuse_dev_fiq_ops, NULL);
+	spin_lock(&fc->lock);
+	if (fc->connected && fc->nr_iqs < fc->max_iqs) {
+		fc->iqs[fc->nr_iqs] = fiq;
+		fud->fiq = fiq;
+		/* Pairs with smp_load_acquire() in fuse_lock_iqueue() */
+		smp_store_release(&fc->nr_iqs, fc->nr_iqs + 1);
+		fiq = NULL;
+	}
+	spin_unlock(&fc->lock);
+	kfree(fiq);
 }
 
 static int fuse_device_clone(struct fuse_conn *fc, struct file *new)
@@ -2304,6 +2422,7 @@ static int fuse_device_clone(struct fuse_conn *fc, struct file *new)
 	if (!fud)
 		return -ENOMEM;
 
+	fuse_dev_bind_queue(fc, fud);
 	new->private_data = fud;
 	atomic_inc(&fc->dev_count);
 
@@ -435,6 +435,9 @@ struct fuse_req {
 
 	/** fuse_mount this request belongs to */
 	struct fuse_mount *fm;
+
+	/** Input queue the request was queued on */
+	struct fuse_iqueue *fiq;
 };
 
 struct fuse_iqueue;
@@ -485,8 +488,8 @@ struct fuse_iqueue {
 	/** Readers of the connection are waiting on this */
 	wait_queue_head_t waitq;
 
-	/** The next unique request id */
-	u64 reqctr;
+	/** The next unique request id (connection wide, hence atomic) */
+	atomic64_t reqctr;
 
 	/** The list of pending requests */
 	struct list_head pending;
@@ -538,6 +541,9 @@ struct fuse_dev {
 	/** Processing queue */
 	struct fuse_pqueue pq;
 
+	/** Input queue this device reads from */
+	struct fuse_iqueue *fiq;
+
 	/** list entry on fc->devices */
 	struct list_head entry;
 };
@@ -636,6 +642,15 @@ struct fuse_conn {
 	/** Input queue */
 	struct fuse_iqueue iq;
 
+	/** Input queue shards for cloned devices (FUSE_CLONE_QUEUES) */
+	struct fuse_iqueue **iqs;
+
+	/** Number of installed input queue shards */
+	unsigned int nr_iqs;
+
+	/** Capacity of the iqs array */
+	unsigned int max_iqs;
+
 	/** The next unique kernel file handle */
 	atomic64_t khctr;
 
@@ -770,6 +785,9 @@ struct fuse_conn {
 	/** Is interrupt not implemented by fs? */
 	unsigned no_interrupt:1;
 
+	/** Shard the input queue across cloned devices */
+	unsigned clone_queues:1;
+
 	/** Is bmap not implemented by fs? */
 	unsigned no_bmap:1;
 
@@ -1202,6 +1220,12 @@ void fuse_conn_init(struct fuse_conn *fc, struct fuse_mount *fm,
 		    struct user_namespace *user_ns,
 		    const struct fuse_iqueue_ops *fiq_ops, void *fiq_priv);
 
+/**
+ * Initialize an input queue
+ */
+void fuse_iqueue_init(struct fuse_iqueue *fiq, const struct fuse_iqueue_ops *ops,
+		      void *priv);
+
 /**
  * Release reference to fuse_conn
  */
@@ -878,9 +878,8 @@ static int fuse_show_options(struct seq_file *m, struct dentry *root)
 	return 0;
 }
 
-static void fuse_iqueue_init(struct fuse_iqueue *fiq,
-			     const struct fuse_iqueue_ops *ops,
-			     void *priv)
+void fuse_iqueue_init(struct fuse_iqueue *fiq, const struct fuse_iqueue_ops *ops,
+		      void *priv)
 {
 	memset(fiq, 0, sizeof(struct fuse_iqueue));
 	spin_lock_init(&fiq->lock);
@@ -961,6 +960,13 @@ void fuse_conn_put(struct fuse_conn *fc)
 			fuse_dax_conn_free(fc);
 		if (fiq->ops->release)
 			fiq->ops->release(fiq);
+		if (fc->iqs) {
+			unsigned int i;
+
+			for (i = 0; i < fc->nr_iqs; i++)
+				kfree(fc->iqs[i]);
+			kfree(fc->iqs);
+		}
 		put_pid_ns(fc->pid_ns);
 		bucket = rcu_dereference_protected(fc->curr_bucket, 1);
 		if (bucket) {
@@ -1331,6 +1337,13 @@ static void process_init_reply(struct fuse_mount *fm, struct fuse_args *args,
 			}
 			if (flags & FUSE_NO_EXPORT_SUPPORT)
 				fm->sb->s_export_op = &fuse_export_fid_operations;
+			if (flags & FUSE_CLONE_QUEUES) {
+				fc->max_iqs = num_possible_cpus();
+				fc->iqs = kcalloc(fc->max_iqs,
+						  sizeof(*fc->iqs), GFP_KERNEL);
+				if (fc->iqs)
+					fc->clone_queues = 1;
+			}
 		} else {
 			ra_pages = fc->max_read / PAGE_SIZE;
 			fc->no_lock = 1;
@@ -1389,6 +1402,9 @@ void fuse_send_init(struct fuse_mount *fm)
 		flags |= FUSE_SUBMOUNTS;
 	if (IS_ENABLED(CONFIG_FUSE_PASSTHROUGH))
 		flags |= FUSE_PASSTHROUGH;
+	/* Input queue sharding requires FUSE_DEV_IOC_CLONE on /dev/fuse */
+	if (fm->fc->iq.ops == &fuse_dev_fiq_ops)
+		flags |= FUSE_CLONE_QUEUES;
 
 	ia->in.flags = flags;
 	ia->in.flags2 = flags >> 32;
@@ -1485,6 +1501,7 @@ EXPORT_SYMBOL_GPL(fuse_dev_alloc);
 void fuse_dev_install(struct fuse_dev *fud, struct fuse_conn *fc)
 {
 	fud->fc = fuse_conn_get(fc);
+	fud->fiq = &fc->iq;
 	spin_lock(&fc->lock);
 	list_add_tail(&fud->entry, &fc->devices);
 	spin_unlock(&fc->lock);
@@ -44,6 +44,11 @@ enum {
 
 #define VQ_NAME_LEN	24
 
+/* Flush a batched device notification after this many requests ... */
+#define VIRTIO_FS_KICK_BATCH	8
+/* ... or after this delay, whichever comes first */
+#define VIRTIO_FS_KICK_DELAY_NS	(20 * NSEC_PER_USEC)
+
 /* Per-virtqueue state */
 struct virtio_fs_vq {
 	spinlock_t lock;
@@ -52,6 +57,9 @@ struct virtio_fs_vq {
 	struct list_head queued_reqs;
 	struct list_head end_reqs;	/* End these requests */
 	struct delayed_work dispatch_work;
+	struct work_struct kick_work;
+	struct hrtimer kick_timer;
+	unsigned int unnotified;  /* queued but device not yet notified */
 	struct fuse_dev *fud;
 	bool connected;
 	long in_flight;
@@ -169,6 +177,68 @@ static inline void dec_in_flight_req(struct virtio_fs_vq *fsvq)
 		complete(&fsvq->in_flight_zero);
 }
 
+/*
+ * Notify the device about new buffers.  Called with fsvq->lock held,
+ * releases it.
+ *
+ * An idle queue is kicked immediately so that an isolated request does not
+ * pay any added latency.  While the device is still busy with earlier
+ * buffers, the notification is held back: either further submissions
+ * arrive and share a single kick, or the timer flushes the batch.  This
+ * keeps the guest from paying a vmexit per request under load.
+ */
+static void virtio_fs_kick_and_unlock(struct virtio_fs_vq *fsvq)
+__releases(fsvq->lock)
+{
+	struct virtqueue *vq = fsvq->vq;
+	bool notify;
+
+	if (fsvq->in_flight > 1 &&
+	    ++fsvq->unnotified < VIRTIO_FS_KICK_BATCH) {
+		if (!hrtimer_active(&fsvq->kick_timer))
+			hrtimer_start(&fsvq->kick_timer,
+				      ns_to_ktime(VIRTIO_FS_KICK_DELAY_NS),
+				      HRTIMER_MODE_REL);
+		spin_unlock(&fsvq->lock);
+		return;
+	}
+
+	fsvq->unnotified = 0;
+	notify = virtqueue_kick_prepare(vq);
+	spin_unlock(&fsvq->lock);
+
+	if (notify)
+		virtqueue_notify(vq);
+}
+
+static void virtio_fs_kick_work(struct work_struct *work)
+{
+	struct virtio_fs_vq *fsvq = container_of(work, struct virtio_fs_vq,
+						 kick_work);
+	struct virtqueue *vq = fsvq->vq;
+	bool notify = false;
+
+	spin_lock(&fsvq->lock);
+	if (fsvq->connected && fsvq->unnotified) {
+		fsvq->unnotified = 0;
+		notify = virtqueue_kick_prepare(vq);
+	}
+	spin_unlock(&fsvq->lock);
+
+	if (notify)
+		virtqueue_notify(vq);
+}
+
+/* fsvq->lock is not irq safe, so flush from a worker instead */
+static enum hrtimer_restart virtio_fs_kick_timer_fn(struct hrtimer *timer)
+{
+	struct virtio_fs_vq *fsvq = container_of(timer, struct virtio_fs_vq,
+						 kick_timer);
+
+	schedule_work(&fsvq->kick_work);
+	return HRTIMER_NORESTART;
+}
+
 static ssize_t tag_show(struct kobject *kobj,
 		struct kobj_attribute *attr, char *buf)
 {
@@ -217,8 +287,22 @@ static void virtio_fs_fiq_release(struct fuse_iqueue *fiq)
 
 static void virtio_fs_drain_queue(struct virtio_fs_vq *fsvq)
 {
+	bool notify = false;
+
 	WARN_ON(fsvq->in_flight < 0);
 
+	/* Flush a batched notification so the device sees all buffers */
+	hrtimer_cancel(&fsvq->kick_timer);
+	flush_work(&fsvq->kick_work);
+	spin_lock(&fsvq->lock);
+	if (fsvq->unnotified) {
+		fsvq->unnotified = 0;
+		notify = virtqueue_kick_prepare(fsvq->vq);
+	}
+	spin_unlock(&fsvq->lock);
+	if (notify)
+		virtqueue_notify(fsvq->vq);
+
 	/* Wait for in flight requests to finish.*/
 	spin_lock(&fsvq->lock);
 	if (fsvq->in_flight) {
@@ -477,7 +561,6 @@ static int send_forget_request(struct virtio_fs_vq *fsvq,
 	struct scatterlist sg;
 	struct virtqueue *vq;
 	int ret = 0;
-	bool notify;
 	struct virtio_fs_forget_req *req = &forget->req;
 
 	spin_lock(&fsvq->lock);
@@ -516,11 +599,7 @@ static int send_forget_request(struct virtio_fs_vq *fsvq,
 
 	if (!in_flight)
 		inc_in_flight_req(fsvq);
-	notify = virtqueue_kick_prepare(vq);
-	spin_unlock(&fsvq->lock);
-
-	if (notify)
-		virtqueue_notify(vq);
+	virtio_fs_kick_and_unlock(fsvq);
 	return ret;
 out:
 	spin_unlock(&fsvq->lock);
@@ -767,6 +846,9 @@ static void virtio_fs_init_vq(struct virtio_fs_vq *fsvq, char *name,
 	INIT_LIST_HEAD(&fsvq->queued_reqs);
 	INIT_LIST_HEAD(&fsvq->end_reqs);
 	init_completion(&fsvq->in_flight_zero);
+	INIT_WORK(&fsvq->kick_work, virtio_fs_kick_work);
+	hrtimer_init(&fsvq->kick_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	fsvq->kick_timer.function = virtio_fs_kick_timer_fn;
 
 	if (vq_type == VQ_REQUEST) {
 		INIT_WORK(&fsvq->done_work, virtio_fs_requests_done_work);
@@ -1252,7 +1334,6 @@ static int virtio_fs_enqueue_req(struct virtio_fs_vq *fsvq,
 	unsigned int total_sgs;
 	unsigned int i;
 	int ret;
-	bool notify;
 	struct fuse_pqueue *fpq;
 
 	/* Does the sglist fit on the stack? */
@@ -1319,12 +1400,7 @@ static int virtio_fs_enqueue_req(struct virtio_fs_vq *fsvq,
 
 	if (!in_flight)
 		inc_in_flight_req(fsvq);
-	notify = virtqueue_kick_prepare(vq);
-
-	spin_unlock(&fsvq->lock);
-
-	if (notify)
-		virtqueue_notify(vq);
+	virtio_fs_kick_and_unlock(fsvq);
 
 out:
 	if (ret < 0 && req->argbuf) {
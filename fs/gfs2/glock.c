@@ -1600,6 +1600,48 @@ trap_recursive:
 	BUG();
 }
 
+/**
+ * __gfs2_glock_nq_fast - grant a compatible shared re-request cheaply
+ * @gh: the holder structure
+ *
+ * Read-mostly workloads spend most of their glock time re-acquiring a
+ * glock that this node already holds in the shared state.  In that case
+ * nothing needs to go through the state machine: if there are no waiters
+ * and no demote has been requested, the new holder is compatible by
+ * definition and can be granted with a minimal critical section, skipping
+ * add_to_queue()'s holder scans, run_queue() and the HIF_WAIT wake-up
+ * dance.  The recursion trap is only taken on the slow path; the comment
+ * above add_to_queue() has always treated it as a debugging aid.
+ *
+ * Returns true if @gh was granted.
+ */
+
+static bool __gfs2_glock_nq_fast(struct gfs2_holder *gh)
+{
+	struct gfs2_glock *gl = gh->gh_gl;
+	struct gfs2_holder *current_gh;
+	bool granted = false;
+
+	spin_lock(&gl->gl_lockref.lock);
+	if (gl->gl_state == LM_ST_SHARED &&
+	    !test_bit(GLF_LOCK, &gl->gl_flags) &&
+	    !test_bit(GLF_DEMOTE, &gl->gl_flags) &&
+	    !test_bit(GLF_PENDING_DEMOTE, &gl->gl_flags) &&
+	    !test_bit(GLF_INVALIDATE_IN_PROGRESS, &gl->gl_flags) &&
+	    !find_last_waiter(gl)) {
+		current_gh = find_first_holder(gl);
+		if (current_gh && may_grant(gl, current_gh, gh)) {
+			set_bit(HIF_HOLDER, &gh->gh_iflags);
+			list_add_tail(&gh->gh_list, &gl->gl_holders);
+			gh->gh_error = 0;
+			trace_gfs2_promote(gh);
+			granted = true;
+		}
+	}
+	spin_unlock(&gl->gl_lockref.lock);
+	return granted;
+}
+
 /**
  * gfs2_glock_nq - enqueue a struct gfs2_holder onto a glock (acquire a glock)
  * @gh: the holder structure
@@ -1636,6 +1678,16 @@ unlock:
 		return error;
 	}
 
+	/*
+	 * A glock with active holders is never on the LRU, so the fast
+	 * path can also skip the LRU removal below.
+	 */
+	if (gh->gh_state == LM_ST_SHARED &&
+	    !(gh->gh_flags & (LM_FLAG_TRY | LM_FLAG_TRY_1CB | LM_FLAG_NOEXP |
+			      GL_ASYNC)) &&
+	    __gfs2_glock_nq_fast(gh))
+		return 0;
+
 	if (test_bit(GLF_LRU, &gl->gl_flags))
 		gfs2_glock_remove_from_lru(gl);
 
@@ -34,7 +34,9 @@
 #include <linux/security.h>
 #include <linux/magic.h>
 #include <linux/migrate.h>
+#include <linux/sizes.h>
 #include <linux/uio.h>
+#include <linux/workqueue.h>
 
 #include <linux/uaccess.h>
 #include <linux/sched/mm.h>
@@ -795,55 +797,24 @@ static long hugetlbfs_punch_hole(struct inode *inode, loff_t offset, loff_t len)
 	return 0;
 }
 
-static long hugetlbfs_fallocate(struct file *file, int mode, loff_t offset,
-				loff_t len)
+
+/*
+ * Preallocate and zero huge pages for the range [start, end) of @file.
+ * Called with the inode lock held; @pseudo_vma carries the caller's
+ * context for reservation accounting and mempolicy purposes.
+ */
+static long hugetlbfs_fallocate_range(struct file *file,
+				      struct vm_area_struct *pseudo_vma,
+				      pgoff_t start, pgoff_t end)
 {
 	struct inode *inode = file_inode(file);
-	struct hugetlbfs_inode_info *info = HUGETLBFS_I(inode);
 	struct address_space *mapping = inode->i_mapping;
 	struct hstate *h = hstate_inode(inode);
-	struct vm_area_struct pseudo_vma;
-	struct mm_struct *mm = current->mm;
 	loff_t hpage_size = huge_page_size(h);
-	unsigned long hpage_shift = huge_page_shift(h);
-	pgoff_t start, index, end;
-	int error;
+	pgoff_t index;
+	long error;
 	u32 hash;
 
-	if (mode & ~(FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE))
-		return -EOPNOTSUPP;
-
-	if (mode & FALLOC_FL_PUNCH_HOLE)
-		return hugetlbfs_punch_hole(inode, offset, len);
-
-	/*
-	 * Default preallocate case.
-	 * For this range, start is rounded down and end is rounded up
-	 * as well as being converted to page offsets.
-	 */
-	start = offset >> hpage_shift;
-	end = (offset + len + hpage_size - 1) >> hpage_shift;
-
-	inode_lock(inode);
-
-	/* We need to check rlimit even when FALLOC_FL_KEEP_SIZE */
-	error = inode_newsize_ok(inode, offset + len);
-	if (error)
-		goto out;
-
-	if ((info->seals & F_SEAL_GROW) && offset + len > inode->i_size) {
-		error = -EPERM;
-		goto out;
-	}
-
-	/*
-	 * Initialize a pseudo vma as this is required by the huge page
-	 * allocation routines.
-	 */
-	vma_init(&pseudo_vma, mm);
-	vm_flags_init(&pseudo_vma, VM_HUGETLB | VM_MAYSHARE | VM_SHARED);
-	pseudo_vma.vm_file = file;
-
 	for (index = start; index < end; index++) {
 		/*
 		 * This is supposed to be the vaddr where the page is being
@@ -858,10 +829,8 @@ static long hugetlbfs_fallocate(struct file *file, int mode, loff_t offset,
 		 * fallocate(2) manpage permits EINTR; we may have been
 		 * interrupted because we are using up too much memory.
 		 */
-		if (signal_pending(current)) {
-			error = -EINTR;
-			break;
-		}
+		if (signal_pending(current))
+			return -EINTR;
 
 		/* addr is the offset within the file (zero based) */
 		addr = index * hpage_size;
@@ -886,20 +855,19 @@ static long hugetlbfs_fallocate(struct file *file, int mode, loff_t offset,
 		 * folios in these areas, we need to consume the reserves
 		 * to keep reservation accounting consistent.
 		 */
-		folio = alloc_hugetlb_folio(&pseudo_vma, addr, 0);
+		folio = alloc_hugetlb_folio(pseudo_vma, addr, 0);
 		if (IS_ERR(folio)) {
 			mutex_unlock(&hugetlb_fault_mutex_table[hash]);
-			error = PTR_ERR(folio);
-			goto out;
+			return PTR_ERR(folio);
 		}
 		clear_huge_page(&folio->page, addr, pages_per_huge_page(h));
 		__folio_mark_uptodate(folio);
 		error = hugetlb_add_to_page_cache(folio, mapping, index);
 		if (unlikely(error)) {
-			restore_reserve_on_error(h, &pseudo_vma, addr, folio);
+			restore_reserve_on_error(h, pseudo_vma, addr, folio);
 			folio_put(folio);
 			mutex_unlock(&hugetlb_fault_mutex_table[hash]);
-			goto out;
+			return error;
 		}
 
 		mutex_unlock(&hugetlb_fault_mutex_table[hash]);
@@ -913,6 +881,201 @@ static long hugetlbfs_fallocate(struct file *file, int mode, loff_t offset,
 		folio_put(folio);
 	}
 
+	return 0;
+}
+
+struct hugetlbfs_falloc_ctl {
+	struct address_space *mapping;
+	struct hstate *h;
+	struct vm_area_struct *pseudo_vma;
+	int error;
+};
+
+struct hugetlbfs_falloc_work {
+	struct work_struct work;
+	struct hugetlbfs_falloc_ctl *ctl;
+	struct folio *folio;
+	pgoff_t index;
+	unsigned long addr;
+};
+
+static void hugetlbfs_falloc_zero_workfn(struct work_struct *work)
+{
+	struct hugetlbfs_falloc_work *w =
+		container_of(work, struct hugetlbfs_falloc_work, work);
+	struct hugetlbfs_falloc_ctl *ctl = w->ctl;
+	struct hstate *h = ctl->h;
+	struct folio *folio = w->folio;
+	int error;
+	u32 hash;
+
+	clear_huge_page(&folio->page, w->addr, pages_per_huge_page(h));
+	__folio_mark_uptodate(folio);
+
+	hash = hugetlb_fault_mutex_hash(ctl->mapping, w->index);
+	mutex_lock(&hugetlb_fault_mutex_table[hash]);
+	error = hugetlb_add_to_page_cache(folio, ctl->mapping, w->index);
+	mutex_unlock(&hugetlb_fault_mutex_table[hash]);
+
+	if (unlikely(error)) {
+		restore_reserve_on_error(h, ctl->pseudo_vma, w->addr, folio);
+		folio_put(folio);
+		/* A racing fault instantiated the page; that's not an error. */
+		if (error != -EEXIST)
+			cmpxchg(&ctl->error, 0, error);
+		return;
+	}
+
+	folio_set_hugetlb_migratable(folio);
+	folio_unlock(folio);
+	folio_put(folio);
+}
+
+/*
+ * Parallel variant of hugetlbfs_fallocate_range().  Folio allocation
+ * stays in the caller's task context, so cgroup charging, reservation
+ * consumption and the caller's mempolicy are honoured exactly as in the
+ * serial path.  Only the zeroing and page cache insertion, which
+ * dominate a multi-gigabyte prealloc, are pushed to unbound workers on
+ * the node each folio was allocated from, bounded by a small pool of
+ * reusable work items.
+ */
+static long hugetlbfs_fallocate_parallel(struct file *file,
+					 struct vm_area_struct *pseudo_vma,
+					 pgoff_t start, pgoff_t end)
+{
+	struct inode *inode = file_inode(file);
+	struct hstate *h = hstate_inode(inode);
+	struct hugetlbfs_falloc_ctl ctl = {
+		.mapping = inode->i_mapping,
+		.h = h,
+		.pseudo_vma = pseudo_vma,
+	};
+	struct hugetlbfs_falloc_work *works;
+	loff_t hpage_size = huge_page_size(h);
+	unsigned int nr_works, i;
+	pgoff_t index;
+	long error = 0;
+
+	/* A few zeroing threads per node saturate its memory bandwidth. */
+	nr_works = clamp_t(unsigned int, 4 * num_node_state(N_MEMORY),
+			   2, num_online_cpus());
+	works = kcalloc(nr_works, sizeof(*works), GFP_KERNEL);
+	if (!works)
+		return hugetlbfs_fallocate_range(file, pseudo_vma, start, end);
+
+	for (i = 0; i < nr_works; i++) {
+		works[i].ctl = &ctl;
+		INIT_WORK(&works[i].work, hugetlbfs_falloc_zero_workfn);
+	}
+
+	i = 0;
+	for (index = start; index < end; index++) {
+		struct hugetlbfs_falloc_work *w;
+		struct folio *folio;
+		unsigned long addr;
+
+		cond_resched();
+
+		if (signal_pending(current)) {
+			error = -EINTR;
+			break;
+		}
+		if (READ_ONCE(ctl.error))
+			break;
+
+		/*
+		 * Racy presence check to avoid a pointless allocation; the
+		 * authoritative recheck is hugetlb_add_to_page_cache()
+		 * failing under the fault mutex in the worker.
+		 */
+		folio = filemap_get_folio(ctl.mapping,
+					  index << huge_page_order(h));
+		if (!IS_ERR(folio)) {
+			folio_put(folio);
+			continue;
+		}
+
+		addr = index * hpage_size;
+		folio = alloc_hugetlb_folio(pseudo_vma, addr, 0);
+		if (IS_ERR(folio)) {
+			error = PTR_ERR(folio);
+			break;
+		}
+
+		w = &works[i++ % nr_works];
+		flush_work(&w->work);
+		w->folio = folio;
+		w->index = index;
+		w->addr = addr;
+		queue_work_node(folio_nid(folio), system_unbound_wq, &w->work);
+	}
+
+	for (i = 0; i < nr_works; i++)
+		flush_work(&works[i].work);
+	kfree(works);
+
+	if (!error)
+		error = ctl.error;
+	return error;
+}
+
+static long hugetlbfs_fallocate(struct file *file, int mode, loff_t offset,
+				loff_t len)
+{
+	struct inode *inode = file_inode(file);
+	struct hugetlbfs_inode_info *info = HUGETLBFS_I(inode);
+	struct hstate *h = hstate_inode(inode);
+	struct vm_area_struct pseudo_vma;
+	struct mm_struct *mm = current->mm;
+	loff_t hpage_size = huge_page_size(h);
+	unsigned long hpage_shift = huge_page_shift(h);
+	pgoff_t start, end;
+	int error;
+
+	if (mode & ~(FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE))
+		return -EOPNOTSUPP;
+
+	if (mode & FALLOC_FL_PUNCH_HOLE)
+		return hugetlbfs_punch_hole(inode, offset, len);
+
+	/*
+	 * Default preallocate case.
+	 * For this range, start is rounded down and end is rounded up
+	 * as well as being converted to page offsets.
+	 */
+	start = offset >> hpage_shift;
+	end = (offset + len + hpage_size - 1) >> hpage_shift;
+
+	inode_lock(inode);
+
+	/* We need to check rlimit even when FALLOC_FL_KEEP_SIZE */
+	error = inode_newsize_ok(inode, offset + len);
+	if (error)
+		goto out;
+
+	if ((info->seals & F_SEAL_GROW) && offset + len > inode->i_size) {
+		error = -EPERM;
+		goto out;
+	}
+
+	/*
+	 * Initialize a pseudo vma as this is required by the huge page
+	 * allocation routines.
+	 */
+	vma_init(&pseudo_vma, mm);
+	vm_flags_init(&pseudo_vma, VM_HUGETLB | VM_MAYSHARE | VM_SHARED);
+	pseudo_vma.vm_file = file;
+
+	/* Zeroing dominates large preallocs; fan those out across nodes. */
+	if (((loff_t)(end - start) << hpage_shift) >= SZ_1G)
+		error = hugetlbfs_fallocate_parallel(file, &pseudo_vma, start, end);
+	else
+		error = hugetlbfs_fallocate_range(file, &pseudo_vma, start, end);
+	/* As before, an interrupted prealloc still extends the size. */
+	if (error && error != -EINTR)
+		goto out;
+
 	if (!(mode & FALLOC_FL_KEEP_SIZE) && offset + len > inode->i_size)
 		i_size_write(inode, offset + len);
 	inode_set_ctime_current(inode);
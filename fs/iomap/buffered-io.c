@@ -533,9 +533,31 @@ void iomap_readahead(struct readahead_control *rac, const struct iomap_ops *ops)
 
 	trace_iomap_readahead(rac->mapping->host, readahead_count(rac));
 
-	while (iomap_iter(&iter, ops) > 0)
+	while (iomap_iter(&iter, ops) > 0) {
 		iter.processed = iomap_readahead_iter(&iter, &ctx);
 
+		/*
+		 * Submit what this extent built before looking up the next
+		 * mapping, so the device works on these reads while
+		 * ->iomap_begin potentially blocks on metadata.  Contiguous
+		 * extents lose a little bio merging to this, but a pipelined
+		 * stream beats a perfectly merged stall.
+		 *
+		 * Hold the bio back when the current folio straddles the
+		 * extent boundary: its read_bytes_pending so far only covers
+		 * the ranges added from this extent, so an early completion
+		 * would end the folio read before the next extent's ranges
+		 * are accounted.
+		 */
+		if (ctx.bio && iter.processed > 0 &&
+		    (!ctx.cur_folio ||
+		     offset_in_folio(ctx.cur_folio,
+				     iter.pos + iter.processed) == 0)) {
+			submit_bio(ctx.bio);
+			ctx.bio = NULL;
+		}
+	}
+
 	if (ctx.bio)
 		submit_bio(ctx.bio);
 	if (ctx.cur_folio) {
@@ -753,3 +753,141 @@ iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 	return iomap_dio_complete(dio);
 }
 EXPORT_SYMBOL_GPL(iomap_dio_rw);
+
+/*
+ * Shared result aggregation for a batch of concurrently issued DIO segments.
+ * The first error observed wins, matching iomap_dio_set_error().
+ */
+struct iomap_dio_batch {
+	atomic_t		ref;
+	int			error;
+	atomic_long_t		done;
+	struct completion	wait;
+};
+
+struct iomap_dio_bseg {
+	struct kiocb		iocb;
+	struct iomap_dio_batch	*batch;
+};
+
+static void iomap_dio_batch_account(struct iomap_dio_batch *batch, long ret)
+{
+	if (ret < 0)
+		cmpxchg(&batch->error, 0, ret);
+	else
+		atomic_long_add(ret, &batch->done);
+
+	if (atomic_dec_and_test(&batch->ref))
+		complete(&batch->wait);
+}
+
+static void iomap_dio_batch_complete(struct kiocb *iocb, long ret)
+{
+	struct iomap_dio_bseg *bseg =
+		container_of(iocb, struct iomap_dio_bseg, iocb);
+
+	iomap_dio_batch_account(bseg->batch, ret);
+}
+
+/**
+ * iomap_dio_rw_batch - issue a batch of disjoint DIO segments to one file
+ * @iocb:	template kiocb; supplies the file and I/O flags
+ * @segs:	segments, sorted by ascending position and non-overlapping
+ * @nr_segs:	number of segments, at most UIO_MAXIOV
+ * @ops:	iomap ops for the mapping lookups
+ * @dops:	optional DIO ops, applied to every segment
+ * @dio_flags:	IOMAP_DIO_* flags, applied to every segment
+ * @private:	filesystem private data passed through to the iomap ops
+ *
+ * All segments must transfer in the same direction.  The segments are
+ * validated once, then issued back to back inside a single block plug so the
+ * stream reaches the device as one submission, and the caller sleeps for one
+ * aggregate completion rather than once per segment.  The position of @iocb
+ * is neither consulted nor advanced; each segment carries its own.
+ *
+ * Returns the total number of bytes transferred, or the first error observed
+ * if any segment failed.  Segments are independent at the block layer, so a
+ * failure does not undo the transfers that preceded it.
+ */
+ssize_t
+iomap_dio_rw_batch(struct kiocb *iocb, struct iomap_dio_seg *segs,
+		unsigned int nr_segs, const struct iomap_ops *ops,
+		const struct iomap_dio_ops *dops, unsigned int dio_flags,
+		void *private)
+{
+	struct iomap_dio_batch batch = {
+		.ref	= ATOMIC_INIT(1),
+		.done	= ATOMIC_LONG_INIT(0),
+		.wait	= COMPLETION_INITIALIZER_ONSTACK(batch.wait),
+	};
+	struct iomap_dio_bseg *bsegs;
+	struct blk_plug plug;
+	int dir;
+	unsigned int i;
+
+	if (!nr_segs || nr_segs > UIO_MAXIOV)
+		return -EINVAL;
+	if (iocb->ki_flags & IOCB_APPEND)
+		return -EINVAL;
+
+	dir = iov_iter_rw(segs[0].iter);
+	for (i = 0; i < nr_segs; i++) {
+		if (segs[i].pos < 0 || iov_iter_rw(segs[i].iter) != dir)
+			return -EINVAL;
+		if (i && segs[i].pos <
+			 segs[i - 1].pos + iov_iter_count(segs[i - 1].iter))
+			return -EINVAL;
+	}
+
+	bsegs = kcalloc(nr_segs, sizeof(*bsegs), GFP_KERNEL);
+	if (!bsegs)
+		return -ENOMEM;
+
+	/*
+	 * One plug across the whole batch; the per-segment plugs inside
+	 * __iomap_dio_rw nest and defer to this one.
+	 */
+	blk_start_plug(&plug);
+	for (i = 0; i < nr_segs; i++) {
+		struct iomap_dio_bseg *bseg = &bsegs[i];
+		struct iomap_dio *dio;
+
+		bseg->iocb = *iocb;
+		bseg->iocb.ki_pos = segs[i].pos;
+		bseg->iocb.ki_complete = iomap_dio_batch_complete;
+		/*
+		 * Polling only works for a lone bio, and the caller-owned
+		 * completion protocol would hand our internal iocbs to the
+		 * issuer of the template.
+		 */
+		bseg->iocb.ki_flags &= ~(IOCB_HIPRI | IOCB_DIO_CALLER_COMP);
+		bseg->batch = &batch;
+
+		/*
+		 * Take the in-flight reference before issuing; the segment
+		 * may complete from the bio end_io before we get back.
+		 */
+		atomic_inc(&batch.ref);
+		dio = __iomap_dio_rw(&bseg->iocb, segs[i].iter, ops, dops,
+				     dio_flags, private, 0);
+		if (dio == ERR_PTR(-EIOCBQUEUED))
+			continue;
+		if (IS_ERR_OR_NULL(dio)) {
+			iomap_dio_batch_account(&batch, PTR_ERR_OR_ZERO(dio));
+			if (IS_ERR(dio))
+				break;
+			continue;
+		}
+		iomap_dio_batch_account(&batch, iomap_dio_complete(dio));
+	}
+	blk_finish_plug(&plug);
+
+	if (!atomic_dec_and_test(&batch.ref))
+		wait_for_completion(&batch.wait);
+	kfree(bsegs);
+
+	if (batch.error)
+		return batch.error;
+	return atomic_long_read(&batch.done);
+}
+EXPORT_SYMBOL_GPL(iomap_dio_rw_batch);
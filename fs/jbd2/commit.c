@@ -339,6 +339,50 @@ static void jbd2_block_tag_csum_set(journal_t *j, journal_block_tag_t *tag,
 	else
 		tag->t_checksum = cpu_to_be16(csum32);
 }
+
+/*
+ * Deferred checksumming of one descriptor batch.  The v2/v3 block tag
+ * checksums live in the descriptor, not in the journalled blocks, so the
+ * data blocks can be put in flight immediately and only the descriptor has
+ * to wait for the checksum pass.  The commit thread hands a batch to a
+ * worker and carries on building the next one.
+ */
+struct jbd2_csum_work {
+	struct work_struct	work;
+	journal_t		*journal;
+	struct buffer_head	*descriptor;
+	tid_t			tid;
+	int			nr;
+	struct buffer_head	*wbuf[] __counted_by(nr);
+};
+
+static void jbd2_desc_csum_workfn(struct work_struct *work)
+{
+	struct jbd2_csum_work *cw =
+		container_of(work, struct jbd2_csum_work, work);
+	journal_t *journal = cw->journal;
+	struct buffer_head *descriptor = cw->descriptor;
+	size_t tag_bytes = journal_tag_bytes(journal);
+	char *tagp = &descriptor->b_data[sizeof(journal_header_t)];
+	int i;
+
+	for (i = 0; i < cw->nr; i++) {
+		journal_block_tag_t *tag = (journal_block_tag_t *)tagp;
+
+		jbd2_block_tag_csum_set(journal, tag, cw->wbuf[i], cw->tid);
+		tagp += tag_bytes;
+		if (!i)
+			tagp += 16;	/* the uuid follows the first tag */
+	}
+	jbd2_descriptor_block_csum_set(journal, descriptor);
+
+	lock_buffer(descriptor);
+	clear_buffer_dirty(descriptor);
+	set_buffer_uptodate(descriptor);
+	descriptor->b_end_io = journal_end_buffer_io_sync;
+	submit_bh(REQ_OP_WRITE | JBD2_JOURNAL_REQ_FLAGS, descriptor);
+}
+
 /*
  * jbd2_journal_commit_transaction
  *
@@ -366,6 +410,7 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	int i;
 	int tag_bytes = journal_tag_bytes(journal);
 	struct buffer_head *cbh = NULL; /* For transactional checksums */
+	struct jbd2_csum_work *csum_work = NULL;
 	__u32 crc32_sum = ~0;
 	struct blk_plug plug;
 	/* Tail of the journal */
@@ -571,6 +616,23 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 	J_ASSERT(commit_transaction->t_nr_buffers <=
 		 atomic_read(&commit_transaction->t_outstanding_credits));
 
+	/*
+	 * Offload the per-block tag checksums to a worker where possible.
+	 * The v1 compat checksum chains a single crc across the whole
+	 * transaction in submission order, so it stays inline; if the
+	 * allocation fails we simply checksum inline as before.
+	 */
+	if (jbd2_journal_has_csum_v2or3(journal) &&
+	    !jbd2_has_feature_checksum(journal)) {
+		csum_work = kmalloc(struct_size(csum_work, wbuf,
+						journal->j_wbufsize),
+				    GFP_NOFS);
+		if (csum_work) {
+			INIT_WORK(&csum_work->work, jbd2_desc_csum_workfn);
+			csum_work->journal = journal;
+		}
+	}
+
 	bufs = 0;
 	descriptor = NULL;
 	while (commit_transaction->t_buffers) {
@@ -680,8 +742,9 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 		tag = (journal_block_tag_t *) tagp;
 		write_tag_block(journal, tag, jh2bh(jh)->b_blocknr);
 		tag->t_flags = cpu_to_be16(tag_flag);
-		jbd2_block_tag_csum_set(journal, tag, wbuf[bufs],
-					commit_transaction->t_tid);
+		if (!csum_work)
+			jbd2_block_tag_csum_set(journal, tag, wbuf[bufs],
+						commit_transaction->t_tid);
 		tagp += tag_bytes;
 		space_left -= tag_bytes;
 		bufs++;
@@ -708,27 +771,58 @@ void jbd2_journal_commit_transaction(journal_t *journal)
 
 			tag->t_flags |= cpu_to_be16(JBD2_FLAG_LAST_TAG);
 start_journal_io:
-			if (descriptor)
-				jbd2_descriptor_block_csum_set(journal,
-							descriptor);
-
-			for (i = 0; i < bufs; i++) {
-				struct buffer_head *bh = wbuf[i];
-
+			if (csum_work && descriptor) {
 				/*
-				 * Compute checksum.
+				 * The tag checksums only touch the
+				 * descriptor, so the data blocks can go out
+				 * right now; the worker checksums the batch
+				 * and submits the descriptor behind them.
 				 */
-				if (jbd2_has_feature_checksum(journal)) {
-					crc32_sum =
-					    jbd2_checksum_data(crc32_sum, bh);
+				for (i = 1; i < bufs; i++) {
+					struct buffer_head *bh = wbuf[i];
+
+					lock_buffer(bh);
+					clear_buffer_dirty(bh);
+					set_buffer_uptodate(bh);
+					bh->b_end_io =
+						journal_end_buffer_io_sync;
+					submit_bh(REQ_OP_WRITE |
+						  JBD2_JOURNAL_REQ_FLAGS, bh);
 				}
 
-				lock_buffer(bh);
-				clear_buffer_dirty(bh);
-				set_buffer_uptodate(bh);
-				bh->b_end_io = journal_end_buffer_io_sync;
-				submit_bh(REQ_OP_WRITE | JBD2_JOURNAL_REQ_FLAGS,
-					  bh);
+				/* wait until the worker is done with the
+				 * previous batch before reusing it */
+				flush_work(&csum_work->work);
+				csum_work->descriptor = descriptor;
+				csum_work->tid = commit_transaction->t_tid;
+				csum_work->nr = bufs - 1;
+				memcpy(csum_work->wbuf, wbuf + 1,
+				       (bufs - 1) * sizeof(*wbuf));
+				queue_work(system_unbound_wq,
+					   &csum_work->work);
+			} else {
+				if (descriptor)
+					jbd2_descriptor_block_csum_set(journal,
+								descriptor);
+
+				for (i = 0; i < bufs; i++) {
+					struct buffer_head *bh = wbuf[i];
+
+					/*
+					 * Compute checksum.
+					 */
+					if (jbd2_has_feature_checksum(journal)) {
+						crc32_sum =
+						    jbd2_checksum_data(crc32_sum, bh);
+					}
+
+					lock_buffer(bh);
+					clear_buffer_dirty(bh);
+					set_buffer_uptodate(bh);
+					bh->b_end_io = journal_end_buffer_io_sync;
+					submit_bh(REQ_OP_WRITE | JBD2_JOURNAL_REQ_FLAGS,
+						  bh);
+				}
 			}
 			cond_resched();
 
@@ -739,6 +833,16 @@ start_journal_io:
 		}
 	}
 
+	/*
+	 * All descriptors must be in flight before we start waiting on the
+	 * log buffers below, and the last batch may still sit with the
+	 * checksum worker.
+	 */
+	if (csum_work) {
+		flush_work(&csum_work->work);
+		kfree(csum_work);
+	}
+
 	err = journal_finish_inode_data_buffers(journal, commit_transaction);
 	if (err) {
 		printk(KERN_WARNING
@@ -1582,6 +1582,10 @@ static journal_t *journal_init_common(struct block_device *bdev,
 	if (!journal->j_wbuf)
 		goto err_cleanup;
 
+	journal->j_pcp_credits = alloc_percpu(struct jbd2_pcp_credits);
+	if (!journal->j_pcp_credits)
+		goto err_cleanup;
+
 	err = percpu_counter_init(&journal->j_checkpoint_jh_count, 0,
 				  GFP_KERNEL);
 	if (err)
@@ -1610,6 +1614,7 @@ err_cleanup:
 	percpu_counter_destroy(&journal->j_checkpoint_jh_count);
 	if (journal->j_chksum_driver)
 		crypto_free_shash(journal->j_chksum_driver);
+	free_percpu(journal->j_pcp_credits);
 	kfree(journal->j_wbuf);
 	jbd2_journal_destroy_revoke(journal);
 	journal_fail_superblock(journal);
@@ -2196,6 +2201,7 @@ int jbd2_journal_destroy(journal_t *journal)
 	if (journal->j_chksum_driver)
 		crypto_free_shash(journal->j_chksum_driver);
 	kfree(journal->j_fc_wbuf);
+	free_percpu(journal->j_pcp_credits);
 	kfree(journal->j_wbuf);
 	kfree(journal);
 
@@ -213,6 +213,23 @@ static void sub_reserved_credits(journal_t *journal, int blocks)
 	wake_up(&journal->j_wait_reserved);
 }
 
+/*
+ * Size of the credit batches the per-CPU caches draw from the running
+ * transaction.  Credits cached when the transaction locks down for commit
+ * stay charged to it and expire unused, so the batch is sized to keep that
+ * worst case (every CPU holding a full batch) to a small fraction of the
+ * transaction; tiny journals get no caching at all.
+ */
+static int jbd2_credit_batch(journal_t *journal)
+{
+	int batch = journal->j_max_transaction_buffers /
+			(8 * num_possible_cpus());
+
+	if (batch < 8)
+		return 0;
+	return min(batch, 128);
+}
+
 /*
  * Wait until we can add credits for handle to the running transaction.  Called
  * with j_state_lock held for reading. Returns 0 if handle joined the running
@@ -243,6 +260,26 @@ __must_hold(&journal->j_state_lock)
 		return 1;
 	}
 
+	/*
+	 * Common case: satisfy the whole request from this CPU's cached
+	 * reservation.  Those credits were charged to t_outstanding_credits
+	 * and the log space was checked when the batch was drawn, so nothing
+	 * shared needs to be touched here.  Holding j_state_lock for reading
+	 * keeps the transaction in T_RUNNING just as in the slow path.
+	 */
+	if (!rsv_blocks) {
+		struct jbd2_pcp_credits *pc;
+		bool cached;
+
+		pc = get_cpu_ptr(journal->j_pcp_credits);
+		cached = pc->tid == t->t_tid && pc->credits >= total;
+		if (cached)
+			pc->credits -= total;
+		put_cpu_ptr(journal->j_pcp_credits);
+		if (cached)
+			return 0;
+	}
+
 	/*
 	 * If there is not enough space left in the log to write all
 	 * potential buffers requested by this operation, we need to
@@ -301,9 +338,35 @@ __must_hold(&journal->j_state_lock)
 		return 1;
 	}
 
-	/* No reservation? We are done... */
-	if (!rsv_blocks)
+	/*
+	 * We paid for the shared counter update and the space checks anyway,
+	 * so refill this CPU's cache while we are here and let the next few
+	 * handles on this CPU start without them.
+	 */
+	if (!rsv_blocks) {
+		int batch = jbd2_credit_batch(journal);
+
+		if (batch) {
+			struct jbd2_pcp_credits *pc;
+
+			pc = get_cpu_ptr(journal->j_pcp_credits);
+			if (pc->tid != t->t_tid) {
+				pc->tid = t->t_tid;
+				pc->credits = 0;
+			}
+			if (pc->credits < batch) {
+				if (atomic_add_return(batch,
+					&t->t_outstanding_credits) <=
+				    journal->j_max_transaction_buffers)
+					pc->credits += batch;
+				else
+					atomic_sub(batch,
+						&t->t_outstanding_credits);
+			}
+			put_cpu_ptr(journal->j_pcp_credits);
+		}
 		return 0;
+	}
 
 	needed = atomic_add_return(rsv_blocks, &journal->j_reserved_credits);
 	/* We allow at most half of a transaction to be reserved */
@@ -742,8 +805,28 @@ static void stop_this_handle(handle_t *handle)
 			DIV_ROUND_UP(t_revokes - revokes, rr_per_blk);
 		handle->h_total_credits -= revoke_descriptors;
 	}
-	atomic_sub(handle->h_total_credits,
-		   &transaction->t_outstanding_credits);
+	/*
+	 * Return the unused credits to this CPU's cache when they fit; they
+	 * stay charged to the transaction either way, so a racing commit
+	 * lock-down at worst strands them there until the tid check expires
+	 * the entry.
+	 */
+	if (handle->h_total_credits) {
+		int unused = handle->h_total_credits;
+		int batch = jbd2_credit_batch(journal);
+		struct jbd2_pcp_credits *pc;
+
+		pc = get_cpu_ptr(journal->j_pcp_credits);
+		if (batch && pc->tid == transaction->t_tid &&
+		    pc->credits + unused <= batch) {
+			pc->credits += unused;
+			unused = 0;
+		}
+		put_cpu_ptr(journal->j_pcp_credits);
+		if (unused)
+			atomic_sub(unused,
+				   &transaction->t_outstanding_credits);
+	}
 	if (handle->h_rsv_handle)
 		__jbd2_journal_unreserve_handle(handle->h_rsv_handle,
 						transaction);
@@ -273,9 +273,52 @@ static ssize_t kernfs_file_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 	return len;
 }
 
+/* Scalar attributes served by read_lockless() fit comfortably here. */
+#define KERNFS_READ_LOCKLESS_MAX	128
+
+/*
+ * Opt-in fast path for hot scalar attributes: format the value into an
+ * on-stack buffer while holding only the active ref, skipping @of->mutex
+ * and the seq_file machinery so that high-frequency stat collectors don't
+ * contend on per-open-file locking.  See the read_lockless() comment in
+ * kernfs.h for the contract the implementation must follow.
+ */
+static ssize_t kernfs_file_read_iter_lockless(struct kiocb *iocb,
+					      struct iov_iter *iter)
+{
+	struct kernfs_open_file *of = kernfs_of(iocb->ki_filp);
+	char buf[KERNFS_READ_LOCKLESS_MAX];
+	ssize_t len;
+
+	if (!kernfs_get_active(of->kn))
+		return -ENODEV;
+
+	of->event = atomic_read(&of_on(of)->event);
+	len = kernfs_ops(of->kn)->read_lockless(of, buf, sizeof(buf));
+	kernfs_put_active(of->kn);
+
+	if (len < 0)
+		return len;
+	if (WARN_ON_ONCE(len > sizeof(buf)))
+		return -EIO;
+	if (iocb->ki_pos >= len)
+		return 0;
+
+	len = min_t(size_t, len - iocb->ki_pos, iov_iter_count(iter));
+	if (copy_to_iter(buf + iocb->ki_pos, len, iter) != len)
+		return -EFAULT;
+
+	iocb->ki_pos += len;
+	return len;
+}
+
 static ssize_t kernfs_fop_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 {
-	if (kernfs_of(iocb->ki_filp)->kn->flags & KERNFS_HAS_SEQ_SHOW)
+	struct kernfs_node *kn = kernfs_of(iocb->ki_filp)->kn;
+
+	if (kn->flags & KERNFS_HAS_READ_LOCKLESS)
+		return kernfs_file_read_iter_lockless(iocb, iter);
+	if (kn->flags & KERNFS_HAS_SEQ_SHOW)
 		return seq_read_iter(iocb, iter);
 	return kernfs_file_read_iter(iocb, iter);
 }
@@ -603,7 +646,8 @@ static int kernfs_fop_open(struct inode *inode, struct file *file)
 
 	ops = kernfs_ops(kn);
 
-	has_read = ops->seq_show || ops->read || ops->mmap;
+	has_read = ops->seq_show || ops->read || ops->read_lockless ||
+		   ops->mmap;
 	has_write = ops->write || ops->mmap;
 	has_mmap = ops->mmap;
 
@@ -1055,6 +1099,8 @@ struct kernfs_node *__kernfs_create_file(struct kernfs_node *parent,
 	 */
 	if (ops->seq_show)
 		kn->flags |= KERNFS_HAS_SEQ_SHOW;
+	if (ops->read_lockless)
+		kn->flags |= KERNFS_HAS_READ_LOCKLESS;
 	if (ops->mmap)
 		kn->flags |= KERNFS_HAS_MMAP;
 	if (ops->release)
@@ -188,6 +188,7 @@ locks_get_lock_context(struct inode *inode, int type)
 		goto out;
 
 	spin_lock_init(&ctx->flc_lock);
+	seqcount_spinlock_init(&ctx->flc_seq, &ctx->flc_lock);
 	INIT_LIST_HEAD(&ctx->flc_flock);
 	INIT_LIST_HEAD(&ctx->flc_posix);
 	INIT_LIST_HEAD(&ctx->flc_lease);
@@ -346,11 +347,22 @@ bool locks_owner_has_blockers(struct file_lock_context *flctx, fl_owner_t owner)
 }
 EXPORT_SYMBOL_GPL(locks_owner_has_blockers);
 
-/* Free a lock which is not in use. */
+static void locks_free_lock_rcu(struct rcu_head *head)
+{
+	struct file_lock *fl = container_of(head, struct file_lock, fl_rcu);
+
+	kmem_cache_free(filelock_cache, fl);
+}
+
+/*
+ * Free a lock which is not in use.  The owner references are dropped
+ * right away, but the memory is held back for a grace period so that
+ * the lockless walk in posix_test_lock() never steps on freed locks.
+ */
 void locks_free_lock(struct file_lock *fl)
 {
 	locks_release_private(fl);
-	kmem_cache_free(filelock_cache, fl);
+	call_rcu(&fl->fl_rcu, locks_free_lock_rcu);
 }
 EXPORT_SYMBOL(locks_free_lock);
 
@@ -858,7 +870,7 @@ static void locks_wake_up_blocks(struct file_lock_core *blocker)
 static void
 locks_insert_lock_ctx(struct file_lock_core *fl, struct list_head *before)
 {
-	list_add_tail(&fl->flc_list, before);
+	list_add_tail_rcu(&fl->flc_list, before);
 	locks_insert_global_locks(fl);
 }
 
@@ -954,6 +966,8 @@ posix_test_lock(struct file *filp, struct file_lock *fl)
 	struct file_lock *cfl;
 	struct file_lock_context *ctx;
 	struct inode *inode = file_inode(filp);
+	unsigned int seq;
+	bool slow;
 	void *owner;
 	void (*func)(void);
 
@@ -963,6 +977,45 @@ posix_test_lock(struct file *filp, struct file_lock *fl)
 		return;
 	}
 
+	/*
+	 * Lockless walk.  Every update of ->flc_posix happens inside a
+	 * ->flc_seq write section, so a stable sequence means the answer
+	 * was valid at some point during the call, which is all F_GETLK
+	 * can promise anyway.
+	 */
+	rcu_read_lock();
+	do {
+		seq = read_seqcount_begin(&ctx->flc_seq);
+		fl->c.flc_type = F_UNLCK;
+		slow = false;
+		list_for_each_entry_rcu(cfl, &ctx->flc_posix, c.flc_list) {
+			/*
+			 * A concurrent update may have diverted us off the
+			 * list; the writer bumped the sequence before doing
+			 * so, so this check also bounds the walk.
+			 */
+			if (read_seqcount_retry(&ctx->flc_seq, seq))
+				break;
+			/*
+			 * Copying a lock-manager lock needs lm_get_owner,
+			 * and possibly lm_expire_lock; neither is safe to
+			 * call on a lock that can go away under us.
+			 */
+			if (cfl->fl_lmops) {
+				slow = true;
+				break;
+			}
+			if (!posix_test_locks_conflict(fl, cfl))
+				continue;
+			locks_copy_conflock(fl, cfl);
+			break;
+		}
+	} while (read_seqcount_retry(&ctx->flc_seq, seq));
+	rcu_read_unlock();
+
+	if (!slow)
+		return;
+
 retry:
 	spin_lock(&ctx->flc_lock);
 	list_for_each_entry(cfl, &ctx->flc_posix, c.flc_list) {
@@ -1178,6 +1231,7 @@ static int posix_lock_inode(struct inode *inode, struct file_lock *request,
 retry:
 	percpu_down_read(&file_rwsem);
 	spin_lock(&ctx->flc_lock);
+	write_seqcount_begin(&ctx->flc_seq);
 	/*
 	 * New lock request. Walk all POSIX locks and look for conflicts. If
 	 * there are any, either return error or put the request on the
@@ -1192,6 +1246,7 @@ retry:
 				owner = fl->fl_lmops->lm_mod_owner;
 				func = fl->fl_lmops->lm_expire_lock;
 				__module_get(owner);
+				write_seqcount_end(&ctx->flc_seq);
 				spin_unlock(&ctx->flc_lock);
 				percpu_up_read(&file_rwsem);
 				(*func)();
@@ -1367,6 +1422,7 @@ retry:
 		locks_wake_up_blocks(&left->c);
 	}
  out:
+	write_seqcount_end(&ctx->flc_seq);
 	spin_unlock(&ctx->flc_lock);
 	percpu_up_read(&file_rwsem);
 	trace_posix_lock_inode(inode, request, error);
@@ -3,6 +3,8 @@
 #include <linux/slab.h>
 #include <linux/list.h>
 #include <linux/list_bl.h>
+#include <linux/list_lru.h>
+#include <linux/rculist_bl.h>
 #include <linux/module.h>
 #include <linux/sched.h>
 #include <linux/workqueue.h>
@@ -23,6 +25,11 @@
  * We provide functions for creation and removal of entries, search by key,
  * and a special "delete entry with given key-value pair" operation. Fixed
  * size hash table is used for fast key lookups.
+ *
+ * Hash chains are modified under per-bucket bitlocks and searched under RCU,
+ * so lookups don't contend with each other or with insertions into other
+ * buckets. The LRU used for reclaim is a list_lru, which has per-node locking
+ * of its own; nothing in the cache takes a global lock.
  */
 
 struct mb_cache {
@@ -32,11 +39,10 @@ struct mb_cache {
 	int			c_bucket_bits;
 	/* Maximum entries in cache to avoid degrading hash too much */
 	unsigned long		c_max_entries;
-	/* Protects c_list, c_entry_count */
-	spinlock_t		c_list_lock;
-	struct list_head	c_list;
+	/* LRU of entries for reclaim */
+	struct list_lru		c_list_lru;
 	/* Number of entries in cache */
-	unsigned long		c_entry_count;
+	atomic_long_t		c_entry_count;
 	struct shrinker		*c_shrink;
 	/* Work for shrinking when the cache has too many entries */
 	struct work_struct	c_shrink_work;
@@ -79,10 +85,10 @@ int mb_cache_entry_create(struct mb_cache *cache, gfp_t mask, u32 key,
 	struct hlist_bl_head *head;
 
 	/* Schedule background reclaim if there are too many entries */
-	if (cache->c_entry_count >= cache->c_max_entries)
+	if (atomic_long_read(&cache->c_entry_count) >= cache->c_max_entries)
 		schedule_work(&cache->c_shrink_work);
 	/* Do some sync reclaim if background reclaim cannot keep up */
-	if (cache->c_entry_count >= 2*cache->c_max_entries)
+	if (atomic_long_read(&cache->c_entry_count) >= 2*cache->c_max_entries)
 		mb_cache_shrink(cache, SYNC_SHRINK_BATCH);
 
 	entry = kmem_cache_alloc(mb_entry_cache, mask);
@@ -93,9 +99,7 @@ int mb_cache_entry_create(struct mb_cache *cache, gfp_t mask, u32 key,
 	/*
 	 * We create entry with two references. One reference is kept by the
 	 * hash table, the other reference is used to protect us from
-	 * mb_cache_entry_delete_or_get() until the entry is fully setup. This
-	 * avoids nesting of cache->c_list_lock into hash table bit locks which
-	 * is problematic for RT.
+	 * mb_cache_entry_delete_or_get() until the entry is fully setup.
 	 */
 	atomic_set(&entry->e_refcnt, 2);
 	entry->e_key = key;
@@ -112,27 +116,31 @@ int mb_cache_entry_create(struct mb_cache *cache, gfp_t mask, u32 key,
 			return -EBUSY;
 		}
 	}
-	hlist_bl_add_head(&entry->e_hash_list, head);
+	hlist_bl_add_head_rcu(&entry->e_hash_list, head);
 	hlist_bl_unlock(head);
-	spin_lock(&cache->c_list_lock);
-	list_add_tail(&entry->e_list, &cache->c_list);
-	cache->c_entry_count++;
-	spin_unlock(&cache->c_list_lock);
+	list_lru_add_obj(&cache->c_list_lru, &entry->e_list);
+	atomic_long_inc(&cache->c_entry_count);
 	mb_cache_entry_put(cache, entry);
 
 	return 0;
 }
 EXPORT_SYMBOL(mb_cache_entry_create);
 
+static void mb_cache_entry_free_rcu(struct rcu_head *rcu)
+{
+	kmem_cache_free(mb_entry_cache,
+			container_of(rcu, struct mb_cache_entry, e_rcu));
+}
+
 void __mb_cache_entry_free(struct mb_cache *cache, struct mb_cache_entry *entry)
 {
 	struct hlist_bl_head *head;
 
 	head = mb_cache_entry_head(cache, entry->e_key);
 	hlist_bl_lock(head);
-	hlist_bl_del(&entry->e_hash_list);
+	hlist_bl_del_rcu(&entry->e_hash_list);
 	hlist_bl_unlock(head);
-	kmem_cache_free(mb_entry_cache, entry);
+	call_rcu(&entry->e_rcu, mb_cache_entry_free_rcu);
 }
 EXPORT_SYMBOL(__mb_cache_entry_free);
 
@@ -156,25 +164,42 @@ static struct mb_cache_entry *__entry_find(struct mb_cache *cache,
 	struct mb_cache_entry *old_entry = entry;
 	struct hlist_bl_node *node;
 	struct hlist_bl_head *head;
+	bool past_old = !old_entry;
 
 	head = mb_cache_entry_head(cache, key);
-	hlist_bl_lock(head);
-	if (entry && !hlist_bl_unhashed(&entry->e_hash_list))
-		node = entry->e_hash_list.next;
-	else
-		node = hlist_bl_first(head);
-	while (node) {
-		entry = hlist_bl_entry(node, struct mb_cache_entry,
-				       e_hash_list);
+	rcu_read_lock();
+	hlist_bl_for_each_entry_rcu(entry, node, head, e_hash_list) {
+		if (!past_old) {
+			/*
+			 * Resume the search after @old_entry only if we meet
+			 * it in this walk: then it is still hashed and its
+			 * forward pointer is valid to follow under RCU.
+			 */
+			if (entry == old_entry)
+				past_old = true;
+			continue;
+		}
 		if (entry->e_key == key &&
 		    test_bit(MBE_REUSABLE_B, &entry->e_flags) &&
 		    atomic_inc_not_zero(&entry->e_refcnt))
 			goto out;
-		node = node->next;
+	}
+	if (!past_old) {
+		/*
+		 * @old_entry was removed from the chain while we walked it.
+		 * Fall back to returning the first reusable entry, matching
+		 * the documented behavior for an unhashed starting point.
+		 */
+		hlist_bl_for_each_entry_rcu(entry, node, head, e_hash_list) {
+			if (entry->e_key == key &&
+			    test_bit(MBE_REUSABLE_B, &entry->e_flags) &&
+			    atomic_inc_not_zero(&entry->e_refcnt))
+				goto out;
+		}
 	}
 	entry = NULL;
 out:
-	hlist_bl_unlock(head);
+	rcu_read_unlock();
 	if (old_entry)
 		mb_cache_entry_put(cache, old_entry);
 
@@ -227,15 +252,15 @@ struct mb_cache_entry *mb_cache_entry_get(struct mb_cache *cache, u32 key,
 	struct mb_cache_entry *entry;
 
 	head = mb_cache_entry_head(cache, key);
-	hlist_bl_lock(head);
-	hlist_bl_for_each_entry(entry, node, head, e_hash_list) {
+	rcu_read_lock();
+	hlist_bl_for_each_entry_rcu(entry, node, head, e_hash_list) {
 		if (entry->e_key == key && entry->e_value == value &&
 		    atomic_inc_not_zero(&entry->e_refcnt))
 			goto out;
 	}
 	entry = NULL;
 out:
-	hlist_bl_unlock(head);
+	rcu_read_unlock();
 	return entry;
 }
 EXPORT_SYMBOL(mb_cache_entry_get);
@@ -267,11 +292,8 @@ struct mb_cache_entry *mb_cache_entry_delete_or_get(struct mb_cache *cache,
 	if (atomic_cmpxchg(&entry->e_refcnt, 2, 0) != 2)
 		return entry;
 
-	spin_lock(&cache->c_list_lock);
-	if (!list_empty(&entry->e_list))
-		list_del_init(&entry->e_list);
-	cache->c_entry_count--;
-	spin_unlock(&cache->c_list_lock);
+	list_lru_del_obj(&cache->c_list_lru, &entry->e_list);
+	atomic_long_dec(&cache->c_entry_count);
 	__mb_cache_entry_free(cache, entry);
 	return NULL;
 }
@@ -295,37 +317,49 @@ static unsigned long mb_cache_count(struct shrinker *shrink,
 {
 	struct mb_cache *cache = shrink->private_data;
 
-	return cache->c_entry_count;
+	return list_lru_shrink_count(&cache->c_list_lru, sc);
 }
 
-/* Shrink number of entries in cache */
-static unsigned long mb_cache_shrink(struct mb_cache *cache,
-				     unsigned long nr_to_scan)
+static enum lru_status mb_cache_entry_lru_isolate(struct list_head *item,
+		struct list_lru_one *list, spinlock_t *lock, void *cb_arg)
 {
-	struct mb_cache_entry *entry;
-	unsigned long shrunk = 0;
-
-	spin_lock(&cache->c_list_lock);
-	while (nr_to_scan-- && !list_empty(&cache->c_list)) {
-		entry = list_first_entry(&cache->c_list,
-					 struct mb_cache_entry, e_list);
-		/* Drop initial hash reference if there is no user */
-		if (test_bit(MBE_REFERENCED_B, &entry->e_flags) ||
-		    atomic_cmpxchg(&entry->e_refcnt, 1, 0) != 1) {
-			clear_bit(MBE_REFERENCED_B, &entry->e_flags);
-			list_move_tail(&entry->e_list, &cache->c_list);
-			continue;
-		}
+	struct mb_cache_entry *entry = container_of(item,
+					struct mb_cache_entry, e_list);
+	struct list_head *dispose = cb_arg;
+
+	/* Drop the initial hash reference if there is no user */
+	if (test_bit(MBE_REFERENCED_B, &entry->e_flags) ||
+	    atomic_cmpxchg(&entry->e_refcnt, 1, 0) != 1) {
+		clear_bit(MBE_REFERENCED_B, &entry->e_flags);
+		return LRU_ROTATE;
+	}
+	list_lru_isolate_move(list, item, dispose);
+	return LRU_REMOVED;
+}
+
+static void mb_cache_dispose_list(struct mb_cache *cache,
+				  struct list_head *dispose)
+{
+	struct mb_cache_entry *entry, *next;
+
+	list_for_each_entry_safe(entry, next, dispose, e_list) {
 		list_del_init(&entry->e_list);
-		cache->c_entry_count--;
-		spin_unlock(&cache->c_list_lock);
+		atomic_long_dec(&cache->c_entry_count);
 		__mb_cache_entry_free(cache, entry);
-		shrunk++;
 		cond_resched();
-		spin_lock(&cache->c_list_lock);
 	}
-	spin_unlock(&cache->c_list_lock);
+}
+
+/* Shrink number of entries in cache */
+static unsigned long mb_cache_shrink(struct mb_cache *cache,
+				     unsigned long nr_to_scan)
+{
+	LIST_HEAD(dispose);
+	unsigned long shrunk;
 
+	shrunk = list_lru_walk(&cache->c_list_lru, mb_cache_entry_lru_isolate,
+			       &dispose, nr_to_scan);
+	mb_cache_dispose_list(cache, &dispose);
 	return shrunk;
 }
 
@@ -333,7 +367,13 @@ static unsigned long mb_cache_scan(struct shrinker *shrink,
 				   struct shrink_control *sc)
 {
 	struct mb_cache *cache = shrink->private_data;
-	return mb_cache_shrink(cache, sc->nr_to_scan);
+	LIST_HEAD(dispose);
+	unsigned long shrunk;
+
+	shrunk = list_lru_shrink_walk(&cache->c_list_lru, sc,
+				      mb_cache_entry_lru_isolate, &dispose);
+	mb_cache_dispose_list(cache, &dispose);
+	return shrunk;
 }
 
 /* We shrink 1/X of the cache when we have too many entries in it */
@@ -363,8 +403,6 @@ struct mb_cache *mb_cache_create(int bucket_bits)
 		goto err_out;
 	cache->c_bucket_bits = bucket_bits;
 	cache->c_max_entries = bucket_count << 4;
-	INIT_LIST_HEAD(&cache->c_list);
-	spin_lock_init(&cache->c_list_lock);
 	cache->c_hash = kmalloc_array(bucket_count,
 				      sizeof(struct hlist_bl_head),
 				      GFP_KERNEL);
@@ -375,8 +413,15 @@ struct mb_cache *mb_cache_create(int bucket_bits)
 	for (i = 0; i < bucket_count; i++)
 		INIT_HLIST_BL_HEAD(&cache->c_hash[i]);
 
+	if (list_lru_init(&cache->c_list_lru)) {
+		kfree(cache->c_hash);
+		kfree(cache);
+		goto err_out;
+	}
+
 	cache->c_shrink = shrinker_alloc(0, "mbcache-shrinker");
 	if (!cache->c_shrink) {
+		list_lru_destroy(&cache->c_list_lru);
 		kfree(cache->c_hash);
 		kfree(cache);
 		goto err_out;
@@ -397,6 +442,13 @@ err_out:
 }
 EXPORT_SYMBOL(mb_cache_create);
 
+static enum lru_status mb_cache_entry_lru_isolate_all(struct list_head *item,
+		struct list_lru_one *list, spinlock_t *lock, void *cb_arg)
+{
+	list_lru_isolate_move(list, item, cb_arg);
+	return LRU_REMOVED;
+}
+
 /*
  * mb_cache_destroy - destroy cache
  * @cache: the cache to destroy
@@ -407,18 +459,22 @@ EXPORT_SYMBOL(mb_cache_create);
 void mb_cache_destroy(struct mb_cache *cache)
 {
 	struct mb_cache_entry *entry, *next;
+	LIST_HEAD(dispose);
 
 	shrinker_free(cache->c_shrink);
 
 	/*
-	 * We don't bother with any locking. Cache must not be used at this
-	 * point.
+	 * Cache must not be used at this point, so the walk cannot race with
+	 * anybody adding or removing entries.
 	 */
-	list_for_each_entry_safe(entry, next, &cache->c_list, e_list) {
+	list_lru_walk(&cache->c_list_lru, mb_cache_entry_lru_isolate_all,
+		      &dispose, ULONG_MAX);
+	list_for_each_entry_safe(entry, next, &dispose, e_list) {
 		list_del(&entry->e_list);
 		WARN_ON(atomic_read(&entry->e_refcnt) != 1);
 		mb_cache_entry_put(cache, entry);
 	}
+	list_lru_destroy(&cache->c_list_lru);
 	kfree(cache->c_hash);
 	kfree(cache);
 }
@@ -434,6 +490,8 @@ static int __init mbcache_init(void)
 
 static void __exit mbcache_exit(void)
 {
+	/* Entries are freed via call_rcu() */
+	rcu_barrier();
 	kmem_cache_destroy(mb_entry_cache);
 }
 
@@ -5048,7 +5048,7 @@ static struct mount *listmnt_next(struct mount *curr)
 }
 
 static ssize_t do_listmount(struct mount *first, struct path *orig,
-			    u64 mnt_parent_id, u64 __user *mnt_ids,
+			    u64 mnt_parent_id, u64 *mnt_ids,
 			    size_t nr_mnt_ids, const struct path *root)
 {
 	struct mount *r;
@@ -5071,9 +5071,7 @@ static ssize_t do_listmount(struct mount *first, struct path *orig,
 			continue;
 		if (!is_path_reachable(r, r->mnt.mnt_root, orig))
 			continue;
-		if (put_user(r->mnt_id_unique, mnt_ids))
-			return -EFAULT;
-		mnt_ids++;
+		*mnt_ids++ = r->mnt_id_unique;
 		nr_mnt_ids--;
 		ret++;
 	}
@@ -5085,11 +5083,13 @@ SYSCALL_DEFINE4(listmount, const struct mnt_id_req __user *, req, u64 __user *,
 {
 	struct mnt_namespace *ns = current->nsproxy->mnt_ns;
 	struct mnt_id_req kreq;
-	struct mount *first;
-	struct path root, orig;
 	u64 mnt_parent_id, last_mnt_id;
+	u64 *kbuf;
 	const size_t maxcount = (size_t)-1 >> 3;
-	ssize_t ret;
+	/* one page cache's worth of ids gathered per pass under the lock */
+	const size_t max_batch = PAGE_SIZE / sizeof(*kbuf);
+	size_t batch;
+	ssize_t nr = 0, ret;
 
 	if (flags)
 		return -EINVAL;
@@ -5106,26 +5106,63 @@ SYSCALL_DEFINE4(listmount, const struct mnt_id_req __user *, req, u64 __user *,
 	mnt_parent_id = kreq.mnt_id;
 	last_mnt_id = kreq.param;
 
-	down_read(&namespace_sem);
-	get_fs_root(current->fs, &root);
-	if (mnt_parent_id == LSMT_ROOT) {
-		orig = root;
-	} else {
-		ret = -ENOENT;
-		orig.mnt = lookup_mnt_in_ns(mnt_parent_id, ns);
-		if (!orig.mnt)
-			goto err;
-		orig.dentry = orig.mnt->mnt_root;
-	}
-	if (!last_mnt_id)
-		first = node_to_mount(rb_first(&ns->mounts));
-	else
-		first = mnt_find_id_at(ns, last_mnt_id + 1);
+	/*
+	 * Gather ids into a kernel buffer in bounded batches, copying each
+	 * batch out to userspace with namespace_sem dropped, so a large
+	 * listing no longer stalls mount/umount for its whole duration (or
+	 * takes page faults under the lock).  Batches continue from the
+	 * last returned id exactly like userspace-driven continuation via
+	 * mnt_id_req->param does, since the tree is ordered by unique id.
+	 */
+	batch = min_t(size_t, nr_mnt_ids, max_batch);
+	kbuf = kvmalloc_array(batch, sizeof(*kbuf), GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
 
-	ret = do_listmount(first, &orig, mnt_parent_id, mnt_ids, nr_mnt_ids, &root);
-err:
-	path_put(&root);
-	up_read(&namespace_sem);
+	while (nr_mnt_ids) {
+		size_t chunk = min_t(size_t, nr_mnt_ids, batch);
+		struct mount *first;
+		struct path root, orig;
+
+		down_read(&namespace_sem);
+		get_fs_root(current->fs, &root);
+		if (mnt_parent_id == LSMT_ROOT) {
+			orig = root;
+		} else {
+			orig.mnt = lookup_mnt_in_ns(mnt_parent_id, ns);
+			if (!orig.mnt) {
+				path_put(&root);
+				up_read(&namespace_sem);
+				ret = -ENOENT;
+				goto out;
+			}
+			orig.dentry = orig.mnt->mnt_root;
+		}
+		if (!last_mnt_id)
+			first = node_to_mount(rb_first(&ns->mounts));
+		else
+			first = mnt_find_id_at(ns, last_mnt_id + 1);
+
+		ret = do_listmount(first, &orig, mnt_parent_id, kbuf, chunk,
+				   &root);
+		path_put(&root);
+		up_read(&namespace_sem);
+		if (ret < 0)
+			goto out;
+
+		if (copy_to_user(mnt_ids + nr, kbuf, ret * sizeof(*kbuf))) {
+			ret = -EFAULT;
+			goto out;
+		}
+		nr += ret;
+		nr_mnt_ids -= ret;
+		if ((size_t)ret < chunk)
+			break;
+		last_mnt_id = kbuf[ret - 1];
+	}
+	ret = nr;
+out:
+	kvfree(kbuf);
 	return ret;
 }
 
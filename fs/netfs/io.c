@@ -14,8 +14,21 @@
 #include <linux/uio.h>
 #include <linux/sched/mm.h>
 #include <linux/task_io_accounting_ops.h>
+#include <linux/math64.h>
+#include <linux/blkdev.h>
 #include "internal.h"
 
+/*
+ * Aim each server subrequest at roughly this much transfer time at the
+ * observed download bandwidth.  Slow or cold servers then gate
+ * proportionally less data per slice and a striped read rebalances onto the
+ * faster connections sooner.
+ */
+#define NETFS_SREQ_TARGET_MSEC	100
+
+/* Never let the adaptive clamp drive slices below this */
+#define NETFS_SREQ_MIN_LEN	(256 * 1024)
+
 /*
  * Clear the unread part of an I/O request.
  */
@@ -85,9 +98,31 @@ static void netfs_read_from_server(struct netfs_io_request *rreq,
 			rreq->debug_id, subreq->debug_index,
 			iov_iter_count(&subreq->io_iter), subreq->len,
 			subreq->transferred, subreq->flags);
+	subreq->issue_time = ktime_get_ns();
 	rreq->netfs_ops->issue_read(subreq);
 }
 
+/*
+ * Fold the download bandwidth achieved by a subrequest leg into the per-inode
+ * estimate.  An EWMA with a weight of 1/4 for the new sample reacts quickly
+ * when a server slows down whilst riding out one-off blips.
+ */
+static void netfs_update_download_rate(struct netfs_io_subrequest *subreq,
+				       size_t bytes)
+{
+	struct netfs_inode *ictx = netfs_inode(subreq->rreq->inode);
+	u64 duration = ktime_get_ns() - subreq->issue_time;
+	unsigned long rate, old;
+
+	if (duration == 0 || bytes == 0)
+		return;
+	rate = div64_u64((u64)bytes * NSEC_PER_SEC, duration);
+	old = atomic_long_read(&ictx->download_rate);
+	if (old)
+		rate = old - (old >> 2) + (rate >> 2);
+	atomic_long_set(&ictx->download_rate, rate);
+}
+
 /*
  * Release those waiting.
  */
@@ -356,6 +391,8 @@ void netfs_subreq_terminated(struct netfs_io_subrequest *subreq,
 
 	subreq->error = 0;
 	subreq->transferred += transferred_or_error;
+	if (subreq->source == NETFS_DOWNLOAD_FROM_SERVER)
+		netfs_update_download_rate(subreq, transferred_or_error);
 	if (subreq->transferred < subreq->len)
 		goto incomplete;
 
@@ -433,6 +470,7 @@ netfs_rreq_prepare_read(struct netfs_io_request *rreq,
 {
 	enum netfs_io_source source = NETFS_DOWNLOAD_FROM_SERVER;
 	struct netfs_inode *ictx = netfs_inode(rreq->inode);
+	unsigned long rate;
 	size_t lsize;
 
 	_enter("%llx-%llx,%llx", subreq->start, subreq->start + subreq->len, rreq->i_size);
@@ -463,6 +501,21 @@ netfs_rreq_prepare_read(struct netfs_io_request *rreq,
 		if (rreq->rsize && subreq->len > rreq->rsize)
 			subreq->len = rreq->rsize;
 
+		/* Adapt the slice to the bandwidth observed against this
+		 * file's servers so that each slice covers roughly
+		 * NETFS_SREQ_TARGET_MSEC of transfer.
+		 */
+		rate = atomic_long_read(&ictx->download_rate);
+		if (rate) {
+			size_t cap = max_t(size_t, NETFS_SREQ_MIN_LEN,
+					   div_u64((u64)rate *
+						   NETFS_SREQ_TARGET_MSEC,
+						   MSEC_PER_SEC));
+
+			if (subreq->len > cap)
+				subreq->len = cap;
+		}
+
 		if (rreq->netfs_ops->clamp_length &&
 		    !rreq->netfs_ops->clamp_length(subreq)) {
 			source = NETFS_INVALID_READ;
@@ -568,6 +621,7 @@ subreq_failed:
 int netfs_begin_read(struct netfs_io_request *rreq, bool sync)
 {
 	struct iov_iter io_iter;
+	struct blk_plug plug;
 	int ret;
 
 	_enter("R=%x %llx-%llx",
@@ -592,6 +646,12 @@ int netfs_begin_read(struct netfs_io_request *rreq, bool sync)
 	netfs_get_request(rreq, netfs_rreq_trace_get_for_outstanding);
 	atomic_set(&rreq->nr_outstanding, 1);
 	io_iter = rreq->io_iter;
+	/*
+	 * Plug across the whole burst of slices so that cache reads issued
+	 * against fast local media go to the device as one submission rather
+	 * than one per subrequest.
+	 */
+	blk_start_plug(&plug);
 	do {
 		_debug("submit %llx + %llx >= %llx",
 		       rreq->start, rreq->submitted, rreq->i_size);
@@ -605,6 +665,7 @@ int netfs_begin_read(struct netfs_io_request *rreq, bool sync)
 			break;
 
 	} while (rreq->submitted < rreq->len);
+	blk_finish_plug(&plug);
 
 	if (!rreq->submitted) {
 		netfs_put_request(rreq, false, netfs_rreq_trace_put_no_submit);
@@ -350,6 +350,9 @@ nfsd_file_get(struct nfsd_file *nf)
  * Put a reference to a nfsd_file. In the non-GC case, we just put the
  * reference immediately. In the GC case, if the reference would be
  * the last one, the put it on the LRU instead to be cleaned up later.
+ * A file that is already on the LRU keeps the LRU's reference, so the
+ * common put of an actively-cached file never leaves this function's
+ * fast path.
  */
 void
 nfsd_file_put(struct nfsd_file *nf)
@@ -1003,12 +1006,14 @@ retry:
 
 	if (nf) {
 		/*
-		 * If the nf is on the LRU then it holds an extra reference
-		 * that must be put if it's removed. It had better not be
-		 * the last one however, since we should hold another.
+		 * If the nf is on the LRU, leave it there. Marking it
+		 * referenced is enough to hold off the garbage collector,
+		 * and means that a cache hit never has to touch the LRU
+		 * locks. The LRU's reference keeps nfsd_file_put() from
+		 * seeing ours as the last one while the file is listed.
 		 */
-		if (nfsd_file_lru_remove(nf))
-			WARN_ON_ONCE(refcount_dec_and_test(&nf->nf_ref));
+		if (test_bit(NFSD_FILE_GC, &nf->nf_flags))
+			set_bit(NFSD_FILE_REFERENCED, &nf->nf_flags);
 		goto wait_for_construction;
 	}
 
@@ -666,6 +666,12 @@ int nfsd_create_serv(struct net *net)
 		return -ENOMEM;
 
 	serv->sv_maxconn = nn->max_connections;
+	/*
+	 * Let svc_xprt_enqueue() grow each pool on demand, up to twice
+	 * the number of CPUs the pool serves.
+	 */
+	serv->sv_max_pool_threads =
+		max(4U, DIV_ROUND_UP(2 * num_online_cpus(), serv->sv_nrpools));
 	error = svc_bind(serv, net);
 	if (error < 0) {
 		svc_destroy(&serv);
@@ -14,6 +14,7 @@
 #include <linux/buffer_head.h>
 #include <linux/bio.h>
 #include <linux/completion.h>
+#include <linux/workqueue.h>
 
 /**
  * struct nilfs_segsum_info - On-memory segment summary
@@ -80,6 +81,10 @@ struct nilfs_segment_buffer {
 	int			sb_nbio;
 	atomic_t		sb_err;
 	struct completion	sb_bio_event;
+
+	/* Parallel checksum calculation */
+	struct work_struct	sb_crc_work;
+	u32			sb_crc_seed;
 };
 
 #define NILFS_LIST_SEGBUF(head)  \
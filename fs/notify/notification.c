@@ -87,6 +87,7 @@ int fsnotify_insert_event(struct fsnotify_group *group,
 {
 	int ret = 0;
 	struct list_head *list = &group->notification_list;
+	bool was_empty;
 
 	pr_debug("%s: group=%p event=%p\n", __func__, group, event);
 
@@ -118,14 +119,26 @@ int fsnotify_insert_event(struct fsnotify_group *group,
 	}
 
 queue:
+	was_empty = list_empty(list);
 	group->q_len++;
 	list_add_tail(&event->list, list);
 	if (insert)
 		insert(group, event);
 	spin_unlock(&group->notification_lock);
 
-	wake_up(&group->notification_waitq);
-	kill_fasync(&group->fsn_fa, SIGIO, POLL_IN);
+	/*
+	 * Only the event that makes the queue non-empty needs to notify
+	 * readers.  Waiters are added to the waitqueue before checking the
+	 * queue under the lock, so they cannot miss this wakeup, and as
+	 * long as the queue stays non-empty they have already been woken
+	 * and will keep draining before sleeping again.  This keeps
+	 * modify-heavy workloads from generating a wakeup storm while a
+	 * reader is busy draining the backlog.
+	 */
+	if (was_empty) {
+		wake_up(&group->notification_waitq);
+		kill_fasync(&group->fsn_fa, SIGIO, POLL_IN);
+	}
 	return ret;
 }
 
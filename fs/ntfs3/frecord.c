@@ -2162,6 +2162,139 @@ out:
 	return err;
 }
 
+/*
+ * Asynchronous decompression of upcoming compression units.
+ *
+ * Sequential scans of compressed files otherwise alternate between
+ * reading and decompressing one frame at a time in the reader's context.
+ * The readahead window is handed to an unbound worker that pre-reads and
+ * decompresses whole frames into the page cache, so IO and CPU overlap
+ * with the consumer; the page cache itself acts as the cache of
+ * decompressed runs.
+ */
+struct ntfs_cmpr_ra {
+	struct work_struct work;
+	struct ntfs_inode *ni;
+	u64 vbo;
+	u64 end;
+};
+
+static void ni_readahead_cmpr_worker(struct work_struct *work)
+{
+	struct ntfs_cmpr_ra *ra = container_of(work, struct ntfs_cmpr_ra, work);
+	struct ntfs_inode *ni = ra->ni;
+	struct super_block *sb = ni->vfs_inode.i_sb;
+	struct address_space *mapping = ni->vfs_inode.i_mapping;
+	gfp_t gfp_mask = mapping_gfp_mask(mapping);
+	struct page **pages;
+	struct page *pg;
+	u8 frame_bits;
+	u32 i, nr, frame_size, pages_per_frame;
+	u64 vbo;
+
+	if (ni->ni_flags & NI_FLAG_COMPRESSED_MASK)
+		frame_bits = ni_ext_compress_bits(ni);
+	else
+		frame_bits = NTFS_LZNT_CUNIT + ni->mi.sbi->cluster_bits;
+	frame_size = 1u << frame_bits;
+	pages_per_frame = frame_size >> PAGE_SHIFT;
+
+	pages = kcalloc(pages_per_frame, sizeof(struct page *), GFP_NOFS);
+	if (!pages)
+		goto out;
+
+	for (vbo = ra->vbo & ~((u64)frame_size - 1); vbo < ra->end;
+	     vbo += frame_size) {
+		pgoff_t index = vbo >> PAGE_SHIFT;
+
+		if (vbo >= i_size_read(&ni->vfs_inode))
+			break;
+
+		/* Skip frames that are already cached. */
+		pg = find_get_page(mapping, index);
+		if (pg) {
+			bool uptodate = PageUptodate(pg);
+
+			put_page(pg);
+			if (uptodate)
+				continue;
+		}
+
+		/*
+		 * Take ni_lock before gathering pages and never block on a
+		 * page lock: a reader holds its locked page while waiting
+		 * for ni_lock, so blocking here would deadlock.  A failed
+		 * trylock means the reader has caught up - stop.
+		 */
+		ni_lock(ni);
+		for (nr = 0; nr < pages_per_frame; nr++) {
+			pg = pagecache_get_page(mapping, index + nr,
+						FGP_LOCK | FGP_CREAT |
+						FGP_NOFS | FGP_NOWAIT,
+						gfp_mask);
+			if (!pg)
+				break;
+			pages[nr] = pg;
+		}
+
+		if (nr == pages_per_frame) {
+			/* Best effort - a failed frame is re-read on demand. */
+			ni_read_frame(ni, vbo, pages, pages_per_frame);
+		}
+
+		for (i = 0; i < nr; i++) {
+			unlock_page(pages[i]);
+			put_page(pages[i]);
+		}
+		ni_unlock(ni);
+
+		if (nr < pages_per_frame)
+			break;
+	}
+
+	kfree(pages);
+out:
+	iput(&ni->vfs_inode);
+	kfree(ra);
+	/* drops the reference taken in ni_readahead_cmpr() */
+	deactivate_super(sb);
+}
+
+/*
+ * ni_readahead_cmpr - kick off decompression of frames in [@vbo, @end).
+ */
+void ni_readahead_cmpr(struct ntfs_inode *ni, u64 vbo, u64 end)
+{
+	struct ntfs_cmpr_ra *ra;
+
+	if (vbo >= end)
+		return;
+
+	ra = kmalloc(sizeof(*ra), GFP_NOFS | __GFP_NOWARN);
+	if (!ra)
+		return;
+
+	if (!igrab(&ni->vfs_inode)) {
+		kfree(ra);
+		return;
+	}
+
+	/*
+	 * The inode reference alone does not keep unmount from tearing the
+	 * superblock down under the work item; generic_shutdown_super()
+	 * only complains about busy inodes and proceeds.  Pin the sb too -
+	 * the caller is in the middle of ->readahead, so it is active.
+	 * The worker drops it with deactivate_super().
+	 */
+	atomic_inc(&ni->vfs_inode.i_sb->s_active);
+
+	ra->ni = ni;
+	ra->vbo = vbo;
+	ra->end = end;
+	INIT_WORK(&ra->work, ni_readahead_cmpr_worker);
+	queue_work(system_unbound_wq, &ra->work);
+}
+
 #ifdef CONFIG_NTFS3_LZX_XPRESS
 /*
  * ni_decompress_file - Decompress LZX/Xpress compressed file.
@@ -751,7 +751,9 @@ static void ntfs_readahead(struct readahead_control *rac)
 	}
 
 	if (is_compressed(ni)) {
-		/* No readahead for compressed. */
+		/* Decompress the upcoming frames on a worker. */
+		ni_readahead_cmpr(ni, readahead_pos(rac),
+				  readahead_pos(rac) + readahead_length(rac));
 		return;
 	}
 
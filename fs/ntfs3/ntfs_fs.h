@@ -565,6 +565,7 @@ int ni_write_inode(struct inode *inode, int sync, const char *hint);
 int ni_fiemap(struct ntfs_inode *ni, struct fiemap_extent_info *fieinfo,
 	      __u64 vbo, __u64 len);
 int ni_readpage_cmpr(struct ntfs_inode *ni, struct page *page);
+void ni_readahead_cmpr(struct ntfs_inode *ni, u64 vbo, u64 end);
 int ni_decompress_file(struct ntfs_inode *ni);
 int ni_read_frame(struct ntfs_inode *ni, u64 frame_vbo, struct page **pages,
 		  u32 pages_per_frame);
@@ -1026,6 +1026,124 @@ int ovl_verify_lowerdata(struct dentry *dentry)
 	return ovl_maybe_validate_verity(dentry);
 }
 
+/*
+ * Cache of completed lower layer walks in a merge directory.
+ *
+ * Lower layers are immutable while the overlay is mounted, so once a full
+ * lookup has walked the lower stack of a directory we can remember the
+ * first layer that contained the name - or that no lower layer did - and
+ * start subsequent walks from that layer.  The upper layer is mutable and
+ * is always probed.  An upper redirect changes the name or the stack used
+ * for the lower walk, so the cache is neither consulted nor populated in
+ * that case.
+ */
+#define OVL_LOOKUP_CACHE_MAX_ENTRIES 256
+
+struct ovl_lookup_cache_entry {
+	struct list_head node;
+	unsigned int lowest;	/* first lower index with this name */
+	u32 hash;
+	u32 len;
+	char name[];
+};
+
+struct ovl_lookup_cache {
+	spinlock_t lock;
+	struct list_head entries;
+	unsigned int nr;
+};
+
+/*
+ * Return the first lower index that may contain @name, ovl_numlower() or
+ * more if no lower layer does, or -1 if nothing has been cached yet.
+ */
+static int ovl_lookup_cache_probe(struct inode *dir, const struct qstr *name)
+{
+	struct ovl_lookup_cache *cache = READ_ONCE(OVL_I(dir)->lcache);
+	struct ovl_lookup_cache_entry *e;
+	int lowest = -1;
+
+	if (!cache)
+		return -1;
+
+	spin_lock(&cache->lock);
+	list_for_each_entry(e, &cache->entries, node) {
+		if (e->hash == name->hash && e->len == name->len &&
+		    !memcmp(e->name, name->name, name->len)) {
+			lowest = e->lowest;
+			break;
+		}
+	}
+	spin_unlock(&cache->lock);
+
+	return lowest;
+}
+
+static void ovl_lookup_cache_add(struct inode *dir, const struct qstr *name,
+				 unsigned int lowest)
+{
+	struct ovl_inode *oi = OVL_I(dir);
+	struct ovl_lookup_cache *cache = READ_ONCE(oi->lcache);
+	struct ovl_lookup_cache_entry *e, *tmp;
+
+	if (!cache) {
+		cache = kzalloc(sizeof(*cache), GFP_KERNEL);
+		if (!cache)
+			return;
+		spin_lock_init(&cache->lock);
+		INIT_LIST_HEAD(&cache->entries);
+		if (cmpxchg(&oi->lcache, NULL, cache)) {
+			kfree(cache);
+			cache = oi->lcache;
+		}
+	}
+
+	e = kmalloc(sizeof(*e) + name->len + 1, GFP_KERNEL);
+	if (!e)
+		return;
+
+	e->lowest = lowest;
+	e->hash = name->hash;
+	e->len = name->len;
+	memcpy(e->name, name->name, name->len);
+	e->name[name->len] = '\0';
+
+	spin_lock(&cache->lock);
+	list_for_each_entry(tmp, &cache->entries, node) {
+		/* Raced with another lookup of the same name? */
+		if (tmp->hash == e->hash && tmp->len == e->len &&
+		    !memcmp(tmp->name, e->name, e->len)) {
+			spin_unlock(&cache->lock);
+			kfree(e);
+			return;
+		}
+	}
+	if (cache->nr >= OVL_LOOKUP_CACHE_MAX_ENTRIES) {
+		tmp = list_last_entry(&cache->entries,
+				      struct ovl_lookup_cache_entry, node);
+		list_del(&tmp->node);
+		kfree(tmp);
+		cache->nr--;
+	}
+	list_add(&e->node, &cache->entries);
+	cache->nr++;
+	spin_unlock(&cache->lock);
+}
+
+void ovl_lookup_cache_free(struct inode *inode)
+{
+	struct ovl_lookup_cache *cache = OVL_I(inode)->lcache;
+	struct ovl_lookup_cache_entry *e, *tmp;
+
+	if (!cache)
+		return;
+
+	list_for_each_entry_safe(e, tmp, &cache->entries, node)
+		kfree(e);
+	kfree(cache);
+	OVL_I(inode)->lcache = NULL;
+}
+
 struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 			  unsigned int flags)
 {
@@ -1044,6 +1162,8 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 	char *upperredirect = NULL;
 	struct dentry *this;
 	unsigned int i;
+	unsigned int first_lower = UINT_MAX;
+	int lower_start = -1;
 	int err;
 	bool uppermetacopy = false;
 	int metacopy_size = 0;
@@ -1105,6 +1225,13 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 		upperopaque = d.opaque;
 	}
 
+	/*
+	 * A previous walk of this directory's lower stack may have recorded
+	 * the first layer that can contain the name.
+	 */
+	if (!d.stop && !upperredirect && ovl_numlower(poe) > 1)
+		lower_start = ovl_lookup_cache_probe(dir, &dentry->d_name);
+
 	if (!d.stop && ovl_numlower(poe)) {
 		err = -ENOMEM;
 		stack = ovl_stack_alloc(ofs->numlayer - 1);
@@ -1112,7 +1239,8 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 			goto out_put_upper;
 	}
 
-	for (i = 0; !d.stop && i < ovl_numlower(poe); i++) {
+	for (i = lower_start > 0 ? lower_start : 0;
+	     !d.stop && i < ovl_numlower(poe); i++) {
 		struct ovl_path lower = ovl_lowerstack(poe)[i];
 
 		if (!ovl_redirect_follow(ofs))
@@ -1128,6 +1256,9 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 		if (!this)
 			continue;
 
+		if (first_lower == UINT_MAX)
+			first_lower = i;
+
 		if ((uppermetacopy || d.metacopy) && !ofs->config.metacopy) {
 			dput(this);
 			err = -EPERM;
@@ -1214,6 +1345,19 @@ struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 		}
 	}
 
+	/*
+	 * Remember where the lower walk first found the name, or that it
+	 * found nothing, unless this was already known.  A hit in the top
+	 * lower layer is not worth caching, and a walk that was cut short
+	 * by an opaque or whiteout upper entry proves nothing about the
+	 * lower layers.
+	 */
+	if (lower_start == -1 && !upperredirect && ovl_numlower(poe) > 1 &&
+	    (first_lower != UINT_MAX || !d.stop) &&
+	    min(first_lower, ovl_numlower(poe)) > 0)
+		ovl_lookup_cache_add(dir, &dentry->d_name,
+				     min(first_lower, ovl_numlower(poe)));
+
 	/* Defer lookup of lowerdata in data-only layers to first access */
 	if (d.metacopy && ctr && ofs->numdatalayer && d.absolute_redirect) {
 		d.metacopy = 0;
@@ -698,6 +698,7 @@ int ovl_path_next(int idx, struct dentry *dentry, struct path *path,
 int ovl_verify_lowerdata(struct dentry *dentry);
 struct dentry *ovl_lookup(struct inode *dir, struct dentry *dentry,
 			  unsigned int flags);
+void ovl_lookup_cache_free(struct inode *inode);
 bool ovl_lower_positive(struct dentry *dentry);
 
 static inline int ovl_verify_origin_fh(struct ovl_fs *ofs, struct dentry *upper,
@@ -164,6 +164,7 @@ struct ovl_inode {
 		struct ovl_dir_cache *cache;	/* directory */
 		const char *lowerdata_redirect;	/* regular file */
 	};
+	struct ovl_lookup_cache *lcache;	/* directory */
 	const char *redirect;
 	u64 version;
 	unsigned long flags;
@@ -153,6 +153,7 @@ static struct inode *ovl_alloc_inode(struct super_block *sb)
 		return NULL;
 
 	oi->cache = NULL;
+	oi->lcache = NULL;
 	oi->redirect = NULL;
 	oi->version = 0;
 	oi->flags = 0;
@@ -180,10 +181,12 @@ static void ovl_destroy_inode(struct inode *inode)
 
 	dput(oi->__upperdentry);
 	ovl_stack_put(ovl_lowerstack(oi->oe), ovl_numlower(oi->oe));
-	if (S_ISDIR(inode->i_mode))
+	if (S_ISDIR(inode->i_mode)) {
 		ovl_dir_cache_free(inode);
-	else
+		ovl_lookup_cache_free(inode);
+	} else {
 		kfree(oi->lowerdata_redirect);
+	}
 }
 
 static void ovl_put_super(struct super_block *sb)
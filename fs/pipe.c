@@ -121,8 +121,10 @@ static void anon_pipe_buf_release(struct pipe_inode_info *pipe,
 	 * If nobody else uses this page, and we don't already have a
 	 * temporary page, let's keep track of it as a one-deep
 	 * allocation cache. (Otherwise just release our reference to it)
+	 * Don't bother caching a stale order after a ring resize.
 	 */
-	if (page_count(page) == 1 && !pipe->tmp_page)
+	if (page_count(page) == 1 && !pipe->tmp_page &&
+	    compound_order(page) == pipe->buf_order)
 		pipe->tmp_page = page;
 	else
 		put_page(page);
@@ -133,7 +135,8 @@ static bool anon_pipe_buf_try_steal(struct pipe_inode_info *pipe,
 {
 	struct page *page = buf->page;
 
-	if (page_count(page) != 1)
+	/* stealing is for insertion into a pagecache, order 0 only */
+	if (page_count(page) != 1 || PageCompound(page))
 		return false;
 	memcg_kmem_uncharge_page(page, 0);
 	__SetPageLocked(page);
@@ -477,7 +480,7 @@ pipe_write(struct kiocb *iocb, struct iov_iter *from)
 		int offset = buf->offset + buf->len;
 
 		if ((buf->flags & PIPE_BUF_FLAG_CAN_MERGE) &&
-		    offset + chars <= PAGE_SIZE) {
+		    offset + chars <= page_size(buf->page)) {
 			ret = pipe_buf_confirm(pipe, buf);
 			if (ret)
 				goto out;
@@ -507,16 +510,24 @@ pipe_write(struct kiocb *iocb, struct iov_iter *from)
 			unsigned int mask = pipe->ring_size - 1;
 			struct pipe_buffer *buf;
 			struct page *page = pipe->tmp_page;
+			size_t buf_size;
 			int copied;
 
 			if (!page) {
-				page = alloc_page(GFP_HIGHUSER | __GFP_ACCOUNT);
+				page = alloc_pages(GFP_HIGHUSER | __GFP_ACCOUNT |
+						   __GFP_COMP | __GFP_NOWARN,
+						   pipe->buf_order);
+				/* an undersized buffer only costs capacity */
+				if (!page && pipe->buf_order)
+					page = alloc_page(GFP_HIGHUSER |
+							  __GFP_ACCOUNT);
 				if (unlikely(!page)) {
 					ret = ret ? : -ENOMEM;
 					break;
 				}
 				pipe->tmp_page = page;
 			}
+			buf_size = page_size(page);
 
 			/* Allocate a slot in the ring in advance and attach an
 			 * empty buffer.  If we fault or otherwise fail to use
@@ -537,8 +548,8 @@ pipe_write(struct kiocb *iocb, struct iov_iter *from)
 				buf->flags = PIPE_BUF_FLAG_CAN_MERGE;
 			pipe->tmp_page = NULL;
 
-			copied = copy_page_from_iter(page, 0, PAGE_SIZE, from);
-			if (unlikely(copied < PAGE_SIZE && iov_iter_count(from))) {
+			copied = copy_page_from_iter(page, 0, buf_size, from);
+			if (unlikely(copied < buf_size && iov_iter_count(from))) {
 				if (!ret)
 					ret = -EFAULT;
 				break;
@@ -857,7 +868,7 @@ void free_pipe_info(struct pipe_inode_info *pipe)
 		put_watch_queue(pipe->watch_queue);
 #endif
 	if (pipe->tmp_page)
-		__free_page(pipe->tmp_page);
+		put_page(pipe->tmp_page);
 	kfree(pipe->bufs);
 	kfree(pipe);
 }
@@ -1327,6 +1338,31 @@ int pipe_resize_ring(struct pipe_inode_info *pipe, unsigned int nr_slots)
 	return 0;
 }
 
+/*
+ * Pipes enlarged via F_SETPIPE_SZ get bigger buffers, so that pushing a
+ * given volume of data takes fewer buffer and wakeup operations.  Keep
+ * at least 64 slots in the ring so flow control stays reasonably
+ * granular, and cap buffers at order 4 (64K with 4K pages) so the
+ * allocations stay cheap and reliable.
+ */
+#define PIPE_BUF_MAX_ORDER	4
+
+static unsigned int pipe_buf_order(unsigned int size)
+{
+	unsigned int order = 0;
+
+	while (order < PIPE_BUF_MAX_ORDER &&
+	       (size >> (PAGE_SHIFT + order + 1)) >= 64)
+		order++;
+	return order;
+}
+
+/* Upper bound on the bytes the ring can hold */
+static unsigned int pipe_capacity(struct pipe_inode_info *pipe)
+{
+	return pipe->max_usage << (PAGE_SHIFT + pipe->buf_order);
+}
+
 /*
  * Allocate a new array of pipe buffers and copy the info over. Returns the
  * pipe size if successful, or return -ERROR on error.
@@ -1334,18 +1370,21 @@ int pipe_resize_ring(struct pipe_inode_info *pipe, unsigned int nr_slots)
 static long pipe_set_size(struct pipe_inode_info *pipe, unsigned int arg)
 {
 	unsigned long user_bufs;
-	unsigned int nr_slots, size;
+	unsigned int nr_pages, nr_slots, size, buf_order;
 	long ret = 0;
 
 	if (pipe_has_watch_queue(pipe))
 		return -EBUSY;
 
 	size = round_pipe_size(arg);
-	nr_slots = size >> PAGE_SHIFT;
+	nr_pages = size >> PAGE_SHIFT;
 
-	if (!nr_slots)
+	if (!nr_pages)
 		return -EINVAL;
 
+	buf_order = pipe_buf_order(size);
+	nr_slots = size >> (PAGE_SHIFT + buf_order);
+
 	/*
 	 * If trying to increase the pipe capacity, check that an
 	 * unprivileged user is not trying to exceed various limits
@@ -1353,13 +1392,13 @@ static long pipe_set_size(struct pipe_inode_info *pipe, unsigned int arg)
 	 * Decreasing the pipe capacity is always permitted, even
 	 * if the user is currently over a limit.
 	 */
-	if (nr_slots > pipe->max_usage &&
+	if (size > pipe_capacity(pipe) &&
 			size > pipe_max_size && !capable(CAP_SYS_RESOURCE))
 		return -EPERM;
 
-	user_bufs = account_pipe_buffers(pipe->user, pipe->nr_accounted, nr_slots);
+	user_bufs = account_pipe_buffers(pipe->user, pipe->nr_accounted, nr_pages);
 
-	if (nr_slots > pipe->max_usage &&
+	if (size > pipe_capacity(pipe) &&
 			(too_many_pipe_buffers_hard(user_bufs) ||
 			 too_many_pipe_buffers_soft(user_bufs)) &&
 			pipe_is_unprivileged_user()) {
@@ -1371,10 +1410,17 @@ static long pipe_set_size(struct pipe_inode_info *pipe, unsigned int arg)
 	if (ret < 0)
 		goto out_revert_acct;
 
-	return pipe->max_usage * PAGE_SIZE;
+	/*
+	 * Accounting is in pages, not ring slots; pipe_resize_ring()
+	 * assumed they are the same thing, correct it.
+	 */
+	pipe->buf_order = buf_order;
+	pipe->nr_accounted = nr_pages;
+
+	return pipe_capacity(pipe);
 
 out_revert_acct:
-	(void) account_pipe_buffers(pipe->user, nr_slots, pipe->nr_accounted);
+	(void) account_pipe_buffers(pipe->user, nr_pages, pipe->nr_accounted);
 	return ret;
 }
 
@@ -1409,7 +1455,7 @@ long pipe_fcntl(struct file *file, unsigned int cmd, unsigned int arg)
 		ret = pipe_set_size(pipe, arg);
 		break;
 	case F_GETPIPE_SZ:
-		ret = pipe->max_usage * PAGE_SIZE;
+		ret = pipe_capacity(pipe);
 		break;
 	default:
 		ret = -EINVAL;
@@ -489,6 +489,27 @@ static int proc_pid_schedstat(struct seq_file *m, struct pid_namespace *ns,
 }
 #endif
 
+#ifdef CONFIG_SYSCALL_LAT_HIST
+/*
+ * Provides /proc/PID/syscall_latency
+ *
+ * The histogram is updated locklessly by @task itself, so the values
+ * printed here may be torn; that is acceptable for a statistics file.
+ */
+static int proc_pid_syscall_lat(struct seq_file *m, struct pid_namespace *ns,
+				struct pid *pid, struct task_struct *task)
+{
+	const struct syscall_lat_hist *h = &task->syscall_lat;
+	int i;
+
+	seq_printf(m, "total %llu\n", READ_ONCE(h->nr_syscalls));
+	for (i = 0; i < SYSCALL_LAT_BUCKETS; i++)
+		seq_printf(m, "%u\n", READ_ONCE(h->buckets[i]));
+
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_LATENCYTOP
 static int lstats_show_proc(struct seq_file *m, void *v)
 {
@@ -1984,15 +2005,65 @@ int pid_getattr(struct mnt_idmap *idmap, const struct path *path,
 
 /* dentry stuff */
 
+static int task_dumpable(struct task_struct *task)
+{
+	int dumpable = SUID_DUMP_USER;
+	struct mm_struct *mm;
+
+	task_lock(task);
+	mm = task->mm;
+	if (mm)
+		dumpable = get_dumpable(mm);
+	task_unlock(task);
+
+	return dumpable;
+}
+
 /*
  * Set <pid>/... inode ownership (can change due to setuid(), etc.)
  */
 void pid_update_inode(struct task_struct *task, struct inode *inode)
 {
+	struct proc_inode *ei = PROC_I(inode);
+	const struct cred *cred;
+
 	task_dump_owner(task, inode->i_mode, &inode->i_uid, &inode->i_gid);
 
 	inode->i_mode &= ~(S_ISUID | S_ISGID);
 	security_task_to_inode(task, inode);
+
+	/*
+	 * Remember what the ownership was derived from, so that
+	 * pid_revalidate() can leave the inode untouched until the task
+	 * commits new creds or changes its dumpability.
+	 */
+	WRITE_ONCE(ei->pid_dumpable, task_dumpable(task));
+	cred = get_task_cred(task);
+	cred = xchg(&ei->pid_cred, cred);
+	if (cred)
+		put_cred(cred);
+}
+
+/*
+ * The inode only needs rewriting if the task committed new creds or
+ * changed its dumpability since pid_update_inode() last derived the
+ * ownership.  Monitoring loads stat the hot per-pid files continuously,
+ * so skipping the rewrite keeps the cached dentries and inodes clean
+ * instead of dirtying them on every sample.
+ */
+static bool pid_inode_needs_update(struct task_struct *task,
+				   struct inode *inode)
+{
+	struct proc_inode *ei = PROC_I(inode);
+
+	if (READ_ONCE(ei->pid_cred) != __task_cred(task))
+		return true;
+
+	/* The dump owner of world readable+executable dirs is the task. */
+	if (inode->i_mode == (S_IFDIR|S_IRUGO|S_IXUGO))
+		return false;
+
+	return READ_ONCE(ei->pid_dumpable) != task_dumpable(task);
 }
 
 /*
@@ -2013,7 +2084,8 @@ static int pid_revalidate(struct dentry *dentry, unsigned int flags)
 	task = pid_task(proc_pid(inode), PIDTYPE_PID);
 
 	if (task) {
-		pid_update_inode(task, inode);
+		if (pid_inode_needs_update(task, inode))
+			pid_update_inode(task, inode);
 		ret = 1;
 	}
 out:
@@ -3304,6 +3376,9 @@ static const struct pid_entry tgid_base_stuff[] = {
 #ifdef CONFIG_SCHED_INFO
 	ONE("schedstat",  S_IRUGO, proc_pid_schedstat),
 #endif
+#ifdef CONFIG_SYSCALL_LAT_HIST
+	ONE("syscall_latency", S_IRUGO, proc_pid_syscall_lat),
+#endif
 #ifdef CONFIG_LATENCYTOP
 	REG("latency",  S_IRUGO, proc_lstats_operations),
 #endif
@@ -3653,6 +3728,9 @@ static const struct pid_entry tid_base_stuff[] = {
 #ifdef CONFIG_SCHED_INFO
 	ONE("schedstat", S_IRUGO, proc_pid_schedstat),
 #endif
+#ifdef CONFIG_SYSCALL_LAT_HIST
+	ONE("syscall_latency", S_IRUGO, proc_pid_syscall_lat),
+#endif
 #ifdef CONFIG_LATENCYTOP
 	REG("latency",  S_IRUGO, proc_lstats_operations),
 #endif
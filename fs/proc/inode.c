@@ -59,6 +59,8 @@ static struct inode *proc_alloc_inode(struct super_block *sb)
 		return NULL;
 	ei->pid = NULL;
 	ei->fd = 0;
+	ei->pid_cred = NULL;
+	ei->pid_dumpable = 0;
 	ei->op.proc_get_link = NULL;
 	ei->pde = NULL;
 	ei->sysctl = NULL;
@@ -74,6 +76,8 @@ static void proc_free_inode(struct inode *inode)
 
 	if (ei->pid)
 		put_pid(ei->pid);
+	if (ei->pid_cred)
+		put_cred(ei->pid_cred);
 	/* Let go of any associated proc directory entry */
 	if (ei->pde)
 		pde_put(ei->pde);
@@ -599,6 +599,77 @@ out:
 	return orig_buflen - buflen;
 }
 
+/*
+ * Memory-scanning tools issue millions of small pread()s against the
+ * KCORE_RAM segments, where syscall overhead dwarfs the copy cost.  Let
+ * them map the directly-mapped RAM segments instead and do the scanning
+ * through the mapping.  Only read-only mappings of ranges that lie
+ * entirely within a single KCORE_RAM entry and pass the same exclusion
+ * checks as the read side are allowed; everything else (headers, notes,
+ * vmalloc, text) must still go through read().
+ */
+static int mmap_kcore(struct file *file, struct vm_area_struct *vma)
+{
+	size_t size = vma->vm_end - vma->vm_start;
+	size_t phdrs_len, notes_len, data_offset;
+	struct kcore_list *m = NULL, *iter;
+	unsigned long start, pfn, nr_pages, i;
+	loff_t pos = (loff_t)vma->vm_pgoff << PAGE_SHIFT;
+	int nphdr;
+	int ret = 0;
+
+	if (vma->vm_flags & (VM_WRITE | VM_EXEC))
+		return -EPERM;
+
+	vm_flags_clear(vma, VM_MAYWRITE | VM_MAYEXEC);
+
+	down_read(&kclist_lock);
+
+	get_kcore_size(&nphdr, &phdrs_len, &notes_len, &data_offset);
+	if (pos < data_offset) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/* The whole range must fall inside one KCORE_RAM entry. */
+	start = kc_offset_to_vaddr(pos - data_offset);
+	list_for_each_entry(iter, &kclist_head, list) {
+		if (start >= iter->addr &&
+		    start + size <= iter->addr + iter->size) {
+			m = iter;
+			break;
+		}
+	}
+	if (!m || m->type != KCORE_RAM) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	/*
+	 * Unlike the read side we cannot zero-fill excluded pages later,
+	 * so refuse the mapping up front if any page would be excluded.
+	 */
+	pfn = __pa(start) >> PAGE_SHIFT;
+	nr_pages = size >> PAGE_SHIFT;
+	for (i = 0; i < nr_pages; i++) {
+		struct page *page = pfn_to_online_page(pfn + i);
+
+		if (!page || PageOffline(page) ||
+		    is_page_hwpoison(page) || !pfn_is_ram(pfn + i) ||
+		    pfn_is_unaccepted_memory(pfn + i)) {
+			ret = -EPERM;
+			goto out;
+		}
+	}
+
+	if (remap_pfn_range(vma, vma->vm_start, pfn, size,
+			    vma->vm_page_prot))
+		ret = -EAGAIN;
+out:
+	up_read(&kclist_lock);
+	return ret;
+}
+
 static int open_kcore(struct inode *inode, struct file *filp)
 {
 	int ret = security_locked_down(LOCKDOWN_KCORE);
@@ -634,6 +705,7 @@ static const struct proc_ops kcore_proc_ops = {
 	.proc_open	= open_kcore,
 	.proc_release	= release_kcore,
 	.proc_lseek	= default_llseek,
+	.proc_mmap	= mmap_kcore,
 };
 
 /* just remember that we have to update kcore */
@@ -358,11 +358,20 @@ static int pid_maps_open(struct inode *inode, struct file *file)
 	return do_maps_open(inode, file, &proc_pid_maps_op);
 }
 
+#ifdef CONFIG_PROC_PAGE_MONITOR
+static long do_procmap_cmd(struct file *file, unsigned int cmd,
+			   unsigned long arg);
+#endif
+
 const struct file_operations proc_pid_maps_operations = {
 	.open		= pid_maps_open,
 	.read		= seq_read,
 	.llseek		= seq_lseek,
 	.release	= proc_map_release,
+#ifdef CONFIG_PROC_PAGE_MONITOR
+	.unlocked_ioctl	= do_procmap_cmd,
+	.compat_ioctl	= do_procmap_cmd,
+#endif
 };
 
 /*
@@ -810,6 +819,142 @@ static void smap_gather_stats(struct vm_area_struct *vma,
 		walk_page_range(vma->vm_mm, start, vma->vm_end, ops, mss);
 }
 
+/* Number of procmap entries gathered per mmap_lock acquisition. */
+#define PROCMAP_SCAN_BATCH	512
+
+static u64 procmap_scan_vma_flags(struct vm_area_struct *vma)
+{
+	u64 flags = 0;
+
+	if (vma->vm_flags & VM_READ)
+		flags |= PROCMAP_VMA_READABLE;
+	if (vma->vm_flags & VM_WRITE)
+		flags |= PROCMAP_VMA_WRITABLE;
+	if (vma->vm_flags & VM_EXEC)
+		flags |= PROCMAP_VMA_EXECUTABLE;
+	if (vma->vm_flags & VM_MAYSHARE)
+		flags |= PROCMAP_VMA_SHARED;
+
+	return flags;
+}
+
+static long do_procmap_scan(struct proc_maps_private *priv, unsigned long uargl)
+{
+	struct procmap_scan_arg __user *uarg = (void __user *)uargl;
+	struct procmap_scan_arg arg;
+	struct procmap_entry __user *uvec;
+	struct procmap_entry *kbuf, *ent;
+	struct mm_struct *mm = priv->mm;
+	struct vm_area_struct *vma;
+	struct vma_iterator vmi;
+	struct mem_size_stats mss;
+	unsigned long addr;
+	u64 walk_end, total = 0;
+	size_t nr, n;
+	long ret = 0;
+
+	if (copy_from_user(&arg, uarg, sizeof(arg)))
+		return -EFAULT;
+
+	if (arg.size != sizeof(struct procmap_scan_arg))
+		return -EINVAL;
+	if (arg.flags & ~PROCMAP_SCAN_STATS)
+		return -EINVAL;
+	if (!arg.vec || !arg.vec_len)
+		return -EINVAL;
+
+	uvec = (struct procmap_entry __user *)(long)arg.vec;
+	nr = min_t(u64, arg.vec_len, PROCMAP_SCAN_BATCH);
+	kbuf = kmalloc_array(nr, sizeof(*kbuf), GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
+
+	if (!mm || !mmget_not_zero(mm)) {
+		kfree(kbuf);
+		return -ESRCH;
+	}
+
+	addr = arg.start;
+	walk_end = arg.start;
+	while (total < arg.vec_len) {
+		nr = min_t(u64, arg.vec_len - total, PROCMAP_SCAN_BATCH);
+
+		ret = mmap_read_lock_killable(mm);
+		if (ret)
+			break;
+
+		vma_iter_init(&vmi, mm, addr);
+		for (n = 0; n < nr; n++) {
+			vma = vma_next(&vmi);
+			if (!vma)
+				break;
+
+			ent = &kbuf[n];
+			ent->start = vma->vm_start;
+			ent->end = vma->vm_end;
+			ent->pgoff = (u64)vma->vm_pgoff << PAGE_SHIFT;
+			ent->vma_flags = procmap_scan_vma_flags(vma);
+			ent->rss = 0;
+			ent->pss = 0;
+			if (arg.flags & PROCMAP_SCAN_STATS) {
+				memset(&mss, 0, sizeof(mss));
+				smap_gather_stats(vma, &mss, 0);
+				ent->rss = mss.resident;
+				ent->pss = mss.pss >> PSS_SHIFT;
+			}
+			addr = vma->vm_end;
+		}
+		mmap_read_unlock(mm);
+
+		if (n && copy_to_user(uvec + total, kbuf, n * sizeof(*kbuf))) {
+			ret = -EFAULT;
+			break;
+		}
+		total += n;
+		walk_end = addr;
+
+		/* Ran off the end of the address space? */
+		if (n < nr) {
+			walk_end = -1;
+			break;
+		}
+
+		if (fatal_signal_pending(current)) {
+			ret = -EINTR;
+			break;
+		}
+	}
+
+	mmput(mm);
+	kfree(kbuf);
+
+	if (ret == -EFAULT)
+		return ret;
+	/* An interrupted but non-empty scan can be resumed from walk_end. */
+	if (ret && !total)
+		return ret;
+
+	if (copy_to_user(&uarg->walk_end, &walk_end, sizeof(walk_end)))
+		return -EFAULT;
+
+	return total;
+}
+
+static long do_procmap_cmd(struct file *file, unsigned int cmd,
+			   unsigned long arg)
+{
+	struct seq_file *seq = file->private_data;
+	struct proc_maps_private *priv = seq->private;
+
+	switch (cmd) {
+	case PROCMAP_SCAN:
+		return do_procmap_scan(priv, arg);
+
+	default:
+		return -EINVAL;
+	}
+}
+
 #define SEQ_PUT_DEC(str, val) \
 		seq_put_decimal_ull_width(m, str, (val) >> 10, 8)
 
@@ -260,7 +260,7 @@ static LIST_HEAD(inuse_list);
 static LIST_HEAD(free_dquots);
 static LIST_HEAD(releasing_dquots);
 static unsigned int dq_hash_bits, dq_hash_mask;
-static struct hlist_head *dquot_hash;
+static struct hlist_bl_head *dquot_hash;
 
 struct dqstats dqstats;
 EXPORT_SYMBOL(dqstats);
@@ -284,26 +284,40 @@ hashfn(const struct super_block *sb, struct kqid qid)
 }
 
 /*
- * Following list functions expect dq_list_lock to be held
+ * The hash chains are protected by per-bucket bit locks so that lookups
+ * don't have to touch dq_list_lock; insertion and removal additionally
+ * happen under dq_list_lock (taken first) as they also manipulate the
+ * global lists.  The remaining list functions below expect dq_list_lock
+ * to be held.
  */
 static inline void insert_dquot_hash(struct dquot *dquot)
 {
-	struct hlist_head *head;
+	struct hlist_bl_head *head;
+
 	head = dquot_hash + hashfn(dquot->dq_sb, dquot->dq_id);
-	hlist_add_head(&dquot->dq_hash, head);
+	hlist_bl_lock(head);
+	hlist_bl_add_head(&dquot->dq_hash, head);
+	hlist_bl_unlock(head);
 }
 
 static inline void remove_dquot_hash(struct dquot *dquot)
 {
-	hlist_del_init(&dquot->dq_hash);
+	struct hlist_bl_head *head;
+
+	head = dquot_hash + hashfn(dquot->dq_sb, dquot->dq_id);
+	hlist_bl_lock(head);
+	hlist_bl_del_init(&dquot->dq_hash);
+	hlist_bl_unlock(head);
 }
 
+/* Call with the hash bucket locked */
 static struct dquot *find_dquot(unsigned int hashent, struct super_block *sb,
 				struct kqid qid)
 {
+	struct hlist_bl_node *node;
 	struct dquot *dquot;
 
-	hlist_for_each_entry(dquot, dquot_hash+hashent, dq_hash)
+	hlist_bl_for_each_entry(dquot, node, dquot_hash + hashent, dq_hash)
 		if (dquot->dq_sb == sb && qid_eq(dquot->dq_id, qid))
 			return dquot;
 
@@ -467,6 +481,9 @@ int dquot_acquire(struct dquot *dquot)
 	/* Make sure flags update is visible after dquot has been filled */
 	smp_mb__before_atomic();
 	set_bit(DQ_READ_B, &dquot->dq_flags);
+	spin_lock(&dquot->dq_dqb_lock);
+	dquot_update_fastpath(dquot);
+	spin_unlock(&dquot->dq_dqb_lock);
 	/* Instantiate dquot if needed */
 	if (!dquot_active(dquot) && !dquot->dq_off) {
 		ret = dqopt->ops[dquot->dq_id.type]->commit_dqblk(dquot);
@@ -508,6 +525,7 @@ int dquot_commit(struct dquot *dquot)
 	memalloc = memalloc_nofs_save();
 	if (!clear_dquot_dirty(dquot))
 		goto out_lock;
+	dquot_fold_space_delta(dquot);
 	/* Inactive dquot can be only if there was error during read/init
 	 * => we have better not writing it */
 	if (dquot_active(dquot))
@@ -535,6 +553,7 @@ int dquot_release(struct dquot *dquot)
 	/* Check whether we are not racing with some other dqget() */
 	if (dquot_is_busy(dquot))
 		goto out_dqlock;
+	dquot_fold_space_delta(dquot);
 	if (dqopt->ops[dquot->dq_id.type]->release_dqblk) {
 		ret = dqopt->ops[dquot->dq_id.type]->release_dqblk(dquot);
 		/* Write the info */
@@ -561,6 +580,7 @@ EXPORT_SYMBOL(dquot_destroy);
 
 static inline void do_destroy_dquot(struct dquot *dquot)
 {
+	percpu_counter_destroy(&dquot->dq_space_delta);
 	dquot->dq_sb->dq_op->destroy_dquot(dquot);
 }
 
@@ -865,9 +885,8 @@ void dqput(struct dquot *dquot)
 	dqstats_inc(DQST_DROPS);
 
 	spin_lock(&dq_list_lock);
-	if (atomic_read(&dquot->dq_count) > 1) {
+	if (!atomic_dec_and_test(&dquot->dq_count)) {
 		/* We have more than one user... nothing to do */
-		atomic_dec(&dquot->dq_count);
 		/* Releasing dquot during quotaoff phase? */
 		if (!sb_has_quota_active(dquot->dq_sb, dquot->dq_id.type) &&
 		    atomic_read(&dquot->dq_count) == 1)
@@ -876,10 +895,13 @@ void dqput(struct dquot *dquot)
 		return;
 	}
 
-	/* Need to release dquot? */
+	/*
+	 * Need to release dquot.  The count went to zero before the list
+	 * insertion, so the lockless dqget() fast path can no longer take
+	 * a reference and the release worker owns the dquot.
+	 */
 	WARN_ON_ONCE(!list_empty(&dquot->dq_free));
 	put_releasing_dquots(dquot);
-	atomic_dec(&dquot->dq_count);
 	spin_unlock(&dq_list_lock);
 	queue_delayed_work(system_unbound_wq, &quota_release_work, 1);
 }
@@ -899,10 +921,14 @@ static struct dquot *get_empty_dquot(struct super_block *sb, int type)
 	if(!dquot)
 		return NULL;
 
+	if (percpu_counter_init(&dquot->dq_space_delta, 0, GFP_NOFS)) {
+		sb->dq_op->destroy_dquot(dquot);
+		return NULL;
+	}
 	mutex_init(&dquot->dq_lock);
 	INIT_LIST_HEAD(&dquot->dq_free);
 	INIT_LIST_HEAD(&dquot->dq_inuse);
-	INIT_HLIST_NODE(&dquot->dq_hash);
+	INIT_HLIST_BL_NODE(&dquot->dq_hash);
 	INIT_LIST_HEAD(&dquot->dq_dirty);
 	dquot->dq_sb = sb;
 	dquot->dq_id = make_kqid_invalid(type);
@@ -930,6 +956,29 @@ struct dquot *dqget(struct super_block *sb, struct kqid qid)
 
         if (!sb_has_quota_active(sb, qid.type))
 		return ERR_PTR(-ESRCH);
+
+	/*
+	 * Fast path: look the dquot up under just its hash bucket lock and
+	 * grab a reference if it is already in use.  dqput() brings
+	 * dq_count to zero before putting the dquot on the releasing list,
+	 * so a successful increment from non-zero here cannot resurrect a
+	 * dquot behind the release worker's back; the zero case falls
+	 * through to the dq_list_lock slow path which resurrects properly.
+	 */
+	hlist_bl_lock(dquot_hash + hashent);
+	dquot = find_dquot(hashent, sb, qid);
+	if (dquot && atomic_add_unless(&dquot->dq_count, 1, 0)) {
+		hlist_bl_unlock(dquot_hash + hashent);
+		/* Raced with quotaoff? The reference keeps it valid. */
+		if (unlikely(!sb_has_quota_active(sb, qid.type))) {
+			dqput(dquot);
+			return ERR_PTR(-ESRCH);
+		}
+		dqstats_inc(DQST_CACHE_HITS);
+		dqstats_inc(DQST_LOOKUPS);
+		goto found;
+	}
+	hlist_bl_unlock(dquot_hash + hashent);
 we_slept:
 	spin_lock(&dq_list_lock);
 	spin_lock(&dq_state_lock);
@@ -941,7 +990,9 @@ we_slept:
 	}
 	spin_unlock(&dq_state_lock);
 
+	hlist_bl_lock(dquot_hash + hashent);
 	dquot = find_dquot(hashent, sb, qid);
+	hlist_bl_unlock(dquot_hash + hashent);
 	if (!dquot) {
 		if (!empty) {
 			spin_unlock(&dq_list_lock);
@@ -967,6 +1018,7 @@ we_slept:
 		dqstats_inc(DQST_CACHE_HITS);
 		dqstats_inc(DQST_LOOKUPS);
 	}
+found:
 	/* Wait for dq_lock - after this we know that either dquot_release() is
 	 * already finished or it will be canceled due to dq_count > 0 test */
 	wait_on_dquot(dquot);
@@ -987,7 +1039,7 @@ we_slept:
 	 */
 	smp_rmb();
 	/* Has somebody invalidated entry under us? */
-	WARN_ON_ONCE(hlist_unhashed(&dquot->dq_hash));
+	WARN_ON_ONCE(hlist_bl_unhashed(&dquot->dq_hash));
 out:
 	if (empty)
 		do_destroy_dquot(empty);
@@ -1333,6 +1385,97 @@ out:
 	return ret;
 }
 
+/*
+ * Per-CPU space accounting fast path
+ *
+ * When a dquot has no block limits, or its usage is far enough below them,
+ * allocations and frees are accumulated in a per-CPU delta instead of
+ * dqb_curspace and folded back under dq_dqb_lock once enough builds up or
+ * when someone needs exact numbers (commit, release, transfer, Q_GETQUOTA,
+ * Q_SETQUOTA).  dq_fastpath is maintained under dq_dqb_lock and requires
+ * several times more headroom below the nearest limit than the unfolded
+ * deltas can ever amount to, so no limit breach, warning or grace time can
+ * be missed while the fast path is engaged.  Filesystems with journaled
+ * quota commit every change through their own ->mark_dirty and never see
+ * the fast path.
+ */
+#define DQ_DELTA_BATCH		(1 << 20)
+
+static bool sb_dquot_fastpath(struct super_block *sb)
+{
+	return sb->dq_op->mark_dirty == dquot_mark_dquot_dirty;
+}
+
+static qsize_t dq_delta_slack(void)
+{
+	return 2 * (qsize_t)num_online_cpus() * DQ_DELTA_BATCH;
+}
+
+/* Recompute dq_fastpath.  Call with dq_dqb_lock held. */
+static void dquot_update_fastpath(struct dquot *dquot)
+{
+	struct mem_dqblk *dm = &dquot->dq_dqb;
+	qsize_t limit = dm->dqb_bsoftlimit;
+	bool fast = false;
+
+	if (sb_dquot_fastpath(dquot->dq_sb)) {
+		if (dm->dqb_bhardlimit &&
+		    (!limit || dm->dqb_bhardlimit < limit))
+			limit = dm->dqb_bhardlimit;
+		if (!sb_has_quota_limits_enabled(dquot->dq_sb,
+						 dquot->dq_id.type) ||
+		    test_bit(DQ_FAKE_B, &dquot->dq_flags) || !limit)
+			fast = true;
+		else
+			fast = dm->dqb_curspace + dm->dqb_rsvspace +
+			       4 * dq_delta_slack() < limit;
+	}
+	WRITE_ONCE(dquot->dq_fastpath, fast);
+}
+
+/* Fold the per-CPU deltas into dqb_curspace. */
+static void dquot_fold_space_delta(struct dquot *dquot)
+{
+	s64 delta;
+
+	if (!sb_dquot_fastpath(dquot->dq_sb))
+		return;
+	spin_lock(&dquot->dq_dqb_lock);
+	delta = percpu_counter_sum(&dquot->dq_space_delta);
+	if (delta) {
+		/*
+		 * Concurrent fast path updates may land on CPUs we already
+		 * summed; subtracting the snapshot leaves exactly those for
+		 * the next fold.
+		 */
+		percpu_counter_sub(&dquot->dq_space_delta, delta);
+		if (delta < 0 && dquot->dq_dqb.dqb_curspace < -delta)
+			dquot->dq_dqb.dqb_curspace = 0;
+		else
+			dquot->dq_dqb.dqb_curspace += delta;
+	}
+	dquot_update_fastpath(dquot);
+	spin_unlock(&dquot->dq_dqb_lock);
+}
+
+/*
+ * Try to account a space change without dq_dqb_lock.  Returns true if the
+ * change was absorbed by the per-CPU delta.
+ */
+static bool dquot_space_fastpath(struct dquot *dquot, s64 number)
+{
+	if (!READ_ONCE(dquot->dq_fastpath))
+		return false;
+	if (number > DQ_DELTA_BATCH || number < -DQ_DELTA_BATCH)
+		return false;
+	percpu_counter_add_batch(&dquot->dq_space_delta, number,
+				 DQ_DELTA_BATCH);
+	if (abs(percpu_counter_read(&dquot->dq_space_delta)) >
+	    dq_delta_slack())
+		dquot_fold_space_delta(dquot);
+	return true;
+}
+
 static int dquot_add_space(struct dquot *dquot, qsize_t space,
 			   qsize_t rsv_space, unsigned int flags,
 			   struct dquot_warn *warn)
@@ -1396,6 +1539,7 @@ finish:
 	if (!ret) {
 		dquot->dq_dqb.dqb_rsvspace += rsv_space;
 		dquot->dq_dqb.dqb_curspace += space;
+		dquot_update_fastpath(dquot);
 	}
 	spin_unlock(&dquot->dq_dqb_lock);
 	return ret;
@@ -1683,6 +1827,7 @@ int __dquot_alloc_space(struct inode *inode, qsize_t number, int flags)
 	int cnt, ret = 0, index;
 	struct dquot_warn warn[MAXQUOTAS];
 	int reserve = flags & DQUOT_SPACE_RESERVE;
+	unsigned int fast_done = 0;
 	struct dquot __rcu **dquots;
 	struct dquot *dquot;
 
@@ -1709,6 +1854,8 @@ int __dquot_alloc_space(struct inode *inode, qsize_t number, int flags)
 			continue;
 		if (reserve) {
 			ret = dquot_add_space(dquot, 0, number, flags, &warn[cnt]);
+		} else if (dquot_space_fastpath(dquot, number)) {
+			fast_done |= 1 << cnt;
 		} else {
 			ret = dquot_add_space(dquot, number, 0, flags, &warn[cnt]);
 		}
@@ -1718,6 +1865,12 @@ int __dquot_alloc_space(struct inode *inode, qsize_t number, int flags)
 				dquot = srcu_dereference(dquots[cnt], &dquot_srcu);
 				if (!dquot)
 					continue;
+				if (fast_done & (1 << cnt)) {
+					percpu_counter_sub(
+						&dquot->dq_space_delta,
+						number);
+					continue;
+				}
 				spin_lock(&dquot->dq_dqb_lock);
 				if (reserve)
 					dquot_free_reserved_space(dquot, number);
@@ -1909,6 +2062,8 @@ void __dquot_free_space(struct inode *inode, qsize_t number, int flags)
 		dquot = srcu_dereference(dquots[cnt], &dquot_srcu);
 		if (!dquot)
 			continue;
+		if (!reserve && dquot_space_fastpath(dquot, -(s64)number))
+			continue;
 		spin_lock(&dquot->dq_dqb_lock);
 		wtype = info_bdq_free(dquot, number);
 		if (wtype != QUOTA_NL_NOWARN)
@@ -2038,6 +2193,13 @@ int __dquot_transfer(struct inode *inode, struct dquot **transfer_to)
 		is_valid[cnt] = 1;
 		transfer_from[cnt] = srcu_dereference_check(dquots[cnt],
 				&dquot_srcu, lockdep_is_held(&dq_data_lock));
+		/*
+		 * Part of the source usage may still sit in its per-CPU
+		 * deltas; fold them so the decrement below can't underflow
+		 * dqb_curspace.
+		 */
+		if (transfer_from[cnt])
+			dquot_fold_space_delta(transfer_from[cnt]);
 		ret = dquot_add_inodes(transfer_to[cnt], inode_usage,
 				       &warn_to[cnt]);
 		if (ret)
@@ -2671,6 +2833,7 @@ static void do_get_dqblk(struct dquot *dquot, struct qc_dqblk *di)
 	struct mem_dqblk *dm = &dquot->dq_dqb;
 
 	memset(di, 0, sizeof(*di));
+	dquot_fold_space_delta(dquot);
 	spin_lock(&dquot->dq_dqb_lock);
 	di->d_spc_hardlimit = dm->dqb_bhardlimit;
 	di->d_spc_softlimit = dm->dqb_bsoftlimit;
@@ -2745,6 +2908,7 @@ static int do_set_dqblk(struct dquot *dquot, struct qc_dqblk *di)
 	     (di->d_ino_hardlimit > dqi->dqi_max_ino_limit)))
 		return -ERANGE;
 
+	dquot_fold_space_delta(dquot);
 	spin_lock(&dquot->dq_dqb_lock);
 	if (di->d_fieldmask & QC_SPACE) {
 		dm->dqb_curspace = di->d_space - dm->dqb_rsvspace;
@@ -2811,6 +2975,7 @@ static int do_set_dqblk(struct dquot *dquot, struct qc_dqblk *di)
 		clear_bit(DQ_FAKE_B, &dquot->dq_flags);
 	else
 		set_bit(DQ_FAKE_B, &dquot->dq_flags);
+	dquot_update_fastpath(dquot);
 	spin_unlock(&dquot->dq_dqb_lock);
 	ret = mark_dquot_dirty(dquot);
 	if (ret < 0)
@@ -3018,7 +3183,7 @@ static int __init dquot_init(void)
 			NULL);
 
 	order = 0;
-	dquot_hash = (struct hlist_head *)__get_free_pages(GFP_KERNEL, order);
+	dquot_hash = (struct hlist_bl_head *)__get_free_pages(GFP_KERNEL, order);
 	if (!dquot_hash)
 		panic("Cannot create dquot hash table");
 
@@ -3028,13 +3193,13 @@ static int __init dquot_init(void)
 		panic("Cannot create dquot stat counters");
 
 	/* Find power-of-two hlist_heads which can fit into allocation */
-	nr_hash = (1UL << order) * PAGE_SIZE / sizeof(struct hlist_head);
+	nr_hash = (1UL << order) * PAGE_SIZE / sizeof(struct hlist_bl_head);
 	dq_hash_bits = ilog2(nr_hash);
 
 	nr_hash = 1UL << dq_hash_bits;
 	dq_hash_mask = nr_hash - 1;
 	for (i = 0; i < nr_hash; i++)
-		INIT_HLIST_HEAD(dquot_hash + i);
+		INIT_HLIST_BL_HEAD(dquot_hash + i);
 
 	pr_info("VFS: Dquot-cache hash table entries: %ld (order %ld,"
 		" %ld bytes)\n", nr_hash, order, (PAGE_SIZE << order));
@@ -723,17 +723,44 @@ COMPAT_SYSCALL_DEFINE5(pwrite64, unsigned int, fd, const char __user *, buf,
 }
 #endif
 
+/*
+ * With RWF_DONTCACHE the data just transferred should not stick around in
+ * the page cache.  For reads, drop the pages behind the transfer now that
+ * userspace has its copy.  For writes, write the range through first so
+ * the pages are clean enough to invalidate.  Only pages wholly covered by
+ * the transfer are considered, and only clean, unmapped pages actually
+ * leave the cache, so pages someone else is using stay put.
+ */
+static void iocb_dontcache(struct kiocb *iocb, loff_t pos, size_t count,
+		int type)
+{
+	struct address_space *mapping = iocb->ki_filp->f_mapping;
+	pgoff_t start = DIV_ROUND_UP(pos, PAGE_SIZE);
+	pgoff_t end = (pos + count) >> PAGE_SHIFT;
+
+	if (iocb->ki_flags & IOCB_DIRECT)
+		return;
+	if (start >= end)
+		return;
+
+	if (type == WRITE)
+		filemap_write_and_wait_range(mapping, pos, pos + count - 1);
+	invalidate_mapping_pages(mapping, start, end - 1);
+}
+
 static ssize_t do_iter_readv_writev(struct file *filp, struct iov_iter *iter,
 		loff_t *ppos, int type, rwf_t flags)
 {
 	struct kiocb kiocb;
+	loff_t pos;
 	ssize_t ret;
 
 	init_sync_kiocb(&kiocb, filp);
 	ret = kiocb_set_rw_flags(&kiocb, flags);
 	if (ret)
 		return ret;
-	kiocb.ki_pos = (ppos ? *ppos : 0);
+	pos = (ppos ? *ppos : 0);
+	kiocb.ki_pos = pos;
 
 	if (type == READ)
 		ret = filp->f_op->read_iter(&kiocb, iter);
@@ -742,6 +769,8 @@ static ssize_t do_iter_readv_writev(struct file *filp, struct iov_iter *iter,
 	BUG_ON(ret == -EIOCBQUEUED);
 	if (ppos)
 		*ppos = kiocb.ki_pos;
+	if (ret > 0 && (kiocb.ki_flags & IOCB_DONTCACHE))
+		iocb_dontcache(&kiocb, pos, ret, type);
 	return ret;
 }
 
@@ -800,6 +829,8 @@ ssize_t vfs_iocb_iter_read(struct file *file, struct kiocb *iocb,
 		return ret;
 
 	ret = file->f_op->read_iter(iocb, iter);
+	if (ret > 0 && (iocb->ki_flags & IOCB_DONTCACHE))
+		iocb_dontcache(iocb, iocb->ki_pos - ret, ret, READ);
 out:
 	if (ret >= 0)
 		fsnotify_access(file);
@@ -863,8 +894,11 @@ ssize_t vfs_iocb_iter_write(struct file *file, struct kiocb *iocb,
 	ret = file->f_op->write_iter(iocb, iter);
 	if (ret != -EIOCBQUEUED)
 		kiocb_end_write(iocb);
-	if (ret > 0)
+	if (ret > 0) {
+		if (iocb->ki_flags & IOCB_DONTCACHE)
+			iocb_dontcache(iocb, iocb->ki_pos - ret, ret, WRITE);
 		fsnotify_modify(file);
+	}
 
 	return ret;
 }
@@ -391,10 +391,13 @@ efault:
 	return false;
 }
 
-SYSCALL_DEFINE3(getdents64, unsigned int, fd,
-		struct linux_dirent64 __user *, dirent, unsigned int, count)
+/*
+ * Fallback when the staging buffer cannot be allocated: the classic
+ * fill-the-user-buffer-in-place walk.
+ */
+static int getdents64_direct(struct file *file,
+		struct linux_dirent64 __user *dirent, unsigned int count)
 {
-	struct fd f;
 	struct getdents_callback64 buf = {
 		.ctx.actor = filldir64,
 		.count = count,
@@ -402,11 +405,7 @@ SYSCALL_DEFINE3(getdents64, unsigned int, fd,
 	};
 	int error;
 
-	f = fdget_pos(fd);
-	if (!f.file)
-		return -EBADF;
-
-	error = iterate_dir(f.file, &buf.ctx);
+	error = iterate_dir(file, &buf.ctx);
 	if (error >= 0)
 		error = buf.error;
 	if (buf.prev_reclen) {
@@ -419,6 +418,104 @@ SYSCALL_DEFINE3(getdents64, unsigned int, fd,
 		else
 			error = count - buf.count;
 	}
+	return error;
+}
+
+/*
+ * Stage dirents in a kernel buffer and copy them out in one go, instead
+ * of dribbling them into the user buffer entry by entry.  This keeps
+ * user access (and the page faults it can take) out of the pass that
+ * runs under the inode lock, and large directory scans do one bulk
+ * copy per syscall instead of two uaccess windows per entry.
+ */
+#define GETDENTS_STAGE_MAX	(64 << 10)
+
+struct getdents_stager64 {
+	struct dir_context ctx;
+	void *buf;
+	unsigned int size;
+	unsigned int used;
+	int prev_reclen;
+	int error;
+};
+
+static bool filldir64_stage(struct dir_context *ctx, const char *name,
+			    int namlen, loff_t offset, u64 ino,
+			    unsigned int d_type)
+{
+	struct getdents_stager64 *buf =
+		container_of(ctx, struct getdents_stager64, ctx);
+	struct linux_dirent64 *dirent, *prev;
+	int reclen = ALIGN(offsetof(struct linux_dirent64, d_name) + namlen + 1,
+		sizeof(u64));
+
+	buf->error = verify_dirent_name(name, namlen);
+	if (unlikely(buf->error))
+		return false;
+	buf->error = -EINVAL;	/* only used if we fail.. */
+	if (reclen > buf->size - buf->used)
+		return false;
+	if (buf->prev_reclen && signal_pending(current))
+		return false;
+
+	dirent = buf->buf + buf->used;
+	if (buf->prev_reclen) {
+		prev = (void *)dirent - buf->prev_reclen;
+		prev->d_off = offset;
+	}
+	dirent->d_ino = ino;
+	dirent->d_reclen = reclen;
+	dirent->d_type = d_type;
+	memcpy(dirent->d_name, name, namlen);
+	/* zero the terminator and the alignment padding */
+	memset(dirent->d_name + namlen, 0,
+	       reclen - offsetof(struct linux_dirent64, d_name) - namlen);
+
+	buf->prev_reclen = reclen;
+	buf->used += reclen;
+	return true;
+}
+
+SYSCALL_DEFINE3(getdents64, unsigned int, fd,
+		struct linux_dirent64 __user *, dirent, unsigned int, count)
+{
+	struct getdents_stager64 buf = {
+		.ctx.actor = filldir64_stage,
+	};
+	loff_t orig_pos;
+	struct fd f;
+	int error;
+
+	f = fdget_pos(fd);
+	if (!f.file)
+		return -EBADF;
+
+	buf.size = min_t(unsigned int, count, GETDENTS_STAGE_MAX);
+	buf.buf = kvmalloc(buf.size, GFP_KERNEL);
+	if (unlikely(!buf.buf)) {
+		error = getdents64_direct(f.file, dirent, count);
+		fdput_pos(f);
+		return error;
+	}
+
+	orig_pos = f.file->f_pos;
+	error = iterate_dir(f.file, &buf.ctx);
+	if (error >= 0)
+		error = buf.error;
+	if (buf.used) {
+		struct linux_dirent64 *lastdirent;
+
+		lastdirent = buf.buf + buf.used - buf.prev_reclen;
+		lastdirent->d_off = buf.ctx.pos;
+		if (copy_to_user(dirent, buf.buf, buf.used)) {
+			/* nothing was delivered, make it all re-readable */
+			f.file->f_pos = orig_pos;
+			error = -EFAULT;
+		} else {
+			error = buf.used;
+		}
+	}
+	kvfree(buf.buf);
 	fdput_pos(f);
 	return error;
 }
@@ -11,6 +11,7 @@
 #include <linux/cache.h>
 #include <linux/fs.h>
 #include <linux/export.h>
+#include <linux/log2.h>
 #include <linux/seq_file.h>
 #include <linux/vmalloc.h>
 #include <linux/slab.h>
@@ -38,6 +39,20 @@ static void *seq_buf_alloc(unsigned long size)
 	return kvmalloc(size, GFP_KERNEL_ACCOUNT);
 }
 
+/*
+ * Size of the first buffer allocation.  Honour the provider's size hint,
+ * if any, so that outputs known to exceed PAGE_SIZE render in a single
+ * pass instead of overflowing and being rendered again into a doubled
+ * buffer.
+ */
+static size_t seq_initial_size(struct seq_file *m)
+{
+	if (m->size_hint > PAGE_SIZE)
+		return min_t(size_t, roundup_pow_of_two(m->size_hint),
+			     MAX_RW_COUNT);
+	return PAGE_SIZE;
+}
+
 /**
  *	seq_open -	initialize sequential file
  *	@file: file we initialize
@@ -99,7 +114,7 @@ static int traverse(struct seq_file *m, loff_t offset)
 		return 0;
 
 	if (!m->buf) {
-		m->buf = seq_buf_alloc(m->size = PAGE_SIZE);
+		m->buf = seq_buf_alloc(m->size = seq_initial_size(m));
 		if (!m->buf)
 			return -ENOMEM;
 	}
@@ -207,7 +222,7 @@ ssize_t seq_read_iter(struct kiocb *iocb, struct iov_iter *iter)
 
 	/* grab buffer if we didn't have one */
 	if (!m->buf) {
-		m->buf = seq_buf_alloc(m->size = PAGE_SIZE);
+		m->buf = seq_buf_alloc(m->size = seq_initial_size(m));
 		if (!m->buf)
 			goto Enomem;
 	}
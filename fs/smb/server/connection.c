@@ -37,6 +37,8 @@ void ksmbd_conn_free(struct ksmbd_conn *conn)
 	up_write(&conn_list_lock);
 
 	xa_destroy(&conn->sessions);
+	if (conn->wq)
+		destroy_workqueue(conn->wq);
 	kvfree(conn->request_buf);
 	kfree(conn->preauth_info);
 	kfree(conn);
@@ -86,6 +88,14 @@ struct ksmbd_conn *ksmbd_conn_alloc(void)
 
 	init_rwsem(&conn->session_lock);
 
+	/*
+	 * Bound the number of workers a single connection can occupy so
+	 * that one client's request storm cannot head-of-line block the
+	 * other connections.  If allocation fails, requests fall back to
+	 * the shared ksmbd-io workqueue.
+	 */
+	conn->wq = alloc_workqueue("ksmbd-conn", 0, KSMBD_CONN_MAX_ACTIVE_WORKS);
+
 	down_write(&conn_list_lock);
 	list_add(&conn->conns_list, &conn_list);
 	up_write(&conn_list_lock);
@@ -37,6 +37,9 @@ struct ksmbd_stats {
 
 struct ksmbd_transport;
 
+/* Maximum number of in-flight works per connection */
+#define KSMBD_CONN_MAX_ACTIVE_WORKS	8
+
 struct ksmbd_conn {
 	struct smb_version_values	*vals;
 	struct smb_version_ops		*ops;
@@ -47,6 +50,8 @@ struct ksmbd_conn {
 	unsigned int			cli_cap;
 	char				*request_buf;
 	struct ksmbd_transport		*transport;
+	/* Bounded worker pool for this connection's requests */
+	struct workqueue_struct		*wq;
 	struct nls_table		*local_nls;
 	struct unicode_map		*um;
 	struct list_head		conns_list;
@@ -95,7 +95,9 @@ void ksmbd_workqueue_destroy(void)
 
 bool ksmbd_queue_work(struct ksmbd_work *work)
 {
-	return queue_work(ksmbd_wq, &work->work);
+	struct workqueue_struct *wq = work->conn->wq ?: ksmbd_wq;
+
+	return queue_work(wq, &work->work);
 }
 
 static inline void __ksmbd_iov_pin(struct ksmbd_work *work, void *ib,
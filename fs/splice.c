@@ -1658,6 +1658,158 @@ SYSCALL_DEFINE6(splice, int, fd_in, loff_t __user *, off_in,
 	return error;
 }
 
+/*
+ * Splice one input segment to @out, which is never a pipe here.  A pipe
+ * input takes the regular do_splice() route; anything else goes through
+ * do_splice_direct() and thus reuses the task's internal pipe, so the
+ * data of consecutive segments reaches the output as one stream.
+ *
+ * @opos is NULL when the caller gave no off_out, in which case the
+ * output position comes from (and updates) ->f_pos, same as splice(2).
+ */
+static ssize_t do_splice_seg(struct file *in, loff_t off_in,
+			     struct file *out, loff_t *opos,
+			     size_t len, unsigned int flags)
+{
+	loff_t pos, out_pos;
+	ssize_t ret;
+
+	if (!(in->f_mode & FMODE_READ))
+		return -EBADF;
+
+	if (get_pipe_info(in, true)) {
+		if (off_in != -1)
+			return -ESPIPE;
+		pipe_clear_nowait(in);
+		return do_splice(in, NULL, out, opos, len, flags);
+	}
+
+	if (off_in == -1) {
+		pos = in->f_pos;
+	} else {
+		if (!(in->f_mode & FMODE_PREAD))
+			return -EINVAL;
+		pos = off_in;
+	}
+	ret = rw_verify_area(READ, in, &pos, len);
+	if (unlikely(ret < 0))
+		return ret;
+
+	out_pos = opos ? *opos : out->f_pos;
+	ret = rw_verify_area(WRITE, out, &out_pos, len);
+	if (unlikely(ret < 0))
+		return ret;
+
+	ret = do_splice_direct(in, &pos, out, &out_pos, len, flags);
+	if (ret > 0) {
+		fsnotify_modify(out);
+		fsnotify_access(in);
+		if (off_in == -1)
+			in->f_pos = pos;
+		if (opos)
+			*opos = out_pos;
+		else
+			out->f_pos = out_pos;
+	}
+	return ret;
+}
+
+SYSCALL_DEFINE5(splicev, const struct splice_segment __user *, usegs,
+		unsigned int, nr_segs, int, fd_out,
+		loff_t __user *, off_out, unsigned int, flags)
+{
+	struct splice_segment segstack[UIO_FASTIOV];
+	struct splice_segment *segs = segstack;
+	loff_t opos, *__opos = NULL;
+	ssize_t total = 0, ret = 0;
+	unsigned int i;
+	struct fd out;
+
+	if (unlikely(flags & ~SPLICE_F_ALL))
+		return -EINVAL;
+	if (!nr_segs)
+		return 0;
+	if (nr_segs > UIO_MAXIOV)
+		return -EINVAL;
+
+	if (nr_segs > ARRAY_SIZE(segstack)) {
+		segs = memdup_array_user(usegs, nr_segs, sizeof(*segs));
+		if (IS_ERR(segs))
+			return PTR_ERR(segs);
+	} else if (copy_from_user(segs, usegs, nr_segs * sizeof(*segs))) {
+		return -EFAULT;
+	}
+
+	ret = -EBADF;
+	out = fdget(fd_out);
+	if (!out.file)
+		goto out_free;
+	if (!(out.file->f_mode & FMODE_WRITE))
+		goto out_fdput;
+	ret = -EINVAL;
+	if (unlikely(out.file->f_flags & O_APPEND))
+		goto out_fdput;
+	/* many inputs, one byte stream; a pipe output makes no sense here */
+	ret = -ESPIPE;
+	if (get_pipe_info(out.file, true))
+		goto out_fdput;
+
+	if (off_out) {
+		ret = -EINVAL;
+		if (!(out.file->f_mode & FMODE_PWRITE))
+			goto out_fdput;
+		ret = -EFAULT;
+		if (copy_from_user(&opos, off_out, sizeof(loff_t)))
+			goto out_fdput;
+		__opos = &opos;
+	}
+
+	for (i = 0; i < nr_segs; i++) {
+		struct splice_segment *seg = &segs[i];
+		unsigned int seg_flags = flags;
+		struct fd in;
+
+		if (seg->reserved) {
+			ret = -EINVAL;
+			break;
+		}
+		if (!seg->len)
+			continue;
+
+		/* keep the output side streaming until the last segment */
+		if (i != nr_segs - 1)
+			seg_flags |= SPLICE_F_MORE;
+
+		ret = -EBADF;
+		in = fdget(seg->fd);
+		if (!in.file)
+			break;
+		ret = do_splice_seg(in.file, seg->offset, out.file, __opos,
+				    seg->len, seg_flags);
+		fdput(in);
+		if (ret <= 0)
+			break;
+		total += ret;
+		/* a short segment stops the run, like a short write */
+		if ((size_t)ret < seg->len)
+			break;
+	}
+
+	if (__opos && total > 0 &&
+	    copy_to_user(off_out, &opos, sizeof(loff_t))) {
+		ret = -EFAULT;
+		total = 0;
+	}
+	if (total > 0)
+		ret = total;
+out_fdput:
+	fdput(out);
+out_free:
+	if (segs != segstack)
+		kfree(segs);
+	return ret;
+}
+
 /*
  * Make sure there's data to read. Wait for input if we can, otherwise
  * return an appropriate error.
@@ -19,6 +19,7 @@
 #include <linux/pagemap.h>
 #include <linux/compat.h>
 #include <linux/iversion.h>
+#include <linux/uio.h>
 
 #include <linux/uaccess.h>
 #include <asm/unistd.h>
@@ -712,6 +713,56 @@ SYSCALL_DEFINE5(statx,
 	return ret;
 }
 
+/**
+ * sys_statxv - System call to get enhanced stats for many files in one go
+ * @dfd: Base directory to pathwalk from for every entry.
+ * @vec: Array of pathname/result-buffer pairs.
+ * @nr: Number of entries in @vec.
+ * @flags: AT_* flags to control pathwalk, applied to every entry.
+ * @mask: Parts of statx struct actually required.
+ *
+ * Stats each entry in turn, so a tree-walk that has the names from
+ * getdents64 can fetch attributes for a whole batch with one syscall;
+ * with a warm dcache each entry is just a path walk and a stat.  Stops
+ * at the first entry that fails and returns the number of entries
+ * completed before it, so the caller can retry the failing entry alone
+ * to get its error.  A failure on the very first entry returns that
+ * error directly.
+ */
+SYSCALL_DEFINE5(statxv,
+		int, dfd, const struct statx_vec __user *, vec,
+		unsigned int, nr, unsigned int, flags,
+		unsigned int, mask)
+{
+	unsigned int i;
+	int ret = 0;
+
+	if (nr > UIO_MAXIOV)
+		return -EINVAL;
+
+	for (i = 0; i < nr; i++) {
+		struct statx_vec entry;
+		struct filename *name;
+
+		if (copy_from_user(&entry, &vec[i], sizeof(entry))) {
+			ret = -EFAULT;
+			break;
+		}
+
+		name = getname_flags(u64_to_user_ptr(entry.pathname),
+				     getname_statx_lookup_flags(flags), NULL);
+		ret = do_statx(dfd, name, flags, mask,
+			       u64_to_user_ptr(entry.buffer));
+		putname(name);
+		if (ret)
+			break;
+	}
+
+	if (i)
+		return i;
+	return ret;
+}
+
 #if defined(CONFIG_COMPAT) && defined(__ARCH_WANT_COMPAT_STAT)
 static int cp_compat_stat(struct kstat *stat, struct compat_stat __user *ubuf)
 {
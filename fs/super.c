@@ -35,6 +35,7 @@
 #include <linux/fsnotify.h>
 #include <linux/lockdep.h>
 #include <linux/user_namespace.h>
+#include <linux/workqueue.h>
 #include <linux/fs_context.h>
 #include <uapi/linux/mount.h>
 #include "internal.h"
@@ -174,6 +175,43 @@ static void super_wake(struct super_block *sb, unsigned int flag)
  * shrinker path and that leads to deadlock on the shrinker_mutex. Hence we
  * take a passive reference to the superblock to avoid this from occurring.
  */
+/*
+ * Shrinkers run one superblock at a time, so the duration of a single
+ * super_cache_scan() is the building block of direct reclaim latency on
+ * hosts with many mounts.  The dcache and icache walks of one scan need
+ * no ordering between them for correctness - concurrent scans of the
+ * same sb already interleave them freely under the shared s_umount - so
+ * for large scans the dcache prune is pushed to a reclaim-safe worker
+ * and runs alongside the icache prune.  The workqueue bounds how many
+ * such helpers run at once across all superblocks.
+ */
+static struct workqueue_struct *sb_shrink_wq;
+
+#define SB_SHRINK_ASYNC_THRESHOLD	1024
+
+struct super_shrink_work {
+	struct work_struct work;
+	struct super_block *sb;
+	struct shrink_control sc;
+	long freed;
+};
+
+static void super_shrink_dcache_workfn(struct work_struct *work)
+{
+	struct super_shrink_work *ssw =
+		container_of(work, struct super_shrink_work, work);
+
+	ssw->freed = prune_dcache_sb(ssw->sb, &ssw->sc);
+}
+
+static int __init sb_shrink_wq_init(void)
+{
+	sb_shrink_wq = alloc_workqueue("sb_shrink",
+				       WQ_UNBOUND | WQ_MEM_RECLAIM, 4);
+	return 0;
+}
+fs_initcall(sb_shrink_wq_init);
+
 static unsigned long super_cache_scan(struct shrinker *shrink,
 				      struct shrink_control *sc)
 {
@@ -217,10 +255,29 @@ static unsigned long super_cache_scan(struct shrinker *shrink,
 	 * Ensure that we always scan at least one object - memcg kmem
 	 * accounting uses this to fully empty the caches.
 	 */
-	sc->nr_to_scan = dentries + 1;
-	freed = prune_dcache_sb(sb, sc);
-	sc->nr_to_scan = inodes + 1;
-	freed += prune_icache_sb(sb, sc);
+	if (sb_shrink_wq && dentries > SB_SHRINK_ASYNC_THRESHOLD) {
+		struct super_shrink_work ssw = {
+			.sb	= sb,
+			.sc	= *sc,
+			.freed	= 0,
+		};
+
+		ssw.sc.nr_to_scan = dentries + 1;
+		INIT_WORK_ONSTACK(&ssw.work, super_shrink_dcache_workfn);
+		queue_work(sb_shrink_wq, &ssw.work);
+
+		sc->nr_to_scan = inodes + 1;
+		freed = prune_icache_sb(sb, sc);
+
+		flush_work(&ssw.work);
+		destroy_work_on_stack(&ssw.work);
+		freed += ssw.freed;
+	} else {
+		sc->nr_to_scan = dentries + 1;
+		freed = prune_dcache_sb(sb, sc);
+		sc->nr_to_scan = inodes + 1;
+		freed += prune_icache_sb(sb, sc);
+	}
 
 	if (fs_objects) {
 		sc->nr_to_scan = fs_objects + 1;
@@ -298,6 +355,7 @@ static void destroy_unused_super(struct super_block *s)
 	super_unlock_excl(s);
 	list_lru_destroy(&s->s_dentry_lru);
 	list_lru_destroy(&s->s_inode_lru);
+	percpu_counter_destroy(&s->s_nr_neg_dentry);
 	shrinker_free(s->s_shrink);
 	/* no delays needed */
 	destroy_super_work(&s->destroy_work);
@@ -389,6 +447,9 @@ static struct super_block *alloc_super(struct file_system_type *type, int flags,
 		goto fail;
 	if (list_lru_init_memcg(&s->s_inode_lru, s->s_shrink))
 		goto fail;
+	if (percpu_counter_init(&s->s_nr_neg_dentry, 0, GFP_KERNEL))
+		goto fail;
+	INIT_DELAYED_WORK(&s->s_neg_dentry_prune, sb_prune_neg_dentry);
 	return s;
 
 fail:
@@ -470,6 +531,11 @@ void deactivate_locked_super(struct super_block *s)
 	struct file_system_type *fs = s->s_type;
 	if (atomic_dec_and_test(&s->s_active)) {
 		shrinker_free(s->s_shrink);
+		/*
+		 * ->s_active is zero now, so the prune work cannot rearm
+		 * itself once this cancel has completed.
+		 */
+		cancel_delayed_work_sync(&s->s_neg_dentry_prune);
 		fs->kill_sb(s);
 
 		kill_super_notify(s);
@@ -481,6 +547,7 @@ void deactivate_locked_super(struct super_block *s)
 		 */
 		list_lru_destroy(&s->s_dentry_lru);
 		list_lru_destroy(&s->s_inode_lru);
+		percpu_counter_destroy(&s->s_nr_neg_dentry);
 
 		put_filesystem(fs);
 		put_super(s);
@@ -934,6 +1001,106 @@ void iterate_supers(void (*f)(struct super_block *, void *), void *arg)
 	spin_unlock(&sb_lock);
 }
 
+struct super_iter_ctl {
+	void (*f)(struct super_block *, void *);
+	void *arg;
+	atomic_t pending;
+	struct completion done;
+};
+
+struct super_iter_work {
+	struct work_struct work;
+	struct super_block *sb;
+	struct super_iter_ctl *ctl;
+};
+
+static void super_iter_one(struct super_block *sb, struct super_iter_ctl *ctl)
+{
+	bool locked;
+
+	locked = super_lock_shared(sb);
+	if (locked) {
+		if (sb->s_root)
+			ctl->f(sb, ctl->arg);
+		super_unlock_shared(sb);
+	}
+}
+
+static void super_iter_workfn(struct work_struct *work)
+{
+	struct super_iter_work *siw =
+		container_of(work, struct super_iter_work, work);
+	struct super_iter_ctl *ctl = siw->ctl;
+
+	super_iter_one(siw->sb, ctl);
+
+	spin_lock(&sb_lock);
+	__put_super(siw->sb);
+	spin_unlock(&sb_lock);
+	kfree(siw);
+
+	if (atomic_dec_and_test(&ctl->pending))
+		complete(&ctl->done);
+}
+
+/**
+ *	iterate_supers_async - call function for all active superblocks in parallel
+ *	@f: function to call
+ *	@arg: argument to pass to it
+ *
+ *	Like iterate_supers(), but runs the function for each superblock from
+ *	its own unbound work item and returns once all of them have finished,
+ *	so slow per-superblock work (sync, for instance) overlaps across
+ *	independent backing devices.  If a work item cannot be allocated the
+ *	superblock is handled inline instead.
+ */
+void iterate_supers_async(void (*f)(struct super_block *, void *), void *arg)
+{
+	struct super_iter_ctl ctl = {
+		.f	= f,
+		.arg	= arg,
+		.pending = ATOMIC_INIT(1),
+	};
+	struct super_block *sb, *p = NULL;
+
+	init_completion(&ctl.done);
+
+	spin_lock(&sb_lock);
+	list_for_each_entry(sb, &super_blocks, s_list) {
+		struct super_iter_work *siw;
+
+		sb->s_count++;
+		spin_unlock(&sb_lock);
+
+		siw = kmalloc(sizeof(*siw), GFP_KERNEL);
+		if (siw) {
+			/* the work item gets a reference of its own */
+			spin_lock(&sb_lock);
+			sb->s_count++;
+			spin_unlock(&sb_lock);
+
+			siw->sb = sb;
+			siw->ctl = &ctl;
+			atomic_inc(&ctl.pending);
+			INIT_WORK(&siw->work, super_iter_workfn);
+			queue_work(system_unbound_wq, &siw->work);
+		} else {
+			super_iter_one(sb, &ctl);
+		}
+
+		spin_lock(&sb_lock);
+		if (p)
+			__put_super(p);
+		p = sb;
+	}
+	if (p)
+		__put_super(p);
+	spin_unlock(&sb_lock);
+
+	if (!atomic_dec_and_test(&ctl.pending))
+		wait_for_completion(&ctl.done);
+}
+
 /**
  *	iterate_supers_type - call function for superblocks of given type
  *	@type: fs type
@@ -85,23 +85,35 @@ static void sync_fs_one_sb(struct super_block *sb, void *arg)
 }
 
 /*
- * Sync everything. We start by waking flusher threads so that most of
- * writeback runs on all devices in parallel. Then we sync all inodes reliably
- * which effectively also waits for all flusher threads to finish doing
- * writeback. At this point all data is on disk so metadata should be stable
- * and we tell filesystems to sync their metadata via ->sync_fs() calls.
- * Finally, we writeout all block devices because some filesystems (e.g. ext2)
- * just write metadata (such as inodes or bitmaps) to block device page cache
- * and do not sync it on their own in ->sync_fs().
+ * The full per-superblock sync sequence, run from one unbound worker per
+ * superblock so independent backing devices sync in parallel.  Collapsing
+ * the three global phases into per-sb order is fine: it is exactly what
+ * sync_filesystem() has always done for syncfs(2), and superblocks do not
+ * depend on each other's phases.
  */
-void ksys_sync(void)
+static void sync_one_sb(struct super_block *sb, void *arg)
 {
 	int nowait = 0, wait = 1;
 
+	sync_inodes_one_sb(sb, NULL);
+	sync_fs_one_sb(sb, &nowait);
+	sync_fs_one_sb(sb, &wait);
+}
+
+/*
+ * Sync everything. We start by waking flusher threads so that most of
+ * writeback runs on all devices in parallel. Then each superblock is synced
+ * from its own worker: inodes first, which effectively also waits for the
+ * flusher threads to finish writeback for that sb, at which point its data
+ * is on disk and metadata should be stable, then ->sync_fs() without and
+ * with wait. Finally, we writeout all block devices because some filesystems
+ * (e.g. ext2) just write metadata (such as inodes or bitmaps) to block
+ * device page cache and do not sync it on their own in ->sync_fs().
+ */
+void ksys_sync(void)
+{
 	wakeup_flusher_threads(WB_REASON_SYNC);
-	iterate_supers(sync_inodes_one_sb, NULL);
-	iterate_supers(sync_fs_one_sb, &nowait);
-	iterate_supers(sync_fs_one_sb, &wait);
+	iterate_supers_async(sync_one_sb, NULL);
 	sync_bdevs(false);
 	sync_bdevs(true);
 	if (unlikely(laptop_mode))
@@ -1748,6 +1748,120 @@ out:
 	return ret;
 }
 
+/* Ranges copied from userspace per chunk of a UFFDIO_COPYV. */
+#define UFFDIO_COPYV_BATCH	512
+
+/*
+ * Vectored flavour of UFFDIO_COPY: resolve an array of (dst, src, len)
+ * triples in one syscall so that postcopy-style workloads don't pay two
+ * syscalls per 4k page.  Semantics per range match UFFDIO_COPY; the
+ * ioctl stops at the first range that fails or copies short and reports
+ * the total bytes copied so userspace can resume from that point.
+ */
+static int userfaultfd_copyv(struct userfaultfd_ctx *ctx,
+			     unsigned long arg)
+{
+	struct uffdio_copyv uffdio_copyv;
+	struct uffdio_copyv __user *user_uffdio_copyv;
+	struct uffdio_copy_range __user *uranges;
+	struct uffdio_copy_range *ranges;
+	struct userfaultfd_wake_range range;
+	uffd_flags_t flags = 0;
+	__s64 total = 0;
+	__u64 done = 0;
+	__s64 ret;
+
+	user_uffdio_copyv = (struct uffdio_copyv __user *) arg;
+
+	ret = -EAGAIN;
+	if (atomic_read(&ctx->mmap_changing))
+		goto out;
+
+	ret = -EFAULT;
+	if (copy_from_user(&uffdio_copyv, user_uffdio_copyv,
+			   /* don't copy "copy" last field */
+			   sizeof(uffdio_copyv)-sizeof(__s64)))
+		goto out;
+
+	ret = -EINVAL;
+	if (!uffdio_copyv.count)
+		goto out;
+	if (uffdio_copyv.mode & ~(UFFDIO_COPY_MODE_DONTWAKE|UFFDIO_COPY_MODE_WP))
+		goto out;
+	if (uffdio_copyv.mode & UFFDIO_COPY_MODE_WP)
+		flags |= MFILL_ATOMIC_WP;
+
+	uranges = u64_to_user_ptr(uffdio_copyv.ranges);
+	ranges = kmalloc_array(min_t(__u64, uffdio_copyv.count,
+				     UFFDIO_COPYV_BATCH),
+			       sizeof(*ranges), GFP_KERNEL);
+	if (!ranges) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	if (!mmget_not_zero(ctx->mm)) {
+		ret = -ESRCH;
+		goto out_free;
+	}
+
+	ret = 0;
+	while (done < uffdio_copyv.count) {
+		__u64 nr = min_t(__u64, uffdio_copyv.count - done,
+				 UFFDIO_COPYV_BATCH);
+		__u64 i;
+
+		if (copy_from_user(ranges, uranges + done,
+				   nr * sizeof(*ranges))) {
+			ret = -EFAULT;
+			break;
+		}
+
+		for (i = 0; i < nr; i++) {
+			struct uffdio_copy_range *r = &ranges[i];
+
+			ret = validate_unaligned_range(ctx->mm, r->src,
+						       r->len);
+			if (ret)
+				goto out_mm;
+			ret = validate_range(ctx->mm, r->dst, r->len);
+			if (ret)
+				goto out_mm;
+
+			ret = mfill_atomic_copy(ctx, r->dst, r->src, r->len,
+						flags);
+			if (ret > 0) {
+				total += ret;
+				if (!(uffdio_copyv.mode &
+				      UFFDIO_COPY_MODE_DONTWAKE)) {
+					range.start = r->dst;
+					range.len = ret;
+					wake_userfault(ctx, &range);
+				}
+			}
+			if (ret < 0)
+				goto out_mm;
+			if (ret != r->len) {
+				ret = -EAGAIN;
+				goto out_mm;
+			}
+			ret = 0;
+
+			cond_resched();
+		}
+
+		done += nr;
+	}
+out_mm:
+	mmput(ctx->mm);
+out_free:
+	kfree(ranges);
+	if (unlikely(put_user(total, &user_uffdio_copyv->copy)))
+		ret = -EFAULT;
+out:
+	return ret;
+}
+
 static int userfaultfd_zeropage(struct userfaultfd_ctx *ctx,
 				unsigned long arg)
 {
@@ -2127,6 +2241,9 @@ static long userfaultfd_ioctl(struct file *file, unsigned cmd,
 	case UFFDIO_COPY:
 		ret = userfaultfd_copy(ctx, arg);
 		break;
+	case UFFDIO_COPYV:
+		ret = userfaultfd_copyv(ctx, arg);
+		break;
 	case UFFDIO_ZEROPAGE:
 		ret = userfaultfd_zeropage(ctx, arg);
 		break;
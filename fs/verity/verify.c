@@ -79,18 +79,24 @@ static bool is_hash_block_verified(struct fsverity_info *vi, struct page *hpage,
 }
 
 /*
- * Verify a single data block against the file's Merkle tree.
+ * Verify the path from the root of the Merkle tree down to the leaf-level hash
+ * block that covers the data block with index @hidx, and return the verified
+ * leaf hash block mapped via kmap_local.  On success the caller is responsible
+ * for kunmap_local() on the returned address and put_page() on *@hpage_ret.
  *
  * In principle, we need to verify the entire path to the root node.  However,
  * for efficiency the filesystem may cache the hash blocks.  Therefore we need
  * only ascend the tree until an already-verified hash block is seen, and then
  * verify the path to that block.
  *
- * Return: %true if the data block is valid, else %false.
+ * @data_pos is used only for error reporting.
+ *
+ * Return: the mapped address of the leaf hash block, or NULL on failure.
  */
-static bool
-verify_data_block(struct inode *inode, struct fsverity_info *vi,
-		  const void *data, u64 data_pos, unsigned long max_ra_pages)
+static const void *
+verify_hash_block_path(struct inode *inode, struct fsverity_info *vi,
+		       u64 data_pos, u64 hidx, unsigned long max_ra_pages,
+		       struct page **hpage_ret)
 {
 	const struct merkle_tree_params *params = &vi->tree_params;
 	const unsigned int hsize = params->digest_size;
@@ -109,32 +115,10 @@ verify_data_block(struct inode *inode, struct fsverity_info *vi,
 		/* Byte offset of the wanted hash relative to @addr */
 		unsigned int hoffset;
 	} hblocks[FS_VERITY_MAX_LEVELS];
-	/*
-	 * The index of the previous level's block within that level; also the
-	 * index of that block's hash within the current level.
-	 */
-	u64 hidx = data_pos >> params->log_blocksize;
 
 	/* Up to 1 + FS_VERITY_MAX_LEVELS pages may be mapped at once */
 	BUILD_BUG_ON(1 + FS_VERITY_MAX_LEVELS > KM_MAX_IDX);
 
-	if (unlikely(data_pos >= inode->i_size)) {
-		/*
-		 * This can happen in the data page spanning EOF when the Merkle
-		 * tree block size is less than the page size.  The Merkle tree
-		 * doesn't cover data blocks fully past EOF.  But the entire
-		 * page spanning EOF can be visible to userspace via a mmap, and
-		 * any part past EOF should be all zeroes.  Therefore, we need
-		 * to verify that any data blocks fully past EOF are all zeroes.
-		 */
-		if (memchr_inv(data, 0, params->block_size)) {
-			fsverity_err(inode,
-				     "FILE CORRUPTED!  Data past EOF is not zeroed");
-			return false;
-		}
-		return true;
-	}
-
 	/*
 	 * Starting at the leaf level, ascend the tree saving hash blocks along
 	 * the way until we find a hash block that has already been verified, or
@@ -180,6 +164,10 @@ verify_data_block(struct inode *inode, struct fsverity_info *vi,
 		}
 		haddr = kmap_local_page(hpage) + hblock_offset_in_page;
 		if (is_hash_block_verified(vi, hpage, hblock_idx)) {
+			if (level == 0) {
+				*hpage_ret = hpage;
+				return haddr;
+			}
 			memcpy(_want_hash, haddr + hoffset, hsize);
 			want_hash = _want_hash;
 			kunmap_local(haddr);
@@ -215,18 +203,20 @@ descend:
 			set_bit(hblock_idx, vi->hash_block_verified);
 		else
 			SetPageChecked(hpage);
+		if (level == 1) {
+			/* Keep the leaf hash block mapped for the caller. */
+			*hpage_ret = hpage;
+			return haddr;
+		}
 		memcpy(_want_hash, haddr + hoffset, hsize);
 		want_hash = _want_hash;
 		kunmap_local(haddr);
 		put_page(hpage);
 	}
 
-	/* Finally, verify the data block. */
-	if (fsverity_hash_block(params, inode, data, real_hash) != 0)
-		goto error;
-	if (memcmp(want_hash, real_hash, hsize) != 0)
-		goto corrupted;
-	return true;
+	/* A file this small has no hash blocks; the caller handles it. */
+	WARN_ON_ONCE(1);
+	return NULL;
 
 corrupted:
 	fsverity_err(inode,
@@ -239,7 +229,7 @@ error:
 		kunmap_local(hblocks[level - 1].addr);
 		put_page(hblocks[level - 1].page);
 	}
-	return false;
+	return NULL;
 }
 
 static bool
@@ -248,7 +238,9 @@ verify_data_blocks(struct folio *data_folio, size_t len, size_t offset,
 {
 	struct inode *inode = data_folio->mapping->host;
 	struct fsverity_info *vi = inode->i_verity_info;
-	const unsigned int block_size = vi->tree_params.block_size;
+	const struct merkle_tree_params *params = &vi->tree_params;
+	const unsigned int block_size = params->block_size;
+	const unsigned int hsize = params->digest_size;
 	u64 pos = (u64)data_folio->index << PAGE_SHIFT;
 
 	if (WARN_ON_ONCE(len <= 0 || !IS_ALIGNED(len | offset, block_size)))
@@ -257,17 +249,101 @@ verify_data_blocks(struct folio *data_folio, size_t len, size_t offset,
 			 folio_test_uptodate(data_folio)))
 		return false;
 	do {
-		void *data;
-		bool valid;
+		u64 data_pos = pos + offset;
+		u64 hidx = data_pos >> params->log_blocksize;
+		u64 run_end_hidx;
+		const void *leaf_addr = NULL;
+		struct page *leaf_page = NULL;
+		bool valid = true;
+
+		if (unlikely(data_pos >= inode->i_size)) {
+			/*
+			 * This can happen in the data page spanning EOF when
+			 * the Merkle tree block size is less than the page
+			 * size.  The Merkle tree doesn't cover data blocks
+			 * fully past EOF.  But the entire page spanning EOF can
+			 * be visible to userspace via a mmap, and any part past
+			 * EOF should be all zeroes.  Therefore, we need to
+			 * verify that any data blocks fully past EOF are all
+			 * zeroes.
+			 */
+			void *data = kmap_local_folio(data_folio, offset);
+
+			if (memchr_inv(data, 0, block_size)) {
+				fsverity_err(inode,
+					     "FILE CORRUPTED!  Data past EOF is not zeroed");
+				valid = false;
+			}
+			kunmap_local(data);
+			if (!valid)
+				return false;
+			offset += block_size;
+			len -= block_size;
+			continue;
+		}
+
+		/*
+		 * Verify the path to the leaf hash block covering this data
+		 * block once, then check every data block it covers (within
+		 * the requested range) against the single mapped copy.  This
+		 * amortizes the tree walk, the Merkle tree page cache lookups,
+		 * and the kmaps over up to hashes_per_block data blocks; only
+		 * one hash per data block remains.
+		 */
+		if (params->num_levels == 0) {
+			/* The file is covered by a lone data block. */
+			run_end_hidx = hidx + 1;
+		} else {
+			leaf_addr = verify_hash_block_path(inode, vi, data_pos,
+							   hidx, max_ra_pages,
+							   &leaf_page);
+			if (!leaf_addr)
+				return false;
+			run_end_hidx = round_up(hidx + 1,
+						1UL << params->log_arity);
+		}
+		do {
+			u8 real_hash[FS_VERITY_MAX_DIGEST_SIZE];
+			const u8 *want_hash;
+			void *data;
+			int err;
 
-		data = kmap_local_folio(data_folio, offset);
-		valid = verify_data_block(inode, vi, data, pos + offset,
-					  max_ra_pages);
-		kunmap_local(data);
+			if (leaf_addr)
+				want_hash = leaf_addr +
+					((hidx << params->log_digestsize) &
+					 (block_size - 1));
+			else
+				want_hash = vi->root_hash;
+			data = kmap_local_folio(data_folio, offset);
+			err = fsverity_hash_block(params, inode, data,
+						  real_hash);
+			kunmap_local(data);
+			if (err) {
+				valid = false;
+				break;
+			}
+			if (memcmp(want_hash, real_hash, hsize) != 0) {
+				fsverity_err(inode,
+					     "FILE CORRUPTED! pos=%llu, level=-1, want_hash=%s:%*phN, real_hash=%s:%*phN",
+					     pos + offset,
+					     params->hash_alg->name, hsize,
+					     want_hash,
+					     params->hash_alg->name, hsize,
+					     real_hash);
+				valid = false;
+				break;
+			}
+			offset += block_size;
+			len -= block_size;
+			hidx++;
+		} while (len && hidx < run_end_hidx &&
+			 pos + offset < inode->i_size);
+		if (leaf_addr) {
+			kunmap_local(leaf_addr);
+			put_page(leaf_page);
+		}
 		if (!valid)
 			return false;
-		offset += block_size;
-		len -= block_size;
 	} while (len);
 	return true;
 }
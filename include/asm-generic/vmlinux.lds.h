@@ -924,6 +924,8 @@
 
 #define INIT_CALLS_LEVEL(level)						\
 		__initcall##level##_start = .;				\
+		KEEP(*(.initcall##level##p.init))			\
+		__initcall##level##_par_end = .;			\
 		KEEP(*(.initcall##level##.init))			\
 		KEEP(*(.initcall##level##s.init))			\
 
@@ -265,4 +265,39 @@ static inline int crypto_acomp_decompress(struct acomp_req *req)
 	return crypto_acomp_reqtfm(req)->decompress(req);
 }
 
+/**
+ * crypto_acomp_batch_compress() -- Submit a batch of compress operations
+ *
+ * Function submits all requests of the set and reports completion of the
+ * whole set through the batch callback.  The per-request callbacks are
+ * replaced by the batch completion; request flags are left untouched, so
+ * requests with CRYPTO_TFM_REQ_MAY_BACKLOG set keep the engine queue fed
+ * instead of failing with -EBUSY.
+ *
+ * @batch:	batch descriptor set up with crypto_init_batch()
+ * @reqs:	array of asynchronous compress requests
+ * @nr:		number of requests in @reqs
+ *
+ * Return:	-EINPROGRESS; the result of the set is reported through the
+ *		batch callback, which may run before this function returns
+ *		if all requests completed synchronously
+ */
+int crypto_acomp_batch_compress(struct crypto_batch *batch,
+				struct acomp_req *reqs[], unsigned int nr);
+
+/**
+ * crypto_acomp_batch_decompress() -- Submit a batch of decompress operations
+ *
+ * Counterpart of crypto_acomp_batch_compress() for decompression.
+ *
+ * @batch:	batch descriptor set up with crypto_init_batch()
+ * @reqs:	array of asynchronous decompress requests
+ * @nr:		number of requests in @reqs
+ *
+ * Return:	-EINPROGRESS; the result of the set is reported through the
+ *		batch callback
+ */
+int crypto_acomp_batch_decompress(struct crypto_batch *batch,
+				  struct acomp_req *reqs[], unsigned int nr);
+
 #endif
@@ -467,6 +467,27 @@ int crypto_ahash_final(struct ahash_request *req);
  */
 int crypto_ahash_digest(struct ahash_request *req);
 
+/**
+ * crypto_ahash_batch_digest() - submit a batch of digest operations
+ * @batch: batch descriptor set up with crypto_init_batch()
+ * @reqs: array of ahash_request handles, each set up as for
+ *	  crypto_ahash_digest()
+ * @nr: number of requests in @reqs
+ *
+ * Submit all requests of the set and report completion of the whole set
+ * through the batch callback, amortizing the submission and completion
+ * overhead over the batch.  The per-request callbacks are replaced by the
+ * batch completion; request flags are left untouched, so requests with
+ * CRYPTO_TFM_REQ_MAY_BACKLOG set keep the engine queue fed instead of
+ * failing with -EBUSY.
+ *
+ * Return: -EINPROGRESS; the result of the set is reported through the
+ *	   batch callback, which may run before this function returns if
+ *	   all requests completed synchronously
+ */
+int crypto_ahash_batch_digest(struct crypto_batch *batch,
+			      struct ahash_request *reqs[], unsigned int nr);
+
 /**
  * crypto_ahash_export() - extract current message digest state
  * @req: reference to the ahash_request handle whose state is exported
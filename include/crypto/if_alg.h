@@ -38,6 +38,7 @@ struct af_alg_control {
 	struct af_alg_iv *iv;
 	int op;
 	unsigned int aead_assoclen;
+	bool vectored;
 };
 
 struct af_alg_type {
@@ -171,6 +172,8 @@ int af_alg_accept(struct sock *sk, struct socket *newsock,
 
 void af_alg_free_sg(struct af_alg_sgl *sgl);
 
+int af_alg_cmsg_send(struct msghdr *msg, struct af_alg_control *con);
+
 static inline struct alg_sock *alg_sk(struct sock *sk)
 {
 	return (struct alg_sock *)sk;
@@ -60,6 +60,22 @@ enum wb_reason {
 	WB_REASON_MAX,
 };
 
+/*
+ * Hard cap on concurrent flusher contexts per backing device; the actual
+ * count is controlled by the fs.writeback-flushers sysctl.
+ */
+#define WB_MAX_FLUSHERS		8
+
+/*
+ * A helper flusher context.  Helpers drain a wb's ->b_io alongside the
+ * main worker; only the root wb of a bdi uses them, cgroup wbs already
+ * run in parallel with each other.
+ */
+struct wb_flush_work {
+	struct work_struct work;
+	struct bdi_writeback *wb;
+};
+
 struct wb_completion {
 	atomic_t		cnt;
 	wait_queue_head_t	*waitq;
@@ -184,6 +200,8 @@ struct backing_dev_info {
 	unsigned long last_bdp_sleep;
 
 	struct bdi_writeback wb;  /* the root writeback info for this bdi */
+	bool flush_works_init;	  /* helper contexts set up, see wb_workfn() */
+	struct wb_flush_work flush_works[WB_MAX_FLUSHERS - 1];
 	struct list_head wb_list; /* list of all wbs */
 #ifdef CONFIG_CGROUP_WRITEBACK
 	struct radix_tree_root cgwb_tree; /* radix tree of active cgroup wbs */
@@ -6,6 +6,7 @@
 #include <linux/completion.h>
 #include <linux/kref.h>
 #include <linux/mempool.h>
+#include <linux/percpu_counter.h>
 #include <linux/rbtree.h>
 #include <linux/refcount.h>
 #include <linux/ktime.h>
@@ -418,7 +419,7 @@ struct ceph_osd_client {
 	struct rb_root         linger_requests; /* lingering requests */
 	struct rb_root         map_checks;
 	struct rb_root         linger_map_checks;
-	atomic_t               num_requests;
+	struct percpu_counter  num_requests;
 	atomic_t               num_homeless;
 	int                    abort_err;
 	struct delayed_work    timeout_work;
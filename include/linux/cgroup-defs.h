@@ -506,10 +506,14 @@ struct cgroup {
 	/*
 	 * A singly-linked list of cgroup structures to be rstat flushed.
 	 * This is a scratch field to be used exclusively by
-	 * cgroup_rstat_flush_locked() and protected by cgroup_rstat_lock.
+	 * cgroup_rstat_flush_locked() and protected by the rstat lock
+	 * shard covering this cgroup.
 	 */
 	struct cgroup	*rstat_flush_next;
 
+	/* jiffies at the last completed rstat flush of this subtree */
+	unsigned long rstat_last_flush;
+
 	/* cgroup basic resource statistics */
 	struct cgroup_base_stat last_bstat;
 	struct cgroup_base_stat bstat;
@@ -408,6 +408,31 @@ static inline void crypto_init_wait(struct crypto_wait *wait)
 	init_completion(&wait->completion);
 }
 
+/*
+ * A helper struct for batch submission of async crypto requests.  The
+ * batch completion callback is invoked exactly once, when the last
+ * request of the set has finished, with the first error encountered
+ * (or zero if all requests succeeded).
+ */
+struct crypto_batch {
+	atomic_t pending;
+	atomic_t err;
+	crypto_completion_t complete;
+	void *data;
+};
+
+void crypto_batch_done(void *data, int err);
+
+static inline void crypto_init_batch(struct crypto_batch *batch,
+				     crypto_completion_t complete, void *data)
+{
+	/* submission reference, dropped once all requests are queued */
+	atomic_set(&batch->pending, 1);
+	atomic_set(&batch->err, 0);
+	batch->complete = complete;
+	batch->data = data;
+}
+
 /*
  * Algorithm query interface.
  */
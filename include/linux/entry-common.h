@@ -3,6 +3,7 @@
 #define __LINUX_ENTRYCOMMON_H
 
 #include <linux/static_call_types.h>
+#include <linux/jump_label.h>
 #include <linux/ptrace.h>
 #include <linux/syscalls.h>
 #include <linux/seccomp.h>
@@ -137,6 +138,32 @@ void syscall_enter_from_user_mode_prepare(struct pt_regs *regs);
 long syscall_trace_enter(struct pt_regs *regs, long syscall,
 			 unsigned long work);
 
+#ifdef CONFIG_SYSCALL_LAT_HIST
+DECLARE_STATIC_KEY_FALSE(syscall_lat_hist_key);
+
+void __syscall_lat_hist_enter(void);
+void __syscall_lat_hist_exit(void);
+
+/*
+ * Per-task syscall latency accounting.  Patched out entirely unless the
+ * kernel.syscall_lat_hist sysctl has enabled the static key.
+ */
+static __always_inline void syscall_lat_hist_enter(void)
+{
+	if (static_branch_unlikely(&syscall_lat_hist_key))
+		__syscall_lat_hist_enter();
+}
+
+static __always_inline void syscall_lat_hist_exit(void)
+{
+	if (static_branch_unlikely(&syscall_lat_hist_key))
+		__syscall_lat_hist_exit();
+}
+#else
+static __always_inline void syscall_lat_hist_enter(void) { }
+static __always_inline void syscall_lat_hist_exit(void) { }
+#endif
+
 /**
  * syscall_enter_from_user_mode_work - Check and handle work before invoking
  *				       a syscall
@@ -164,6 +191,8 @@ static __always_inline long syscall_enter_from_user_mode_work(struct pt_regs *re
 {
 	unsigned long work = READ_ONCE(current_thread_info()->syscall_work);
 
+	syscall_lat_hist_enter();
+
 	if (work & SYSCALL_WORK_ENTER)
 		syscall = syscall_trace_enter(regs, syscall, work);
 
@@ -36,6 +36,20 @@ struct fdtable {
 /*
  * Open file table structure
  */
+/*
+ * Per-CPU cache of released fd slots, optionally hanging off a
+ * files_struct (see the fs.fd-cache sysctl).  A cached slot stays
+ * claimed in ->open_fds with a NULL file pointer, so the rest of the
+ * code treats it like an open() that has not reached fd_install() yet.
+ */
+#define FD_CACHE_NR	8
+
+struct fd_cache {
+	spinlock_t lock;
+	unsigned int count;
+	unsigned int fds[FD_CACHE_NR];
+};
+
 struct files_struct {
   /*
    * read mostly part
@@ -43,6 +57,7 @@ struct files_struct {
 	atomic_t count;
 	bool resize_in_progress;
 	wait_queue_head_t resize_wait;
+	struct fd_cache __percpu *fd_cache;
 
 	struct fdtable __rcu *fdt;
 	struct fdtable fdtab;
@@ -107,5 +107,6 @@ extern void flush_delayed_fput(void);
 extern void __fput_sync(struct file *);
 
 extern unsigned int sysctl_nr_open_min, sysctl_nr_open_max;
+extern unsigned int sysctl_fd_cache;
 
 #endif /* __LINUX_FILE_H */
@@ -111,6 +111,7 @@ struct file_lock_core {
 
 struct file_lock {
 	struct file_lock_core c;
+	struct rcu_head fl_rcu;		/* delays freeing for lockless readers */
 	loff_t fl_start;
 	loff_t fl_end;
 
@@ -141,6 +142,11 @@ struct file_lease {
 
 struct file_lock_context {
 	spinlock_t		flc_lock;
+	/*
+	 * Bumped around every update of ->flc_posix, so that
+	 * posix_test_lock() can walk the list without the lock.
+	 */
+	seqcount_spinlock_t	flc_seq;
 	struct list_head	flc_flock;
 	struct list_head	flc_posix;
 	struct list_head	flc_lease;
@@ -18,6 +18,7 @@
 #include <linux/list.h>
 #include <linux/percpu-defs.h>
 #include <linux/rbtree.h>
+#include <linux/spinlock.h>
 #include <linux/timer.h>
 
 /*
@@ -278,6 +279,39 @@ static inline void hrtimer_start(struct hrtimer *timer, ktime_t tim,
 extern int hrtimer_cancel(struct hrtimer *timer);
 extern int hrtimer_try_to_cancel(struct hrtimer *timer);
 
+/**
+ * struct hrtimer_group - coalescing group for slack-tolerant timers
+ * @lock:	serializes updates of @anchor
+ * @anchor:	current shared absolute expiry point of the group
+ *
+ * Timers started through hrtimer_group_start() whose slack windows
+ * overlap the group's anchor are all programmed to expire exactly at
+ * the anchor, so an arbitrary number of them is served by a single
+ * timer interrupt.  All members of a group must run on the same clock.
+ */
+struct hrtimer_group {
+	spinlock_t	lock;
+	ktime_t		anchor;
+};
+
+#define __HRTIMER_GROUP_INITIALIZER(name) {				\
+	.lock = __SPIN_LOCK_UNLOCKED(name.lock),			\
+	.anchor = 0,							\
+}
+
+#define DEFINE_HRTIMER_GROUP(name)					\
+	struct hrtimer_group name = __HRTIMER_GROUP_INITIALIZER(name)
+
+static inline void hrtimer_group_init(struct hrtimer_group *group)
+{
+	spin_lock_init(&group->lock);
+	group->anchor = 0;
+}
+
+extern void hrtimer_group_start(struct hrtimer_group *group,
+				struct hrtimer *timer, ktime_t tim,
+				u64 slack_ns, const enum hrtimer_mode mode);
+
 static inline void hrtimer_start_expires(struct hrtimer *timer,
 					 enum hrtimer_mode mode)
 {
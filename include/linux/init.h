@@ -164,6 +164,14 @@ extern initcall_entry_t __initcall4_start[];
 extern initcall_entry_t __initcall5_start[];
 extern initcall_entry_t __initcall6_start[];
 extern initcall_entry_t __initcall7_start[];
+extern initcall_entry_t __initcall0_par_end[];
+extern initcall_entry_t __initcall1_par_end[];
+extern initcall_entry_t __initcall2_par_end[];
+extern initcall_entry_t __initcall3_par_end[];
+extern initcall_entry_t __initcall4_par_end[];
+extern initcall_entry_t __initcall5_par_end[];
+extern initcall_entry_t __initcall6_par_end[];
+extern initcall_entry_t __initcall7_par_end[];
 extern initcall_entry_t __initcall_end[];
 
 extern struct file_system_type rootfs_fs_type;
@@ -313,6 +321,21 @@ extern struct module __this_module;
 #define late_initcall(fn)		__define_initcall(fn, 7)
 #define late_initcall_sync(fn)		__define_initcall(fn, 7s)
 
+/*
+ * The _par variants declare that the initcall has no ordering dependency
+ * on any other initcall of its level. Such calls may be run concurrently
+ * with each other and with the serial calls of the level, but are
+ * guaranteed to have completed before the next level starts. Unannotated
+ * initcalls keep their serial, link-order semantics.
+ */
+#define core_initcall_par(fn)		__define_initcall(fn, 1p)
+#define postcore_initcall_par(fn)	__define_initcall(fn, 2p)
+#define arch_initcall_par(fn)		__define_initcall(fn, 3p)
+#define subsys_initcall_par(fn)		__define_initcall(fn, 4p)
+#define fs_initcall_par(fn)		__define_initcall(fn, 5p)
+#define device_initcall_par(fn)		__define_initcall(fn, 6p)
+#define late_initcall_par(fn)		__define_initcall(fn, 7p)
+
 #define __initcall(fn) device_initcall(fn)
 
 #define __exitcall(fn)						\
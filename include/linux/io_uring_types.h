@@ -39,6 +39,8 @@ enum io_uring_cmd_flags {
 	IO_URING_F_COMPAT		= (1 << 12),
 };
 
+struct io_opstat;
+
 struct io_wq_work_node {
 	struct io_wq_work_node *next;
 };
@@ -410,8 +412,16 @@ struct io_ring_ctx {
 	struct list_head	napi_list;	/* track busy poll napi_id */
 	spinlock_t		napi_lock;	/* napi_list lock */
 
+	/* optional per-opcode latency stats, see opstat.c */
+	struct io_opstat __percpu	*opstat;
+	bool			opstat_enabled;
+
 	/* napi busy poll default timeout */
 	unsigned int		napi_busy_poll_to;
+	/* current adaptive poll budget, never above napi_busy_poll_to */
+	unsigned int		napi_cur_busy_poll_to;
+	/* busy loops that timed out without any completion arriving */
+	unsigned int		napi_poll_misses;
 	bool			napi_prefer_busy_poll;
 	bool			napi_enabled;
 
@@ -662,6 +672,9 @@ struct io_kiocb {
 	const struct cred		*creds;
 	struct io_wq_work		work;
 
+	/* submission timestamp, only set while per-opcode stats are enabled */
+	u64				opstat_ts;
+
 	struct {
 		u64			extra1;
 		u64			extra2;
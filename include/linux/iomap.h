@@ -393,9 +393,23 @@ struct iomap_dio_ops {
  */
 #define IOMAP_DIO_PARTIAL		(1 << 2)
 
+/*
+ * A single segment of a batched direct I/O request.  The segments of a batch
+ * all target the file behind the issuing kiocb, must be sorted by ascending
+ * @pos and must not overlap.
+ */
+struct iomap_dio_seg {
+	loff_t			pos;
+	struct iov_iter		*iter;
+};
+
 ssize_t iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
 		unsigned int dio_flags, void *private, size_t done_before);
+ssize_t iomap_dio_rw_batch(struct kiocb *iocb, struct iomap_dio_seg *segs,
+		unsigned int nr_segs, const struct iomap_ops *ops,
+		const struct iomap_dio_ops *dops, unsigned int dio_flags,
+		void *private);
 struct iomap_dio *__iomap_dio_rw(struct kiocb *iocb, struct iov_iter *iter,
 		const struct iomap_ops *ops, const struct iomap_dio_ops *dops,
 		unsigned int dio_flags, void *private, size_t done_before);
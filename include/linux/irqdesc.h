@@ -45,6 +45,8 @@ struct irqstat {
  * @irqs_unhandled:	stats field for spurious unhandled interrupts
  * @threads_handled:	stats field for deferred spurious detection of threaded handlers
  * @threads_handled_last: comparator field for deferred spurious detection of threaded handlers
+ * @steer_time:		accumulated handler runtime, for interrupt steering
+ * @steer_time_ref:	snapshot of @steer_time at the last steering scan
  * @lock:		locking for SMP
  * @affinity_hint:	hint to user space for preferred irq affinity
  * @affinity_notify:	context for notification of affinity changes
@@ -80,6 +82,10 @@ struct irq_desc {
 	unsigned int		irqs_unhandled;
 	atomic_t		threads_handled;
 	int			threads_handled_last;
+#ifdef CONFIG_IRQ_STEERING
+	u64			steer_time;
+	u64			steer_time_ref;
+#endif
 	raw_spinlock_t		lock;
 	struct cpumask		*percpu_enabled;
 	const struct cpumask	*percpu_affinity;
@@ -743,6 +743,17 @@ enum passtype {PASS_SCAN, PASS_REVOKE, PASS_REPLAY};
 #define JBD2_FC_REPLAY_STOP	0
 #define JBD2_FC_REPLAY_CONTINUE	1
 
+/*
+ * Per-CPU cache of transaction credits. The credits are counted in the
+ * owning transaction's t_outstanding_credits already; the cache only tracks
+ * how many of them this CPU may hand to new handles without touching the
+ * shared counter. Each entry is written exclusively by its own CPU.
+ */
+struct jbd2_pcp_credits {
+	tid_t		tid;
+	int		credits;
+};
+
 /**
  * struct journal_s - The journal_s type is the concrete type associated with
  *     journal_t.
@@ -1120,6 +1131,16 @@ struct journal_s
 	 */
 	struct buffer_head	**j_wbuf;
 
+	/**
+	 * @j_pcp_credits:
+	 *
+	 * Per-CPU caches of credits already charged to the running
+	 * transaction, so that most handles can start and stop without
+	 * touching t_outstanding_credits. Stays empty on journals too
+	 * small to afford the batches.
+	 */
+	struct jbd2_pcp_credits __percpu *j_pcp_credits;
+
 	/**
 	 * @j_fc_wbuf: Array of fast commit bhs for fast commit. Accessed only
 	 * during a fast commit. Currently only process can do fast commit, so
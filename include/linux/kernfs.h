@@ -114,6 +114,7 @@ enum kernfs_node_flag {
 	KERNFS_EMPTY_DIR	= 0x1000,
 	KERNFS_HAS_RELEASE	= 0x2000,
 	KERNFS_REMOVING		= 0x4000,
+	KERNFS_HAS_READ_LOCKLESS = 0x8000,
 };
 
 /* @flags for kernfs_create_root() */
@@ -296,6 +297,20 @@ struct kernfs_ops {
 	ssize_t (*read)(struct kernfs_open_file *of, char *buf, size_t bytes,
 			loff_t off);
 
+	/*
+	 * read_lockless() is an opt-in fast path for simple scalar
+	 * attributes that are sampled at high frequency.  It formats at
+	 * most @bytes of the attribute value into @buf and returns the
+	 * formatted length.  Unlike the paths above it is invoked without
+	 * @of->mutex and without the seq_file machinery, so it may run
+	 * concurrently for the same open file and must provide its own
+	 * consistency (e.g. a seqcount retry loop around snapshotting the
+	 * value).  When implemented it takes precedence over seq_show()
+	 * and read() for regular reads.
+	 */
+	ssize_t (*read_lockless)(struct kernfs_open_file *of, char *buf,
+				 size_t bytes);
+
 	/*
 	 * write() is bounced through kernel buffer.  If atomic_write_len
 	 * is not set, a write larger than PAGE_SIZE results in partial
@@ -33,6 +33,7 @@
 #include <linux/hashtable.h>
 #include <linux/instrumentation.h>
 #include <linux/interval_tree.h>
+#include <linux/timekeeping.h>
 #include <linux/rbtree.h>
 #include <linux/xarray.h>
 #include <asm/signal.h>
@@ -346,6 +347,8 @@ struct kvm_vcpu {
 	int sigset_active;
 	sigset_t sigset;
 	unsigned int halt_poll_ns;
+	u64 halt_ewma_ns;
+	u64 last_exit_ns;
 	bool valid_wakeup;
 
 #ifdef CONFIG_HAS_IOMEM
@@ -356,6 +359,10 @@ struct kvm_vcpu {
 	int mmio_nr_fragments;
 	struct kvm_mmio_fragment mmio_fragments[KVM_MAX_MMIO_FRAGMENTS];
 #endif
+#ifdef CONFIG_KVM_MMIO
+	/* Private ring when KVM_CAP_COALESCED_MMIO_PER_VCPU is enabled */
+	struct kvm_coalesced_mmio_ring *coalesced_mmio_ring;
+#endif
 
 #ifdef CONFIG_KVM_ASYNC_PF
 	struct {
@@ -799,6 +806,7 @@ struct kvm {
 	struct kvm_coalesced_mmio_ring *coalesced_mmio_ring;
 	spinlock_t ring_lock;
 	struct list_head coalesced_zones;
+	bool coalesced_mmio_per_vcpu;
 #endif
 
 	struct mutex irq_lock;
@@ -1439,6 +1447,17 @@ int __kvm_mmu_topup_memory_cache(struct kvm_mmu_memory_cache *mc, int capacity,
 int kvm_mmu_memory_cache_nr_free_objects(struct kvm_mmu_memory_cache *mc);
 void kvm_mmu_free_memory_cache(struct kvm_mmu_memory_cache *mc);
 void *kvm_mmu_memory_cache_alloc(struct kvm_mmu_memory_cache *mc);
+
+static inline void kvm_mmu_memory_cache_set_node(struct kvm_mmu_memory_cache *mc,
+						 int nid)
+{
+	mc->node_biased = nid + 1;
+}
+
+static inline int kvm_mmu_memory_cache_node(const struct kvm_mmu_memory_cache *mc)
+{
+	return mc->node_biased - 1;
+}
 #endif
 
 void kvm_mmu_invalidate_begin(struct kvm *kvm);
@@ -1953,7 +1972,10 @@ struct _kvm_stats_desc {
 			HALT_POLL_HIST_COUNT),				       \
 	STATS_DESC_LOGHIST_TIME_NSEC(VCPU_GENERIC, halt_wait_hist,	       \
 			HALT_POLL_HIST_COUNT),				       \
-	STATS_DESC_IBOOLEAN(VCPU_GENERIC, blocking)
+	STATS_DESC_IBOOLEAN(VCPU_GENERIC, blocking),			       \
+	STATS_DESC_TIME_NSEC(VCPU_GENERIC, halt_poll_ewma_ns),		       \
+	STATS_DESC_LOGHIST_TIME_NSEC(VCPU_GENERIC, exit_reentry_hist,	       \
+			HALT_POLL_HIST_COUNT)
 
 extern struct dentry *kvm_debugfs_dir;
 
@@ -2001,6 +2023,32 @@ static inline void kvm_stats_log_hist_update(u64 *data, size_t size, u64 value)
 #define KVM_STATS_LOG_HIST_UPDATE(array, value)				       \
 	kvm_stats_log_hist_update(array, ARRAY_SIZE(array), value)
 
+DECLARE_STATIC_KEY_FALSE(kvm_exit_reentry_stats);
+
+/*
+ * kvm_vcpu_stat_guest_exit() and kvm_vcpu_stat_guest_entry() sample the
+ * host-side latency between a VM-Exit and the subsequent VM-Entry into the
+ * exit_reentry_hist logarithmic histogram.  Arch code calls them as close
+ * as possible to the actual world switch, i.e. immediately after and before
+ * the noinstr entry/exit section.  Both are no-ops unless the sampling has
+ * been enabled via the "exit_reentry_stats" module parameter, so that the
+ * clock reads stay off the hot path by default.
+ */
+static inline void kvm_vcpu_stat_guest_exit(struct kvm_vcpu *vcpu)
+{
+	if (static_branch_unlikely(&kvm_exit_reentry_stats))
+		vcpu->last_exit_ns = ktime_get_mono_fast_ns();
+}
+
+static inline void kvm_vcpu_stat_guest_entry(struct kvm_vcpu *vcpu)
+{
+	if (static_branch_unlikely(&kvm_exit_reentry_stats) &&
+	    vcpu->last_exit_ns)
+		KVM_STATS_LOG_HIST_UPDATE(vcpu->stat.generic.exit_reentry_hist,
+					  ktime_get_mono_fast_ns() -
+					  vcpu->last_exit_ns);
+}
+
 
 extern const struct kvm_stats_header kvm_vm_stats_header;
 extern const struct _kvm_stats_desc kvm_vm_stats_desc[];
@@ -46,6 +46,14 @@ struct kvm_kernel_irqfd {
 	/* Used for level IRQ fast-path */
 	int gsi;
 	struct work_struct inject;
+	/* Adaptive signal coalescing (KVM_IRQFD_FLAG_COALESCE only) */
+	bool coalesce;
+	/* Protects the four fields below */
+	spinlock_t coalesce_lock;
+	bool coalesce_window_open;
+	unsigned int coalesced_signals;
+	u64 coalesce_window_ns;
+	struct hrtimer coalesce_timer;
 	/* The resampler used by this irqfd (resampler-only) */
 	struct kvm_kernel_irqfd_resampler *resampler;
 	/* Eventfd notified on resample (resampler-only) */
@@ -87,6 +87,12 @@ struct kvm_mmu_memory_cache {
 	gfp_t gfp_zero;
 	gfp_t gfp_custom;
 	u64 init_value;
+	/*
+	 * Preferred NUMA node for refills, biased by one so that the
+	 * zero-initialized default means NUMA_NO_NODE.  Use the
+	 * kvm_mmu_memory_cache_{set_node,node}() accessors.
+	 */
+	int node_biased;
 	struct kmem_cache *kmem_cache;
 	int capacity;
 	int nobjs;
@@ -113,6 +119,8 @@ struct kvm_vcpu_stat_generic {
 	u64 halt_poll_fail_hist[HALT_POLL_HIST_COUNT];
 	u64 halt_wait_hist[HALT_POLL_HIST_COUNT];
 	u64 blocking;
+	u64 halt_poll_ewma_ns;
+	u64 exit_reentry_hist[HALT_POLL_HIST_COUNT];
 };
 
 #define KVM_STATS_NAME_SIZE	48
@@ -135,6 +135,20 @@ static inline void hlist_bl_del(struct hlist_bl_node *n)
 	n->pprev = LIST_POISON2;
 }
 
+/*
+ * Fake-hash a node, for objects that must look hashed without being on
+ * any list (mirrors hlist_add_fake()/hlist_fake()).
+ */
+static inline void hlist_bl_add_fake(struct hlist_bl_node *n)
+{
+	n->pprev = &n->next;
+}
+
+static inline bool hlist_bl_fake(struct hlist_bl_node *n)
+{
+	return n->pprev == &n->next;
+}
+
 static inline void hlist_bl_del_init(struct hlist_bl_node *n)
 {
 	if (!hlist_bl_unhashed(n)) {
@@ -27,5 +27,13 @@ struct map_benchmark {
 	__u32 dma_dir; /* DMA data direction */
 	__u32 dma_trans_ns; /* time for DMA transmission in ns */
 	__u32 granule;  /* how many PAGE_SIZE will do map/unmap once a time */
+	__u64 map_p50_100ns; /* 50th percentile of map latency in 100ns */
+	__u64 map_p99_100ns; /* 99th percentile of map latency */
+	__u64 map_p999_100ns; /* 99.9th percentile of map latency */
+	__u64 map_max_100ns; /* worst observed map latency */
+	__u64 unmap_p50_100ns; /* as above, for unmap */
+	__u64 unmap_p99_100ns;
+	__u64 unmap_p999_100ns;
+	__u64 unmap_max_100ns;
 };
 #endif /* _KERNEL_DMA_BENCHMARK_H */
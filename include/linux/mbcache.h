@@ -17,13 +17,16 @@ enum {
 };
 
 struct mb_cache_entry {
-	/* List of entries in cache - protected by cache->c_list_lock */
+	/* LRU list of entries - managed by the cache's list_lru */
 	struct list_head	e_list;
 	/*
-	 * Hash table list - protected by hash chain bitlock. The entry is
-	 * guaranteed to be hashed while e_refcnt > 0.
+	 * Hash table list - protected by hash chain bitlock for modification,
+	 * traversed under RCU. The entry is guaranteed to be hashed while
+	 * e_refcnt > 0.
 	 */
 	struct hlist_bl_node	e_hash_list;
+	/* Used to free the entry after an RCU grace period */
+	struct rcu_head		e_rcu;
 	/*
 	 * Entry refcount. Once it reaches zero, entry is unhashed and freed.
 	 * While refcount > 0, the entry is guaranteed to stay in the hash and
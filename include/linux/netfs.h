@@ -69,6 +69,7 @@ struct netfs_inode {
 	loff_t			zero_point;	/* Size after which we assume there's no data
 						 * on the server */
 	atomic_t		io_count;	/* Number of outstanding reqs */
+	atomic_long_t		download_rate;	/* EWMA of download bandwidth (bytes/s) */
 	unsigned long		flags;
 #define NETFS_ICTX_ODIRECT	0		/* The file has DIO in progress */
 #define NETFS_ICTX_UNBUFFERED	1		/* I/O should not use the pagecache */
@@ -181,6 +182,7 @@ struct netfs_io_subrequest {
 	size_t			max_len;	/* Maximum size of the I/O */
 	size_t			len;		/* Size of the I/O */
 	size_t			transferred;	/* Amount of data transferred */
+	unsigned long long	issue_time;	/* When a download was (re)issued (ns) */
 	refcount_t		ref;
 	short			error;		/* 0 or error that occurred */
 	unsigned short		debug_index;	/* Index in list (for debugging output) */
@@ -476,6 +478,7 @@ static inline void netfs_inode_init(struct netfs_inode *ctx,
 	ctx->zero_point = LLONG_MAX;
 	ctx->flags = 0;
 	atomic_set(&ctx->io_count, 0);
+	atomic_long_set(&ctx->download_rate, 0);
 #if IS_ENABLED(CONFIG_FSCACHE)
 	ctx->cache = NULL;
 #endif
@@ -15,6 +15,14 @@ struct percpu_rw_semaphore {
 	struct rcuwait		writer;
 	wait_queue_head_t	waiters;
 	atomic_t		block;
+	/*
+	 * In fast-writer mode readers unconditionally use the per-CPU
+	 * slowpath (percpu increment + full barrier + sem->block test)
+	 * and writers aggregate the per-CPU counts directly, without
+	 * waiting for an RCU grace period to switch reader modes.  Set
+	 * once at init time, never changed afterwards.
+	 */
+	bool			fast_writer;
 #ifdef CONFIG_DEBUG_LOCK_ALLOC
 	struct lockdep_map	dep_map;
 #endif
@@ -58,8 +66,11 @@ static inline void percpu_down_read(struct percpu_rw_semaphore *sem)
 	 * the writer won't be checking until we're past the preempt_enable()
 	 * and that once the synchronize_rcu() is done, the writer will see
 	 * anything we did within this RCU-sched read-size critical section.
+	 *
+	 * Fast-writer semaphores never arm sem->rss and must always use
+	 * the slowpath, which orders the increment against sem->block.
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss)))
+	if (likely(!sem->fast_writer && rcu_sync_is_idle(&sem->rss)))
 		this_cpu_inc(*sem->read_count);
 	else
 		__percpu_down_read(sem, false); /* Unconditional memory barrier */
@@ -78,7 +89,7 @@ static inline bool percpu_down_read_trylock(struct percpu_rw_semaphore *sem)
 	/*
 	 * Same as in percpu_down_read().
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss)))
+	if (likely(!sem->fast_writer && rcu_sync_is_idle(&sem->rss)))
 		this_cpu_inc(*sem->read_count);
 	else
 		ret = __percpu_down_read(sem, true); /* Unconditional memory barrier */
@@ -102,7 +113,7 @@ static inline void percpu_up_read(struct percpu_rw_semaphore *sem)
 	/*
 	 * Same as in percpu_down_read().
 	 */
-	if (likely(rcu_sync_is_idle(&sem->rss))) {
+	if (likely(!sem->fast_writer && rcu_sync_is_idle(&sem->rss))) {
 		this_cpu_dec(*sem->read_count);
 	} else {
 		/*
@@ -123,6 +134,7 @@ static inline void percpu_up_read(struct percpu_rw_semaphore *sem)
 
 extern bool percpu_is_read_locked(struct percpu_rw_semaphore *);
 extern void percpu_down_write(struct percpu_rw_semaphore *);
+extern void percpu_down_write_expedited(struct percpu_rw_semaphore *);
 extern void percpu_up_write(struct percpu_rw_semaphore *);
 
 static inline bool percpu_is_write_locked(struct percpu_rw_semaphore *sem)
@@ -132,6 +144,8 @@ static inline bool percpu_is_write_locked(struct percpu_rw_semaphore *sem)
 
 extern int __percpu_init_rwsem(struct percpu_rw_semaphore *,
 				const char *, struct lock_class_key *);
+extern int __percpu_init_rwsem_fast_writer(struct percpu_rw_semaphore *,
+				const char *, struct lock_class_key *);
 
 extern void percpu_free_rwsem(struct percpu_rw_semaphore *);
 
@@ -141,6 +155,12 @@ extern void percpu_free_rwsem(struct percpu_rw_semaphore *);
 	__percpu_init_rwsem(sem, #sem, &rwsem_key);		\
 })
 
+#define percpu_init_rwsem_fast_writer(sem)			\
+({								\
+	static struct lock_class_key rwsem_key;			\
+	__percpu_init_rwsem_fast_writer(sem, #sem, &rwsem_key);	\
+})
+
 #define percpu_rwsem_is_held(sem)	lockdep_is_held(sem)
 #define percpu_rwsem_assert_held(sem)	lockdep_assert_held(sem)
 
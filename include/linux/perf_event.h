@@ -291,6 +291,7 @@ struct perf_event_pmu_context;
 #define PERF_PMU_CAP_NO_EXCLUDE			0x0040
 #define PERF_PMU_CAP_AUX_OUTPUT			0x0080
 #define PERF_PMU_CAP_EXTENDED_HW_TYPE		0x0100
+#define PERF_PMU_CAP_AUX_PREFER_LARGE		0x0200
 
 struct perf_output_handle;
 
@@ -1043,6 +1044,8 @@ struct perf_cgroup_info {
 	u64				timestamp;
 	u64				timeoffset;
 	int				active;
+	/* enabled events targeting this cgroup on this CPU */
+	int				nr_events;
 };
 
 struct perf_cgroup {
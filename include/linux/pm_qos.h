@@ -148,6 +148,8 @@ s32 cpu_latency_qos_limit(void);
 bool cpu_latency_qos_request_active(struct pm_qos_request *req);
 void cpu_latency_qos_add_request(struct pm_qos_request *req, s32 value);
 void cpu_latency_qos_update_request(struct pm_qos_request *req, s32 new_value);
+void cpu_latency_qos_update_requests(struct pm_qos_request **reqs,
+				     const s32 *values, int count);
 void cpu_latency_qos_remove_request(struct pm_qos_request *req);
 #else
 static inline s32 cpu_latency_qos_limit(void) { return INT_MAX; }
@@ -159,6 +161,9 @@ static inline void cpu_latency_qos_add_request(struct pm_qos_request *req,
 					       s32 value) {}
 static inline void cpu_latency_qos_update_request(struct pm_qos_request *req,
 						  s32 new_value) {}
+static inline void cpu_latency_qos_update_requests(struct pm_qos_request **reqs,
+						   const s32 *values,
+						   int count) {}
 static inline void cpu_latency_qos_remove_request(struct pm_qos_request *req) {}
 #endif
 
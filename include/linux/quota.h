@@ -38,6 +38,7 @@
 #include <linux/spinlock.h>
 #include <linux/wait.h>
 #include <linux/percpu_counter.h>
+#include <linux/list_bl.h>
 
 #include <linux/dqblk_xfs.h>
 #include <linux/dqblk_v1.h>
@@ -294,7 +295,7 @@ static inline void dqstats_dec(unsigned int type)
 				 * clear them when it sees fit. */
 
 struct dquot {
-	struct hlist_node dq_hash;	/* Hash list in memory [dq_list_lock] */
+	struct hlist_bl_node dq_hash;	/* Hash chain [bucket bit lock] */
 	struct list_head dq_inuse;	/* List of all quotas [dq_list_lock] */
 	struct list_head dq_free;	/* Free list element [dq_list_lock] */
 	struct list_head dq_dirty;	/* List of dirty dquots [dq_list_lock] */
@@ -306,6 +307,8 @@ struct dquot {
 	loff_t dq_off;			/* Offset of dquot on disk [dq_lock, stable once set] */
 	unsigned long dq_flags;		/* See DQ_* */
 	struct mem_dqblk dq_dqb;	/* Diskquota usage [dq_dqb_lock] */
+	struct percpu_counter dq_space_delta; /* Space accounted only per CPU so far */
+	bool dq_fastpath;		/* May space changes skip dq_dqb_lock? */
 };
 
 /* Operations which must be implemented by each quota format */
@@ -38,6 +38,7 @@ static inline bool rcu_sync_is_idle(struct rcu_sync *rsp)
 
 extern void rcu_sync_init(struct rcu_sync *);
 extern void rcu_sync_enter(struct rcu_sync *);
+extern void rcu_sync_enter_expedited(struct rcu_sync *);
 extern void rcu_sync_exit(struct rcu_sync *);
 extern void rcu_sync_dtor(struct rcu_sync *);
 
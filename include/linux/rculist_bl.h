@@ -68,6 +68,21 @@ static inline void hlist_bl_del_rcu(struct hlist_bl_node *n)
  * problems on Alpha CPUs.  Regardless of the type of CPU, the
  * list-traversal primitive must be guarded by rcu_read_lock().
  */
+/**
+ * hlist_bl_del_init_rcu - deletes entry from hash list with re-initialization
+ * @n: the element to delete from the hash list.
+ *
+ * Like hlist_del_init_rcu(): the entry reads as unhashed afterwards, but
+ * stays safe for concurrent RCU traversals that may still see it.
+ */
+static inline void hlist_bl_del_init_rcu(struct hlist_bl_node *n)
+{
+	if (!hlist_bl_unhashed(n)) {
+		__hlist_bl_del(n);
+		WRITE_ONCE(n->pprev, NULL);
+	}
+}
+
 static inline void hlist_bl_add_head_rcu(struct hlist_bl_node *n,
 					struct hlist_bl_head *h)
 {
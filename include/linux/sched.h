@@ -738,6 +738,23 @@ struct wake_q_node {
 	struct wake_q_node *next;
 };
 
+#ifdef CONFIG_SYSCALL_LAT_HIST
+#define SYSCALL_LAT_BUCKETS	16
+
+/*
+ * Coarse per-task syscall latency histogram with log2 microsecond
+ * buckets, recorded by the generic syscall entry/exit code when the
+ * syscall_lat_hist static key is enabled.  @owner_pid detects stale
+ * contents inherited over fork(), so no fork/exit hooks are needed.
+ */
+struct syscall_lat_hist {
+	u64				enter_ts;
+	u64				nr_syscalls;
+	pid_t				owner_pid;
+	u32				buckets[SYSCALL_LAT_BUCKETS];
+};
+#endif
+
 struct kmap_ctrl {
 #ifdef CONFIG_KMAP_LOCAL
 	int				idx;
@@ -1350,6 +1367,10 @@ struct task_struct {
 	struct task_delay_info		*delays;
 #endif
 
+#ifdef CONFIG_SYSCALL_LAT_HIST
+	struct syscall_lat_hist		syscall_lat;
+#endif
+
 #ifdef CONFIG_FAULT_INJECTION
 	int				make_it_fail;
 	unsigned int			fail_nth;
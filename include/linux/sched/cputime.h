@@ -3,6 +3,7 @@
 #define _LINUX_SCHED_CPUTIME_H
 
 #include <linux/sched/signal.h>
+#include <linux/smp.h>
 
 /*
  * cputime accounting APIs:
@@ -106,6 +107,19 @@ struct thread_group_cputimer *get_running_cputimer(struct task_struct *tsk)
 }
 #endif
 
+/**
+ * group_cputime_shard - return this CPU's shard of the group accumulator
+ *
+ * @cputimer:	Pointer to thread_group_cputimer of the target group.
+ */
+static inline
+struct task_cputime_atomic *group_cputime_shard(struct thread_group_cputimer *cputimer)
+{
+	unsigned int shard = raw_smp_processor_id() & (TG_CPUTIME_SHARDS - 1);
+
+	return &cputimer->shards[shard].cputime_atomic;
+}
+
 /**
  * account_group_user_time - Maintain utime for a thread group.
  *
@@ -124,7 +138,7 @@ static inline void account_group_user_time(struct task_struct *tsk,
 	if (!cputimer)
 		return;
 
-	atomic64_add(cputime, &cputimer->cputime_atomic.utime);
+	atomic64_add(cputime, &group_cputime_shard(cputimer)->utime);
 }
 
 /**
@@ -145,7 +159,7 @@ static inline void account_group_system_time(struct task_struct *tsk,
 	if (!cputimer)
 		return;
 
-	atomic64_add(cputime, &cputimer->cputime_atomic.stime);
+	atomic64_add(cputime, &group_cputime_shard(cputimer)->stime);
 }
 
 /**
@@ -166,7 +180,7 @@ static inline void account_group_exec_runtime(struct task_struct *tsk,
 	if (!cputimer)
 		return;
 
-	atomic64_add(ns, &cputimer->cputime_atomic.sum_exec_runtime);
+	atomic64_add(ns, &group_cputime_shard(cputimer)->sum_exec_runtime);
 }
 
 static inline void prev_cputime_init(struct prev_cputime *prev)
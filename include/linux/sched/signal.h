@@ -57,15 +57,41 @@ struct task_cputime_atomic {
 		.stime = ATOMIC64_INIT(0),			\
 		.sum_exec_runtime = ATOMIC64_INIT(0),		\
 	}
+/* Number of group cputime accumulator shards. Must be a power of 2! */
+#if defined(CONFIG_SMP) && NR_CPUS > 8
+# define TG_CPUTIME_SHARDS	8
+#else
+# define TG_CPUTIME_SHARDS	1
+#endif
+
+/**
+ * struct task_cputime_shard - cacheline spaced shard of group cputime
+ * @cputime_atomic:	interval timer deltas accumulated by the CPUs
+ *			which map to this shard
+ *
+ * Spacing the shards prevents every CPU running a thread of a large
+ * process from bouncing a single set of interval timer counts at each
+ * tick.
+ */
+struct task_cputime_shard {
+	struct task_cputime_atomic cputime_atomic;
+} ____cacheline_aligned_in_smp;
+
 /**
  * struct thread_group_cputimer - thread group interval timer counts
- * @cputime_atomic:	atomic thread group interval timers.
+ * @cputime_atomic:	baseline of the thread group interval timers,
+ *			established when the accounting is (re)started
+ * @shards:		tick time deltas, sharded by CPU; only written
+ *			while the group accounting is active and reset
+ *			when a fresh baseline is established
  *
  * This structure contains the version of task_cputime, above, that is
- * used for thread group CPU timer calculations.
+ * used for thread group CPU timer calculations.  The current value of a
+ * process-wide clock is @cputime_atomic plus the sum of all @shards.
  */
 struct thread_group_cputimer {
 	struct task_cputime_atomic cputime_atomic;
+	struct task_cputime_shard shards[TG_CPUTIME_SHARDS];
 };
 
 struct multiprocess_signals {
@@ -17,6 +17,7 @@ struct seq_operations;
 struct seq_file {
 	char *buf;
 	size_t size;
+	size_t size_hint;
 	size_t from;
 	size_t count;
 	size_t pad_until;
@@ -53,6 +54,23 @@ static inline bool seq_has_overflowed(struct seq_file *m)
 	return m->count == m->size;
 }
 
+/**
+ * seq_set_size_hint - declare the expected output size of a seq_file
+ * @m: the seq_file handle
+ * @size: expected number of bytes a full render will produce
+ *
+ * Providers whose output is known to exceed PAGE_SIZE (large tables,
+ * per-object listings) can call this after seq_open() so that the first
+ * buffer allocation is already big enough, instead of rendering into a
+ * PAGE_SIZE buffer, overflowing, and rendering again with a doubled
+ * buffer.  The hint only affects the initial allocation; an undersized
+ * hint falls back to the normal grow-and-retry behaviour.
+ */
+static inline void seq_set_size_hint(struct seq_file *m, size_t size)
+{
+	m->size_hint = size;
+}
+
 /**
  * seq_get_buf - get buffer to write arbitrary data to
  * @m: the seq_file handle
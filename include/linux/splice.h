@@ -11,6 +11,8 @@
 
 #include <linux/pipe_fs_i.h>
 
+#include <uapi/linux/splice.h>
+
 /*
  * Flags passed in from splice/tee/vmsplice
  */
@@ -52,6 +52,7 @@ enum {
 	SP_TASK_PENDING,	/* still work to do even if no xprt is queued */
 	SP_NEED_VICTIM,		/* One thread needs to agree to exit */
 	SP_VICTIM_REMAINS,	/* One thread needs to actually exit */
+	SP_NEED_THREAD,		/* Pool was congested; grow it on demand */
 };
 
 
@@ -88,6 +89,12 @@ struct svc_serv {
 	struct svc_pool *	sv_pools;	/* array of thread pools */
 	int			(*sv_threadfn)(void *data);
 
+	unsigned int		sv_max_pool_threads; /* cap for on-demand pool
+						 * growth, or '0' to disable
+						 * auto-scaling. */
+	struct mutex		sv_scale_mutex;	/* protects thread counts */
+	struct work_struct	sv_scale_work;	/* demand-driven thread creation */
+
 #if defined(CONFIG_SUNRPC_BACKCHANNEL)
 	struct lwq		sv_cb_list;	/* queue for callback requests
 						 * that arrive over the same
@@ -423,7 +430,9 @@ int		   svc_register(const struct svc_serv *, struct net *, const int,
 
 void		   svc_wake_up(struct svc_serv *);
 void		   svc_reserve(struct svc_rqst *rqstp, int space);
-void		   svc_pool_wake_idle_thread(struct svc_pool *pool);
+bool		   svc_pool_wake_idle_thread(struct svc_pool *pool);
+void		   svc_pool_grow_on_demand(struct svc_serv *serv,
+					   struct svc_pool *pool);
 struct svc_pool   *svc_pool_for_cpu(struct svc_serv *serv);
 char *		   svc_print_addr(struct svc_rqst *, char *, size_t);
 const char *	   svc_proc_name(const struct svc_rqst *rqstp);
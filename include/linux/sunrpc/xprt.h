@@ -255,6 +255,8 @@ struct rpc_xprt {
 	 * Send stuff
 	 */
 	atomic_long_t		queuelen;
+	unsigned long		srtt_ns;	/* smoothed RTT, for multipath
+						 * transport balancing */
 	spinlock_t		transport_lock;	/* lock transport info */
 	spinlock_t		reserve_lock;	/* lock slot table */
 	spinlock_t		queue_lock;	/* send/receive queue lock */
@@ -447,6 +449,7 @@ void			xprt_release_write(struct rpc_xprt *, struct rpc_task *);
 #define XPRT_CWND_WAIT		(10)
 #define XPRT_WRITE_SPACE	(11)
 #define XPRT_SND_IS_COOKIE	(12)
+#define XPRT_DEGRADED		(13)
 
 static inline void xprt_set_connected(struct rpc_xprt *xprt)
 {
@@ -115,6 +115,9 @@ struct io_tlb_pool {
  * @lock:	Lock to synchronize changes to the list.
  * @pools:	List of IO TLB memory pool descriptors (if dynamic).
  * @dyn_alloc:	Dynamic IO TLB pool allocation work.
+ * @dyn_alloc_nid: NUMA node of the device which most recently triggered
+ *		dynamic pool allocation. New pools are allocated on this
+ *		node so that bounce buffers stay local to the device.
  * @total_used:	The total number of slots in the pool that are currently used
  *		across all areas. Used only for calculating used_hiwater in
  *		debugfs.
@@ -135,6 +138,7 @@ struct io_tlb_mem {
 	spinlock_t lock;
 	struct list_head pools;
 	struct work_struct dyn_alloc;
+	int dyn_alloc_nid;
 #endif
 #ifdef CONFIG_DEBUG_FS
 	atomic_long_t total_used;
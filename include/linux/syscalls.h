@@ -47,6 +47,7 @@ struct stat64;
 struct statfs;
 struct statfs64;
 struct statx;
+struct statx_vec;
 struct sysinfo;
 struct timespec;
 struct __kernel_old_timeval;
@@ -64,6 +65,7 @@ struct old_linux_dirent;
 struct perf_event_attr;
 struct file_handle;
 struct sigaltstack;
+struct splice_segment;
 struct rseq;
 union bpf_attr;
 struct io_uring_params;
@@ -496,6 +498,9 @@ asmlinkage long sys_vmsplice(int fd, const struct iovec __user *iov,
 asmlinkage long sys_splice(int fd_in, loff_t __user *off_in,
 			   int fd_out, loff_t __user *off_out,
 			   size_t len, unsigned int flags);
+asmlinkage long sys_splicev(const struct splice_segment __user *segs,
+			    unsigned int nr_segs, int fd_out,
+			    loff_t __user *off_out, unsigned int flags);
 asmlinkage long sys_tee(int fdin, int fdout, size_t len, unsigned int flags);
 asmlinkage long sys_readlinkat(int dfd, const char __user *path, char __user *buf,
 			       int bufsiz);
@@ -929,6 +934,9 @@ asmlinkage long sys_pkey_alloc(unsigned long flags, unsigned long init_val);
 asmlinkage long sys_pkey_free(int pkey);
 asmlinkage long sys_statx(int dfd, const char __user *path, unsigned flags,
 			  unsigned mask, struct statx __user *buffer);
+asmlinkage long sys_statxv(int dfd, const struct statx_vec __user *vec,
+			   unsigned int nr, unsigned int flags,
+			   unsigned int mask);
 asmlinkage long sys_rseq(struct rseq __user *rseq, uint32_t rseq_len,
 			 int flags, uint32_t sig);
 asmlinkage long sys_open_tree(int dfd, const char __user *path, unsigned flags);
@@ -45,6 +45,16 @@ struct uprobe_consumer {
 	struct uprobe_consumer *next;
 };
 
+/*
+ * One probe of a batch registration on a single file, see
+ * uprobe_register_batch().
+ */
+struct uprobe_batch_desc {
+	loff_t			offset;
+	loff_t			ref_ctr_offset;
+	struct uprobe_consumer	*uc;
+};
+
 #ifdef CONFIG_UPROBES
 #include <asm/uprobes.h>
 
@@ -112,6 +122,7 @@ extern unsigned long uprobe_get_trap_addr(struct pt_regs *regs);
 extern int uprobe_write_opcode(struct arch_uprobe *auprobe, struct mm_struct *mm, unsigned long vaddr, uprobe_opcode_t);
 extern int uprobe_register(struct inode *inode, loff_t offset, struct uprobe_consumer *uc);
 extern int uprobe_register_refctr(struct inode *inode, loff_t offset, loff_t ref_ctr_offset, struct uprobe_consumer *uc);
+extern int uprobe_register_batch(struct inode *inode, struct uprobe_batch_desc *descs, int cnt);
 extern int uprobe_apply(struct inode *inode, loff_t offset, struct uprobe_consumer *uc, bool);
 extern void uprobe_unregister(struct inode *inode, loff_t offset, struct uprobe_consumer *uc);
 extern int uprobe_mmap(struct vm_area_struct *vma);
@@ -153,6 +164,10 @@ uprobe_register(struct inode *inode, loff_t offset, struct uprobe_consumer *uc)
 {
 	return -ENOSYS;
 }
+static inline int uprobe_register_batch(struct inode *inode, struct uprobe_batch_desc *descs, int cnt)
+{
+	return -ENOSYS;
+}
 static inline int uprobe_register_refctr(struct inode *inode, loff_t offset, loff_t ref_ctr_offset, struct uprobe_consumer *uc)
 {
 	return -ENOSYS;
@@ -180,6 +180,30 @@ zstd_cctx *zstd_init_cctx(void *workspace, size_t workspace_size);
 size_t zstd_compress_cctx(zstd_cctx *cctx, void *dst, size_t dst_capacity,
 	const void *src, size_t src_size, const zstd_parameters *parameters);
 
+/**
+ * zstd_compress_using_dict() - compress src into dst using a dictionary
+ * @cctx:         The context. Must have been initialized with zstd_init_cctx().
+ * @dst:          The buffer to compress src into.
+ * @dst_capacity: The size of the destination buffer. May be any size, but
+ *                ZSTD_compressBound(srcSize) is guaranteed to be large enough.
+ * @src:          The data to compress.
+ * @src_size:     The size of the data to compress.
+ * @dict:         The dictionary to be used.
+ * @dict_size:    The size of the dictionary.
+ * @level:        The compression level.
+ *
+ * The dictionary is loaded into the context on every call, so it is most
+ * efficient for the many-small-inputs case the dictionary API targets.
+ * Frames produced with a dictionary can only be decompressed with the same
+ * dictionary, e.g. via zstd_decompress_using_dict().
+ *
+ * Return:        The compressed size or an error, which can be checked using
+ *                zstd_is_error().
+ */
+size_t zstd_compress_using_dict(zstd_cctx *cctx, void *dst, size_t dst_capacity,
+	const void *src, size_t src_size, const void *dict, size_t dict_size,
+	int level);
+
 /* ======   Single-pass Decompression   ====== */
 
 typedef ZSTD_DCtx zstd_dctx;
@@ -220,6 +244,25 @@ zstd_dctx *zstd_init_dctx(void *workspace, size_t workspace_size);
 size_t zstd_decompress_dctx(zstd_dctx *dctx, void *dst, size_t dst_capacity,
 	const void *src, size_t src_size);
 
+/**
+ * zstd_decompress_using_dict() - decompress src into dst using a dictionary
+ * @dctx:         The decompression context.
+ * @dst:          The buffer to decompress src into.
+ * @dst_capacity: The size of the destination buffer. Must be at least as large
+ *                as the decompressed size. If the caller cannot upper bound the
+ *                decompressed size, then it's better to use the streaming API.
+ * @src:          The zstd compressed data to decompress.
+ * @src_size:     The exact size of the data to decompress.
+ * @dict:         The dictionary the data was compressed with.
+ * @dict_size:    The size of the dictionary.
+ *
+ * Return:        The decompressed size or an error, which can be checked using
+ *                zstd_is_error().
+ */
+size_t zstd_decompress_using_dict(zstd_dctx *dctx, void *dst,
+	size_t dst_capacity, const void *src, size_t src_size,
+	const void *dict, size_t dict_size);
+
 /* ======   Streaming Buffers   ====== */
 
 /**
@@ -444,4 +487,90 @@ typedef ZSTD_frameHeader zstd_frame_header;
 size_t zstd_get_frame_header(zstd_frame_header *params, const void *src,
 	size_t src_size);
 
+/* ======   Multithreaded Streaming Compression   ====== */
+
+struct zstd_mt_cctx;
+
+/**
+ * struct zstd_mt_parameters - parameters for multithreaded compression
+ * @level:      The compression level used for every job.
+ * @nr_workers: The number of jobs compressed concurrently, or 0 to use one
+ *              job per online CPU.
+ * @job_size:   The number of input bytes compressed into each frame, or 0
+ *              for the default.
+ * @dict:       An optional dictionary shared by every frame, or NULL. It
+ *              must outlive the context.
+ * @dict_size:  The size of the dictionary.
+ */
+struct zstd_mt_parameters {
+	int level;
+	unsigned int nr_workers;
+	size_t job_size;
+	const void *dict;
+	size_t dict_size;
+};
+
+/**
+ * typedef zstd_mt_write_fn - ordered output sink of a multithreaded stream
+ * @priv: The private pointer passed to zstd_mt_init_cctx().
+ * @data: The compressed frame data to consume.
+ * @len:  The number of bytes in @data.
+ *
+ * Called in input order, once per compressed frame, from the context that
+ * calls zstd_mt_compress_update()/zstd_mt_compress_end(). May sleep.
+ *
+ * Return: Zero on success or a negative errno, which aborts the stream.
+ */
+typedef int (*zstd_mt_write_fn)(void *priv, const void *data, size_t len);
+
+/**
+ * zstd_mt_init_cctx() - initialize a multithreaded compression context
+ * @params: The compression parameters. Copied into the context.
+ * @write:  The callback consuming the ordered compressed output.
+ * @priv:   An opaque pointer passed to @write.
+ *
+ * The input stream is sharded into jobs of @params->job_size bytes, each
+ * compressed into an independent zstd frame on a workqueue. The
+ * concatenated frames form a standard zstd stream decodable with
+ * zstd_decompress_stream(). All functions on the context may sleep and
+ * must be called from process context; the context itself is not
+ * thread-safe.
+ *
+ * Return: The context, or NULL on allocation failure.
+ */
+struct zstd_mt_cctx *zstd_mt_init_cctx(const struct zstd_mt_parameters *params,
+	zstd_mt_write_fn write, void *priv);
+
+/**
+ * zstd_mt_compress_update() - feed input data to a multithreaded stream
+ * @mt:  The multithreaded compression context.
+ * @src: The input data. May be reused once this function returns.
+ * @len: The number of bytes in @src.
+ *
+ * Return: Zero on success or a negative errno. Once an error is returned
+ *         the stream is failed and must be ended and freed.
+ */
+int zstd_mt_compress_update(struct zstd_mt_cctx *mt, const void *src,
+	size_t len);
+
+/**
+ * zstd_mt_compress_end() - finish a multithreaded stream
+ * @mt: The multithreaded compression context.
+ *
+ * Flushes buffered input as a final frame and waits until every job has
+ * been compressed and written out. On success the context may be reused
+ * for a new stream.
+ *
+ * Return: Zero on success or the first error of the stream.
+ */
+int zstd_mt_compress_end(struct zstd_mt_cctx *mt);
+
+/**
+ * zstd_mt_free_cctx() - free a multithreaded compression context
+ * @mt: The context to free, or NULL.
+ *
+ * Waits for any jobs still in flight without writing their output.
+ */
+void zstd_mt_free_cctx(struct zstd_mt_cctx *mt);
+
 #endif  /* LINUX_ZSTD_H */
@@ -95,6 +95,10 @@ struct tls_sw_context_tx {
 	struct crypto_wait async_wait;
 	struct tx_work tx_work;
 	struct tls_rec *open_rec;
+	/* most recently retired record, recycled by the next record
+	 * allocation; protected by the socket lock
+	 */
+	struct tls_rec *rec_cache;
 	struct list_head tx_list;
 	atomic_t encrypt_pending;
 	u8 async_capable:1;
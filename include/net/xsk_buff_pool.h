@@ -59,6 +59,8 @@ struct xsk_buff_pool {
 	struct list_head xskb_list;
 	u32 heads_cnt;
 	u16 queue_id;
+	/* NUMA node of the netdev the pool was created for */
+	int numa_node;
 
 	/* Data path members as close to free_heads at the end as possible. */
 	struct xsk_queue *fq ____cacheline_aligned_in_smp;
@@ -101,7 +103,8 @@ struct xsk_buff_pool {
 
 /* AF_XDP core. */
 struct xsk_buff_pool *xp_create_and_assign_umem(struct xdp_sock *xs,
-						struct xdp_umem *umem);
+						struct xdp_umem *umem,
+						struct net_device *dev);
 int xp_assign_dev(struct xsk_buff_pool *pool, struct net_device *dev,
 		  u16 queue_id, u16 flags);
 int xp_assign_dev_shared(struct xsk_buff_pool *pool, struct xdp_sock *umem_xs,
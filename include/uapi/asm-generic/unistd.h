@@ -844,9 +844,13 @@ __SYSCALL(__NR_lsm_list_modules, sys_lsm_list_modules)
 
 #define __NR_mseal 462
 __SYSCALL(__NR_mseal, sys_mseal)
+#define __NR_splicev 463
+__SYSCALL(__NR_splicev, sys_splicev)
+#define __NR_statxv 464
+__SYSCALL(__NR_statxv, sys_statxv)
 
 #undef __NR_syscalls
-#define __NR_syscalls 463
+#define __NR_syscalls 465
 
 /*
  * 32 bit systems traditionally used different
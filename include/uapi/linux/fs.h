@@ -329,9 +329,12 @@ typedef int __bitwise __kernel_rwf_t;
 /* per-IO negation of O_APPEND */
 #define RWF_NOAPPEND	((__force __kernel_rwf_t)0x00000020)
 
+/* buffered IO that drops the cache after reading or writing data */
+#define RWF_DONTCACHE	((__force __kernel_rwf_t)0x00000040)
+
 /* mask of flags supported by the kernel */
 #define RWF_SUPPORTED	(RWF_HIPRI | RWF_DSYNC | RWF_SYNC | RWF_NOWAIT |\
-			 RWF_APPEND | RWF_NOAPPEND)
+			 RWF_APPEND | RWF_NOAPPEND | RWF_DONTCACHE)
 
 /* Pagemap ioctl */
 #define PAGEMAP_SCAN	_IOWR('f', 16, struct pm_scan_arg)
@@ -393,4 +396,55 @@ struct pm_scan_arg {
 	__u64 return_mask;
 };
 
+/* /proc/<pid>/maps ioctl */
+#define PROCMAP_SCAN	_IOWR('f', 17, struct procmap_scan_arg)
+
+/* Bitmasks reported in procmap_entry.vma_flags. */
+#define PROCMAP_VMA_READABLE	(1 << 0)
+#define PROCMAP_VMA_WRITABLE	(1 << 1)
+#define PROCMAP_VMA_EXECUTABLE	(1 << 2)
+#define PROCMAP_VMA_SHARED	(1 << 3)
+
+/*
+ * struct procmap_entry - Single VMA record returned by PROCMAP_SCAN
+ * @start:	Start address of the mapping
+ * @end:	End address of the mapping (exclusive)
+ * @pgoff:	Offset into the backing object, in bytes
+ * @vma_flags:	PROCMAP_VMA_* bitmask for the mapping
+ * @rss:	Resident set size of the mapping, in bytes
+ * @pss:	Proportional set size of the mapping, in bytes
+ */
+struct procmap_entry {
+	__u64 start;
+	__u64 end;
+	__u64 pgoff;
+	__u64 vma_flags;
+	__u64 rss;
+	__u64 pss;
+};
+
+/* Flags for PROCMAP_SCAN ioctl */
+#define PROCMAP_SCAN_STATS	(1 << 0)	/* Fill in rss/pss (walks the page tables). */
+
+/*
+ * struct procmap_scan_arg - /proc/<pid>/maps ioctl argument
+ * @size:	Size of the structure
+ * @flags:	Flags for the IOCTL
+ * @start:	Address to start the walk from; the first VMA returned is
+ *		the one containing or following it
+ * @walk_end:	Address to pass back as @start to resume the walk (written
+ *		by kernel); -1 informs that the whole address space has
+ *		been walked
+ * @vec:	Address of procmap_entry struct array for output
+ * @vec_len:	Length of the procmap_entry struct array
+ */
+struct procmap_scan_arg {
+	__u64 size;
+	__u64 flags;
+	__u64 start;
+	__u64 walk_end;
+	__u64 vec;
+	__u64 vec_len;
+};
+
 #endif /* _UAPI_LINUX_FS_H */
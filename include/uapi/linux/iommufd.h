@@ -50,6 +50,7 @@ enum {
 	IOMMUFD_CMD_HWPT_SET_DIRTY_TRACKING,
 	IOMMUFD_CMD_HWPT_GET_DIRTY_BITMAP,
 	IOMMUFD_CMD_HWPT_INVALIDATE,
+	IOMMUFD_CMD_IOAS_MAP_VEC,
 };
 
 /**
@@ -212,6 +213,49 @@ struct iommu_ioas_map {
 };
 #define IOMMU_IOAS_MAP _IO(IOMMUFD_TYPE, IOMMUFD_CMD_IOAS_MAP)
 
+/**
+ * struct iommu_ioas_map_elem - Single range of IOMMU_IOAS_MAP_VEC
+ * @user_va: Userspace pointer to start mapping from
+ * @length: Number of bytes to map
+ * @iova: IOVA the mapping was placed at. If IOMMU_IOAS_MAP_FIXED_IOVA is set
+ *        then this must be provided as input.
+ */
+struct iommu_ioas_map_elem {
+	__aligned_u64 user_va;
+	__aligned_u64 length;
+	__aligned_u64 iova;
+};
+
+/**
+ * struct iommu_ioas_map_vec - ioctl(IOMMU_IOAS_MAP_VEC)
+ * @size: sizeof(struct iommu_ioas_map_vec)
+ * @flags: Combination of enum iommufd_ioas_map_flags, applied to every range
+ * @ioas_id: IOAS ID to change the mapping of
+ * @num_elems: Number of elements in the array at elems_uptr
+ * @elems_uptr: Userspace pointer to an array of struct iommu_ioas_map_elem
+ * @num_mapped: Number of ranges successfully mapped, must be 0 on input
+ * @__reserved: Must be 0
+ *
+ * Establish several IOVA mappings with a single ioctl, equivalent to calling
+ * IOMMU_IOAS_MAP once per element in array order. The iova field of each
+ * element is written back as the range is mapped. Physically contiguous
+ * ranges are promoted to large IOPTEs exactly as with IOMMU_IOAS_MAP,
+ * subject to IOMMU_OPTION_HUGE_PAGES.
+ *
+ * On failure the first num_mapped ranges remain established and the caller
+ * owns unmapping them if the partial state is unwanted.
+ */
+struct iommu_ioas_map_vec {
+	__u32 size;
+	__u32 flags;
+	__u32 ioas_id;
+	__u32 num_elems;
+	__aligned_u64 elems_uptr;
+	__u32 num_mapped;
+	__u32 __reserved;
+};
+#define IOMMU_IOAS_MAP_VEC _IO(IOMMUFD_TYPE, IOMMUFD_CMD_IOAS_MAP_VEC)
+
 /**
  * struct iommu_ioas_copy - ioctl(IOMMU_IOAS_COPY)
  * @size: sizeof(struct iommu_ioas_copy)
@@ -51,6 +51,7 @@ struct kvm_userspace_memory_region2 {
 #define KVM_MEM_LOG_DIRTY_PAGES	(1UL << 0)
 #define KVM_MEM_READONLY	(1UL << 1)
 #define KVM_MEM_GUEST_MEMFD	(1UL << 2)
+#define KVM_MEM_DIRTY_LOG_BITMAP	(1UL << 3)
 
 /* for KVM_IRQ_LINE */
 struct kvm_irq_level {
@@ -917,6 +918,8 @@ struct kvm_enable_cap {
 #define KVM_CAP_MEMORY_ATTRIBUTES 233
 #define KVM_CAP_GUEST_MEMFD 234
 #define KVM_CAP_VM_TYPES 235
+#define KVM_CAP_IRQFD_COALESCE 236
+#define KVM_CAP_COALESCED_MMIO_PER_VCPU 237
 
 struct kvm_irq_routing_irqchip {
 	__u32 irqchip;
@@ -991,6 +994,15 @@ struct kvm_irq_routing {
  * emulation.  See Documentation/virt/kvm/api.rst.
  */
 #define KVM_IRQFD_FLAG_RESAMPLE (1 << 1)
+/*
+ * KVM_IRQFD_FLAG_COALESCE lets KVM adaptively coalesce bursts of signals
+ * on this irqfd: the first signal of a burst is injected immediately,
+ * subsequent signals arriving within the coalescing window collapse into
+ * a single deferred injection.  Only valid for edge triggered (non
+ * resampling) irqfds whose consumer re-scans its ring on every interrupt,
+ * e.g. virtio queues.
+ */
+#define KVM_IRQFD_FLAG_COALESCE (1 << 2)
 
 struct kvm_irqfd {
 	__u32 fd;
@@ -1548,4 +1560,6 @@ struct kvm_create_guest_memfd {
 	__u64 reserved[6];
 };
 
+#define KVM_GUEST_MEMFD_ALLOW_HUGEPAGE		(1ULL << 0)
+
 #endif /* __LINUX_KVM_H */
@@ -0,0 +1,18 @@
+/* SPDX-License-Identifier: GPL-2.0 WITH Linux-syscall-note */
+#ifndef _UAPI_LINUX_SPLICE_H
+#define _UAPI_LINUX_SPLICE_H
+
+#include <linux/types.h>
+
+/*
+ * One input segment for splicev(2).  An @offset of -1 reads from (and
+ * advances) the file's position, like splice(2) with a NULL off_in.
+ */
+struct splice_segment {
+	__s32 fd;
+	__u32 reserved;		/* must be zero */
+	__s64 offset;
+	__u64 len;
+};
+
+#endif /* _UAPI_LINUX_SPLICE_H */
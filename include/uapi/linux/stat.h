@@ -193,5 +193,13 @@ struct statx {
 #define STATX_ATTR_VERITY		0x00100000 /* [I] Verity protected file */
 #define STATX_ATTR_DAX			0x00200000 /* File is currently in DAX state */
 
+/*
+ * One entry for statxv(): a pathname to resolve (relative to the shared
+ * dfd argument) and the statx buffer to fill for it.
+ */
+struct statx_vec {
+	__u64	pathname;	/* const char * */
+	__u64	buffer;		/* struct statx * */
+};
 
 #endif /* _UAPI_LINUX_STAT_H */
@@ -54,7 +54,8 @@
 	 (__u64)1 << _UFFDIO_MOVE |		\
 	 (__u64)1 << _UFFDIO_WRITEPROTECT |	\
 	 (__u64)1 << _UFFDIO_CONTINUE |		\
-	 (__u64)1 << _UFFDIO_POISON)
+	 (__u64)1 << _UFFDIO_POISON |		\
+	 (__u64)1 << _UFFDIO_COPYV)
 #define UFFD_API_RANGE_IOCTLS_BASIC		\
 	((__u64)1 << _UFFDIO_WAKE |		\
 	 (__u64)1 << _UFFDIO_COPY |		\
@@ -79,6 +80,7 @@
 #define _UFFDIO_WRITEPROTECT		(0x06)
 #define _UFFDIO_CONTINUE		(0x07)
 #define _UFFDIO_POISON			(0x08)
+#define _UFFDIO_COPYV			(0x09)
 #define _UFFDIO_API			(0x3F)
 
 /* userfaultfd ioctl ids */
@@ -103,6 +105,8 @@
 				      struct uffdio_continue)
 #define UFFDIO_POISON		_IOWR(UFFDIO, _UFFDIO_POISON, \
 				      struct uffdio_poison)
+#define UFFDIO_COPYV		_IOWR(UFFDIO, _UFFDIO_COPYV, \
+				      struct uffdio_copyv)
 
 /* read() structure */
 struct uffd_msg {
@@ -293,6 +297,30 @@ struct uffdio_copy {
 	__s64 copy;
 };
 
+struct uffdio_copy_range {
+	__u64 dst;
+	__u64 src;
+	__u64 len;
+};
+
+struct uffdio_copyv {
+	/*
+	 * Array of struct uffdio_copy_range to resolve in order.  The
+	 * same alignment rules as for uffdio_copy apply to each range.
+	 */
+	__u64 ranges;
+	__u64 count;
+	/* Applied to every range; same flags as uffdio_copy.mode. */
+	__u64 mode;
+
+	/*
+	 * "copy" is written by the ioctl and must be at the end: the
+	 * total number of bytes copied across all ranges, stopping at
+	 * the first range that fails.
+	 */
+	__s64 copy;
+};
+
 struct uffdio_zeropage {
 	struct uffdio_range range;
 #define UFFDIO_ZEROPAGE_MODE_DONTWAKE		((__u64)1<<0)
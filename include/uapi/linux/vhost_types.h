@@ -63,6 +63,13 @@ struct vhost_vring_worker {
 	unsigned int worker_id;
 };
 
+/*
+ * Pass as worker_id to VHOST_ATTACH_VRING_WORKER to let the kernel pick
+ * the least loaded of the device's workers, preferring one on the local
+ * NUMA node.  The result can be read back with VHOST_GET_VRING_WORKER.
+ */
+#define VHOST_VRING_WORKER_AUTO	((unsigned int)-1)
+
 /* no alignment requirement */
 struct vhost_iotlb_msg {
 	__u64 iova;
@@ -2,6 +2,7 @@
 #include <linux/init.h>
 #include <linux/async.h>
 #include <linux/fs.h>
+#include <linux/kthread.h>
 #include <linux/slab.h>
 #include <linux/types.h>
 #include <linux/fcntl.h>
@@ -481,6 +482,134 @@ static unsigned long my_inptr __initdata; /* index of next byte to be processed
 
 #include <linux/decompress/generic.h>
 
+/*
+ * Pipelined unpacking: the decompressor runs in the caller's context and
+ * copies every flushed chunk into a small ring, while a worker drains the
+ * ring into the cpio state machine and creates the rootfs entries.  Chunks
+ * are consumed strictly in order, so the resulting tree is identical to
+ * what the serial path produces; decompression and file creation merely
+ * overlap in time.
+ */
+#define INITRAMFS_PIPE_CHUNKS	16
+
+struct initramfs_chunk {
+	char		*buf;
+	unsigned long	size;	/* allocated bytes */
+	unsigned long	len;	/* valid bytes */
+};
+
+static struct initramfs_pipe {
+	struct initramfs_chunk	chunk[INITRAMFS_PIPE_CHUNKS];
+	unsigned int		head;	/* next chunk to fill */
+	unsigned int		tail;	/* next chunk to drain */
+	bool			eof;
+	bool			failed;
+	wait_queue_head_t	space_wait;
+	wait_queue_head_t	data_wait;
+	struct completion	done;
+} initramfs_pipe __initdata;
+
+static long __init initramfs_pipe_flush(void *bufv, unsigned long len)
+{
+	struct initramfs_pipe *pipe = &initramfs_pipe;
+	struct initramfs_chunk *c;
+
+	if (READ_ONCE(pipe->failed))
+		return -1;
+
+	wait_event(pipe->space_wait,
+		   pipe->head - READ_ONCE(pipe->tail) < INITRAMFS_PIPE_CHUNKS ||
+		   READ_ONCE(pipe->failed));
+	if (READ_ONCE(pipe->failed))
+		return -1;
+
+	c = &pipe->chunk[pipe->head % INITRAMFS_PIPE_CHUNKS];
+	if (c->size < len) {
+		kvfree(c->buf);
+		c->buf = kvmalloc(len, GFP_KERNEL);
+		if (!c->buf) {
+			c->size = 0;
+			WRITE_ONCE(pipe->failed, true);
+			wake_up(&pipe->data_wait);
+			return -1;
+		}
+		c->size = len;
+	}
+	memcpy(c->buf, bufv, len);
+	c->len = len;
+	/* Publish the chunk contents before moving the head index. */
+	smp_store_release(&pipe->head, pipe->head + 1);
+	wake_up(&pipe->data_wait);
+	return len;
+}
+
+static int __init initramfs_pipe_workfn(void *unused)
+{
+	struct initramfs_pipe *pipe = &initramfs_pipe;
+
+	for (;;) {
+		struct initramfs_chunk *c;
+
+		wait_event(pipe->data_wait,
+			   READ_ONCE(pipe->head) != pipe->tail ||
+			   READ_ONCE(pipe->eof) || READ_ONCE(pipe->failed));
+
+		if (READ_ONCE(pipe->failed))
+			break;
+		if (smp_load_acquire(&pipe->head) == pipe->tail) {
+			if (READ_ONCE(pipe->eof))
+				break;
+			continue;
+		}
+
+		c = &pipe->chunk[pipe->tail % INITRAMFS_PIPE_CHUNKS];
+		if (flush_buffer(c->buf, c->len) < 0)
+			WRITE_ONCE(pipe->failed, true);
+
+		smp_store_release(&pipe->tail, pipe->tail + 1);
+		wake_up(&pipe->space_wait);
+	}
+	complete(&pipe->done);
+	return 0;
+}
+
+static int __init initramfs_pipe_run(decompress_fn decompress, char *buf,
+				     unsigned long len)
+{
+	struct initramfs_pipe *pipe = &initramfs_pipe;
+	struct task_struct *worker;
+	int res;
+	int i;
+
+	pipe->head = pipe->tail = 0;
+	pipe->eof = false;
+	pipe->failed = false;
+	init_waitqueue_head(&pipe->space_wait);
+	init_waitqueue_head(&pipe->data_wait);
+	init_completion(&pipe->done);
+
+	worker = kthread_run(initramfs_pipe_workfn, NULL, "initramfs");
+	if (IS_ERR(worker))
+		return decompress(buf, len, NULL, flush_buffer, NULL,
+				  &my_inptr, error);
+
+	res = decompress(buf, len, NULL, initramfs_pipe_flush, NULL,
+			 &my_inptr, error);
+
+	if (res)
+		WRITE_ONCE(pipe->failed, true);
+	WRITE_ONCE(pipe->eof, true);
+	wake_up(&pipe->data_wait);
+	wait_for_completion(&pipe->done);
+
+	for (i = 0; i < INITRAMFS_PIPE_CHUNKS; i++) {
+		kvfree(pipe->chunk[i].buf);
+		pipe->chunk[i].buf = NULL;
+		pipe->chunk[i].size = 0;
+	}
+	return res;
+}
+
 static char * __init unpack_to_rootfs(char *buf, unsigned long len)
 {
 	long written;
@@ -517,8 +646,13 @@ static char * __init unpack_to_rootfs(char *buf, unsigned long len)
 		decompress = decompress_method(buf, len, &compress_name);
 		pr_debug("Detected %s compressed data\n", compress_name);
 		if (decompress) {
-			int res = decompress(buf, len, NULL, flush_buffer, NULL,
-				   &my_inptr, error);
+			int res;
+
+			if (num_online_cpus() > 1)
+				res = initramfs_pipe_run(decompress, buf, len);
+			else
+				res = decompress(buf, len, NULL, flush_buffer,
+						 NULL, &my_inptr, error);
 			if (res)
 				error("decompressor failed");
 		} else if (compress_name) {
@@ -1296,6 +1296,18 @@ static initcall_entry_t *initcall_levels[] __initdata = {
 	__initcall_end,
 };
 
+/* Ends of the per-level *_initcall_par() regions, see INIT_CALLS_LEVEL(). */
+static initcall_entry_t *initcall_par_ends[] __initdata = {
+	__initcall0_par_end,
+	__initcall1_par_end,
+	__initcall2_par_end,
+	__initcall3_par_end,
+	__initcall4_par_end,
+	__initcall5_par_end,
+	__initcall6_par_end,
+	__initcall7_par_end,
+};
+
 /* Keep these in sync with initcalls in include/linux/init.h */
 static const char *initcall_level_names[] __initdata = {
 	"pure",
@@ -1314,6 +1326,17 @@ static int __init ignore_unknown_bootoption(char *param, char *val,
 	return 0;
 }
 
+/*
+ * Parallel initcalls get their own domain so that waiting for them does
+ * not entangle them with unrelated async work such as device probing.
+ */
+static ASYNC_DOMAIN_EXCLUSIVE(initcall_par_domain);
+
+static void __init do_one_initcall_async(void *data, async_cookie_t cookie)
+{
+	do_one_initcall((initcall_t)data);
+}
+
 static void __init do_initcall_level(int level, char *command_line)
 {
 	initcall_entry_t *fn;
@@ -1325,8 +1348,23 @@ static void __init do_initcall_level(int level, char *command_line)
 		   NULL, ignore_unknown_bootoption);
 
 	trace_initcall_level(initcall_level_names[level]);
-	for (fn = initcall_levels[level]; fn < initcall_levels[level+1]; fn++)
+
+	/*
+	 * Initcalls annotated with the *_initcall_par() variants have no
+	 * ordering dependencies within their level. Kick them off first so
+	 * they overlap with each other and with the serial calls below;
+	 * the synchronization point guarantees they have all finished
+	 * before the next level starts.
+	 */
+	for (fn = initcall_levels[level]; fn < initcall_par_ends[level]; fn++)
+		async_schedule_domain(do_one_initcall_async,
+				      (void *)initcall_from_entry(fn),
+				      &initcall_par_domain);
+
+	for (; fn < initcall_levels[level+1]; fn++)
 		do_one_initcall(initcall_from_entry(fn));
+
+	async_synchronize_full_domain(&initcall_par_domain);
 }
 
 static void __init do_initcalls(void)
@@ -24,6 +24,7 @@ struct io_futex {
 	u32		futex_flags;
 	unsigned int	futex_nr;
 	bool		futexv_unqueued;
+	bool		futex_defer;
 };
 
 struct io_futex_data {
@@ -166,9 +167,24 @@ int io_futex_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 	struct io_futex *iof = io_kiocb_to_cmd(req, struct io_futex);
 	u32 flags;
 
-	if (unlikely(sqe->len || sqe->futex_flags || sqe->buf_index ||
-		     sqe->file_index))
+	u32 iou_flags;
+
+	if (unlikely(sqe->len || sqe->buf_index || sqe->file_index))
+		return -EINVAL;
+
+	iou_flags = READ_ONCE(sqe->futex_flags);
+	if (iou_flags & ~IORING_FUTEX_WAIT_DEFER)
 		return -EINVAL;
+	iof->futex_defer = iou_flags & IORING_FUTEX_WAIT_DEFER;
+	if (iof->futex_defer) {
+		/*
+		 * Lazy wake only means anything when completions are run off
+		 * the deferred task_work list, and only for the wait side.
+		 */
+		if (req->opcode != IORING_OP_FUTEX_WAIT ||
+		    !(req->ctx->flags & IORING_SETUP_DEFER_TASKRUN))
+			return -EINVAL;
+	}
 
 	iof->uaddr = u64_to_user_ptr(READ_ONCE(sqe->addr));
 	iof->futex_val = READ_ONCE(sqe->addr2);
@@ -242,13 +258,14 @@ static void io_futex_wake_fn(struct wake_q_head *wake_q, struct futex_q *q)
 {
 	struct io_futex_data *ifd = container_of(q, struct io_futex_data, q);
 	struct io_kiocb *req = ifd->req;
+	struct io_futex *iof = io_kiocb_to_cmd(req, struct io_futex);
 
 	if (unlikely(!__futex_wake_mark(q)))
 		return;
 
 	io_req_set_res(req, 0, 0);
 	req->io_task_work.func = io_futex_complete;
-	io_req_task_work_add(req);
+	__io_req_task_work_add(req, iof->futex_defer ? IOU_F_TWQ_LAZY_WAKE : 0);
 }
 
 static struct io_futex_data *io_alloc_ifd(struct io_ring_ctx *ctx)
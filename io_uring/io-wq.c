@@ -167,6 +167,16 @@ static inline struct io_wq_acct *io_wq_get_acct(struct io_worker *worker)
 	return io_get_acct(worker->wq, test_bit(IO_WORKER_F_BOUND, &worker->flags));
 }
 
+/*
+ * Return the acct a worker can steal work from, ie the one it doesn't
+ * naturally service.
+ */
+static inline struct io_wq_acct *io_get_steal_acct(struct io_wq *wq,
+						   struct io_wq_acct *acct)
+{
+	return &wq->acct[(acct->index + 1) % IO_WQ_ACCT_NR];
+}
+
 static void io_worker_ref_put(struct io_wq *wq)
 {
 	if (atomic_dec_and_test(&wq->worker_refs))
@@ -270,8 +280,10 @@ static bool io_wq_activate_free_worker(struct io_wq *wq,
 					struct io_wq_acct *acct)
 	__must_hold(RCU)
 {
+	struct io_worker *stealer = NULL;
 	struct hlist_nulls_node *n;
 	struct io_worker *worker;
+	bool ret = false;
 
 	/*
 	 * Iterate free_list and see if we can find an idle worker to
@@ -282,6 +294,16 @@ static bool io_wq_activate_free_worker(struct io_wq *wq,
 		if (!io_worker_get(worker))
 			continue;
 		if (io_wq_get_acct(worker) != acct) {
+			/*
+			 * Remember the first idle worker belonging to the
+			 * sibling acct. If no worker of the right acct is
+			 * free, waking it lets it steal this work rather
+			 * than leaving it queued behind an empty free list.
+			 */
+			if (!stealer) {
+				stealer = worker;
+				continue;
+			}
 			io_worker_release(worker);
 			continue;
 		}
@@ -292,10 +314,18 @@ static bool io_wq_activate_free_worker(struct io_wq *wq,
 		 */
 		wake_up_process(worker->task);
 		io_worker_release(worker);
-		return true;
+		ret = true;
+		break;
 	}
 
-	return false;
+	if (stealer) {
+		if (!ret) {
+			wake_up_process(stealer->task);
+			ret = true;
+		}
+		io_worker_release(stealer);
+	}
+	return ret;
 }
 
 /*
@@ -628,6 +658,7 @@ static int io_wq_worker(void *data)
 {
 	struct io_worker *worker = data;
 	struct io_wq_acct *acct = io_wq_get_acct(worker);
+	struct io_wq_acct *steal_acct = io_get_steal_acct(worker->wq, acct);
 	struct io_wq *wq = worker->wq;
 	bool exit_mask = false, last_timeout = false;
 	char buf[TASK_COMM_LEN];
@@ -650,6 +681,17 @@ static int io_wq_worker(void *data)
 		while (io_acct_run_queue(acct))
 			io_worker_handle_work(acct, worker);
 
+		/*
+		 * Our own queue is drained, but the sibling acct may have
+		 * work pending with all of its workers busy or blocked.
+		 * Steal from it before going idle, then recheck our own
+		 * queue in case work arrived while we were busy stealing.
+		 */
+		if (io_acct_run_queue(steal_acct)) {
+			io_worker_handle_work(steal_acct, worker);
+			continue;
+		}
+
 		raw_spin_lock(&wq->lock);
 		/*
 		 * Last sleep timed out. Exit if we're not the last worker,
@@ -88,12 +88,12 @@ void __io_put_kbuf(struct io_kiocb *req, unsigned issue_flags)
 		struct io_ring_ctx *ctx = req->ctx;
 
 		spin_lock(&ctx->completion_lock);
-		__io_put_kbuf_list(req, &ctx->io_buffers_comp);
+		__io_put_kbuf_list(req, 0, &ctx->io_buffers_comp);
 		spin_unlock(&ctx->completion_lock);
 	} else {
 		lockdep_assert_held(&req->ctx->uring_lock);
 
-		__io_put_kbuf_list(req, &req->ctx->io_buffers_cache);
+		__io_put_kbuf_list(req, 0, &req->ctx->io_buffers_cache);
 	}
 }
 
@@ -138,6 +138,41 @@ static struct io_uring_buf *io_ring_head_to_buf(struct io_uring_buf_ring *br,
 	return &br->bufs[head & mask];
 }
 
+/*
+ * Commit consumption of @len bytes from the current head buffer(s). For a
+ * normal ring this just bumps the head by @nr. For an incrementally consumed
+ * ring, the head buffer is trimmed by @len and only retired once it's fully
+ * used up. Returns true if the buffer is done with and ownership is back
+ * with the application, false if the kernel retains (part of) it.
+ */
+bool io_kbuf_commit(struct io_kiocb *req,
+		    struct io_buffer_list *bl, int len, int nr)
+{
+	if (unlikely(!(req->flags & REQ_F_BUFFERS_COMMIT)))
+		return true;
+
+	req->flags &= ~REQ_F_BUFFERS_COMMIT;
+
+	if (unlikely(len < 0))
+		return true;
+
+	if (bl->is_inc) {
+		struct io_uring_buf *buf;
+
+		buf = io_ring_head_to_buf(bl->buf_ring, bl->head, bl->mask);
+		if (WARN_ON_ONCE(len > buf->len))
+			len = buf->len;
+		buf->len -= len;
+		if (buf->len) {
+			buf->addr += len;
+			return false;
+		}
+	}
+
+	bl->head += nr;
+	return true;
+}
+
 static void __user *io_ring_buffer_select(struct io_kiocb *req, size_t *len,
 					  struct io_buffer_list *bl,
 					  unsigned int issue_flags)
@@ -171,9 +206,8 @@ static void __user *io_ring_buffer_select(struct io_kiocb *req, size_t *len,
 		 * the transfer completes (or if we get -EAGAIN and must poll of
 		 * retry).
 		 */
-		req->flags &= ~REQ_F_BUFFERS_COMMIT;
+		io_kbuf_commit(req, bl, *len, 1);
 		req->buf_list = NULL;
-		bl->head++;
 	}
 	return u64_to_user_ptr(buf->addr);
 }
@@ -210,6 +244,13 @@ static int io_ring_buffers_peek(struct io_kiocb *req, struct buf_sel_arg *arg,
 	__u16 nr_avail, tail, head;
 	struct io_uring_buf *buf;
 
+	/*
+	 * Multiple buffer peeks don't mix with incremental consumption, the
+	 * bid/length bookkeeping only works on whole buffers.
+	 */
+	if (unlikely(bl->is_inc))
+		return -EINVAL;
+
 	tail = smp_load_acquire(&br->tail);
 	head = bl->head;
 	nr_avail = min_t(__u16, tail - head, UIO_MAXIOV);
@@ -353,6 +394,7 @@ static int __io_remove_buffers(struct io_ring_ctx *ctx,
 		/* make sure it's seen as empty */
 		INIT_LIST_HEAD(&bl->buf_list);
 		bl->is_buf_ring = 0;
+		bl->is_inc = 0;
 		return i;
 	}
 
@@ -678,7 +720,7 @@ int io_register_pbuf_ring(struct io_ring_ctx *ctx, void __user *arg)
 
 	if (reg.resv[0] || reg.resv[1] || reg.resv[2])
 		return -EINVAL;
-	if (reg.flags & ~IOU_PBUF_RING_MMAP)
+	if (reg.flags & ~(IOU_PBUF_RING_MMAP | IOU_PBUF_RING_INC))
 		return -EINVAL;
 	if (!(reg.flags & IOU_PBUF_RING_MMAP)) {
 		if (!reg.ring_addr)
@@ -716,6 +758,8 @@ int io_register_pbuf_ring(struct io_ring_ctx *ctx, void __user *arg)
 	if (!ret) {
 		bl->nr_entries = reg.ring_entries;
 		bl->mask = reg.ring_entries - 1;
+		if (reg.flags & IOU_PBUF_RING_INC)
+			bl->is_inc = 1;
 
 		io_buffer_add_list(ctx, bl, reg.bgid);
 		return 0;
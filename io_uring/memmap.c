@@ -35,24 +35,50 @@ static void *io_mem_alloc_compound(struct page **pages, int nr_pages,
 	return page_address(page);
 }
 
-static void *io_mem_alloc_single(struct page **pages, int nr_pages, size_t size,
-				 gfp_t gfp)
+static void *io_mem_alloc_chunked(struct page **pages, int nr_pages,
+				  size_t size, gfp_t gfp)
 {
+	int i, j, nr, order;
 	void *ret;
-	int i;
 
-	for (i = 0; i < nr_pages; i++) {
-		pages[i] = alloc_page(gfp);
-		if (!pages[i])
+	/*
+	 * Either the ring was too big for one compound allocation, or that
+	 * allocation failed. Piece it together from huge page sized chunks
+	 * instead, so that large CQ/SQ rings still cover with a handful of
+	 * TLB entries, and drop the chunk order as failures dictate - worst
+	 * case this degrades to the plain order-0 fill it replaces.
+	 */
+	order = min(get_order(size), MAX_PAGE_ORDER);
+#ifdef CONFIG_TRANSPARENT_HUGEPAGE
+	order = min(order, HPAGE_PMD_ORDER);
+#endif
+	for (i = 0; i < nr_pages; i += nr) {
+		struct page *page = NULL;
+
+		while (order && (1 << order) > nr_pages - i)
+			order--;
+		do {
+			page = alloc_pages(gfp | (order ? __GFP_COMP : 0), order);
+			if (page)
+				break;
+		} while (order--);
+		if (!page)
 			goto err;
+		nr = 1 << order;
+		for (j = 0; j < nr; j++)
+			pages[i + j] = page + j;
 	}
 
 	ret = vmap(pages, nr_pages, VM_MAP, PAGE_KERNEL);
 	if (ret)
 		return ret;
 err:
-	while (i--)
-		put_page(pages[i]);
+	for (j = 0; j < i; j += nr) {
+		struct folio *folio = page_folio(pages[j]);
+
+		nr = folio_nr_pages(folio);
+		folio_put(folio);
+	}
 	return ERR_PTR(-ENOMEM);
 }
 
@@ -73,7 +99,7 @@ void *io_pages_map(struct page ***out_pages, unsigned short *npages,
 	if (!IS_ERR(ret))
 		goto done;
 
-	ret = io_mem_alloc_single(pages, nr_pages, size, gfp);
+	ret = io_mem_alloc_chunked(pages, nr_pages, size, gfp);
 	if (!IS_ERR(ret)) {
 done:
 		*out_pages = pages;
@@ -90,28 +116,33 @@ done:
 void io_pages_unmap(void *ptr, struct page ***pages, unsigned short *npages,
 		    bool put_pages)
 {
-	bool do_vunmap = false;
-
 	if (!ptr)
 		return;
 
+	/*
+	 * The chunked path always vmaps, even when a single compound chunk
+	 * ends up covering the whole ring, so ask the address itself rather
+	 * than inferring from page structure.  Unmap before dropping the
+	 * page references.
+	 */
+	if (is_vmalloc_addr(ptr))
+		vunmap(ptr);
+
 	if (put_pages && *npages) {
 		struct page **to_free = *pages;
 		int i;
 
 		/*
-		 * Only did vmap for the non-compound multiple page case.
-		 * For the compound page, we just need to put the head.
+		 * Put each folio exactly once, however many pages of the
+		 * array it accounts for.
 		 */
-		if (PageCompound(to_free[0]))
-			*npages = 1;
-		else if (*npages > 1)
-			do_vunmap = true;
-		for (i = 0; i < *npages; i++)
-			put_page(to_free[i]);
+		for (i = 0; i < *npages; ) {
+			struct folio *folio = page_folio(to_free[i]);
+
+			folio_put(folio);
+			i += folio_nr_pages(folio);
+		}
 	}
-	if (do_vunmap)
-		vunmap(ptr);
 	kvfree(*pages);
 	*pages = NULL;
 	*npages = 0;
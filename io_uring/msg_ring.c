@@ -20,7 +20,10 @@
 
 struct io_msg {
 	struct file			*file;
-	struct file			*src_file;
+	union {
+		struct file		*src_file;
+		struct io_mapped_ubuf	*src_buf;
+	};
 	struct callback_head		tw;
 	u64 user_data;
 	u32 len;
@@ -59,6 +62,12 @@ void io_msg_ring_cleanup(struct io_kiocb *req)
 {
 	struct io_msg *msg = io_kiocb_to_cmd(req, struct io_msg);
 
+	if (msg->cmd == IORING_MSG_SEND_BUF) {
+		if (!WARN_ON_ONCE(!msg->src_buf))
+			io_buffer_unmap(req->ctx, &msg->src_buf);
+		return;
+	}
+
 	if (WARN_ON_ONCE(!msg->src_file))
 		return;
 
@@ -218,6 +227,78 @@ static void io_msg_tw_fd_complete(struct callback_head *head)
 	io_req_queue_tw_complete(req, ret);
 }
 
+static int io_msg_install_buf(struct io_kiocb *req, unsigned int issue_flags)
+{
+	struct io_ring_ctx *target_ctx = req->file->private_data;
+	struct io_msg *msg = io_kiocb_to_cmd(req, struct io_msg);
+	int ret;
+
+	if (unlikely(io_double_lock_ctx(target_ctx, issue_flags)))
+		return -EAGAIN;
+
+	ret = io_mapped_buf_install(target_ctx, msg->src_buf, msg->dst_fd);
+	if (ret < 0)
+		goto out_unlock;
+
+	msg->src_buf = NULL;
+	req->flags &= ~REQ_F_NEED_CLEANUP;
+
+	if (msg->flags & IORING_MSG_RING_CQE_SKIP)
+		goto out_unlock;
+	/*
+	 * Same caveat as for fd passing: on -EOVERFLOW the target owns the
+	 * buffer but never saw the CQE announcing it, and the sender has to
+	 * follow up with another IORING_OP_MSG_RING.
+	 */
+	if (!io_post_aux_cqe(target_ctx, msg->user_data, msg->len, 0))
+		ret = -EOVERFLOW;
+out_unlock:
+	io_double_unlock_ctx(target_ctx);
+	return ret;
+}
+
+static void io_msg_tw_buf_complete(struct callback_head *head)
+{
+	struct io_msg *msg = container_of(head, struct io_msg, tw);
+	struct io_kiocb *req = cmd_to_io_kiocb(msg);
+	int ret = -EOWNERDEAD;
+
+	if (!(current->flags & PF_EXITING))
+		ret = io_msg_install_buf(req, IO_URING_F_UNLOCKED);
+	if (ret < 0)
+		req_set_fail(req);
+	io_req_queue_tw_complete(req, ret);
+}
+
+static int io_msg_send_buf(struct io_kiocb *req, unsigned int issue_flags)
+{
+	struct io_ring_ctx *target_ctx = req->file->private_data;
+	struct io_msg *msg = io_kiocb_to_cmd(req, struct io_msg);
+	struct io_ring_ctx *ctx = req->ctx;
+
+	if (msg->flags & IORING_MSG_RING_FLAGS_PASS)
+		return -EINVAL;
+	if (target_ctx == ctx)
+		return -EINVAL;
+	if (target_ctx->flags & IORING_SETUP_R_DISABLED)
+		return -EBADFD;
+	if (!msg->src_buf) {
+		struct io_mapped_ubuf *imu;
+
+		io_ring_submit_lock(ctx, issue_flags);
+		imu = io_mapped_buf_get(ctx, msg->src_fd);
+		io_ring_submit_unlock(ctx, issue_flags);
+		if (!imu)
+			return -EFAULT;
+		msg->src_buf = imu;
+		req->flags |= REQ_F_NEED_CLEANUP;
+	}
+
+	if (io_msg_need_remote(target_ctx))
+		return io_msg_exec_remote(req, io_msg_tw_buf_complete);
+	return io_msg_install_buf(req, issue_flags);
+}
+
 static int io_msg_send_fd(struct io_kiocb *req, unsigned int issue_flags)
 {
 	struct io_ring_ctx *target_ctx = req->file->private_data;
@@ -280,6 +361,9 @@ int io_msg_ring(struct io_kiocb *req, unsigned int issue_flags)
 	case IORING_MSG_SEND_FD:
 		ret = io_msg_send_fd(req, issue_flags);
 		break;
+	case IORING_MSG_SEND_BUF:
+		ret = io_msg_send_buf(req, issue_flags);
+		break;
 	default:
 		ret = -EINVAL;
 		break;
@@ -8,6 +8,11 @@
 /* Timeout for cleanout of stale entries. */
 #define NAPI_TIMEOUT		(60 * SEC_CONVERSION)
 
+/* Consecutive fruitless busy loops before the poll budget is shrunk. */
+#define NAPI_ADAPT_MISS_THRESHOLD	4
+/* Smallest poll budget we decay to, in usec. Close enough to IRQ mode. */
+#define NAPI_ADAPT_MIN_POLL_TO		1
+
 struct io_napi_entry {
 	unsigned int		napi_id;
 	struct list_head	list;
@@ -151,6 +156,29 @@ static bool __io_napi_do_busy_loop(struct io_ring_ctx *ctx,
 	return is_stale;
 }
 
+/*
+ * Grow or shrink the busy poll budget based on whether recent busy loops
+ * actually produced completions. A hit doubles the budget back towards the
+ * configured maximum, while repeated fruitless loops decay it towards
+ * NAPI_ADAPT_MIN_POLL_TO so an idle ring effectively drops back to IRQ
+ * driven wakeups. Only ever called by the task owning the ring, so plain
+ * updates are fine.
+ */
+static void io_napi_adapt_poll_budget(struct io_ring_ctx *ctx, bool hit)
+{
+	unsigned int cur = READ_ONCE(ctx->napi_cur_busy_poll_to);
+	unsigned int max = READ_ONCE(ctx->napi_busy_poll_to);
+
+	if (hit) {
+		ctx->napi_poll_misses = 0;
+		cur = min(max(cur, 1U) * 2, max);
+	} else if (++ctx->napi_poll_misses >= NAPI_ADAPT_MISS_THRESHOLD) {
+		ctx->napi_poll_misses = 0;
+		cur = max(cur / 2, (unsigned int)NAPI_ADAPT_MIN_POLL_TO);
+	}
+	WRITE_ONCE(ctx->napi_cur_busy_poll_to, cur);
+}
+
 static void io_napi_blocking_busy_loop(struct io_ring_ctx *ctx,
 				       struct io_wait_queue *iowq)
 {
@@ -170,6 +198,7 @@ static void io_napi_blocking_busy_loop(struct io_ring_ctx *ctx,
 	} while (!io_napi_busy_loop_should_end(iowq, start_time) && !loop_end_arg);
 	rcu_read_unlock();
 
+	io_napi_adapt_poll_budget(ctx, io_should_wake(iowq) || io_has_work(ctx));
 	io_napi_remove_stale(ctx, is_stale);
 }
 
@@ -185,6 +214,8 @@ void io_napi_init(struct io_ring_ctx *ctx)
 	spin_lock_init(&ctx->napi_lock);
 	ctx->napi_prefer_busy_poll = false;
 	ctx->napi_busy_poll_to = READ_ONCE(sysctl_net_busy_poll);
+	ctx->napi_cur_busy_poll_to = ctx->napi_busy_poll_to;
+	ctx->napi_poll_misses = 0;
 }
 
 /*
@@ -231,6 +262,8 @@ int io_register_napi(struct io_ring_ctx *ctx, void __user *arg)
 		return -EFAULT;
 
 	WRITE_ONCE(ctx->napi_busy_poll_to, napi.busy_poll_to);
+	WRITE_ONCE(ctx->napi_cur_busy_poll_to, napi.busy_poll_to);
+	ctx->napi_poll_misses = 0;
 	WRITE_ONCE(ctx->napi_prefer_busy_poll, !!napi.prefer_busy_poll);
 	WRITE_ONCE(ctx->napi_enabled, true);
 	return 0;
@@ -255,6 +288,7 @@ int io_unregister_napi(struct io_ring_ctx *ctx, void __user *arg)
 		return -EFAULT;
 
 	WRITE_ONCE(ctx->napi_busy_poll_to, 0);
+	WRITE_ONCE(ctx->napi_cur_busy_poll_to, 0);
 	WRITE_ONCE(ctx->napi_prefer_busy_poll, false);
 	WRITE_ONCE(ctx->napi_enabled, false);
 	return 0;
@@ -271,7 +305,7 @@ int io_unregister_napi(struct io_ring_ctx *ctx, void __user *arg)
 void __io_napi_adjust_timeout(struct io_ring_ctx *ctx, struct io_wait_queue *iowq,
 			      struct timespec64 *ts)
 {
-	unsigned int poll_to = READ_ONCE(ctx->napi_busy_poll_to);
+	unsigned int poll_to = READ_ONCE(ctx->napi_cur_busy_poll_to);
 
 	if (ts) {
 		struct timespec64 poll_to_ts = ns_to_timespec64(1000 * (s64)poll_to);
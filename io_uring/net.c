@@ -489,11 +489,12 @@ static inline bool io_send_finish(struct io_kiocb *req, int *ret,
 	unsigned int cflags;
 
 	if (!(sr->flags & IORING_RECVSEND_BUNDLE)) {
-		cflags = io_put_kbuf(req, issue_flags);
+		cflags = io_put_kbuf(req, *ret, issue_flags);
 		goto finish;
 	}
 
-	cflags = io_put_kbufs(req, io_bundle_nbufs(kmsg, *ret), issue_flags);
+	cflags = io_put_kbufs(req, *ret, io_bundle_nbufs(kmsg, *ret),
+			      issue_flags);
 
 	if (bundle_finished || req->flags & REQ_F_BL_EMPTY)
 		goto finish;
@@ -735,7 +736,13 @@ static int io_recvmsg_prep_setup(struct io_kiocb *req)
 		kmsg->msg.msg_iocb = NULL;
 		kmsg->msg.msg_ubuf = NULL;
 
-		if (!io_do_buffer_select(req)) {
+		if (sr->flags & IORING_RECVSEND_FIXED_BUF) {
+			ret = io_import_fixed(ITER_DEST, &kmsg->msg.msg_iter,
+					      req->imu, (u64)(uintptr_t)sr->buf,
+					      sr->len);
+			if (unlikely(ret))
+				return ret;
+		} else if (!io_do_buffer_select(req)) {
 			ret = import_ubuf(ITER_DEST, sr->buf, sr->len,
 					  &kmsg->msg.msg_iter);
 			if (unlikely(ret))
@@ -751,7 +758,7 @@ static int io_recvmsg_prep_setup(struct io_kiocb *req)
 }
 
 #define RECVMSG_FLAGS (IORING_RECVSEND_POLL_FIRST | IORING_RECV_MULTISHOT | \
-			IORING_RECVSEND_BUNDLE)
+			IORING_RECVSEND_BUNDLE | IORING_RECVSEND_FIXED_BUF)
 
 int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 {
@@ -796,6 +803,31 @@ int io_recvmsg_prep(struct io_kiocb *req, const struct io_uring_sqe *sqe)
 	if (sr->flags & IORING_RECVSEND_BUNDLE) {
 		if (req->opcode == IORING_OP_RECVMSG)
 			return -EINVAL;
+		if (sr->flags & IORING_RECVSEND_FIXED_BUF)
+			return -EINVAL;
+	}
+	if (sr->flags & IORING_RECVSEND_FIXED_BUF) {
+		struct io_ring_ctx *ctx = req->ctx;
+		unsigned idx = READ_ONCE(sqe->buf_index);
+
+		/*
+		 * Receiving into a registered buffer avoids the per-issue
+		 * import and pinning of user pages. It's a single shot
+		 * request only - re-arming would scribble over data the
+		 * application hasn't consumed yet - and the destination is
+		 * fixed, so provided buffer selection makes no sense here.
+		 */
+		if (req->opcode == IORING_OP_RECVMSG)
+			return -EINVAL;
+		if (req->flags & REQ_F_BUFFER_SELECT)
+			return -EINVAL;
+		if (sr->flags & IORING_RECV_MULTISHOT)
+			return -EINVAL;
+		if (unlikely(idx >= ctx->nr_user_bufs))
+			return -EFAULT;
+		idx = array_index_nospec(idx, ctx->nr_user_bufs);
+		req->imu = READ_ONCE(ctx->user_bufs[idx]);
+		io_req_set_rsrc_node(req, ctx, 0);
 	}
 
 #ifdef CONFIG_COMPAT
@@ -820,10 +852,10 @@ static inline bool io_recv_finish(struct io_kiocb *req, int *ret,
 	unsigned int cflags;
 
 	if (sr->flags & IORING_RECVSEND_BUNDLE)
-		cflags = io_put_kbufs(req, io_bundle_nbufs(kmsg, *ret),
+		cflags = io_put_kbufs(req, *ret, io_bundle_nbufs(kmsg, *ret),
 				      issue_flags);
 	else
-		cflags = io_put_kbuf(req, issue_flags);
+		cflags = io_put_kbuf(req, *ret, issue_flags);
 
 	if (kmsg->msg.msg_inq > 0)
 		cflags |= IORING_CQE_F_SOCK_NONEMPTY;
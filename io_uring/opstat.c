@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Optional per-opcode submission-to-completion latency histograms,
+ * registered per ring and exported through fdinfo.
+ */
+#include <linux/kernel.h>
+#include <linux/errno.h>
+#include <linux/percpu.h>
+#include <linux/slab.h>
+#include <linux/seq_file.h>
+#include <linux/io_uring.h>
+
+#include <uapi/linux/io_uring.h>
+
+#include "io_uring.h"
+#include "opstat.h"
+
+DEFINE_STATIC_KEY_FALSE(io_opstat_key);
+
+void __io_opstat_start(struct io_kiocb *req)
+{
+	if (READ_ONCE(req->ctx->opstat_enabled))
+		req->opstat_ts = ktime_get_ns();
+}
+
+void __io_opstat_account(struct io_kiocb *req)
+{
+	struct io_opstat __percpu *stat = req->ctx->opstat;
+	u64 delta;
+	int bucket;
+
+	if (!stat || !req->opstat_ts)
+		return;
+
+	/*
+	 * A request that was in flight when stats got enabled can carry a
+	 * stale stamp from an earlier ring user of this req. Those few
+	 * samples land in the top bucket and wash out immediately.
+	 */
+	delta = ktime_get_ns() - req->opstat_ts;
+	req->opstat_ts = 0;
+	bucket = delta ? min(ilog2(delta), IO_OPSTAT_BUCKETS - 1) : 0;
+	this_cpu_inc(stat->op[req->opcode].nr);
+	this_cpu_inc(stat->op[req->opcode].buckets[bucket]);
+}
+
+int io_register_opstat(struct io_ring_ctx *ctx)
+{
+	if (ctx->opstat_enabled)
+		return -EBUSY;
+	if (!ctx->opstat) {
+		ctx->opstat = alloc_percpu(struct io_opstat);
+		if (!ctx->opstat)
+			return -ENOMEM;
+	}
+	WRITE_ONCE(ctx->opstat_enabled, true);
+	static_branch_inc(&io_opstat_key);
+	return 0;
+}
+
+int io_unregister_opstat(struct io_ring_ctx *ctx)
+{
+	if (!ctx->opstat_enabled)
+		return -ENOENT;
+	/*
+	 * Only stop sampling here. Completions for requests already in
+	 * flight may still account into ->opstat, so the memory stays
+	 * around until the ring itself goes away.
+	 */
+	WRITE_ONCE(ctx->opstat_enabled, false);
+	static_branch_dec(&io_opstat_key);
+	return 0;
+}
+
+void io_opstat_free(struct io_ring_ctx *ctx)
+{
+	if (!ctx->opstat)
+		return;
+	if (ctx->opstat_enabled) {
+		ctx->opstat_enabled = false;
+		static_branch_dec(&io_opstat_key);
+	}
+	free_percpu(ctx->opstat);
+	ctx->opstat = NULL;
+}
+
+/*
+ * Summed across CPUs without stopping writers; fdinfo output is best
+ * effort, same as the rest of the stats shown there.
+ */
+__cold void io_opstat_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m)
+{
+	struct io_opstat __percpu *stat = ctx->opstat;
+	int op, cpu, i;
+
+	if (!stat)
+		return;
+
+	seq_puts(m, "OpStats:\topcode\tcount\tp50_ns\tp99_ns\n");
+	for (op = 0; op < IORING_OP_LAST; op++) {
+		u64 buckets[IO_OPSTAT_BUCKETS] = { };
+		u64 nr = 0, sum = 0, p50 = 0, p99 = 0;
+
+		for_each_possible_cpu(cpu) {
+			struct io_opstat_op *pos = &per_cpu_ptr(stat, cpu)->op[op];
+
+			nr += pos->nr;
+			for (i = 0; i < IO_OPSTAT_BUCKETS; i++)
+				buckets[i] += pos->buckets[i];
+		}
+		if (!nr)
+			continue;
+
+		/* report the upper edge of the bucket holding the percentile */
+		for (i = 0; i < IO_OPSTAT_BUCKETS; i++) {
+			sum += buckets[i];
+			if (!p50 && sum * 2 >= nr)
+				p50 = 2ULL << i;
+			if (!p99 && sum * 100 >= nr * 99)
+				p99 = 2ULL << i;
+		}
+		seq_printf(m, "\t%s\t%llu\t%llu\t%llu\n",
+			   io_uring_get_opcode(op), nr, p50, p99);
+	}
+}
@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: GPL-2.0
+#ifndef IOU_OPSTAT_H
+#define IOU_OPSTAT_H
+
+#include <linux/jump_label.h>
+
+/*
+ * log2 nsec buckets. The final bucket collects everything from ~2 seconds
+ * upwards, which is well past any latency worth bucketing precisely.
+ */
+#define IO_OPSTAT_BUCKETS	32
+
+struct io_opstat_op {
+	u64 nr;
+	u64 buckets[IO_OPSTAT_BUCKETS];
+};
+
+struct io_opstat {
+	struct io_opstat_op op[IORING_OP_LAST];
+};
+
+DECLARE_STATIC_KEY_FALSE(io_opstat_key);
+
+void __io_opstat_start(struct io_kiocb *req);
+void __io_opstat_account(struct io_kiocb *req);
+int io_register_opstat(struct io_ring_ctx *ctx);
+int io_unregister_opstat(struct io_ring_ctx *ctx);
+void io_opstat_free(struct io_ring_ctx *ctx);
+void io_opstat_show_fdinfo(struct io_ring_ctx *ctx, struct seq_file *m);
+
+/*
+ * Hot path hooks. Both collapse to a single patched-out branch unless at
+ * least one ring in the system has op stats registered.
+ */
+static inline void io_opstat_start(struct io_kiocb *req)
+{
+	if (static_branch_unlikely(&io_opstat_key))
+		__io_opstat_start(req);
+}
+
+static inline void io_opstat_account(struct io_kiocb *req)
+{
+	if (static_branch_unlikely(&io_opstat_key))
+		__io_opstat_account(req);
+}
+
+#endif
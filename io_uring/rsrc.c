@@ -134,12 +134,12 @@ static int io_buffer_validate(struct iovec *iov)
 	return 0;
 }
 
-static void io_buffer_unmap(struct io_ring_ctx *ctx, struct io_mapped_ubuf **slot)
+void io_buffer_unmap(struct io_ring_ctx *ctx, struct io_mapped_ubuf **slot)
 {
 	struct io_mapped_ubuf *imu = *slot;
 	unsigned int i;
 
-	if (imu != &dummy_ubuf) {
+	if (imu != &dummy_ubuf && refcount_dec_and_test(&imu->refs)) {
 		for (i = 0; i < imu->nr_bvecs; i++)
 			unpin_user_page(imu->bvec[i].bv_page);
 		if (imu->acct_pages)
@@ -149,6 +149,53 @@ static void io_buffer_unmap(struct io_ring_ctx *ctx, struct io_mapped_ubuf **slo
 	*slot = NULL;
 }
 
+/*
+ * Take a reference on the buffer at @idx in @ctx's table, for loaning it to
+ * another ring. The caller owns the returned reference.
+ */
+struct io_mapped_ubuf *io_mapped_buf_get(struct io_ring_ctx *ctx,
+					 unsigned int idx)
+{
+	struct io_mapped_ubuf *imu;
+
+	lockdep_assert_held(&ctx->uring_lock);
+
+	if (idx >= ctx->nr_user_bufs)
+		return NULL;
+	idx = array_index_nospec(idx, ctx->nr_user_bufs);
+	imu = ctx->user_bufs[idx];
+	if (imu == &dummy_ubuf)
+		return NULL;
+	refcount_inc(&imu->refs);
+	return imu;
+}
+
+/*
+ * Install a loaned buffer into @ctx's table at @idx, consuming the caller's
+ * reference on success. Whatever occupied the slot is put through the usual
+ * deferred rsrc teardown.
+ */
+int io_mapped_buf_install(struct io_ring_ctx *ctx, struct io_mapped_ubuf *imu,
+			  unsigned int idx)
+{
+	int ret;
+
+	lockdep_assert_held(&ctx->uring_lock);
+
+	if (!ctx->buf_data || idx >= ctx->nr_user_bufs)
+		return -EINVAL;
+	idx = array_index_nospec(idx, ctx->nr_user_bufs);
+	if (ctx->user_bufs[idx] != &dummy_ubuf) {
+		ret = io_queue_rsrc_removal(ctx->buf_data, idx,
+					    ctx->user_bufs[idx]);
+		if (unlikely(ret))
+			return ret;
+	}
+	ctx->user_bufs[idx] = imu;
+	*io_get_tag_slot(ctx->buf_data, idx) = 0;
+	return 0;
+}
+
 static void io_rsrc_put_work(struct io_rsrc_node *node)
 {
 	struct io_rsrc_put *prsrc = &node->item;
@@ -871,16 +918,113 @@ static int io_buffer_account_pin(struct io_ring_ctx *ctx, struct page **pages,
 	return ret;
 }
 
+/*
+ * Check if the pages are all part of large folios that can each be
+ * represented by a single bvec entry: pages must be consecutive inside
+ * every folio, and all folios but the head and tail must be fully
+ * covered and of the same order. On success, fill in @data describing
+ * the folio geometry.
+ */
+static bool io_sqe_buffer_try_coalesce(struct page **page_array, int nr_pages,
+				       struct io_imu_folio_data *data)
+{
+	struct folio *folio = page_folio(page_array[0]);
+	unsigned int count = 1, nr_folios = 1;
+	int i;
+
+	if (nr_pages <= 1)
+		return false;
+
+	data->nr_pages_mid = folio_nr_pages(folio);
+	if (data->nr_pages_mid == 1)
+		return false;
+
+	data->folio_shift = folio_shift(folio);
+	data->first_folio_page_idx = folio_page_idx(folio, page_array[0]);
+	for (i = 1; i < nr_pages; i++) {
+		if (page_folio(page_array[i]) == folio &&
+		    page_array[i] == page_array[i - 1] + 1) {
+			count++;
+			continue;
+		}
+
+		if (nr_folios == 1) {
+			/* head folio must reach its last page */
+			if (folio_page_idx(folio, page_array[i - 1]) !=
+			    data->nr_pages_mid - 1)
+				return false;
+			data->nr_pages_head = count;
+		} else if (count != data->nr_pages_mid) {
+			return false;
+		}
+
+		folio = page_folio(page_array[i]);
+		if (folio_size(folio) != (1UL << data->folio_shift) ||
+		    folio_page_idx(folio, page_array[i]) != 0)
+			return false;
+
+		count = 1;
+		nr_folios++;
+	}
+	if (nr_folios == 1)
+		data->nr_pages_head = count;
+
+	data->nr_folios = nr_folios;
+	return true;
+}
+
+/*
+ * Collapse the pinned page array down to one entry per folio, dropping
+ * the extra pins. The pages are bound to the folio, so dropping all but
+ * one reference per folio doesn't actually unpin them; the remaining
+ * reference is put down by io_buffer_unmap().
+ */
+static bool io_sqe_buffer_coalesce(struct page ***pages, int *nr_pages,
+				   struct io_imu_folio_data *data)
+{
+	struct page **page_array = *pages, **new_array;
+	int nr_pages_left = *nr_pages, i, j;
+
+	/* Store head pages only */
+	new_array = kvmalloc_array(data->nr_folios, sizeof(struct page *),
+				   GFP_KERNEL);
+	if (!new_array)
+		return false;
+
+	new_array[0] = compound_head(page_array[0]);
+	if (data->nr_pages_head > 1)
+		unpin_user_pages(&page_array[1], data->nr_pages_head - 1);
+
+	j = data->nr_pages_head;
+	nr_pages_left -= data->nr_pages_head;
+	for (i = 1; i < data->nr_folios; i++) {
+		unsigned int nr_unpin;
+
+		new_array[i] = page_array[j];
+		nr_unpin = min_t(unsigned int, nr_pages_left - 1,
+				 data->nr_pages_mid - 1);
+		if (nr_unpin)
+			unpin_user_pages(&page_array[j + 1], nr_unpin);
+		j += data->nr_pages_mid;
+		nr_pages_left -= data->nr_pages_mid;
+	}
+	kvfree(page_array);
+	*pages = new_array;
+	*nr_pages = data->nr_folios;
+	return true;
+}
+
 static int io_sqe_buffer_register(struct io_ring_ctx *ctx, struct iovec *iov,
 				  struct io_mapped_ubuf **pimu,
 				  struct page **last_hpage)
 {
 	struct io_mapped_ubuf *imu = NULL;
 	struct page **pages = NULL;
+	struct io_imu_folio_data data;
 	unsigned long off;
 	size_t size;
 	int ret, nr_pages, i;
-	struct folio *folio = NULL;
+	bool coalesced = false;
 
 	*pimu = (struct io_mapped_ubuf *)&dummy_ubuf;
 	if (!iov->iov_base)
@@ -895,31 +1039,9 @@ static int io_sqe_buffer_register(struct io_ring_ctx *ctx, struct iovec *iov,
 		goto done;
 	}
 
-	/* If it's a huge page, try to coalesce them into a single bvec entry */
-	if (nr_pages > 1) {
-		folio = page_folio(pages[0]);
-		for (i = 1; i < nr_pages; i++) {
-			/*
-			 * Pages must be consecutive and on the same folio for
-			 * this to work
-			 */
-			if (page_folio(pages[i]) != folio ||
-			    pages[i] != pages[i - 1] + 1) {
-				folio = NULL;
-				break;
-			}
-		}
-		if (folio) {
-			/*
-			 * The pages are bound to the folio, it doesn't
-			 * actually unpin them but drops all but one reference,
-			 * which is usually put down by io_buffer_unmap().
-			 * Note, needs a better helper.
-			 */
-			unpin_user_pages(&pages[1], nr_pages - 1);
-			nr_pages = 1;
-		}
-	}
+	/* If it's huge page(s), try to coalesce them into fewer bvec entries */
+	if (io_sqe_buffer_try_coalesce(pages, nr_pages, &data))
+		coalesced = io_sqe_buffer_coalesce(&pages, &nr_pages, &data);
 
 	imu = kvmalloc(struct_size(imu, bvec, nr_pages), GFP_KERNEL);
 	if (!imu)
@@ -931,23 +1053,25 @@ static int io_sqe_buffer_register(struct io_ring_ctx *ctx, struct iovec *iov,
 		goto done;
 	}
 
-	off = (unsigned long) iov->iov_base & ~PAGE_MASK;
 	size = iov->iov_len;
 	/* store original address for later verification */
 	imu->ubuf = (unsigned long) iov->iov_base;
 	imu->ubuf_end = imu->ubuf + iov->iov_len;
 	imu->nr_bvecs = nr_pages;
+	refcount_set(&imu->refs, 1);
+	imu->folio_shift = PAGE_SHIFT;
+	if (coalesced)
+		imu->folio_shift = data.folio_shift;
+	off = (unsigned long) iov->iov_base & ~PAGE_MASK;
+	if (coalesced)
+		off += data.first_folio_page_idx << PAGE_SHIFT;
 	*pimu = imu;
 	ret = 0;
 
-	if (folio) {
-		bvec_set_page(&imu->bvec[0], pages[0], size, off);
-		goto done;
-	}
 	for (i = 0; i < nr_pages; i++) {
 		size_t vec_len;
 
-		vec_len = min_t(size_t, size, PAGE_SIZE - off);
+		vec_len = min_t(size_t, size, (1UL << imu->folio_shift) - off);
 		bvec_set_page(&imu->bvec[i], pages[i], vec_len, off);
 		off = 0;
 		size -= vec_len;
@@ -1049,23 +1173,18 @@ int io_import_fixed(int ddir, struct iov_iter *iter,
 		 * we know that:
 		 *
 		 * 1) it's a BVEC iter, we set it up
-		 * 2) all bvecs are PAGE_SIZE in size, except potentially the
+		 * 2) all bvecs are the same in size, except potentially the
 		 *    first and last bvec
 		 *
 		 * So just find our index, and adjust the iterator afterwards.
 		 * If the offset is within the first bvec (or the whole first
 		 * bvec, just use iov_iter_advance(). This makes it easier
 		 * since we can just skip the first segment, which may not
-		 * be PAGE_SIZE aligned.
+		 * be folio_size aligned.
 		 */
 		const struct bio_vec *bvec = imu->bvec;
 
 		if (offset < bvec->bv_len) {
-			/*
-			 * Note, huge pages buffers consists of one large
-			 * bvec entry and should always go this way. The other
-			 * branch doesn't expect non PAGE_SIZE'd chunks.
-			 */
 			iter->bvec = bvec;
 			iter->nr_segs = bvec->bv_len;
 			iter->count -= offset;
@@ -1075,12 +1194,12 @@ int io_import_fixed(int ddir, struct iov_iter *iter,
 
 			/* skip first vec */
 			offset -= bvec->bv_len;
-			seg_skip = 1 + (offset >> PAGE_SHIFT);
+			seg_skip = 1 + (offset >> imu->folio_shift);
 
 			iter->bvec = bvec + seg_skip;
 			iter->nr_segs -= seg_skip;
 			iter->count -= bvec->bv_len + offset;
-			iter->iov_offset = offset & ~PAGE_MASK;
+			iter->iov_offset = offset & ((1UL << imu->folio_shift) - 1);
 		}
 	}
 
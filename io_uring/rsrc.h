@@ -46,14 +46,32 @@ struct io_mapped_ubuf {
 	u64		ubuf;
 	u64		ubuf_end;
 	unsigned int	nr_bvecs;
+	unsigned int	folio_shift;
+	refcount_t	refs;
 	unsigned long	acct_pages;
 	struct bio_vec	bvec[] __counted_by(nr_bvecs);
 };
 
+struct io_imu_folio_data {
+	/* Head folio can be partially included in the fixed buf */
+	unsigned int	nr_pages_head;
+	/* For non-head/tail folios, has to be fully included */
+	unsigned int	nr_pages_mid;
+	/* Page index of the first pinned page in its folio */
+	unsigned int	first_folio_page_idx;
+	unsigned int	folio_shift;
+	unsigned int	nr_folios;
+};
+
 void io_rsrc_node_ref_zero(struct io_rsrc_node *node);
 void io_rsrc_node_destroy(struct io_ring_ctx *ctx, struct io_rsrc_node *ref_node);
 struct io_rsrc_node *io_rsrc_node_alloc(struct io_ring_ctx *ctx);
 int io_queue_rsrc_removal(struct io_rsrc_data *data, unsigned idx, void *rsrc);
+void io_buffer_unmap(struct io_ring_ctx *ctx, struct io_mapped_ubuf **slot);
+struct io_mapped_ubuf *io_mapped_buf_get(struct io_ring_ctx *ctx,
+					 unsigned int idx);
+int io_mapped_buf_install(struct io_ring_ctx *ctx, struct io_mapped_ubuf *imu,
+			  unsigned int idx);
 
 int io_import_fixed(int ddir, struct iov_iter *iter,
 			   struct io_mapped_ubuf *imu,
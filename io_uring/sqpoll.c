@@ -10,6 +10,7 @@
 #include <linux/slab.h>
 #include <linux/audit.h>
 #include <linux/security.h>
+#include <linux/topology.h>
 #include <linux/io_uring.h>
 
 #include <uapi/linux/io_uring.h>
@@ -84,6 +85,7 @@ static __cold void io_sqd_update_thread_idle(struct io_sq_data *sqd)
 	list_for_each_entry(ctx, &sqd->ctx_list, sqd_list)
 		sq_thread_idle = max(sq_thread_idle, ctx->sq_thread_idle);
 	sqd->sq_thread_idle = sq_thread_idle;
+	sqd->sq_cur_idle = sq_thread_idle;
 }
 
 void io_sq_thread_finish(struct io_ring_ctx *ctx)
@@ -154,6 +156,7 @@ static struct io_sq_data *io_get_sq_data(struct io_uring_params *p,
 
 	atomic_set(&sqd->park_pending, 0);
 	refcount_set(&sqd->refs, 1);
+	sqd->sq_node = NUMA_NO_NODE;
 	INIT_LIST_HEAD(&sqd->ctx_list);
 	mutex_init(&sqd->lock);
 	init_waitqueue_head(&sqd->wait);
@@ -289,7 +292,19 @@ static int io_sq_thread(void *data)
 	if (sqd->sq_cpu != -1) {
 		set_cpus_allowed_ptr(current, cpumask_of(sqd->sq_cpu));
 	} else {
-		set_cpus_allowed_ptr(current, cpu_online_mask);
+		const struct cpumask *allowed = cpu_online_mask;
+
+		/*
+		 * No explicit affinity was asked for. Prefer the node that
+		 * the creating task lived on, as the SQ/CQ ring memory will
+		 * have been allocated there under the default local policy,
+		 * keeping ring polling off remote sockets.
+		 */
+		if (sqd->sq_node != NUMA_NO_NODE &&
+		    cpumask_intersects(cpumask_of_node(sqd->sq_node),
+				       cpu_online_mask))
+			allowed = cpumask_of_node(sqd->sq_node);
+		set_cpus_allowed_ptr(current, allowed);
 		sqd->sq_cpu = raw_smp_processor_id();
 	}
 
@@ -308,7 +323,7 @@ static int io_sq_thread(void *data)
 		if (io_sqd_events_pending(sqd) || signal_pending(current)) {
 			if (io_sqd_handle_event(sqd))
 				break;
-			timeout = jiffies + sqd->sq_thread_idle;
+			timeout = jiffies + sqd->sq_cur_idle;
 		}
 
 		cap_entries = !list_is_singular(&sqd->ctx_list);
@@ -325,7 +340,12 @@ static int io_sq_thread(void *data)
 		if (sqt_spin || !time_after(jiffies, timeout)) {
 			if (sqt_spin) {
 				io_sq_update_worktime(sqd, &start);
-				timeout = jiffies + sqd->sq_thread_idle;
+				/*
+				 * We did useful work, restore the full
+				 * configured idle budget.
+				 */
+				sqd->sq_cur_idle = sqd->sq_thread_idle;
+				timeout = jiffies + sqd->sq_cur_idle;
 			}
 			if (unlikely(need_resched())) {
 				mutex_unlock(&sqd->lock);
@@ -336,6 +356,14 @@ static int io_sq_thread(void *data)
 			continue;
 		}
 
+		/*
+		 * The idle window expired without any submissions. Back the
+		 * spin budget off so that mostly-idle rings don't burn a
+		 * full core between sparse wakeups; any productive pass
+		 * above restores the full window.
+		 */
+		sqd->sq_cur_idle = max(sqd->sq_cur_idle / 2, 1U);
+
 		prepare_to_wait(&sqd->wait, &wait, TASK_INTERRUPTIBLE);
 		if (!io_sqd_events_pending(sqd) && !io_sq_tw_pending(retry_list)) {
 			bool needs_sched = true;
@@ -373,7 +401,7 @@ static int io_sq_thread(void *data)
 		}
 
 		finish_wait(&sqd->wait, &wait);
-		timeout = jiffies + sqd->sq_thread_idle;
+		timeout = jiffies + sqd->sq_cur_idle;
 	}
 
 	if (retry_list)
@@ -472,7 +500,8 @@ __cold int io_sq_offload_create(struct io_ring_ctx *ctx,
 
 		sqd->task_pid = current->pid;
 		sqd->task_tgid = current->tgid;
-		tsk = create_io_thread(io_sq_thread, sqd, NUMA_NO_NODE);
+		sqd->sq_node = numa_node_id();
+		tsk = create_io_thread(io_sq_thread, sqd, sqd->sq_node);
 		if (IS_ERR(tsk)) {
 			ret = PTR_ERR(tsk);
 			goto err_sqpoll;
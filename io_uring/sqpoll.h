@@ -12,7 +12,10 @@ struct io_sq_data {
 	struct wait_queue_head	wait;
 
 	unsigned		sq_thread_idle;
+	/* current idle budget, scaled down while submissions are sparse */
+	unsigned		sq_cur_idle;
 	int			sq_cpu;
+	int			sq_node;
 	pid_t			task_pid;
 	pid_t			task_tgid;
 
@@ -1121,8 +1121,13 @@ static int do_mq_timedsend(mqd_t mqdes, const char __user *u_msg_ptr,
 	 * msg_insert really wants us to have a valid, spare node struct so
 	 * it doesn't have to kmalloc a GFP_ATOMIC allocation, but it will
 	 * fall back to that if necessary.
+	 *
+	 * Skip the speculative allocation if a receiver is already waiting,
+	 * as delivery is then pipelined past the message tree altogether.
+	 * Both checks are racy, but if they turn out wrong, msg_insert()
+	 * does the GFP_ATOMIC fallback.
 	 */
-	if (!info->node_cache)
+	if (!info->node_cache && list_empty(&info->e_wait_q[RECV].list))
 		new_leaf = kmalloc(sizeof(*new_leaf), GFP_KERNEL);
 
 	spin_lock(&info->lock);
@@ -1132,8 +1137,6 @@ static int do_mq_timedsend(mqd_t mqdes, const char __user *u_msg_ptr,
 		INIT_LIST_HEAD(&new_leaf->msg_list);
 		info->node_cache = new_leaf;
 		new_leaf = NULL;
-	} else {
-		kfree(new_leaf);
 	}
 
 	if (info->attr.mq_curmsgs == info->attr.mq_maxmsg) {
@@ -1169,6 +1172,8 @@ out_unlock:
 	spin_unlock(&info->lock);
 	wake_up_q(&wake_q);
 out_free:
+	/* Drop a speculative allocation that lost the race for the cache. */
+	kfree(new_leaf);
 	if (ret)
 		free_msg(msg_ptr);
 out_fput:
@@ -1236,8 +1241,7 @@ static int do_mq_timedreceive(mqd_t mqdes, char __user *u_msg_ptr,
 		/* Save our speculative allocation into the cache */
 		INIT_LIST_HEAD(&new_leaf->msg_list);
 		info->node_cache = new_leaf;
-	} else {
-		kfree(new_leaf);
+		new_leaf = NULL;
 	}
 
 	if (info->attr.mq_curmsgs == 0) {
@@ -1274,6 +1278,8 @@ static int do_mq_timedreceive(mqd_t mqdes, char __user *u_msg_ptr,
 		}
 		free_msg(msg_ptr);
 	}
+	/* Drop a speculative allocation that lost the race for the cache. */
+	kfree(new_leaf);
 out_fput:
 	fdput(f);
 out:
@@ -1878,19 +1878,6 @@ static struct sem_undo *__lookup_undo(struct sem_undo_list *ulp, int semid)
 	return NULL;
 }
 
-static struct sem_undo *lookup_undo(struct sem_undo_list *ulp, int semid)
-{
-	struct sem_undo *un;
-
-	assert_spin_locked(&ulp->lock);
-
-	un = __lookup_undo(ulp, semid);
-	if (un) {
-		list_del_rcu(&un->list_proc);
-		list_add_rcu(&un->list_proc, &ulp->list_proc);
-	}
-	return un;
-}
 
 /**
  * find_alloc_undo - lookup (and if not present create) undo array
@@ -1914,10 +1901,15 @@ static struct sem_undo *find_alloc_undo(struct ipc_namespace *ns, int semid)
 	if (error)
 		return ERR_PTR(error);
 
+	/*
+	 * Lockless fast path: the undo structure only leaves list_proc
+	 * under ulp->lock and is freed by RCU, so threads sharing the undo
+	 * list (CLONE_SYSVSEM) can look it up without serializing on the
+	 * lock.  A structure invalidated by a racing IPC_RMID is caught by
+	 * the un->semid check in __do_semtimedop().
+	 */
 	rcu_read_lock();
-	spin_lock(&ulp->lock);
-	un = lookup_undo(ulp, semid);
-	spin_unlock(&ulp->lock);
+	un = __lookup_undo(ulp, semid);
 	if (likely(un != NULL))
 		goto out;
 
@@ -1959,7 +1951,7 @@ static struct sem_undo *find_alloc_undo(struct ipc_namespace *ns, int semid)
 	/*
 	 * step 4: check for races: did someone else allocate the undo struct?
 	 */
-	un = lookup_undo(ulp, semid);
+	un = __lookup_undo(ulp, semid);
 	if (un) {
 		spin_unlock(&ulp->lock);
 		kvfree(new);
@@ -762,6 +762,20 @@ static int newseg(struct ipc_namespace *ns, struct ipc_params *params)
 	if (IS_ERR(file))
 		goto no_file;
 
+	/*
+	 * Allocate the whole segment up front instead of on first touch, so
+	 * that page placement is determined by the creator's mempolicy (e.g.
+	 * MPOL_INTERLEAVE for a segment striped across nodes) rather than by
+	 * whichever task happens to fault each page in later.
+	 */
+	if (shmflg & SHM_PREFAULT) {
+		error = vfs_fallocate(file, 0, 0, i_size_read(file_inode(file)));
+		if (error) {
+			fput(file);
+			goto no_file;
+		}
+	}
+
 	shp->shm_cprid = get_pid(task_tgid(current));
 	shp->shm_lprid = NULL;
 	shp->shm_atim = shp->shm_dtim = 0;
@@ -2411,8 +2411,13 @@ EXPORT_SYMBOL_GPL(cgroup_path_ns);
 void cgroup_attach_lock(bool lock_threadgroup)
 {
 	cpus_read_lock();
+	/*
+	 * Attach latency is dominated by the grace period needed to flip
+	 * the rwsem out of reader-fast mode; migrations are user-visible
+	 * and bursty, so pay for an expedited drain instead.
+	 */
 	if (lock_threadgroup)
-		percpu_down_write(&cgroup_threadgroup_rwsem);
+		percpu_down_write_expedited(&cgroup_threadgroup_rwsem);
 }
 
 /**
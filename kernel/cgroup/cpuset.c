@@ -199,6 +199,9 @@ struct cpuset {
 
 	/* Remote partition silbling list anchored at remote_children */
 	struct list_head remote_sibling;
+
+	/* deferred cpumask propagation for large cpusets */
+	struct work_struct rebind_work;
 };
 
 /*
@@ -1265,6 +1268,78 @@ void rebuild_sched_domains(void)
 	cpus_read_unlock();
 }
 
+/* # of tasks rebound synchronously before deferring to the workqueue */
+#define CPUSET_REBIND_SYNC_MAX	512
+
+/* # of tasks rebound per cpuset_mutex hold in the rebind worker */
+#define CPUSET_REBIND_BATCH	256
+
+/*
+ * Apply @cs's effective cpumask to @task, using @new_cpus as a temp
+ * variable.  For top_cpuset, task_cpu_possible_mask() is used instead of
+ * effective_cpus to make sure all offline CPUs are also included as
+ * hotplug code won't update cpumasks for tasks in top_cpuset.
+ */
+static void cpuset_rebind_task(struct cpuset *cs, struct task_struct *task,
+			       struct cpumask *new_cpus)
+{
+	const struct cpumask *possible_mask = task_cpu_possible_mask(task);
+
+	if (cs == &top_cpuset) {
+		/*
+		 * Percpu kthreads in top_cpuset are ignored
+		 */
+		if (kthread_is_per_cpu(task))
+			return;
+		cpumask_andnot(new_cpus, possible_mask, subpartitions_cpus);
+	} else {
+		cpumask_and(new_cpus, possible_mask, cs->effective_cpus);
+	}
+	set_cpus_allowed_ptr(task, new_cpus);
+}
+
+/*
+ * Rebind all tasks of a large cpuset from the workqueue, dropping
+ * cpuset_mutex between batches so that a topology change on a cpuset
+ * with tens of thousands of tasks doesn't stall writers for the whole
+ * walk.  The walk restarts from scratch, which is fine - rebinding a
+ * task to its current cpumask is a no-op, and tasks which moved to
+ * another cpuset in the meantime are skipped.
+ */
+static void cpuset_rebind_workfn(struct work_struct *work)
+{
+	struct cpuset *cs = container_of(work, struct cpuset, rebind_work);
+	struct css_task_iter it;
+	struct task_struct *task;
+	cpumask_var_t new_cpus;
+	int batch = CPUSET_REBIND_BATCH;
+
+	if (WARN_ON_ONCE(!alloc_cpumask_var(&new_cpus, GFP_KERNEL)))
+		goto out_put;
+
+	mutex_lock(&cpuset_mutex);
+	css_task_iter_start(&cs->css, 0, &it);
+	while ((task = css_task_iter_next(&it))) {
+		/* the task may have moved while the mutex was dropped */
+		if (task_cs(task) != cs)
+			continue;
+
+		cpuset_rebind_task(cs, task, new_cpus);
+
+		if (!--batch) {
+			batch = CPUSET_REBIND_BATCH;
+			mutex_unlock(&cpuset_mutex);
+			cond_resched();
+			mutex_lock(&cpuset_mutex);
+		}
+	}
+	css_task_iter_end(&it);
+	mutex_unlock(&cpuset_mutex);
+	free_cpumask_var(new_cpus);
+out_put:
+	css_put(&cs->css);
+}
+
 /**
  * update_tasks_cpumask - Update the cpumasks of tasks in the cpuset.
  * @cs: the cpuset in which each task's cpus_allowed mask needs to be changed
@@ -1272,31 +1347,29 @@ void rebuild_sched_domains(void)
  *
  * Iterate through each task of @cs updating its cpus_allowed to the
  * effective cpuset's.  As this function is called with cpuset_mutex held,
- * cpuset membership stays stable. For top_cpuset, task_cpu_possible_mask()
- * is used instead of effective_cpus to make sure all offline CPUs are also
- * included as hotplug code won't update cpumasks for tasks in top_cpuset.
+ * cpuset membership stays stable.
+ *
+ * Only the first CPUSET_REBIND_SYNC_MAX tasks are rebound synchronously.
+ * The remainder is propagated incrementally by cpuset_rebind_workfn() so
+ * that the writer doesn't turn a topology change on a huge cpuset into a
+ * stop-the-world event; until the worker reaches them, such tasks keep
+ * running on their previous cpumask.
  */
 static void update_tasks_cpumask(struct cpuset *cs, struct cpumask *new_cpus)
 {
 	struct css_task_iter it;
 	struct task_struct *task;
-	bool top_cs = cs == &top_cpuset;
+	int budget = CPUSET_REBIND_SYNC_MAX;
 
 	css_task_iter_start(&cs->css, 0, &it);
 	while ((task = css_task_iter_next(&it))) {
-		const struct cpumask *possible_mask = task_cpu_possible_mask(task);
-
-		if (top_cs) {
-			/*
-			 * Percpu kthreads in top_cpuset are ignored
-			 */
-			if (kthread_is_per_cpu(task))
-				continue;
-			cpumask_andnot(new_cpus, possible_mask, subpartitions_cpus);
-		} else {
-			cpumask_and(new_cpus, possible_mask, cs->effective_cpus);
+		if (!budget--) {
+			if (css_tryget_online(&cs->css) &&
+			    !queue_work(system_unbound_wq, &cs->rebind_work))
+				css_put(&cs->css);
+			break;
 		}
-		set_cpus_allowed_ptr(task, new_cpus);
+		cpuset_rebind_task(cs, task, new_cpus);
 	}
 	css_task_iter_end(&it);
 }
@@ -4014,6 +4087,7 @@ cpuset_css_alloc(struct cgroup_subsys_state *parent_css)
 	fmeter_init(&cs->fmeter);
 	cs->relax_domain_level = -1;
 	INIT_LIST_HEAD(&cs->remote_sibling);
+	INIT_WORK(&cs->rebind_work, cpuset_rebind_workfn);
 
 	/* Set CS_MEMORY_MIGRATE for default hierarchy */
 	if (cgroup_subsys_on_dfl(cpuset_cgrp_subsys))
@@ -4302,6 +4376,7 @@ int __init cpuset_init(void)
 	nodes_setall(top_cpuset.effective_mems);
 
 	fmeter_init(&top_cpuset.fmeter);
+	INIT_WORK(&top_cpuset.rebind_work, cpuset_rebind_workfn);
 	INIT_LIST_HEAD(&remote_children);
 
 	BUG_ON(!alloc_cpumask_var(&cpus_attach, GFP_KERNEL));
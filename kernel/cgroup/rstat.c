@@ -6,10 +6,23 @@
 #include <linux/bpf.h>
 #include <linux/btf.h>
 #include <linux/btf_ids.h>
+#include <linux/hash.h>
 
 #include <trace/events/cgroup.h>
 
-static DEFINE_SPINLOCK(cgroup_rstat_lock);
+/*
+ * The flush side is sharded so that concurrent flushes of disjoint
+ * top-level subtrees don't serialize on a single global lock.  All
+ * cgroups sharing a top-level ancestor hash to the same shard; flushing
+ * the root cgroup acquires every shard.  This is safe because a flush
+ * of a non-root subtree only modifies statistics of cgroups within the
+ * top-level subtree covering it - propagation to the root is skipped,
+ * see cgroup_base_stat_flush().
+ */
+#define CGROUP_RSTAT_LOCK_BITS	3
+#define CGROUP_RSTAT_NR_LOCKS	(1 << CGROUP_RSTAT_LOCK_BITS)
+
+static spinlock_t cgroup_rstat_lock[CGROUP_RSTAT_NR_LOCKS];
 static DEFINE_PER_CPU(raw_spinlock_t, cgroup_rstat_cpu_lock);
 
 static void cgroup_base_stat_flush(struct cgroup *cgrp, int cpu);
@@ -271,7 +284,22 @@ __weak noinline void bpf_rstat_flush(struct cgroup *cgrp,
 __bpf_hook_end();
 
 /*
- * Helper functions for locking cgroup_rstat_lock.
+ * Return the shard of cgroup_rstat_lock[] covering @cgrp's top-level
+ * subtree, or NULL for the root cgroup whose subtree spans every shard.
+ */
+static spinlock_t *cgroup_rstat_shard_lock(struct cgroup *cgrp)
+{
+	if (!cgrp->level)
+		return NULL;
+	return &cgroup_rstat_lock[hash_ptr(cgrp->ancestors[1],
+					   CGROUP_RSTAT_LOCK_BITS)];
+}
+
+/*
+ * Helper functions for locking the cgroup_rstat_lock shard covering
+ * @cgrp.  Flushing the root cgroup takes all shards in index order;
+ * the extra shards use distinct lockdep subclasses as they belong to
+ * the same lock class and are always acquired in ascending order.
  *
  * This makes it easier to diagnose locking issues and contention in
  * production environments.  The parameter @cpu_in_loop indicate lock
@@ -280,32 +308,52 @@ __bpf_hook_end();
  * number processed last.
  */
 static inline void __cgroup_rstat_lock(struct cgroup *cgrp, int cpu_in_loop)
-	__acquires(&cgroup_rstat_lock)
 {
+	spinlock_t *lock = cgroup_rstat_shard_lock(cgrp);
+	bool root = !lock;
 	bool contended;
+	int i;
 
-	contended = !spin_trylock_irq(&cgroup_rstat_lock);
+	if (root)
+		lock = &cgroup_rstat_lock[0];
+
+	contended = !spin_trylock_irq(lock);
 	if (contended) {
 		trace_cgroup_rstat_lock_contended(cgrp, cpu_in_loop, contended);
-		spin_lock_irq(&cgroup_rstat_lock);
+		spin_lock_irq(lock);
+	}
+
+	if (root) {
+		for (i = 1; i < CGROUP_RSTAT_NR_LOCKS; i++)
+			spin_lock_nested(&cgroup_rstat_lock[i], i);
 	}
+
 	trace_cgroup_rstat_locked(cgrp, cpu_in_loop, contended);
 }
 
 static inline void __cgroup_rstat_unlock(struct cgroup *cgrp, int cpu_in_loop)
-	__releases(&cgroup_rstat_lock)
 {
+	spinlock_t *lock = cgroup_rstat_shard_lock(cgrp);
+	int i;
+
 	trace_cgroup_rstat_unlock(cgrp, cpu_in_loop, false);
-	spin_unlock_irq(&cgroup_rstat_lock);
+	if (!lock) {
+		for (i = CGROUP_RSTAT_NR_LOCKS - 1; i > 0; i--)
+			spin_unlock(&cgroup_rstat_lock[i]);
+		spin_unlock_irq(&cgroup_rstat_lock[0]);
+	} else {
+		spin_unlock_irq(lock);
+	}
 }
 
 /* see cgroup_rstat_flush() */
 static void cgroup_rstat_flush_locked(struct cgroup *cgrp)
-	__releases(&cgroup_rstat_lock) __acquires(&cgroup_rstat_lock)
 {
+	spinlock_t *lock = cgroup_rstat_shard_lock(cgrp) ?:
+			   &cgroup_rstat_lock[0];
 	int cpu;
 
-	lockdep_assert_held(&cgroup_rstat_lock);
+	lockdep_assert_held(lock);
 
 	for_each_possible_cpu(cpu) {
 		struct cgroup *pos = cgroup_rstat_updated_list(cgrp, cpu);
@@ -324,13 +372,33 @@ static void cgroup_rstat_flush_locked(struct cgroup *cgrp)
 		}
 
 		/* play nice and yield if necessary */
-		if (need_resched() || spin_needbreak(&cgroup_rstat_lock)) {
+		if (need_resched() || spin_needbreak(lock)) {
 			__cgroup_rstat_unlock(cgrp, cpu);
 			if (!cond_resched())
 				cpu_relax();
 			__cgroup_rstat_lock(cgrp, cpu);
 		}
 	}
+
+	WRITE_ONCE(cgrp->rstat_last_flush, jiffies);
+}
+
+/*
+ * Speculatively test whether any CPU has updates pending in @cgrp's
+ * subtree.  As updates are propagated to all ancestors' updated lists,
+ * @cgrp is on-list iff some cgroup in its subtree has been updated.
+ * This may race with concurrent updaters, which is fine - a missed
+ * update is indistinguishable from one arriving right after the flush.
+ */
+static bool cgroup_rstat_updated_any(struct cgroup *cgrp)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		if (data_race(cgroup_rstat_cpu(cgrp, cpu)->updated_next))
+			return true;
+	}
+	return false;
 }
 
 /**
@@ -350,11 +418,40 @@ __bpf_kfunc void cgroup_rstat_flush(struct cgroup *cgrp)
 {
 	might_sleep();
 
+	if (!cgroup_rstat_updated_any(cgrp))
+		return;
+
 	__cgroup_rstat_lock(cgrp, -1);
 	cgroup_rstat_flush_locked(cgrp);
 	__cgroup_rstat_unlock(cgrp, -1);
 }
 
+/**
+ * cgroup_rstat_flush_ifstale - flush stats unless they are fresh enough
+ * @cgrp: target cgroup
+ * @max_age: acceptable staleness, in jiffies
+ *
+ * Flush stats in @cgrp's subtree unless a flush covering it completed
+ * within the last @max_age jiffies.  A flush of an ancestor also covers
+ * @cgrp's subtree, so the ancestor chain is consulted too.  Intended for
+ * periodic or high-frequency readers which can tolerate slightly stale
+ * numbers in exchange for not serializing on the flush lock.
+ *
+ * This function may block.
+ */
+void cgroup_rstat_flush_ifstale(struct cgroup *cgrp, unsigned long max_age)
+{
+	struct cgroup *pos;
+
+	for (pos = cgrp; pos; pos = cgroup_parent(pos)) {
+		if (time_before(jiffies,
+				READ_ONCE(pos->rstat_last_flush) + max_age))
+			return;
+	}
+
+	cgroup_rstat_flush(cgrp);
+}
+
 /**
  * cgroup_rstat_flush_hold - flush stats in @cgrp's subtree and hold
  * @cgrp: target cgroup
@@ -365,11 +462,11 @@ __bpf_kfunc void cgroup_rstat_flush(struct cgroup *cgrp)
  * This function may block.
  */
 void cgroup_rstat_flush_hold(struct cgroup *cgrp)
-	__acquires(&cgroup_rstat_lock)
 {
 	might_sleep();
 	__cgroup_rstat_lock(cgrp, -1);
-	cgroup_rstat_flush_locked(cgrp);
+	if (cgroup_rstat_updated_any(cgrp))
+		cgroup_rstat_flush_locked(cgrp);
 }
 
 /**
@@ -377,7 +474,6 @@ void cgroup_rstat_flush_hold(struct cgroup *cgrp)
  * @cgrp: cgroup used by tracepoint
  */
 void cgroup_rstat_flush_release(struct cgroup *cgrp)
-	__releases(&cgroup_rstat_lock)
 {
 	__cgroup_rstat_unlock(cgrp, -1);
 }
@@ -393,6 +489,9 @@ int cgroup_rstat_init(struct cgroup *cgrp)
 			return -ENOMEM;
 	}
 
+	/* a freshly created cgroup has nothing to flush */
+	cgrp->rstat_last_flush = jiffies;
+
 	/* ->updated_children list is self terminated */
 	for_each_possible_cpu(cpu) {
 		struct cgroup_rstat_cpu *rstatc = cgroup_rstat_cpu(cgrp, cpu);
@@ -425,7 +524,10 @@ void cgroup_rstat_exit(struct cgroup *cgrp)
 
 void __init cgroup_rstat_boot(void)
 {
-	int cpu;
+	int cpu, i;
+
+	for (i = 0; i < CGROUP_RSTAT_NR_LOCKS; i++)
+		spin_lock_init(&cgroup_rstat_lock[i]);
 
 	for_each_possible_cpu(cpu)
 		raw_spin_lock_init(per_cpu_ptr(&cgroup_rstat_cpu_lock, cpu));
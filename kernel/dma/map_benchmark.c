@@ -19,6 +19,12 @@
 #include <linux/slab.h>
 #include <linux/timekeeping.h>
 
+/*
+ * Latencies are binned by log2 of their value in 100ns units, so the
+ * last bucket holds everything from ~214s upwards.
+ */
+#define DMA_MAP_LAT_BUCKETS	32
+
 struct map_benchmark_data {
 	struct map_benchmark bparam;
 	struct device *dev;
@@ -28,9 +34,21 @@ struct map_benchmark_data {
 	atomic64_t sum_unmap_100ns;
 	atomic64_t sum_sq_map;
 	atomic64_t sum_sq_unmap;
+	atomic64_t map_lat_hist[DMA_MAP_LAT_BUCKETS];
+	atomic64_t unmap_lat_hist[DMA_MAP_LAT_BUCKETS];
+	atomic64_t map_lat_max;
+	atomic64_t unmap_lat_max;
 	atomic64_t loops;
 };
 
+static void map_benchmark_update_max(atomic64_t *max, u64 val)
+{
+	u64 old = atomic64_read(max);
+
+	while (val > old && !atomic64_try_cmpxchg(max, &old, val))
+		;
+}
+
 static int map_benchmark_thread(void *data)
 {
 	void *buf;
@@ -88,6 +106,12 @@ static int map_benchmark_thread(void *data)
 		atomic64_add(unmap_100ns, &map->sum_unmap_100ns);
 		atomic64_add(map_sq, &map->sum_sq_map);
 		atomic64_add(unmap_sq, &map->sum_sq_unmap);
+		atomic64_inc(&map->map_lat_hist[min_t(int, ilog2(map_100ns | 1),
+						      DMA_MAP_LAT_BUCKETS - 1)]);
+		atomic64_inc(&map->unmap_lat_hist[min_t(int, ilog2(unmap_100ns | 1),
+							DMA_MAP_LAT_BUCKETS - 1)]);
+		map_benchmark_update_max(&map->map_lat_max, map_100ns);
+		map_benchmark_update_max(&map->unmap_lat_max, unmap_100ns);
 		atomic64_inc(&map->loops);
 	}
 
@@ -96,6 +120,25 @@ out:
 	return ret;
 }
 
+/*
+ * Return the upper bound (in 100ns units) of the histogram bucket holding
+ * the given per-mille rank, e.g. 990 for the 99th percentile.
+ */
+static u64 map_benchmark_pctile(atomic64_t *hist, u64 loops,
+				unsigned int permille)
+{
+	u64 rank = div64_u64(loops * permille + 999, 1000);
+	u64 seen = 0;
+	int i;
+
+	for (i = 0; i < DMA_MAP_LAT_BUCKETS; i++) {
+		seen += atomic64_read(&hist[i]);
+		if (seen >= rank)
+			return 2ULL << i;
+	}
+	return 2ULL << (DMA_MAP_LAT_BUCKETS - 1);
+}
+
 static int do_map_benchmark(struct map_benchmark_data *map)
 {
 	struct task_struct **tsk;
@@ -130,6 +173,12 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 	atomic64_set(&map->sum_unmap_100ns, 0);
 	atomic64_set(&map->sum_sq_map, 0);
 	atomic64_set(&map->sum_sq_unmap, 0);
+	for (i = 0; i < DMA_MAP_LAT_BUCKETS; i++) {
+		atomic64_set(&map->map_lat_hist[i], 0);
+		atomic64_set(&map->unmap_lat_hist[i], 0);
+	}
+	atomic64_set(&map->map_lat_max, 0);
+	atomic64_set(&map->unmap_lat_max, 0);
 	atomic64_set(&map->loops, 0);
 
 	for (i = 0; i < threads; i++) {
@@ -167,6 +216,22 @@ static int do_map_benchmark(struct map_benchmark_data *map)
 				map->bparam.avg_unmap_100ns;
 		map->bparam.map_stddev = int_sqrt64(map_variance);
 		map->bparam.unmap_stddev = int_sqrt64(unmap_variance);
+
+		/* tail latency, as histogram bucket upper bounds */
+		map->bparam.map_p50_100ns =
+			map_benchmark_pctile(map->map_lat_hist, loops, 500);
+		map->bparam.map_p99_100ns =
+			map_benchmark_pctile(map->map_lat_hist, loops, 990);
+		map->bparam.map_p999_100ns =
+			map_benchmark_pctile(map->map_lat_hist, loops, 999);
+		map->bparam.map_max_100ns = atomic64_read(&map->map_lat_max);
+		map->bparam.unmap_p50_100ns =
+			map_benchmark_pctile(map->unmap_lat_hist, loops, 500);
+		map->bparam.unmap_p99_100ns =
+			map_benchmark_pctile(map->unmap_lat_hist, loops, 990);
+		map->bparam.unmap_p999_100ns =
+			map_benchmark_pctile(map->unmap_lat_hist, loops, 999);
+		map->bparam.unmap_max_100ns = atomic64_read(&map->unmap_lat_max);
 	}
 
 out:
@@ -91,6 +91,7 @@ static struct io_tlb_mem io_tlb_default_mem = {
 	.pools = LIST_HEAD_INIT(io_tlb_default_mem.pools),
 	.dyn_alloc = __WORK_INITIALIZER(io_tlb_default_mem.dyn_alloc,
 					swiotlb_dyn_alloc),
+	.dyn_alloc_nid = NUMA_NO_NODE,
 };
 
 #else  /* !CONFIG_SWIOTLB_DYNAMIC */
@@ -564,21 +565,23 @@ void __init swiotlb_exit(void)
  * @gfp:	GFP flags for the allocation.
  * @bytes:	Size of the buffer.
  * @phys_limit:	Maximum allowed physical address of the buffer.
+ * @nid:	Preferred NUMA node, or %NUMA_NO_NODE.
  *
- * Allocate pages from the buddy allocator. If successful, make the allocated
- * pages decrypted that they can be used for DMA.
+ * Allocate pages from the buddy allocator, preferably on @nid. If successful,
+ * make the allocated pages decrypted that they can be used for DMA.
  *
  * Return: Decrypted pages, %NULL on allocation failure, or ERR_PTR(-EAGAIN)
  * if the allocated physical address was above @phys_limit.
  */
-static struct page *alloc_dma_pages(gfp_t gfp, size_t bytes, u64 phys_limit)
+static struct page *alloc_dma_pages(gfp_t gfp, size_t bytes, u64 phys_limit,
+		int nid)
 {
 	unsigned int order = get_order(bytes);
 	struct page *page;
 	phys_addr_t paddr;
 	void *vaddr;
 
-	page = alloc_pages(gfp, order);
+	page = alloc_pages_node(nid, gfp, order);
 	if (!page)
 		return NULL;
 
@@ -606,11 +609,12 @@ error:
  * @bytes:	Size of the buffer.
  * @phys_limit:	Maximum allowed physical address of the buffer.
  * @gfp:	GFP flags for the allocation.
+ * @nid:	Preferred NUMA node, or %NUMA_NO_NODE.
  *
  * Return: Allocated pages, or %NULL on allocation failure.
  */
 static struct page *swiotlb_alloc_tlb(struct device *dev, size_t bytes,
-		u64 phys_limit, gfp_t gfp)
+		u64 phys_limit, gfp_t gfp, int nid)
 {
 	struct page *page;
 
@@ -634,7 +638,7 @@ static struct page *swiotlb_alloc_tlb(struct device *dev, size_t bytes,
 	else if (phys_limit <= DMA_BIT_MASK(32))
 		gfp |= __GFP_DMA32;
 
-	while (IS_ERR(page = alloc_dma_pages(gfp, bytes, phys_limit))) {
+	while (IS_ERR(page = alloc_dma_pages(gfp, bytes, phys_limit, nid))) {
 		if (IS_ENABLED(CONFIG_ZONE_DMA32) &&
 		    phys_limit < DMA_BIT_MASK(64) &&
 		    !(gfp & (__GFP_DMA32 | __GFP_DMA)))
@@ -673,19 +677,24 @@ static void swiotlb_free_tlb(void *vaddr, size_t bytes)
  * @nareas:	Number of areas.
  * @phys_limit:	Maximum DMA buffer physical address.
  * @gfp:	GFP flags for the allocations.
+ * @nid:	Preferred NUMA node, or %NUMA_NO_NODE.
  *
  * Allocate and initialize a new IO TLB memory pool. The actual number of
  * slabs may be reduced if allocation of @nslabs fails. If even
- * @minslabs cannot be allocated, this function fails.
+ * @minslabs cannot be allocated, this function fails. The pool descriptor,
+ * the slot metadata and the bounce buffer itself are all allocated
+ * preferably on @nid, so that bouncing does not cross NUMA nodes when the
+ * pool serves a node-local device.
  *
  * Return: New memory pool, or %NULL on allocation failure.
  */
 static struct io_tlb_pool *swiotlb_alloc_pool(struct device *dev,
 		unsigned long minslabs, unsigned long nslabs,
-		unsigned int nareas, u64 phys_limit, gfp_t gfp)
+		unsigned int nareas, u64 phys_limit, gfp_t gfp, int nid)
 {
 	struct io_tlb_pool *pool;
 	unsigned int slot_order;
+	struct page *slot_pages;
 	struct page *tlb;
 	size_t pool_size;
 	size_t tlb_size;
@@ -696,13 +705,13 @@ static struct io_tlb_pool *swiotlb_alloc_pool(struct device *dev,
 	}
 
 	pool_size = sizeof(*pool) + array_size(sizeof(*pool->areas), nareas);
-	pool = kzalloc(pool_size, gfp);
+	pool = kzalloc_node(pool_size, gfp, nid);
 	if (!pool)
 		goto error;
 	pool->areas = (void *)pool + sizeof(*pool);
 
 	tlb_size = nslabs << IO_TLB_SHIFT;
-	while (!(tlb = swiotlb_alloc_tlb(dev, tlb_size, phys_limit, gfp))) {
+	while (!(tlb = swiotlb_alloc_tlb(dev, tlb_size, phys_limit, gfp, nid))) {
 		if (nslabs <= minslabs)
 			goto error_tlb;
 		nslabs = ALIGN(nslabs >> 1, IO_TLB_SEGSIZE);
@@ -711,10 +720,10 @@ static struct io_tlb_pool *swiotlb_alloc_pool(struct device *dev,
 	}
 
 	slot_order = get_order(array_size(sizeof(*pool->slots), nslabs));
-	pool->slots = (struct io_tlb_slot *)
-		__get_free_pages(gfp, slot_order);
-	if (!pool->slots)
+	slot_pages = alloc_pages_node(nid, gfp, slot_order);
+	if (!slot_pages)
 		goto error_slots;
+	pool->slots = page_address(slot_pages);
 
 	swiotlb_init_io_tlb_pool(pool, page_to_phys(tlb), nslabs, true, nareas);
 	return pool;
@@ -738,7 +747,8 @@ static void swiotlb_dyn_alloc(struct work_struct *work)
 	struct io_tlb_pool *pool;
 
 	pool = swiotlb_alloc_pool(NULL, IO_TLB_MIN_SLABS, default_nslabs,
-				  default_nareas, mem->phys_limit, GFP_KERNEL);
+				  default_nareas, mem->phys_limit, GFP_KERNEL,
+				  READ_ONCE(mem->dyn_alloc_nid));
 	if (!pool) {
 		pr_warn_ratelimited("Failed to allocate new pool");
 		return;
@@ -1203,12 +1213,18 @@ static int swiotlb_find_slots(struct device *dev, phys_addr_t orig_addr,
 	if (!mem->can_grow)
 		return -1;
 
+	/*
+	 * Hint to the allocation worker which node ran out of slots. Racy
+	 * updates from devices on different nodes are harmless; each grown
+	 * pool lands on the node of some starved device.
+	 */
+	WRITE_ONCE(mem->dyn_alloc_nid, dev_to_node(dev));
 	schedule_work(&mem->dyn_alloc);
 
 	nslabs = nr_slots(alloc_size);
 	phys_limit = min_not_zero(*dev->dma_mask, dev->bus_dma_limit);
 	pool = swiotlb_alloc_pool(dev, nslabs, nslabs, 1, phys_limit,
-				  GFP_NOWAIT | __GFP_NOWARN);
+				  GFP_NOWAIT | __GFP_NOWARN, dev_to_node(dev));
 	if (!pool)
 		return -1;
 
@@ -1833,6 +1849,7 @@ static int rmem_swiotlb_device_init(struct reserved_mem *rmem,
 #ifdef CONFIG_SWIOTLB_DYNAMIC
 		spin_lock_init(&mem->lock);
 		INIT_LIST_HEAD_RCU(&mem->pools);
+		mem->dyn_alloc_nid = NUMA_NO_NODE;
 #endif
 		add_mem_pool(mem, pool);
 
@@ -8,6 +8,8 @@
 #include <linux/kmsan.h>
 #include <linux/livepatch.h>
 #include <linux/audit.h>
+#include <linux/sched/clock.h>
+#include <linux/sysctl.h>
 #include <linux/tick.h>
 
 #include "common.h"
@@ -15,6 +17,58 @@
 #define CREATE_TRACE_POINTS
 #include <trace/events/syscalls.h>
 
+#ifdef CONFIG_SYSCALL_LAT_HIST
+DEFINE_STATIC_KEY_FALSE(syscall_lat_hist_key);
+
+void __syscall_lat_hist_enter(void)
+{
+	struct syscall_lat_hist *h = &current->syscall_lat;
+
+	/* Contents copied over fork() belong to the parent, drop them. */
+	if (unlikely(h->owner_pid != task_pid_nr(current))) {
+		memset(h, 0, sizeof(*h));
+		h->owner_pid = task_pid_nr(current);
+	}
+	h->enter_ts = local_clock();
+}
+
+void __syscall_lat_hist_exit(void)
+{
+	struct syscall_lat_hist *h = &current->syscall_lat;
+	u64 delta;
+
+	/* Key was enabled after this syscall entered, or fresh task. */
+	if (!h->enter_ts)
+		return;
+
+	delta = local_clock() - h->enter_ts;
+	h->enter_ts = 0;
+	/*
+	 * Log2 microsecond buckets.  Updates are CPU-local; /proc readers
+	 * may observe a torn snapshot, which is fine for monitoring.
+	 */
+	h->buckets[min(ilog2((delta >> 10) | 1), SYSCALL_LAT_BUCKETS - 1)]++;
+	h->nr_syscalls++;
+}
+
+static struct ctl_table syscall_lat_hist_sysctl[] = {
+	{
+		.procname	= "syscall_lat_hist",
+		.data		= &syscall_lat_hist_key.key,
+		.maxlen		= sizeof(syscall_lat_hist_key.key),
+		.mode		= 0644,
+		.proc_handler	= proc_do_static_key,
+	},
+};
+
+static int __init syscall_lat_hist_init(void)
+{
+	register_sysctl_init("kernel", syscall_lat_hist_sysctl);
+	return 0;
+}
+late_initcall(syscall_lat_hist_init);
+#endif /* CONFIG_SYSCALL_LAT_HIST */
+
 static inline void syscall_enter_audit(struct pt_regs *regs, long syscall)
 {
 	if (unlikely(audit_context())) {
@@ -184,6 +238,8 @@ static void syscall_exit_to_user_mode_prepare(struct pt_regs *regs)
 
 	CT_WARN_ON(ct_state() != CONTEXT_KERNEL);
 
+	syscall_lat_hist_exit();
+
 	if (IS_ENABLED(CONFIG_PROVE_LOCKING)) {
 		if (WARN(irqs_disabled(), "syscall %lu left IRQs disabled", nr))
 			local_irq_enable();
@@ -844,6 +844,25 @@ perf_cgroup_set_timestamp(struct perf_cpu_context *cpuctx)
 /*
  * reschedule events based on the cgroup constraint of task.
  */
+/*
+ * A task in @cgrp is monitored on this CPU when any enabled cgroup event
+ * here targets @cgrp or one of its ancestors. The per CPU counters are
+ * maintained by perf_cgroup_event_enable()/disable() under ctx->lock.
+ */
+static bool perf_cgroup_monitored(struct perf_cgroup *cgrp)
+{
+	struct cgroup_subsys_state *css;
+
+	for (css = &cgrp->css; css; css = css->parent) {
+		struct perf_cgroup *pc = container_of(css, struct perf_cgroup, css);
+
+		if (READ_ONCE(this_cpu_ptr(pc->info)->nr_events))
+			return true;
+	}
+
+	return false;
+}
+
 static void perf_cgroup_switch(struct task_struct *task)
 {
 	struct perf_cpu_context *cpuctx = this_cpu_ptr(&perf_cpu_context);
@@ -862,6 +881,21 @@ static void perf_cgroup_switch(struct task_struct *task)
 	if (READ_ONCE(cpuctx->cgrp) == cgrp)
 		return;
 
+	/*
+	 * When no enabled cgroup event targets the outgoing or the incoming
+	 * cgroup or one of their ancestors, the switch cannot change the
+	 * state of any event: nothing matching is scheduled in that would
+	 * have to go out and nothing would come in. Just note the new cgroup
+	 * instead of taking the ctx locks and walking the cgroup events.
+	 * Updates of the counters and of cpuctx->cgrp are CPU local and
+	 * serialized against this path by the disabled interrupts.
+	 */
+	if (!perf_cgroup_monitored(cpuctx->cgrp) &&
+	    !perf_cgroup_monitored(cgrp)) {
+		WRITE_ONCE(cpuctx->cgrp, cgrp);
+		return;
+	}
+
 	perf_ctx_lock(cpuctx, cpuctx->task_ctx);
 	perf_ctx_disable(&cpuctx->ctx, true);
 
@@ -973,6 +1007,7 @@ perf_cgroup_event_enable(struct perf_event *event, struct perf_event_context *ct
 		return;
 
 	event->pmu_ctx->nr_cgroups++;
+	per_cpu_ptr(event->cgrp->info, event->cpu)->nr_events++;
 
 	/*
 	 * Because cgroup events are always per-cpu events,
@@ -995,6 +1030,7 @@ perf_cgroup_event_disable(struct perf_event *event, struct perf_event_context *c
 		return;
 
 	event->pmu_ctx->nr_cgroups--;
+	per_cpu_ptr(event->cgrp->info, event->cpu)->nr_events--;
 
 	/*
 	 * Because cgroup events are always per-cpu events,
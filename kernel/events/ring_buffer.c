@@ -9,6 +9,7 @@
  */
 
 #include <linux/perf_event.h>
+#include <linux/mm.h>
 #include <linux/vmalloc.h>
 #include <linux/slab.h>
 #include <linux/circ_buf.h>
@@ -695,6 +696,18 @@ int rb_alloc_aux(struct perf_buffer *rb, struct perf_event *event,
 		 * help PMU drivers honor the watermark.
 		 */
 		max_order = get_order(watermark);
+
+		/*
+		 * PMUs which place their interrupt and stop markers at
+		 * arbitrary page offsets are not tied to the watermark
+		 * granularity and can opt in to PMD sized chunks, which
+		 * cut down both the driver's SG table and the TLB
+		 * pressure of the consumer walking the buffer.
+		 */
+		if (event->pmu->capabilities & PERF_PMU_CAP_AUX_PREFER_LARGE)
+			max_order = max(max_order,
+					min((int)(PMD_SHIFT - PAGE_SHIFT),
+					    ilog2(nr_pages)));
 	} else {
 		/*
 		 * We need to start with the max_order that fits in nr_pages,
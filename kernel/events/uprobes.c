@@ -26,6 +26,7 @@
 #include <linux/task_work.h>
 #include <linux/shmem_fs.h>
 #include <linux/khugepaged.h>
+#include <linux/sort.h>
 
 #include <linux/uprobes.h>
 
@@ -1200,6 +1201,288 @@ int uprobe_register_refctr(struct inode *inode, loff_t offset,
 }
 EXPORT_SYMBOL_GPL(uprobe_register_refctr);
 
+struct uprobe_batch_item {
+	loff_t			offset;
+	loff_t			ref_ctr_offset;
+	struct uprobe		*uprobe;
+	struct uprobe_consumer	*uc;
+};
+
+static int batch_item_cmp(const void *a, const void *b)
+{
+	const struct uprobe_batch_item *ia = a, *ib = b;
+
+	if (ia->offset < ib->offset)
+		return -1;
+	if (ia->offset > ib->offset)
+		return 1;
+	return 0;
+}
+
+/*
+ * Like build_map_info(), but collects each mm mapping any part of the
+ * file range [@min, @max] (in pages) exactly once; ->vaddr is unused.
+ */
+static struct map_info *
+build_batch_map_info(struct address_space *mapping, pgoff_t min, pgoff_t max)
+{
+	struct vm_area_struct *vma;
+	struct map_info *curr = NULL;
+	struct map_info *prev = NULL;
+	struct map_info *info;
+	int more = 0;
+
+ again:
+	i_mmap_lock_read(mapping);
+	vma_interval_tree_foreach(vma, &mapping->i_mmap, min, max) {
+		if (!valid_vma(vma, true))
+			continue;
+
+		/* one entry per mm */
+		for (info = curr; info; info = info->next) {
+			if (info->mm == vma->vm_mm)
+				break;
+		}
+		if (info)
+			continue;
+
+		if (!prev && !more) {
+			/*
+			 * Needs GFP_NOWAIT to avoid i_mmap_rwsem recursion through
+			 * reclaim. This is optimistic, no harm done if it fails.
+			 */
+			prev = kmalloc(sizeof(struct map_info),
+					GFP_NOWAIT | __GFP_NOMEMALLOC | __GFP_NOWARN);
+			if (prev)
+				prev->next = NULL;
+		}
+		if (!prev) {
+			more++;
+			continue;
+		}
+
+		if (!mmget_not_zero(vma->vm_mm))
+			continue;
+
+		info = prev;
+		prev = prev->next;
+		info->next = curr;
+		curr = info;
+
+		info->mm = vma->vm_mm;
+	}
+	i_mmap_unlock_read(mapping);
+
+	if (!more)
+		goto out;
+
+	prev = curr;
+	while (curr) {
+		mmput(curr->mm);
+		curr = curr->next;
+	}
+
+	do {
+		info = kmalloc(sizeof(struct map_info), GFP_KERNEL);
+		if (!info) {
+			curr = ERR_PTR(-ENOMEM);
+			goto out;
+		}
+		info->next = prev;
+		prev = info;
+	} while (--more);
+
+	goto again;
+ out:
+	while (prev)
+		prev = free_map_info(prev);
+	return curr;
+}
+
+/*
+ * Install the whole sorted batch into one mm, walking its VMAs once and
+ * taking its mmap lock once.
+ */
+static int batch_install_mm(struct inode *inode, struct uprobe_batch_item *items,
+			    int cnt, struct mm_struct *mm)
+{
+	VMA_ITERATOR(vmi, mm, 0);
+	struct vm_area_struct *vma;
+	int err = 0;
+
+	mmap_write_lock(mm);
+	for_each_vma(vmi, vma) {
+		loff_t off_start, off_end;
+		int lo = 0, hi = cnt, i;
+
+		if (!valid_vma(vma, true) ||
+		    file_inode(vma->vm_file) != inode)
+			continue;
+
+		off_start = (loff_t)vma->vm_pgoff << PAGE_SHIFT;
+		off_end = off_start + (vma->vm_end - vma->vm_start);
+
+		/* first item at or above this VMA's file range */
+		while (lo < hi) {
+			int mid = lo + (hi - lo) / 2;
+
+			if (items[mid].offset < off_start)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+
+		for (i = lo; i < cnt && items[i].offset < off_end; i++) {
+			unsigned long vaddr;
+
+			/* consult only the "caller", new consumer. */
+			if (!consumer_filter(items[i].uc,
+					UPROBE_FILTER_REGISTER, mm))
+				continue;
+
+			vaddr = offset_to_vaddr(vma, items[i].offset);
+			err = install_breakpoint(items[i].uprobe, mm, vma, vaddr);
+			if (err)
+				break;
+		}
+		if (err)
+			break;
+	}
+	mmap_write_unlock(mm);
+
+	return err;
+}
+
+/*
+ * uprobe_register_batch - register many probes on one file.
+ * @inode: the file in which the probes have to be placed.
+ * @descs: array of probe descriptors; may be given in any order.
+ * @cnt: number of descriptors.
+ *
+ * Registering each probe individually rebuilds the mm list and takes
+ * every mmap lock once per probe, which makes attach time proportional
+ * to probes * processes. This variant attaches all consumers first and
+ * then walks each mm exactly once, installing every breakpoint that
+ * falls into a VMA in one locked pass, so the locking cost scales with
+ * the number of VMAs instead.
+ *
+ * Either all probes are registered or none: on failure every consumer
+ * is unregistered again. Caller rules of __uprobe_register() apply.
+ */
+int uprobe_register_batch(struct inode *inode, struct uprobe_batch_desc *descs,
+			  int cnt)
+{
+	struct uprobe_batch_item *items;
+	struct map_info *info;
+	int i, err = 0;
+
+	if (cnt <= 0)
+		return -EINVAL;
+
+	/* copy_insn() uses read_mapping_page() or shmem_read_mapping_page() */
+	if (!inode->i_mapping->a_ops->read_folio &&
+	    !shmem_mapping(inode->i_mapping))
+		return -EIO;
+
+	items = kvcalloc(cnt, sizeof(*items), GFP_KERNEL);
+	if (!items)
+		return -ENOMEM;
+
+	for (i = 0; i < cnt; i++) {
+		struct uprobe_batch_desc *d = &descs[i];
+
+		if (!d->uc || (!d->uc->handler && !d->uc->ret_handler) ||
+		    d->offset > i_size_read(inode) ||
+		    !IS_ALIGNED(d->offset, UPROBE_SWBP_INSN_SIZE) ||
+		    !IS_ALIGNED(d->ref_ctr_offset, sizeof(short))) {
+			err = -EINVAL;
+			goto free;
+		}
+		items[i].offset = d->offset;
+		items[i].ref_ctr_offset = d->ref_ctr_offset;
+		items[i].uc = d->uc;
+	}
+
+	sort(items, cnt, sizeof(*items), batch_item_cmp, NULL);
+
+	/*
+	 * Phase one: create the uprobes and attach the consumers without
+	 * touching any mm. From here on the probes are live: concurrent
+	 * (un)registrations of other consumers on the same uprobes and
+	 * uprobe_mmap() see the new consumers and keep the breakpoint
+	 * state consistent with the consumer set.
+	 */
+	for (i = 0; i < cnt; i++) {
+		struct uprobe *uprobe;
+ retry:
+		uprobe = alloc_uprobe(inode, items[i].offset,
+				      items[i].ref_ctr_offset);
+		if (!uprobe) {
+			err = -ENOMEM;
+			goto unregister;
+		}
+		if (IS_ERR(uprobe)) {
+			err = PTR_ERR(uprobe);
+			goto unregister;
+		}
+
+		/*
+		 * We can race with uprobe_unregister()->delete_uprobe().
+		 * Check uprobe_is_active() and retry if it is false.
+		 */
+		down_write(&uprobe->register_rwsem);
+		if (likely(uprobe_is_active(uprobe))) {
+			consumer_add(uprobe, items[i].uc);
+			items[i].uprobe = uprobe;
+		}
+		up_write(&uprobe->register_rwsem);
+
+		if (!items[i].uprobe) {
+			put_uprobe(uprobe);
+			goto retry;
+		}
+	}
+
+	/*
+	 * Phase two: one pass over all mms mapping the probed range.
+	 * Concurrent breakpoint updates for the same uprobes are
+	 * serialized by the respective mmap lock and converge to the
+	 * state the consumer set dictates, so the per uprobe
+	 * register_rwsem does not need to be held across the installs.
+	 */
+	percpu_down_write(&dup_mmap_sem);
+	info = build_batch_map_info(inode->i_mapping,
+				    items[0].offset >> PAGE_SHIFT,
+				    items[cnt - 1].offset >> PAGE_SHIFT);
+	if (IS_ERR(info)) {
+		err = PTR_ERR(info);
+		info = NULL;
+	}
+
+	while (info) {
+		struct mm_struct *mm = info->mm;
+
+		if (!err)
+			err = batch_install_mm(inode, items, cnt, mm);
+		mmput(mm);
+		info = free_map_info(info);
+	}
+	percpu_up_write(&dup_mmap_sem);
+
+ unregister:
+	for (i = 0; i < cnt; i++) {
+		if (!items[i].uprobe)
+			continue;
+		if (err)
+			uprobe_unregister(inode, items[i].offset, items[i].uc);
+		put_uprobe(items[i].uprobe);
+	}
+ free:
+	kvfree(items);
+	return err;
+}
+EXPORT_SYMBOL_GPL(uprobe_register_batch);
+
 /*
  * uprobe_apply - unregister an already registered probe.
  * @inode: the file in which the probe has to be removed.
@@ -32,11 +32,15 @@
  *  "But they come in a choice of three flavours!"
  */
 #include <linux/compat.h>
+#include <linux/hash.h>
 #include <linux/jhash.h>
+#include <linux/log2.h>
 #include <linux/pagemap.h>
 #include <linux/plist.h>
+#include <linux/prctl.h>
 #include <linux/memblock.h>
 #include <linux/fault-inject.h>
+#include <linux/sched/mm.h>
 #include <linux/slab.h>
 
 #include "futex.h"
@@ -54,6 +58,158 @@ static struct {
 #define futex_queues   (__futex_data.queues)
 #define futex_hashsize (__futex_data.hashsize)
 
+/*
+ * Optional per-process hash for private futexes, opted into via
+ * prctl(PR_FUTEX_HASH).  Heavily threaded processes otherwise collide in
+ * the boot-sized global table with every other tenant on the machine and
+ * serialize on shared hb->lock cachelines.
+ *
+ * Tables are registered in a small global hash keyed by mm so that no
+ * mm_struct member (and thus no fork/exit plumbing) is needed; the lookup
+ * runs under RCU and is compiled out of the fast path by a static key
+ * until the first process opts in.  A table is only ever installed while
+ * its mm has a single user, so no waiter can already be queued in the
+ * global hash under a private key of that mm, and it is only torn down
+ * once the mm has no users left, so no waiter can still be queued in it.
+ * Teardown is lazy: exiting tasks and new opt-ins reap tables whose mm
+ * has reached mm_users == 0 (the registry holds the mm_struct itself via
+ * mmgrab() so the check is safe).
+ */
+struct futex_private_hash {
+	struct hlist_node	node;
+	struct mm_struct	*mm;	/* registry key, pinned by mm_count */
+	unsigned int		hash_mask;
+	struct rcu_head		rcu;
+	struct futex_hash_bucket queues[];
+};
+
+#define FUTEX_PHASH_BITS	6
+static struct hlist_head futex_phash_registry[1 << FUTEX_PHASH_BITS];
+static DEFINE_SPINLOCK(futex_phash_lock);
+static DEFINE_STATIC_KEY_FALSE(futex_phash_used);
+
+static struct futex_private_hash *futex_private_hash_find(struct mm_struct *mm)
+{
+	struct hlist_head *head;
+	struct futex_private_hash *fph;
+
+	head = &futex_phash_registry[hash_ptr(mm, FUTEX_PHASH_BITS)];
+	hlist_for_each_entry_rcu(fph, head, node,
+				 lockdep_is_held(&futex_phash_lock)) {
+		if (fph->mm == mm)
+			return fph;
+	}
+	return NULL;
+}
+
+/*
+ * Free tables whose mm no longer has any users.  At that point no task
+ * can issue a private futex op on that mm and no waiter can be queued in
+ * the table (every waiter contributes to mm_users until it unqueues), so
+ * the table only needs to survive RCU readers of the registry.  Work is
+ * bounded per call; anything left over is picked up by a later exit.
+ */
+static void futex_private_hash_reap(void)
+{
+	struct futex_private_hash *batch[8];
+	struct futex_private_hash *fph;
+	struct hlist_node *tmp;
+	unsigned int i, nr = 0;
+
+	if (!static_branch_unlikely(&futex_phash_used))
+		return;
+
+	spin_lock(&futex_phash_lock);
+	for (i = 0; i < ARRAY_SIZE(futex_phash_registry); i++) {
+		hlist_for_each_entry_safe(fph, tmp,
+					  &futex_phash_registry[i], node) {
+			if (atomic_read(&fph->mm->mm_users))
+				continue;
+			hlist_del_rcu(&fph->node);
+			batch[nr++] = fph;
+			if (nr == ARRAY_SIZE(batch))
+				goto unlock;
+		}
+	}
+unlock:
+	spin_unlock(&futex_phash_lock);
+
+	for (i = 0; i < nr; i++) {
+		mmdrop(batch[i]->mm);
+		kvfree_rcu(batch[i], rcu);
+	}
+}
+
+static int futex_private_hash_create(unsigned long slots)
+{
+	struct mm_struct *mm = current->mm;
+	struct futex_private_hash *fph;
+	unsigned int i;
+
+	if (slots < 2 || slots > 65536 || !is_power_of_2(slots))
+		return -EINVAL;
+
+	futex_private_hash_reap();
+
+	fph = kvzalloc_node(struct_size(fph, queues, slots), GFP_KERNEL,
+			    numa_node_id());
+	if (!fph)
+		return -ENOMEM;
+
+	fph->mm = mm;
+	fph->hash_mask = slots - 1;
+	for (i = 0; i < slots; i++) {
+		atomic_set(&fph->queues[i].waiters, 0);
+		plist_head_init(&fph->queues[i].chain);
+		spin_lock_init(&fph->queues[i].lock);
+	}
+
+	spin_lock(&futex_phash_lock);
+	/*
+	 * A queued waiter must never see the same key hash to two
+	 * different buckets, so switching tables is only safe while no
+	 * private futex of this mm can have a waiter at all: reject the
+	 * opt-in unless the caller is the sole user of its mm.  Runtimes
+	 * are expected to opt in during startup, before spawning threads.
+	 */
+	if (atomic_read(&mm->mm_users) != 1 || futex_private_hash_find(mm)) {
+		spin_unlock(&futex_phash_lock);
+		kvfree(fph);
+		return -EBUSY;
+	}
+	mmgrab(mm);
+	hlist_add_head_rcu(&fph->node,
+			   &futex_phash_registry[hash_ptr(mm, FUTEX_PHASH_BITS)]);
+	spin_unlock(&futex_phash_lock);
+
+	static_branch_enable(&futex_phash_used);
+	return 0;
+}
+
+static int futex_private_hash_get_slots(void)
+{
+	struct futex_private_hash *fph;
+	int slots = 0;
+
+	rcu_read_lock();
+	fph = futex_private_hash_find(current->mm);
+	if (fph)
+		slots = fph->hash_mask + 1;
+	rcu_read_unlock();
+	return slots;
+}
+
+int futex_hash_prctl(unsigned long arg2, unsigned long arg3)
+{
+	switch (arg2) {
+	case PR_FUTEX_HASH_SET_SLOTS:
+		return futex_private_hash_create(arg3);
+	case PR_FUTEX_HASH_GET_SLOTS:
+		return futex_private_hash_get_slots();
+	default:
+		return -EINVAL;
+	}
+}
 
 /*
  * Fault injections for futexes.
@@ -111,13 +267,33 @@ late_initcall(fail_futex_debugfs);
  * @key:	Pointer to the futex key for which the hash is calculated
  *
  * We hash on the keys returned from get_futex_key (see below) and return the
- * corresponding hash bucket in the global hash.
+ * corresponding hash bucket in the global hash, or in the process private
+ * hash if the key is private and the mm has opted into one.
  */
 struct futex_hash_bucket *futex_hash(union futex_key *key)
 {
 	u32 hash = jhash2((u32 *)key, offsetof(typeof(*key), both.offset) / 4,
 			  key->both.offset);
 
+	if (static_branch_unlikely(&futex_phash_used) &&
+	    !(key->both.offset & (FUT_OFF_INODE | FUT_OFF_MMSHARED))) {
+		struct futex_hash_bucket *hb = NULL;
+		struct futex_private_hash *fph;
+
+		rcu_read_lock();
+		fph = futex_private_hash_find(key->private.mm);
+		if (fph)
+			hb = &fph->queues[hash & fph->hash_mask];
+		rcu_read_unlock();
+		/*
+		 * Safe to use beyond the RCU section: the table is not
+		 * reaped before its mm runs out of users, and the caller
+		 * is such a user.
+		 */
+		if (hb)
+			return hb;
+	}
+
 	return &futex_queues[hash & (futex_hashsize - 1)];
 }
 
@@ -1143,6 +1319,7 @@ void futex_exit_release(struct task_struct *tsk)
 	futex_cleanup_begin(tsk);
 	futex_cleanup(tsk);
 	futex_cleanup_end(tsk, FUTEX_STATE_DEAD);
+	futex_private_hash_reap();
 }
 
 static int __init futex_init(void)
@@ -395,6 +395,68 @@ int futex_unqueue_multiple(struct futex_vector *v, int count)
 	return ret;
 }
 
+/*
+ * Bounded spin phase for FUTEX2_SPIN waits.  Unlike rtmutex there is no
+ * owner to watch, so the bound is a small fixed budget: spin as long as
+ * the futex still holds the expected value, and give up early when this
+ * CPU has competing work or a signal arrived.  A value change means a
+ * waker is in flight, so aborting with -EWOULDBLOCK before queueing lets
+ * userspace re-evaluate the word without a sleep/wake round trip.
+ */
+#define FUTEX_SPIN_LOOPS	128
+
+static bool futex_spin_value(u32 __user *uaddr, u32 val)
+{
+	unsigned int loops = FUTEX_SPIN_LOOPS;
+	u32 uval;
+
+	if (num_online_cpus() == 1)
+		return false;
+
+	while (loops--) {
+		if (get_user(uval, uaddr))
+			return false;	/* let the slow path sort out the fault */
+		if (uval != val)
+			return true;
+		if (need_resched() || signal_pending(current))
+			return false;
+		cpu_relax();
+	}
+	return false;
+}
+
+static bool futex_spin_multiple(struct futex_vector *vs, unsigned int count)
+{
+	unsigned int loops = FUTEX_SPIN_LOOPS;
+	bool spun;
+	u32 uval;
+	int i;
+
+	if (num_online_cpus() == 1)
+		return false;
+
+	do {
+		spun = false;
+		for (i = 0; i < count; i++) {
+			u32 __user *uaddr;
+
+			if (!(vs[i].w.flags & FLAGS_SPIN))
+				continue;
+			uaddr = u64_to_user_ptr(vs[i].w.uaddr);
+			if (get_user(uval, uaddr))
+				return false;
+			if (uval != vs[i].w.val)
+				return true;
+			spun = true;
+		}
+		if (need_resched() || signal_pending(current))
+			return false;
+		cpu_relax();
+	} while (spun && --loops);
+
+	return false;
+}
+
 /**
  * futex_wait_multiple_setup - Prepare to wait and enqueue multiple futexes
  * @vs:		The futex list to wait on
@@ -541,6 +603,13 @@ int futex_wait_multiple(struct futex_vector *vs, unsigned int count,
 {
 	int ret, hint = 0;
 
+	/*
+	 * Spin only on the way in; once we have slept and retried, the
+	 * wait is not short and queueing straight away is the right call.
+	 */
+	if (futex_spin_multiple(vs, count))
+		return -EWOULDBLOCK;
+
 	if (to)
 		hrtimer_sleeper_start_expires(to, HRTIMER_MODE_ABS);
 
@@ -654,6 +723,9 @@ int __futex_wait(u32 __user *uaddr, unsigned int flags, u32 val,
 	if (!bitset)
 		return -EINVAL;
 
+	if ((flags & FLAGS_SPIN) && futex_spin_value(uaddr, val))
+		return -EWOULDBLOCK;
+
 	q.bitset = bitset;
 
 retry:
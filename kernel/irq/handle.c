@@ -202,12 +202,15 @@ irqreturn_t handle_irq_event_percpu(struct irq_desc *desc)
 irqreturn_t handle_irq_event(struct irq_desc *desc)
 {
 	irqreturn_t ret;
+	u64 ts;
 
 	desc->istate &= ~IRQS_PENDING;
 	irqd_set(&desc->irq_data, IRQD_IRQ_INPROGRESS);
 	raw_spin_unlock(&desc->lock);
 
+	ts = irq_steer_begin();
 	ret = handle_irq_event_percpu(desc);
+	irq_steer_end(desc, ts);
 
 	raw_spin_lock(&desc->lock);
 	irqd_clear(&desc->irq_data, IRQD_IRQ_INPROGRESS);
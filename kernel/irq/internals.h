@@ -526,3 +526,26 @@ static inline void irq_debugfs_copy_devname(int irq, struct device *dev)
 {
 }
 #endif /* CONFIG_GENERIC_IRQ_DEBUGFS */
+
+#ifdef CONFIG_IRQ_STEERING
+extern bool irq_steer_active;
+
+/*
+ * Handler runtime accounting for interrupt steering. Only called from
+ * handle_irq_event(), so updates to desc->steer_time are serialized by
+ * IRQD_IRQ_INPROGRESS.
+ */
+static inline u64 irq_steer_begin(void)
+{
+	return unlikely(irq_steer_active) ? local_clock() : 0;
+}
+
+static inline void irq_steer_end(struct irq_desc *desc, u64 start)
+{
+	if (unlikely(start))
+		desc->steer_time += local_clock() - start;
+}
+#else
+static inline u64 irq_steer_begin(void) { return 0; }
+static inline void irq_steer_end(struct irq_desc *desc, u64 start) { }
+#endif /* CONFIG_IRQ_STEERING */
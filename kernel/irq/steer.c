@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * Steering of unmanaged interrupts away from overloaded CPUs.
+ *
+ * Userspace balancers react on a timescale of seconds and fight with
+ * managed-affinity devices. This periodic scan watches the time each CPU
+ * spends in hard and soft interrupt context and, when a CPU exceeds the
+ * configured share of a scan period, moves the interrupt with the largest
+ * handler runtime off that CPU. Managed, per-CPU and non-balanceable
+ * interrupts are never touched.
+ *
+ * Enabled with the "irq_steering" command line option.
+ */
+#include <linux/cpumask.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/irqdesc.h>
+#include <linux/kernel_stat.h>
+#include <linux/math64.h>
+#include <linux/moduleparam.h>
+#include <linux/workqueue.h>
+
+#include "internals.h"
+
+/* Scan period. Short enough to protect latency-critical CPUs quickly. */
+#define IRQ_STEER_PERIOD_MS	10
+
+/* Share (percent) of a scan period spent in irq context before steering */
+static unsigned int irq_steer_threshold __read_mostly = 50;
+module_param(irq_steer_threshold, uint, 0644);
+
+/* Enables the handler runtime accounting in handle_irq_event() */
+bool irq_steer_active __read_mostly;
+
+static bool irq_steer_enable __initdata;
+
+static DEFINE_PER_CPU(u64, irq_steer_cpu_time);
+static struct delayed_work irq_steer_work;
+static cpumask_var_t irq_steer_newmask;
+
+static u64 irq_steer_cpu_load(int cpu)
+{
+	u64 *cpustat = kcpustat_cpu(cpu).cpustat;
+
+	return cpustat[CPUTIME_IRQ] + cpustat[CPUTIME_SOFTIRQ];
+}
+
+/*
+ * Find the busiest steerable interrupt on @src and retarget it, preferring
+ * the remaining CPUs of its current affinity and falling back to @dst.
+ */
+static void irq_steer_migrate(int src, int dst)
+{
+	struct irq_desc *victim = NULL;
+	unsigned int irq, victim_irq = 0;
+	unsigned long flags;
+	u64 best = 0;
+
+	irq_lock_sparse();
+	for_each_active_irq(irq) {
+		struct irq_desc *desc = irq_to_desc(irq);
+		struct irq_data *d;
+		u64 delta;
+
+		if (!desc)
+			continue;
+
+		raw_spin_lock_irqsave(&desc->lock, flags);
+		d = irq_desc_get_irq_data(desc);
+		delta = desc->steer_time - desc->steer_time_ref;
+		desc->steer_time_ref = desc->steer_time;
+
+		if (desc->action && delta > best &&
+		    !irqd_affinity_is_managed(d) && irqd_can_balance(d) &&
+		    !irqd_is_per_cpu(d) &&
+		    cpumask_test_cpu(src, irq_data_get_effective_affinity_mask(d))) {
+			best = delta;
+			victim = desc;
+			victim_irq = irq;
+		}
+		raw_spin_unlock_irqrestore(&desc->lock, flags);
+	}
+
+	if (victim) {
+		struct irq_data *d = irq_desc_get_irq_data(victim);
+
+		cpumask_and(irq_steer_newmask,
+			    irq_data_get_affinity_mask(d), cpu_online_mask);
+		cpumask_clear_cpu(src, irq_steer_newmask);
+		if (cpumask_empty(irq_steer_newmask))
+			cpumask_copy(irq_steer_newmask, cpumask_of(dst));
+
+		if (!irq_set_affinity(victim_irq, irq_steer_newmask))
+			pr_debug("irq %u steered away from CPU%d\n",
+				 victim_irq, src);
+	}
+	irq_unlock_sparse();
+}
+
+static void irq_steer_work_fn(struct work_struct *work)
+{
+	u64 period = (u64)IRQ_STEER_PERIOD_MS * NSEC_PER_MSEC;
+	u64 limit = div_u64(period * irq_steer_threshold, 100);
+	u64 max_delta = 0, min_delta = U64_MAX;
+	int cpu, src = -1, dst = -1;
+
+	cpus_read_lock();
+	for_each_online_cpu(cpu) {
+		u64 now = irq_steer_cpu_load(cpu);
+		u64 delta = now - per_cpu(irq_steer_cpu_time, cpu);
+
+		per_cpu(irq_steer_cpu_time, cpu) = now;
+		if (delta > limit && delta > max_delta) {
+			max_delta = delta;
+			src = cpu;
+		}
+		if (delta < min_delta) {
+			min_delta = delta;
+			dst = cpu;
+		}
+	}
+
+	if (src >= 0 && dst >= 0 && src != dst)
+		irq_steer_migrate(src, dst);
+	cpus_read_unlock();
+
+	queue_delayed_work(system_unbound_wq, &irq_steer_work,
+			   msecs_to_jiffies(IRQ_STEER_PERIOD_MS));
+}
+
+static int __init irq_steer_setup(char *str)
+{
+	unsigned int thresh;
+
+	irq_steer_enable = true;
+	if (str && !kstrtouint(str, 0, &thresh) && thresh && thresh <= 100)
+		irq_steer_threshold = thresh;
+	return 1;
+}
+__setup("irq_steering=", irq_steer_setup);
+
+static int __init irq_steer_init(void)
+{
+	int cpu;
+
+	if (!irq_steer_enable)
+		return 0;
+
+	if (!alloc_cpumask_var(&irq_steer_newmask, GFP_KERNEL))
+		return -ENOMEM;
+
+	/* Baseline the per CPU counters before the first scan */
+	for_each_possible_cpu(cpu)
+		per_cpu(irq_steer_cpu_time, cpu) = irq_steer_cpu_load(cpu);
+
+	irq_steer_active = true;
+	INIT_DELAYED_WORK(&irq_steer_work, irq_steer_work_fn);
+	queue_delayed_work(system_unbound_wq, &irq_steer_work,
+			   msecs_to_jiffies(IRQ_STEER_PERIOD_MS));
+
+	pr_info("irq: steering enabled, threshold %u%%\n", irq_steer_threshold);
+	return 0;
+}
+late_initcall(irq_steer_init);
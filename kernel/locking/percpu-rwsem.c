@@ -22,6 +22,7 @@ int __percpu_init_rwsem(struct percpu_rw_semaphore *sem,
 	rcuwait_init(&sem->writer);
 	init_waitqueue_head(&sem->waiters);
 	atomic_set(&sem->block, 0);
+	sem->fast_writer = false;
 #ifdef CONFIG_DEBUG_LOCK_ALLOC
 	debug_check_no_locks_freed((void *)sem, sizeof(*sem));
 	lockdep_init_map(&sem->dep_map, name, key, 0);
@@ -30,6 +31,37 @@ int __percpu_init_rwsem(struct percpu_rw_semaphore *sem,
 }
 EXPORT_SYMBOL_GPL(__percpu_init_rwsem);
 
+/**
+ * __percpu_init_rwsem_fast_writer - initialize a fast-writer percpu-rwsem
+ * @sem: percpu_rw_semaphore to initialize
+ * @name: lock name, for lockdep
+ * @key: lockdep class key
+ *
+ * A fast-writer percpu-rwsem keeps the per-CPU reader accounting but
+ * does not use the rcu_sync machinery: readers always pay a full
+ * barrier against sem->block, and in exchange percpu_down_write() only
+ * has to set sem->block and sum the per-CPU counts - no RCU grace
+ * period.  Writer-writer exclusion and the FIFO reader/writer wait
+ * queue are the same as in the normal flavor.
+ *
+ * Use this for read-mostly semaphores whose writers cannot afford
+ * grace-period latency; if writers are rare enough to amortize the
+ * grace period, the normal flavor has the cheaper read side.  The
+ * flavor must be chosen at init time and never changed afterwards.
+ */
+int __percpu_init_rwsem_fast_writer(struct percpu_rw_semaphore *sem,
+				    const char *name,
+				    struct lock_class_key *key)
+{
+	int ret;
+
+	ret = __percpu_init_rwsem(sem, name, key);
+	if (!ret)
+		sem->fast_writer = true;
+	return ret;
+}
+EXPORT_SYMBOL_GPL(__percpu_init_rwsem_fast_writer);
+
 void percpu_free_rwsem(struct percpu_rw_semaphore *sem)
 {
 	/*
@@ -221,15 +253,25 @@ static bool readers_active_check(struct percpu_rw_semaphore *sem)
 	return true;
 }
 
-void __sched percpu_down_write(struct percpu_rw_semaphore *sem)
+static void __sched __percpu_down_write(struct percpu_rw_semaphore *sem,
+					bool expedited)
 {
 	bool contended = false;
 
 	might_sleep();
 	rwsem_acquire(&sem->dep_map, 0, 0, _RET_IP_);
 
-	/* Notify readers to take the slow path. */
-	rcu_sync_enter(&sem->rss);
+	/*
+	 * Notify readers to take the slow path.  Fast-writer semaphores
+	 * have no reader fast path to disarm; their readers always order
+	 * themselves against sem->block.
+	 */
+	if (!sem->fast_writer) {
+		if (expedited)
+			rcu_sync_enter_expedited(&sem->rss);
+		else
+			rcu_sync_enter(&sem->rss);
+	}
 
 	/*
 	 * Try set sem->block; this provides writer-writer exclusion.
@@ -254,8 +296,34 @@ void __sched percpu_down_write(struct percpu_rw_semaphore *sem)
 	if (contended)
 		trace_contention_end(sem, 0);
 }
+
+void __sched percpu_down_write(struct percpu_rw_semaphore *sem)
+{
+	__percpu_down_write(sem, false);
+}
 EXPORT_SYMBOL_GPL(percpu_down_write);
 
+/**
+ * percpu_down_write_expedited - writer lock, expedited reader draining
+ * @sem: percpu_rw_semaphore to lock
+ *
+ * Like percpu_down_write(), but when this writer is the one switching
+ * @sem out of reader-fast mode, the required grace period is driven by
+ * synchronize_rcu_expedited() (IPI-based) instead of waiting out a full
+ * grace period.  Back-to-back writers already share one switch: the
+ * semaphore stays in writer mode until a grace period after the last
+ * percpu_up_write(), so only the first writer of a burst pays for the
+ * drain at all.
+ *
+ * Expedited grace periods disturb every CPU; reserve this for writers
+ * whose latency is user-visible.
+ */
+void __sched percpu_down_write_expedited(struct percpu_rw_semaphore *sem)
+{
+	__percpu_down_write(sem, true);
+}
+EXPORT_SYMBOL_GPL(percpu_down_write_expedited);
+
 void percpu_up_write(struct percpu_rw_semaphore *sem)
 {
 	rwsem_release(&sem->dep_map, _RET_IP_);
@@ -282,6 +350,7 @@ void percpu_up_write(struct percpu_rw_semaphore *sem)
 	 * reader fast path will be available again. Safe to use outside the
 	 * exclusive write lock because its counting.
 	 */
-	rcu_sync_exit(&sem->rss);
+	if (!sem->fast_writer)
+		rcu_sync_exit(&sem->rss);
 }
 EXPORT_SYMBOL_GPL(percpu_up_write);
@@ -11,13 +11,14 @@
  *          Peter Zijlstra <peterz@infradead.org>
  */
 
-#ifndef _GEN_PV_LOCK_SLOWPATH
+#if !defined(_GEN_PV_LOCK_SLOWPATH) && !defined(_GEN_CNA_LOCK_SLOWPATH)
 
 #include <linux/smp.h>
 #include <linux/bug.h>
 #include <linux/cpumask.h>
 #include <linux/percpu.h>
 #include <linux/hardirq.h>
+#include <linux/jump_label.h>
 #include <linux/mutex.h>
 #include <linux/prefetch.h>
 #include <asm/byteorder.h>
@@ -81,7 +82,9 @@
  */
 struct qnode {
 	struct mcs_spinlock mcs;
-#ifdef CONFIG_PARAVIRT_SPINLOCKS
+#if defined(CONFIG_NUMA)
+	long reserved[4];	/* covers both cna_node and pv_node */
+#elif defined(CONFIG_PARAVIRT_SPINLOCKS)
 	long reserved[2];
 #endif
 };
@@ -283,11 +286,28 @@ static __always_inline u32  __pv_wait_head_or_lock(struct qspinlock *lock,
 #define pv_kick_node		__pv_kick_node
 #define pv_wait_head_or_lock	__pv_wait_head_or_lock
 
+/*
+ * Hook points used by the NUMA-aware (CNA) slowpath variant; the
+ * defaults are the stock MCS behaviour.
+ */
+#define try_clear_tail(lock, val, node)					\
+	atomic_try_cmpxchg_relaxed(&(lock)->val, &(val), _Q_LOCKED_VAL)
+#define mcs_pass_lock(node, next)					\
+	arch_mcs_spin_unlock_contended(&(next)->locked)
+
+#ifdef CONFIG_NUMA
+DECLARE_STATIC_KEY_FALSE(numa_spinlock_key);
+void __lockfunc __cna_queued_spin_lock_slowpath(struct qspinlock *lock, u32 val);
+#define cna_enabled()		static_branch_unlikely(&numa_spinlock_key)
+#else
+#define cna_enabled()		false
+#endif
+
 #ifdef CONFIG_PARAVIRT_SPINLOCKS
 #define queued_spin_lock_slowpath	native_queued_spin_lock_slowpath
 #endif
 
-#endif /* _GEN_PV_LOCK_SLOWPATH */
+#endif /* _GEN_PV_LOCK_SLOWPATH && _GEN_CNA_LOCK_SLOWPATH */
 
 /**
  * queued_spin_lock_slowpath - acquire the queued spinlock
@@ -318,6 +338,11 @@ void __lockfunc queued_spin_lock_slowpath(struct qspinlock *lock, u32 val)
 
 	BUILD_BUG_ON(CONFIG_NR_CPUS >= (1U << _Q_TAIL_CPU_BITS));
 
+	if (cna_enabled()) {
+		__cna_queued_spin_lock_slowpath(lock, val);
+		return;
+	}
+
 	if (pv_enabled())
 		goto pv_queue;
 
@@ -533,7 +558,7 @@ locked:
 	 *       PENDING will make the uncontended transition fail.
 	 */
 	if ((val & _Q_TAIL_MASK) == tail) {
-		if (atomic_try_cmpxchg_relaxed(&lock->val, &val, _Q_LOCKED_VAL))
+		if (try_clear_tail(lock, val, node))
 			goto release; /* No contention */
 	}
 
@@ -550,7 +575,7 @@ locked:
 	if (!next)
 		next = smp_cond_load_relaxed(&node->next, (VAL));
 
-	arch_mcs_spin_unlock_contended(&next->locked);
+	mcs_pass_lock(node, next);
 	pv_kick_node(lock, next);
 
 release:
@@ -563,10 +588,57 @@ release:
 }
 EXPORT_SYMBOL(queued_spin_lock_slowpath);
 
+/*
+ * Generate the NUMA-aware (CNA) variant of queued_spin_lock_slowpath().
+ */
+#if !defined(_GEN_PV_LOCK_SLOWPATH) && !defined(_GEN_CNA_LOCK_SLOWPATH) && \
+	defined(CONFIG_NUMA)
+#define _GEN_CNA_LOCK_SLOWPATH
+
+#undef  pv_init_node
+#define pv_init_node			cna_init_node
+
+#undef  try_clear_tail
+#define try_clear_tail			cna_try_clear_tail
+
+#undef  mcs_pass_lock
+#define mcs_pass_lock			cna_pass_lock
+
+#undef  cna_enabled
+#define cna_enabled()			false
+
+#undef  queued_spin_lock_slowpath
+#define queued_spin_lock_slowpath	__cna_queued_spin_lock_slowpath
+
+#include "qspinlock_cna.h"
+#include "qspinlock.c"
+
+#undef _GEN_CNA_LOCK_SLOWPATH
+
+/* restore the stock hooks for the paravirt variant below */
+#undef  pv_init_node
+#define pv_init_node		__pv_init_node
+
+#undef  try_clear_tail
+#define try_clear_tail(lock, val, node)					\
+	atomic_try_cmpxchg_relaxed(&(lock)->val, &(val), _Q_LOCKED_VAL)
+
+#undef  mcs_pass_lock
+#define mcs_pass_lock(node, next)					\
+	arch_mcs_spin_unlock_contended(&(next)->locked)
+
+#undef  queued_spin_lock_slowpath
+#ifdef CONFIG_PARAVIRT_SPINLOCKS
+#define queued_spin_lock_slowpath	native_queued_spin_lock_slowpath
+#endif
+
+#endif /* _GEN_CNA_LOCK_SLOWPATH && CONFIG_NUMA */
+
 /*
  * Generate the paravirt code for queued_spin_unlock_slowpath().
  */
-#if !defined(_GEN_PV_LOCK_SLOWPATH) && defined(CONFIG_PARAVIRT_SPINLOCKS)
+#if !defined(_GEN_PV_LOCK_SLOWPATH) && !defined(_GEN_CNA_LOCK_SLOWPATH) && \
+	defined(CONFIG_PARAVIRT_SPINLOCKS)
 #define _GEN_PV_LOCK_SLOWPATH
 
 #undef  pv_enabled
@@ -0,0 +1,179 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _GEN_CNA_LOCK_SLOWPATH
+#error "do not include this file"
+#endif
+
+#include <linux/topology.h>
+#include <linux/kstrtox.h>
+
+/*
+ * Implement a NUMA-aware variant of the MCS queue for the queued
+ * spinlock slowpath (CNA - compact NUMA-aware lock).
+ *
+ * When passing the lock, the holder scans the main MCS queue for the
+ * first waiter running on its own NUMA node and parks the skipped
+ * remote waiters on a secondary queue.  Keeping consecutive handoffs on
+ * one node keeps the lock word and the data it protects in that node's
+ * caches instead of ping-ponging them across the fabric on every
+ * handoff.
+ *
+ * Fairness is preserved two ways: the parked waiters are released - in
+ * arrival order, ahead of the (newer) main queue - as soon as no
+ * same-node waiter is queued, and an unbroken intra-node handoff streak
+ * is bounded by "numa_spinlock_threshold", after which the parked
+ * waiters are released unconditionally.
+ *
+ * The secondary queue links parked nodes through their regular ->next
+ * pointers; its head/tail and the streak length travel with the lock:
+ * the holder writes them into the chosen successor's cna_node before
+ * the release-store that unblocks it.
+ *
+ * The variant is selected with "numa_spinlock=on" (or "auto" on
+ * multi-node machines).  The static key is flipped from early_param
+ * context, after jump_label_init() but before SMP bring-up, so native
+ * and CNA waiters can never share a queue.  The paravirt slowpath is a
+ * separate function and never uses CNA.
+ */
+
+struct cna_node {
+	struct mcs_spinlock	mcs;
+	int			numa_node;
+	u32			encoded_tail;	/* self */
+	struct mcs_spinlock	*sq_head;	/* parked remote waiters */
+	struct mcs_spinlock	*sq_tail;
+	u32			intra_count;
+};
+
+DEFINE_STATIC_KEY_FALSE(numa_spinlock_key);
+
+/*
+ * Upper bound on consecutive same-node handoffs before the parked
+ * remote waiters are released regardless of local demand.
+ */
+static unsigned int cna_intra_max = 256;
+
+static int __init numa_spinlock_setup(char *str)
+{
+	if (!str)
+		return -EINVAL;
+
+	if (!strcmp(str, "on")) {
+		static_branch_enable(&numa_spinlock_key);
+		return 0;
+	}
+	if (!strcmp(str, "auto")) {
+		if (nr_node_ids > 1)
+			static_branch_enable(&numa_spinlock_key);
+		return 0;
+	}
+	if (!strcmp(str, "off"))
+		return 0;
+
+	return -EINVAL;
+}
+early_param("numa_spinlock", numa_spinlock_setup);
+
+static int __init numa_spinlock_threshold_setup(char *str)
+{
+	return kstrtouint(str, 0, &cna_intra_max);
+}
+early_param("numa_spinlock_threshold", numa_spinlock_threshold_setup);
+
+static __always_inline void cna_init_node(struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+
+	BUILD_BUG_ON(sizeof(struct cna_node) > sizeof(struct qnode));
+
+	cn->numa_node = numa_node_id();
+	cn->encoded_tail = encode_tail(smp_processor_id(),
+				       (struct qnode *)cn - this_cpu_ptr(&qnodes[0]));
+	cn->sq_head = cn->sq_tail = NULL;
+	cn->intra_count = 0;
+}
+
+/*
+ * The queue head found the main queue empty (lock tail == its own
+ * tail).  With no parked waiters this is the stock uncontended-release
+ * of the tail; otherwise the secondary queue becomes the new main
+ * queue: claim the lock with the tail pointing at the last parked
+ * node, then designate the oldest parked waiter as the new queue head.
+ */
+static __always_inline bool cna_try_clear_tail(struct qspinlock *lock, u32 val,
+					       struct mcs_spinlock *node)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+	struct cna_node *head;
+	u32 new;
+
+	if (!cn->sq_head)
+		return atomic_try_cmpxchg_relaxed(&lock->val, &val,
+						  _Q_LOCKED_VAL);
+
+	new = ((struct cna_node *)cn->sq_tail)->encoded_tail | _Q_LOCKED_VAL;
+	if (!atomic_try_cmpxchg_relaxed(&lock->val, &val, new))
+		return false;
+
+	head = (struct cna_node *)cn->sq_head;
+	head->sq_head = head->sq_tail = NULL;
+	head->intra_count = 0;
+	arch_mcs_spin_unlock_contended(&head->mcs.locked);
+	return true;
+}
+
+static __always_inline void cna_pass_lock(struct mcs_spinlock *node,
+					  struct mcs_spinlock *next)
+{
+	struct cna_node *cn = (struct cna_node *)node;
+	struct mcs_spinlock *cur, *prev = NULL;
+	struct cna_node *succ = NULL;
+	u32 intra = 0;
+
+	/*
+	 * Unless the intra-node streak hit its bound, look for the first
+	 * waiter on our own node.  The scan ends at the current tail
+	 * (->next == NULL); a waiter whose link is not completed yet is
+	 * simply not considered this round.
+	 */
+	if (cn->intra_count < cna_intra_max) {
+		for (cur = next; cur; cur = READ_ONCE(cur->next)) {
+			if (((struct cna_node *)cur)->numa_node ==
+			    cn->numa_node) {
+				succ = (struct cna_node *)cur;
+				break;
+			}
+			prev = cur;
+		}
+	}
+
+	if (succ) {
+		if (prev) {
+			/* park the skipped remote waiters */
+			if (cn->sq_head)
+				cn->sq_tail->next = next;
+			else
+				cn->sq_head = next;
+			cn->sq_tail = prev;
+			prev->next = NULL;
+		}
+		intra = cn->intra_count + 1;
+	} else if (cn->sq_head) {
+		/*
+		 * No same-node successor (or the streak is over): release
+		 * the parked waiters ahead of the remaining main queue and
+		 * hand off to the oldest of them.
+		 */
+		cn->sq_tail->next = next;
+		succ = (struct cna_node *)cn->sq_head;
+		cn->sq_head = cn->sq_tail = NULL;
+	} else {
+		succ = (struct cna_node *)next;
+	}
+
+	/* the secondary queue and the streak length travel with the lock */
+	succ->sq_head = cn->sq_head;
+	succ->sq_tail = cn->sq_tail;
+	succ->intra_count = intra;
+
+	arch_mcs_spin_unlock_contended(&succ->mcs.locked);
+}
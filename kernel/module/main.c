@@ -1118,17 +1118,41 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 		.gplok	= !(mod->taints & (1 << TAINT_PROPRIETARY_MODULE)),
 		.warn	= true,
 	};
+	bool locked = false;
 	int err;
 
 	/*
+	 * Symbols exported by vmlinux - the vast majority - have no owner
+	 * to take a reference on and no unload to race with, so they can
+	 * be resolved with just preemption disabled.  This keeps modules
+	 * loading in parallel from serializing on module_mutex for every
+	 * undefined symbol.  Only symbols owned by another module fall
+	 * back to the mutex, which also allows ref_module() to sleep.
+	 *
 	 * The module_mutex should not be a heavily contended lock;
 	 * if we get the occasional sleep here, we'll go an extra iteration
 	 * in the wait_event_interruptible(), which is harmless.
 	 */
 	sched_annotate_sleep();
-	mutex_lock(&module_mutex);
+	preempt_disable();
+retry:
 	if (!find_symbol(&fsa))
-		goto unlock;
+		goto out;
+
+	if (fsa.owner && !locked) {
+		/*
+		 * Redo the lookup with the owner pinned by module_mutex.
+		 * find_symbol() leaves fsa untouched on failure, so drop
+		 * the unlocked result first: the owner may be gone by the
+		 * time we hold the mutex.
+		 */
+		fsa.sym = NULL;
+		fsa.owner = NULL;
+		preempt_enable();
+		mutex_lock(&module_mutex);
+		locked = true;
+		goto retry;
+	}
 
 	if (fsa.license == GPL_ONLY)
 		mod->using_gplonly_symbols = true;
@@ -1149,17 +1173,22 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 		goto getname;
 	}
 
-	err = ref_module(mod, fsa.owner);
-	if (err) {
-		fsa.sym = ERR_PTR(err);
-		goto getname;
+	if (fsa.owner) {
+		err = ref_module(mod, fsa.owner);
+		if (err) {
+			fsa.sym = ERR_PTR(err);
+			goto getname;
+		}
 	}
 
 getname:
 	/* We must make copy under the lock if we failed to get ref. */
 	strncpy(ownername, module_name(fsa.owner), MODULE_NAME_LEN);
-unlock:
-	mutex_unlock(&module_mutex);
+out:
+	if (locked)
+		mutex_unlock(&module_mutex);
+	else
+		preempt_enable();
 	return fsa.sym;
 }
 
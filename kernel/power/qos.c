@@ -311,6 +311,69 @@ void cpu_latency_qos_update_request(struct pm_qos_request *req, s32 new_value)
 }
 EXPORT_SYMBOL_GPL(cpu_latency_qos_update_request);
 
+/**
+ * cpu_latency_qos_update_requests - Modify multiple CPU latency QoS requests.
+ * @reqs: Array of QoS requests to update.
+ * @values: New requested constraint values, one for each entry in @reqs.
+ * @count: Number of entries in @reqs and @values.
+ *
+ * Update all of the given requests under a single acquisition of the
+ * constraints lock and recompute the effective constraint value once, instead
+ * of paying the full per-request update cost for every entry.  Idle CPUs are
+ * woken up at most once, after all requests have been applied.  Requests that
+ * are inactive, invalid or already at the given value are skipped.
+ */
+void cpu_latency_qos_update_requests(struct pm_qos_request **reqs,
+				     const s32 *values, int count)
+{
+	struct pm_qos_constraints *c = &cpu_latency_constraints;
+	int prev_value, curr_value;
+	unsigned long flags;
+	int i;
+
+	spin_lock_irqsave(&pm_qos_lock, flags);
+
+	prev_value = pm_qos_get_value(c);
+
+	for (i = 0; i < count; i++) {
+		struct pm_qos_request *req = reqs[i];
+		s32 new_value = values[i];
+
+		if (!req || req->qos != c) {
+			WARN(1, KERN_ERR "%s called for unknown object\n", __func__);
+			continue;
+		}
+
+		if (cpu_latency_qos_value_invalid(new_value))
+			continue;
+
+		if (new_value == PM_QOS_DEFAULT_VALUE)
+			new_value = c->default_value;
+
+		if (new_value == req->node.prio)
+			continue;
+
+		plist_del(&req->node, &c->list);
+		plist_node_init(&req->node, new_value);
+		plist_add(&req->node, &c->list);
+	}
+
+	curr_value = pm_qos_get_value(c);
+	pm_qos_set_value(c, curr_value);
+
+	spin_unlock_irqrestore(&pm_qos_lock, flags);
+
+	trace_pm_qos_update_target(PM_QOS_UPDATE_REQ, prev_value, curr_value);
+
+	if (prev_value != curr_value) {
+		if (c->notifiers)
+			blocking_notifier_call_chain(c->notifiers, curr_value,
+						     NULL);
+		wake_up_all_idle_cpus();
+	}
+}
+EXPORT_SYMBOL_GPL(cpu_latency_qos_update_requests);
+
 /**
  * cpu_latency_qos_remove_request - Remove existing CPU latency QoS request.
  * @req: QoS request to remove.
@@ -30,6 +30,7 @@
 #include <linux/slab.h>
 #include <linux/compiler.h>
 #include <linux/ktime.h>
+#include <linux/prefetch.h>
 #include <linux/set_memory.h>
 
 #include <linux/uaccess.h>
@@ -1440,14 +1441,24 @@ static unsigned int count_data_pages(void)
  */
 static inline bool do_copy_page(long *dst, long *src)
 {
-	long z = 0;
 	int n;
 
-	for (n = PAGE_SIZE / sizeof(long); n; n--) {
-		z |= *src;
+	prefetch_range(src, PAGE_SIZE);
+
+	/*
+	 * Pages found to contain only zeros are dropped from the image and
+	 * the destination frame is reused by the caller, so don't waste
+	 * memory bandwidth on writing out a copy that will be discarded.
+	 * We run on a single CPU with interrupts disabled here, so the page
+	 * cannot change between the scan and the copy.
+	 */
+	if (!memchr_inv(src, 0, PAGE_SIZE))
+		return true;
+
+	for (n = PAGE_SIZE / sizeof(long); n; n--)
 		*dst++ = *src++;
-	}
-	return !z;
+
+	return false;
 }
 
 /**
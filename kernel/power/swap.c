@@ -409,7 +409,14 @@ static int write_page(void *buf, sector_t offset, struct hib_bio_batch *hb)
 	} else {
 		src = buf;
 	}
-	return hib_submit_io(REQ_OP_WRITE | REQ_SYNC, offset, src, hb);
+
+	/*
+	 * Batched writes are only waited for when the free page pool runs
+	 * low, so don't mark them sync; that lets the block layer merge
+	 * them under the plug and keep the device queue deep instead of
+	 * dispatching page-sized requests at sync priority.
+	 */
+	return hib_submit_io(REQ_OP_WRITE | (hb ? 0 : REQ_SYNC), offset, src, hb);
 }
 
 static void release_swap_writer(struct swap_map_handle *handle)
@@ -535,11 +542,11 @@ static int swap_writer_finish(struct swap_map_handle *handle,
 #define CMP_SIZE	(CMP_PAGES * PAGE_SIZE)
 
 /* Maximum number of threads for compression/decompression. */
-#define CMP_THREADS	3
+#define CMP_THREADS	8
 
 /* Minimum/maximum number of pages for read buffering. */
 #define CMP_MIN_RD_PAGES	1024
-#define CMP_MAX_RD_PAGES	8192
+#define CMP_MAX_RD_PAGES	16384
 
 /**
  *	save_image - save the suspend image data
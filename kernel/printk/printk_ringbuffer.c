@@ -2,6 +2,7 @@
 
 #include <linux/kernel.h>
 #include <linux/irqflags.h>
+#include <linux/processor.h>
 #include <linux/string.h>
 #include <linux/errno.h>
 #include <linux/bug.h>
@@ -755,6 +756,9 @@ static bool data_push_tail(struct printk_ringbuffer *rb, unsigned long lpos)
 					    next_lpos)) { /* LMM(data_push_tail:D) */
 			break;
 		}
+
+		/* Lost the race to push the tail. See desc_reserve(). */
+		cpu_relax();
 	}
 
 	return true;
@@ -966,8 +970,18 @@ static bool desc_reserve(struct printk_ringbuffer *rb, unsigned long *id_out)
 		 *    finalize the previous descriptor. This pairs with
 		 *    _prb_commit:B.
 		 */
-	} while (!atomic_long_try_cmpxchg(&desc_ring->head_id, &head_id,
-					  id)); /* LMM(desc_reserve:D) */
+		if (atomic_long_try_cmpxchg(&desc_ring->head_id, &head_id,
+					    id)) /* LMM(desc_reserve:D) */
+			break;
+
+		/*
+		 * Another context won the race for this slot. Wait a bit
+		 * before retrying so that reservation during log storms on
+		 * large machines does not degenerate into all CPUs
+		 * hammering the head ID cacheline with failing cmpxchg().
+		 */
+		cpu_relax();
+	} while (true);
 
 	desc = to_desc(desc_ring, id);
 
@@ -1075,8 +1089,13 @@ static char *data_alloc(struct printk_ringbuffer *rb, unsigned int size,
 		 *    since other CPUs may have updated the tail lpos. This
 		 *    pairs with data_push_tail:B.
 		 */
-	} while (!atomic_long_try_cmpxchg(&data_ring->head_lpos, &begin_lpos,
-					  next_lpos)); /* LMM(data_alloc:A) */
+		if (atomic_long_try_cmpxchg(&data_ring->head_lpos, &begin_lpos,
+					    next_lpos)) /* LMM(data_alloc:A) */
+			break;
+
+		/* Lost the race for this data block. See desc_reserve(). */
+		cpu_relax();
+	} while (true);
 
 	blk = to_block(data_ring, begin_lpos);
 	blk->id = id; /* LMM(data_alloc:B) */
@@ -83,9 +83,11 @@ MODULE_AUTHOR("Paul E. McKenney <paulmck@linux.ibm.com>");
 # define RCUSCALE_SHUTDOWN 1
 #endif
 
+torture_param(int, burst, 0, "Back-to-back operations per holdoff, zero to disable");
 torture_param(bool, gp_async, false, "Use asynchronous GP wait primitives");
 torture_param(int, gp_async_max, 1000, "Max # outstanding waits per writer");
 torture_param(bool, gp_exp, false, "Use expedited GP wait primitives");
+torture_param(bool, gp_mix, false, "Randomly mix normal, expedited, and asynchronous GPs");
 torture_param(int, holdoff, 10, "Holdoff time before test start (s)");
 torture_param(int, minruntime, 0, "Minimum run time (s)");
 torture_param(int, nreaders, -1, "Number of RCU reader threads");
@@ -110,6 +112,7 @@ static struct task_struct **reader_tasks;
 static struct task_struct *shutdown_task;
 
 static u64 **writer_durations;
+static u8 **writer_ops;
 static int *writer_n_durations;
 static atomic_t n_rcu_scale_reader_started;
 static atomic_t n_rcu_scale_writer_started;
@@ -124,6 +127,19 @@ static DEFINE_PER_CPU(atomic_t, n_async_inflight);
 #define MAX_MEAS 10000
 #define MIN_MEAS 100
 
+/* Writer operation types, for gp_mix selection and latency accounting. */
+enum rcu_scale_writer_op {
+	RCU_SCALE_GP_SYNC,
+	RCU_SCALE_GP_EXP,
+	RCU_SCALE_GP_ASYNC,
+	RCU_SCALE_NUM_OPS
+};
+
+static const char * const rcu_scale_op_names[] = { "sync", "exp", "async" };
+
+/* Log2 buckets for per-operation latency percentile estimates. */
+#define RCU_SCALE_HIST_BUCKETS 64
+
 /*
  * Operations vector for selecting different types of tests.
  */
@@ -451,19 +467,32 @@ static void rcu_scale_async_cb(struct rcu_head *rhp)
 static int
 rcu_scale_writer(void *arg)
 {
+	int burst_left = 0;
 	int i = 0;
 	int i_max;
 	unsigned long jdone;
 	long me = (long)arg;
+	int mix_ops[RCU_SCALE_NUM_OPS];
+	int n_mix = 0;
+	int op;
 	struct rcu_head *rhp = NULL;
 	bool started = false, done = false, alldone = false;
 	u64 t;
 	DEFINE_TORTURE_RANDOM(tr);
 	u64 *wdp;
 	u64 *wdpp = writer_durations[me];
+	u8 *wopp = writer_ops[me];
 
 	VERBOSE_SCALEOUT_STRING("rcu_scale_writer task started");
 	WARN_ON(!wdpp);
+	WARN_ON(!wopp);
+
+	/* With gp_mix, draw each operation from whatever this flavor offers. */
+	mix_ops[n_mix++] = RCU_SCALE_GP_SYNC;
+	if (cur_ops->exp_sync)
+		mix_ops[n_mix++] = RCU_SCALE_GP_EXP;
+	if (cur_ops->async)
+		mix_ops[n_mix++] = RCU_SCALE_GP_ASYNC;
 	set_cpus_allowed_ptr(current, cpumask_of(me % nr_cpu_ids));
 	current->flags |= PF_NO_SETAFFINITY;
 	sched_set_fifo_low(current);
@@ -492,13 +521,31 @@ rcu_scale_writer(void *arg)
 
 	jdone = jiffies + minruntime * HZ;
 	do {
-		if (writer_holdoff)
-			udelay(writer_holdoff);
-		if (writer_holdoff_jiffies)
-			schedule_timeout_idle(torture_random(&tr) % writer_holdoff_jiffies + 1);
+		/*
+		 * With burst set, holdoffs separate bursts of back-to-back
+		 * operations rather than individual operations.
+		 */
+		if (burst_left > 0) {
+			burst_left--;
+		} else {
+			burst_left = burst;
+			if (writer_holdoff)
+				udelay(writer_holdoff);
+			if (writer_holdoff_jiffies)
+				schedule_timeout_idle(torture_random(&tr) % writer_holdoff_jiffies + 1);
+		}
+		if (gp_mix)
+			op = mix_ops[torture_random(&tr) % n_mix];
+		else if (gp_async)
+			op = RCU_SCALE_GP_ASYNC;
+		else if (gp_exp)
+			op = RCU_SCALE_GP_EXP;
+		else
+			op = RCU_SCALE_GP_SYNC;
+		wopp[i] = op;
 		wdp = &wdpp[i];
 		*wdp = ktime_get_mono_fast_ns();
-		if (gp_async) {
+		if (op == RCU_SCALE_GP_ASYNC) {
 retry:
 			if (!rhp)
 				rhp = kmalloc(sizeof(*rhp), GFP_KERNEL);
@@ -512,7 +559,7 @@ retry:
 			} else {
 				kfree(rhp); /* Because we are stopping. */
 			}
-		} else if (gp_exp) {
+		} else if (op == RCU_SCALE_GP_EXP) {
 			cur_ops->exp_sync();
 		} else {
 			cur_ops->sync();
@@ -554,7 +601,7 @@ retry:
 			i++;
 		rcu_scale_wait_shutdown();
 	} while (!torture_must_stop());
-	if (gp_async) {
+	if (gp_async || (gp_mix && cur_ops->async)) {
 		cur_ops->gp_barrier();
 	}
 	writer_n_durations[me] = i_max + 1;
@@ -566,8 +613,8 @@ static void
 rcu_scale_print_module_parms(struct rcu_scale_ops *cur_ops, const char *tag)
 {
 	pr_alert("%s" SCALE_FLAG
-		 "--- %s: gp_async=%d gp_async_max=%d gp_exp=%d holdoff=%d minruntime=%d nreaders=%d nwriters=%d writer_holdoff=%d writer_holdoff_jiffies=%d verbose=%d shutdown=%d\n",
-		 scale_type, tag, gp_async, gp_async_max, gp_exp, holdoff, minruntime, nrealreaders, nrealwriters, writer_holdoff, writer_holdoff_jiffies, verbose, shutdown);
+		 "--- %s: burst=%d gp_async=%d gp_async_max=%d gp_exp=%d gp_mix=%d holdoff=%d minruntime=%d nreaders=%d nwriters=%d writer_holdoff=%d writer_holdoff_jiffies=%d verbose=%d shutdown=%d\n",
+		 scale_type, tag, burst, gp_async, gp_async_max, gp_exp, gp_mix, holdoff, minruntime, nrealreaders, nrealwriters, writer_holdoff, writer_holdoff_jiffies, verbose, shutdown);
 }
 
 /*
@@ -831,12 +878,34 @@ unwind:
 	return firsterr;
 }
 
+/*
+ * Estimate a latency percentile from a log2 histogram, returning the
+ * upper bound in nanoseconds of the bucket containing the requested
+ * per-mille rank.
+ */
+static u64 rcu_scale_hist_pctile(u64 *hist, u64 total, int permille)
+{
+	u64 rank = div_u64(total * permille + 999, 1000);
+	u64 seen = 0;
+	int b;
+
+	for (b = 0; b < RCU_SCALE_HIST_BUCKETS; b++) {
+		seen += hist[b];
+		if (seen >= rank)
+			return 2ULL << b;
+	}
+	return 0;
+}
+
 static void
 rcu_scale_cleanup(void)
 {
 	int i;
 	int j;
 	int ngps = 0;
+	u64 *lathist;
+	u64 latcnt[RCU_SCALE_NUM_OPS] = { 0 };
+	u64 latmax[RCU_SCALE_NUM_OPS] = { 0 };
 	u64 *wdp;
 	u64 *wdpp;
 
@@ -901,6 +970,8 @@ rcu_scale_cleanup(void)
 			 ngps,
 			 rcuscale_seq_diff(b_rcu_gp_test_finished,
 					   b_rcu_gp_test_started));
+		lathist = kcalloc(RCU_SCALE_NUM_OPS * RCU_SCALE_HIST_BUCKETS,
+				  sizeof(*lathist), GFP_KERNEL);
 		for (i = 0; i < nrealwriters; i++) {
 			if (!writer_durations)
 				break;
@@ -910,17 +981,55 @@ rcu_scale_cleanup(void)
 			if (!wdpp)
 				continue;
 			for (j = 0; j < writer_n_durations[i]; j++) {
+				u8 wop = writer_ops && writer_ops[i] ?
+					 writer_ops[i][j] : RCU_SCALE_GP_SYNC;
+
 				wdp = &wdpp[j];
 				pr_alert("%s%s %4d writer-duration: %5d %llu\n",
 					scale_type, SCALE_FLAG,
 					i, j, *wdp);
+				if (lathist && wop < RCU_SCALE_NUM_OPS) {
+					lathist[wop * RCU_SCALE_HIST_BUCKETS +
+						min(ilog2(*wdp | 1),
+						    RCU_SCALE_HIST_BUCKETS - 1)]++;
+					latcnt[wop]++;
+					if (*wdp > latmax[wop])
+						latmax[wop] = *wdp;
+				}
 				if (j % 100 == 0)
 					schedule_timeout_uninterruptible(1);
 			}
 			kfree(writer_durations[i]);
+			if (writer_ops)
+				kfree(writer_ops[i]);
+		}
+
+		/*
+		 * Per-operation latency percentile estimates, plus one
+		 * machine-parsable CSV line per operation type.
+		 */
+		for (j = 0; lathist && j < RCU_SCALE_NUM_OPS; j++) {
+			u64 *hist = &lathist[j * RCU_SCALE_HIST_BUCKETS];
+			u64 p50, p90, p99, p999;
+
+			if (!latcnt[j])
+				continue;
+			p50 = rcu_scale_hist_pctile(hist, latcnt[j], 500);
+			p90 = rcu_scale_hist_pctile(hist, latcnt[j], 900);
+			p99 = rcu_scale_hist_pctile(hist, latcnt[j], 990);
+			p999 = rcu_scale_hist_pctile(hist, latcnt[j], 999);
+			pr_alert("%s%s %s-latency: ops %llu p50 %llu p90 %llu p99 %llu p99.9 %llu max %llu ns\n",
+				 scale_type, SCALE_FLAG, rcu_scale_op_names[j],
+				 latcnt[j], p50, p90, p99, p999, latmax[j]);
+			pr_alert("%s%s csv: writer-latency,%s,%d,%llu,%llu,%llu,%llu,%llu,%llu\n",
+				 scale_type, SCALE_FLAG, rcu_scale_op_names[j],
+				 nrealwriters, latcnt[j], p50, p90, p99, p999,
+				 latmax[j]);
 		}
+		kfree(lathist);
 		kfree(writer_tasks);
 		kfree(writer_durations);
+		kfree(writer_ops);
 		kfree(writer_n_durations);
 	}
 
@@ -1020,10 +1129,12 @@ rcu_scale_init(void)
 			       GFP_KERNEL);
 	writer_durations = kcalloc(nrealwriters, sizeof(*writer_durations),
 				   GFP_KERNEL);
+	writer_ops = kcalloc(nrealwriters, sizeof(*writer_ops), GFP_KERNEL);
 	writer_n_durations =
 		kcalloc(nrealwriters, sizeof(*writer_n_durations),
 			GFP_KERNEL);
-	if (!writer_tasks || !writer_durations || !writer_n_durations) {
+	if (!writer_tasks || !writer_durations || !writer_ops ||
+	    !writer_n_durations) {
 		SCALEOUT_ERRSTRING("out of memory");
 		firsterr = -ENOMEM;
 		goto unwind;
@@ -1032,7 +1143,9 @@ rcu_scale_init(void)
 		writer_durations[i] =
 			kcalloc(MAX_MEAS, sizeof(*writer_durations[i]),
 				GFP_KERNEL);
-		if (!writer_durations[i]) {
+		writer_ops[i] = kcalloc(MAX_MEAS, sizeof(*writer_ops[i]),
+					GFP_KERNEL);
+		if (!writer_durations[i] || !writer_ops[i]) {
 			firsterr = -ENOMEM;
 			goto unwind;
 		}
@@ -102,7 +102,7 @@ static void rcu_sync_func(struct rcu_head *rhp)
  * optimize away the grace-period wait via a state machine implemented
  * by rcu_sync_enter(), rcu_sync_exit(), and rcu_sync_func().
  */
-void rcu_sync_enter(struct rcu_sync *rsp)
+static void __rcu_sync_enter(struct rcu_sync *rsp, bool expedited)
 {
 	int gp_state;
 
@@ -130,7 +130,10 @@ void rcu_sync_enter(struct rcu_sync *rsp)
 		 * See the comment above, this simply does the "synchronous"
 		 * call_rcu(rcu_sync_func) which does GP_ENTER -> GP_PASSED.
 		 */
-		synchronize_rcu();
+		if (expedited)
+			synchronize_rcu_expedited();
+		else
+			synchronize_rcu();
 		rcu_sync_func(&rsp->cb_head);
 		/* Not really needed, wait_event() would see GP_PASSED. */
 		return;
@@ -139,6 +142,28 @@ void rcu_sync_enter(struct rcu_sync *rsp)
 	wait_event(rsp->gp_wait, READ_ONCE(rsp->gp_state) >= GP_PASSED);
 }
 
+void rcu_sync_enter(struct rcu_sync *rsp)
+{
+	__rcu_sync_enter(rsp, false);
+}
+
+/**
+ * rcu_sync_enter_expedited() - Force readers onto slowpath, expedited
+ * @rsp: Pointer to rcu_sync structure to use for synchronization
+ *
+ * Like rcu_sync_enter(), but when this updater is the one moving @rsp
+ * out of the idle state, drive the grace period with
+ * synchronize_rcu_expedited() so latency-sensitive callers do not stall
+ * behind a full grace period.  Only the idle->entered transition can be
+ * expedited; an updater joining a transition that is already under way
+ * waits for it like everybody else, and grace periods driven by the
+ * callback state machine (after rcu_sync_exit()) are unaffected.
+ */
+void rcu_sync_enter_expedited(struct rcu_sync *rsp)
+{
+	__rcu_sync_enter(rsp, true);
+}
+
 /**
  * rcu_sync_exit() - Allow readers back onto fast path after grace period
  * @rsp: Pointer to rcu_sync structure to use for synchronization
@@ -1304,6 +1304,51 @@ void hrtimer_start_range_ns(struct hrtimer *timer, ktime_t tim,
 }
 EXPORT_SYMBOL_GPL(hrtimer_start_range_ns);
 
+/**
+ * hrtimer_group_start - (re)start an hrtimer on a shared group expiry point
+ * @group:	the coalescing group to join
+ * @timer:	the timer to be added
+ * @tim:	earliest acceptable expiry time
+ * @slack_ns:	how far past @tim the expiry may be deferred
+ * @mode:	timer mode, as for hrtimer_start_range_ns()
+ *
+ * The timer's tolerance window [@tim, @tim + @slack_ns] is matched
+ * against the group's anchor.  If the anchor lies inside the window,
+ * the timer is programmed to expire exactly at the anchor and shares
+ * the interrupt and the softirq/wakeup pass with every other member
+ * parked there.  Otherwise the anchor is moved to the latest point of
+ * the window, @tim + @slack_ns, which maximizes the number of future
+ * windows that can still reach it.  A stale anchor in the past always
+ * precedes @tim and is replaced the same way.
+ *
+ * Unlike plain timer slack, which only lets the expiry code batch
+ * timers that happen to be queued nearby, identical expiry values
+ * guarantee the batching up front.  All times are interpreted on
+ * @timer's clock; mixing clocks within one group yields nonsense
+ * anchors.
+ */
+void hrtimer_group_start(struct hrtimer_group *group, struct hrtimer *timer,
+			 ktime_t tim, u64 slack_ns,
+			 const enum hrtimer_mode mode)
+{
+	unsigned long flags;
+	ktime_t deadline;
+
+	if (mode & HRTIMER_MODE_REL)
+		tim = ktime_add_safe(tim, hrtimer_cb_get_time(timer));
+	deadline = ktime_add_safe(tim, ns_to_ktime(slack_ns));
+
+	spin_lock_irqsave(&group->lock, flags);
+	if (ktime_before(group->anchor, tim) ||
+	    ktime_after(group->anchor, deadline))
+		group->anchor = deadline;
+	tim = group->anchor;
+	spin_unlock_irqrestore(&group->lock, flags);
+
+	hrtimer_start_range_ns(timer, tim, 0, mode & ~HRTIMER_MODE_REL);
+}
+EXPORT_SYMBOL_GPL(hrtimer_group_start);
+
 /**
  * hrtimer_try_to_cancel - try to deactivate a timer
  * @timer:	hrtimer to stop
@@ -226,14 +226,29 @@ static void task_sample_cputime(struct task_struct *p, u64 *samples)
 	store_samples(samples, stime, utime, p->se.sum_exec_runtime);
 }
 
-static void proc_sample_cputime_atomic(struct task_cputime_atomic *at,
-				       u64 *samples)
+/*
+ * Sample the group accumulator: the baseline established when the
+ * accounting was started plus the tick time deltas sharded by CPU.
+ * O(TG_CPUTIME_SHARDS), independent of the number of threads.
+ */
+static void proc_sample_cputimer(struct thread_group_cputimer *cputimer,
+				 u64 *samples)
 {
+	struct task_cputime_atomic *at = &cputimer->cputime_atomic;
 	u64 stime, utime, rtime;
+	int i;
 
 	utime = atomic64_read(&at->utime);
 	stime = atomic64_read(&at->stime);
 	rtime = atomic64_read(&at->sum_exec_runtime);
+
+	for (i = 0; i < TG_CPUTIME_SHARDS; i++) {
+		at = &cputimer->shards[i].cputime_atomic;
+		utime += atomic64_read(&at->utime);
+		stime += atomic64_read(&at->stime);
+		rtime += atomic64_read(&at->sum_exec_runtime);
+	}
+
 	store_samples(samples, stime, utime, rtime);
 }
 
@@ -277,7 +292,7 @@ void thread_group_sample_cputime(struct task_struct *tsk, u64 *samples)
 
 	WARN_ON_ONCE(!pct->timers_active);
 
-	proc_sample_cputime_atomic(&cputimer->cputime_atomic, samples);
+	proc_sample_cputimer(cputimer, samples);
 }
 
 /**
@@ -302,6 +317,23 @@ static void thread_group_start_cputime(struct task_struct *tsk, u64 *samples)
 	/* Check if cputimer isn't running. This is accessed without locking. */
 	if (!READ_ONCE(pct->timers_active)) {
 		struct task_cputime sum;
+		int i;
+
+		/*
+		 * The shards are only written while timers_active is set, so
+		 * nothing can race with resetting them here. Residue from an
+		 * earlier activation is already contained in the freshly
+		 * summed thread group cputime below and must not be counted
+		 * twice.
+		 */
+		for (i = 0; i < TG_CPUTIME_SHARDS; i++) {
+			struct task_cputime_atomic *at;
+
+			at = &cputimer->shards[i].cputime_atomic;
+			atomic64_set(&at->utime, 0);
+			atomic64_set(&at->stime, 0);
+			atomic64_set(&at->sum_exec_runtime, 0);
+		}
 
 		/*
 		 * The POSIX timer interface allows for absolute time expiry
@@ -320,7 +352,7 @@ static void thread_group_start_cputime(struct task_struct *tsk, u64 *samples)
 		 */
 		WRITE_ONCE(pct->timers_active, true);
 	}
-	proc_sample_cputime_atomic(&cputimer->cputime_atomic, samples);
+	proc_sample_cputimer(cputimer, samples);
 }
 
 static void __thread_group_cputime(struct task_struct *tsk, u64 *samples)
@@ -349,7 +381,7 @@ static u64 cpu_clock_sample_group(const clockid_t clkid, struct task_struct *p,
 		else
 			__thread_group_cputime(p, samples);
 	} else {
-		proc_sample_cputime_atomic(&cputimer->cputime_atomic, samples);
+		proc_sample_cputimer(cputimer, samples);
 	}
 
 	return samples[clkid];
@@ -997,7 +1029,7 @@ static void check_process_timers(struct task_struct *tsk,
 	 * Collect the current process totals. Group accounting is active
 	 * so the sample can be taken directly.
 	 */
-	proc_sample_cputime_atomic(&sig->cputimer.cputime_atomic, samples);
+	proc_sample_cputimer(&sig->cputimer, samples);
 	collect_posix_cputimers(pct, samples, firing);
 
 	/*
@@ -1145,8 +1177,7 @@ static inline bool fastpath_timer_check(struct task_struct *tsk)
 	if (READ_ONCE(pct->timers_active) && !READ_ONCE(pct->expiry_active)) {
 		u64 samples[CPUCLOCK_MAX];
 
-		proc_sample_cputime_atomic(&sig->cputimer.cputime_atomic,
-					   samples);
+		proc_sample_cputimer(&sig->cputimer, samples);
 
 		if (task_cputimers_expired(samples, pct))
 			return true;
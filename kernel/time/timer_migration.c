@@ -5,6 +5,9 @@
  * Copyright(C) 2022 linutronix GmbH
  */
 #include <linux/cpuhotplug.h>
+#include <linux/debugfs.h>
+#include <linux/sched/isolation.h>
+#include <linux/seq_file.h>
 #include <linux/slab.h>
 #include <linux/smp.h>
 #include <linux/spinlock.h>
@@ -420,6 +423,13 @@ static struct list_head *tmigr_level_list __read_mostly;
 static unsigned int tmigr_hierarchy_levels __read_mostly;
 static unsigned int tmigr_crossnode_level __read_mostly;
 
+/*
+ * When set, the migrator role in the lowest level groups is biased towards
+ * housekeeping CPUs, so isolated CPUs are relieved of remote expiry work
+ * whenever a housekeeping sibling is active. Writable via debugfs.
+ */
+static bool tmigr_prefer_housekeeping __read_mostly;
+
 static DEFINE_PER_CPU(struct tmigr_cpu, tmigr_cpu);
 
 #define TMIGR_NONE	0xFF
@@ -642,6 +652,18 @@ static bool tmigr_active_up(struct tmigr_group *group,
 
 			/* Changes need to be propagated */
 			walk_done = false;
+		} else if (tmigr_prefer_housekeeping &&
+			   (childmask & group->hk_childmask) &&
+			   !(newstate.migrator & group->hk_childmask)) {
+			/*
+			 * An activating housekeeping CPU takes the migrator
+			 * role over from an isolated one. Only effective in
+			 * the lowest level groups, where hk_childmask is
+			 * maintained. Both children stay active, so the
+			 * group state seen by the parent does not change and
+			 * the walk can still be terminated here.
+			 */
+			newstate.migrator = childmask;
 		}
 
 		newstate.active |= childmask;
@@ -1024,6 +1046,10 @@ again:
 
 	if (evt) {
 		unsigned int remote_cpu = evt->cpu;
+		u64 lat = now - evt->nextevt.expires;
+
+		group->remote_expiries++;
+		group->lat_hist[min(ilog2(lat | 1), TMIGR_LAT_HIST_SIZE - 1)]++;
 
 		raw_spin_unlock_irq(&group->lock);
 
@@ -1617,6 +1643,8 @@ static int tmigr_setup_groups(unsigned int cpu, unsigned int node)
 
 			tmc->tmgroup = group;
 			tmc->childmask = BIT(group->num_children++);
+			if (housekeeping_cpu(cpu, HK_TYPE_TIMER))
+				group->hk_childmask |= tmc->childmask;
 
 			raw_spin_unlock_irq(&group->lock);
 
@@ -1740,6 +1768,45 @@ static int tmigr_cpu_offline(unsigned int cpu)
 	return 0;
 }
 
+#ifdef CONFIG_DEBUG_FS
+static int tmigr_stats_show(struct seq_file *m, void *v)
+{
+	struct tmigr_group *group;
+	unsigned int lvl, i;
+
+	mutex_lock(&tmigr_mutex);
+	for (lvl = 0; lvl < tmigr_hierarchy_levels; lvl++) {
+		unsigned int grp = 0;
+
+		list_for_each_entry(group, &tmigr_level_list[lvl], list) {
+			seq_printf(m, "GRP%u:%u numa=%d remote_expiries=%lu\n",
+				   lvl, grp++, group->numa_node,
+				   group->remote_expiries);
+			seq_puts(m, "  lat_hist_log2ns:");
+			for (i = 0; i < TMIGR_LAT_HIST_SIZE; i++)
+				seq_printf(m, " %lu", group->lat_hist[i]);
+			seq_putc(m, '\n');
+		}
+	}
+	mutex_unlock(&tmigr_mutex);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(tmigr_stats);
+
+static void __init tmigr_debugfs_init(void)
+{
+	struct dentry *dir;
+
+	dir = debugfs_create_dir("timer_migration", NULL);
+	debugfs_create_file("stats", 0444, dir, NULL, &tmigr_stats_fops);
+	debugfs_create_bool("prefer_housekeeping", 0644, dir,
+			    &tmigr_prefer_housekeeping);
+}
+#else
+static inline void tmigr_debugfs_init(void) { }
+#endif
+
 static int __init tmigr_init(void)
 {
 	unsigned int cpulvl, nodelvl, cpus_per_node, i;
@@ -1801,6 +1868,8 @@ static int __init tmigr_init(void)
 	if (ret)
 		goto err;
 
+	tmigr_debugfs_init();
+
 	return 0;
 
 err:
@@ -5,6 +5,9 @@
 /* Per group capacity. Must be a power of 2! */
 #define TMIGR_CHILDREN_PER_GROUP 8
 
+/* Buckets of the per group remote expiry latency histogram (log2 ns) */
+#define TMIGR_LAT_HIST_SIZE 32
+
 /**
  * struct tmigr_event - a timer event associated to a CPU
  * @nextevt:	The node to enqueue an event in the parent group queue
@@ -44,10 +47,20 @@ struct tmigr_event {
  * @childmask:		childmask of the group in the parent group; is set
  *			during setup and will never change; can be read
  *			lockless
+ * @hk_childmask:	childmask bits of children which are housekeeping
+ *			CPUs; only maintained at the lowest level, where
+ *			children are CPUs; used to bias the migrator role
+ *			towards housekeeping CPUs; is set during setup and
+ *			will never change; can be read lockless
  * @list:		List head that is added to the per level
  *			tmigr_level_list; is required during setup when a
  *			new group needs to be connected to the existing
  *			hierarchy groups
+ * @remote_expiries:	Counter of events which were expired remotely via
+ *			this group; protected by @lock
+ * @lat_hist:		Histogram of the remote expiry latency (time between
+ *			the event expiry and its remote handling) with log2
+ *			nanosecond buckets; protected by @lock
  */
 struct tmigr_group {
 	raw_spinlock_t		lock;
@@ -60,7 +73,10 @@ struct tmigr_group {
 	int			numa_node;
 	unsigned int		num_children;
 	u8			childmask;
+	u8			hk_childmask;
 	struct list_head	list;
+	unsigned long		remote_expiries;
+	unsigned long		lat_hist[TMIGR_LAT_HIST_SIZE];
 };
 
 /**
@@ -131,15 +131,45 @@ const struct raid6_recov_calls *const raid6_recov_algos[] = {
 #define RAID6_TEST_DISKS	8
 #define RAID6_TEST_DISKS_ORDER	3
 
-static inline const struct raid6_recov_calls *raid6_choose_recov(void)
+static inline const struct raid6_recov_calls *raid6_choose_recov(
+	void *(*const dptrs)[RAID6_TEST_DISKS], const int disks)
 {
+	unsigned long perf, bestrecperf, j0, j1;
 	const struct raid6_recov_calls *const *algo;
 	const struct raid6_recov_calls *best;
 
-	for (best = NULL, algo = raid6_recov_algos; *algo; algo++)
-		if (!best || (*algo)->priority > best->priority)
-			if (!(*algo)->valid || (*algo)->valid())
+	for (bestrecperf = 0, best = NULL, algo = raid6_recov_algos; *algo; algo++) {
+		if ((*algo)->valid && !(*algo)->valid())
+			continue;
+
+		if (!IS_ENABLED(CONFIG_RAID6_PQ_BENCHMARK)) {
+			if (!best || (*algo)->priority > best->priority)
 				best = *algo;
+			continue;
+		}
+
+		perf = 0;
+
+		preempt_disable();
+		j0 = jiffies;
+		while ((j1 = jiffies) == j0)
+			cpu_relax();
+		while (time_before(jiffies,
+				   j1 + (1 << RAID6_TIME_JIFFIES_LG2))) {
+			(*algo)->data2(disks, PAGE_SIZE, 0, 1, *dptrs);
+			perf++;
+		}
+		preempt_enable();
+
+		if (perf > bestrecperf) {
+			bestrecperf = perf;
+			best = *algo;
+		}
+		/* 2 pages are reconstructed per call */
+		pr_info("raid6: %-8s rec() %5ld MB/s\n", (*algo)->name,
+			(perf * HZ * 2) >>
+			(20 - PAGE_SHIFT + RAID6_TIME_JIFFIES_LG2));
+	}
 
 	if (best) {
 		raid6_2data_recov = best->data2;
@@ -273,7 +303,7 @@ int __init raid6_select_algo(void)
 	gen_best = raid6_choose_gen(&dptrs, disks);
 
 	/* select raid recover functions */
-	rec_best = raid6_choose_recov();
+	rec_best = raid6_choose_recov(&dptrs, disks);
 
 	free_pages((unsigned long)disk_ptr, RAID6_TEST_DISKS_ORDER);
 
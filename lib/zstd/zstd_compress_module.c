@@ -101,6 +101,15 @@ size_t zstd_compress_cctx(zstd_cctx *cctx, void *dst, size_t dst_capacity,
 }
 EXPORT_SYMBOL(zstd_compress_cctx);
 
+size_t zstd_compress_using_dict(zstd_cctx *cctx, void *dst, size_t dst_capacity,
+	const void *src, size_t src_size, const void *dict, size_t dict_size,
+	int level)
+{
+	return ZSTD_compress_usingDict(cctx, dst, dst_capacity, src, src_size,
+		dict, dict_size, level);
+}
+EXPORT_SYMBOL(zstd_compress_using_dict);
+
 size_t zstd_cstream_workspace_bound(const zstd_compression_parameters *cparams)
 {
 	return ZSTD_estimateCStreamSize_usingCParams(*cparams);
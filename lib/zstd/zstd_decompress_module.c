@@ -59,6 +59,15 @@ size_t zstd_decompress_dctx(zstd_dctx *dctx, void *dst, size_t dst_capacity,
 }
 EXPORT_SYMBOL(zstd_decompress_dctx);
 
+size_t zstd_decompress_using_dict(zstd_dctx *dctx, void *dst,
+	size_t dst_capacity, const void *src, size_t src_size,
+	const void *dict, size_t dict_size)
+{
+	return ZSTD_decompress_usingDict(dctx, dst, dst_capacity, src, src_size,
+		dict, dict_size);
+}
+EXPORT_SYMBOL(zstd_decompress_using_dict);
+
 size_t zstd_dstream_workspace_bound(size_t max_window_size)
 {
 	return ZSTD_estimateDStreamSize(max_window_size);
@@ -0,0 +1,258 @@
+// SPDX-License-Identifier: GPL-2.0+ OR BSD-3-Clause
+/*
+ * Multithreaded streaming compression on top of the kernel zstd API.
+ *
+ * The caller feeds an input stream; the engine shards it into fixed-size
+ * jobs, compresses each job into an independent zstd frame on the
+ * system_unbound_wq, and hands the frames to the caller's write callback
+ * in input order.  The concatenated frames form a standard zstd stream
+ * that zstd_decompress_stream() (or any other conforming decoder)
+ * consumes frame by frame, so no changes are needed on the decompression
+ * side.
+ *
+ * Job slots are used round-robin: before a slot is refilled, the job that
+ * last occupied it is waited for and its output written out, which both
+ * bounds memory use and yields ordered output without a reorder buffer.
+ */
+
+#include <linux/completion.h>
+#include <linux/cpumask.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/workqueue.h>
+#include <linux/zstd.h>
+
+/* Input bytes per job when the caller doesn't specify a job size. */
+#define ZSTD_MT_JOB_SIZE_DEFAULT	(1UL << 18)
+/* Upper bound on concurrency; each job slot carries its own cctx. */
+#define ZSTD_MT_MAX_WORKERS		16
+
+struct zstd_mt_job {
+	struct work_struct work;
+	struct completion done;
+	struct zstd_mt_cctx *mt;
+	zstd_cctx *cctx;
+	void *workspace;
+	u8 *in;
+	u8 *out;
+	size_t in_len;
+	size_t out_len;
+	bool pending;
+	int err;
+};
+
+struct zstd_mt_cctx {
+	struct zstd_mt_parameters params;
+	zstd_parameters zparams;
+	zstd_mt_write_fn write;
+	void *priv;
+
+	struct zstd_mt_job *jobs;
+	unsigned int nr_jobs;
+	unsigned int head;	/* slot being filled next */
+	size_t fill;		/* bytes buffered in that slot */
+	size_t out_cap;
+	size_t cctx_size;
+	int err;		/* sticky stream error */
+};
+
+static void zstd_mt_work(struct work_struct *work)
+{
+	struct zstd_mt_job *job = container_of(work, struct zstd_mt_job, work);
+	struct zstd_mt_cctx *mt = job->mt;
+	size_t ret;
+
+	if (mt->params.dict_size)
+		ret = zstd_compress_using_dict(job->cctx, job->out,
+			mt->out_cap, job->in, job->in_len, mt->params.dict,
+			mt->params.dict_size, mt->params.level);
+	else
+		ret = zstd_compress_cctx(job->cctx, job->out, mt->out_cap,
+			job->in, job->in_len, &mt->zparams);
+
+	if (zstd_is_error(ret)) {
+		job->err = -EIO;
+		job->out_len = 0;
+	} else {
+		job->err = 0;
+		job->out_len = ret;
+	}
+	complete(&job->done);
+}
+
+/*
+ * Wait for the job occupying @job's slot, if any, and emit its frame.
+ * Because slots are drained in the order they were submitted, writes
+ * come out in input order.
+ */
+static int zstd_mt_drain_job(struct zstd_mt_cctx *mt, struct zstd_mt_job *job)
+{
+	int err;
+
+	if (!job->pending)
+		return 0;
+
+	wait_for_completion(&job->done);
+	job->pending = false;
+
+	err = job->err;
+	if (!err && !mt->err && job->out_len)
+		err = mt->write(mt->priv, job->out, job->out_len);
+
+	return err;
+}
+
+static void zstd_mt_submit(struct zstd_mt_cctx *mt)
+{
+	struct zstd_mt_job *job = &mt->jobs[mt->head];
+
+	job->in_len = mt->fill;
+	job->pending = true;
+	reinit_completion(&job->done);
+	queue_work(system_unbound_wq, &job->work);
+
+	mt->head = (mt->head + 1) % mt->nr_jobs;
+	mt->fill = 0;
+}
+
+struct zstd_mt_cctx *zstd_mt_init_cctx(const struct zstd_mt_parameters *params,
+	zstd_mt_write_fn write, void *priv)
+{
+	struct zstd_mt_cctx *mt;
+	unsigned int i;
+
+	if (params == NULL || write == NULL)
+		return NULL;
+
+	mt = kzalloc(sizeof(*mt), GFP_KERNEL);
+	if (mt == NULL)
+		return NULL;
+
+	mt->params = *params;
+	if (mt->params.nr_workers == 0)
+		mt->params.nr_workers = num_online_cpus();
+	mt->params.nr_workers = min_t(unsigned int, mt->params.nr_workers,
+				      ZSTD_MT_MAX_WORKERS);
+	if (mt->params.job_size == 0)
+		mt->params.job_size = ZSTD_MT_JOB_SIZE_DEFAULT;
+	mt->zparams = zstd_get_params(mt->params.level, mt->params.job_size);
+	mt->write = write;
+	mt->priv = priv;
+	/* two spare slots so filling overlaps with in-flight compression */
+	mt->nr_jobs = mt->params.nr_workers + 2;
+	mt->out_cap = zstd_compress_bound(mt->params.job_size);
+	mt->cctx_size = zstd_cctx_workspace_bound(&mt->zparams.cParams);
+
+	mt->jobs = kvcalloc(mt->nr_jobs, sizeof(*mt->jobs), GFP_KERNEL);
+	if (mt->jobs == NULL)
+		goto err;
+
+	for (i = 0; i < mt->nr_jobs; i++) {
+		struct zstd_mt_job *job = &mt->jobs[i];
+
+		job->mt = mt;
+		job->in = kvmalloc(mt->params.job_size, GFP_KERNEL);
+		job->out = kvmalloc(mt->out_cap, GFP_KERNEL);
+		job->workspace = kvmalloc(mt->cctx_size, GFP_KERNEL);
+		if (job->in == NULL || job->out == NULL ||
+		    job->workspace == NULL)
+			goto err;
+		job->cctx = zstd_init_cctx(job->workspace, mt->cctx_size);
+		if (job->cctx == NULL)
+			goto err;
+		INIT_WORK(&job->work, zstd_mt_work);
+		init_completion(&job->done);
+	}
+
+	return mt;
+
+err:
+	zstd_mt_free_cctx(mt);
+	return NULL;
+}
+EXPORT_SYMBOL(zstd_mt_init_cctx);
+
+int zstd_mt_compress_update(struct zstd_mt_cctx *mt, const void *src,
+	size_t len)
+{
+	const u8 *p = src;
+	int err;
+
+	if (mt->err)
+		return mt->err;
+
+	while (len) {
+		struct zstd_mt_job *job = &mt->jobs[mt->head];
+		size_t n;
+
+		if (mt->fill == 0) {
+			err = zstd_mt_drain_job(mt, job);
+			if (err) {
+				mt->err = err;
+				return err;
+			}
+		}
+
+		n = min(len, mt->params.job_size - mt->fill);
+		memcpy(job->in + mt->fill, p, n);
+		mt->fill += n;
+		p += n;
+		len -= n;
+
+		if (mt->fill == mt->params.job_size)
+			zstd_mt_submit(mt);
+	}
+
+	return 0;
+}
+EXPORT_SYMBOL(zstd_mt_compress_update);
+
+int zstd_mt_compress_end(struct zstd_mt_cctx *mt)
+{
+	unsigned int i;
+	int err = mt->err;
+
+	if (!err && mt->fill)
+		zstd_mt_submit(mt);
+
+	/* drain every in-flight job, oldest first */
+	for (i = 0; i < mt->nr_jobs; i++) {
+		int err2 = zstd_mt_drain_job(mt,
+				&mt->jobs[(mt->head + i) % mt->nr_jobs]);
+
+		if (err2 && !err)
+			err = err2;
+		/* suppress writes of jobs past the first failure */
+		if (err)
+			mt->err = err;
+	}
+
+	mt->err = err;
+	mt->fill = 0;
+
+	return err;
+}
+EXPORT_SYMBOL(zstd_mt_compress_end);
+
+void zstd_mt_free_cctx(struct zstd_mt_cctx *mt)
+{
+	unsigned int i;
+
+	if (mt == NULL)
+		return;
+
+	for (i = 0; mt->jobs != NULL && i < mt->nr_jobs; i++) {
+		struct zstd_mt_job *job = &mt->jobs[i];
+
+		if (job->pending)
+			wait_for_completion(&job->done);
+		kvfree(job->in);
+		kvfree(job->out);
+		kvfree(job->workspace);
+	}
+	kvfree(mt->jobs);
+	kfree(mt);
+}
+EXPORT_SYMBOL(zstd_mt_free_cctx);
@@ -14,6 +14,8 @@
 #include <linux/page_idle.h>
 #include <linux/pagewalk.h>
 #include <linux/sched/mm.h>
+#include <linux/slab.h>
+#include <linux/workqueue.h>
 
 #include "ops-common.h"
 
@@ -412,20 +414,17 @@ static void __damon_va_prepare_access_check(struct mm_struct *mm,
 	damon_va_mkold(mm, r->sampling_addr);
 }
 
-static void damon_va_prepare_access_checks(struct damon_ctx *ctx)
+static void damon_va_prepare_target(struct damon_target *t)
 {
-	struct damon_target *t;
 	struct mm_struct *mm;
 	struct damon_region *r;
 
-	damon_for_each_target(t, ctx) {
-		mm = damon_get_mm(t);
-		if (!mm)
-			continue;
-		damon_for_each_region(r, t)
-			__damon_va_prepare_access_check(mm, r);
-		mmput(mm);
-	}
+	mm = damon_get_mm(t);
+	if (!mm)
+		return;
+	damon_for_each_region(r, t)
+		__damon_va_prepare_access_check(mm, r);
+	mmput(mm);
 }
 
 struct damon_young_walk_private {
@@ -557,56 +556,141 @@ static bool damon_va_young(struct mm_struct *mm, unsigned long addr,
  * mm	'mm_struct' for the given virtual address space
  * r	the region to be checked
  */
+/* Result of the last access check, reusable for regions in the same page */
+struct damon_va_access_cache {
+	unsigned long last_addr;
+	unsigned long last_folio_sz;
+	bool last_accessed;
+};
+
 static void __damon_va_check_access(struct mm_struct *mm,
 				struct damon_region *r, bool same_target,
-				struct damon_attrs *attrs)
+				struct damon_attrs *attrs,
+				struct damon_va_access_cache *cache)
 {
-	static unsigned long last_addr;
-	static unsigned long last_folio_sz = PAGE_SIZE;
-	static bool last_accessed;
-
 	if (!mm) {
 		damon_update_region_access_rate(r, false, attrs);
 		return;
 	}
 
 	/* If the region is in the last checked page, reuse the result */
-	if (same_target && (ALIGN_DOWN(last_addr, last_folio_sz) ==
-				ALIGN_DOWN(r->sampling_addr, last_folio_sz))) {
-		damon_update_region_access_rate(r, last_accessed, attrs);
+	if (same_target && (ALIGN_DOWN(cache->last_addr, cache->last_folio_sz) ==
+				ALIGN_DOWN(r->sampling_addr,
+					cache->last_folio_sz))) {
+		damon_update_region_access_rate(r, cache->last_accessed, attrs);
 		return;
 	}
 
-	last_accessed = damon_va_young(mm, r->sampling_addr, &last_folio_sz);
-	damon_update_region_access_rate(r, last_accessed, attrs);
+	cache->last_accessed = damon_va_young(mm, r->sampling_addr,
+			&cache->last_folio_sz);
+	damon_update_region_access_rate(r, cache->last_accessed, attrs);
 
-	last_addr = r->sampling_addr;
+	cache->last_addr = r->sampling_addr;
 }
 
-static unsigned int damon_va_check_accesses(struct damon_ctx *ctx)
+static unsigned int damon_va_check_target(struct damon_target *t,
+		struct damon_attrs *attrs)
 {
-	struct damon_target *t;
+	struct damon_va_access_cache cache = { .last_folio_sz = PAGE_SIZE };
 	struct mm_struct *mm;
 	struct damon_region *r;
 	unsigned int max_nr_accesses = 0;
-	bool same_target;
+	bool same_target = false;
 
-	damon_for_each_target(t, ctx) {
-		mm = damon_get_mm(t);
-		same_target = false;
-		damon_for_each_region(r, t) {
-			__damon_va_check_access(mm, r, same_target,
-					&ctx->attrs);
-			max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
-			same_target = true;
+	mm = damon_get_mm(t);
+	damon_for_each_region(r, t) {
+		__damon_va_check_access(mm, r, same_target, attrs, &cache);
+		max_nr_accesses = max(r->nr_accesses, max_nr_accesses);
+		same_target = true;
+	}
+	if (mm)
+		mmput(mm);
+
+	return max_nr_accesses;
+}
+
+/*
+ * The page table walks for the sampling checks dominate the kdamond's CPU
+ * time on hosts with large multi-process target sets.  Since every target has
+ * its own mm, shard the walks across the unbound workqueue with one work item
+ * per target and merge the results when all items have finished.  The
+ * adaptive region split/merge logic still runs serially in the kdamond
+ * between sampling passes.
+ */
+struct damon_va_sample_work {
+	struct work_struct work;
+	struct damon_target *t;
+	struct damon_attrs *attrs;
+	unsigned int max_nr_accesses;
+};
+
+static void damon_va_sample_workfn(struct work_struct *work)
+{
+	struct damon_va_sample_work *w = container_of(work,
+			struct damon_va_sample_work, work);
+
+	/* attrs is only set for the access check phase */
+	if (w->attrs)
+		w->max_nr_accesses = damon_va_check_target(w->t, w->attrs);
+	else
+		damon_va_prepare_target(w->t);
+}
+
+static unsigned int damon_va_sample_targets(struct damon_ctx *ctx,
+		struct damon_attrs *attrs)
+{
+	struct damon_va_sample_work *works = NULL;
+	unsigned int max_nr_accesses = 0;
+	unsigned int nr_targets = 0, i = 0;
+	struct damon_target *t;
+
+	damon_for_each_target(t, ctx)
+		nr_targets++;
+
+	if (nr_targets > 1)
+		works = kcalloc(nr_targets, sizeof(*works), GFP_KERNEL);
+	if (!works) {
+		/* Single target, or keep sampling despite allocation failure */
+		damon_for_each_target(t, ctx) {
+			if (attrs)
+				max_nr_accesses = max(
+					damon_va_check_target(t, attrs),
+					max_nr_accesses);
+			else
+				damon_va_prepare_target(t);
 		}
-		if (mm)
-			mmput(mm);
+		return max_nr_accesses;
+	}
+
+	damon_for_each_target(t, ctx) {
+		struct damon_va_sample_work *w = &works[i++];
+
+		INIT_WORK(&w->work, damon_va_sample_workfn);
+		w->t = t;
+		w->attrs = attrs;
+		queue_work(system_unbound_wq, &w->work);
+	}
+
+	for (i = 0; i < nr_targets; i++) {
+		flush_work(&works[i].work);
+		max_nr_accesses = max(works[i].max_nr_accesses,
+				max_nr_accesses);
 	}
+	kfree(works);
 
 	return max_nr_accesses;
 }
 
+static void damon_va_prepare_access_checks(struct damon_ctx *ctx)
+{
+	damon_va_sample_targets(ctx, NULL);
+}
+
+static unsigned int damon_va_check_accesses(struct damon_ctx *ctx)
+{
+	return damon_va_sample_targets(ctx, &ctx->attrs);
+}
+
 /*
  * Functions for the target validity check and cleanup
  */
@@ -99,6 +99,18 @@ module_param_cb(sample_interval, &sample_interval_param_ops, &kfence_sample_inte
 static unsigned long kfence_skip_covered_thresh __read_mostly = 75;
 module_param_named(skip_covered_thresh, kfence_skip_covered_thresh, ulong, 0644);
 
+/*
+ * If non-zero, sample as often as the toggling overhead allows, rather than at
+ * the fixed sample_interval: the delay until re-arming the allocation gate is
+ * the measured cost of the last gate toggle multiplied by sample_budget, so at
+ * most 1/sample_budget of one CPU is ever spent toggling.  sample_interval
+ * then acts as the upper bound of the delay.  Only meaningful with
+ * CONFIG_KFENCE_STATIC_KEYS, where the toggle cost (IPIs to all CPUs) is what
+ * scales with machine size.
+ */
+static unsigned long kfence_sample_budget __read_mostly;
+module_param_named(sample_budget, kfence_sample_budget, ulong, 0644);
+
 /* If true, use a deferrable timer. */
 static bool kfence_deferrable __read_mostly = IS_ENABLED(CONFIG_KFENCE_DEFERRABLE);
 module_param_named(deferrable, kfence_deferrable, bool, 0444);
@@ -817,21 +829,52 @@ static DEFINE_IRQ_WORK(wake_up_kfence_timer_work, wake_up_kfence_timer);
  */
 static void toggle_allocation_gate(struct work_struct *work)
 {
+	unsigned long delay = msecs_to_jiffies(kfence_sample_interval);
+
 	if (!READ_ONCE(kfence_enabled))
 		return;
 
 	atomic_set(&kfence_allocation_gate, 0);
 #ifdef CONFIG_KFENCE_STATIC_KEYS
-	/* Enable static key, and await allocation to happen. */
-	static_branch_enable(&kfence_allocation_key);
+	{
+		static u64 toggle_cost_ns; /* exponential moving average */
+		unsigned long budget = READ_ONCE(kfence_sample_budget);
+		u64 cost;
+		ktime_t t;
+
+		/*
+		 * Measure only the static key toggles; the time the gate
+		 * stays open below is idle waiting, not overhead.
+		 */
+		t = ktime_get();
+		/* Enable static key, and await allocation to happen. */
+		static_branch_enable(&kfence_allocation_key);
+		cost = ktime_sub(ktime_get(), t);
 
-	wait_event_idle(allocation_wait, atomic_read(&kfence_allocation_gate));
+		wait_event_idle(allocation_wait, atomic_read(&kfence_allocation_gate));
 
-	/* Disable static key and reset timer. */
-	static_branch_disable(&kfence_allocation_key);
+		/* Disable static key and reset timer. */
+		t = ktime_get();
+		static_branch_disable(&kfence_allocation_key);
+		cost += ktime_sub(ktime_get(), t);
+
+		toggle_cost_ns = toggle_cost_ns ?
+			(toggle_cost_ns * 7 + cost) / 8 : cost;
+
+		if (budget) {
+			unsigned long min_delay =
+				nsecs_to_jiffies(toggle_cost_ns * budget);
+
+			/*
+			 * Sample as fast as the budget allows, but never
+			 * faster than once per jiffy and never slower than
+			 * the configured sample_interval.
+			 */
+			delay = clamp(min_delay, 1UL, delay);
+		}
+	}
 #endif
-	queue_delayed_work(system_unbound_wq, &kfence_timer,
-			   msecs_to_jiffies(kfence_sample_interval));
+	queue_delayed_work(system_unbound_wq, &kfence_timer, delay);
 }
 
 /* === Public interface ===================================================== */
@@ -35,6 +35,13 @@
 
 #define DEFAULT_MSIZE ((128 * 1024) + P9_IOHDRSZ)
 
+/*
+ * Payloads up to this size are copied through the fcall buffer rather
+ * than sent zero-copy: pinning and mapping user pages costs more than
+ * a sub-page memcpy, so "zero-copy for all sizes" is a loss below here.
+ */
+#define P9_ZC_MIN_SIZE 1024
+
 /* Client Option Parsing (code inspired by NFS code)
  *  - a little lazy - parse all client options
  */
@@ -1550,8 +1557,7 @@ p9_client_read_once(struct p9_fid *fid, u64 offset, struct iov_iter *to,
 	if (count < rsize)
 		rsize = count;
 
-	/* Don't bother zerocopy for small IO (< 1024) */
-	if (clnt->trans_mod->zc_request && rsize > 1024) {
+	if (clnt->trans_mod->zc_request && rsize > P9_ZC_MIN_SIZE) {
 		/* response header len is 11
 		 * PDU Header(7) + IO Size (4)
 		 */
@@ -1624,8 +1630,7 @@ p9_client_write(struct p9_fid *fid, u64 offset, struct iov_iter *from, int *err)
 		p9_debug(P9_DEBUG_9P, ">>> TWRITE fid %d offset %llu count %d (/%d)\n",
 			 fid->fid, offset, rsize, count);
 
-		/* Don't bother zerocopy for small IO (< 1024) */
-		if (clnt->trans_mod->zc_request && rsize > 1024) {
+		if (clnt->trans_mod->zc_request && rsize > P9_ZC_MIN_SIZE) {
 			req = p9_client_zc_rpc(clnt, P9_TWRITE, NULL, from, 0,
 					       rsize, P9_ZC_HDR_SZ, "dqd",
 					       fid->fid, offset, rsize);
@@ -1676,8 +1681,7 @@ p9_client_write_subreq(struct netfs_io_subrequest *subreq)
 	p9_debug(P9_DEBUG_9P, ">>> TWRITE fid %d offset %llu len %d\n",
 		 fid->fid, start, len);
 
-	/* Don't bother zerocopy for small IO (< 1024) */
-	if (clnt->trans_mod->zc_request && len > 1024) {
+	if (clnt->trans_mod->zc_request && len > P9_ZC_MIN_SIZE) {
 		req = p9_client_zc_rpc(clnt, P9_TWRITE, NULL, &subreq->io_iter,
 				       0, wreq->len, P9_ZC_HDR_SZ, "dqd",
 				       fid->fid, start, len);
@@ -2107,8 +2111,7 @@ int p9_client_readdir(struct p9_fid *fid, char *data, u32 count, u64 offset)
 	if (count < rsize)
 		rsize = count;
 
-	/* Don't bother zerocopy for small IO (< 1024) */
-	if (clnt->trans_mod->zc_request && rsize > 1024) {
+	if (clnt->trans_mod->zc_request && rsize > P9_ZC_MIN_SIZE) {
 		/* response header len is 11
 		 * PDU Header(7) + IO Size (4)
 		 */
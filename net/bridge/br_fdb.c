@@ -70,7 +70,7 @@ static inline int has_expired(const struct net_bridge *br,
 {
 	return !test_bit(BR_FDB_STATIC, &fdb->flags) &&
 	       !test_bit(BR_FDB_ADDED_BY_EXT_LEARN, &fdb->flags) &&
-	       time_before_eq(fdb->updated + hold_time(br), jiffies);
+	       time_before_eq(READ_ONCE(fdb->updated) + hold_time(br), jiffies);
 }
 
 static void fdb_rcu_free(struct rcu_head *head)
@@ -135,7 +135,7 @@ static int fdb_fill_info(struct sk_buff *skb, const struct net_bridge *br,
 
 	ci.ndm_used	 = jiffies_to_clock_t(now - fdb->used);
 	ci.ndm_confirmed = 0;
-	ci.ndm_updated	 = jiffies_to_clock_t(now - fdb->updated);
+	ci.ndm_updated	 = jiffies_to_clock_t(now - READ_ONCE(fdb->updated));
 	ci.ndm_refcnt	 = 0;
 	if (nla_put(skb, NDA_CACHEINFO, sizeof(ci), &ci))
 		goto nla_put_failure;
@@ -414,7 +414,8 @@ static struct net_bridge_fdb_entry *fdb_create(struct net_bridge *br,
 	WRITE_ONCE(fdb->dst, source);
 	fdb->key.vlan_id = vid;
 	fdb->flags = flags;
-	fdb->updated = fdb->used = jiffies;
+	fdb->used = jiffies;
+	WRITE_ONCE(fdb->updated, jiffies);
 	err = rhashtable_lookup_insert_fast(&br->fdb_hash_tbl, &fdb->rhnode,
 					    br_fdb_rht_params);
 	if (err) {
@@ -537,14 +538,36 @@ out:
 	spin_unlock_bh(&br->hash_lock);
 }
 
+/* Expired entries are deleted in batches so that a host bridging many
+ * thousands of MACs doesn't bounce the hash lock once per entry while
+ * the datapath is trying to learn under it.
+ */
+#define BR_FDB_CLEANUP_BATCH	32
+
+static void fdb_delete_batch(struct net_bridge *br,
+			     struct net_bridge_fdb_entry **fdbs,
+			     unsigned int n)
+{
+	unsigned int i;
+
+	spin_lock_bh(&br->hash_lock);
+	for (i = 0; i < n; i++) {
+		if (!hlist_unhashed(&fdbs[i]->fdb_node))
+			fdb_delete(br, fdbs[i], true);
+	}
+	spin_unlock_bh(&br->hash_lock);
+}
+
 void br_fdb_cleanup(struct work_struct *work)
 {
 	struct net_bridge *br = container_of(work, struct net_bridge,
 					     gc_work.work);
+	struct net_bridge_fdb_entry *expired[BR_FDB_CLEANUP_BATCH];
 	struct net_bridge_fdb_entry *f = NULL;
 	unsigned long delay = hold_time(br);
 	unsigned long work_delay = delay;
 	unsigned long now = jiffies;
+	unsigned int nr_expired = 0;
 
 	/* this part is tricky, in order to avoid blocking learning and
 	 * consequently forwarding, we rely on rcu to delete objects with
@@ -552,7 +575,7 @@ void br_fdb_cleanup(struct work_struct *work)
 	 */
 	rcu_read_lock();
 	hlist_for_each_entry_rcu(f, &br->fdb_list, fdb_node) {
-		unsigned long this_timer = f->updated + delay;
+		unsigned long this_timer = READ_ONCE(f->updated) + delay;
 
 		if (test_bit(BR_FDB_STATIC, &f->flags) ||
 		    test_bit(BR_FDB_ADDED_BY_EXT_LEARN, &f->flags)) {
@@ -570,12 +593,15 @@ void br_fdb_cleanup(struct work_struct *work)
 		if (time_after(this_timer, now)) {
 			work_delay = min(work_delay, this_timer - now);
 		} else {
-			spin_lock_bh(&br->hash_lock);
-			if (!hlist_unhashed(&f->fdb_node))
-				fdb_delete(br, f, true);
-			spin_unlock_bh(&br->hash_lock);
+			expired[nr_expired++] = f;
+			if (nr_expired == BR_FDB_CLEANUP_BATCH) {
+				fdb_delete_batch(br, expired, nr_expired);
+				nr_expired = 0;
+			}
 		}
 	}
+	if (nr_expired)
+		fdb_delete_batch(br, expired, nr_expired);
 	rcu_read_unlock();
 
 	/* Cleanup minimum 10 milliseconds apart */
@@ -859,7 +885,7 @@ int br_fdb_fillbuf(struct net_bridge *br, void *buf,
 
 		fe->is_local = test_bit(BR_FDB_LOCAL, &f->flags);
 		if (!test_bit(BR_FDB_STATIC, &f->flags))
-			fe->ageing_timer_value = jiffies_delta_to_clock_t(jiffies - f->updated);
+			fe->ageing_timer_value = jiffies_delta_to_clock_t(jiffies - READ_ONCE(f->updated));
 		++fe;
 		++num;
 	}
@@ -907,8 +933,8 @@ void br_fdb_update(struct net_bridge *br, struct net_bridge_port *source,
 			unsigned long now = jiffies;
 			bool fdb_modified = false;
 
-			if (now != fdb->updated) {
-				fdb->updated = now;
+			if (now != READ_ONCE(fdb->updated)) {
+				WRITE_ONCE(fdb->updated, now);
 				fdb_modified = __fdb_mark_active(fdb);
 			}
 
@@ -1149,7 +1175,7 @@ static int fdb_add_entry(struct net_bridge *br, struct net_bridge_port *source,
 	fdb->used = jiffies;
 	if (modified) {
 		if (refresh)
-			fdb->updated = jiffies;
+			WRITE_ONCE(fdb->updated, jiffies);
 		fdb_notify(br, fdb, RTM_NEWNEIGH, true);
 	}
 
@@ -1462,7 +1488,7 @@ int br_fdb_external_learn_add(struct net_bridge *br, struct net_bridge_port *p,
 			goto err_unlock;
 		}
 
-		fdb->updated = jiffies;
+		WRITE_ONCE(fdb->updated, jiffies);
 
 		if (READ_ONCE(fdb->dst) != p) {
 			WRITE_ONCE(fdb->dst, p);
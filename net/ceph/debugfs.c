@@ -346,8 +346,8 @@ static int osdc_show(struct seq_file *s, void *pp)
 	struct rb_node *n;
 
 	down_read(&osdc->lock);
-	seq_printf(s, "REQUESTS %d homeless %d\n",
-		   atomic_read(&osdc->num_requests),
+	seq_printf(s, "REQUESTS %lld homeless %d\n",
+		   percpu_counter_sum(&osdc->num_requests),
 		   atomic_read(&osdc->num_homeless));
 	for (n = rb_first(&osdc->osds); n; n = rb_next(n)) {
 		struct ceph_osd *osd = rb_entry(n, struct ceph_osd, o_node);
@@ -1409,8 +1409,9 @@ struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
 	struct subflow_send_info send_info[SSK_MODE_MAX];
 	struct mptcp_subflow_context *subflow;
 	struct sock *sk = (struct sock *)msk;
-	u32 pace, burst, wmem;
+	u32 pace, burst, wmem, cwnd_gap;
 	int i, nr_active = 0;
+	struct tcp_sock *tp;
 	struct sock *ssk;
 	u64 linger_time;
 	long tout = 0;
@@ -1465,7 +1466,17 @@ struct sock *mptcp_subflow_get_send(struct mptcp_sock *msk)
 	if (!ssk || !sk_stream_memory_free(ssk))
 		return NULL;
 
-	burst = min_t(int, MPTCP_SEND_BURST_SIZE, mptcp_wnd_end(msk) - msk->snd_nxt);
+	/* Size the burst to the subflow's free cwnd space: committing a
+	 * longer train than the path can put on the wire just grows the
+	 * subflow queue and delays rescheduling to a faster path, while a
+	 * couple of segments are always allowed to keep the pipe busy.
+	 */
+	tp = tcp_sk(ssk);
+	cwnd_gap = tcp_snd_cwnd(tp) - min(tcp_snd_cwnd(tp),
+					  tcp_packets_in_flight(tp));
+	burst = clamp_t(u32, cwnd_gap * tp->mss_cache,
+			2 * tp->mss_cache, MPTCP_SEND_BURST_SIZE);
+	burst = min_t(int, burst, mptcp_wnd_end(msk) - msk->snd_nxt);
 	wmem = READ_ONCE(ssk->sk_wmem_queued);
 	if (!burst)
 		return ssk;
@@ -28,6 +28,7 @@
 #include <linux/udp.h>
 #include <linux/icmp.h>
 #include <linux/icmpv6.h>
+#include <linux/prefetch.h>
 #include <linux/rculist.h>
 #include <linux/sort.h>
 #include <net/ip.h>
@@ -752,6 +753,7 @@ static struct sw_flow *flow_lookup(struct flow_table *tbl,
 	}
 
 	for (i = 0; i < ma->max; i++)  {
+		struct sw_flow_mask *next;
 
 		if (i == *index)
 			continue;
@@ -760,6 +762,16 @@ static struct sw_flow *flow_lookup(struct flow_table *tbl,
 		if (unlikely(!mask))
 			break;
 
+		/* Start pulling in the next mask's range and key whilst this
+		 * one is being probed; the mask walk otherwise stalls on a
+		 * cache miss per mask.
+		 */
+		if (i + 1 < ma->max) {
+			next = rcu_dereference_ovsl(ma->masks[i + 1]);
+			if (next)
+				prefetch(&next->range);
+		}
+
 		flow = masked_flow_lookup(ti, key, mask, n_mask_hit);
 		if (flow) { /* Found */
 			*index = i;
@@ -814,6 +826,16 @@ struct sw_flow *ovs_flow_tbl_lookup_stats(struct flow_table *tbl,
 	hash = skb_hash;
 	entries = this_cpu_ptr(mc->mask_cache);
 
+	/* The candidate entries lie in up to MC_HASH_SEGS scattered cache
+	 * lines; issue the prefetches up front so that their misses overlap
+	 * rather than serialise through the segment walk below.
+	 */
+	for (seg = 0; seg < MC_HASH_SEGS; seg++) {
+		prefetch(&entries[hash & (mc->cache_size - 1)]);
+		hash >>= MC_HASH_SHIFT;
+	}
+	hash = skb_hash;
+
 	/* Find the cache entry 'ce' to operate on. */
 	for (seg = 0; seg < MC_HASH_SEGS; seg++) {
 		int index = hash & (mc->cache_size - 1);
@@ -2208,11 +2208,11 @@ static int packet_rcv(struct sk_buff *skb, struct net_device *dev,
 	nf_reset_ct(skb);
 
 	spin_lock(&sk->sk_receive_queue.lock);
-	po->stats.stats1.tp_packets++;
 	sock_skb_set_dropcount(sk, skb);
 	skb_clear_delivery_time(skb);
 	__skb_queue_tail(&sk->sk_receive_queue, skb);
 	spin_unlock(&sk->sk_receive_queue.lock);
+	atomic_inc(&po->tp_packets);
 	sk->sk_data_ready(sk);
 	return 0;
 
@@ -2386,13 +2386,13 @@ static int tpacket_rcv(struct sk_buff *skb, struct net_device *dev,
 			status |= TP_STATUS_LOSING;
 	}
 
-	po->stats.stats1.tp_packets++;
 	if (copy_skb) {
 		status |= TP_STATUS_COPY;
 		skb_clear_delivery_time(copy_skb);
 		__skb_queue_tail(&sk->sk_receive_queue, copy_skb);
 	}
 	spin_unlock(&sk->sk_receive_queue.lock);
+	atomic_inc(&po->tp_packets);
 
 	skb_copy_bits(skb, 0, h.raw + macoff, snaplen);
 
@@ -4057,26 +4057,30 @@ static int packet_getsockopt(struct socket *sock, int level, int optname,
 		return -EINVAL;
 
 	switch (optname) {
-	case PACKET_STATISTICS:
+	case PACKET_STATISTICS: {
+		unsigned int pkts;
+
 		spin_lock_bh(&sk->sk_receive_queue.lock);
 		memcpy(&st, &po->stats, sizeof(st));
 		memset(&po->stats, 0, sizeof(po->stats));
 		spin_unlock_bh(&sk->sk_receive_queue.lock);
 		drops = atomic_xchg(&po->tp_drops, 0);
+		pkts = atomic_xchg(&po->tp_packets, 0);
 
 		if (po->tp_version == TPACKET_V3) {
 			lv = sizeof(struct tpacket_stats_v3);
 			st.stats3.tp_drops = drops;
-			st.stats3.tp_packets += drops;
+			st.stats3.tp_packets = pkts + drops;
 			data = &st.stats3;
 		} else {
 			lv = sizeof(struct tpacket_stats);
 			st.stats1.tp_drops = drops;
-			st.stats1.tp_packets += drops;
+			st.stats1.tp_packets = pkts + drops;
 			data = &st.stats1;
 		}
 
 		break;
+	}
 	case PACKET_AUXDATA:
 		val = packet_sock_flag(po, PACKET_SOCK_AUXDATA);
 		break;
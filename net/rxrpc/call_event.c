@@ -172,6 +172,9 @@ void rxrpc_resend(struct rxrpc_call *call, struct sk_buff *ack_skb)
 
 no_further_resend:
 no_resend:
+	if (did_send)
+		rxrpc_transmit_end(call);
+
 	if (resend_at < KTIME_MAX) {
 		delay = rxrpc_get_rto_backoff(call->peer, did_send);
 		resend_at = ktime_add(resend_at, delay);
@@ -249,6 +252,7 @@ static bool rxrpc_tx_window_has_space(struct rxrpc_call *call)
 static void rxrpc_decant_prepared_tx(struct rxrpc_call *call)
 {
 	struct rxrpc_txbuf *txb;
+	bool sent = false;
 
 	if (!test_bit(RXRPC_CALL_EXPOSED, &call->flags)) {
 		if (list_empty(&call->tx_sendmsg))
@@ -268,11 +272,15 @@ static void rxrpc_decant_prepared_tx(struct rxrpc_call *call)
 		if (txb->flags & RXRPC_LAST_PACKET)
 			rxrpc_close_tx_phase(call);
 
-		rxrpc_transmit_one(call, txb);
+		if (rxrpc_transmit_one(call, txb) >= 0)
+			sent = true;
 
 		if (!rxrpc_tx_window_has_space(call))
 			break;
 	}
+
+	if (sent)
+		rxrpc_transmit_end(call);
 }
 
 static void rxrpc_transmit_some_data(struct rxrpc_call *call)
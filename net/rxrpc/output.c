@@ -422,8 +422,6 @@ static void rxrpc_tstamp_data_packets(struct rxrpc_call *call, struct rxrpc_txbu
 		call->expect_rx_by = ktime_add(now, delay);
 		trace_rxrpc_timer_set(call, delay, rxrpc_timer_trace_expect_rx);
 	}
-
-	rxrpc_set_keepalive(call, now);
 }
 
 /*
@@ -704,9 +702,10 @@ static inline void rxrpc_instant_resend(struct rxrpc_call *call,
 }
 
 /*
- * Transmit one packet.
+ * Transmit one packet as part of a train.  The timers are left for the caller
+ * to update once for the whole train with rxrpc_transmit_end().
  */
-void rxrpc_transmit_one(struct rxrpc_call *call, struct rxrpc_txbuf *txb)
+int rxrpc_transmit_one(struct rxrpc_call *call, struct rxrpc_txbuf *txb)
 {
 	int ret;
 
@@ -723,10 +722,22 @@ void rxrpc_transmit_one(struct rxrpc_call *call, struct rxrpc_txbuf *txb)
 			_debug("need instant resend %d", ret);
 			rxrpc_instant_resend(call, txb);
 		}
-	} else {
-		ktime_t delay = ns_to_ktime(call->peer->rto_us * NSEC_PER_USEC);
-
-		call->resend_at = ktime_add(ktime_get_real(), delay);
-		trace_rxrpc_timer_set(call, delay, rxrpc_timer_trace_resend_tx);
 	}
+
+	return ret;
+}
+
+/*
+ * Finish a train of transmissions.  The resend and keepalive timers only need
+ * pushing out once per train, not once per constituent packet.
+ */
+void rxrpc_transmit_end(struct rxrpc_call *call)
+{
+	ktime_t now = ktime_get_real();
+	ktime_t delay = ns_to_ktime(call->peer->rto_us * NSEC_PER_USEC);
+
+	call->resend_at = ktime_add(now, delay);
+	trace_rxrpc_timer_set(call, delay, rxrpc_timer_trace_resend_tx);
+
+	rxrpc_set_keepalive(call, now);
 }
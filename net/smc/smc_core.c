@@ -124,7 +124,7 @@ static int smcr_lgr_conn_assign_link(struct smc_connection *conn, bool first)
 {
 	enum smc_link_state expected = first ? SMC_LNK_ACTIVATING :
 				       SMC_LNK_ACTIVE;
-	int i, j;
+	int i;
 
 	/* do link balancing */
 	conn->lnk = NULL;	/* reset conn->lnk first */
@@ -137,21 +137,14 @@ static int smcr_lgr_conn_assign_link(struct smc_connection *conn, bool first)
 			conn->lnk = lnk; /* temporary, SMC server assigns link*/
 			break;
 		}
-		if (conn->lgr->conns_num % 2) {
-			for (j = i + 1; j < SMC_LINKS_PER_LGR_MAX; j++) {
-				struct smc_link *lnk2;
-
-				lnk2 = &conn->lgr->lnk[j];
-				if (lnk2->state == expected &&
-				    !lnk2->link_is_asym) {
-					conn->lnk = lnk2;
-					break;
-				}
-			}
-		}
-		if (!conn->lnk)
+		/* the server assigns the link carrying the fewest
+		 * connections; alternating by connection count parity
+		 * drifts badly once long-lived connections close unevenly
+		 */
+		if (!conn->lnk ||
+		    atomic_read(&lnk->conn_cnt) <
+		    atomic_read(&conn->lnk->conn_cnt))
 			conn->lnk = lnk;
-		break;
 	}
 	if (!conn->lnk)
 		return SMC_CLC_DECL_NOACTLINK;
@@ -37,7 +37,7 @@
 
 static void svc_unregister(const struct svc_serv *serv, struct net *net);
 
-#define SVC_POOL_DEFAULT	SVC_POOL_GLOBAL
+#define SVC_POOL_DEFAULT	SVC_POOL_AUTO
 
 /*
  * Mode for mapping cpus to pools.
@@ -450,6 +450,8 @@ __svc_init_bc(struct svc_serv *serv)
 /*
  * Create an RPC service
  */
+static void svc_scale_worker(struct work_struct *work);
+
 static struct svc_serv *
 __svc_create(struct svc_program *prog, struct svc_stat *stats,
 	     unsigned int bufsize, int npools, int (*threadfn)(void *data))
@@ -487,6 +489,8 @@ __svc_create(struct svc_program *prog, struct svc_stat *stats,
 	INIT_LIST_HEAD(&serv->sv_permsocks);
 	timer_setup(&serv->sv_temptimer, NULL, 0);
 	spin_lock_init(&serv->sv_lock);
+	mutex_init(&serv->sv_scale_mutex);
+	INIT_WORK(&serv->sv_scale_work, svc_scale_worker);
 
 	__svc_init_bc(serv);
 
@@ -573,6 +577,7 @@ svc_destroy(struct svc_serv **servp)
 	*servp = NULL;
 
 	dprintk("svc: svc_destroy(%s)\n", serv->sv_program->pg_name);
+	cancel_work_sync(&serv->sv_scale_work);
 	timer_shutdown_sync(&serv->sv_temptimer);
 
 	/*
@@ -700,8 +705,11 @@ svc_prepare_thread(struct svc_serv *serv, struct svc_pool *pool, int node)
  * service thread and marking it BUSY is atomic with respect to
  * other calls to svc_pool_wake_idle_thread().
  *
+ * Return values:
+ *   %true: an idle thread was found
+ *   %false: every thread in @pool is busy
  */
-void svc_pool_wake_idle_thread(struct svc_pool *pool)
+bool svc_pool_wake_idle_thread(struct svc_pool *pool)
 {
 	struct svc_rqst	*rqstp;
 	struct llist_node *ln;
@@ -717,13 +725,31 @@ void svc_pool_wake_idle_thread(struct svc_pool *pool)
 			percpu_counter_inc(&pool->sp_threads_woken);
 		}
 		rcu_read_unlock();
-		return;
+		return true;
 	}
 	rcu_read_unlock();
-
+	return false;
 }
 EXPORT_SYMBOL_GPL(svc_pool_wake_idle_thread);
 
+/**
+ * svc_pool_grow_on_demand - note that a pool had work but no idle thread
+ * @serv: RPC service to which @pool belongs
+ * @pool: service thread pool that was found congested
+ *
+ * Ask the scale worker to add a thread to @pool, if the service allows
+ * auto-scaling and the pool is below its cap. Can be called from soft
+ * IRQ or process context.
+ */
+void svc_pool_grow_on_demand(struct svc_serv *serv, struct svc_pool *pool)
+{
+	if (!serv->sv_max_pool_threads ||
+	    atomic_read(&pool->sp_nrthreads) >= serv->sv_max_pool_threads)
+		return;
+	if (!test_and_set_bit(SP_NEED_THREAD, &pool->sp_flags))
+		queue_work(system_unbound_wq, &serv->sv_scale_work);
+}
+
 static struct svc_pool *
 svc_pool_next(struct svc_serv *serv, struct svc_pool *pool, unsigned int *state)
 {
@@ -817,6 +843,34 @@ svc_stop_kthreads(struct svc_serv *serv, struct svc_pool *pool, int nrservs)
 	return 0;
 }
 
+/*
+ * Add threads to pools that svc_xprt_enqueue() found congested. Racing
+ * with service shutdown is resolved by sv_scale_mutex: once the last
+ * nfsd thread has been counted out we must not start another one.
+ */
+static void
+svc_scale_worker(struct work_struct *work)
+{
+	struct svc_serv *serv = container_of(work, struct svc_serv,
+					     sv_scale_work);
+	unsigned int i;
+
+	mutex_lock(&serv->sv_scale_mutex);
+	for (i = 0; i < serv->sv_nrpools; i++) {
+		struct svc_pool *pool = &serv->sv_pools[i];
+
+		if (!test_and_clear_bit(SP_NEED_THREAD, &pool->sp_flags))
+			continue;
+		if (!serv->sv_nrthreads)
+			continue;
+		if (atomic_read(&pool->sp_nrthreads) >= serv->sv_max_pool_threads)
+			continue;
+		if (svc_start_kthreads(serv, pool, 1) < 0)
+			break;
+	}
+	mutex_unlock(&serv->sv_scale_mutex);
+}
+
 /**
  * svc_set_num_threads - adjust number of threads per RPC service
  * @serv: RPC service to adjust
@@ -837,16 +891,20 @@ svc_stop_kthreads(struct svc_serv *serv, struct svc_pool *pool, int nrservs)
 int
 svc_set_num_threads(struct svc_serv *serv, struct svc_pool *pool, int nrservs)
 {
+	int ret = 0;
+
+	mutex_lock(&serv->sv_scale_mutex);
 	if (!pool)
 		nrservs -= serv->sv_nrthreads;
 	else
 		nrservs -= atomic_read(&pool->sp_nrthreads);
 
 	if (nrservs > 0)
-		return svc_start_kthreads(serv, pool, nrservs);
-	if (nrservs < 0)
-		return svc_stop_kthreads(serv, pool, nrservs);
-	return 0;
+		ret = svc_start_kthreads(serv, pool, nrservs);
+	else if (nrservs < 0)
+		ret = svc_stop_kthreads(serv, pool, nrservs);
+	mutex_unlock(&serv->sv_scale_mutex);
+	return ret;
 }
 EXPORT_SYMBOL_GPL(svc_set_num_threads);
 
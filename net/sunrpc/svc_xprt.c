@@ -489,7 +489,8 @@ void svc_xprt_enqueue(struct svc_xprt *xprt)
 	percpu_counter_inc(&pool->sp_sockets_queued);
 	lwq_enqueue(&xprt->xpt_ready, &pool->sp_xprts);
 
-	svc_pool_wake_idle_thread(pool);
+	if (!svc_pool_wake_idle_thread(pool))
+		svc_pool_grow_on_demand(xprt->xpt_server, pool);
 }
 EXPORT_SYMBOL_GPL(svc_xprt_enqueue);
 
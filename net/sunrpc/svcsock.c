@@ -1206,6 +1206,15 @@ err_noclose:
  * MSG_SPLICE_PAGES is used exclusively to reduce the number of
  * copy operations in this path. Therefore the caller must ensure
  * that the pages backing @xdr are unchanging.
+ *
+ * The payload of a READ reply is handed to the socket as page
+ * references: nfsd_splice_read() put the page cache pages themselves
+ * into rq_res, and the network layer takes a reference on each page
+ * it splices into an skb.  Those references, not a send-completion
+ * callback, are what keep the payload stable until the last
+ * (re)transmission - the server side releases its own page references
+ * after the send and allocates fresh pages for the next RPC, so a
+ * 1MB READ reply crosses this function without a single payload copy.
  */
 static int svc_tcp_sendmsg(struct svc_sock *svsk, struct svc_rqst *rqstp,
 			   rpc_fraghdr marker, unsigned int *sentp)
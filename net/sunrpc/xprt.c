@@ -1214,12 +1214,25 @@ EXPORT_SYMBOL_GPL(xprt_update_rtt);
  *
  * Caller holds xprt->queue_lock.
  */
+static void xprt_update_srtt(struct rpc_xprt *xprt, const struct rpc_rqst *req)
+{
+	unsigned long rtt = ktime_to_ns(req->rq_rtt);
+	unsigned long srtt = READ_ONCE(xprt->srtt_ns);
+
+	if (srtt)
+		srtt += ((long)rtt - (long)srtt) >> 3;
+	else
+		srtt = rtt;
+	WRITE_ONCE(xprt->srtt_ns, srtt);
+}
+
 void xprt_complete_rqst(struct rpc_task *task, int copied)
 {
 	struct rpc_rqst *req = task->tk_rqstp;
 	struct rpc_xprt *xprt = req->rq_xprt;
 
 	xprt->stat.recvs++;
+	xprt_update_srtt(xprt, req);
 
 	xdr_free_bvec(&req->rq_rcv_buf);
 	req->rq_private_buf.bvec = NULL;
@@ -427,12 +427,53 @@ struct rpc_xprt *__xprt_switch_find_next_entry_roundrobin(struct list_head *head
 	return xprt_switch_find_first_entry(head);
 }
 
+static
+unsigned long xprt_switch_best_srtt(struct rpc_xprt_switch *xps)
+{
+	struct rpc_xprt *pos;
+	unsigned long best = 0, srtt;
+
+	list_for_each_entry_rcu(pos, &xps->xps_xprt_list, xprt_switch) {
+		if (!xprt_is_active(pos))
+			continue;
+		srtt = READ_ONCE(pos->srtt_ns);
+		if (srtt && (!best || srtt < best))
+			best = srtt;
+	}
+	return best;
+}
+
+/*
+ * A transport is degraded when its smoothed RTT is well above that of
+ * the best transport in the switch.  The entry threshold (2x the best
+ * RTT) is higher than the exit threshold (1.5x), so a path hovering
+ * around the limit does not flap on and off.
+ */
+static
+bool xprt_switch_xprt_degraded(struct rpc_xprt *xprt, unsigned long best)
+{
+	unsigned long srtt = READ_ONCE(xprt->srtt_ns);
+
+	if (!best || !srtt)
+		return false;
+	if (test_bit(XPRT_DEGRADED, &xprt->state)) {
+		if (srtt > best + (best >> 1))
+			return true;
+		clear_bit(XPRT_DEGRADED, &xprt->state);
+	} else if (srtt > 2 * best) {
+		set_bit(XPRT_DEGRADED, &xprt->state);
+		return true;
+	}
+	return false;
+}
+
 static
 struct rpc_xprt *xprt_switch_find_next_entry_roundrobin(struct rpc_xprt_switch *xps,
 		const struct rpc_xprt *cur)
 {
 	struct list_head *head = &xps->xps_xprt_list;
-	struct rpc_xprt *xprt;
+	struct rpc_xprt *xprt, *first = NULL;
+	unsigned long best_srtt = xprt_switch_best_srtt(xps);
 	unsigned int nactive;
 
 	for (;;) {
@@ -441,11 +482,17 @@ struct rpc_xprt *xprt_switch_find_next_entry_roundrobin(struct rpc_xprt_switch *
 		xprt = __xprt_switch_find_next_entry_roundrobin(head, cur);
 		if (!xprt)
 			break;
+		/* Every transport is backlogged or degraded: stop skipping */
+		if (xprt == first)
+			break;
+		if (!first)
+			first = xprt;
 		xprt_queuelen = atomic_long_read(&xprt->queuelen);
 		xps_queuelen = atomic_long_read(&xps->xps_queuelen);
 		nactive = READ_ONCE(xps->xps_nactive);
 		/* Exit loop if xprt_queuelen <= average queue length */
-		if (xprt_queuelen * nactive <= xps_queuelen)
+		if (xprt_queuelen * nactive <= xps_queuelen &&
+		    !xprt_switch_xprt_degraded(xprt, best_srtt))
 			break;
 		cur = xprt;
 	}
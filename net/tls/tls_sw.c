@@ -362,9 +362,15 @@ static struct tls_rec *tls_get_rec(struct sock *sk)
 
 	mem_size = sizeof(struct tls_rec) + crypto_aead_reqsize(ctx->aead_send);
 
-	rec = kzalloc(mem_size, sk->sk_allocation);
-	if (!rec)
-		return NULL;
+	rec = ctx->rec_cache;
+	if (rec) {
+		ctx->rec_cache = NULL;
+		memset(rec, 0, mem_size);
+	} else {
+		rec = kzalloc(mem_size, sk->sk_allocation);
+		if (!rec)
+			return NULL;
+	}
 
 	msg_pl = &rec->msg_plaintext;
 	msg_en = &rec->msg_encrypted;
@@ -385,11 +391,26 @@ static struct tls_rec *tls_get_rec(struct sock *sk)
 	return rec;
 }
 
+/* Retire a record whose sk_msgs have been freed already. The most
+ * recently retired record is kept for the next tls_get_rec() so that bulk
+ * transfers do not go through the allocator once per record. Caller holds
+ * the socket lock.
+ */
+static void tls_rec_put(struct sock *sk, struct tls_rec *rec)
+{
+	struct tls_sw_context_tx *ctx = tls_sw_ctx_tx(tls_get_ctx(sk));
+
+	if (!ctx->rec_cache)
+		ctx->rec_cache = rec;
+	else
+		kfree(rec);
+}
+
 static void tls_free_rec(struct sock *sk, struct tls_rec *rec)
 {
 	sk_msg_free(sk, &rec->msg_encrypted);
 	sk_msg_free(sk, &rec->msg_plaintext);
-	kfree(rec);
+	tls_rec_put(sk, rec);
 }
 
 static void tls_free_open_rec(struct sock *sk)
@@ -430,7 +451,7 @@ int tls_tx_records(struct sock *sk, int flags)
 		 */
 		list_del(&rec->list);
 		sk_msg_free(sk, &rec->msg_plaintext);
-		kfree(rec);
+		tls_rec_put(sk, rec);
 	}
 
 	/* Tx all ready records */
@@ -450,7 +471,7 @@ int tls_tx_records(struct sock *sk, int flags)
 
 			list_del(&rec->list);
 			sk_msg_free(sk, &rec->msg_plaintext);
-			kfree(rec);
+			tls_rec_put(sk, rec);
 		} else {
 			break;
 		}
@@ -2492,6 +2513,7 @@ void tls_sw_free_ctx_tx(struct tls_context *tls_ctx)
 {
 	struct tls_sw_context_tx *ctx = tls_sw_ctx_tx(tls_ctx);
 
+	kfree(ctx->rec_cache);
 	kfree(ctx);
 }
 
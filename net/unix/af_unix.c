@@ -2190,6 +2190,7 @@ static int queue_oob(struct socket *sock, struct msghdr *msg, struct sock *other
 static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 			       size_t len)
 {
+	struct ubuf_info *uarg = NULL;
 	struct sock *sk = sock->sk;
 	struct sock *other = NULL;
 	int err, size;
@@ -2203,6 +2204,15 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 	if (err < 0)
 		return err;
 
+	if (msg->msg_flags & MSG_ZEROCOPY && len &&
+	    sock_flag(sk, SOCK_ZEROCOPY)) {
+		uarg = msg_zerocopy_realloc(sk, len, NULL);
+		if (!uarg) {
+			err = -ENOBUFS;
+			goto out_err;
+		}
+	}
+
 	wait_for_unix_gc(scm.fp);
 
 	err = -EOPNOTSUPP;
@@ -2231,7 +2241,7 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 	while (sent < len) {
 		size = len - sent;
 
-		if (unlikely(msg->msg_flags & MSG_SPLICE_PAGES)) {
+		if (uarg || unlikely(msg->msg_flags & MSG_SPLICE_PAGES)) {
 			skb = sock_alloc_send_pskb(sk, 0, 0,
 						   msg->msg_flags & MSG_DONTWAIT,
 						   &err, 0);
@@ -2261,7 +2271,26 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 		}
 		fds_sent = true;
 
-		if (unlikely(msg->msg_flags & MSG_SPLICE_PAGES)) {
+		if (uarg) {
+			unsigned int orig_truesize = skb->truesize;
+			int added;
+
+			err = skb_zerocopy_iter_stream(sk, skb, msg, size, uarg);
+			if (err < 0) {
+				kfree_skb(skb);
+				goto out_err;
+			}
+			size = err;
+
+			/* __zerocopy_sg_from_iter() charges the pinned
+			 * pages to sk_wmem_queued as for TCP; AF_UNIX skbs
+			 * are accounted against sk_wmem_alloc instead, so
+			 * move the charge over for sock_wfree().
+			 */
+			added = skb->truesize - orig_truesize;
+			sk_wmem_queued_add(sk, -added);
+			refcount_add(added, &sk->sk_wmem_alloc);
+		} else if (unlikely(msg->msg_flags & MSG_SPLICE_PAGES)) {
 			err = skb_splice_from_iter(skb, &msg->msg_iter, size,
 						   sk->sk_allocation);
 			if (err < 0) {
@@ -2304,6 +2333,7 @@ static int unix_stream_sendmsg(struct socket *sock, struct msghdr *msg,
 	}
 #endif
 
+	net_zcopy_put(uarg);
 	scm_destroy(&scm);
 
 	return sent;
@@ -2316,6 +2346,7 @@ pipe_err:
 		send_sig(SIGPIPE, current, 0);
 	err = -EPIPE;
 out_err:
+	net_zcopy_put_abort(uarg, true);
 	scm_destroy(&scm);
 	return sent ? : err;
 }
@@ -2909,12 +2940,18 @@ static int unix_stream_recvmsg(struct socket *sock, struct msghdr *msg,
 		.flags = flags
 	};
 
+	/* MSG_ZEROCOPY completion notifications */
+	if (unlikely(flags & MSG_ERRQUEUE))
+		return sock_recv_errqueue(sock->sk, msg, size, SOL_SOCKET, 0);
+
 #ifdef CONFIG_BPF_SYSCALL
-	struct sock *sk = sock->sk;
-	const struct proto *prot = READ_ONCE(sk->sk_prot);
+	{
+		struct sock *sk = sock->sk;
+		const struct proto *prot = READ_ONCE(sk->sk_prot);
 
-	if (prot != &unix_stream_proto)
-		return prot->recvmsg(sk, msg, size, flags, NULL);
+		if (prot != &unix_stream_proto)
+			return prot->recvmsg(sk, msg, size, flags, NULL);
+	}
 #endif
 	return unix_stream_read_generic(&state, true);
 }
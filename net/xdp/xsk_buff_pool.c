@@ -44,8 +44,9 @@ void xp_destroy(struct xsk_buff_pool *pool)
 
 int xp_alloc_tx_descs(struct xsk_buff_pool *pool, struct xdp_sock *xs)
 {
-	pool->tx_descs = kvcalloc(xs->tx->nentries, sizeof(*pool->tx_descs),
-				  GFP_KERNEL);
+	pool->tx_descs = kvcalloc_node(xs->tx->nentries,
+				       sizeof(*pool->tx_descs),
+				       GFP_KERNEL, pool->numa_node);
 	if (!pool->tx_descs)
 		return -ENOMEM;
 
@@ -53,19 +54,30 @@ int xp_alloc_tx_descs(struct xsk_buff_pool *pool, struct xdp_sock *xs)
 }
 
 struct xsk_buff_pool *xp_create_and_assign_umem(struct xdp_sock *xs,
-						struct xdp_umem *umem)
+						struct xdp_umem *umem,
+						struct net_device *dev)
 {
 	bool unaligned = umem->flags & XDP_UMEM_UNALIGNED_CHUNK_FLAG;
 	struct xsk_buff_pool *pool;
 	struct xdp_buff_xsk *xskb;
 	u32 i, entries;
+	int node;
+
+	/* Keep the pool metadata that the data path walks on the node of
+	 * the device the socket is bound to, not of the binding CPU.
+	 */
+	node = dev->dev.parent ? dev_to_node(dev->dev.parent) : NUMA_NO_NODE;
 
 	entries = unaligned ? umem->chunks : 0;
-	pool = kvzalloc(struct_size(pool, free_heads, entries),	GFP_KERNEL);
+	pool = kvzalloc_node(struct_size(pool, free_heads, entries),
+			     GFP_KERNEL, node);
 	if (!pool)
 		goto out;
 
-	pool->heads = kvcalloc(umem->chunks, sizeof(*pool->heads), GFP_KERNEL);
+	pool->numa_node = node;
+
+	pool->heads = kvcalloc_node(umem->chunks, sizeof(*pool->heads),
+				    GFP_KERNEL, node);
 	if (!pool->heads)
 		goto out;
 
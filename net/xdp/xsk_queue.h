@@ -140,6 +140,10 @@ static inline bool xp_unused_options_set(u32 options)
 	return options & ~(XDP_PKT_CONTD | XDP_TX_METADATA);
 }
 
+/* The checks are evaluated branchlessly so that validating a batch of
+ * descriptors costs a single well-predicted branch per descriptor, taken
+ * only on failure.
+ */
 static inline bool xp_aligned_validate_desc(struct xsk_buff_pool *pool,
 					    struct xdp_desc *desc)
 {
@@ -147,18 +151,10 @@ static inline bool xp_aligned_validate_desc(struct xsk_buff_pool *pool,
 	u64 len = desc->len + pool->tx_metadata_len;
 	u64 offset = addr & (pool->chunk_size - 1);
 
-	if (!desc->len)
-		return false;
-
-	if (offset + len > pool->chunk_size)
-		return false;
-
-	if (addr >= pool->addrs_cnt)
-		return false;
-
-	if (xp_unused_options_set(desc->options))
-		return false;
-	return true;
+	return (desc->len != 0) &
+	       (offset + len <= pool->chunk_size) &
+	       (addr < pool->addrs_cnt) &
+	       !xp_unused_options_set(desc->options);
 }
 
 static inline bool xp_unaligned_validate_desc(struct xsk_buff_pool *pool,
@@ -167,19 +163,14 @@ static inline bool xp_unaligned_validate_desc(struct xsk_buff_pool *pool,
 	u64 addr = xp_unaligned_add_offset_to_addr(desc->addr) - pool->tx_metadata_len;
 	u64 len = desc->len + pool->tx_metadata_len;
 
-	if (!desc->len)
+	if ((desc->len == 0) |
+	    (len > pool->chunk_size) |
+	    (addr >= pool->addrs_cnt) |
+	    (addr + len > pool->addrs_cnt) |
+	    xp_unused_options_set(desc->options))
 		return false;
 
-	if (len > pool->chunk_size)
-		return false;
-
-	if (addr >= pool->addrs_cnt || addr + len > pool->addrs_cnt ||
-	    xp_desc_crosses_non_contig_pg(pool, addr, len))
-		return false;
-
-	if (xp_unused_options_set(desc->options))
-		return false;
-	return true;
+	return !xp_desc_crosses_non_contig_pg(pool, addr, len);
 }
 
 static inline bool xp_validate_desc(struct xsk_buff_pool *pool,
@@ -237,6 +228,7 @@ static inline
 u32 xskq_cons_read_desc_batch(struct xsk_queue *q, struct xsk_buff_pool *pool,
 			      u32 max)
 {
+	struct xdp_rxtx_ring *ring = (struct xdp_rxtx_ring *)q->ring;
 	u32 cached_cons = q->cached_cons, nb_entries = 0;
 	struct xdp_desc *descs = pool->tx_descs;
 	u32 total_descs = 0, nr_frags = 0;
@@ -245,7 +237,6 @@ u32 xskq_cons_read_desc_batch(struct xsk_queue *q, struct xsk_buff_pool *pool,
 	 * current packet that consists of frags and stop the processing
 	 */
 	while (cached_cons != q->cached_prod && nb_entries < max) {
-		struct xdp_rxtx_ring *ring = (struct xdp_rxtx_ring *)q->ring;
 		u32 idx = cached_cons & q->ring_mask;
 		struct parsed_desc parsed;
 
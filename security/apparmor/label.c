@@ -8,6 +8,7 @@
  */
 
 #include <linux/audit.h>
+#include <linux/percpu.h>
 #include <linux/seq_file.h>
 #include <linux/sort.h>
 
@@ -39,6 +40,14 @@
 #define PROXY_POISON 97
 #define LABEL_POISON 100
 
+/*
+ * generation of the per-CPU label match cache, bumped whenever a label or
+ * profile is destroyed so cached match results can never outlive the
+ * objects they were computed against.  Starts at 1 so zero-initialized
+ * cache entries are always invalid.
+ */
+static atomic64_t label_match_gen = ATOMIC64_INIT(1);
+
 static void free_proxy(struct aa_proxy *proxy)
 {
 	if (proxy) {
@@ -318,6 +327,9 @@ void aa_label_destroy(struct aa_label *label)
 {
 	AA_BUG(!label);
 
+	/* invalidate cached match results before addresses can be reused */
+	atomic64_inc(&label_match_gen);
+
 	if (!label_isprofile(label)) {
 		struct aa_profile *profile;
 		struct label_it i;
@@ -1405,6 +1417,94 @@ fail:
 	return -EACCES;
 }
 
+/*
+ * Per-CPU cache of recent label match results.  Profiles, rulesets and
+ * labels are immutable once published - policy replacement creates new
+ * objects - so a cached result for a given (profile, rules, label, state,
+ * request) tuple can only go stale through an object being freed and its
+ * address reused.  @label_match_gen is bumped on every label/profile
+ * destroy (see aa_label_destroy()), invalidating all cached entries
+ * before any address reuse is possible.
+ */
+#define LABEL_MATCH_CACHE_SIZE 4
+
+struct label_match_ent {
+	u64 gen;
+	struct aa_profile *profile;
+	struct aa_ruleset *rules;
+	struct aa_label *label;
+	aa_state_t state;
+	u32 request;
+	bool subns;
+	int error;
+	struct aa_perms perms;
+};
+
+struct label_match_cache {
+	struct label_match_ent ents[LABEL_MATCH_CACHE_SIZE];
+	unsigned int next;	/* round-robin replacement */
+};
+
+static DEFINE_PER_CPU(struct label_match_cache, label_match_cache);
+
+static bool label_match_cached(struct aa_profile *profile,
+			       struct aa_ruleset *rules,
+			       struct aa_label *label, aa_state_t state,
+			       bool subns, u32 request,
+			       struct aa_perms *perms, int *error)
+{
+	struct label_match_cache *cache;
+	u64 gen = atomic64_read(&label_match_gen);
+	int i;
+
+	cache = get_cpu_ptr(&label_match_cache);
+	for (i = 0; i < LABEL_MATCH_CACHE_SIZE; i++) {
+		struct label_match_ent *ent = &cache->ents[i];
+
+		if (ent->gen == gen && ent->profile == profile &&
+		    ent->rules == rules && ent->label == label &&
+		    ent->state == state && ent->subns == subns &&
+		    ent->request == request) {
+			*perms = ent->perms;
+			*error = ent->error;
+			put_cpu_ptr(&label_match_cache);
+			return true;
+		}
+	}
+	put_cpu_ptr(&label_match_cache);
+
+	return false;
+}
+
+static void label_match_cache_insert(struct aa_profile *profile,
+				     struct aa_ruleset *rules,
+				     struct aa_label *label, aa_state_t state,
+				     bool subns, u32 request,
+				     struct aa_perms *perms, int error)
+{
+	struct label_match_cache *cache;
+	struct label_match_ent *ent;
+
+	cache = get_cpu_ptr(&label_match_cache);
+	ent = &cache->ents[cache->next++ % LABEL_MATCH_CACHE_SIZE];
+	/* invalidate while the entry is being refilled */
+	ent->gen = 0;
+	ent->profile = profile;
+	ent->rules = rules;
+	ent->label = label;
+	ent->state = state;
+	ent->subns = subns;
+	ent->request = request;
+	ent->error = error;
+	ent->perms = *perms;
+	/*
+	 * re-read the generation: @profile and @label are pinned by the
+	 * caller so a concurrent bump can only have been for other objects
+	 */
+	ent->gen = atomic64_read(&label_match_gen);
+	put_cpu_ptr(&label_match_cache);
+}
+
 /**
  * aa_label_match - do a multi-component label match
  * @profile: profile to match against (NOT NULL)
@@ -1421,14 +1521,23 @@ int aa_label_match(struct aa_profile *profile, struct aa_ruleset *rules,
 		   struct aa_label *label, aa_state_t state, bool subns,
 		   u32 request, struct aa_perms *perms)
 {
-	int error = label_compound_match(profile, rules, label, state, subns,
-					 request, perms);
-	if (!error)
+	int error;
+
+	if (label_match_cached(profile, rules, label, state, subns, request,
+			       perms, &error))
 		return error;
 
-	*perms = allperms;
-	return label_components_match(profile, rules, label, state, subns,
-				      request, perms);
+	error = label_compound_match(profile, rules, label, state, subns,
+				     request, perms);
+	if (error) {
+		*perms = allperms;
+		error = label_components_match(profile, rules, label, state,
+					       subns, request, perms);
+	}
+
+	label_match_cache_insert(profile, rules, label, state, subns, request,
+				 perms, error);
+	return error;
 }
 
 
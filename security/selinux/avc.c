@@ -540,6 +540,104 @@ static inline struct avc_node *avc_search_node(u32 ssid, u32 tsid, u16 tclass)
 	return ret;
 }
 
+/*
+ * Per-CPU front cache holding recently used decisions by value, so that the
+ * repeated (ssid, tsid, tclass) checks of a busy task resolve without
+ * touching the shared hash slots at all.  Entries are validated against a
+ * global epoch that is bumped whenever cached decisions may go stale (cache
+ * flush on policy reload, in-place node updates), and are written under a
+ * per-entry sequence count so that a lookup racing with an update on the
+ * same or another CPU simply falls back to the shared cache.
+ */
+#define AVC_PCPU_CACHE_SLOTS	8
+
+struct avc_pcpu_entry {
+	u32			seq;	/* odd while being updated */
+	u32			epoch;
+	u32			ssid;
+	u32			tsid;
+	u16			tclass;
+	struct av_decision	avd;
+};
+
+struct avc_pcpu_cache {
+	struct avc_pcpu_entry	entries[AVC_PCPU_CACHE_SLOTS];
+};
+
+static DEFINE_PER_CPU(struct avc_pcpu_cache, avc_pcpu_cache);
+
+/*
+ * Bumped whenever decisions cached by value may have become stale.  Starts
+ * at 1 so that zero-initialized entries can never appear valid.
+ */
+static atomic_t avc_cache_epoch = ATOMIC_INIT(1);
+
+static inline u32 avc_pcpu_hash(u32 ssid, u32 tsid, u16 tclass)
+{
+	return (ssid ^ (tsid<<2) ^ (tclass<<4)) & (AVC_PCPU_CACHE_SLOTS - 1);
+}
+
+static bool avc_pcpu_lookup(u32 ssid, u32 tsid, u16 tclass,
+			    struct av_decision *avd)
+{
+	struct avc_pcpu_entry *e;
+	u32 seq, epoch = atomic_read(&avc_cache_epoch);
+	bool valid = false;
+
+	preempt_disable();
+	e = &this_cpu_ptr(&avc_pcpu_cache)->entries[avc_pcpu_hash(ssid, tsid,
+								  tclass)];
+	seq = READ_ONCE(e->seq);
+	if (!(seq & 1)) {
+		/* Pairs with the smp_wmb()s in avc_pcpu_insert(). */
+		smp_rmb();
+		if (e->ssid == ssid && e->tsid == tsid &&
+		    e->tclass == tclass && e->epoch == epoch) {
+			*avd = e->avd;
+			smp_rmb();
+			valid = READ_ONCE(e->seq) == seq;
+		}
+	}
+	preempt_enable();
+	return valid;
+}
+
+/*
+ * @epoch must have been sampled from avc_cache_epoch before the decision
+ * being inserted was computed, so that a flush racing with the insertion
+ * bumps past it and invalidates the entry rather than blessing a
+ * pre-flush decision under the post-flush epoch.
+ */
+static void avc_pcpu_insert(u32 ssid, u32 tsid, u16 tclass,
+			    const struct av_decision *avd, u32 epoch)
+{
+	struct avc_pcpu_entry *e;
+	u32 seq;
+
+	preempt_disable();
+	e = &this_cpu_ptr(&avc_pcpu_cache)->entries[avc_pcpu_hash(ssid, tsid,
+								  tclass)];
+	seq = READ_ONCE(e->seq);
+	/*
+	 * Claim the entry with cmpxchg so that an update interrupted by
+	 * another update of the same entry (e.g. from irq context) cannot
+	 * leave a torn entry behind an apparently stable sequence count.
+	 * Losing the race just means skipping this insertion.
+	 */
+	if ((seq & 1) || cmpxchg(&e->seq, seq, seq + 1) != seq)
+		goto out;
+	smp_wmb();
+	e->ssid = ssid;
+	e->tsid = tsid;
+	e->tclass = tclass;
+	e->epoch = epoch;
+	e->avd = *avd;
+	smp_wmb();
+	WRITE_ONCE(e->seq, seq + 2);
+out:
+	preempt_enable();
+}
+
 /**
  * avc_lookup - Look up an AVC entry.
  * @ssid: source security identifier
@@ -911,6 +1009,8 @@ static int avc_update_node(u32 event, u32 perms, u8 driver, u8 xperm, u32 ssid,
 		break;
 	}
 	avc_node_replace(node, orig);
+	/* Decisions cached by value in the per-CPU front cache went stale. */
+	atomic_inc(&avc_cache_epoch);
 out_unlock:
 	spin_unlock_irqrestore(lock, flag);
 out:
@@ -928,6 +1028,9 @@ static void avc_flush(void)
 	unsigned long flag;
 	int i;
 
+	/* Invalidate the per-CPU front caches first. */
+	atomic_inc(&avc_cache_epoch);
+
 	for (i = 0; i < AVC_CACHE_SLOTS; i++) {
 		head = &selinux_avc.avc_cache.slots[i];
 		lock = &selinux_avc.avc_cache.slots_lock[i];
@@ -1144,12 +1247,27 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 				unsigned int flags,
 				struct av_decision *avd)
 {
-	u32 denied;
+	u32 denied, epoch;
 	struct avc_node *node;
 
 	if (WARN_ON(!requested))
 		return -EACCES;
 
+	if (avc_pcpu_lookup(ssid, tsid, tclass, avd)) {
+		avc_cache_stats_incr(lookups);
+		denied = requested & ~avd->allowed;
+		if (unlikely(denied))
+			return avc_denied(ssid, tsid, tclass, requested, 0, 0,
+					  flags, avd);
+		return 0;
+	}
+
+	/*
+	 * Sampled before the decision is looked up; see the comment above
+	 * avc_pcpu_insert().
+	 */
+	epoch = atomic_read(&avc_cache_epoch);
+
 	rcu_read_lock();
 	node = avc_lookup(ssid, tsid, tclass);
 	if (unlikely(!node)) {
@@ -1159,6 +1277,7 @@ inline int avc_has_perm_noaudit(u32 ssid, u32 tsid,
 	}
 	denied = requested & ~node->ae.avd.allowed;
 	memcpy(avd, &node->ae.avd, sizeof(*avd));
+	avc_pcpu_insert(ssid, tsid, tclass, avd, epoch);
 	rcu_read_unlock();
 
 	if (unlikely(denied))
@@ -979,6 +979,7 @@ void snd_pcm_detach_substream(struct snd_pcm_substream *substream)
 
 	if (PCM_RUNTIME_CHECK(substream))
 		return;
+	snd_pcm_period_elapsed_flush(substream);
 	runtime = substream->runtime;
 	if (runtime->private_free != NULL)
 		runtime->private_free(runtime);
@@ -1211,6 +1212,7 @@ static void snd_pcm_proc_done(void)
 
 static int __init alsa_pcm_init(void)
 {
+	snd_pcm_period_elapsed_init();
 	snd_ctl_register_ioctl(snd_pcm_control_ioctl);
 	snd_ctl_register_ioctl_compat(snd_pcm_control_ioctl);
 	snd_pcm_proc_init();
@@ -1222,6 +1224,7 @@ static void __exit alsa_pcm_exit(void)
 	snd_ctl_unregister_ioctl(snd_pcm_control_ioctl);
 	snd_ctl_unregister_ioctl_compat(snd_pcm_control_ioctl);
 	snd_pcm_proc_done();
+	snd_pcm_period_elapsed_exit();
 }
 
 module_init(alsa_pcm_init)
@@ -9,6 +9,8 @@
 #include <linux/sched/signal.h>
 #include <linux/time.h>
 #include <linux/math64.h>
+#include <linux/module.h>
+#include <linux/hrtimer.h>
 #include <linux/export.h>
 #include <sound/core.h>
 #include <sound/control.h>
@@ -1836,6 +1838,148 @@ int snd_pcm_lib_ioctl(struct snd_pcm_substream *substream,
 }
 EXPORT_SYMBOL(snd_pcm_lib_ioctl);
 
+/*
+ * Optional coalescing of period-elapsed processing. With
+ * period_wakeup_window_us set, a period interrupt only queues the substream
+ * here and a single hrtimer expiry services every stream whose period
+ * elapsed within the window: one wakeup interrupt instead of one per
+ * stream. The positions still reach the mmap'd status/control pages from
+ * the deferred update, so pollers see at most the window of extra latency.
+ */
+static unsigned int period_wakeup_window_us;
+module_param(period_wakeup_window_us, uint, 0644);
+MODULE_PARM_DESC(period_wakeup_window_us, "Coalesce period-elapsed processing of multiple streams within this window (in microseconds, 0 = disabled).");
+
+struct pcm_elapsed_entry {
+	struct list_head list;
+	struct snd_pcm_substream *substream;
+};
+
+static DEFINE_SPINLOCK(pcm_elapsed_lock);
+static LIST_HEAD(pcm_elapsed_list);
+static struct hrtimer pcm_elapsed_timer;
+/*
+ * Whether an expiry is armed or still draining the list, maintained under
+ * pcm_elapsed_lock.  hrtimer_active() can't be used for this: it stays
+ * true until the expiry callback has fully returned, i.e. also in the
+ * window after the callback's final empty-check where a newly queued
+ * entry does need a new arming.
+ */
+static bool pcm_elapsed_timer_armed;
+
+static void __snd_pcm_period_elapsed(struct snd_pcm_substream *substream);
+
+static enum hrtimer_restart pcm_elapsed_timer_fn(struct hrtimer *timer)
+{
+	struct pcm_elapsed_entry *entry;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pcm_elapsed_lock, flags);
+	while (!list_empty(&pcm_elapsed_list)) {
+		entry = list_first_entry(&pcm_elapsed_list,
+					 struct pcm_elapsed_entry, list);
+		list_del(&entry->list);
+		spin_unlock_irqrestore(&pcm_elapsed_lock, flags);
+
+		scoped_guard(pcm_stream_lock_irqsave, entry->substream)
+			__snd_pcm_period_elapsed(entry->substream);
+		kfree(entry);
+
+		spin_lock_irqsave(&pcm_elapsed_lock, flags);
+	}
+	/* a defer observing this under the lock arms a fresh expiry */
+	pcm_elapsed_timer_armed = false;
+	spin_unlock_irqrestore(&pcm_elapsed_lock, flags);
+
+	return HRTIMER_NORESTART;
+}
+
+/* queue the substream for deferred period-elapsed processing;
+ * returns false if coalescing is disabled or the entry cannot be
+ * allocated, in which case the caller processes the period immediately
+ */
+static bool snd_pcm_period_elapsed_defer(struct snd_pcm_substream *substream)
+{
+	unsigned int window = READ_ONCE(period_wakeup_window_us);
+	struct pcm_elapsed_entry *entry, *e;
+	bool queued = false;
+	unsigned long flags;
+
+	if (!window)
+		return false;
+
+	entry = kmalloc(sizeof(*entry), GFP_ATOMIC);
+	if (!entry)
+		return false;
+	entry->substream = substream;
+
+	spin_lock_irqsave(&pcm_elapsed_lock, flags);
+	list_for_each_entry(e, &pcm_elapsed_list, list) {
+		if (e->substream == substream) {
+			/* already queued, one pass handles all elapsed periods */
+			queued = true;
+			break;
+		}
+	}
+	if (!queued)
+		list_add_tail(&entry->list, &pcm_elapsed_list);
+	/*
+	 * Arm on the duplicate path too: the entry may have been queued in
+	 * the window between the expiry's final empty-check and its return,
+	 * in which case nobody else will.
+	 */
+	if (!pcm_elapsed_timer_armed) {
+		pcm_elapsed_timer_armed = true;
+		hrtimer_start(&pcm_elapsed_timer,
+			      ns_to_ktime((u64)window * NSEC_PER_USEC),
+			      HRTIMER_MODE_REL);
+	}
+	spin_unlock_irqrestore(&pcm_elapsed_lock, flags);
+
+	if (queued)
+		kfree(entry);
+	return true;
+}
+
+/* drop any queued period-elapsed work for the substream and wait out a
+ * concurrently running expiry; called before the runtime is freed
+ */
+void snd_pcm_period_elapsed_flush(struct snd_pcm_substream *substream)
+{
+	struct pcm_elapsed_entry *entry, *tmp;
+	unsigned long flags;
+
+	spin_lock_irqsave(&pcm_elapsed_lock, flags);
+	list_for_each_entry_safe(entry, tmp, &pcm_elapsed_list, list) {
+		if (entry->substream == substream) {
+			list_del(&entry->list);
+			kfree(entry);
+		}
+	}
+	spin_unlock_irqrestore(&pcm_elapsed_lock, flags);
+
+	/* the expiry may have dequeued an entry for this substream already */
+	hrtimer_cancel(&pcm_elapsed_timer);
+
+	spin_lock_irqsave(&pcm_elapsed_lock, flags);
+	pcm_elapsed_timer_armed = !list_empty(&pcm_elapsed_list);
+	if (pcm_elapsed_timer_armed)
+		hrtimer_start(&pcm_elapsed_timer, 0, HRTIMER_MODE_REL);
+	spin_unlock_irqrestore(&pcm_elapsed_lock, flags);
+}
+
+void snd_pcm_period_elapsed_init(void)
+{
+	hrtimer_init(&pcm_elapsed_timer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	pcm_elapsed_timer.function = pcm_elapsed_timer_fn;
+}
+
+void snd_pcm_period_elapsed_exit(void)
+{
+	hrtimer_cancel(&pcm_elapsed_timer);
+	WARN_ON(!list_empty(&pcm_elapsed_list));
+}
+
 /**
  * snd_pcm_period_elapsed_under_stream_lock() - update the status of runtime for the next period
  *						under acquired lock of PCM substream.
@@ -1864,6 +2008,16 @@ EXPORT_SYMBOL(snd_pcm_lib_ioctl);
  * Even if more than one periods have elapsed since the last call, you have to call this only once.
  */
 void snd_pcm_period_elapsed_under_stream_lock(struct snd_pcm_substream *substream)
+{
+	if (PCM_RUNTIME_CHECK(substream))
+		return;
+	if (snd_pcm_period_elapsed_defer(substream))
+		return;
+	__snd_pcm_period_elapsed(substream);
+}
+EXPORT_SYMBOL(snd_pcm_period_elapsed_under_stream_lock);
+
+static void __snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
 {
 	struct snd_pcm_runtime *runtime;
 
@@ -1882,7 +2036,6 @@ void snd_pcm_period_elapsed_under_stream_lock(struct snd_pcm_substream *substrea
  _end:
 	snd_kill_fasync(runtime->fasync, SIGIO, POLL_IN);
 }
-EXPORT_SYMBOL(snd_pcm_period_elapsed_under_stream_lock);
 
 /**
  * snd_pcm_period_elapsed() - update the status of runtime for the next period by acquiring lock of
@@ -1901,8 +2054,11 @@ void snd_pcm_period_elapsed(struct snd_pcm_substream *substream)
 	if (snd_BUG_ON(!substream))
 		return;
 
+	if (snd_pcm_period_elapsed_defer(substream))
+		return;
+
 	guard(pcm_stream_lock_irqsave)(substream);
-	snd_pcm_period_elapsed_under_stream_lock(substream);
+	__snd_pcm_period_elapsed(substream);
 }
 EXPORT_SYMBOL(snd_pcm_period_elapsed);
 
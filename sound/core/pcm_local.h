@@ -61,6 +61,10 @@ static inline void snd_pcm_timer_init(struct snd_pcm_substream *substream) {}
 static inline void snd_pcm_timer_done(struct snd_pcm_substream *substream) {}
 #endif
 
+void snd_pcm_period_elapsed_init(void);
+void snd_pcm_period_elapsed_exit(void);
+void snd_pcm_period_elapsed_flush(struct snd_pcm_substream *substream);
+
 void __snd_pcm_xrun(struct snd_pcm_substream *substream);
 void snd_pcm_group_init(struct snd_pcm_group *group);
 void snd_pcm_sync_stop(struct snd_pcm_substream *substream, bool sync_irq);
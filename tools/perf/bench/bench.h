@@ -35,6 +35,12 @@ int bench_futex_wake_parallel(int argc, const char **argv);
 int bench_futex_requeue(int argc, const char **argv);
 /* pi futexes */
 int bench_futex_lock_pi(int argc, const char **argv);
+/* futex2 */
+int bench_futex_waitv(int argc, const char **argv);
+int bench_fanotify(int argc, const char **argv);
+/* io_uring */
+int bench_uring_nop(int argc, const char **argv);
+int bench_uring_read(int argc, const char **argv);
 int bench_epoll_wait(int argc, const char **argv);
 int bench_epoll_ctl(int argc, const char **argv);
 int bench_synthesize(int argc, const char **argv);
@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * fanotify: Benchmark fanotify event delivery throughput.
+ *
+ * A set of generator threads produces filesystem events (open, modify,
+ * close-write) on per-thread files inside a watched temporary directory
+ * while the main thread drains the fanotify queue, closing the event fds
+ * as a real listener would.  Reports events per second, the achieved
+ * read() batching and per-read latency percentiles.  Needs
+ * CAP_SYS_ADMIN; the benchmark is skipped without it.
+ */
+
+#include <string.h>
+#include <pthread.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/types.h>
+
+#include "../util/stat.h"
+#include <subcmd/parse-options.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/time64.h>
+#include "bench.h"
+
+#include <err.h>
+
+#define FANOTIFY_BUF_SIZE	16384
+
+static unsigned int nthreads = 4;
+static unsigned int nsecs = 8;
+static bool silent;
+
+static volatile bool done;
+static char tmpdir[] = "/tmp/perf-bench-fanotifyXXXXXX";
+
+struct worker {
+	pthread_t thread;
+	int tid;
+	unsigned long ops;
+};
+
+static const struct option options[] = {
+	OPT_UINTEGER('t', "threads", &nthreads, "Number of event generator threads"),
+	OPT_UINTEGER('r', "runtime", &nsecs,    "Specify runtime (in seconds)"),
+	OPT_BOOLEAN( 's', "silent",  &silent,   "Silent mode: do not display data/details"),
+	OPT_END()
+};
+
+static const char * const bench_fanotify_usage[] = {
+	"perf bench fanotify events <options>",
+	NULL
+};
+
+static int cmp_u64(const void *a, const void *b)
+{
+	const u64 *x = a, *y = b;
+
+	return *x < *y ? -1 : *x > *y;
+}
+
+static u64 percentile(u64 *sorted, size_t n, double pct)
+{
+	return sorted[(size_t)((n - 1) * pct)];
+}
+
+static void *workerfn(void *arg)
+{
+	struct worker *w = arg;
+	char path[sizeof(tmpdir) + 32];
+	char c = 0;
+
+	scnprintf(path, sizeof(path), "%s/gen-%d", tmpdir, w->tid);
+
+	while (!done) {
+		int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, 0600);
+
+		if (fd < 0)
+			err(EXIT_FAILURE, "open");
+		if (write(fd, &c, 1) != 1)
+			err(EXIT_FAILURE, "write");
+		close(fd);
+		w->ops++;
+	}
+
+	return NULL;
+}
+
+static void toggle_done(int sig __maybe_unused,
+			siginfo_t *info __maybe_unused,
+			void *uc __maybe_unused)
+{
+	done = true;
+}
+
+int bench_fanotify(int argc, const char **argv)
+{
+	char buf[FANOTIFY_BUF_SIZE] __aligned(8);
+	unsigned long nr_events = 0, nr_reads = 0, nr_overflows = 0;
+	struct timeval start, end, runtime;
+	struct worker *worker;
+	struct sigaction act;
+	u64 *read_lat;
+	size_t read_lat_nr = 0, read_lat_max;
+	unsigned int i;
+	double secs;
+	int fanofd;
+
+	argc = parse_options(argc, argv, options, bench_fanotify_usage, 0);
+	if (argc) {
+		usage_with_options(bench_fanotify_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	fanofd = fanotify_init(FAN_CLASS_NOTIF | FAN_NONBLOCK, O_RDONLY);
+	if (fanofd < 0) {
+		if (errno == EPERM) {
+			printf("fanotify requires CAP_SYS_ADMIN, skipping\n");
+			return 0;
+		}
+		err(EXIT_FAILURE, "fanotify_init");
+	}
+
+	if (!mkdtemp(tmpdir))
+		err(EXIT_FAILURE, "mkdtemp");
+
+	if (fanotify_mark(fanofd, FAN_MARK_ADD,
+			  FAN_OPEN | FAN_MODIFY | FAN_CLOSE_WRITE |
+			  FAN_EVENT_ON_CHILD, AT_FDCWD, tmpdir))
+		err(EXIT_FAILURE, "fanotify_mark");
+
+	memset(&act, 0, sizeof(act));
+	sigfillset(&act.sa_mask);
+	act.sa_sigaction = toggle_done;
+	sigaction(SIGINT, &act, NULL);
+	sigaction(SIGALRM, &act, NULL);
+
+	worker = calloc(nthreads, sizeof(*worker));
+	/* more samples than any real queue drain can produce */
+	read_lat_max = (size_t)nsecs * 1000000;
+	read_lat = calloc(read_lat_max, sizeof(*read_lat));
+	if (!worker || !read_lat)
+		err(EXIT_FAILURE, "calloc");
+
+	printf("Run summary [PID %d]: %d event generators on a watched "
+	       "directory for %d secs.\n\n", getpid(), nthreads, nsecs);
+
+	for (i = 0; i < nthreads; i++) {
+		worker[i].tid = i;
+		if (pthread_create(&worker[i].thread, NULL, workerfn,
+				   &worker[i]))
+			err(EXIT_FAILURE, "pthread_create");
+	}
+
+	alarm(nsecs);
+	gettimeofday(&start, NULL);
+
+	while (!done) {
+		struct fanotify_event_metadata *md;
+		struct pollfd pfd = { .fd = fanofd, .events = POLLIN };
+		struct timespec t0, t1;
+		ssize_t len;
+
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+		len = read(fanofd, buf, sizeof(buf));
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+		if (len <= 0) {
+			if (len < 0 && errno != EAGAIN && errno != EINTR)
+				err(EXIT_FAILURE, "read");
+			continue;
+		}
+
+		if (read_lat_nr < read_lat_max)
+			read_lat[read_lat_nr++] =
+				(t1.tv_sec - t0.tv_sec) * NSEC_PER_SEC +
+				t1.tv_nsec - t0.tv_nsec;
+		nr_reads++;
+
+		md = (struct fanotify_event_metadata *)buf;
+		while (FAN_EVENT_OK(md, len)) {
+			if (md->mask & FAN_Q_OVERFLOW)
+				nr_overflows++;
+			if (md->fd >= 0)
+				close(md->fd);
+			nr_events++;
+			md = FAN_EVENT_NEXT(md, len);
+		}
+	}
+
+	gettimeofday(&end, NULL);
+	timersub(&end, &start, &runtime);
+
+	for (i = 0; i < nthreads; i++)
+		pthread_join(worker[i].thread, NULL);
+
+	secs = runtime.tv_sec + (double)runtime.tv_usec / USEC_PER_SEC;
+
+	printf("Received %lu events in %lu reads over %.2f secs "
+	       "(%.0f events/sec, %.1f events/read",
+	       nr_events, nr_reads, secs, nr_events / secs,
+	       nr_reads ? (double)nr_events / nr_reads : 0.0);
+	if (nr_overflows)
+		printf(", %lu queue overflows", nr_overflows);
+	printf(")\n");
+
+	if (!silent) {
+		unsigned long gen_ops = 0;
+
+		for (i = 0; i < nthreads; i++)
+			gen_ops += worker[i].ops;
+		printf("Generators performed %lu open/write/close cycles\n",
+		       gen_ops);
+	}
+
+	if (read_lat_nr) {
+		qsort(read_lat, read_lat_nr, sizeof(*read_lat), cmp_u64);
+		printf("Read latency: p50 %" PRIu64 " ns, p90 %" PRIu64
+		       " ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns\n",
+		       percentile(read_lat, read_lat_nr, 0.50),
+		       percentile(read_lat, read_lat_nr, 0.90),
+		       percentile(read_lat, read_lat_nr, 0.99),
+		       read_lat[read_lat_nr - 1]);
+	}
+
+	for (i = 0; i < nthreads; i++) {
+		char path[sizeof(tmpdir) + 32];
+
+		scnprintf(path, sizeof(path), "%s/gen-%d", tmpdir, i);
+		unlink(path);
+	}
+	rmdir(tmpdir);
+	close(fanofd);
+
+	free(read_lat);
+	free(worker);
+	return 0;
+}
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * futex-waitv: Block threads on vectors of futexes (futex2) and wake them.
+ *
+ * Each waiter blocks in futex_waitv() on its own vector of futexes and is
+ * woken through a single entry of that vector, which is what a fan-in
+ * event loop over futex2 looks like: many sources, one blocked consumer.
+ * The wake slot rotates across runs so every vector position gets
+ * exercised.  Reports the usual wake-time summary plus per-wake latency
+ * percentiles.
+ */
+
+/* For the CLR_() macros */
+#include <string.h>
+#include <pthread.h>
+
+#include <signal.h>
+#include "../util/mutex.h"
+#include "../util/stat.h"
+#include <subcmd/parse-options.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/time64.h>
+#include <errno.h>
+#include <perf/cpumap.h>
+#include "bench.h"
+#include "futex.h"
+
+#include <err.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+
+static u_int32_t *futexes;
+static struct futex_waitv *waitvs;
+
+static pthread_t *worker;
+static bool done = false;
+static struct mutex thread_lock;
+static struct cond thread_parent, thread_worker;
+static struct stats waketime_stats, wakeup_stats;
+static unsigned int threads_starting;
+static int futex_flag = 0;
+static unsigned int wake_slot;
+static u64 *wake_lat;
+static size_t wake_lat_nr;
+
+static struct bench_futex_parameters params = {
+	.nfutexes = 8,
+};
+
+static const struct option options[] = {
+	OPT_UINTEGER('t', "threads",  &params.nthreads, "Specify amount of threads"),
+	OPT_UINTEGER('f', "futexes",  &params.nfutexes, "Specify amount of futexes per waitv vector"),
+	OPT_BOOLEAN( 's', "silent",   &params.silent, "Silent mode: do not display data/details"),
+	OPT_BOOLEAN( 'S', "shared",   &params.fshared, "Use shared futexes instead of private ones"),
+	OPT_BOOLEAN( 'm', "mlockall", &params.mlockall, "Lock all current and future memory"),
+
+	OPT_END()
+};
+
+static const char * const bench_futex_waitv_usage[] = {
+	"perf bench futex waitv <options>",
+	NULL
+};
+
+static int cmp_u64(const void *a, const void *b)
+{
+	const u64 *x = a, *y = b;
+
+	return *x < *y ? -1 : *x > *y;
+}
+
+static u64 percentile(u64 *sorted, size_t n, double pct)
+{
+	return sorted[(size_t)((n - 1) * pct)];
+}
+
+static void *workerfn(void *arg)
+{
+	struct futex_waitv *waitv = &waitvs[(unsigned long)arg * params.nfutexes];
+	int ret;
+
+	mutex_lock(&thread_lock);
+	threads_starting--;
+	if (!threads_starting)
+		cond_signal(&thread_parent);
+	cond_wait(&thread_worker, &thread_lock);
+	mutex_unlock(&thread_lock);
+
+	do {
+		ret = futex_waitv(waitv, params.nfutexes, NULL,
+				  CLOCK_MONOTONIC);
+	} while (ret < 0 && errno == EINTR);
+
+	pthread_exit(NULL);
+	return NULL;
+}
+
+static void print_summary(void)
+{
+	double waketime_avg = avg_stats(&waketime_stats);
+	double waketime_stddev = stddev_stats(&waketime_stats);
+	unsigned int wakeup_avg = avg_stats(&wakeup_stats);
+
+	printf("Wokeup %d of %d threads in %.4f ms (+-%.2f%%)\n",
+	       wakeup_avg,
+	       params.nthreads,
+	       waketime_avg / USEC_PER_MSEC,
+	       rel_stddev_stats(waketime_stddev, waketime_avg));
+
+	if (wake_lat_nr) {
+		qsort(wake_lat, wake_lat_nr, sizeof(*wake_lat), cmp_u64);
+		printf("Wake latency: p50 %" PRIu64 " ns, p90 %" PRIu64
+		       " ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns\n",
+		       percentile(wake_lat, wake_lat_nr, 0.50),
+		       percentile(wake_lat, wake_lat_nr, 0.90),
+		       percentile(wake_lat, wake_lat_nr, 0.99),
+		       wake_lat[wake_lat_nr - 1]);
+	}
+}
+
+static void block_threads(pthread_t *w, struct perf_cpu_map *cpu)
+{
+	cpu_set_t *cpuset;
+	unsigned long i;
+	size_t size;
+	int nrcpus = perf_cpu_map__nr(cpu);
+	threads_starting = params.nthreads;
+
+	cpuset = CPU_ALLOC(nrcpus);
+	BUG_ON(!cpuset);
+	size = CPU_ALLOC_SIZE(nrcpus);
+
+	/* create and block all threads */
+	for (i = 0; i < params.nthreads; i++) {
+		pthread_attr_t thread_attr;
+
+		pthread_attr_init(&thread_attr);
+		CPU_ZERO_S(size, cpuset);
+		CPU_SET_S(perf_cpu_map__cpu(cpu, i % perf_cpu_map__nr(cpu)).cpu, size, cpuset);
+
+		if (pthread_attr_setaffinity_np(&thread_attr, size, cpuset)) {
+			CPU_FREE(cpuset);
+			err(EXIT_FAILURE, "pthread_attr_setaffinity_np");
+		}
+
+		if (pthread_create(&w[i], &thread_attr, workerfn, (void *)i)) {
+			CPU_FREE(cpuset);
+			err(EXIT_FAILURE, "pthread_create");
+		}
+		pthread_attr_destroy(&thread_attr);
+	}
+	CPU_FREE(cpuset);
+}
+
+static void toggle_done(int sig __maybe_unused,
+			siginfo_t *info __maybe_unused,
+			void *uc __maybe_unused)
+{
+	done = true;
+}
+
+int bench_futex_waitv(int argc, const char **argv)
+{
+	int ret = 0;
+	unsigned int i, j;
+	struct sigaction act;
+	struct perf_cpu_map *cpu;
+
+	argc = parse_options(argc, argv, options, bench_futex_waitv_usage, 0);
+	if (argc) {
+		usage_with_options(bench_futex_waitv_usage, options);
+		exit(EXIT_FAILURE);
+	}
+
+	cpu = perf_cpu_map__new_online_cpus();
+	if (!cpu)
+		err(EXIT_FAILURE, "calloc");
+
+	memset(&act, 0, sizeof(act));
+	sigfillset(&act.sa_mask);
+	act.sa_sigaction = toggle_done;
+	sigaction(SIGINT, &act, NULL);
+
+	if (params.mlockall) {
+		if (mlockall(MCL_CURRENT | MCL_FUTURE))
+			err(EXIT_FAILURE, "mlockall");
+	}
+
+	if (!params.nthreads)
+		params.nthreads = perf_cpu_map__nr(cpu);
+	if (!params.nfutexes)
+		params.nfutexes = 1;
+
+	worker = calloc(params.nthreads, sizeof(*worker));
+	futexes = calloc((size_t)params.nthreads * params.nfutexes,
+			 sizeof(*futexes));
+	waitvs = calloc((size_t)params.nthreads * params.nfutexes,
+			sizeof(*waitvs));
+	wake_lat = calloc((size_t)bench_repeat * params.nthreads,
+			  sizeof(*wake_lat));
+	if (!worker || !futexes || !waitvs || !wake_lat)
+		err(EXIT_FAILURE, "calloc");
+
+	if (!params.fshared)
+		futex_flag = FUTEX_PRIVATE_FLAG;
+
+	for (i = 0; i < params.nthreads * params.nfutexes; i++) {
+		waitvs[i].val = 0;
+		waitvs[i].uaddr = (unsigned long)&futexes[i];
+		waitvs[i].flags = FUTEX_32 | futex_flag;
+	}
+
+	/* probe for futex2 support before spawning anything */
+	ret = futex_waitv(waitvs, 0, NULL, CLOCK_MONOTONIC);
+	if (ret < 0 && errno == ENOSYS) {
+		printf("futex_waitv() is not supported by this kernel, skipping\n");
+		ret = 0;
+		goto out;
+	}
+	ret = 0;
+
+	printf("Run summary [PID %d]: blocking %d threads on waitv vectors of "
+	       "%d [%s] futexes.\n\n",
+	       getpid(), params.nthreads, params.nfutexes,
+	       params.fshared ? "shared" : "private");
+
+	init_stats(&wakeup_stats);
+	init_stats(&waketime_stats);
+	mutex_init(&thread_lock);
+	cond_init(&thread_parent);
+	cond_init(&thread_worker);
+
+	for (j = 0; j < bench_repeat && !done; j++) {
+		unsigned int nwoken = 0;
+		struct timeval start, end, runtime;
+
+		/* rotate the vector slot that gets woken */
+		wake_slot = j % params.nfutexes;
+
+		/* create, launch & block all threads */
+		block_threads(worker, cpu);
+
+		/* make sure all threads are already blocked */
+		mutex_lock(&thread_lock);
+		while (threads_starting)
+			cond_wait(&thread_parent, &thread_lock);
+		cond_broadcast(&thread_worker);
+		mutex_unlock(&thread_lock);
+
+		usleep(100000);
+
+		/* Ok, all threads are patiently blocked, start waking folks up */
+		gettimeofday(&start, NULL);
+		for (i = 0; i < params.nthreads; i++) {
+			u_int32_t *uaddr = &futexes[i * params.nfutexes +
+						    wake_slot];
+			struct timespec t0, t1;
+
+			do {
+				/* a 0 return means the waiter isn't blocked yet */
+				clock_gettime(CLOCK_MONOTONIC, &t0);
+				ret = futex_wake(uaddr, 1, futex_flag);
+				clock_gettime(CLOCK_MONOTONIC, &t1);
+			} while (!ret);
+			ret = 0;
+
+			wake_lat[wake_lat_nr++] =
+				(t1.tv_sec - t0.tv_sec) * NSEC_PER_SEC +
+				t1.tv_nsec - t0.tv_nsec;
+			nwoken++;
+		}
+		gettimeofday(&end, NULL);
+		timersub(&end, &start, &runtime);
+
+		update_stats(&wakeup_stats, nwoken);
+		update_stats(&waketime_stats, runtime.tv_usec);
+
+		if (!params.silent) {
+			printf("[Run %d]: Wokeup %d of %d threads (slot %d) in %.4f ms\n",
+			       j + 1, nwoken, params.nthreads, wake_slot,
+			       runtime.tv_usec / (double)USEC_PER_MSEC);
+		}
+
+		for (i = 0; i < params.nthreads; i++) {
+			ret = pthread_join(worker[i], NULL);
+			if (ret)
+				err(EXIT_FAILURE, "pthread_join");
+		}
+	}
+
+	/* cleanup & report results */
+	cond_destroy(&thread_parent);
+	cond_destroy(&thread_worker);
+	mutex_destroy(&thread_lock);
+
+	print_summary();
+
+out:
+	free(wake_lat);
+	free(waitvs);
+	free(futexes);
+	free(worker);
+	perf_cpu_map__put(cpu);
+	return ret;
+}
@@ -27,6 +27,24 @@ struct bench_futex_parameters {
 	unsigned int nrequeue;
 };
 
+/*
+ * futex2 bits, for toolchains whose headers predate the futex_waitv()
+ * syscall (v5.16).
+ */
+#ifndef FUTEX_32
+#define FUTEX_32	2
+struct futex_waitv {
+	__u64 val;
+	__u64 uaddr;
+	__u32 flags;
+	__u32 __reserved;
+};
+#endif
+
+#ifndef __NR_futex_waitv
+#define __NR_futex_waitv 449
+#endif
+
 /**
  * futex_syscall() - SYS_futex syscall wrapper
  * @uaddr:	address of first futex
@@ -69,6 +87,22 @@ futex_wait(u_int32_t *uaddr, u_int32_t val, struct timespec *timeout, int opflag
 	return futex_syscall(uaddr, FUTEX_WAIT, val, timeout, NULL, 0, opflags);
 }
 
+/**
+ * futex_waitv() - block on any of the futexes described by @waiters
+ * @waiters:	array of futexes to wait on
+ * @nr_futexes:	number of entries in @waiters
+ * @timeout:	absolute timeout against @clockid, or NULL
+ *
+ * Return: the array index of the futex that woke us, or -1 with errno set.
+ */
+static inline int
+futex_waitv(struct futex_waitv *waiters, unsigned long nr_futexes,
+	    struct timespec *timeout, clockid_t clockid)
+{
+	return syscall(__NR_futex_waitv, waiters, nr_futexes, 0, timeout,
+		       clockid);
+}
+
 /**
  * futex_wake() - wake one or more tasks blocked on uaddr
  * @nr_wake:	wake up to this many tasks
@@ -0,0 +1,396 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * uring: Benchmark io_uring submission/completion overhead.
+ *
+ * Drives a raw io_uring (no liburing dependency) in batches of SQEs and
+ * waits for the matching CQEs, measuring the round trip of each batch.
+ * Two workloads are exposed: "nop", which isolates pure ring overhead,
+ * and "read", which reads from /dev/zero and can additionally exercise
+ * the provided-buffer path (IOSQE_BUFFER_SELECT with per-iteration
+ * re-provisioning).  Both run either in the default interrupt-driven
+ * mode or with an SQPOLL kernel submission thread, and report ops per
+ * second plus per-batch latency percentiles.
+ */
+
+#include <string.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+
+#include <subcmd/parse-options.h>
+#include <linux/compiler.h>
+#include <linux/kernel.h>
+#include <linux/log2.h>
+#include <linux/time64.h>
+#include <linux/io_uring.h>
+#include "bench.h"
+
+#include <err.h>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup	425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter	426
+#endif
+
+#define URING_READ_BUF_SIZE	4096
+
+static unsigned int batch = 32;
+static unsigned int nsecs = 8;
+static bool sqpoll;
+static bool provide_buffers;
+static bool silent;
+
+static volatile bool done;
+
+static const struct option options[] = {
+	OPT_UINTEGER('b', "batch",   &batch,  "SQEs submitted per io_uring_enter() call"),
+	OPT_UINTEGER('r', "runtime", &nsecs,  "Specify runtime (in seconds)"),
+	OPT_BOOLEAN( 'p', "sqpoll",  &sqpoll, "Use an SQPOLL kernel submission thread"),
+	OPT_BOOLEAN( 'B', "provide-buffers", &provide_buffers,
+		     "Use provided buffers (read workload only)"),
+	OPT_BOOLEAN( 's', "silent",  &silent, "Silent mode: do not display data/details"),
+	OPT_END()
+};
+
+static const char * const bench_uring_usage[] = {
+	"perf bench uring <nop|read> <options>",
+	NULL
+};
+
+struct uring {
+	int fd;
+	unsigned int *sq_head;
+	unsigned int *sq_tail;
+	unsigned int *sq_mask;
+	unsigned int *sq_flags;
+	unsigned int *sq_array;
+	unsigned int *cq_head;
+	unsigned int *cq_tail;
+	unsigned int *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ring;
+	void *cq_ring;
+	size_t sq_ring_sz;
+	size_t cq_ring_sz;
+	size_t sqes_sz;
+};
+
+static int cmp_u64(const void *a, const void *b)
+{
+	const u64 *x = a, *y = b;
+
+	return *x < *y ? -1 : *x > *y;
+}
+
+static u64 percentile(u64 *sorted, size_t n, double pct)
+{
+	return sorted[(size_t)((n - 1) * pct)];
+}
+
+static int uring_enter(struct uring *r, unsigned int to_submit,
+		       unsigned int min_complete, unsigned int flags)
+{
+	return syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete,
+		       flags, NULL, 0);
+}
+
+static int uring_setup(struct uring *r, unsigned int entries)
+{
+	struct io_uring_params p;
+
+	memset(&p, 0, sizeof(p));
+	if (sqpoll) {
+		p.flags |= IORING_SETUP_SQPOLL;
+		p.sq_thread_idle = 1000;
+	}
+
+	r->fd = syscall(__NR_io_uring_setup, entries, &p);
+	if (r->fd < 0)
+		return -errno;
+
+	r->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+	r->cq_ring_sz = p.cq_off.cqes +
+			p.cq_entries * sizeof(struct io_uring_cqe);
+	r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+
+	r->sq_ring = mmap(NULL, r->sq_ring_sz, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, r->fd,
+			  IORING_OFF_SQ_RING);
+	r->cq_ring = mmap(NULL, r->cq_ring_sz, PROT_READ | PROT_WRITE,
+			  MAP_SHARED | MAP_POPULATE, r->fd,
+			  IORING_OFF_CQ_RING);
+	r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE,
+		       MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sq_ring == MAP_FAILED || r->cq_ring == MAP_FAILED ||
+	    r->sqes == MAP_FAILED)
+		return -errno;
+
+	r->sq_head  = r->sq_ring + p.sq_off.head;
+	r->sq_tail  = r->sq_ring + p.sq_off.tail;
+	r->sq_mask  = r->sq_ring + p.sq_off.ring_mask;
+	r->sq_flags = r->sq_ring + p.sq_off.flags;
+	r->sq_array = r->sq_ring + p.sq_off.array;
+	r->cq_head  = r->cq_ring + p.cq_off.head;
+	r->cq_tail  = r->cq_ring + p.cq_off.tail;
+	r->cq_mask  = r->cq_ring + p.cq_off.ring_mask;
+	r->cqes     = r->cq_ring + p.cq_off.cqes;
+
+	return 0;
+}
+
+static void uring_teardown(struct uring *r)
+{
+	if (r->sq_ring && r->sq_ring != MAP_FAILED)
+		munmap(r->sq_ring, r->sq_ring_sz);
+	if (r->cq_ring && r->cq_ring != MAP_FAILED)
+		munmap(r->cq_ring, r->cq_ring_sz);
+	if (r->sqes && r->sqes != MAP_FAILED)
+		munmap(r->sqes, r->sqes_sz);
+	close(r->fd);
+}
+
+static struct io_uring_sqe *uring_next_sqe(struct uring *r,
+					   unsigned int *tail)
+{
+	unsigned int idx = *tail & *r->sq_mask;
+	struct io_uring_sqe *sqe = &r->sqes[idx];
+
+	memset(sqe, 0, sizeof(*sqe));
+	r->sq_array[idx] = idx;
+	(*tail)++;
+
+	return sqe;
+}
+
+static int uring_submit_and_reap(struct uring *r, unsigned int tail,
+				 unsigned int nr)
+{
+	unsigned int reaped = 0, head, eflags;
+	int ret, res = 0;
+
+	__atomic_store_n(r->sq_tail, tail, __ATOMIC_RELEASE);
+
+	eflags = IORING_ENTER_GETEVENTS;
+	if (sqpoll &&
+	    (__atomic_load_n(r->sq_flags, __ATOMIC_ACQUIRE) &
+	     IORING_SQ_NEED_WAKEUP))
+		eflags |= IORING_ENTER_SQ_WAKEUP;
+
+	ret = uring_enter(r, nr, nr, eflags);
+	if (ret < 0 && errno != EINTR && errno != EBUSY)
+		err(EXIT_FAILURE, "io_uring_enter");
+
+	head = *r->cq_head;
+	while (reaped < nr) {
+		struct io_uring_cqe *cqe;
+
+		if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) {
+			ret = uring_enter(r, 0, 1, IORING_ENTER_GETEVENTS);
+			if (ret < 0 && errno != EINTR)
+				err(EXIT_FAILURE, "io_uring_enter");
+			continue;
+		}
+
+		cqe = &r->cqes[head & *r->cq_mask];
+		if (cqe->res < 0 && !res)
+			res = cqe->res;
+		head++;
+		reaped++;
+	}
+	__atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+
+	return res;
+}
+
+static void uring_provide_buffers(struct uring *r, void *bufs)
+{
+	unsigned int tail = *r->sq_tail;
+	struct io_uring_sqe *sqe = uring_next_sqe(r, &tail);
+	int res;
+
+	sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+	sqe->fd = batch;			/* number of buffers */
+	sqe->addr = (unsigned long)bufs;
+	sqe->len = URING_READ_BUF_SIZE;
+	sqe->off = 0;				/* first buffer id */
+	sqe->buf_group = 0;
+
+	res = uring_submit_and_reap(r, tail, 1);
+	if (res < 0)
+		errx(EXIT_FAILURE, "PROVIDE_BUFFERS failed: %d", res);
+}
+
+static void toggle_done(int sig __maybe_unused,
+			siginfo_t *info __maybe_unused,
+			void *uc __maybe_unused)
+{
+	done = true;
+}
+
+static int bench_uring(bool do_read)
+{
+	unsigned long nr_ops = 0, nr_batches = 0;
+	struct timeval start, end, runtime;
+	struct sigaction act;
+	struct uring r;
+	u64 *batch_lat;
+	size_t batch_lat_nr = 0, batch_lat_max;
+	void *bufs = NULL;
+	struct timespec t0, t1;
+	double secs;
+	int zfd = -1, ret, res = 0;
+
+	memset(&r, 0, sizeof(r));
+	ret = uring_setup(&r, roundup_pow_of_two(batch));
+	if (ret) {
+		if (ret == -ENOSYS) {
+			printf("io_uring is not supported by this kernel, skipping\n");
+			return 0;
+		}
+		if (sqpoll && (ret == -EPERM || ret == -EINVAL)) {
+			printf("SQPOLL not permitted/supported here, skipping\n");
+			return 0;
+		}
+		errno = -ret;
+		err(EXIT_FAILURE, "io_uring_setup");
+	}
+
+	if (do_read) {
+		zfd = open("/dev/zero", O_RDONLY);
+		if (zfd < 0)
+			err(EXIT_FAILURE, "open(/dev/zero)");
+
+		bufs = calloc(batch, URING_READ_BUF_SIZE);
+		if (!bufs)
+			err(EXIT_FAILURE, "calloc");
+
+		if (provide_buffers)
+			uring_provide_buffers(&r, bufs);
+	}
+
+	memset(&act, 0, sizeof(act));
+	sigfillset(&act.sa_mask);
+	act.sa_sigaction = toggle_done;
+	sigaction(SIGINT, &act, NULL);
+	sigaction(SIGALRM, &act, NULL);
+
+	/* more samples than any realistic run can produce */
+	batch_lat_max = (size_t)nsecs * 1000000;
+	batch_lat = calloc(batch_lat_max, sizeof(*batch_lat));
+	if (!batch_lat)
+		err(EXIT_FAILURE, "calloc");
+
+	printf("Run summary [PID %d]: %s x %d per batch, %s%sfor %d secs.\n\n",
+	       getpid(), do_read ? "READ(/dev/zero)" : "NOP", batch,
+	       sqpoll ? "SQPOLL, " : "",
+	       provide_buffers ? "provided buffers, " : "", nsecs);
+
+	alarm(nsecs);
+	gettimeofday(&start, NULL);
+
+	while (!done) {
+		unsigned int tail = *r.sq_tail;
+		unsigned int b;
+
+		clock_gettime(CLOCK_MONOTONIC, &t0);
+
+		for (b = 0; b < batch; b++) {
+			struct io_uring_sqe *sqe = uring_next_sqe(&r, &tail);
+
+			if (!do_read) {
+				sqe->opcode = IORING_OP_NOP;
+				continue;
+			}
+
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = zfd;
+			sqe->len = URING_READ_BUF_SIZE;
+			if (provide_buffers) {
+				sqe->flags |= IOSQE_BUFFER_SELECT;
+				sqe->buf_group = 0;
+			} else {
+				sqe->addr = (unsigned long)bufs +
+					    (unsigned long)b *
+					    URING_READ_BUF_SIZE;
+			}
+		}
+
+		res = uring_submit_and_reap(&r, tail, batch);
+		if (res < 0)
+			errx(EXIT_FAILURE, "request failed: %d", res);
+
+		/* the consumed buffers have to go back into the pool */
+		if (provide_buffers)
+			uring_provide_buffers(&r, bufs);
+
+		clock_gettime(CLOCK_MONOTONIC, &t1);
+
+		if (batch_lat_nr < batch_lat_max)
+			batch_lat[batch_lat_nr++] =
+				(t1.tv_sec - t0.tv_sec) * NSEC_PER_SEC +
+				t1.tv_nsec - t0.tv_nsec;
+		nr_batches++;
+		nr_ops += batch;
+	}
+
+	gettimeofday(&end, NULL);
+	timersub(&end, &start, &runtime);
+	secs = runtime.tv_sec + (double)runtime.tv_usec / USEC_PER_SEC;
+
+	printf("Completed %lu ops in %lu batches over %.2f secs "
+	       "(%.0f ops/sec)\n", nr_ops, nr_batches, secs, nr_ops / secs);
+
+	if (!silent && batch_lat_nr) {
+		qsort(batch_lat, batch_lat_nr, sizeof(*batch_lat), cmp_u64);
+		printf("Batch latency: p50 %" PRIu64 " ns, p90 %" PRIu64
+		       " ns, p99 %" PRIu64 " ns, max %" PRIu64 " ns\n",
+		       percentile(batch_lat, batch_lat_nr, 0.50),
+		       percentile(batch_lat, batch_lat_nr, 0.90),
+		       percentile(batch_lat, batch_lat_nr, 0.99),
+		       batch_lat[batch_lat_nr - 1]);
+	}
+
+	free(batch_lat);
+	free(bufs);
+	if (zfd >= 0)
+		close(zfd);
+	uring_teardown(&r);
+	return 0;
+}
+
+int bench_uring_nop(int argc, const char **argv)
+{
+	argc = parse_options(argc, argv, options, bench_uring_usage, 0);
+	if (argc) {
+		usage_with_options(bench_uring_usage, options);
+		exit(EXIT_FAILURE);
+	}
+	if (!batch)
+		batch = 1;
+
+	return bench_uring(false);
+}
+
+int bench_uring_read(int argc, const char **argv)
+{
+	argc = parse_options(argc, argv, options, bench_uring_usage, 0);
+	if (argc) {
+		usage_with_options(bench_uring_usage, options);
+		exit(EXIT_FAILURE);
+	}
+	if (!batch)
+		batch = 1;
+
+	return bench_uring(true);
+}
@@ -21,6 +21,20 @@ static char *directions[] = {
 	"FROM_DEVICE",
 };
 
+static int run_one(int fd, struct map_benchmark *map, int threads, int node,
+		   int granule)
+{
+	map->threads = threads;
+	map->node = node;
+	map->granule = granule;
+
+	if (ioctl(fd, DMA_MAP_BENCHMARK, map)) {
+		perror("ioctl");
+		return -1;
+	}
+	return 0;
+}
+
 int main(int argc, char **argv)
 {
 	struct map_benchmark map;
@@ -31,11 +45,12 @@ int main(int argc, char **argv)
 	int bits = 32, xdelay = 0, dir = DMA_MAP_BIDIRECTIONAL;
 	/* default granule 1 PAGESIZE */
 	int granule = 1;
+	/* sweep powers of two up to -t/-g instead of a single run */
+	int sweep = 0;
 
-	int cmd = DMA_MAP_BENCHMARK;
 	char *p;
 
-	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:")) != -1) {
+	while ((opt = getopt(argc, argv, "t:s:n:b:d:x:g:S")) != -1) {
 		switch (opt) {
 		case 't':
 			threads = atoi(optarg);
@@ -58,6 +73,9 @@ int main(int argc, char **argv)
 		case 'g':
 			granule = atoi(optarg);
 			break;
+		case 'S':
+			sweep = 1;
+			break;
 		default:
 			return -1;
 		}
@@ -106,24 +124,47 @@ int main(int argc, char **argv)
 
 	memset(&map, 0, sizeof(map));
 	map.seconds = seconds;
-	map.threads = threads;
-	map.node = node;
 	map.dma_bits = bits;
 	map.dma_dir = dir;
 	map.dma_trans_ns = xdelay;
-	map.granule = granule;
 
-	if (ioctl(fd, cmd, &map)) {
-		perror("ioctl");
-		exit(1);
+	if (sweep) {
+		int t, g;
+
+		printf("threads,granule,node,map_avg_us,map_p50_us,map_p99_us,map_p999_us,map_max_us,unmap_avg_us,unmap_p99_us\n");
+		for (t = 1; t <= threads; t <<= 1) {
+			for (g = 1; g <= granule; g <<= 1) {
+				if (run_one(fd, &map, t, node, g))
+					exit(1);
+				printf("%d,%d,%d,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n",
+					t, g, node,
+					map.avg_map_100ns/10.0,
+					map.map_p50_100ns/10.0,
+					map.map_p99_100ns/10.0,
+					map.map_p999_100ns/10.0,
+					map.map_max_100ns/10.0,
+					map.avg_unmap_100ns/10.0,
+					map.unmap_p99_100ns/10.0);
+			}
+		}
+		return 0;
 	}
 
+	if (run_one(fd, &map, threads, node, granule))
+		exit(1);
+
 	printf("dma mapping benchmark: threads:%d seconds:%d node:%d dir:%s granule: %d\n",
 			threads, seconds, node, dir[directions], granule);
 	printf("average map latency(us):%.1f standard deviation:%.1f\n",
 			map.avg_map_100ns/10.0, map.map_stddev/10.0);
+	printf("map latency(us): p50:%.1f p99:%.1f p99.9:%.1f max:%.1f\n",
+			map.map_p50_100ns/10.0, map.map_p99_100ns/10.0,
+			map.map_p999_100ns/10.0, map.map_max_100ns/10.0);
 	printf("average unmap latency(us):%.1f standard deviation:%.1f\n",
 			map.avg_unmap_100ns/10.0, map.unmap_stddev/10.0);
+	printf("unmap latency(us): p50:%.1f p99:%.1f p99.9:%.1f max:%.1f\n",
+			map.unmap_p50_100ns/10.0, map.unmap_p99_100ns/10.0,
+			map.unmap_p999_100ns/10.0, map.unmap_max_100ns/10.0);
 
 	return 0;
 }
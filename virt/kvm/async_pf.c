@@ -164,14 +164,38 @@ void kvm_clear_async_pf_completion_queue(struct kvm_vcpu *vcpu)
 void kvm_check_async_pf_completion(struct kvm_vcpu *vcpu)
 {
 	struct kvm_async_pf *work;
+	LIST_HEAD(ready);
+
+	if (list_empty_careful(&vcpu->async_pf.done) ||
+	    !kvm_arch_can_dequeue_async_page_present(vcpu))
+		return;
+
+	/*
+	 * Harvest the whole completion list with a single lock acquisition.
+	 * Completions arrive in bursts, e.g. when postcopy migration resolves
+	 * thousands of pages back to back, and taking the lock per item makes
+	 * the vCPU and the completion workers ping-pong on it.
+	 */
+	spin_lock(&vcpu->async_pf.lock);
+	list_splice_init(&vcpu->async_pf.done, &ready);
+	spin_unlock(&vcpu->async_pf.lock);
+
+	while (!list_empty(&ready)) {
+		work = list_first_entry(&ready, typeof(*work), link);
+
+		if (!kvm_arch_can_dequeue_async_page_present(vcpu)) {
+			/*
+			 * Put back what the guest can't take yet, ahead of
+			 * any completions that arrived in the meantime to
+			 * keep FIFO ordering.
+			 */
+			spin_lock(&vcpu->async_pf.lock);
+			list_splice(&ready, &vcpu->async_pf.done);
+			spin_unlock(&vcpu->async_pf.lock);
+			break;
+		}
 
-	while (!list_empty_careful(&vcpu->async_pf.done) &&
-	      kvm_arch_can_dequeue_async_page_present(vcpu)) {
-		spin_lock(&vcpu->async_pf.lock);
-		work = list_first_entry(&vcpu->async_pf.done, typeof(*work),
-					      link);
 		list_del(&work->link);
-		spin_unlock(&vcpu->async_pf.lock);
 
 		kvm_arch_async_page_ready(vcpu, work);
 		if (!IS_ENABLED(CONFIG_KVM_ASYNC_PF_SYNC))
@@ -40,9 +40,9 @@ static int coalesced_mmio_in_range(struct kvm_coalesced_mmio_dev *dev,
 	return 1;
 }
 
-static int coalesced_mmio_has_room(struct kvm_coalesced_mmio_dev *dev, u32 last)
+static int coalesced_mmio_has_room(struct kvm_coalesced_mmio_ring *ring,
+				   u32 last)
 {
-	struct kvm_coalesced_mmio_ring *ring;
 	unsigned avail;
 
 	/* Are we able to batch it ? */
@@ -51,8 +51,7 @@ static int coalesced_mmio_has_room(struct kvm_coalesced_mmio_dev *dev, u32 last)
 	 * check if we don't meet the first used entry
 	 * there is always one unused entry in the buffer
 	 */
-	ring = dev->kvm->coalesced_mmio_ring;
-	avail = (ring->first - last - 1) % KVM_COALESCED_MMIO_MAX;
+	avail = (READ_ONCE(ring->first) - last - 1) % KVM_COALESCED_MMIO_MAX;
 	if (avail == 0) {
 		/* full */
 		return 0;
@@ -66,18 +65,29 @@ static int coalesced_mmio_write(struct kvm_vcpu *vcpu,
 				int len, const void *val)
 {
 	struct kvm_coalesced_mmio_dev *dev = to_mmio(this);
-	struct kvm_coalesced_mmio_ring *ring = dev->kvm->coalesced_mmio_ring;
+	struct kvm_coalesced_mmio_ring *ring;
+	bool per_vcpu = vcpu && vcpu->coalesced_mmio_ring;
 	__u32 insert;
 
 	if (!coalesced_mmio_in_range(dev, addr, len))
 		return -EOPNOTSUPP;
 
-	spin_lock(&dev->kvm->ring_lock);
+	/*
+	 * A per-vCPU ring has a single producer (the vCPU thread) and a
+	 * single consumer (userspace, between runs of that vCPU), so writes
+	 * to it are lockless; only the VM-wide ring is shared by all vCPUs
+	 * and needs ring_lock.
+	 */
+	ring = per_vcpu ? vcpu->coalesced_mmio_ring :
+			  dev->kvm->coalesced_mmio_ring;
+	if (!per_vcpu)
+		spin_lock(&dev->kvm->ring_lock);
 
 	insert = READ_ONCE(ring->last);
-	if (!coalesced_mmio_has_room(dev, insert) ||
+	if (!coalesced_mmio_has_room(ring, insert) ||
 	    insert >= KVM_COALESCED_MMIO_MAX) {
-		spin_unlock(&dev->kvm->ring_lock);
+		if (!per_vcpu)
+			spin_unlock(&dev->kvm->ring_lock);
 		return -EOPNOTSUPP;
 	}
 
@@ -89,7 +99,8 @@ static int coalesced_mmio_write(struct kvm_vcpu *vcpu,
 	ring->coalesced_mmio[insert].pio = dev->zone.pio;
 	smp_wmb();
 	ring->last = (insert + 1) % KVM_COALESCED_MMIO_MAX;
-	spin_unlock(&dev->kvm->ring_lock);
+	if (!per_vcpu)
+		spin_unlock(&dev->kvm->ring_lock);
 	return 0;
 }
 
@@ -134,6 +145,28 @@ void kvm_coalesced_mmio_free(struct kvm *kvm)
 		free_page((unsigned long)kvm->coalesced_mmio_ring);
 }
 
+int kvm_coalesced_mmio_init_vcpu(struct kvm_vcpu *vcpu)
+{
+	struct page *page;
+
+	if (!vcpu->kvm->coalesced_mmio_per_vcpu)
+		return 0;
+
+	page = alloc_page(GFP_KERNEL_ACCOUNT | __GFP_ZERO);
+	if (!page)
+		return -ENOMEM;
+
+	vcpu->coalesced_mmio_ring = page_address(page);
+
+	return 0;
+}
+
+void kvm_coalesced_mmio_free_vcpu(struct kvm_vcpu *vcpu)
+{
+	if (vcpu->coalesced_mmio_ring)
+		free_page((unsigned long)vcpu->coalesced_mmio_ring);
+}
+
 int kvm_vm_ioctl_register_coalesced_mmio(struct kvm *kvm,
 					 struct kvm_coalesced_mmio_zone *zone)
 {
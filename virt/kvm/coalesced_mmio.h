@@ -24,6 +24,8 @@ struct kvm_coalesced_mmio_dev {
 
 int kvm_coalesced_mmio_init(struct kvm *kvm);
 void kvm_coalesced_mmio_free(struct kvm *kvm);
+int kvm_coalesced_mmio_init_vcpu(struct kvm_vcpu *vcpu);
+void kvm_coalesced_mmio_free_vcpu(struct kvm_vcpu *vcpu);
 int kvm_vm_ioctl_register_coalesced_mmio(struct kvm *kvm,
 					struct kvm_coalesced_mmio_zone *zone);
 int kvm_vm_ioctl_unregister_coalesced_mmio(struct kvm *kvm,
@@ -33,6 +35,8 @@ int kvm_vm_ioctl_unregister_coalesced_mmio(struct kvm *kvm,
 
 static inline int kvm_coalesced_mmio_init(struct kvm *kvm) { return 0; }
 static inline void kvm_coalesced_mmio_free(struct kvm *kvm) { }
+static inline int kvm_coalesced_mmio_init_vcpu(struct kvm_vcpu *vcpu) { return 0; }
+static inline void kvm_coalesced_mmio_free_vcpu(struct kvm_vcpu *vcpu) { }
 
 #endif
 
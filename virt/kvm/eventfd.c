@@ -12,6 +12,7 @@
 #include <linux/kvm_host.h>
 #include <linux/kvm.h>
 #include <linux/kvm_irqfd.h>
+#include <linux/hrtimer.h>
 #include <linux/workqueue.h>
 #include <linux/syscalls.h>
 #include <linux/wait.h>
@@ -136,8 +137,12 @@ irqfd_shutdown(struct work_struct *work)
 
 	/*
 	 * We know no new events will be scheduled at this point, so block
-	 * until all previously outstanding events have completed
+	 * until all previously outstanding events have completed.  The
+	 * coalescing timer must go first as its expiry may queue the
+	 * inject work one last time.
 	 */
+	if (irqfd->coalesce)
+		hrtimer_cancel(&irqfd->coalesce_timer);
 	flush_work(&irqfd->inject);
 
 	if (irqfd->resampler) {
@@ -187,6 +192,91 @@ int __attribute__((weak)) kvm_arch_set_irq_inatomic(
 	return -EWOULDBLOCK;
 }
 
+/* Inject from atomic context, falling back to the inject work if need be */
+static void irqfd_inject_inatomic(struct kvm_kernel_irqfd *irqfd)
+{
+	struct kvm_kernel_irq_routing_entry irq;
+	struct kvm *kvm = irqfd->kvm;
+	unsigned seq;
+	int idx;
+
+	idx = srcu_read_lock(&kvm->irq_srcu);
+	do {
+		seq = read_seqcount_begin(&irqfd->irq_entry_sc);
+		irq = irqfd->irq_entry;
+	} while (read_seqcount_retry(&irqfd->irq_entry_sc, seq));
+	if (kvm_arch_set_irq_inatomic(&irq, kvm,
+				      KVM_USERSPACE_IRQ_SOURCE_ID, 1,
+				      false) == -EWOULDBLOCK)
+		schedule_work(&irqfd->inject);
+	srcu_read_unlock(&kvm->irq_srcu, idx);
+}
+
+/*
+ * Bounds for the adaptive coalescing window.  The window doubles after
+ * every window that absorbed at least one signal and halves after every
+ * idle one, so sustained storms quickly converge on one injection per
+ * IRQFD_COALESCE_MAX_NS while isolated signals keep seeing immediate
+ * injection.
+ */
+#define IRQFD_COALESCE_MIN_NS	5000
+#define IRQFD_COALESCE_MAX_NS	50000
+
+/*
+ * Returns true if the caller opened a new coalescing window and must
+ * inject the signal itself, false if the signal was absorbed into an
+ * already open window.
+ */
+static bool irqfd_coalesce_begin(struct kvm_kernel_irqfd *irqfd)
+{
+	bool open;
+
+	spin_lock(&irqfd->coalesce_lock);
+	open = irqfd->coalesce_window_open;
+	if (open) {
+		irqfd->coalesced_signals++;
+	} else {
+		irqfd->coalesce_window_open = true;
+		hrtimer_start(&irqfd->coalesce_timer,
+			      ns_to_ktime(irqfd->coalesce_window_ns),
+			      HRTIMER_MODE_REL);
+	}
+	spin_unlock(&irqfd->coalesce_lock);
+
+	return !open;
+}
+
+static enum hrtimer_restart irqfd_coalesce_timer_fn(struct hrtimer *timer)
+{
+	struct kvm_kernel_irqfd *irqfd =
+		container_of(timer, struct kvm_kernel_irqfd, coalesce_timer);
+	unsigned int n;
+
+	spin_lock(&irqfd->coalesce_lock);
+	n = irqfd->coalesced_signals;
+	irqfd->coalesced_signals = 0;
+	if (n) {
+		irqfd->coalesce_window_ns = min_t(u64,
+						  irqfd->coalesce_window_ns * 2,
+						  IRQFD_COALESCE_MAX_NS);
+		hrtimer_forward_now(timer,
+				    ns_to_ktime(irqfd->coalesce_window_ns));
+	} else {
+		irqfd->coalesce_window_ns = max_t(u64,
+						  irqfd->coalesce_window_ns / 2,
+						  IRQFD_COALESCE_MIN_NS);
+		irqfd->coalesce_window_open = false;
+	}
+	spin_unlock(&irqfd->coalesce_lock);
+
+	if (!n)
+		return HRTIMER_NORESTART;
+
+	/* One injection covers every signal absorbed in this window */
+	irqfd_inject_inatomic(irqfd);
+	return HRTIMER_RESTART;
+}
+
 /*
  * Called with wqh->lock held and interrupts disabled
  */
@@ -196,27 +286,16 @@ irqfd_wakeup(wait_queue_entry_t *wait, unsigned mode, int sync, void *key)
 	struct kvm_kernel_irqfd *irqfd =
 		container_of(wait, struct kvm_kernel_irqfd, wait);
 	__poll_t flags = key_to_poll(key);
-	struct kvm_kernel_irq_routing_entry irq;
 	struct kvm *kvm = irqfd->kvm;
-	unsigned seq;
-	int idx;
 	int ret = 0;
 
 	if (flags & EPOLLIN) {
 		u64 cnt;
 		eventfd_ctx_do_read(irqfd->eventfd, &cnt);
 
-		idx = srcu_read_lock(&kvm->irq_srcu);
-		do {
-			seq = read_seqcount_begin(&irqfd->irq_entry_sc);
-			irq = irqfd->irq_entry;
-		} while (read_seqcount_retry(&irqfd->irq_entry_sc, seq));
 		/* An event has been signaled, inject an interrupt */
-		if (kvm_arch_set_irq_inatomic(&irq, kvm,
-					      KVM_USERSPACE_IRQ_SOURCE_ID, 1,
-					      false) == -EWOULDBLOCK)
-			schedule_work(&irqfd->inject);
-		srcu_read_unlock(&kvm->irq_srcu, idx);
+		if (!irqfd->coalesce || irqfd_coalesce_begin(irqfd))
+			irqfd_inject_inatomic(irqfd);
 		ret = 1;
 	}
 
@@ -326,6 +405,15 @@ kvm_irqfd_assign(struct kvm *kvm, struct kvm_irqfd *args)
 	INIT_WORK(&irqfd->shutdown, irqfd_shutdown);
 	seqcount_spinlock_init(&irqfd->irq_entry_sc, &kvm->irqfds.lock);
 
+	if (args->flags & KVM_IRQFD_FLAG_COALESCE) {
+		irqfd->coalesce = true;
+		spin_lock_init(&irqfd->coalesce_lock);
+		irqfd->coalesce_window_ns = IRQFD_COALESCE_MIN_NS;
+		hrtimer_init(&irqfd->coalesce_timer, CLOCK_MONOTONIC,
+			     HRTIMER_MODE_REL);
+		irqfd->coalesce_timer.function = irqfd_coalesce_timer_fn;
+	}
+
 	f = fdget(args->fd);
 	if (!f.file) {
 		ret = -EBADF;
@@ -573,7 +661,13 @@ kvm_irqfd_deassign(struct kvm *kvm, struct kvm_irqfd *args)
 int
 kvm_irqfd(struct kvm *kvm, struct kvm_irqfd *args)
 {
-	if (args->flags & ~(KVM_IRQFD_FLAG_DEASSIGN | KVM_IRQFD_FLAG_RESAMPLE))
+	if (args->flags & ~(KVM_IRQFD_FLAG_DEASSIGN | KVM_IRQFD_FLAG_RESAMPLE |
+			    KVM_IRQFD_FLAG_COALESCE))
+		return -EINVAL;
+
+	/* Coalescing would defeat level triggered re-assertion */
+	if ((args->flags & KVM_IRQFD_FLAG_COALESCE) &&
+	    (args->flags & KVM_IRQFD_FLAG_RESAMPLE))
 		return -EINVAL;
 
 	if (args->flags & KVM_IRQFD_FLAG_DEASSIGN)
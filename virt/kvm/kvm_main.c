@@ -96,6 +96,54 @@ unsigned int halt_poll_ns_shrink;
 module_param(halt_poll_ns_shrink, uint, 0644);
 EXPORT_SYMBOL_GPL(halt_poll_ns_shrink);
 
+/*
+ * EWMA weight shift for the adaptive halt-polling governor.  When non-zero,
+ * each vCPU sizes its polling window from an exponential moving average of
+ * its recent halt durations instead of the multiplicative grow/shrink above.
+ */
+unsigned int halt_poll_ns_ewma_shift;
+module_param(halt_poll_ns_ewma_shift, uint, 0644);
+EXPORT_SYMBOL_GPL(halt_poll_ns_ewma_shift);
+
+/*
+ * Host-wide cap on CPU time burnt in failed polls by the adaptive governor,
+ * in percent of wall time per online CPU.  0 disables the cap.
+ */
+unsigned int halt_poll_burn_pct = 10;
+module_param(halt_poll_burn_pct, uint, 0644);
+EXPORT_SYMBOL_GPL(halt_poll_burn_pct);
+
+/*
+ * Gates the per-vCPU exit-to-reentry latency histogram, off by default as it
+ * adds two clock reads to every world switch.
+ */
+DEFINE_STATIC_KEY_FALSE(kvm_exit_reentry_stats);
+EXPORT_SYMBOL_GPL(kvm_exit_reentry_stats);
+
+static bool exit_reentry_stats;
+
+static int exit_reentry_stats_set(const char *val, const struct kernel_param *kp)
+{
+	int ret;
+
+	ret = param_set_bool(val, kp);
+	if (ret)
+		return ret;
+
+	if (exit_reentry_stats)
+		static_branch_enable(&kvm_exit_reentry_stats);
+	else
+		static_branch_disable(&kvm_exit_reentry_stats);
+	return 0;
+}
+
+static const struct kernel_param_ops exit_reentry_stats_ops = {
+	.set = exit_reentry_stats_set,
+	.get = param_get_bool,
+};
+module_param_cb(exit_reentry_stats, &exit_reentry_stats_ops,
+		&exit_reentry_stats, 0644);
+
 /*
  * Ordering of locks:
  *
@@ -392,14 +440,17 @@ static void kvm_flush_shadow_all(struct kvm *kvm)
 static inline void *mmu_memory_cache_alloc_obj(struct kvm_mmu_memory_cache *mc,
 					       gfp_t gfp_flags)
 {
+	int nid = kvm_mmu_memory_cache_node(mc);
+	struct page *pg;
 	void *page;
 
 	gfp_flags |= mc->gfp_zero;
 
 	if (mc->kmem_cache)
-		return kmem_cache_alloc(mc->kmem_cache, gfp_flags);
+		return kmem_cache_alloc_node(mc->kmem_cache, gfp_flags, nid);
 
-	page = (void *)__get_free_page(gfp_flags);
+	pg = alloc_pages_node(nid, gfp_flags, 0);
+	page = pg ? page_address(pg) : NULL;
 	if (page && mc->init_value)
 		memset64(page, mc->init_value, PAGE_SIZE / sizeof(u64));
 	return page;
@@ -518,6 +569,7 @@ static void kvm_vcpu_destroy(struct kvm_vcpu *vcpu)
 	 */
 	put_pid(rcu_dereference_protected(vcpu->pid, 1));
 
+	kvm_coalesced_mmio_free_vcpu(vcpu);
 	free_page((unsigned long)vcpu->run);
 	kmem_cache_free(kvm_vcpu_cache, vcpu);
 }
@@ -1582,6 +1634,14 @@ static int check_memory_region_flags(struct kvm *kvm,
 		valid_flags |= KVM_MEM_READONLY;
 #endif
 
+	/*
+	 * Routing a slot's dirty tracking to its bitmap is only meaningful
+	 * in ring+bitmap mode and for slots that are dirty logged.
+	 */
+	if (kvm->dirty_ring_with_bitmap &&
+	    (mem->flags & KVM_MEM_LOG_DIRTY_PAGES))
+		valid_flags |= KVM_MEM_DIRTY_LOG_BITMAP;
+
 	if (mem->flags & ~valid_flags)
 		return -EINVAL;
 
@@ -3605,7 +3665,8 @@ void mark_page_dirty_in_slot(struct kvm *kvm,
 		unsigned long rel_gfn = gfn - memslot->base_gfn;
 		u32 slot = (memslot->as_id << 16) | memslot->id;
 
-		if (kvm->dirty_ring_size && vcpu)
+		if (kvm->dirty_ring_size && vcpu &&
+		    !(memslot->flags & KVM_MEM_DIRTY_LOG_BITMAP))
 			kvm_dirty_ring_push(vcpu, slot, rel_gfn);
 		else if (memslot->dirty_bitmap)
 			set_bit_le(rel_gfn, memslot->dirty_bitmap);
@@ -3692,6 +3753,74 @@ static void shrink_halt_poll_ns(struct kvm_vcpu *vcpu)
 	trace_kvm_halt_poll_ns_shrink(vcpu->vcpu_id, val, old);
 }
 
+/*
+ * Failed-poll time burnt by all vCPUs in the current accounting window, used
+ * to enforce halt_poll_burn_pct.  The window reset is racy by design; losing
+ * an update or resetting twice merely perturbs the cap by a fraction of one
+ * window.
+ */
+#define HALT_POLL_BURN_WINDOW_NS	(100 * NSEC_PER_MSEC)
+
+static atomic64_t halt_poll_burn_ns;
+static u64 halt_poll_burn_start;
+
+static bool halt_poll_over_burn_cap(void)
+{
+	unsigned int pct = READ_ONCE(halt_poll_burn_pct);
+	u64 now, start, budget;
+
+	if (!pct)
+		return false;
+
+	now = ktime_get_ns();
+	start = READ_ONCE(halt_poll_burn_start);
+	if (now - start > HALT_POLL_BURN_WINDOW_NS) {
+		WRITE_ONCE(halt_poll_burn_start, now);
+		atomic64_set(&halt_poll_burn_ns, 0);
+		return false;
+	}
+
+	budget = mult_frac(now - start, pct, 100) * num_online_cpus();
+	return atomic64_read(&halt_poll_burn_ns) > budget;
+}
+
+static void adapt_halt_poll_ns(struct kvm_vcpu *vcpu, u64 halt_ns,
+			       unsigned int max_halt_poll_ns)
+{
+	unsigned int shift = READ_ONCE(halt_poll_ns_ewma_shift);
+	unsigned int old = vcpu->halt_poll_ns;
+	u64 ewma = vcpu->halt_ewma_ns;
+	u64 val;
+
+	/* EWMA of recent halt durations classifies this vCPU's wakeups. */
+	ewma -= ewma >> shift;
+	ewma += halt_ns >> shift;
+	vcpu->halt_ewma_ns = ewma;
+	vcpu->stat.generic.halt_poll_ewma_ns = ewma;
+
+	/*
+	 * Poll for twice the typical halt: vCPUs with short wakeup intervals
+	 * (IO threads) get a window that covers them, while housekeeping
+	 * vCPUs with long idle periods fall below grow_start and stop
+	 * polling.  The EWMA keeps tracking halt durations either way, so a
+	 * vCPU that stops polling starts again as soon as its wakeups speed
+	 * up.
+	 */
+	val = min_t(u64, ewma * 2, max_halt_poll_ns);
+	if (val < READ_ONCE(halt_poll_ns_grow_start))
+		val = 0;
+
+	if (val && halt_poll_over_burn_cap())
+		val = 0;
+
+	vcpu->halt_poll_ns = val;
+
+	if (val > old)
+		trace_kvm_halt_poll_ns_grow(vcpu->vcpu_id, val, old);
+	else if (val < old)
+		trace_kvm_halt_poll_ns_shrink(vcpu->vcpu_id, val, old);
+}
+
 static int kvm_vcpu_check_block(struct kvm_vcpu *vcpu)
 {
 	int ret = -EINTR;
@@ -3768,6 +3897,9 @@ static inline void update_halt_poll_stats(struct kvm_vcpu *vcpu, ktime_t start,
 	} else {
 		stats->halt_poll_fail_ns += poll_ns;
 		KVM_STATS_LOG_HIST_UPDATE(stats->halt_poll_fail_hist, poll_ns);
+
+		if (READ_ONCE(halt_poll_ns_ewma_shift))
+			atomic64_add(poll_ns, &halt_poll_burn_ns);
 	}
 }
 
@@ -3848,6 +3980,9 @@ out:
 
 		if (!vcpu_valid_wakeup(vcpu)) {
 			shrink_halt_poll_ns(vcpu);
+		} else if (max_halt_poll_ns &&
+			   READ_ONCE(halt_poll_ns_ewma_shift)) {
+			adapt_halt_poll_ns(vcpu, halt_ns, max_halt_poll_ns);
 		} else if (max_halt_poll_ns) {
 			if (halt_ns <= vcpu->halt_poll_ns)
 				;
@@ -4108,7 +4243,8 @@ static vm_fault_t kvm_vcpu_fault(struct vm_fault *vmf)
 #endif
 #ifdef CONFIG_KVM_MMIO
 	else if (vmf->pgoff == KVM_COALESCED_MMIO_PAGE_OFFSET)
-		page = virt_to_page(vcpu->kvm->coalesced_mmio_ring);
+		page = virt_to_page(vcpu->coalesced_mmio_ring ?:
+				    vcpu->kvm->coalesced_mmio_ring);
 #endif
 	else if (kvm_page_in_dirty_ring(vcpu->kvm, vmf->pgoff))
 		page = kvm_dirty_ring_get_page(
@@ -4240,10 +4376,14 @@ static int kvm_vm_ioctl_create_vcpu(struct kvm *kvm, u32 id)
 
 	kvm_vcpu_init(vcpu, kvm, id);
 
-	r = kvm_arch_vcpu_create(vcpu);
+	r = kvm_coalesced_mmio_init_vcpu(vcpu);
 	if (r)
 		goto vcpu_free_run_page;
 
+	r = kvm_arch_vcpu_create(vcpu);
+	if (r)
+		goto vcpu_free_coalesced_mmio;
+
 	if (kvm->dirty_ring_size) {
 		r = kvm_dirty_ring_alloc(&vcpu->dirty_ring,
 					 id, kvm->dirty_ring_size);
@@ -4300,6 +4440,8 @@ unlock_vcpu_destroy:
 	kvm_dirty_ring_free(&vcpu->dirty_ring);
 arch_vcpu_destroy:
 	kvm_arch_vcpu_destroy(vcpu);
+vcpu_free_coalesced_mmio:
+	kvm_coalesced_mmio_free_vcpu(vcpu);
 vcpu_free_run_page:
 	free_page((unsigned long)vcpu->run);
 vcpu_free:
@@ -4805,6 +4947,7 @@ static int kvm_vm_ioctl_check_extension_generic(struct kvm *kvm, long arg)
 #endif
 #ifdef CONFIG_HAVE_KVM_IRQCHIP
 	case KVM_CAP_IRQFD:
+	case KVM_CAP_IRQFD_COALESCE:
 #endif
 	case KVM_CAP_IOEVENTFD_ANY_LENGTH:
 	case KVM_CAP_CHECK_EXTENSION_VM:
@@ -4815,6 +4958,7 @@ static int kvm_vm_ioctl_check_extension_generic(struct kvm *kvm, long arg)
 	case KVM_CAP_COALESCED_MMIO:
 		return KVM_COALESCED_MMIO_PAGE_OFFSET;
 	case KVM_CAP_COALESCED_PIO:
+	case KVM_CAP_COALESCED_MMIO_PER_VCPU:
 		return 1;
 #endif
 #ifdef CONFIG_KVM_GENERIC_DIRTYLOG_READ_PROTECT
@@ -4987,6 +5131,26 @@ static int kvm_vm_ioctl_enable_cap_generic(struct kvm *kvm,
 			return -EINVAL;
 
 		return kvm_vm_ioctl_enable_dirty_log_ring(kvm, cap->args[0]);
+#ifdef CONFIG_KVM_MMIO
+	case KVM_CAP_COALESCED_MMIO_PER_VCPU: {
+		int r = -EINVAL;
+
+		if (cap->flags || cap->args[0])
+			return -EINVAL;
+
+		/*
+		 * All vCPUs must agree on which ring their fd maps, so the
+		 * switch is only allowed before the first vCPU is created.
+		 */
+		mutex_lock(&kvm->lock);
+		if (!kvm->created_vcpus) {
+			kvm->coalesced_mmio_per_vcpu = true;
+			r = 0;
+		}
+		mutex_unlock(&kvm->lock);
+		return r;
+	}
+#endif
 	case KVM_CAP_DIRTY_LOG_RING_WITH_BITMAP: {
 		int r = -EINVAL;
 
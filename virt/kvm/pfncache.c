@@ -28,31 +28,36 @@ void gfn_to_pfn_cache_invalidate_start(struct kvm *kvm, unsigned long start,
 	struct gfn_to_pfn_cache *gpc;
 
 	spin_lock(&kvm->gpc_lock);
-	list_for_each_entry(gpc, &kvm->gpc_list, list) {
-		read_lock_irq(&gpc->lock);
 
-		/* Only a single page so no need to care about length */
-		if (gpc->valid && !is_error_noslot_pfn(gpc->pfn) &&
-		    gpc->uhva >= start && gpc->uhva < end) {
-			read_unlock_irq(&gpc->lock);
+	/*
+	 * Pairs with the smp_mb() in hva_to_pfn_retry(): the caller elevated
+	 * mn_active_invalidate_count before invoking this hook, so ordering
+	 * that store before the lockless peeks below guarantees that a
+	 * concurrent refresh either sees the elevated count when it re-checks
+	 * after publishing and self-invalidates, or has made its uhva/valid
+	 * stores visible to the peeks here.
+	 */
+	smp_mb();
 
-			/*
-			 * There is a small window here where the cache could
-			 * be modified, and invalidation would no longer be
-			 * necessary. Hence check again whether invalidation
-			 * is still necessary once the write lock has been
-			 * acquired.
-			 */
+	list_for_each_entry(gpc, &kvm->gpc_list, list) {
+		unsigned long uhva = READ_ONCE(gpc->uhva);
 
-			write_lock_irq(&gpc->lock);
-			if (gpc->valid && !is_error_noslot_pfn(gpc->pfn) &&
-			    gpc->uhva >= start && gpc->uhva < end)
-				gpc->valid = false;
-			write_unlock_irq(&gpc->lock);
+		/*
+		 * Filter with a racy peek at the cache before touching its
+		 * lock, so that invalidations only contend with the caches
+		 * they overlap.  A refresh racing with the peek is handled
+		 * by the publish-then-recheck protocol above.
+		 *
+		 * Only a single page so no need to care about length.
+		 */
+		if (!READ_ONCE(gpc->valid) || uhva < start || uhva >= end)
 			continue;
-		}
 
-		read_unlock_irq(&gpc->lock);
+		write_lock_irq(&gpc->lock);
+		if (gpc->valid && !is_error_noslot_pfn(gpc->pfn) &&
+		    gpc->uhva >= start && gpc->uhva < end)
+			gpc->valid = false;
+		write_unlock_irq(&gpc->lock);
 	}
 	spin_unlock(&kvm->gpc_lock);
 }
@@ -224,9 +229,26 @@ static kvm_pfn_t hva_to_pfn_retry(struct gfn_to_pfn_cache *gpc)
 		 * attempting to refresh.
 		 */
 		WARN_ON_ONCE(gpc->valid);
-	} while (mmu_notifier_retry_cache(gpc->kvm, mmu_seq));
 
-	gpc->valid = true;
+		/*
+		 * Publish valid, then re-check for an invalidation that
+		 * raced with it.  Pairs with the smp_mb() in
+		 * gfn_to_pfn_cache_invalidate_start(), which peeks at valid
+		 * and uhva without taking gpc->lock: either that peek
+		 * observes these stores, or the re-check below observes the
+		 * elevated invalidate count / advanced sequence and
+		 * self-invalidates.  The pfn isn't published until the loop
+		 * exits, but the invalidator can't look at it before this
+		 * task drops gpc->lock, which happens after.
+		 */
+		gpc->valid = true;
+		smp_mb();
+		if (!mmu_notifier_retry_cache(gpc->kvm, mmu_seq))
+			break;
+
+		gpc->valid = false;
+	} while (1);
+
 	gpc->pfn = new_pfn;
 	gpc->khva = new_khva + offset_in_page(gpc->uhva);
 